@@ -0,0 +1,143 @@
+/**
+ * @file bench_support.c
+ * @brief Implementación en C de las funciones que mide monitor_bench.cc.
+ */
+
+#include "monitor_bench.h"
+#include "expose_metrics.h"
+
+/**
+ * @brief Fuentes que los fixtures no capturan y que el ciclo completo omite.
+ */
+#define BENCH_UNCAPTURED_SOURCES (SNAPSHOT_PROCS | SNAPSHOT_CGROUPS | SNAPSHOT_BPF | SNAPSHOT_FILESYSTEMS)
+
+/**
+ * @brief Getter de metrics.h y la fuente de la que lee.
+ */
+typedef struct
+{
+    const char* name;                           ///< Nombre de la función.
+    unsigned int source;                        ///< Bit SNAPSHOT_* de la fuente.
+    double (*get)(const proc_snapshot_t* snap); ///< Getter, o un adaptador si devuelve un entero.
+} bench_getter_t;
+
+/**
+ * @brief Adaptadores de los getters que devuelven unsigned long long.
+ */
+static double change_context(const proc_snapshot_t* snap)
+{
+    return (double)get_change_context(snap);
+}
+
+static double total_processes(const proc_snapshot_t* snap)
+{
+    return (double)get_total_processes(snap);
+}
+
+static double major_page_faults(const proc_snapshot_t* snap)
+{
+    return (double)get_major_page_faults(snap);
+}
+
+static double minor_page_faults(const proc_snapshot_t* snap)
+{
+    return (double)get_minor_page_faults(snap);
+}
+
+/**
+ * @brief Getters medidos, uno por función pública de metrics.h.
+ */
+static const bench_getter_t getters[] = {
+    {"get_change_context", SNAPSHOT_STAT, change_context},
+    {"get_total_processes", SNAPSHOT_STAT, total_processes},
+    {"get_cpu_usage", SNAPSHOT_STAT, get_cpu_usage},
+    {"get_memory_total", SNAPSHOT_MEMINFO, get_memory_total},
+    {"get_memory_avalible", SNAPSHOT_MEMINFO, get_memory_avalible},
+    {"get_memory_usage", SNAPSHOT_MEMINFO, get_memory_usage},
+    {"get_memory_usage_2", SNAPSHOT_MEMINFO, get_memory_usage_2},
+    {"get_major_page_faults", SNAPSHOT_VMSTAT, major_page_faults},
+    {"get_minor_page_faults", SNAPSHOT_VMSTAT, minor_page_faults},
+    {"get_disk_stats", SNAPSHOT_DISKSTATS, get_disk_stats},
+    {"get_disk_usage", SNAPSHOT_DISKSTATS, get_disk_usage},
+    {"get_network_usage", SNAPSHOT_NETDEV, get_network_usage},
+    {"get_average_bandwidth", SNAPSHOT_NETDEV, get_average_bandwidth},
+};
+
+/**
+ * @brief Instantánea reutilizada por todas las mediciones.
+ */
+static proc_snapshot_t snap;
+
+/**
+ * @brief Canal en el que publica el ciclo completo.
+ */
+static metric_channel_t* channel;
+
+/**
+ * @brief Arena de los renders, reiniciada después de cada uno como la del scrape.
+ */
+static arena_t render_arena;
+
+int bench_init(void)
+{
+    init_metrics();
+    channel = metric_channel_new("bench");
+    return channel != NULL ? INICIAL_VALUE : ERROR_INT;
+}
+
+int bench_use_fixture(const char* dir)
+{
+    if (strcmp(snapshot_proc_root(), dir) == 0)
+    {
+        return INICIAL_VALUE;
+    }
+    // Cada fixture trae su sys/block, así que la selección de discos completos no depende de la máquina
+    char sys_root[PROC_PATH_SIZE];
+    if (snprintf(sys_root, sizeof(sys_root), "%s/sys", dir) >= (int)sizeof(sys_root) ||
+        snapshot_set_sys_root(sys_root) != INICIAL_VALUE || snapshot_set_proc_root(dir) != INICIAL_VALUE ||
+        snapshot_init() != INICIAL_VALUE)
+    {
+        return ERROR_INT;
+    }
+    return update_snapshot_sources(&snap, SNAPSHOT_ALL & ~BENCH_UNCAPTURED_SOURCES);
+}
+
+int bench_getter_count(void)
+{
+    return (int)(sizeof(getters) / sizeof(getters[0]));
+}
+
+const char* bench_getter_name(int index)
+{
+    return getters[index].name;
+}
+
+double bench_run_getter(int index)
+{
+    update_snapshot_sources(&snap, getters[index].source);
+    return getters[index].get(&snap);
+}
+
+size_t bench_tick(void)
+{
+    unsigned long long enabled = metric_registry_enabled();
+    unsigned int sources = metric_registry_sources(enabled) & ~BENCH_UNCAPTURED_SOURCES;
+    update_snapshot_sources(&snap, sources);
+    metric_batch_t* batch = metric_batch_begin(channel);
+    if (batch == NULL)
+    {
+        return INICIAL_VALUE;
+    }
+    metric_registry_collect(batch, &snap, sources, enabled);
+    size_t count = batch->count;
+    metric_batch_publish(channel);
+    return count;
+}
+
+size_t bench_render(void)
+{
+    const char* body = render_exposition(&render_arena);
+    size_t len = body != NULL ? strlen(body) : INICIAL_VALUE;
+    arena_reset(&render_arena);
+    return len;
+}
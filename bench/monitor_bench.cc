@@ -0,0 +1,134 @@
+/**
+ * @file monitor_bench.cc
+ * @brief Microbenchmarks de los getters, del ciclo completo y del render sobre hosts capturados.
+ *
+ * Cada medición se registra una vez por fixture de bench/fixtures: small_vm (una CPU, pocos dispositivos),
+ * cores_128 (128 CPUs con schedstat por dominio y 28 dispositivos de bloque) y veth_500 (500 interfaces veth de
+ * contenedores). Los nombres siguen el patrón medición/fixture, así que --benchmark_filter=/veth_500 corre un host.
+ *
+ * Los fixtures no cambian entre lecturas, así que los getters que calculan tasas ven deltas en cero y lo informan
+ * por stderr; después de inicializar, stderr se descarta para que esos avisos no tapen los resultados.
+ *
+ * Uso: monitor_bench [opciones de Google Benchmark] [directorio_de_fixtures]
+ */
+
+#include "monitor_bench.h"
+#include <benchmark/benchmark.h>
+#include <cstdio>
+#include <cstdlib>
+#include <string>
+
+#ifndef BENCH_FIXTURES_DIR
+/**
+ * @brief Directorio de fixtures por defecto (CMake lo define como bench/fixtures del árbol fuente).
+ */
+#define BENCH_FIXTURES_DIR "bench/fixtures"
+#endif
+
+/**
+ * @brief Hosts capturados, uno por subdirectorio del directorio de fixtures.
+ */
+static const char* const fixtures[] = {"small_vm", "cores_128", "veth_500"};
+
+/**
+ * @brief Pasa al fixture de la medición o la marca como fallida.
+ *
+ * @param state Estado de la medición.
+ * @param dir Directorio del fixture.
+ * @return true si el fixture se pudo leer.
+ */
+static bool use_fixture(benchmark::State& state, const std::string& dir)
+{
+    if (bench_use_fixture(dir.c_str()) != 0)
+    {
+        state.SkipWithError(("No se pudo leer " + dir).c_str());
+        return false;
+    }
+    return true;
+}
+
+/**
+ * @brief Registra las mediciones de un fixture.
+ *
+ * @param name Nombre del fixture.
+ * @param dir Directorio del fixture.
+ */
+static void register_fixture(const std::string& name, const std::string& dir)
+{
+    // Un getter incluye la relectura y el parseo de su fuente: es lo que paga cada tarea por ciclo
+    for (int i = 0; i < bench_getter_count(); i++)
+    {
+        benchmark::RegisterBenchmark(("getter/" + std::string(bench_getter_name(i)) + "/" + name).c_str(),
+                                     [dir, i](benchmark::State& state) {
+                                         if (!use_fixture(state, dir))
+                                         {
+                                             return;
+                                         }
+                                         for (auto _ : state)
+                                         {
+                                             benchmark::DoNotOptimize(bench_run_getter(i));
+                                         }
+                                     });
+    }
+
+    benchmark::RegisterBenchmark(("tick/" + name).c_str(), [dir](benchmark::State& state) {
+        if (!use_fixture(state, dir))
+        {
+            return;
+        }
+        size_t samples = 0;
+        for (auto _ : state)
+        {
+            samples = bench_tick();
+            benchmark::DoNotOptimize(samples);
+        }
+        state.counters["samples"] = static_cast<double>(samples);
+    });
+
+    // El render parte del lote de un ciclo del mismo fixture; libprom conserva las series de los anteriores
+    benchmark::RegisterBenchmark(("render/" + name).c_str(), [dir](benchmark::State& state) {
+        if (!use_fixture(state, dir))
+        {
+            return;
+        }
+        bench_tick();
+        size_t bytes = 0;
+        for (auto _ : state)
+        {
+            bytes = bench_render();
+            benchmark::DoNotOptimize(bytes);
+        }
+        state.SetBytesProcessed(static_cast<int64_t>(state.iterations() * bytes));
+    });
+}
+
+/**
+ * @brief Punto de entrada del benchmark.
+ *
+ * @param argc Número de argumentos.
+ * @param argv Opciones de Google Benchmark y, opcionalmente, el directorio de fixtures.
+ * @return EXIT_SUCCESS si las mediciones corrieron, EXIT_FAILURE en caso contrario.
+ */
+int main(int argc, char* argv[])
+{
+    benchmark::Initialize(&argc, argv);
+    std::string root = argc > 1 ? argv[1] : BENCH_FIXTURES_DIR;
+
+    if (bench_init() != 0)
+    {
+        std::fprintf(stderr, "Error al inicializar el benchmark\n");
+        return EXIT_FAILURE;
+    }
+    if (std::freopen("/dev/null", "w", stderr) == nullptr)
+    {
+        return EXIT_FAILURE;
+    }
+    for (const char* fixture : fixtures)
+    {
+        register_fixture(fixture, root + "/" + fixture);
+    }
+
+    benchmark::RunSpecifiedBenchmarks();
+    benchmark::Shutdown();
+    return EXIT_SUCCESS;
+}
@@ -0,0 +1,77 @@
+/**
+ * @file monitor_bench.h
+ * @brief Funciones en C que monitor_bench.cc mide con Google Benchmark.
+ *
+ * Los encabezados del monitor usan stdatomic.h y no se pueden incluir desde C++; este encabezado expone solo lo que
+ * necesita el benchmark, con tipos simples, y bench_support.c lo implementa sobre la instantánea y el almacén.
+ */
+
+#pragma once
+#include <stddef.h>
+
+#ifdef __cplusplus
+extern "C"
+{
+#endif
+
+    /**
+     * @brief Inicializa las métricas de Prometheus y el canal del almacén del benchmark.
+     *
+     * @return 0 en caso de éxito, -1 en caso de error.
+     */
+    int bench_init(void);
+
+    /**
+     * @brief Pasa a leer las fuentes de un directorio de fixtures con la estructura de /proc y, en sys/, los discos
+     * completos de /sys/block.
+     *
+     * No hace nada si ese directorio ya es la raíz vigente. Lee todas las fuentes una vez para que las tasas del
+     * benchmark se calculen contra una lectura anterior.
+     *
+     * @param dir Directorio del host capturado.
+     * @return 0 en caso de éxito, -1 si el directorio no tiene las fuentes obligatorias.
+     */
+    int bench_use_fixture(const char* dir);
+
+    /**
+     * @brief Cantidad de getters de metrics.h que se miden.
+     *
+     * @return Cantidad.
+     */
+    int bench_getter_count(void);
+
+    /**
+     * @brief Nombre de un getter.
+     *
+     * @param index Índice del getter.
+     * @return Nombre de la función.
+     */
+    const char* bench_getter_name(int index);
+
+    /**
+     * @brief Relee y parsea la fuente de un getter y lo evalúa, como en cada ciclo de su tarea.
+     *
+     * @param index Índice del getter.
+     * @return Valor devuelto por el getter.
+     */
+    double bench_run_getter(int index);
+
+    /**
+     * @brief Ciclo completo: lee las fuentes de las métricas habilitadas, arma el lote y lo publica.
+     *
+     * Los procesos y los cgroups no se capturan en los fixtures, así que quedan fuera del ciclo.
+     *
+     * @return Muestras del lote publicado.
+     */
+    size_t bench_tick(void);
+
+    /**
+     * @brief Renderiza la exposición de texto a partir del almacén, como un scrape sin caché.
+     *
+     * @return Bytes de la exposición, o 0 en caso de error.
+     */
+    size_t bench_render(void);
+
+#ifdef __cplusplus
+}
+#endif
@@ -0,0 +1,300 @@
+/**
+ * @file scan_bench.c
+ * @brief Microbenchmark del tokenizador de scan.h frente al parseo con sscanf().
+ *
+ * Carga los archivos de /proc capturados de un host de bench/fixtures (small_vm si no se indica otro) y mide, para cada
+ * fuente, el tiempo por parseo de los parsers actuales (parse_snapshot_source()) y de una réplica del camino anterior
+ * basado en strtok_r() + sscanf(). Antes de medir verifica que ambos caminos obtengan los mismos valores.
+ *
+ * Uso: scan_bench [directorio_de_fixtures] [iteraciones]
+ */
+
+#include "proc_snapshot.h"
+#include "memstat.h"
+#include "metrics.h"
+#include "netdev.h"
+#include <time.h>
+
+/**
+ * @brief Iteraciones por defecto de cada medición.
+ */
+#define BENCH_ITERATIONS 200000
+
+/**
+ * @brief Tamaño máximo de un fixture.
+ */
+#define FIXTURE_SIZE 65536
+
+#ifndef BENCH_FIXTURES_DIR
+/**
+ * @brief Directorio de fixtures por defecto (CMake lo define como bench/fixtures del árbol fuente).
+ */
+#define BENCH_FIXTURES_DIR "bench/fixtures"
+#endif
+
+/**
+ * @brief Host capturado que se usa si no se indica un directorio.
+ */
+#define BENCH_DEFAULT_FIXTURE "small_vm"
+
+/**
+ * @brief Fixture cargado en memoria y el parser sscanf de referencia para la misma fuente.
+ */
+typedef struct
+{
+    const char* file;                                ///< Nombre del archivo dentro del directorio de fixtures.
+    unsigned int source;                             ///< Bit SNAPSHOT_* de la fuente.
+    int (*legacy)(proc_snapshot_t* snap, char* buf); ///< Parser de referencia con sscanf().
+    char data[FIXTURE_SIZE];                         ///< Contenido del fixture.
+    size_t len;                                      ///< Bytes válidos de data.
+} fixture_t;
+
+/**
+ * @brief Réplica del parser sscanf() de /proc/stat.
+ */
+static int legacy_stat(proc_snapshot_t* snap, char* buf)
+{
+    char* save = NULL;
+    int found_cpu = 0;
+    for (char* line = strtok_r(buf, "\n", &save); line != NULL; line = strtok_r(NULL, "\n", &save))
+    {
+        // Sin la guarda, "cpu  %llu" también acepta las líneas "cpuN"
+        if (!found_cpu && sscanf(line, "cpu  %llu %llu %llu %llu %llu %llu %llu %llu", &snap->cpu_user, &snap->cpu_nice,
+                   &snap->cpu_system, &snap->cpu_idle, &snap->cpu_iowait, &snap->cpu_irq, &snap->cpu_softirq,
+                   &snap->cpu_steal) == ASSIGNED_VALUE_8)
+        {
+            found_cpu = 1;
+            continue;
+        }
+        if (sscanf(line, "ctxt %llu", &snap->ctxt) == ASSIGNED_VALUE)
+        {
+            continue;
+        }
+        if (sscanf(line, "processes %llu", &snap->processes) == ASSIGNED_VALUE)
+        {
+            break;
+        }
+    }
+    return INICIAL_VALUE;
+}
+
+/**
+ * @brief Réplica del parser sscanf() de /proc/meminfo.
+ */
+static int legacy_meminfo(proc_snapshot_t* snap, char* buf)
+{
+    char* save = NULL;
+    for (char* line = strtok_r(buf, "\n", &save); line != NULL; line = strtok_r(NULL, "\n", &save))
+    {
+        if (sscanf(line, "MemTotal: %llu kB", &snap->memstat[MEMSTAT_MEM_TOTAL]) == ASSIGNED_VALUE)
+        {
+            continue;
+        }
+        if (sscanf(line, "MemAvailable: %llu kB", &snap->memstat[MEMSTAT_MEM_AVAILABLE]) == ASSIGNED_VALUE)
+        {
+            break;
+        }
+    }
+    return INICIAL_VALUE;
+}
+
+/**
+ * @brief Réplica del parser sscanf() de /proc/vmstat.
+ */
+static int legacy_vmstat(proc_snapshot_t* snap, char* buf)
+{
+    char* save = NULL;
+    for (char* line = strtok_r(buf, "\n", &save); line != NULL; line = strtok_r(NULL, "\n", &save))
+    {
+        if (sscanf(line, "pgfault %llu", &snap->memstat[MEMSTAT_PGFAULT]) == ASSIGNED_VALUE)
+        {
+            continue;
+        }
+        if (sscanf(line, "pgmajfault %llu", &snap->memstat[MEMSTAT_PGMAJFAULT]) == ASSIGNED_VALUE)
+        {
+            break;
+        }
+    }
+    return INICIAL_VALUE;
+}
+
+/**
+ * @brief Réplica del parser sscanf() de /proc/diskstats (todos los dispositivos, sin tasas).
+ */
+static int legacy_diskstats(proc_snapshot_t* snap, char* buf)
+{
+    char* save = NULL;
+    for (char* line = strtok_r(buf, "\n", &save); line != NULL; line = strtok_r(NULL, "\n", &save))
+    {
+        char name[DISK_NAME_SIZE];
+        unsigned long long reads, read_sectors, writes, write_sectors;
+        if (sscanf(line, "%*u %*u %31s %llu %*u %llu %*u %llu %*u %llu", name, &reads, &read_sectors, &writes,
+                   &write_sectors) == ASSIGNED_VALUE_5 &&
+            snap->disk_count < MAX_DISK_DEVICES)
+        {
+            snap->disk_count++;
+            snap->disk_reads += reads;
+            snap->disk_writes += writes;
+            snap->disk_read_sectors += read_sectors;
+            snap->disk_write_sectors += write_sectors;
+        }
+    }
+    return INICIAL_VALUE;
+}
+
+/**
+ * @brief Réplica del parser sscanf() de /proc/net/dev.
+ */
+static int legacy_netdev(proc_snapshot_t* snap, char* buf)
+{
+    char* save = NULL;
+    int line_number = INICIAL_VALUE;
+    for (char* line = strtok_r(buf, "\n", &save); line != NULL; line = strtok_r(NULL, "\n", &save))
+    {
+        char interface[INTERFACE_SIZE];
+        unsigned long long rx, tx;
+        if (line_number++ < 2)
+        {
+            continue;
+        }
+        if (sscanf(line, "%31s %llu %*u %*u %*u %*u %*u %*u %*u %llu", interface, &rx, &tx) == ASSIGNED_VALUE_3)
+        {
+            snap->net_rx_bytes += rx;
+            snap->net_tx_bytes += tx;
+        }
+    }
+    return INICIAL_VALUE;
+}
+
+/**
+ * @brief Fixtures usados por el benchmark.
+ */
+static fixture_t fixtures[] = {
+    {"stat", SNAPSHOT_STAT, legacy_stat, {0}, 0},
+    {"meminfo", SNAPSHOT_MEMINFO, legacy_meminfo, {0}, 0},
+    {"vmstat", SNAPSHOT_VMSTAT, legacy_vmstat, {0}, 0},
+    {"diskstats", SNAPSHOT_DISKSTATS, legacy_diskstats, {0}, 0},
+    {"net/dev", SNAPSHOT_NETDEV, legacy_netdev, {0}, 0},
+};
+
+/**
+ * @brief Carga un fixture del directorio indicado.
+ *
+ * @param dir Directorio de fixtures.
+ * @param fx Fixture a completar.
+ * @return 0 en caso de éxito, -1 en caso de error.
+ */
+static int load_fixture(const char* dir, fixture_t* fx)
+{
+    char path[BUFFER_SIZE * 2];
+    snprintf(path, sizeof(path), "%s/%s", dir, fx->file);
+
+    FILE* fp = fopen(path, "r");
+    if (fp == NULL)
+    {
+        perror(path);
+        return ERROR_INT;
+    }
+    fx->len = fread(fx->data, 1, sizeof(fx->data) - 1, fp);
+    fx->data[fx->len] = '\0';
+    fclose(fp);
+    return INICIAL_VALUE;
+}
+
+/**
+ * @brief Compara los campos relevantes de dos instantáneas parseadas por ambos caminos.
+ *
+ * @return 1 si coinciden, 0 si no.
+ */
+static int snapshots_match(const proc_snapshot_t* a, const proc_snapshot_t* b)
+{
+    return a->cpu_user == b->cpu_user && a->cpu_steal == b->cpu_steal && a->ctxt == b->ctxt &&
+           a->processes == b->processes && a->memstat[MEMSTAT_MEM_TOTAL] == b->memstat[MEMSTAT_MEM_TOTAL] &&
+           a->memstat[MEMSTAT_MEM_AVAILABLE] == b->memstat[MEMSTAT_MEM_AVAILABLE] &&
+           a->memstat[MEMSTAT_PGFAULT] == b->memstat[MEMSTAT_PGFAULT] &&
+           a->memstat[MEMSTAT_PGMAJFAULT] == b->memstat[MEMSTAT_PGMAJFAULT] && a->net_rx_bytes == b->net_rx_bytes &&
+           a->net_tx_bytes == b->net_tx_bytes;
+}
+
+/**
+ * @brief Devuelve el instante actual de CLOCK_MONOTONIC en nanosegundos.
+ */
+static double now_ns()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return ts.tv_sec * 1e9 + ts.tv_nsec;
+}
+
+/**
+ * @brief Punto de entrada del benchmark.
+ *
+ * @param argc Número de argumentos.
+ * @param argv Directorio de fixtures e iteraciones opcionales.
+ * @return EXIT_SUCCESS si ambos caminos coinciden, EXIT_FAILURE en caso contrario.
+ */
+int main(int argc, char* argv[])
+{
+    const char* dir = argc > 1 ? argv[1] : BENCH_FIXTURES_DIR "/" BENCH_DEFAULT_FIXTURE;
+    long iterations = argc > 2 ? atol(argv[2]) : BENCH_ITERATIONS;
+    static proc_snapshot_t snap_scan, snap_legacy;
+    static char scratch[FIXTURE_SIZE];
+    int ok = 1;
+
+    // Los discos completos salen del sys/block del fixture y no de la máquina del benchmark
+    char sys_root[PROC_PATH_SIZE];
+    snprintf(sys_root, sizeof(sys_root), "%s/sys", dir);
+    snapshot_set_sys_root(sys_root);
+
+    // La réplica sscanf suma todas las interfaces, incluidas lo y veth*
+    set_netdev_filter(ASSIGNED_VALUE, ASSIGNED_VALUE);
+
+    // Compara el mismo trabajo que la réplica sscanf: solo los campos de los getters
+    const char* legacy_fields[] = {"MemTotal", "MemAvailable", "pgfault", "pgmajfault"};
+    set_memstat_fields(legacy_fields, sizeof(legacy_fields) / sizeof(legacy_fields[0]));
+
+    printf("%-10s %12s %12s %8s\n", "fuente", "scan ns/op", "sscanf ns/op", "mejora");
+    for (size_t i = 0; i < sizeof(fixtures) / sizeof(fixtures[0]); i++)
+    {
+        fixture_t* fx = &fixtures[i];
+        if (load_fixture(dir, fx) != INICIAL_VALUE)
+        {
+            return EXIT_FAILURE;
+        }
+
+        // Verificar que ambos caminos producen los mismos valores
+        memset(&snap_scan, 0, sizeof(snap_scan));
+        memset(&snap_legacy, 0, sizeof(snap_legacy));
+        parse_snapshot_source(&snap_scan, fx->source, fx->data, fx->len);
+        memcpy(scratch, fx->data, fx->len + 1);
+        fx->legacy(&snap_legacy, scratch);
+        // La réplica sscanf no selecciona discos, por eso en diskstats solo se comparan los demás campos
+        if (!snapshots_match(&snap_scan, &snap_legacy))
+        {
+            fprintf(stderr, "%s: los valores de scan y sscanf no coinciden\n", fx->file);
+            ok = 0;
+        }
+
+        double start = now_ns();
+        for (long n = 0; n < iterations; n++)
+        {
+            snap_scan.disk_count = 0;
+            parse_snapshot_source(&snap_scan, fx->source, fx->data, fx->len);
+        }
+        double scan_ns = (now_ns() - start) / iterations;
+
+        // El camino sscanf necesita una copia porque strtok_r() modifica el buffer
+        start = now_ns();
+        for (long n = 0; n < iterations; n++)
+        {
+            snap_legacy.disk_count = 0;
+            memcpy(scratch, fx->data, fx->len + 1);
+            fx->legacy(&snap_legacy, scratch);
+        }
+        double legacy_ns = (now_ns() - start) / iterations;
+
+        printf("%-10s %12.1f %12.1f %7.1fx\n", fx->file, scan_ns, legacy_ns, legacy_ns / scan_ns);
+    }
+
+    return ok ? EXIT_SUCCESS : EXIT_FAILURE;
+}
@@ -0,0 +1,10 @@
+# Convierte un archivo binario en un encabezado de C con un arreglo de bytes.
+#
+# Uso: cmake -DINPUT=<archivo> -DOUTPUT=<encabezado> -DNAME=<arreglo> -P embed_object.cmake
+file(READ "${INPUT}" hex HEX)
+string(REGEX REPLACE "([0-9a-f][0-9a-f])" "0x\\1," bytes "${hex}")
+get_filename_component(source "${INPUT}" NAME)
+file(WRITE "${OUTPUT}"
+    "/* Generado por embed_object.cmake a partir de ${source}; no editar. */\n"
+    "#pragma once\n"
+    "static const unsigned char ${NAME}[] = {${bytes}};\n")
@@ -0,0 +1,111 @@
+/**
+ * @file adaptive.h
+ * @brief Muestreo adaptativo: las tareas cuyas métricas no cambian espacian sus ejecuciones.
+ *
+ * Cada regla de config.json asocia un patrón fnmatch de nombres de métrica con un delta y, opcionalmente, un umbral.
+ * Después de cada ejecución la tarea compara su lote con el anterior, serie por serie: los gauges por su valor y los
+ * contadores por su tasa por segundo. Si todas las series cubiertas por alguna regla variaron a lo sumo su delta, la
+ * tarea duplica su intervalo (hasta el máximo configurado); si alguna varió más o superó su umbral, vuelve de
+ * inmediato a su intervalo rápido. La unidad que se espacia es la tarea, porque cada una lee su fuente de /proc
+ * una sola vez por ejecución; las métricas sin regla no retienen a la tarea en el intervalo rápido.
+ */
+
+#pragma once
+#include "metric_store.h"
+#include <stdint.h>
+
+/**
+ * @brief Cantidad máxima de reglas.
+ */
+#define MAX_ADAPTIVE_RULES 16
+
+/**
+ * @brief Tamaño del patrón de una regla.
+ */
+#define ADAPTIVE_PATTERN_SIZE 64
+
+/**
+ * @brief Intervalo máximo al que se espacia una tarea si config.json no indica otro.
+ */
+#define ADAPTIVE_DEFAULT_MAX_INTERVAL_MS 16000
+
+/**
+ * @brief Resultado de comparar un lote con el anterior.
+ */
+typedef enum
+{
+    ADAPTIVE_NONE,    ///< Ninguna serie del lote está cubierta por una regla.
+    ADAPTIVE_QUIET,   ///< Todas las series cubiertas variaron a lo sumo su delta.
+    ADAPTIVE_CHANGED, ///< Alguna serie cubierta varió más que su delta o es nueva.
+    ADAPTIVE_HOT      ///< Alguna serie cubierta superó su umbral.
+} adaptive_result_t;
+
+/**
+ * @brief Regla de muestreo adaptativo.
+ */
+typedef struct
+{
+    const char* pattern; ///< Patrón fnmatch sobre el nombre de la métrica.
+    double delta;        ///< Variación tolerada entre dos ejecuciones (valor, o tasa por segundo de un contador).
+    int has_threshold;   ///< 1 si la regla tiene umbral.
+    double threshold;    ///< Valor (o tasa) por encima del cual la tarea vuelve al intervalo rápido.
+} adaptive_rule_t;
+
+/**
+ * @brief Serie del último lote de una tarea, con la regla que la cubre.
+ */
+typedef struct
+{
+    const void* metric;   ///< Métrica de la muestra.
+    uint64_t labels_hash; ///< Hash de los valores de las etiquetas.
+    int rule;             ///< Índice de la regla, o -1 si ninguna la cubre.
+    int observations;     ///< Lotes en los que apareció, hasta 2 (un contador necesita dos para tener tasa).
+    double value;         ///< Último valor.
+    double quantity;      ///< Último valor comparado: el valor de un gauge o la tasa de un contador.
+} adaptive_point_t;
+
+/**
+ * @brief Estado de una tarea: las series de su último lote en el orden en que se agregaron.
+ */
+typedef struct
+{
+    adaptive_point_t* points;      ///< Series del último lote.
+    size_t count;                  ///< Series válidas.
+    size_t cap;                    ///< Capacidad de points.
+    unsigned long long last_ns;    ///< Instante del último lote.
+    unsigned int rules_generation; ///< Generación de las reglas con la que se resolvieron las series.
+} adaptive_state_t;
+
+/**
+ * @brief Reemplaza las reglas.
+ *
+ * @param rules Reglas (se copian los patrones).
+ * @param count Cantidad de reglas (se trunca a MAX_ADAPTIVE_RULES); con 0 se desactiva el muestreo adaptativo.
+ */
+void set_adaptive_rules(const adaptive_rule_t* rules, int count);
+
+/**
+ * @brief Configura el intervalo máximo al que se espacia una tarea.
+ *
+ * @param max_interval_ms Intervalo en milisegundos (se ignoran valores no positivos).
+ */
+void set_adaptive_max_interval(int max_interval_ms);
+
+/**
+ * @brief Devuelve el intervalo máximo al que se espacia una tarea.
+ *
+ * @return Intervalo en milisegundos.
+ */
+int adaptive_max_interval_ms();
+
+/**
+ * @brief Compara el lote de una ejecución con el anterior de la misma tarea y lo guarda para la siguiente.
+ *
+ * Sin reglas configuradas vuelve de inmediato con ADAPTIVE_NONE, sin recorrer el lote.
+ *
+ * @param state Estado de la tarea.
+ * @param batch Lote recién armado.
+ * @param now_ns Instante de CLOCK_MONOTONIC del lote.
+ * @return Resultado de la comparación.
+ */
+adaptive_result_t adaptive_evaluate(adaptive_state_t* state, const metric_batch_t* batch, unsigned long long now_ns);
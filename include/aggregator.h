@@ -0,0 +1,128 @@
+/**
+ * @file aggregator.h
+ * @brief Modo agregador: recibe las muestras que envían muchos agentes y expone series resumidas por grupo.
+ *
+ * Los agentes envían sus lotes con el modo "influx" de push.h (line protocol sobre UDP) a la dirección del agregador.
+ * Un hilo propio vacía el socket sin bloquear y guarda el último valor de cada serie por host, identificando al host
+ * por la dirección de origen del datagrama; cada host pertenece al primer grupo (rack, cluster) cuyos patrones
+ * coinciden con su dirección. En cada intervalo se calculan, por serie y por grupo, la suma, el máximo, la cantidad de
+ * hosts y los cuantiles configurados, y el texto resultante se agrega a /metrics a través de la caché de la
+ * exposición. Prometheus scrapea solo al agregador: una serie por grupo en lugar de una por host.
+ *
+ * Las familias resumidas llevan el prefijo AGGREGATOR_PREFIX: el agregador puede además recolectar sus propias
+ * métricas, y un mismo nombre no puede aparecer como gauge del host y como summary del grupo en la misma exposición.
+ */
+
+#pragma once
+#include "arena.h"
+#include <stddef.h>
+
+/**
+ * @brief Dirección de escucha si config.json no indica otra (el puerto de line protocol de InfluxDB).
+ */
+#define AGGREGATOR_DEFAULT_LISTEN "0.0.0.0:8089"
+
+/**
+ * @brief Prefijo de las familias resumidas: cpu_usage_percentage se expone como aggregate_cpu_usage_percentage
+ * (summary) y aggregate_cpu_usage_percentage_max (gauge).
+ */
+#define AGGREGATOR_PREFIX "aggregate_"
+
+/**
+ * @brief Nombre de la etiqueta del grupo si config.json no indica otro.
+ */
+#define AGGREGATOR_DEFAULT_GROUP_LABEL "group"
+
+/**
+ * @brief Grupo de los hosts que no coinciden con ningún patrón.
+ */
+#define AGGREGATOR_DEFAULT_GROUP "other"
+
+/**
+ * @brief Intervalo entre cálculos de las series resumidas si config.json no indica otro, en milisegundos.
+ */
+#define AGGREGATOR_DEFAULT_INTERVAL_MS 1000
+
+/**
+ * @brief Tiempo sin muestras tras el cual el valor de un host deja de contar, en milisegundos.
+ */
+#define AGGREGATOR_DEFAULT_STALE_MS 30000
+
+/**
+ * @brief Cantidad máxima de grupos configurados.
+ */
+#define AGGREGATOR_MAX_GROUPS 64
+
+/**
+ * @brief Cantidad máxima de patrones por grupo.
+ */
+#define AGGREGATOR_MAX_PATTERNS 16
+
+/**
+ * @brief Cantidad máxima de cuantiles.
+ */
+#define AGGREGATOR_MAX_QUANTILES 8
+
+/**
+ * @brief Cantidad máxima de hosts seguidos.
+ */
+#define AGGREGATOR_MAX_HOSTS 8192
+
+/**
+ * @brief Cantidad máxima de series seguidas.
+ */
+#define AGGREGATOR_MAX_SERIES 16384
+
+/**
+ * @brief Grupo de hosts.
+ */
+typedef struct
+{
+    const char* name;         ///< Valor de la etiqueta del grupo (por ejemplo "rack-a").
+    const char* const* hosts; ///< Patrones fnmatch sobre la dirección del host ("10.0.1.*").
+    int host_count;           ///< Cantidad de patrones.
+} aggregator_group_t;
+
+/**
+ * @brief Opciones del agregador, leídas de config.json al arrancar.
+ */
+typedef struct
+{
+    const char* listen;               ///< host:puerto UDP de escucha, o NULL para AGGREGATOR_DEFAULT_LISTEN.
+    const char* group_label;          ///< Nombre de la etiqueta del grupo, o NULL para el de por defecto.
+    const aggregator_group_t* groups; ///< Grupos, en orden de prioridad.
+    int group_count;                  ///< Cantidad de grupos.
+    const double* quantiles;          ///< Cuantiles entre 0 y 1, o NULL para 0.5, 0.9 y 0.99.
+    int quantile_count;               ///< Cantidad de cuantiles.
+    int interval_ms;                  ///< Intervalo entre cálculos, o 0 para el de por defecto.
+    int stale_ms;                     ///< Vigencia del valor de un host, o 0 para la de por defecto.
+} aggregator_options_t;
+
+/**
+ * @brief Abre el socket e inicia el hilo del agregador.
+ *
+ * @param options Opciones; se copian, así que pueden liberarse al volver.
+ * @return 0 en caso de éxito, -1 si la dirección no es válida o no se pudo crear el hilo.
+ */
+int aggregator_start(const aggregator_options_t* options);
+
+/**
+ * @brief Detiene el hilo del agregador y libera sus tablas.
+ */
+void aggregator_stop();
+
+/**
+ * @brief Número de cálculos publicados; cambia cada vez que cambia el texto de las series resumidas.
+ *
+ * @return Generación, o 0 si el agregador no está en ejecución.
+ */
+unsigned long long aggregator_generation();
+
+/**
+ * @brief Agrega al final de una exposición el texto de las series resumidas del último cálculo.
+ *
+ * @param body Exposición.
+ * @param arena Arena del scrape, de la que sale la exposición agrandada.
+ * @return body si no hay series resumidas, la exposición agrandada, o NULL si no hay memoria.
+ */
+const char* aggregator_append(const char* body, arena_t* arena);
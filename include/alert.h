@@ -0,0 +1,143 @@
+/**
+ * @file alert.h
+ * @brief Alertas por umbral evaluadas dentro del monitor sobre cada instantánea publicada.
+ *
+ * Cada regla de config.json es una expresión como `cpu_usage_percentage{cpu="all"} > 90 for 5s`: una métrica con
+ * filtros opcionales por etiqueta (= o !=), una comparación (>, >=, <, <=, == o !=) contra un número y, opcionalmente,
+ * cuánto tiempo tiene que cumplirse antes de disparar. Una regla sigue a lo sumo ALERT_MAX_SERIES series a la vez:
+ * las demás que cumplen la condición se ignoran hasta que alguna se resuelva, y se cuentan en
+ * monitor_alert_series_dropped_total. Las reglas se compilan al aplicar la configuración en un
+ * arreglo plano de predicados, y cada instantánea de monitor_snapshot.h se recorre una vez comparando cada muestra con
+ * los predicados de su métrica. Cada serie que cumple la condición tiene su propio estado: pendiente mientras no pasa
+ * el plazo de "for", disparada después y resuelta cuando deja de cumplirse o desaparece de la instantánea.
+ *
+ * La evaluación no hace E/S: los cambios de estado se copian a una cola acotada y un hilo propio los envía como JSON
+ * a un webhook HTTP y/o a un socket unix de datagramas, de modo que un receptor lento nunca demora a las tareas de
+ * recolección. Los contadores se comparan por su valor absoluto.
+ */
+
+#pragma once
+#include "metric_store.h"
+#include <stdint.h>
+
+/**
+ * @brief Cantidad máxima de reglas.
+ */
+#define MAX_ALERT_RULES 32
+
+/**
+ * @brief Tamaño del nombre de una regla.
+ */
+#define ALERT_NAME_SIZE 64
+
+/**
+ * @brief Tamaño de la expresión de una regla.
+ */
+#define ALERT_EXPR_SIZE 160
+
+/**
+ * @brief Series que una regla sigue a la vez (pendientes o disparadas); las demás se ignoran hasta que haya lugar y
+ * se cuentan en alert_series_dropped().
+ */
+#define ALERT_MAX_SERIES 32
+
+/**
+ * @brief Capacidad de la cola de notificaciones; llena, descarta las más viejas.
+ */
+#define ALERT_QUEUE_SIZE 256
+
+/**
+ * @brief Intentos de envío de una notificación al webhook antes de descartarla.
+ */
+#define ALERT_MAX_ATTEMPTS 4
+
+/**
+ * @brief Espera antes del primer reintento, en milisegundos; se duplica en cada intento.
+ */
+#define ALERT_RETRY_BASE_MS 500
+
+/**
+ * @brief Plazo de conexión, envío y respuesta de cada intento, en milisegundos.
+ */
+#define ALERT_TIMEOUT_MS 2000
+
+/**
+ * @brief Tamaño máximo del JSON de una notificación.
+ */
+#define ALERT_MESSAGE_SIZE 2048
+
+/**
+ * @brief Destino final de una notificación, usado como etiqueta "result" de monitor_alert_notifications_total.
+ */
+typedef enum
+{
+    ALERT_RESULT_SENT,    ///< Entregada a todos los destinos configurados.
+    ALERT_RESULT_DROPPED, ///< Descartada por cola llena.
+    ALERT_RESULT_FAILED,  ///< Descartada tras agotar los intentos o por un rechazo permanente.
+    ALERT_RESULT_COUNT    ///< Cantidad de resultados.
+} alert_result_t;
+
+/**
+ * @brief Regla de alerta tal como aparece en config.json.
+ */
+typedef struct
+{
+    const char* name; ///< Nombre de la regla, incluido en cada notificación.
+    const char* expr; ///< Expresión, por ejemplo `cpu_usage_percentage > 90 for 5s`.
+} alert_rule_t;
+
+/**
+ * @brief Compila y reemplaza las reglas.
+ *
+ * Las reglas inválidas se informan por stderr y se omiten. Una regla con el mismo nombre y la misma expresión que una
+ * anterior conserva el estado de sus series; las series disparadas de una regla que se quita o cambia se notifican
+ * como resueltas.
+ *
+ * @param list Reglas (se copian).
+ * @param count Cantidad de reglas; se usan a lo sumo MAX_ALERT_RULES.
+ */
+void set_alert_rules(const alert_rule_t* list, int count);
+
+/**
+ * @brief Se suscribe a las instantáneas e inicia el hilo que envía las notificaciones.
+ *
+ * @param webhook URL http://host[:puerto]/ruta que recibe un POST por notificación, o NULL.
+ * @param socket_path Ruta de un socket unix de datagramas que recibe una línea JSON por notificación, o NULL.
+ * @return 0 en caso de éxito, -1 si no hay destino, alguno no es válido o no se pudo crear el hilo.
+ */
+int alert_start(const char* webhook, const char* socket_path);
+
+/**
+ * @brief Cancela la suscripción y detiene el hilo de envío; las notificaciones pendientes se descartan.
+ */
+void alert_stop();
+
+/**
+ * @brief Series disparadas en este momento, sumadas en todas las reglas; se puede leer desde cualquier hilo.
+ *
+ * @return Cantidad de series.
+ */
+int alert_firing_count();
+
+/**
+ * @brief Totales de notificaciones por resultado desde el arranque; se pueden leer desde cualquier hilo.
+ *
+ * @param counts Totales, indexados por alert_result_t.
+ */
+void alert_counters(unsigned long long counts[ALERT_RESULT_COUNT]);
+
+/**
+ * @brief Muestras ignoradas desde el arranque porque su regla ya seguía ALERT_MAX_SERIES series; se puede leer desde
+ * cualquier hilo.
+ *
+ * @return Cantidad de muestras (una serie ignorada suma una por instantánea).
+ */
+unsigned long long alert_series_dropped();
+
+/**
+ * @brief Nombre de un resultado para la etiqueta "result".
+ *
+ * @param result Resultado.
+ * @return Nombre.
+ */
+const char* alert_result_name(alert_result_t result);
@@ -0,0 +1,100 @@
+/**
+ * @file arena.h
+ * @brief Arena de reserva lineal para los buffers temporales de un ciclo o de un scrape.
+ *
+ * Las reservas se toman de bloques grandes avanzando un puntero y nunca se liberan de a una: arena_reset() descarta
+ * todo lo del ciclo de una vez. Si un ciclo necesitó más de un bloque, el reinicio los reemplaza por uno solo con la
+ * capacidad de todos, así que después del primer ciclo de cada tamaño la arena deja de pedirle memoria al heap.
+ */
+
+#pragma once
+#include <stddef.h>
+
+/**
+ * @brief Capacidad mínima de un bloque.
+ */
+#define ARENA_BLOCK_SIZE 65536
+
+/**
+ * @brief Capacidad máxima que conserva arena_reset(); un pico mayor (una consulta enorme) se devuelve al heap.
+ */
+#define ARENA_RETAIN_MAX (16 * 1024 * 1024)
+
+/**
+ * @brief Alineación de las reservas.
+ */
+#define ARENA_ALIGN 16
+
+/**
+ * @brief Bloque de la arena (definido en arena.c).
+ */
+typedef struct arena_block arena_block_t;
+
+/**
+ * @brief Arena; inicializada en cero está vacía y lista para usar.
+ */
+typedef struct
+{
+    arena_block_t* head; ///< Bloque en uso, con los anteriores encadenados detrás.
+    size_t capacity;     ///< Suma de las capacidades de los bloques.
+} arena_t;
+
+/**
+ * @brief Texto que crece dentro de una arena.
+ */
+typedef struct
+{
+    arena_t* arena; ///< Arena de la que sale el buffer.
+    char* data;     ///< Contenido, terminado en '\0'; NULL hasta la primera escritura.
+    size_t len;     ///< Bytes válidos sin contar el '\0'.
+    size_t cap;     ///< Capacidad de data.
+    int failed;     ///< 1 si alguna escritura no tuvo memoria; el contenido queda truncado.
+} arena_str_t;
+
+/**
+ * @brief Reserva memoria de la arena.
+ *
+ * @param arena Arena.
+ * @param size Bytes.
+ * @return Memoria alineada a ARENA_ALIGN, válida hasta arena_reset(), o NULL si no hay memoria.
+ */
+void* arena_alloc(arena_t* arena, size_t size);
+
+/**
+ * @brief Descarta todas las reservas, conservando la capacidad en un único bloque hasta ARENA_RETAIN_MAX.
+ *
+ * @param arena Arena.
+ */
+void arena_reset(arena_t* arena);
+
+/**
+ * @brief Libera los bloques de la arena.
+ *
+ * @param arena Arena; queda vacía y se puede volver a usar.
+ */
+void arena_free(arena_t* arena);
+
+/**
+ * @brief Inicia un texto vacío en una arena.
+ *
+ * @param str Texto.
+ * @param arena Arena.
+ */
+void arena_str_init(arena_str_t* str, arena_t* arena);
+
+/**
+ * @brief Agrega bytes a un texto; si es la última reserva de la arena crece en el lugar.
+ *
+ * @param str Texto.
+ * @param data Bytes.
+ * @param len Cantidad de bytes.
+ */
+void arena_str_append(arena_str_t* str, const char* data, size_t len);
+
+/**
+ * @brief Agrega texto con formato de printf.
+ *
+ * @param str Texto.
+ * @param fmt Formato.
+ */
+void arena_str_printf(arena_str_t* str, const char* fmt, ...) __attribute__((format(printf, 2, 3)));
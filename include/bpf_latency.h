@@ -0,0 +1,40 @@
+/**
+ * @file bpf_latency.h
+ * @brief Histogramas de latencia de la cola de ejecución y de E/S de bloque armados en el kernel con eBPF.
+ *
+ * Un programa eBPF embebido en el ejecutable se engancha a sched_wakeup, sched_wakeup_new y sched_switch, y a
+ * block_rq_issue y block_rq_complete, y suma cada latencia a un histograma log2 por CPU. En cada ciclo solo se leen
+ * los dos mapas de histogramas: las distribuciones completas cuestan lo mismo que leer un archivo de /proc, sin
+ * importar cuántos eventos hubo. Es opcional: sin libbpf al compilar, o sin CAP_BPF y CAP_PERFMON al correr, la
+ * fuente queda vacía y las métricas no se publican.
+ */
+
+#pragma once
+#include "bpf_latency_maps.h"
+#include "proc_snapshot.h"
+
+/**
+ * @brief Histograma sumando todas las CPUs, con los totales desde que se cargó el programa.
+ */
+typedef struct bpf_latency_slots bpf_latency_hist_t;
+
+/**
+ * @brief Límite superior de una cubeta en segundos (etiqueta "le").
+ *
+ * @param slot Cubeta.
+ * @return 2^(slot+1) microsegundos, en segundos.
+ */
+double bpf_latency_slot_bound(int slot);
+
+/**
+ * @brief Lee los histogramas; la primera vez carga y engancha el programa eBPF.
+ *
+ * @param snap Instantánea a completar; proc_snapshot_t::latency queda en NULL si eBPF no está disponible.
+ * @return 0 siempre: la falta de eBPF se informa una sola vez y no es un error de la fuente.
+ */
+int bpf_latency_scan(proc_snapshot_t* snap);
+
+/**
+ * @brief Desengancha el programa y libera sus mapas.
+ */
+void bpf_latency_close();
@@ -0,0 +1,33 @@
+/**
+ * @file bpf_latency_maps.h
+ * @brief Formato de los mapas compartido por el programa eBPF (src/bpf/latency.bpf.c) y bpf_latency.c.
+ *
+ * No incluye nada de la biblioteca de C: el programa del kernel se compila con clang -target bpf.
+ */
+
+#pragma once
+
+/**
+ * @brief Cubetas log2 en microsegundos: la cubeta s cuenta latencias menores que 2^(s+1) us (hasta unos 134 s).
+ */
+#define BPF_LATENCY_SLOTS 27
+
+/**
+ * @brief Distribuciones medidas, usadas como clave del mapa latency_hists.
+ */
+enum bpf_latency_kind
+{
+    BPF_LATENCY_RUNQUEUE, ///< Desde sched_wakeup (o una expropiación) hasta que la tarea vuelve a correr.
+    BPF_LATENCY_BLOCK,    ///< Desde block_rq_issue hasta block_rq_complete.
+    BPF_LATENCY_COUNT
+};
+
+/**
+ * @brief Valor de latency_hists: una copia por CPU, que el programa incrementa sin operaciones atómicas.
+ */
+struct bpf_latency_slots
+{
+    unsigned long long slots[BPF_LATENCY_SLOTS]; ///< Observaciones por cubeta (no acumuladas).
+    unsigned long long count;                    ///< Observaciones totales.
+    unsigned long long sum_ns;                   ///< Suma de las latencias en nanosegundos.
+};
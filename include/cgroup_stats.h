@@ -0,0 +1,79 @@
+/**
+ * @file cgroup_stats.h
+ * @brief Uso de CPU, memoria y E/S por cgroup v2 (cpu.stat, memory.current e io.stat).
+ *
+ * Se recorre la jerarquía de /sys/fs/cgroup (o /sys/fs/cgroup/unified en modo híbrido) hasta una profundidad
+ * configurable y cada cgroup se guarda en una tabla persistente indexada por su ruta relativa, con un tope de cgroups
+ * seguidos que acota la cantidad de series.
+ */
+
+#pragma once
+#include "proc_snapshot.h"
+
+/**
+ * @brief Raíz de la jerarquía unificada de cgroup v2.
+ */
+#define CGROUP_ROOT "/sys/fs/cgroup"
+
+/**
+ * @brief Raíz de cgroup v2 en los sistemas en modo híbrido, donde CGROUP_ROOT contiene las jerarquías v1.
+ */
+#define CGROUP_HYBRID_ROOT "/sys/fs/cgroup/unified"
+
+/**
+ * @brief Tamaño de la ruta de un cgroup relativa a la raíz de cgroup v2.
+ */
+#define CGROUP_PATH_SIZE 256
+
+/**
+ * @brief Cantidad máxima de cgroups seguidos a la vez.
+ */
+#define CGROUP_MAX_GROUPS 256
+
+/**
+ * @brief Profundidad de la jerarquía si config.json no indica otra (por ejemplo "system.slice/docker-X.scope").
+ */
+#define CGROUP_DEFAULT_DEPTH 2
+
+/**
+ * @brief Profundidad máxima configurable.
+ */
+#define CGROUP_MAX_DEPTH 8
+
+/**
+ * @brief Estado persistente de un cgroup entre ciclos.
+ */
+typedef struct cgroup_usage
+{
+    char path[CGROUP_PATH_SIZE];          ///< Ruta relativa a la raíz: clave de la tabla y etiqueta "cgroup".
+    unsigned int last_seen;               ///< Último ciclo en el que apareció el cgroup.
+    int has_prev;                         ///< 1 si hay una lectura anterior para calcular tasas.
+    unsigned long long prev_timestamp_ns; ///< Instante de la lectura anterior.
+    unsigned long long usage_usec;        ///< usage_usec de cpu.stat.
+    unsigned long long memory_current;    ///< memory.current en bytes (0 si el controlador no está habilitado).
+    unsigned long long read_bytes;        ///< Suma de rbytes de io.stat en todos los dispositivos.
+    unsigned long long write_bytes;       ///< Suma de wbytes de io.stat en todos los dispositivos.
+    double cpu_percent;                   ///< Uso de CPU desde el ciclo anterior (100 = un núcleo).
+    double read_bytes_per_second;         ///< Tasa de lectura desde el ciclo anterior.
+    double write_bytes_per_second;        ///< Tasa de escritura desde el ciclo anterior.
+} cgroup_usage_t;
+
+/**
+ * @brief Recorre la jerarquía de cgroups y actualiza los cgroups de la instantánea.
+ *
+ * @param snap Instantánea a completar; proc_snapshot_t::timestamp_ns debe estar cargado.
+ * @return 0 en caso de éxito, -1 si no hay una jerarquía de cgroup v2 montada.
+ */
+int cgroup_scan(proc_snapshot_t* snap);
+
+/**
+ * @brief Configura hasta qué profundidad de la jerarquía se siguen cgroups.
+ *
+ * @param depth Profundidad entre 1 y CGROUP_MAX_DEPTH; los valores fuera de rango se recortan.
+ */
+void set_cgroup_depth(int depth);
+
+/**
+ * @brief Libera la tabla de cgroups.
+ */
+void cgroup_close();
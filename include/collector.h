@@ -0,0 +1,54 @@
+/**
+ * @file collector.h
+ * @brief Recolección en paralelo: tareas independientes por fuente de /proc ejecutadas por un pool de hilos.
+ *
+ * Cada tarea lee solo su fuente de /proc en una instantánea propia y actualiza las métricas que dependen de ella,
+ * con su propio intervalo y plazo. Un hilo despachador encola las tareas vencidas y COLLECTOR_WORKERS hilos las
+ * ejecutan, de modo que una lectura lenta (por ejemplo un /proc/diskstats colgado) solo demora a su tarea. Una
+ * tarea nunca se encola de nuevo mientras sigue en ejecución.
+ */
+
+#pragma once
+
+/**
+ * @brief Cantidad de hilos que ejecutan tareas.
+ */
+#define COLLECTOR_WORKERS 3
+
+/**
+ * @brief Intervalo por defecto de las tareas en milisegundos, hasta que se lea la configuración.
+ */
+#define COLLECTOR_DEFAULT_INTERVAL_MS 1000
+
+/**
+ * @brief Inicia el hilo despachador y los hilos del pool.
+ *
+ * @return 0 en caso de éxito, -1 en caso de error.
+ */
+int collectors_start();
+
+/**
+ * @brief Detiene el despachador y espera a que los hilos del pool terminen su tarea en curso.
+ */
+void collectors_stop();
+
+/**
+ * @brief Cambia el intervalo de las tareas que no tienen uno propio configurado.
+ *
+ * @param interval_ms Intervalo en milisegundos (se ignoran valores no positivos).
+ */
+void set_collector_default_interval(int interval_ms);
+
+/**
+ * @brief Configura el intervalo y el plazo de una tarea.
+ *
+ * El plazo se cuenta desde que la tarea se encola; si la tarea no terminó al vencer se incrementa su contador de
+ * timeouts. Con 0 se usa el intervalo por defecto y un plazo igual al intervalo.
+ *
+ * @param name Nombre de la tarea, el mismo que acepta el objeto "collectors" de config.json: "cpu", "memory",
+ * "vmstat", "disk", "network", "pressure", "processes", "cgroups", "latency" o "filesystem".
+ * @param interval_ms Intervalo en milisegundos, o 0 para el de por defecto.
+ * @param deadline_ms Plazo en milisegundos, o 0 para usar el intervalo.
+ * @return 0 en caso de éxito, -1 si no existe la tarea.
+ */
+int set_collector_schedule(const char* name, int interval_ms, int deadline_ms);
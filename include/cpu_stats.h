@@ -0,0 +1,101 @@
+/**
+ * @file cpu_stats.h
+ * @brief Utilización de CPU por núcleo a partir de las líneas "cpu" y "cpuN" de /proc/stat.
+ *
+ * Los contadores se guardan como estructura de arreglos contigua indexada por modo y columna (la columna 0 es el
+ * agregado "all" y la columna N + 1 es la CPU N), de modo que los deltas y porcentajes de todos los núcleos se
+ * calculan en bucles planos que el compilador puede vectorizar. Toda la memoria se reserva en cpu_stats_init().
+ */
+
+#pragma once
+#include "scan.h"
+
+/**
+ * @brief Modos de tiempo de CPU en el orden en que aparecen en /proc/stat.
+ */
+enum cpu_mode
+{
+    CPU_MODE_USER,
+    CPU_MODE_NICE,
+    CPU_MODE_SYSTEM,
+    CPU_MODE_IDLE,
+    CPU_MODE_IOWAIT,
+    CPU_MODE_IRQ,
+    CPU_MODE_SOFTIRQ,
+    CPU_MODE_STEAL,
+    CPU_MODE_COUNT
+};
+
+/**
+ * @brief Fila adicional de porcentajes con el tiempo ocupado (todo salvo idle e iowait).
+ */
+#define CPU_MODE_BUSY CPU_MODE_COUNT
+
+/**
+ * @brief Cantidad de filas de porcentajes (los modos más "busy").
+ */
+#define CPU_PERCENT_COUNT (CPU_MODE_COUNT + 1)
+
+/**
+ * @brief Tamaño de la etiqueta "cpu" de cada columna.
+ */
+#define CPU_LABEL_SIZE 12
+
+/**
+ * @brief Contadores por CPU y modo, y porcentajes del último intervalo.
+ */
+typedef struct
+{
+    int columns;                     ///< CPUs configuradas + 1 (la columna 0 es el agregado).
+    unsigned long long* cur;         ///< Buffer de la lectura en curso, [CPU_MODE_COUNT][columns].
+    unsigned long long* prev;        ///< Última lectura ya procesada por cpu_stats_compute(), mismo formato.
+    double* scale;                   ///< 100 / delta total de cada columna (0 si no hubo intervalo), [columns].
+    double* percent;                 ///< Porcentajes del último intervalo, [CPU_PERCENT_COUNT][columns].
+    unsigned char* present;          ///< 1 si la columna apareció en la última lectura, [columns].
+    char (*labels)[CPU_LABEL_SIZE];  ///< Etiqueta "cpu" preasignada de cada columna ("all", "0", "1", ...).
+    int has_prev;                    ///< 1 si prev contiene una lectura anterior.
+} cpu_stats_t;
+
+/**
+ * @brief Nombres de los modos usados como etiqueta "mode", indexados por fila de porcentajes.
+ */
+extern const char* const cpu_mode_labels[CPU_PERCENT_COUNT];
+
+/**
+ * @brief Reserva los arreglos según la cantidad de CPUs configuradas y prepara las etiquetas.
+ *
+ * @param cpus CPUs de la instantánea, o 0 para las configuradas en el sistema (las de un fixture pueden ser más).
+ * @return 0 en caso de éxito, -1 en caso de error.
+ */
+int cpu_stats_init(long cpus);
+
+/**
+ * @brief Libera la memoria reservada por cpu_stats_init().
+ */
+void cpu_stats_close();
+
+/**
+ * @brief Marca el comienzo de una lectura de /proc/stat.
+ */
+void cpu_stats_begin();
+
+/**
+ * @brief Guarda los contadores de una línea "cpu" en la columna indicada.
+ *
+ * @param column Columna (0 para el agregado, N + 1 para la CPU N).
+ * @param line Cursor ubicado después del nombre de la línea.
+ * @return 0 en caso de éxito, -1 si la línea es inválida o la columna está fuera de rango.
+ */
+int cpu_stats_store(int column, scan_t* line);
+
+/**
+ * @brief Calcula deltas y porcentajes de todas las columnas y rota los contadores.
+ */
+void cpu_stats_compute();
+
+/**
+ * @brief Devuelve la tabla de contadores y porcentajes.
+ *
+ * @return Tabla de CPU, o NULL si cpu_stats_init() no se llamó.
+ */
+const cpu_stats_t* get_cpu_stats();
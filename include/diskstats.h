@@ -0,0 +1,45 @@
+/**
+ * @file diskstats.h
+ * @brief Parser nativo de /proc/diskstats para todos los dispositivos de bloque.
+ *
+ * Cubre cualquier dispositivo (sd*, vd*, nvme*, dm-*, md*, ...) en lugar de solo 'sda', filtra con una lista de
+ * dispositivos permitidos configurable desde config.json ("disk_devices") y calcula las tasas de lectura y
+ * escritura en bytes por segundo de cada dispositivo.
+ */
+
+#pragma once
+#include "proc_snapshot.h"
+
+/**
+ * @brief Cantidad máxima de patrones en la lista de dispositivos permitidos.
+ */
+#define MAX_DISK_ALLOWLIST 16
+
+/**
+ * @brief Parsea /proc/diskstats y completa los dispositivos seleccionados de la instantánea.
+ *
+ * Además de proc_snapshot_t::disks guarda en la instantánea la suma de lecturas, escrituras y sectores de los
+ * dispositivos seleccionados, que usan get_disk_stats() y get_disk_usage().
+ *
+ * @param snap Instantánea a completar; proc_snapshot_t::timestamp_ns debe estar cargado.
+ * @param buf Contenido de /proc/diskstats.
+ * @param len Bytes válidos de buf.
+ * @return 0 en caso de éxito, -1 en caso de error.
+ */
+int parse_diskstats(proc_snapshot_t* snap, const char* buf, size_t len);
+
+/**
+ * @brief Reemplaza la lista de dispositivos permitidos.
+ *
+ * Cada patrón se compara con fnmatch(), por lo que se admiten comodines como "nvme*" o "dm-*". Con una lista vacía
+ * se seleccionan los discos completos listados en block/ de snapshot_sys_root(), excluyendo loop*, ram* y zram*.
+ *
+ * @param patterns Patrones de nombres de dispositivo.
+ * @param count Cantidad de patrones (se truncan a MAX_DISK_ALLOWLIST).
+ */
+void set_disk_allowlist(const char** patterns, int count);
+
+/**
+ * @brief Vacía la tabla de dispositivos, con sus selecciones resueltas y sus lecturas anteriores.
+ */
+void diskstats_close();
@@ -6,17 +6,29 @@
  * el uso de CPU, memoria, disco, red y más. Las métricas se exponen vía HTTP utilizando Prometheus.
  */
 
+#include "exposition_cache.h"
+#include "history.h"
+#include "metric_registry.h"
+#include "metric_store.h"
 #include "metrics.h"
+#include "monitor_stats.h"
+#include "push.h"
+#include "strmap.h"
 // #include "read_cpu_usage.h"
 #include "json_cfg.h"
 #include <errno.h>
+#ifdef MONITOR_BUILTIN_EXPOSITION
+#include "http_lite.h"
+#include "prom_lite.h"
+#else
 #include <prom.h>
 #include <promhttp.h>
+#endif
 #include <pthread.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
-#include <unistd.h> // Para sleep
+#include <unistd.h>
 
 /**
  * @brief Tamaño del buffer utilizado para leer archivos o datos.
@@ -24,14 +36,41 @@
 #define BUFFER_SIZE 256
 
 /**
- * @brief Tiempo para que el proceso duerma 1
+ * @brief Dirección de escucha si config.json no indica otra (todas las interfaces IPv4).
  */
-#define SLEEP_TIME 1
+#define HTTP_DEFAULT_BIND "0.0.0.0"
 
 /**
- * @brief Puerto 8000
+ * @brief Modos del servidor HTTP aceptados en config.json.
  */
-#define PUERTO 8000
+#define HTTP_MODE_EPOLL "epoll"
+#define HTTP_MODE_THREAD_PER_CONNECTION "thread_per_connection"
+#define HTTP_MODE_SELECT "select"
+
+/**
+ * @brief Puerto del servidor HTTP si config.json no indica otro.
+ */
+#define HTTP_DEFAULT_PORT 8000
+
+/**
+ * @brief Hilos del servidor en modo epoll si config.json no indica otra cantidad.
+ */
+#define HTTP_DEFAULT_THREADS 2
+
+/**
+ * @brief Segundos que una conexión keep-alive puede quedar inactiva antes de que el servidor la cierre.
+ */
+#define HTTP_DEFAULT_CONNECTION_TIMEOUT 30
+
+/**
+ * @brief Conexiones simultáneas si config.json no indica otra cantidad.
+ */
+#define HTTP_DEFAULT_CONNECTION_LIMIT 256
+
+/**
+ * @brief Largo de la cola de conexiones pendientes del socket de escucha.
+ */
+#define HTTP_DEFAULT_BACKLOG 128
 
 /**
  * @brief Valor minimo 0 para verificar que un valor es positivo
@@ -39,110 +78,154 @@
 #define MIN_VALUE 0
 
 /**
- * @brief Actualiza la métrica de memoria disponible.
- *
- * Lee el valor de memoria disponible desde /proc/meminfo y actualiza el gauge correspondiente de Prometheus.
+ * @brief Límite superior de la primera cubeta de los histogramas monitor_*, en segundos.
  */
-void update_memory_avalible_gauge();
+#define MONITOR_BUCKET_START 0.00005
 
 /**
- * @brief Actualiza la métrica de memoria total.
- *
- * Lee el valor de memoria total desde /proc/meminfo y actualiza el gauge correspondiente de Prometheus.
+ * @brief Cubetas de los histogramas monitor_*; cada una duplica a la anterior.
  */
-void update_memory_total_gauge();
+#define MONITOR_BUCKET_COUNT 16
 
 /**
- * @brief Actualiza la métrica de memoria en uso (no expresada como porcentaje).
- *
- * Lee el valor de memoria en uso desde /proc/meminfo y actualiza el gauge correspondiente de Prometheus.
+ * @brief Ruta en la que se sirven las métricas.
  */
-void update_memory_2_gauge();
+#define METRICS_PATH "/metrics"
 
 /**
- * @brief Actualiza la métrica de estadística de disco.
+ * @brief Ruta en la que se sirve el historial de muestras.
  *
- * Lee el valor total de lecturas y escrituras de disco desde /proc/diskstats y actualiza el gauge correspondiente de
- * Prometheus.
+ * Recibe metric (nombre o patrón fnmatch) y, opcionalmente, start y end en milisegundos desde la época.
  */
-void update_disk_stats_gauge();
+#define HISTORY_PATH "/history"
 
 /**
- * @brief Actualiza la métrica de la cantidad total de procesos del sistema.
- *
- * Lee el valor de procesos totales desde /proc/stat y actualiza el gauge correspondiente de Prometheus.
+ * @brief Tipo de contenido de las respuestas del historial.
  */
-void update_total_processes_gauge();
+#define JSON_CONTENT_TYPE "application/json"
 
 /**
- * @brief Actualiza la métrica de cambios de contexto del sistema.
- *
- * Lee el valor de cambios de contexto desde /proc/stat y actualiza el gauge correspondiente de Prometheus.
+ * @brief Tipo de contenido de la exposición de texto de Prometheus.
  */
-void update_change_context_gauge();
+#define CONTENT_TYPE "text/plain; version=0.0.4"
 
 /**
- * @brief Actualiza la métrica de uso de CPU.
- *
- * Lee el porcentaje de uso de CPU desde /proc/stat y actualiza el gauge correspondiente de Prometheus.
+ * @brief Tipo de retorno de los manejadores de microhttpd, que pasó de int a enum MHD_Result en 0.9.71.
  */
-void update_cpu_gauge();
+#if MHD_VERSION >= 0x00097002
+#define MHD_RESULT enum MHD_Result
+#else
+#define MHD_RESULT int
+#endif
 
 /**
- * @brief Actualiza la métrica de uso de memoria.
- *
- * Lee el porcentaje de uso de memoria desde /proc/meminfo y actualiza el gauge correspondiente de Prometheus.
+ * @brief Nombres de las banderas de microhttpd anteriores a 0.9.53.
  */
-void update_memory_gauge();
+#if MHD_VERSION < 0x00095300
+#define MHD_USE_EPOLL_INTERNAL_THREAD MHD_USE_EPOLL_INTERNALLY
+#define MHD_USE_POLL_INTERNAL_THREAD MHD_USE_POLL_INTERNALLY
+#define MHD_USE_INTERNAL_POLLING_THREAD MHD_USE_SELECT_INTERNALLY
+#define MHD_USE_ERROR_LOG MHD_USE_DEBUG
+#endif
 
 /**
- * @brief Actualiza la métrica de uso de disco.
+ * @brief Agrega al lote la duración, las ejecuciones, los timeouts y los ticks perdidos de una tarea de recolección.
  *
- * Lee el porcentaje de uso de disco desde /proc/diskstats y actualiza el gauge correspondiente de Prometheus.
+ * Alimenta collector_duration_seconds, collector_runs_total, collector_timeouts_total y
+ * collector_missed_ticks_total con la etiqueta "collector". Lo llama el despachador de collector.c.
+ *
+ * @param batch Lote del despachador.
+ * @param name Nombre de la tarea.
+ * @param duration_seconds Duración de la última ejecución completa.
+ * @param runs Ejecuciones completadas desde el arranque.
+ * @param timeouts Ejecuciones que superaron su plazo desde el arranque.
+ * @param missed_ticks Instantes de la grilla salteados porque la tarea seguía en ejecución.
+ * @param allocations Reservas del heap de sus ejecuciones, publicadas en monitor_collector_allocations_total solo si
+ * monitor_counts_allocations().
  */
-void update_disk_gauge();
+void update_collector_metrics(metric_batch_t* batch, const char* name, double duration_seconds,
+                              unsigned long long runs, unsigned long long timeouts, unsigned long long missed_ticks,
+                              unsigned long long allocations);
 
 /**
- * @brief Actualiza la métrica de uso de red.
+ * @brief Agrega al lote el intervalo de muestreo vigente de una métrica en metric_sampling_interval_seconds.
+ *
+ * Es el paso de la tarea que lee la fuente de la métrica, espaciado por el muestreo adaptativo (adaptive.h). Lo
+ * llama el despachador de collector.c junto con update_collector_metrics().
  *
- * Lee las estadísticas de red desde /proc/net/dev y actualiza el gauge correspondiente de Prometheus.
+ * @param batch Lote del despachador.
+ * @param metric Nombre de la métrica, usado como etiqueta "metric".
+ * @param interval_seconds Intervalo vigente en segundos.
  */
-void update_network_gauge();
+void update_sampling_interval_metric(metric_batch_t* batch, const char* metric, double interval_seconds);
 
 /**
- * @brief Actualiza la métrica de ancho de banda promedio.
+ * @brief Observa la duración de una ejecución en monitor_collector_duration_seconds.
  *
- * Calcula el ancho de banda en uso basado en /proc/net/dev y actualiza el gauge correspondiente de Prometheus.
+ * Lo llama cada hilo del pool al terminar una tarea; libprom serializa la observación con el lock del histograma.
+ *
+ * @param name Nombre de la tarea.
+ * @param duration_seconds Duración medida con monitor_clock_ns().
  */
-void update_bandwidth_gauge();
+void observe_collector_duration(const char* name, double duration_seconds);
 
 /**
- * @brief Actualiza la métrica de fallos de página mayores.
+ * @brief Agrega al lote las métricas monitor_* que no son histogramas.
+ *
+ * Alimenta monitor_proc_read_bytes_total, monitor_syscalls_total, monitor_resident_memory_bytes,
+ * monitor_push_samples_total, monitor_alert_notifications_total, monitor_alerts_firing,
+ * monitor_alert_series_dropped_total y, con MONITOR_COUNT_ALLOCATIONS, monitor_heap_allocations_total. Lo llama el
+ * despachador de collector.c junto con update_collector_metrics().
  *
- * Lee el número de fallos de página mayores desde /proc/vmstat y actualiza el gauge correspondiente de Prometheus.
+ * @param batch Lote del despachador.
  */
-void update_major_page_faults_gauge();
+void update_monitor_metrics(metric_batch_t* batch);
 
 /**
- * @brief Actualiza la métrica de fallos de página menores.
+ * @brief Renderiza la exposición: vuelca el almacén en el registro y lo formatea con libprom.
  *
- * Lee el número de fallos de página menores desde /proc/vmstat y actualiza el gauge correspondiente de Prometheus.
+ * El manejador HTTP la llama a través de exposition_cache.h; los benchmarks, directamente.
+ *
+ * @param arena Arena del scrape, de la que sale el texto.
+ * @return Texto válido hasta el próximo arena_reset(), o NULL en caso de error.
+ */
+const char* render_exposition(arena_t* arena);
+
+/**
+ * @brief Opciones del servidor HTTP; los campos en 0 o NULL toman los valores por defecto.
  */
-void update_minor_page_faults_gauge();
+typedef struct
+{
+    const char* bind;       ///< Dirección numérica IPv4 o IPv6 de escucha, o NULL para HTTP_DEFAULT_BIND.
+    int port;               ///< Puerto, o 0 para HTTP_DEFAULT_PORT.
+    const char* mode;       ///< "epoll", "thread_per_connection", "select" o NULL para epoll.
+    int threads;            ///< Hilos en modo epoll, o 0 para HTTP_DEFAULT_THREADS.
+    int connection_timeout; ///< Segundos de inactividad de una conexión keep-alive, o 0 para el valor por defecto.
+    int connection_limit;   ///< Conexiones simultáneas, o 0 para HTTP_DEFAULT_CONNECTION_LIMIT.
+    int backlog;            ///< Cola de conexiones pendientes, o 0 para HTTP_DEFAULT_BACKLOG.
+} http_options_t;
 
 /**
- * @brief Función del hilo para exponer las métricas vía HTTP en el puerto 8000.
+ * @brief Inicia el servidor HTTP que expone las métricas.
  *
- * Esta función es ejecutada por un hilo separado para exponer las métricas a través de HTTP en el puerto 8000.
- * @param arg Argumento no utilizado.
- * @return NULL
+ * microhttpd atiende las conexiones con sus propios hilos: en modo epoll, un grupo fijo de hilos con un epoll cada
+ * uno; en modo thread_per_connection, un hilo por conexión. Si la biblioteca no tiene epoll se usa poll.
+ *
+ * @param options Opciones del servidor, o NULL para los valores por defecto.
+ * @return 0 en caso de éxito, -1 si la dirección no es válida o no se pudo abrir el puerto.
+ */
+int expose_metrics_start(const http_options_t* options);
+
+/**
+ * @brief Detiene el servidor HTTP con MHD_stop_daemon(); espera a que terminen los scrapes en curso.
  */
-void* expose_metrics(void* arg);
+void expose_metrics_stop();
 
 /**
- * @brief Inicializa los mutex y las métricas de Prometheus.
+ * @brief Inicializa el mutex de los scrapes y las métricas de Prometheus.
  *
- * Esta función se encarga de inicializar los mutex necesarios y configurar las métricas de Prometheus.
+ * Esta función se encarga de inicializar los mutex necesarios y configurar las métricas de Prometheus. Se puede
+ * volver a llamar después de destroy_mutex() y snapshot_close(); las métricas se crean solo la primera vez.
  */
 void init_metrics();
 
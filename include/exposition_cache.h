@@ -0,0 +1,73 @@
+/**
+ * @file exposition_cache.h
+ * @brief Exposición de métricas renderizada una vez por ciclo de recolección y servida desde memoria.
+ *
+ * El texto de la exposición solo se vuelve a generar cuando el almacén de métricas publicó algo nuevo; mientras
+ * tanto todos los scrapes reciben el mismo buffer, su versión comprimida con gzip (calculada una única vez por
+ * render) y un ETag derivado del contenido, que permite responder 304 a los clientes que ya lo tienen. El render
+ * escribe en una arena propia de la caché que se reinicia apenas el texto se copia a la exposición vigente, así que
+ * después del primer scrape de cada tamaño renderizar no le pide memoria al heap.
+ */
+
+#pragma once
+#include "arena.h"
+#include <stddef.h>
+
+/**
+ * @brief Tamaño de un ETag entre comillas, incluyendo el sufijo de la variante gzip y el '\0'.
+ */
+#define EXPOSITION_ETAG_SIZE 32
+
+/**
+ * @brief Genera el texto de la exposición.
+ *
+ * @param arena Arena del scrape, de la que sale el texto.
+ * @return Texto válido hasta que la caché reinicia la arena (después de copiarlo), o NULL en caso de error.
+ */
+typedef const char* (*exposition_render_fn)(arena_t* arena);
+
+/**
+ * @brief Exposición renderizada.
+ */
+typedef struct
+{
+    char* body;                              ///< Texto de la exposición.
+    size_t body_len;                         ///< Longitud de body.
+    size_t body_cap;                         ///< Capacidad reservada de body.
+    unsigned char* gzip;                     ///< body comprimido con gzip, o NULL si no está disponible.
+    size_t gzip_len;                         ///< Longitud de gzip.
+    size_t gzip_cap;                         ///< Capacidad reservada de gzip.
+    char etag[EXPOSITION_ETAG_SIZE];         ///< ETag de body.
+    char gzip_etag[EXPOSITION_ETAG_SIZE];    ///< ETag de la variante gzip.
+    unsigned long long generation;           ///< Generación del almacén con la que se renderizó.
+    int valid;                               ///< 1 si ya hubo un render exitoso.
+} exposition_t;
+
+/**
+ * @brief Inicializa la caché.
+ *
+ * @return 0 en caso de éxito, -1 en caso de error.
+ */
+int exposition_cache_init();
+
+/**
+ * @brief Devuelve la exposición vigente, renderizándola antes si la generación cambió.
+ *
+ * La exposición devuelta queda fijada hasta llamar a exposition_cache_release(); mientras tanto ningún render la
+ * reemplaza, así que el llamador puede copiarla a la respuesta sin más locks.
+ *
+ * @param generation Generación actual del almacén (metric_store_generation()).
+ * @param render Función que genera el texto cuando hace falta.
+ * @return Exposición fijada, o NULL si nunca se pudo renderizar (en ese caso no hay que liberar nada).
+ */
+const exposition_t* exposition_cache_acquire(unsigned long long generation, exposition_render_fn render);
+
+/**
+ * @brief Libera la exposición fijada con exposition_cache_acquire().
+ */
+void exposition_cache_release();
+
+/**
+ * @brief Libera los buffers de la caché.
+ */
+void exposition_cache_close();
@@ -0,0 +1,95 @@
+/**
+ * @file fs_stats.h
+ * @brief Capacidad e inodos de los sistemas de archivos montados, con statvfs() y un plazo por montaje.
+ *
+ * La tabla de montajes sale de /proc/self/mountinfo, que se mantiene abierto y solo se vuelve a parsear cuando poll()
+ * informa un cambio (POLLPRI), así que en régimen estable cada ciclo cuesta un poll() y un statvfs() por montaje
+ * seleccionado. Los statvfs() corren en un hilo auxiliar y el recolector espera cada uno hasta un plazo: un montaje
+ * NFS colgado deja de consultarse hasta que su llamada vuelva, sin bloquear la tarea ni a los demás montajes.
+ */
+
+#pragma once
+#include "proc_snapshot.h"
+
+/**
+ * @brief Tabla de montajes del proceso, relativa a la raíz de /proc.
+ */
+#define FS_MOUNTINFO "self/mountinfo"
+
+/**
+ * @brief Cantidad máxima de montajes seguidos a la vez.
+ */
+#define FS_MAX_MOUNTS 64
+
+/**
+ * @brief Tamaño del punto de montaje y del dispositivo de un montaje.
+ */
+#define FS_PATH_SIZE 256
+
+/**
+ * @brief Tamaño del tipo de sistema de archivos.
+ */
+#define FS_TYPE_SIZE 32
+
+/**
+ * @brief Cantidad máxima de patrones en la lista de puntos de montaje permitidos.
+ */
+#define MAX_FS_ALLOWLIST 16
+
+/**
+ * @brief Plazo de cada statvfs() si config.json no indica otro.
+ */
+#define FS_DEFAULT_TIMEOUT_MS 1000
+
+/**
+ * @brief Cantidad máxima de statvfs() colgados a la vez; con todos ocupados no se consulta ningún montaje nuevo.
+ */
+#define FS_MAX_STUCK 4
+
+/**
+ * @brief Capacidad e inodos de un montaje en un ciclo.
+ */
+typedef struct fs_mount
+{
+    char mountpoint[FS_PATH_SIZE];  ///< Punto de montaje, sin los escapes octales de mountinfo.
+    char device[FS_PATH_SIZE];      ///< Dispositivo o fuente del montaje (por ejemplo "/dev/sda1" o "nas:/export").
+    char fstype[FS_TYPE_SIZE];      ///< Tipo de sistema de archivos.
+    int has_stats;                  ///< 1 si el último statvfs() respondió dentro del plazo.
+    int stale;                      ///< 1 si hay un statvfs() de este montaje colgado.
+    unsigned long long size_bytes;  ///< Capacidad total.
+    unsigned long long free_bytes;  ///< Bytes libres, incluida la reserva de root.
+    unsigned long long avail_bytes; ///< Bytes libres para usuarios sin privilegios.
+    unsigned long long files;       ///< Inodos totales.
+    unsigned long long files_free;  ///< Inodos libres.
+} fs_mount_t;
+
+/**
+ * @brief Relee la tabla de montajes si cambió y consulta la capacidad de los montajes seleccionados.
+ *
+ * @param snap Instantánea a completar.
+ * @return 0 en caso de éxito, -1 si no se pudo leer la tabla de montajes.
+ */
+int fs_scan(proc_snapshot_t* snap);
+
+/**
+ * @brief Reemplaza la lista de puntos de montaje permitidos.
+ *
+ * Cada patrón se compara con fnmatch() contra el punto de montaje ("/", "/home", "/data*", ...). Con una lista
+ * vacía se seleccionan todos los montajes salvo los sistemas de archivos virtuales (proc, sysfs, cgroup, overlay...).
+ *
+ * @param patterns Patrones de puntos de montaje.
+ * @param count Cantidad de patrones (se truncan a MAX_FS_ALLOWLIST).
+ */
+void set_fs_allowlist(const char** patterns, int count);
+
+/**
+ * @brief Configura el plazo de cada statvfs().
+ *
+ * @param timeout_ms Plazo en milisegundos (se ignoran valores no positivos).
+ */
+void set_fs_timeout(int timeout_ms);
+
+/**
+ * @brief Detiene el hilo de statvfs() y cierra la tabla de montajes.
+ */
+void fs_close();
@@ -0,0 +1,92 @@
+/**
+ * @file history.h
+ * @brief Historial en memoria de las últimas muestras de cada serie, comprimido al estilo Gorilla.
+ *
+ * Cada serie (métrica más valores de etiquetas) guarda un anillo de bloques de tamaño fijo. Dentro de un bloque los
+ * instantes se codifican como diferencia de diferencias y los valores como XOR con el valor anterior, de modo que una
+ * serie que cambia poco ocupa unos pocos bits por muestra. Todo el historial vive en una única región: memoria
+ * anónima o, si config.json indica un archivo, un mmap compartido de ese archivo que sobrevive a un reinicio.
+ */
+
+#pragma once
+#include "arena.h"
+#include "history_block.h"
+#include "metric_store.h"
+#include <stdint.h>
+
+/**
+ * @brief Muestras por serie si config.json no indica otra cantidad.
+ */
+#define HISTORY_DEFAULT_SAMPLES 720
+
+/**
+ * @brief Series seguidas si config.json no indica otra cantidad.
+ */
+#define HISTORY_DEFAULT_MAX_SERIES 2048
+
+/**
+ * @brief Tamaño del nombre de la serie: métrica y valores de etiquetas separados por '\x1f'.
+ */
+#define HISTORY_KEY_SIZE METRIC_SERIES_KEY_SIZE
+
+/**
+ * @brief Milisegundos entre dos msync() del archivo del historial.
+ */
+#define HISTORY_SYNC_MS 60000
+
+/**
+ * @brief Serie del historial con su anillo de bloques.
+ */
+typedef struct
+{
+    char key[HISTORY_KEY_SIZE]; ///< Métrica y valores de etiquetas, usado como clave al reabrir el archivo.
+    uint32_t head;              ///< Índice del bloque en escritura.
+    uint32_t used;              ///< Bloques con muestras (a lo sumo history_header_t::blocks_per_series).
+} history_series_t;
+
+/**
+ * @brief Inicializa el historial.
+ *
+ * Si file no es NULL se mapea ese archivo; un archivo con otra geometría o de otra versión se vacía. Las muestras
+ * por serie se redondean a bloques enteros; en series con valores muy variables un bloque se cierra antes de llegar a
+ * HISTORY_BLOCK_SAMPLES y el historial retiene menos muestras.
+ *
+ * @param samples Muestras por serie, o 0 para HISTORY_DEFAULT_SAMPLES.
+ * @param max_series Series seguidas, o 0 para HISTORY_DEFAULT_MAX_SERIES.
+ * @param file Archivo del historial, o NULL para usar memoria anónima.
+ * @return 0 en caso de éxito, -1 en caso de error (el historial queda deshabilitado).
+ */
+int history_init(int samples, int max_series, const char* file);
+
+/**
+ * @brief Agrega al historial todas las muestras de un lote con el instante actual.
+ *
+ * @param batch Lote publicado (se ignora si es NULL o si el historial no está inicializado).
+ */
+void history_record_batch(const metric_batch_t* batch);
+
+/**
+ * @brief Devuelve en JSON las muestras de las series de una métrica dentro de un rango de tiempo.
+ *
+ * El formato es {"series":[{"metric":"...","labels":["..."],"samples":[[ms,valor],...]}]}, con las etiquetas en el
+ * orden en que se declararon en la métrica.
+ *
+ * @param pattern Nombre de la métrica o patrón fnmatch.
+ * @param start_ms Primer instante incluido, en milisegundos desde la época.
+ * @param end_ms Último instante incluido.
+ * @param arena Arena de la que sale el texto; se escribe sin armar un árbol de cJSON.
+ * @return Texto válido hasta el próximo arena_reset(), o NULL si el historial no está inicializado o falta memoria.
+ */
+const char* history_query_json(const char* pattern, int64_t start_ms, int64_t end_ms, arena_t* arena);
+
+/**
+ * @brief Devuelve el instante actual en milisegundos desde la época, el mismo reloj de las muestras.
+ *
+ * @return Instante actual.
+ */
+int64_t history_now_ms();
+
+/**
+ * @brief Sincroniza el archivo del historial y libera la región.
+ */
+void history_close();
@@ -0,0 +1,92 @@
+/**
+ * @file history_block.h
+ * @brief Bloques del historial comprimidos al estilo Gorilla: diferencia de diferencias para los instantes y XOR con
+ * el valor anterior para los valores.
+ *
+ * El codificador y el decodificador no dependen del resto del historial: trabajan sobre un bloque de tamaño fijo que
+ * history.c guarda en su región mapeada.
+ */
+
+#pragma once
+#include <stdint.h>
+
+/**
+ * @brief Muestras máximas por bloque.
+ */
+#define HISTORY_BLOCK_SAMPLES 128
+
+/**
+ * @brief Bytes de datos comprimidos por bloque (64 bits por muestra en promedio para un bloque lleno).
+ */
+#define HISTORY_BLOCK_BYTES 1024
+
+/**
+ * @brief Bloque comprimido de muestras consecutivas de una serie.
+ *
+ * Guarda el estado del codificador para poder seguir agregando muestras sin decodificar lo anterior.
+ */
+typedef struct
+{
+    int64_t first_ts;                  ///< Instante de la primera muestra, en milisegundos desde la época.
+    int64_t last_ts;                   ///< Instante de la última muestra.
+    int64_t last_delta;                ///< Diferencia entre las dos últimas muestras.
+    uint64_t first_value;              ///< Bits del valor de la primera muestra.
+    uint64_t last_value;               ///< Bits del último valor.
+    uint32_t bits;                     ///< Bits usados de data.
+    uint16_t count;                    ///< Muestras del bloque.
+    uint8_t leading;                   ///< Ceros a la izquierda de la última ventana de XOR, o 0xff si no hay.
+    uint8_t trailing;                  ///< Ceros a la derecha de la última ventana de XOR.
+    uint8_t data[HISTORY_BLOCK_BYTES]; ///< Muestras a partir de la segunda, comprimidas.
+} history_block_t;
+
+/**
+ * @brief Estado del decodificador de un bloque.
+ */
+typedef struct
+{
+    const history_block_t* block; ///< Bloque decodificado.
+    uint32_t pos;                 ///< Próximo bit a leer.
+    uint16_t index;               ///< Muestras ya devueltas.
+    int64_t ts;                   ///< Instante de la última muestra devuelta.
+    int64_t delta;                ///< Diferencia de la última muestra devuelta.
+    uint64_t value;               ///< Bits del último valor devuelto.
+    int leading;                  ///< Ventana de XOR vigente.
+    int trailing;                 ///< Ventana de XOR vigente.
+} history_block_reader_t;
+
+/**
+ * @brief Vacía un bloque y lo abre con su primera muestra, que se guarda sin comprimir en el encabezado.
+ *
+ * @param block Bloque.
+ * @param ts Instante de la muestra.
+ * @param value Bits del valor (un double copiado con memcpy).
+ */
+void history_block_start(history_block_t* block, int64_t ts, uint64_t value);
+
+/**
+ * @brief Agrega una muestra a un bloque abierto.
+ *
+ * @param block Bloque abierto con history_block_start().
+ * @param ts Instante de la muestra.
+ * @param value Bits del valor.
+ * @return 0 si se agregó, -1 si el bloque está lleno o la diferencia de tiempo no entra en 32 bits.
+ */
+int history_block_append(history_block_t* block, int64_t ts, uint64_t value);
+
+/**
+ * @brief Prepara la lectura de un bloque.
+ *
+ * @param reader Decodificador.
+ * @param block Bloque; no puede cambiar mientras se lee.
+ */
+void history_block_reader_init(history_block_reader_t* reader, const history_block_t* block);
+
+/**
+ * @brief Devuelve la próxima muestra de un bloque.
+ *
+ * @param reader Decodificador.
+ * @param ts Instante de la muestra.
+ * @param value Valor de la muestra.
+ * @return 1 si devolvió una muestra, 0 si el bloque no tiene más.
+ */
+int history_block_next(history_block_reader_t* reader, int64_t* ts, double* value);
@@ -0,0 +1,80 @@
+/**
+ * @file http_client.h
+ * @brief Cliente HTTP/1.1 mínimo en texto plano para los envíos de push.c y alert.c.
+ *
+ * Cada envío abre una conexión, escribe un POST con "Connection: close" y solo lee la línea de estado. No hay TLS,
+ * redirecciones ni keep-alive: los destinos son agentes o proxies locales.
+ */
+
+#pragma once
+#include <stddef.h>
+
+/**
+ * @brief Tamaño del host, el puerto y la ruta de un destino.
+ */
+#define HTTP_HOST_SIZE 256
+#define HTTP_PORT_SIZE 8
+#define HTTP_PATH_SIZE 256
+
+/**
+ * @brief Puerto de un destino http:// que no indica otro.
+ */
+#define HTTP_DEFAULT_PORT "80"
+
+/**
+ * @brief Destino de los envíos.
+ */
+typedef struct
+{
+    char host[HTTP_HOST_SIZE]; ///< Nombre o dirección, sin los corchetes de una dirección IPv6.
+    char port[HTTP_PORT_SIZE]; ///< Puerto o nombre de servicio.
+    char path[HTTP_PATH_SIZE]; ///< Ruta de la petición, "/" si no se indicó.
+} http_target_t;
+
+/**
+ * @brief Resultado de un POST.
+ */
+typedef enum
+{
+    HTTP_POST_OK,      ///< El receptor respondió 2xx.
+    HTTP_POST_RETRY,   ///< Falla transitoria (red, plazo vencido, 5xx o 429): conviene reintentar.
+    HTTP_POST_REJECTED ///< El receptor rechazó el cuerpo (otro estado): reintentar no sirve.
+} http_post_result_t;
+
+/**
+ * @brief Separa un destino `host[:puerto][/ruta]` o `[dirección IPv6][:puerto][/ruta]`, ya sin el esquema.
+ *
+ * @param text Destino.
+ * @param default_port Puerto si el destino no indica otro.
+ * @param target Destino separado.
+ * @return 0 en caso de éxito, -1 si el host o el puerto están vacíos o no entran en target.
+ */
+int http_target_parse(const char* text, const char* default_port, http_target_t* target);
+
+/**
+ * @brief Escribe la línea de petición y los encabezados de un POST al destino.
+ *
+ * Host lleva la dirección entre corchetes si es IPv6, como exige RFC 7230.
+ *
+ * @param target Destino.
+ * @param headers Encabezados propios del envío, cada uno terminado en "\r\n".
+ * @param body_len Longitud del cuerpo, para Content-Length.
+ * @param out Buffer de salida.
+ * @param size Tamaño de out.
+ * @return Longitud escrita, o -1 si no entra en out.
+ */
+int http_format_request(const http_target_t* target, const char* headers, size_t body_len, char* out, size_t size);
+
+/**
+ * @brief Envía un POST al destino y clasifica la línea de estado de la respuesta.
+ *
+ * @param target Destino.
+ * @param headers Encabezados propios del envío, cada uno terminado en "\r\n".
+ * @param body Cuerpo.
+ * @param len Longitud del cuerpo.
+ * @param timeout_ms Plazo de la conexión, de cada escritura y de la respuesta, en milisegundos.
+ * @param status Código de estado recibido, o 0 si no hubo respuesta.
+ * @return Clasificación del resultado.
+ */
+http_post_result_t http_post(const http_target_t* target, const char* headers, const void* body, size_t len,
+                             int timeout_ms, int* status);
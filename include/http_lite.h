@@ -0,0 +1,183 @@
+/**
+ * @file http_lite.h
+ * @brief Servidor HTTP propio con la parte de la API de microhttpd que usa expose_metrics.c.
+ *
+ * Con MONITOR_BUILTIN_EXPOSITION este encabezado reemplaza a <microhttpd.h>. Un único hilo atiende el socket de
+ * escucha y hasta MHD_OPTION_CONNECTION_LIMIT conexiones keep-alive con poll(); cada petición GET completa se pasa al
+ * manejador en el mismo hilo y la respuesta se escribe antes de leer la siguiente. Alcanza para los pocos scrapes por
+ * segundo de un sidecar, sin cuerpos de petición, chunked ni TLS. Las banderas de modo se aceptan y se ignoran.
+ */
+
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+#include <sys/socket.h>
+
+/**
+ * @brief Versión equivalente de microhttpd: los manejadores devuelven enum MHD_Result.
+ */
+#define MHD_VERSION 0x00097500
+
+/**
+ * @brief Resultado de las funciones y de los manejadores.
+ */
+enum MHD_Result
+{
+    MHD_NO = 0, ///< Error: se cierra la conexión.
+    MHD_YES = 1 ///< Éxito.
+};
+
+struct MHD_Daemon;
+struct MHD_Connection;
+struct MHD_Response;
+
+/**
+ * @brief Modo de memoria del cuerpo de una respuesta; el cuerpo siempre se copia.
+ */
+enum MHD_ResponseMemoryMode
+{
+    MHD_RESPMEM_PERSISTENT,
+    MHD_RESPMEM_MUST_FREE,
+    MHD_RESPMEM_MUST_COPY
+};
+
+/**
+ * @brief Origen de un valor de la petición.
+ */
+enum MHD_ValueKind
+{
+    MHD_HEADER_KIND = 1,      ///< Encabezado (sin distinguir mayúsculas en el nombre).
+    MHD_GET_ARGUMENT_KIND = 8 ///< Argumento de la URL, ya decodificado.
+};
+
+/**
+ * @brief Banderas de MHD_start_daemon(); solo MHD_USE_DUAL_STACK cambia el comportamiento.
+ */
+enum MHD_FLAG
+{
+    MHD_NO_FLAG = 0,
+    MHD_USE_ERROR_LOG = 1,
+    MHD_USE_INTERNAL_POLLING_THREAD = 8,
+    MHD_USE_THREAD_PER_CONNECTION = 4,
+    MHD_USE_POLL = 64,
+    MHD_USE_POLL_INTERNAL_THREAD = 72,
+    MHD_USE_EPOLL_INTERNAL_THREAD = 520,
+    MHD_USE_DUAL_STACK = 2048
+};
+
+/**
+ * @brief Opciones de MHD_start_daemon().
+ */
+enum MHD_OPTION
+{
+    MHD_OPTION_END = 0,                 ///< Fin de la lista.
+    MHD_OPTION_CONNECTION_LIMIT = 2,    ///< Conexiones simultáneas.
+    MHD_OPTION_CONNECTION_TIMEOUT = 3,  ///< Segundos de inactividad antes de cerrar una conexión.
+    MHD_OPTION_SOCK_ADDR = 6,           ///< struct sockaddr* de escucha.
+    MHD_OPTION_THREAD_POOL_SIZE = 14,   ///< Se acepta y se ignora: siempre hay un solo hilo.
+    MHD_OPTION_ARRAY = 15,              ///< Arreglo de struct MHD_OptionItem terminado en MHD_OPTION_END.
+    MHD_OPTION_LISTEN_BACKLOG_SIZE = 25 ///< Cola de conexiones pendientes.
+};
+
+/**
+ * @brief Capacidades consultables con MHD_is_feature_supported().
+ */
+enum MHD_FEATURE
+{
+    MHD_FEATURE_EPOLL = 7
+};
+
+/**
+ * @brief Elemento de MHD_OPTION_ARRAY.
+ */
+struct MHD_OptionItem
+{
+    enum MHD_OPTION option; ///< Opción.
+    intptr_t value;         ///< Valor entero.
+    void* ptr_value;        ///< Valor puntero.
+};
+
+/**
+ * @brief Códigos de estado y encabezados usados por el monitor.
+ */
+#define MHD_HTTP_OK 200
+#define MHD_HTTP_NOT_MODIFIED 304
+#define MHD_HTTP_BAD_REQUEST 400
+#define MHD_HTTP_SERVICE_UNAVAILABLE 503
+#define MHD_HTTP_HEADER_CONTENT_TYPE "Content-Type"
+#define MHD_HTTP_HEADER_CONTENT_ENCODING "Content-Encoding"
+#define MHD_HTTP_HEADER_ACCEPT_ENCODING "Accept-Encoding"
+#define MHD_HTTP_HEADER_ETAG "ETag"
+#define MHD_HTTP_HEADER_IF_NONE_MATCH "If-None-Match"
+#define MHD_HTTP_HEADER_VARY "Vary"
+
+/**
+ * @brief Manejador de peticiones; upload_data es siempre NULL.
+ */
+typedef enum MHD_Result (*MHD_AccessHandlerCallback)(void* cls, struct MHD_Connection* connection, const char* url,
+                                                     const char* method, const char* version,
+                                                     const char* upload_data, size_t* upload_data_size,
+                                                     void** con_cls);
+
+/**
+ * @brief Política de aceptación; se ignora.
+ */
+typedef enum MHD_Result (*MHD_AcceptPolicyCallback)(void* cls, const struct sockaddr* addr, socklen_t addrlen);
+
+/**
+ * @brief Abre el socket de escucha e inicia el hilo del servidor.
+ *
+ * @param flags Banderas MHD_USE_*.
+ * @param port Puerto, si no se pasa MHD_OPTION_SOCK_ADDR.
+ * @param apc Política de aceptación (se ignora).
+ * @param apc_cls Argumento de la política.
+ * @param dh Manejador de peticiones.
+ * @param dh_cls Argumento del manejador.
+ * @return Servidor, o NULL si no se pudo escuchar o crear el hilo.
+ */
+struct MHD_Daemon* MHD_start_daemon(unsigned int flags, uint16_t port, MHD_AcceptPolicyCallback apc, void* apc_cls,
+                                    MHD_AccessHandlerCallback dh, void* dh_cls, ...);
+
+/**
+ * @brief Detiene el hilo, cierra las conexiones y libera el servidor.
+ */
+void MHD_stop_daemon(struct MHD_Daemon* daemon);
+
+/**
+ * @brief Crea una respuesta copiando el cuerpo.
+ *
+ * @return Respuesta, o NULL si no hay memoria.
+ */
+struct MHD_Response* MHD_create_response_from_buffer(size_t size, void* buffer, enum MHD_ResponseMemoryMode mode);
+
+/**
+ * @brief Agrega un encabezado a una respuesta.
+ *
+ * @return MHD_YES, o MHD_NO si no hay lugar o el encabezado tiene saltos de línea.
+ */
+enum MHD_Result MHD_add_response_header(struct MHD_Response* response, const char* header, const char* content);
+
+/**
+ * @brief Escribe la respuesta en la conexión.
+ *
+ * @return MHD_YES si se escribió entera, MHD_NO si la conexión falló.
+ */
+enum MHD_Result MHD_queue_response(struct MHD_Connection* connection, unsigned int status_code,
+                                   struct MHD_Response* response);
+
+/**
+ * @brief Libera una respuesta.
+ */
+void MHD_destroy_response(struct MHD_Response* response);
+
+/**
+ * @brief Busca un encabezado o un argumento de la petición en curso.
+ *
+ * @return Valor, válido hasta que vuelve el manejador, o NULL si no vino.
+ */
+const char* MHD_lookup_connection_value(struct MHD_Connection* connection, enum MHD_ValueKind kind, const char* key);
+
+/**
+ * @brief Indica si el servidor tiene una capacidad; este servidor usa poll() y no tiene ninguna de las consultables.
+ */
+enum MHD_Result MHD_is_feature_supported(enum MHD_FEATURE feature);
@@ -8,52 +8,149 @@
 #include <string.h>
 #include <stdbool.h>
 
-// Variables globales que indican las banderas de métricas.
+/**
+ * @brief Intervalo y plazo configurados para una tarea de recolección.
+ */
+typedef struct
+{
+    char* name;      ///< Nombre de la tarea.
+    int interval_ms; ///< Intervalo en milisegundos, o 0 para el de por defecto.
+    int deadline_ms; ///< Plazo en milisegundos, o 0 para usar el intervalo.
+} CollectorSchedule;
+
+/**
+ * @brief Regla de muestreo adaptativo de una métrica.
+ */
+typedef struct
+{
+    char* metric;       ///< Patrón fnmatch sobre el nombre de la métrica.
+    double delta;       ///< Variación tolerada entre dos ejecuciones.
+    bool has_threshold; ///< Si la regla tiene umbral.
+    double threshold;   ///< Valor (o tasa de un contador) que devuelve la tarea al intervalo rápido.
+} AdaptiveRule;
+
+/**
+ * @brief Grupo de hosts del agregador.
+ */
+typedef struct
+{
+    char* name;      ///< Valor de la etiqueta del grupo.
+    char** hosts;    ///< Patrones fnmatch sobre la dirección del host.
+    int hosts_count; ///< Número de patrones.
+} AggregatorGroup;
+
+/**
+ * @brief Regla de alerta por umbral.
+ */
+typedef struct
+{
+    char* name; ///< Nombre de la regla.
+    char* expr; ///< Expresión, por ejemplo "cpu_usage_percentage > 90 for 5s".
+} AlertRule;
+
+/**
+ * @brief Estructura que representa la configuración del sistema de monitoreo.
+ */
+typedef struct
+{
+    int sampling_interval;              ///< Intervalo de muestreo en segundos.
+    int sampling_interval_ms;           ///< Intervalo de muestreo en milisegundos, o -1 si no es válido.
+    char** metrics;                     ///< Lista de métricas a recolectar (nombres, alias o patrones fnmatch).
+    int metrics_count;                  ///< Número de métricas en la lista.
+    unsigned long long enabled;         ///< Máscara de metric_registry.h: todas sin lista, las listadas con ella.
+    char** disk_devices;                ///< Patrones de dispositivos de bloque permitidos.
+    int disk_devices_count;             ///< Número de patrones.
+    char** memory_fields;               ///< Patrones de campos de /proc/meminfo y /proc/vmstat exportados.
+    int memory_fields_count;            ///< Número de patrones.
+    char** filesystem_mounts;           ///< Patrones de puntos de montaje seguidos.
+    int filesystem_mounts_count;        ///< Número de patrones.
+    int filesystem_timeout_ms;          ///< Plazo de cada statvfs(), o 0 para el valor por defecto.
+    bool network_include_loopback;      ///< Incluir la interfaz de loopback en las métricas de red.
+    bool network_include_veth;          ///< Incluir las interfaces veth* en las métricas de red.
+    int process_top_n;                  ///< Procesos exportados por ranking, o 0 para el valor por defecto.
+    char* process_io_engine;            ///< Motor de lectura de /proc/[pid] ("pread" o "io_uring"), o NULL.
+    int cgroup_depth;                   ///< Profundidad de la jerarquía de cgroups, o 0 para el valor por defecto.
+    int history_samples;                ///< Muestras del historial por serie, o 0 para el valor por defecto.
+    int history_max_series;             ///< Series del historial, o 0 para el valor por defecto.
+    char* history_file;                 ///< Archivo mapeado del historial, o NULL para usar memoria anónima.
+    char* push_mode;                    ///< Protocolo de envío ("remote_write", "statsd" o "influx"), o NULL.
+    char* push_url;                     ///< Destino del envío.
+    int push_interval_ms;               ///< Intervalo entre envíos, o 0 para el valor por defecto.
+    int push_queue_size;                ///< Capacidad de la cola de envío, o 0 para el valor por defecto.
+    int push_max_batch;                 ///< Muestras por envío, o 0 para el valor por defecto.
+    bool aggregator_enabled;            ///< Recibir muestras de otros agentes y exponer series resumidas por grupo.
+    char* aggregator_listen;            ///< host:puerto UDP del agregador, o NULL para el valor por defecto.
+    char* aggregator_group_label;       ///< Nombre de la etiqueta del grupo, o NULL para el valor por defecto.
+    AggregatorGroup* aggregator_groups; ///< Grupos de hosts, en orden de prioridad.
+    int aggregator_groups_count;        ///< Número de grupos.
+    double* aggregator_quantiles;       ///< Cuantiles calculados por grupo, o NULL para los de por defecto.
+    int aggregator_quantiles_count;     ///< Número de cuantiles.
+    int aggregator_interval_ms;         ///< Intervalo entre cálculos, o 0 para el valor por defecto.
+    int aggregator_stale_ms;            ///< Vigencia del valor de un host, o 0 para el valor por defecto.
+    char* http_bind;                    ///< Dirección de escucha del servidor HTTP, o NULL para el valor por defecto.
+    int http_port;                      ///< Puerto del servidor HTTP, o 0 para el valor por defecto.
+    char* http_mode;                    ///< Modo del servidor ("epoll", "thread_per_connection" o "select"), o NULL.
+    int http_threads;                   ///< Hilos del servidor en modo epoll, o 0 para el valor por defecto.
+    int http_connection_timeout;        ///< Segundos de inactividad de una conexión keep-alive, o 0 por defecto.
+    int http_connection_limit;          ///< Conexiones simultáneas, o 0 para el valor por defecto.
+    int http_backlog;                   ///< Cola de conexiones pendientes, o 0 para el valor por defecto.
+    AdaptiveRule* adaptive_rules;       ///< Reglas de muestreo adaptativo, en orden de prioridad.
+    int adaptive_rules_count;           ///< Número de reglas.
+    int adaptive_max_interval_ms;       ///< Intervalo máximo de una tarea espaciada, o 0 por defecto.
+    AlertRule* alert_rules;             ///< Reglas de alerta, en el orden de config.json.
+    int alert_rules_count;              ///< Número de reglas.
+    char* alert_webhook;                ///< URL http:// que recibe las notificaciones, o NULL.
+    char* alert_socket;                 ///< Socket unix de datagramas que recibe las notificaciones, o NULL.
+    CollectorSchedule* collectors;      ///< Planificación propia de las tareas.
+    int collectors_count;               ///< Número de tareas con planificación propia.
+} Config;
 
 /**
- * @brief Bandera para el monitoreo del ancho de banda.
+ * @brief Lee y parsea el archivo de configuración una sola vez.
  *
- * Esta variable se utiliza para habilitar o deshabilitar el monitoreo
- * del uso del ancho de banda en la configuración.
+ * Sin "metrics" se recolectan todas las métricas. Con la lista, las que no se nombran quedan apagadas, salvo que la
+ * lista solo tenga los nombres del formato original (bandwith_usage, cpu_usage_porcentage, disk_usage_porcentage y
+ * change_contexts): ahí solo esas cuatro dependen de la lista y todas las demás se recolectan, como antes.
+ *
+ * @param file_path Ruta al archivo JSON.
+ * @param config Configuración a completar (liberar con config_free()).
+ * @return 0 en caso de éxito, -1 en caso de error (config queda vacía).
  */
-extern bool flag_bandwidth;
+int config_load(const char *file_path, Config *config);
 
 /**
- * @brief Bandera para el monitoreo del uso de CPU.
+ * @brief Aplica una configuración: métricas, intervalos, dispositivos, montajes, interfaces, procesos y cgroups.
  *
- * Esta variable se utiliza para habilitar o deshabilitar el monitoreo
- * del uso de CPU en la configuración.
+ * @param config Configuración leída con config_load().
  */
-extern bool flag_cpu;
+void config_apply(const Config *config);
 
 /**
- * @brief Bandera para el monitoreo del uso de disco.
+ * @brief Libera los campos de una configuración.
  *
- * Esta variable se utiliza para habilitar o deshabilitar el monitoreo
- * del uso del disco en la configuración.
+ * @param config Configuración.
  */
-extern bool flag_disk;
+void config_free(Config *config);
 
 /**
- * @brief Bandera para indicar cambios en la configuración.
+ * @brief Empieza a vigilar el archivo de configuración con inotify (o por mtime y tamaño si no está disponible).
  *
- * Esta variable se utiliza para señalar si ha habido cambios en
- * la configuración que deben ser procesados.
+ * @param file_path Ruta al archivo JSON.
+ * @return 0 en caso de éxito, -1 si no se pudo usar inotify (se usa la comparación de mtime y tamaño).
  */
-extern bool flag_change;
+int config_watch(const char *file_path);
 
 /**
- * @brief Estructura que representa la configuración del sistema de monitoreo.
+ * @brief Espera un cambio en el archivo de configuración.
+ *
+ * @param timeout_ms Tiempo máximo de espera en milisegundos.
+ * @return 1 si el archivo cambió, 0 si no.
  */
-typedef struct
-{
-    int sampling_interval; ///< Intervalo de muestreo en segundos.
-    char** metrics;        ///< Lista de métricas a recolectar.
-    int metrics_count;     ///< Número de métricas en la lista.
-} Config;
+int config_wait_change(int timeout_ms);
 
-// Declaración de las funciones
-int read_sampling_interval(const char *file_path);
-void update_flags_from_json(const char *file_path);
+/**
+ * @brief Deja de vigilar el archivo de configuración.
+ */
+void config_unwatch();
 
 #endif
@@ -0,0 +1,47 @@
+/**
+ * @file line_protocol.h
+ * @brief Formato de las líneas de StatsD y line protocol que envía push.c.
+ *
+ * Cada muestra se escribe como `medición[,etiqueta=valor...] value=N instante`, con ',', '=' y ' ' escapados con '\'
+ * en los valores, o como un gauge de StatsD con las etiquetas como tags de DogStatsD, con ',', '|', '#' y ':'
+ * reemplazados por '_' en los valores.
+ */
+
+#pragma once
+#include "metric_registry.h"
+#include "push.h"
+
+/**
+ * @brief Formatea una muestra como una línea de StatsD o line protocol, terminada en '\n'.
+ *
+ * Los contadores se envían como gauges del total: StatsD espera incrementos, y el receptor puede derivar la tasa.
+ *
+ * @param mode PUSH_STATSD o PUSH_INFLUX.
+ * @param info Nombre y etiquetas de la métrica de la muestra, o NULL si no se registró.
+ * @param sample Muestra.
+ * @param line Buffer de salida.
+ * @param size Tamaño de line.
+ * @return Longitud de la línea, o 0 si la muestra se omite o no entra en line.
+ */
+int line_protocol_format(push_mode_t mode, const metric_info_t* info, const push_sample_t* sample, char* line,
+                         size_t size);
+
+/**
+ * @brief Copia a dst un valor de etiqueta escapando los caracteres especiales del line protocol.
+ *
+ * @param dst Buffer destino; el valor se trunca si no entra.
+ * @param size Tamaño de dst.
+ * @param src Valor original.
+ */
+void line_protocol_escape(char* dst, size_t size, const char* src);
+
+/**
+ * @brief Copia a dst un valor de etiqueta como valor de un tag de DogStatsD.
+ *
+ * DogStatsD no define un escape, así que ',', '|', '#' y ':' se reemplazan por '_'.
+ *
+ * @param dst Buffer destino; el valor se trunca si no entra.
+ * @param size Tamaño de dst.
+ * @param src Valor original.
+ */
+void line_protocol_statsd_tag(char* dst, size_t size, const char* src);
@@ -0,0 +1,72 @@
+/**
+ * @file memstat.h
+ * @brief Parser de /proc/meminfo y /proc/vmstat en una sola pasada con una tabla de hash perfecto.
+ *
+ * Cada línea se busca en la tabla generada al compilar (ver memstat_fields.h), así que parsear un archivo cuesta una
+ * pasada lineal sin importar cuántos campos estén habilitados. La lista "memory_fields" de config.json elige qué
+ * campos se exportan; los que usan los getters de metrics.c se parsean siempre.
+ */
+
+#pragma once
+#include "memstat_fields.h"
+
+/**
+ * @brief Cantidad máxima de patrones en la lista de campos.
+ */
+#define MAX_MEMSTAT_ALLOWLIST 64
+
+/**
+ * @brief Descripción de un campo.
+ */
+typedef struct
+{
+    const char* key;    ///< Clave en el archivo, por ejemplo "Cached" o "pgscan_kswapd".
+    int file;           ///< MEMSTAT_MEMINFO o MEMSTAT_VMSTAT.
+    const char* metric; ///< Nombre de la métrica.
+    double scale;       ///< Factor que lleva el valor a la unidad de la métrica.
+    const char* help;   ///< Texto de ayuda.
+} memstat_field_info_t;
+
+/**
+ * @brief Campos, indexados por memstat_field_t.
+ */
+extern const memstat_field_info_t memstat_fields[MEMSTAT_FIELD_COUNT];
+
+/**
+ * @brief Busca un campo por su clave.
+ *
+ * @param key Clave, sin terminar en '\0'.
+ * @param len Longitud de la clave.
+ * @return Campo, o -1 si la clave no es de ningún campo.
+ */
+int memstat_lookup(const char* key, size_t len);
+
+/**
+ * @brief Parsea un archivo en una pasada y guarda los campos habilitados.
+ *
+ * @param file MEMSTAT_MEMINFO o MEMSTAT_VMSTAT.
+ * @param buf Contenido del archivo.
+ * @param len Bytes válidos de buf.
+ * @param values Valores tal como aparecen en el archivo, indexados por memstat_field_t.
+ * @param found Máscara en la que se marcan los campos leídos.
+ */
+void memstat_parse(int file, const char* buf, size_t len, unsigned long long values[MEMSTAT_FIELD_COUNT],
+                   unsigned long long* found);
+
+/**
+ * @brief Reemplaza la lista de campos exportados.
+ *
+ * Cada patrón se compara con fnmatch() contra la clave del archivo ("Cached", "HugePages_*", "pgscan_*", ...). Con
+ * una lista vacía se exportan todos los campos.
+ *
+ * @param patterns Patrones de claves.
+ * @param count Cantidad de patrones (se truncan a MAX_MEMSTAT_ALLOWLIST).
+ */
+void set_memstat_fields(const char** patterns, int count);
+
+/**
+ * @brief Devuelve la máscara de campos exportados.
+ *
+ * @return Máscara con el bit de cada memstat_field_t exportado.
+ */
+unsigned long long memstat_exported_fields();
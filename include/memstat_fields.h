@@ -0,0 +1,116 @@
+/**
+ * @file memstat_fields.h
+ * @brief Campos de /proc/meminfo y /proc/vmstat que exporta el monitor, y la función de hash de sus claves.
+ *
+ * Lo incluyen memstat.c y el generador src/gen/memstat_hash_gen.c, que al compilar busca una semilla con la que el
+ * hash no tenga colisiones entre estas claves y escribe la tabla de memstat_hash.h. Por eso este archivo no depende de
+ * ningún otro encabezado del monitor. Agregar un campo es agregar una línea: la tabla se regenera sola.
+ */
+
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Archivo de origen de un campo.
+ */
+#define MEMSTAT_MEMINFO 0
+#define MEMSTAT_VMSTAT 1
+
+/**
+ * @brief Factor de los campos de /proc/meminfo expresados en kB.
+ */
+#define MEMSTAT_KB 1024
+
+/**
+ * @brief Campos: identificador, clave del archivo, archivo, métrica, factor y ayuda.
+ *
+ * SwapUsed no aparece en /proc/meminfo: se calcula como SwapTotal - SwapFree.
+ */
+#define MEMSTAT_FIELDS(X)                                                                                              \
+    X(MEM_TOTAL, "MemTotal", MEMSTAT_MEMINFO, "meminfo_mem_total_bytes", MEMSTAT_KB, "Memoria total")                 \
+    X(MEM_FREE, "MemFree", MEMSTAT_MEMINFO, "meminfo_mem_free_bytes", MEMSTAT_KB, "Memoria libre")                    \
+    X(MEM_AVAILABLE, "MemAvailable", MEMSTAT_MEMINFO, "meminfo_mem_available_bytes", MEMSTAT_KB,                      \
+      "Memoria disponible sin recurrir al swap")                                                                       \
+    X(BUFFERS, "Buffers", MEMSTAT_MEMINFO, "meminfo_buffers_bytes", MEMSTAT_KB, "Buffers de dispositivos de bloque")  \
+    X(CACHED, "Cached", MEMSTAT_MEMINFO, "meminfo_cached_bytes", MEMSTAT_KB, "Caché de páginas")                      \
+    X(SWAP_CACHED, "SwapCached", MEMSTAT_MEMINFO, "meminfo_swap_cached_bytes", MEMSTAT_KB,                            \
+      "Páginas del swap que también están en memoria")                                                                 \
+    X(ACTIVE, "Active", MEMSTAT_MEMINFO, "meminfo_active_bytes", MEMSTAT_KB, "Memoria usada recientemente")           \
+    X(INACTIVE, "Inactive", MEMSTAT_MEMINFO, "meminfo_inactive_bytes", MEMSTAT_KB, "Memoria candidata a reclamarse")  \
+    X(DIRTY, "Dirty", MEMSTAT_MEMINFO, "meminfo_dirty_bytes", MEMSTAT_KB, "Páginas modificadas sin escribir")         \
+    X(WRITEBACK, "Writeback", MEMSTAT_MEMINFO, "meminfo_writeback_bytes", MEMSTAT_KB, "Páginas escribiéndose")        \
+    X(ANON_PAGES, "AnonPages", MEMSTAT_MEMINFO, "meminfo_anon_pages_bytes", MEMSTAT_KB, "Páginas anónimas")           \
+    X(MAPPED, "Mapped", MEMSTAT_MEMINFO, "meminfo_mapped_bytes", MEMSTAT_KB, "Archivos mapeados en memoria")          \
+    X(SHMEM, "Shmem", MEMSTAT_MEMINFO, "meminfo_shmem_bytes", MEMSTAT_KB, "Memoria compartida y tmpfs")              \
+    X(SLAB, "Slab", MEMSTAT_MEMINFO, "meminfo_slab_bytes", MEMSTAT_KB, "Estructuras del kernel en slab")              \
+    X(SRECLAIMABLE, "SReclaimable", MEMSTAT_MEMINFO, "meminfo_slab_reclaimable_bytes", MEMSTAT_KB,                    \
+      "Slab que se puede reclamar")                                                                                    \
+    X(SUNRECLAIM, "SUnreclaim", MEMSTAT_MEMINFO, "meminfo_slab_unreclaimable_bytes", MEMSTAT_KB,                      \
+      "Slab que no se puede reclamar")                                                                                 \
+    X(KERNEL_STACK, "KernelStack", MEMSTAT_MEMINFO, "meminfo_kernel_stack_bytes", MEMSTAT_KB, "Pilas del kernel")     \
+    X(PAGE_TABLES, "PageTables", MEMSTAT_MEMINFO, "meminfo_page_tables_bytes", MEMSTAT_KB, "Tablas de páginas")       \
+    X(COMMIT_LIMIT, "CommitLimit", MEMSTAT_MEMINFO, "meminfo_commit_limit_bytes", MEMSTAT_KB,                         \
+      "Límite de memoria comprometida")                                                                                \
+    X(COMMITTED_AS, "Committed_AS", MEMSTAT_MEMINFO, "meminfo_committed_as_bytes", MEMSTAT_KB,                        \
+      "Memoria comprometida por los procesos")                                                                         \
+    X(SWAP_TOTAL, "SwapTotal", MEMSTAT_MEMINFO, "meminfo_swap_total_bytes", MEMSTAT_KB, "Swap total")                 \
+    X(SWAP_FREE, "SwapFree", MEMSTAT_MEMINFO, "meminfo_swap_free_bytes", MEMSTAT_KB, "Swap libre")                    \
+    X(SWAP_USED, "SwapUsed", MEMSTAT_MEMINFO, "meminfo_swap_used_bytes", MEMSTAT_KB, "Swap en uso")                   \
+    X(HUGEPAGES_TOTAL, "HugePages_Total", MEMSTAT_MEMINFO, "meminfo_hugepages_total", 1, "Páginas enormes totales")   \
+    X(HUGEPAGES_FREE, "HugePages_Free", MEMSTAT_MEMINFO, "meminfo_hugepages_free", 1, "Páginas enormes libres")       \
+    X(HUGEPAGES_RSVD, "HugePages_Rsvd", MEMSTAT_MEMINFO, "meminfo_hugepages_reserved", 1,                             \
+      "Páginas enormes reservadas sin asignar")                                                                        \
+    X(HUGEPAGES_SURP, "HugePages_Surp", MEMSTAT_MEMINFO, "meminfo_hugepages_surplus", 1,                              \
+      "Páginas enormes por encima del pool")                                                                           \
+    X(HUGEPAGESIZE, "Hugepagesize", MEMSTAT_MEMINFO, "meminfo_hugepage_size_bytes", MEMSTAT_KB,                       \
+      "Tamaño de una página enorme")                                                                                   \
+    X(PGPGIN, "pgpgin", MEMSTAT_VMSTAT, "vmstat_pgpgin_total", 1, "kB paginados desde disco")                         \
+    X(PGPGOUT, "pgpgout", MEMSTAT_VMSTAT, "vmstat_pgpgout_total", 1, "kB paginados a disco")                          \
+    X(PSWPIN, "pswpin", MEMSTAT_VMSTAT, "vmstat_pswpin_total", 1, "Páginas leídas del swap")                          \
+    X(PSWPOUT, "pswpout", MEMSTAT_VMSTAT, "vmstat_pswpout_total", 1, "Páginas escritas al swap")                      \
+    X(PGFAULT, "pgfault", MEMSTAT_VMSTAT, "vmstat_pgfault_total", 1, "Fallos de página menores")                      \
+    X(PGMAJFAULT, "pgmajfault", MEMSTAT_VMSTAT, "vmstat_pgmajfault_total", 1, "Fallos de página mayores")             \
+    X(PGSCAN_KSWAPD, "pgscan_kswapd", MEMSTAT_VMSTAT, "vmstat_pgscan_kswapd_total", 1,                                \
+      "Páginas examinadas por kswapd")                                                                                 \
+    X(PGSCAN_DIRECT, "pgscan_direct", MEMSTAT_VMSTAT, "vmstat_pgscan_direct_total", 1,                                \
+      "Páginas examinadas por reclamo directo")                                                                        \
+    X(PGSTEAL_KSWAPD, "pgsteal_kswapd", MEMSTAT_VMSTAT, "vmstat_pgsteal_kswapd_total", 1,                             \
+      "Páginas reclamadas por kswapd")                                                                                 \
+    X(PGSTEAL_DIRECT, "pgsteal_direct", MEMSTAT_VMSTAT, "vmstat_pgsteal_direct_total", 1,                             \
+      "Páginas reclamadas por reclamo directo")                                                                        \
+    X(OOM_KILL, "oom_kill", MEMSTAT_VMSTAT, "vmstat_oom_kill_total", 1, "Procesos terminados por el OOM killer")
+
+/**
+ * @brief Identificadores de los campos, en el orden de MEMSTAT_FIELDS.
+ */
+typedef enum
+{
+#define MEMSTAT_FIELD_ID(id, key, file, metric, scale, help) MEMSTAT_##id,
+    MEMSTAT_FIELDS(MEMSTAT_FIELD_ID)
+#undef MEMSTAT_FIELD_ID
+    MEMSTAT_FIELD_COUNT ///< Cantidad de campos.
+} memstat_field_t;
+
+_Static_assert(MEMSTAT_FIELD_COUNT <= 64, "los campos no entran en una máscara de 64 bits");
+
+/**
+ * @brief Hash de una clave a partir de su longitud y de sus caracteres primero, del medio y último.
+ *
+ * Como en gperf, mirar solo tres posiciones hace que el costo no dependa del largo de la clave; memstat_lookup()
+ * confirma la coincidencia con memcmp(). Si un campo nuevo repite longitud y esas tres letras con otro, el generador
+ * no encuentra semilla y falla la compilación.
+ *
+ * @param seed Semilla elegida por el generador.
+ * @param key Clave, sin terminar en '\0'.
+ * @param len Longitud de la clave, mayor que 0.
+ * @return Hash; su posición en la tabla son los MEMSTAT_HASH_BITS bits altos.
+ */
+static inline uint32_t memstat_hash(uint32_t seed, const char* key, size_t len)
+{
+    uint32_t h = (seed ^ (uint32_t)len) * 0x85ebca6bu;
+    h = (h ^ (unsigned char)key[0]) * 0xc2b2ae35u;
+    h = (h ^ (unsigned char)key[len / 2]) * 0x85ebca6bu;
+    h = (h ^ (unsigned char)key[len - 1]) * 0xc2b2ae35u;
+    return h ^ (h >> 16);
+}
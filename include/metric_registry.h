@@ -0,0 +1,168 @@
+/**
+ * @file metric_registry.h
+ * @brief Tabla de descriptores de las métricas del sistema.
+ *
+ * Cada métrica se describe una sola vez: nombre, ayuda, unidad, fuente de /proc, tipo, etiquetas y la función que
+ * extrae su valor de la instantánea. Con la tabla se crean y registran las métricas de Prometheus, se resuelve qué
+ * métricas habilita config.json y las tareas de collector.c recolectan todas las habilitadas en un único bucle,
+ * salteando las lecturas de /proc que ninguna métrica habilitada necesita.
+ */
+
+#pragma once
+#include "metric_store.h"
+#include "proc_snapshot.h"
+
+/**
+ * @brief Cantidad máxima de descriptores; cada uno ocupa un bit de la máscara de habilitadas.
+ */
+#define METRIC_REGISTRY_MAX 64
+
+/**
+ * @brief Máscara con todas las métricas habilitadas.
+ */
+#define METRIC_REGISTRY_ALL (~0ULL)
+
+/**
+ * @brief Cantidad máxima de métricas de Prometheus registradas con metric_registry_register().
+ */
+#define METRIC_REGISTRY_MAX_METRICS 256
+
+typedef struct metric_desc metric_desc_t;
+
+/**
+ * @brief Agrega al lote las muestras de una métrica con etiquetas o con más de una serie.
+ *
+ * @param batch Lote de la tarea.
+ * @param desc Descriptor de la métrica.
+ * @param snap Instantánea de /proc del ciclo actual.
+ */
+typedef void (*metric_update_fn)(metric_batch_t* batch, const metric_desc_t* desc, const proc_snapshot_t* snap);
+
+/**
+ * @brief Descriptor de una métrica.
+ *
+ * Las métricas escalares definen value; las que tienen etiquetas o varias series definen update y, si crean más de
+ * una métrica de Prometheus, create. Los histogramas (METRIC_HISTOGRAM) definen create y un update que observa el
+ * valor de cada ciclo directamente en libprom.
+ */
+struct metric_desc
+{
+    const char* name;                        ///< Nombre de la métrica y clave en "metrics" de config.json.
+    const char* alias;                       ///< Nombre histórico aceptado en config.json, o NULL.
+    const char* help;                        ///< Texto de ayuda.
+    const char* unit;                        ///< Unidad del valor, agregada a la ayuda.
+    unsigned int source;                     ///< Bit SNAPSHOT_* de la fuente de /proc que necesita.
+    metric_kind_t kind;                      ///< Tipo de la métrica.
+    int label_count;                         ///< Cantidad de etiquetas.
+    const char* labels[METRIC_MAX_LABELS];   ///< Nombres de las etiquetas.
+    double (*value)(const proc_snapshot_t*); ///< Valor de una métrica escalar (negativo en caso de error).
+    metric_update_fn update;                 ///< Muestras de una métrica con etiquetas.
+    int (*create)(metric_desc_t*);           ///< Crea y registra métricas propias, o NULL para la creación estándar.
+    void* metric;                            ///< Métrica de Prometheus creada por metric_registry_init().
+};
+
+/**
+ * @brief Crea y registra en libprom las métricas de todos los descriptores.
+ *
+ * @return 0 en caso de éxito, -1 si alguna falló.
+ */
+int metric_registry_init();
+
+/**
+ * @brief Nombre y etiquetas de una métrica de Prometheus registrada.
+ */
+typedef struct
+{
+    const void* metric;                                ///< Métrica de Prometheus.
+    const char* name;                                  ///< Nombre con el que se creó.
+    int label_count;                                   ///< Cantidad de etiquetas.
+    char labels[METRIC_MAX_LABELS][METRIC_LABEL_SIZE]; ///< Nombres de las etiquetas, copiados.
+} metric_info_t;
+
+/**
+ * @brief Registra una métrica en libprom y recuerda su nombre y etiquetas para quienes solo conocen el puntero de la
+ * muestra (el historial y el envío remoto).
+ *
+ * Todas las métricas de Prometheus del programa se registran con esta función y no directamente con
+ * prom_collector_registry_must_register_metric().
+ *
+ * @param metric Métrica creada con prom_gauge_new(), prom_counter_new() o prom_histogram_new() (puede ser NULL).
+ * @param name Nombre de la métrica; debe vivir mientras corra el programa.
+ * @param label_count Cantidad de etiquetas (se trunca a METRIC_MAX_LABELS).
+ * @param labels Nombres de las etiquetas, los mismos que se pasaron al crear la métrica (se copian).
+ * @return La métrica registrada, o NULL si metric es NULL o el registro falló.
+ */
+void* metric_registry_register(void* metric, const char* name, int label_count, const char* const* labels);
+
+/**
+ * @brief Devuelve el nombre y las etiquetas de una métrica registrada con metric_registry_register().
+ *
+ * @param metric Métrica de una muestra.
+ * @return Datos de la métrica, o NULL si no se registró con metric_registry_register().
+ */
+const metric_info_t* metric_registry_metric_info(const void* metric);
+
+/**
+ * @brief Devuelve el nombre de una métrica registrada con metric_registry_register().
+ *
+ * @param metric Métrica de una muestra.
+ * @return Nombre de la métrica, o NULL si no se registró con metric_registry_register().
+ */
+const char* metric_registry_metric_name(const void* metric);
+
+/**
+ * @brief Devuelve la cantidad de descriptores.
+ *
+ * @return Cantidad de descriptores.
+ */
+int metric_registry_count();
+
+/**
+ * @brief Devuelve un descriptor.
+ *
+ * @param index Índice entre 0 y metric_registry_count() - 1.
+ * @return Descriptor.
+ */
+const metric_desc_t* metric_registry_at(int index);
+
+/**
+ * @brief Calcula la máscara de las métricas cuyos nombres (o alias) coinciden con algún patrón fnmatch.
+ *
+ * @param patterns Patrones, por ejemplo "cpu_usage_percentage" o "memory_*".
+ * @param count Cantidad de patrones.
+ * @return Máscara de métricas.
+ */
+unsigned long long metric_registry_match(const char* const* patterns, int count);
+
+/**
+ * @brief Reemplaza con un único store las métricas habilitadas.
+ *
+ * @param mask Máscara de métricas habilitadas.
+ */
+void metric_registry_set_enabled(unsigned long long mask);
+
+/**
+ * @brief Devuelve la máscara de métricas habilitadas.
+ *
+ * @return Máscara de métricas habilitadas.
+ */
+unsigned long long metric_registry_enabled();
+
+/**
+ * @brief Devuelve las fuentes de /proc que necesitan las métricas de una máscara.
+ *
+ * @param mask Máscara de métricas.
+ * @return Máscara SNAPSHOT_*.
+ */
+unsigned int metric_registry_sources(unsigned long long mask);
+
+/**
+ * @brief Agrega al lote todas las métricas habilitadas que se calculan a partir de las fuentes indicadas.
+ *
+ * @param batch Lote de la tarea.
+ * @param snap Instantánea de /proc con las fuentes leídas.
+ * @param sources Máscara SNAPSHOT_* de la tarea.
+ * @param mask Máscara de métricas habilitadas.
+ */
+void metric_registry_collect(metric_batch_t* batch, const proc_snapshot_t* snap, unsigned int sources,
+                             unsigned long long mask);
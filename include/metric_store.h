@@ -0,0 +1,188 @@
+/**
+ * @file metric_store.h
+ * @brief Almacén interno de muestras con publicación sin locks entre recolectores y scrapes.
+ *
+ * Cada productor (una tarea de collector.c) escribe sus muestras en un canal propio. El canal tiene tres buffers:
+ * el productor arma el lote completo en un buffer que nadie lee y lo publica con un único intercambio atómico, y
+ * los lectores (el manejador HTTP) fijan el último buffer publicado con un contador de lectores. El productor
+ * nunca escribe un buffer publicado ni uno fijado por un lector, de modo que ninguno de los dos lados espera al otro.
+ *
+ * Los contadores se guardan como valores absolutos; quien lee calcula los incrementos entre lotes.
+ */
+
+#pragma once
+#include <stdatomic.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Cantidad máxima de etiquetas de una muestra.
+ */
+#define METRIC_MAX_LABELS 2
+
+/**
+ * @brief Tamaño de cada valor de etiqueta copiado en la muestra.
+ *
+ * Alcanza para casi todos los puntos de montaje y rutas de cgroups; un valor más largo se trunca y termina con
+ * METRIC_LABEL_HASH_LEN caracteres que identifican al valor completo (ver metric_batch_add()).
+ */
+#define METRIC_LABEL_SIZE 128
+
+/**
+ * @brief Caracteres del final de un valor truncado: '~' y el hash FNV-1a de 32 bits del valor completo en hexadecimal.
+ */
+#define METRIC_LABEL_HASH_LEN 9
+
+/**
+ * @brief Tamaño de una clave con la métrica (nombre o puntero) y los valores de las etiquetas de una muestra.
+ */
+#define METRIC_SERIES_KEY_SIZE (128 + METRIC_MAX_LABELS * (METRIC_LABEL_SIZE + 1))
+
+/**
+ * @brief Buffers por canal: uno publicado, uno en escritura y uno libre para un lector rezagado.
+ */
+#define METRIC_STORE_BUFFERS 3
+
+/**
+ * @brief Cantidad máxima de canales.
+ */
+#define METRIC_STORE_MAX_CHANNELS 16
+
+/**
+ * @brief Tipo de una muestra.
+ */
+typedef enum
+{
+    METRIC_GAUGE,    ///< Valor que se fija tal cual.
+    METRIC_COUNTER,  ///< Total acumulado que solo crece.
+    METRIC_HISTOGRAM ///< Observaciones de cada ciclo; las aplica la tarea y nunca pasan por el almacén.
+} metric_kind_t;
+
+/**
+ * @brief Muestra de una serie: métrica, valores de etiquetas y valor.
+ */
+typedef struct
+{
+    void* metric;                                        ///< Métrica de destino (por ejemplo un prom_gauge_t*).
+    metric_kind_t kind;                                  ///< Tipo de la muestra.
+    int label_count;                                     ///< Cantidad de etiquetas válidas.
+    char labels[METRIC_MAX_LABELS][METRIC_LABEL_SIZE];   ///< Valores de las etiquetas, copiados.
+    double value;                                        ///< Valor de la muestra.
+} metric_sample_t;
+
+/**
+ * @brief Lote de muestras de un productor.
+ */
+typedef struct
+{
+    metric_sample_t* samples; ///< Muestras del lote.
+    size_t count;             ///< Muestras válidas.
+    size_t cap;               ///< Capacidad de samples.
+} metric_batch_t;
+
+/**
+ * @brief Canal de un productor con sus buffers y el índice publicado.
+ */
+typedef struct
+{
+    const char* name;                             ///< Nombre del productor.
+    metric_batch_t buffers[METRIC_STORE_BUFFERS]; ///< Buffers del canal.
+    atomic_int readers[METRIC_STORE_BUFFERS];     ///< Lectores que fijaron cada buffer.
+    atomic_int published;                         ///< Índice del último buffer publicado, o -1.
+    int writing;                                  ///< Índice del buffer en escritura, o -1.
+} metric_channel_t;
+
+/**
+ * @brief Crea y registra un canal.
+ *
+ * Los canales se crean al iniciar las tareas y no se destruyen mientras el proceso corre.
+ *
+ * @param name Nombre del productor.
+ * @return Canal creado, o NULL si no hay lugar o memoria.
+ */
+metric_channel_t* metric_channel_new(const char* name);
+
+/**
+ * @brief Empieza un lote nuevo en un buffer que no está publicado ni fijado por un lector.
+ *
+ * Solo el productor dueño del canal puede llamar a esta función.
+ *
+ * @param ch Canal del productor.
+ * @return Lote vacío, o NULL si todos los buffers están ocupados por lectores.
+ */
+metric_batch_t* metric_batch_begin(metric_channel_t* ch);
+
+/**
+ * @brief Agrega una muestra al lote.
+ *
+ * @param batch Lote en construcción (se ignora si es NULL).
+ * @param metric Métrica de destino.
+ * @param kind Tipo de la muestra.
+ * @param value Valor.
+ * @param labels Valores de las etiquetas (pueden ser NULL si label_count es 0); los que no entran en METRIC_LABEL_SIZE
+ * se truncan y terminan con el hash del valor completo, así que dos valores largos con el mismo comienzo siguen
+ * siendo series distintas.
+ * @param label_count Cantidad de etiquetas (se trunca a METRIC_MAX_LABELS).
+ */
+void metric_batch_add(metric_batch_t* batch, void* metric, metric_kind_t kind, double value, const char** labels,
+                      int label_count);
+
+/**
+ * @brief Hash FNV-1a de 64 bits de los valores de las etiquetas de una muestra.
+ *
+ * Sirve para metric_sample_t y para las muestras de monitor_snapshot.h, que guardan las etiquetas igual. Cada valor
+ * termina con un separador, así que {"ab", "c"} y {"a", "bc"} no colisionan.
+ *
+ * @param labels Valores de las etiquetas.
+ * @param label_count Cantidad de etiquetas válidas.
+ * @return Hash.
+ */
+uint64_t metric_labels_hash(const char (*labels)[METRIC_LABEL_SIZE], int label_count);
+
+/**
+ * @brief Publica el lote en construcción con un intercambio atómico.
+ *
+ * @param ch Canal del productor.
+ */
+void metric_batch_publish(metric_channel_t* ch);
+
+/**
+ * @brief Devuelve la generación del almacén, que aumenta con cada lote publicado en cualquier canal.
+ *
+ * Permite a los lectores saber si algo cambió desde su última lectura sin recorrer los canales.
+ *
+ * @return Generación actual.
+ */
+unsigned long long metric_store_generation();
+
+/**
+ * @brief Devuelve la cantidad de canales registrados.
+ *
+ * @return Cantidad de canales.
+ */
+int metric_channel_count();
+
+/**
+ * @brief Devuelve un canal registrado.
+ *
+ * @param index Índice entre 0 y metric_channel_count() - 1.
+ * @return Canal.
+ */
+metric_channel_t* metric_channel_at(int index);
+
+/**
+ * @brief Fija el último lote publicado de un canal para leerlo.
+ *
+ * @param ch Canal.
+ * @param slot Índice fijado, que se pasa a metric_store_release().
+ * @return Lote publicado, o NULL si el canal todavía no publicó nada.
+ */
+const metric_batch_t* metric_store_acquire(metric_channel_t* ch, int* slot);
+
+/**
+ * @brief Libera un lote fijado con metric_store_acquire().
+ *
+ * @param ch Canal.
+ * @param slot Índice devuelto por metric_store_acquire().
+ */
+void metric_store_release(metric_channel_t* ch, int slot);
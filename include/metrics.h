@@ -9,6 +9,7 @@
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
+#include "proc_snapshot.h"
 
 /**
  * @brief Tamaño del buffer en bytes.
@@ -83,44 +84,52 @@
 /**
  * @brief Obtiene la cantidad de cambios de contexto del sistema desde /proc/stat.
  *
+ * Todos los getters trabajan sobre la instantánea del ciclo actual (ver update_snapshot()).
+ *
+ * @param snap Instantánea de /proc del ciclo actual.
  * @return Cantidad de cambios de contexto, o -1 en caso de error.
  */
-unsigned long long get_change_context();
+unsigned long long get_change_context(const proc_snapshot_t* snap);
 
 /**
  * @brief Obtiene la cantidad total de procesos del sistema desde /proc/stat.
  *
+ * @param snap Instantánea de /proc del ciclo actual.
  * @return Cantidad de procesos del sistema, o -1 en caso de error.
  */
-unsigned long long get_total_processes();
+unsigned long long get_total_processes(const proc_snapshot_t* snap);
 
 /**
  * @brief Obtiene la suma total de lecturas y escrituras en el disco desde /proc/diskstats.
  *
+ * @param snap Instantánea de /proc del ciclo actual.
  * @return Suma de lecturas y escrituras del disco en bytes, o -1.0 en caso de error.
  */
-double get_disk_stats();
+double get_disk_stats(const proc_snapshot_t* snap);
 
 /**
  * @brief Obtiene la memoria total del sistema desde /proc/meminfo.
  *
+ * @param snap Instantánea de /proc del ciclo actual.
  * @return Memoria total del sistema en bytes, o -1.0 en caso de error.
  */
-double get_memory_total();
+double get_memory_total(const proc_snapshot_t* snap);
 
 /**
  * @brief Obtiene la memoria disponible del sistema desde /proc/meminfo.
  *
+ * @param snap Instantánea de /proc del ciclo actual.
  * @return Memoria disponible del sistema en bytes, o -1.0 en caso de error.
  */
-double get_memory_avalible();
+double get_memory_avalible(const proc_snapshot_t* snap);
 
 /**
  * @brief Obtiene la memoria en uso del sistema desde /proc/meminfo, no expresada como porcentaje.
  *
+ * @param snap Instantánea de /proc del ciclo actual.
  * @return Memoria en uso del sistema en bytes, o -1.0 en caso de error.
  */
-double get_memory_usage_2();
+double get_memory_usage_2(const proc_snapshot_t* snap);
 
 /**
  * @brief Obtiene el porcentaje de uso de memoria desde /proc/meminfo.
@@ -128,9 +137,10 @@ double get_memory_usage_2();
  * Lee los valores de memoria total y disponible desde /proc/meminfo y calcula
  * el porcentaje de uso de memoria.
  *
+ * @param snap Instantánea de /proc del ciclo actual.
  * @return Uso de memoria como porcentaje (0.0 a 100.0), o -1.0 en caso de error.
  */
-double get_memory_usage();
+double get_memory_usage(const proc_snapshot_t* snap);
 
 /**
  * @brief Obtiene el porcentaje de uso de CPU desde /proc/stat.
@@ -138,49 +148,56 @@ double get_memory_usage();
  * Lee los tiempos de CPU desde /proc/stat y calcula el porcentaje de uso de CPU
  * en un intervalo de tiempo.
  *
+ * @param snap Instantánea de /proc del ciclo actual.
  * @return Uso de CPU como porcentaje (0.0 a 100.0), o -1.0 en caso de error.
  */
-double get_cpu_usage();
+double get_cpu_usage(const proc_snapshot_t* snap);
 
 /**
  * @brief Obtiene el porcentaje de uso de disco desde /proc/diskstats.
  *
  * Esta función lee el estado del uso de discos desde /proc/diskstats, que proporciona estadísticas detalladas de los
- * discos en el sistema, y calcula el uso total de lectura y escritura.
+ * discos en el sistema, y calcula el uso total de lectura y escritura por segundo según el tiempo medido entre
+ * lecturas.
  *
- * @return Porcentaje de uso de disco, o -1.0 en caso de error.
+ * @param snap Instantánea de /proc del ciclo actual.
+ * @return MB por segundo leídos y escritos, o -1.0 en caso de error.
  */
-double get_disk_usage();
+double get_disk_usage(const proc_snapshot_t* snap);
 
 /**
  * @brief Obtiene el tráfico de red desde /proc/net/dev.
  *
  * Lee las estadísticas de las interfaces de red desde /proc/net/dev y calcula el uso de red.
  *
+ * @param snap Instantánea de /proc del ciclo actual.
  * @return Porcentaje de uso de red, o -1.0 en caso de error.
  */
-double get_network_usage();
+double get_network_usage(const proc_snapshot_t* snap);
 
 /**
  * @brief Obtiene el ancho de banda promedio en uso desde /proc/net/dev.
  *
  * Lee los bytes transmitidos y recibidos desde /proc/net/dev y calcula el
- * ancho de banda promedio en uso basado en el intervalo de tiempo de muestreo.
+ * ancho de banda promedio en uso basado en el tiempo medido entre lecturas (no en el intervalo nominal).
  *
+ * @param snap Instantánea de /proc del ciclo actual.
  * @return Ancho de banda en uso en Megabytes por segundo, o -1.0 en caso de error.
  */
-double get_average_bandwidth();
+double get_average_bandwidth(const proc_snapshot_t* snap);
 
 /**
  * @brief Obtiene el número de fallos de página mayores desde /proc/vmstat.
  *
+ * @param snap Instantánea de /proc del ciclo actual.
  * @return Número de fallos de página mayores, o -1 en caso de error.
  */
-unsigned long long get_major_page_faults();
+unsigned long long get_major_page_faults(const proc_snapshot_t* snap);
 
 /**
  * @brief Obtiene el número de fallos de página menores desde /proc/vmstat.
  *
+ * @param snap Instantánea de /proc del ciclo actual.
  * @return Número de fallos de página menores, o -1 en caso de error.
  */
-unsigned long long get_minor_page_faults();
+unsigned long long get_minor_page_faults(const proc_snapshot_t* snap);
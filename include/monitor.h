@@ -0,0 +1,55 @@
+/**
+ * @file monitor.h
+ * @brief Interfaz de libmonitor: arranque, recarga de la configuración y parada del monitor dentro de otro proceso.
+ *
+ * monitoring_project es main.c sobre esta biblioteca. Un programa que embebe el monitor (por ejemplo un balanceador
+ * que usa CPU, PSI y ancho de banda para el control de admisión) llama a monitor_start(), lee los valores con
+ * monitor_snapshot_get() o espera cada instantánea con monitor_snapshot_subscribe() o monitor_snapshot_eventfd(), y
+ * al terminar llama a monitor_stop(). Los hilos del monitor heredan la máscara de señales del hilo que lo inicia.
+ */
+
+#pragma once
+#include "monitor_snapshot.h"
+#include <stdbool.h>
+
+/**
+ * @brief Ruta de la configuración si no se indica otra.
+ */
+#define MONITOR_DEFAULT_CONFIG_PATH "/etc/monitoring_project/config.json"
+
+/**
+ * @brief Opciones de arranque.
+ */
+typedef struct
+{
+    const char* config_path; ///< Ruta de config.json, o NULL para MONITOR_DEFAULT_CONFIG_PATH.
+    bool serve_http;         ///< true para atender /metrics y /history en la dirección de config.json.
+} monitor_options_t;
+
+/**
+ * @brief Inicia el monitor: lee config.json, inicia el servidor HTTP (si se pidió), el historial, el envío, el
+ * agregador, las alertas y las tareas de recolección.
+ *
+ * Un config.json ausente o inválido no impide arrancar: se usan los valores por defecto. Si falla, detiene lo que
+ * llegó a iniciar como monitor_stop(), así que se puede volver a llamar.
+ *
+ * @param options Opciones, o NULL para las de por defecto con servidor HTTP.
+ * @return 0 en caso de éxito, -1 si no se pudo iniciar el servidor HTTP o las tareas.
+ */
+int monitor_start(const monitor_options_t* options);
+
+/**
+ * @brief Espera un cambio de config.json y, si el archivo nuevo es válido, lo aplica.
+ *
+ * Los parámetros de arranque (servidor HTTP, historial, envío, agregador y destinos de las alertas) no cambian al
+ * recargar; las reglas de alerta sí.
+ *
+ * @param timeout_ms Tiempo máximo de espera en milisegundos.
+ * @return 1 si se aplicó una configuración nueva, 0 si no.
+ */
+int monitor_poll_config(int timeout_ms);
+
+/**
+ * @brief Detiene el monitor y libera lo iniciado por monitor_start().
+ */
+void monitor_stop();
@@ -0,0 +1,140 @@
+/**
+ * @file monitor_snapshot.h
+ * @brief Instantánea versionada de todas las métricas para consumidores dentro del mismo proceso.
+ *
+ * Cada vez que una tarea de recolección publica su lote, el primer hilo que llega copia el último lote publicado de
+ * cada canal del almacén en una instantánea nueva y la publica con el mismo protocolo de metric_store.h: varios
+ * buffers, un índice publicado y un contador de lectores por buffer. monitor_snapshot_get() fija la última
+ * instantánea sin tomar ningún lock ni esperar a los productores; mientras esté fijada su contenido no cambia. Cada
+ * lote entra entero, y la instantánea reúne el último lote de cada tarea, con los contadores como valores absolutos.
+ *
+ * El armado empieza con la primera llamada a monitor_snapshot_get(), monitor_snapshot_subscribe() o
+ * monitor_snapshot_eventfd(): el monitor como ejecutable independiente no paga la copia si nadie la lee.
+ */
+
+#pragma once
+#include "metric_store.h"
+#include <stdint.h>
+
+/**
+ * @brief Buffers de instantáneas: uno publicado, uno en armado y dos para lectores que las retienen.
+ */
+#define MONITOR_SNAPSHOT_BUFFERS 4
+
+/**
+ * @brief Cantidad máxima de suscriptores.
+ */
+#define MONITOR_SNAPSHOT_MAX_SUBSCRIBERS 8
+
+/**
+ * @brief Muestra de una instantánea.
+ */
+typedef struct
+{
+    const char* name;                                  ///< Nombre de la métrica.
+    metric_kind_t kind;                                ///< METRIC_GAUGE o METRIC_COUNTER.
+    int label_count;                                   ///< Cantidad de etiquetas válidas.
+    const char* label_names[METRIC_MAX_LABELS];        ///< Nombres de las etiquetas, o NULL si no se conocen.
+    char labels[METRIC_MAX_LABELS][METRIC_LABEL_SIZE]; ///< Valores de las etiquetas.
+    double value;                                      ///< Valor (absoluto en los contadores).
+} monitor_sample_t;
+
+/**
+ * @brief Instantánea publicada; es de solo lectura para quien la fija.
+ */
+typedef struct
+{
+    unsigned long long version;      ///< Aumenta en 1 con cada instantánea publicada.
+    unsigned long long generation;   ///< Generación del almacén (metric_store_generation()) al armarla.
+    int64_t timestamp_ms;            ///< Instante de armado, en milisegundos desde la época.
+    size_t count;                    ///< Muestras válidas.
+    const monitor_sample_t* samples; ///< Muestras, agrupadas por tarea en el orden de cada lote.
+} monitor_snapshot_t;
+
+/**
+ * @brief Función que se llama con cada instantánea publicada.
+ *
+ * Corre en el hilo que armó la instantánea: el de recolección, o el que soltó un buffer con
+ * monitor_snapshot_release() cuando todos estaban fijados. Debe volver rápido y no puede llamar a
+ * monitor_snapshot_unsubscribe(). La instantánea es válida solo durante la llamada; para retenerla hay que fijarla
+ * con monitor_snapshot_get().
+ */
+typedef void (*monitor_snapshot_cb)(const monitor_snapshot_t* snapshot, void* arg);
+
+/**
+ * @brief Fija la última instantánea publicada.
+ *
+ * La primera llamada activa el armado y arma la primera instantánea con lo que ya esté publicado en el almacén.
+ *
+ * @return Instantánea, que se suelta con monitor_snapshot_release(), o NULL si todavía no hay ninguna.
+ */
+const monitor_snapshot_t* monitor_snapshot_get();
+
+/**
+ * @brief Suelta una instantánea fijada con monitor_snapshot_get().
+ *
+ * Si era el último lector del buffer y un lote quedó sin reflejar porque todos los buffers estaban fijados, arma y
+ * publica la instantánea pendiente antes de volver.
+ *
+ * @param snapshot Instantánea (se ignora si es NULL).
+ */
+void monitor_snapshot_release(const monitor_snapshot_t* snapshot);
+
+/**
+ * @brief Devuelve la versión de la última instantánea publicada, sin fijarla.
+ *
+ * @return Versión, o 0 si todavía no hay ninguna.
+ */
+unsigned long long monitor_snapshot_version();
+
+/**
+ * @brief Busca una serie en una instantánea.
+ *
+ * @param snapshot Instantánea fijada.
+ * @param name Nombre de la métrica.
+ * @param labels Valores de las etiquetas, en el orden de la métrica (puede ser NULL si label_count es 0).
+ * @param label_count Cantidad de valores; se comparan solo los primeros label_count.
+ * @return Primera muestra que coincide, o NULL.
+ */
+const monitor_sample_t* monitor_snapshot_find(const monitor_snapshot_t* snapshot, const char* name,
+                                              const char* const* labels, int label_count);
+
+/**
+ * @brief Registra una función que se llama con cada instantánea publicada.
+ *
+ * @param cb Función.
+ * @param arg Argumento de la función.
+ * @return Identificador para monitor_snapshot_unsubscribe(), o -1 si no hay lugar.
+ */
+int monitor_snapshot_subscribe(monitor_snapshot_cb cb, void* arg);
+
+/**
+ * @brief Quita una suscripción; al volver, la función ya no se está ejecutando ni se vuelve a llamar.
+ *
+ * @param id Identificador devuelto por monitor_snapshot_subscribe().
+ */
+void monitor_snapshot_unsubscribe(int id);
+
+/**
+ * @brief Devuelve un eventfd que se incrementa con cada instantánea publicada.
+ *
+ * El descriptor es no bloqueante: quien lo espera con poll() o epoll lee 8 bytes para vaciarlo y después llama a
+ * monitor_snapshot_get(). Es el mismo descriptor en todas las llamadas y se cierra con monitor_snapshot_close().
+ *
+ * @return Descriptor, o -1 en caso de error.
+ */
+int monitor_snapshot_eventfd();
+
+/**
+ * @brief Arma y publica una instantánea nueva si el armado está activo.
+ *
+ * Lo llama collector.c después de cada lote publicado. Si otro hilo está armando una, se le pide que arme otra al
+ * terminar y se vuelve de inmediato; si todos los buffers están fijados por lectores se reintenta con el lote
+ * siguiente.
+ */
+void monitor_snapshot_update();
+
+/**
+ * @brief Libera los buffers y cierra el eventfd; las instantáneas fijadas dejan de ser válidas.
+ */
+void monitor_snapshot_close();
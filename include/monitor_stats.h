@@ -0,0 +1,106 @@
+/**
+ * @file monitor_stats.h
+ * @brief Contadores del costo del propio monitor: bytes leídos de /proc, syscalls y memoria residente.
+ *
+ * Los lectores de /proc y de cgroupfs cuentan cada open(), pread() y close() con sumas atómicas relajadas, que no
+ * ordenan nada y no agregan locks al camino de lectura. Las métricas monitor_* de expose_metrics.c los publican junto
+ * con los histogramas de duración de las tareas, del render y del manejador HTTP.
+ *
+ * Compilado con MONITOR_COUNT_ALLOCATIONS, el monitor reemplaza malloc(), calloc() y realloc() por envoltorios que
+ * cuentan cada reserva, en total y por hilo, antes de delegar en las funciones de glibc. Así se verifica que un ciclo
+ * de recolección, pasado el calentamiento, no toca el heap.
+ */
+
+#pragma once
+#include <sys/types.h>
+
+/**
+ * @brief Syscalls contadas, usadas como etiqueta "syscall" de monitor_syscalls_total.
+ */
+typedef enum
+{
+    MONITOR_SYSCALL_OPEN,  ///< open() y openat().
+    MONITOR_SYSCALL_READ,  ///< read() y pread().
+    MONITOR_SYSCALL_CLOSE, ///< close().
+    MONITOR_SYSCALL_URING, ///< io_uring_enter(), que envía y espera un lote de lecturas.
+    MONITOR_SYSCALL_COUNT  ///< Cantidad de syscalls contadas.
+} monitor_syscall_t;
+
+/**
+ * @brief Instante de CLOCK_MONOTONIC_RAW en nanosegundos, para medir duraciones sin el ajuste de NTP.
+ *
+ * @return Nanosegundos desde un origen arbitrario.
+ */
+unsigned long long monitor_clock_ns();
+
+/**
+ * @brief Cuenta una syscall.
+ *
+ * @param call Syscall.
+ */
+void monitor_count_syscall(monitor_syscall_t call);
+
+/**
+ * @brief Cuenta una lectura y los bytes que devolvió.
+ *
+ * @param bytes Resultado de read() o pread(); 0 y los errores suman solo la syscall.
+ */
+void monitor_count_read(ssize_t bytes);
+
+/**
+ * @brief Cuenta los bytes de una lectura completada por io_uring, que no es una syscall propia.
+ *
+ * @param bytes Resultado de la lectura; 0 y los errores no suman.
+ */
+void monitor_count_bytes(ssize_t bytes);
+
+/**
+ * @brief Total de bytes leídos desde el arranque.
+ *
+ * @return Bytes.
+ */
+unsigned long long monitor_read_bytes();
+
+/**
+ * @brief Total de llamadas a una syscall desde el arranque.
+ *
+ * @param call Syscall.
+ * @return Llamadas.
+ */
+unsigned long long monitor_syscalls(monitor_syscall_t call);
+
+/**
+ * @brief Nombre de una syscall para la etiqueta "syscall".
+ *
+ * @param call Syscall.
+ * @return Nombre.
+ */
+const char* monitor_syscall_name(monitor_syscall_t call);
+
+/**
+ * @brief Memoria residente del proceso según /proc/self/statm.
+ *
+ * @return Bytes, o -1 si no se pudo leer.
+ */
+double monitor_resident_bytes();
+
+/**
+ * @brief Indica si el ejecutable se compiló con MONITOR_COUNT_ALLOCATIONS.
+ *
+ * @return 1 si las reservas se cuentan, 0 si no (los contadores quedan en cero).
+ */
+int monitor_counts_allocations();
+
+/**
+ * @brief Total de reservas del heap (malloc(), calloc() y realloc()) desde el arranque, de todos los hilos.
+ *
+ * @return Reservas.
+ */
+unsigned long long monitor_heap_allocations();
+
+/**
+ * @brief Reservas del heap hechas por el hilo que llama.
+ *
+ * @return Reservas.
+ */
+unsigned long long monitor_thread_allocations();
@@ -0,0 +1,82 @@
+/**
+ * @file netdev.h
+ * @brief Parser de /proc/net/dev con contadores y tasas por interfaz.
+ *
+ * Cada interfaz se guarda en una tabla hash persistente indexada por nombre, de modo que en cada ciclo solo se
+ * parsean las líneas y se actualizan los contadores de las interfaces existentes. Los deltas toleran el desborde de
+ * los contadores de 32 bits que todavía exponen algunos drivers y el reinicio de los contadores de una interfaz.
+ */
+
+#pragma once
+#include "proc_snapshot.h"
+
+/**
+ * @brief Tamaño del nombre de una interfaz.
+ */
+#define NETDEV_NAME_SIZE 32
+
+/**
+ * @brief Contadores de /proc/net/dev seguidos por interfaz.
+ */
+enum netdev_field
+{
+    NETDEV_RX_BYTES,
+    NETDEV_RX_PACKETS,
+    NETDEV_RX_ERRS,
+    NETDEV_RX_DROP,
+    NETDEV_TX_BYTES,
+    NETDEV_TX_PACKETS,
+    NETDEV_TX_ERRS,
+    NETDEV_TX_DROP,
+    NETDEV_FIELD_COUNT
+};
+
+/**
+ * @brief Nombres de los contadores usados en las métricas ("receive_bytes", "transmit_drop", ...).
+ */
+extern const char* const netdev_field_names[NETDEV_FIELD_COUNT];
+
+/**
+ * @brief Estado persistente de una interfaz entre ciclos.
+ */
+typedef struct netdev_iface
+{
+    char name[NETDEV_NAME_SIZE];                  ///< Nombre de la interfaz, usado también como clave de la tabla.
+    int selected;                                 ///< 1 si la interfaz pasa el filtro de loopback y veth.
+    unsigned int filter_generation;               ///< Generación del filtro con la que se resolvió selected.
+    unsigned int last_seen;                       ///< Último ciclo en el que apareció la interfaz.
+    int has_prev;                                 ///< 1 si raw contiene una lectura anterior.
+    unsigned long long prev_timestamp_ns;         ///< Instante de la lectura anterior.
+    unsigned long long raw[NETDEV_FIELD_COUNT];   ///< Últimos valores leídos de /proc/net/dev.
+    unsigned long long total[NETDEV_FIELD_COUNT]; ///< Totales acumulados sin desbordes ni reinicios.
+    unsigned long long delta[NETDEV_FIELD_COUNT]; ///< Incremento de cada contador en el último ciclo.
+    double rate[NETDEV_FIELD_COUNT];              ///< Incremento por segundo en el último ciclo.
+} netdev_iface_t;
+
+/**
+ * @brief Parsea /proc/net/dev y actualiza las interfaces de la instantánea.
+ *
+ * Guarda en la instantánea las interfaces seleccionadas del ciclo y la suma de sus bytes y tasas, que usan
+ * get_network_usage() y get_average_bandwidth().
+ *
+ * @param snap Instantánea a completar; proc_snapshot_t::timestamp_ns debe estar cargado.
+ * @param buf Contenido de /proc/net/dev.
+ * @param len Bytes válidos de buf.
+ * @return 0 en caso de éxito, -1 en caso de error.
+ */
+int parse_netdev(proc_snapshot_t* snap, const char* buf, size_t len);
+
+/**
+ * @brief Configura qué interfaces virtuales se incluyen.
+ *
+ * Por defecto se excluyen "lo" y las interfaces veth* de los contenedores, que duplican el tráfico de sus puentes.
+ *
+ * @param include_loopback 1 para incluir la interfaz de loopback.
+ * @param include_veth 1 para incluir las interfaces veth*.
+ */
+void set_netdev_filter(int include_loopback, int include_veth);
+
+/**
+ * @brief Libera la tabla de interfaces.
+ */
+void netdev_close();
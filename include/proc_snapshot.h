@@ -0,0 +1,373 @@
+/**
+ * @file proc_snapshot.h
+ * @brief Instantánea de los archivos de /proc leída una sola vez por ciclo de muestreo.
+ *
+ * Cada archivo fuente (/proc/stat, /proc/meminfo, /proc/vmstat, /proc/diskstats, /proc/net/dev,
+ * /proc/pressure/{cpu,memory,io} y /proc/schedstat) se lee y se parsea una única vez por ciclo dentro de un
+ * proc_snapshot_t. Todos los getters de metrics.h trabajan a partir de esta estructura, de modo que los valores de
+ * una misma muestra son coherentes entre sí. Los procesos (/proc/[pid]) y los cgroups no son un único archivo: sus
+ * fuentes recorren un directorio y mantienen su propia tabla persistente.
+ */
+
+#pragma once
+#include "cpu_stats.h"
+#include "memstat_fields.h"
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Raíz de /proc si no se indica otra con snapshot_set_proc_root().
+ */
+#define PROC_ROOT "/proc"
+
+/**
+ * @brief Raíz de /sys si no se indica otra con snapshot_set_sys_root().
+ */
+#define SYS_ROOT "/sys"
+
+/**
+ * @brief Tamaño máximo de la raíz de /proc y de las rutas armadas a partir de ella.
+ */
+#define PROC_PATH_SIZE 512
+
+/**
+ * @brief Tamaño inicial del buffer de lectura de cada fuente de /proc.
+ */
+#define PROC_BUFFER_SIZE 16384
+
+/**
+ * @brief Bit de validez de /proc/stat.
+ */
+#define SNAPSHOT_STAT (1u << 0)
+
+/**
+ * @brief Bit de validez de /proc/meminfo.
+ */
+#define SNAPSHOT_MEMINFO (1u << 1)
+
+/**
+ * @brief Bit de validez de /proc/vmstat.
+ */
+#define SNAPSHOT_VMSTAT (1u << 2)
+
+/**
+ * @brief Bit de validez de /proc/diskstats.
+ */
+#define SNAPSHOT_DISKSTATS (1u << 3)
+
+/**
+ * @brief Bit de validez de /proc/net/dev.
+ */
+#define SNAPSHOT_NETDEV (1u << 4)
+
+/**
+ * @brief Bit de validez de la tabla de procesos (/proc/[pid], ver proctable.h).
+ */
+#define SNAPSHOT_PROCS (1u << 5)
+
+/**
+ * @brief Bit de validez de los cgroups (/sys/fs/cgroup, ver cgroup_stats.h).
+ */
+#define SNAPSHOT_CGROUPS (1u << 6)
+
+/**
+ * @brief Bit de validez de /proc/pressure/cpu.
+ */
+#define SNAPSHOT_PSI_CPU (1u << 7)
+
+/**
+ * @brief Bit de validez de /proc/pressure/memory.
+ */
+#define SNAPSHOT_PSI_MEMORY (1u << 8)
+
+/**
+ * @brief Bit de validez de /proc/pressure/io.
+ */
+#define SNAPSHOT_PSI_IO (1u << 9)
+
+/**
+ * @brief Las tres fuentes de Pressure Stall Information.
+ */
+#define SNAPSHOT_PSI (SNAPSHOT_PSI_CPU | SNAPSHOT_PSI_MEMORY | SNAPSHOT_PSI_IO)
+
+/**
+ * @brief Bit de validez de /proc/schedstat.
+ */
+#define SNAPSHOT_SCHEDSTAT (1u << 10)
+
+/**
+ * @brief Bit de validez de los histogramas de latencia de eBPF (ver bpf_latency.h).
+ */
+#define SNAPSHOT_BPF (1u << 11)
+
+/**
+ * @brief Bit de validez de los sistemas de archivos montados (statvfs(), ver fs_stats.h).
+ */
+#define SNAPSHOT_FILESYSTEMS (1u << 12)
+
+/**
+ * @brief Todas las fuentes de la instantánea.
+ */
+#define SNAPSHOT_ALL                                                                                                   \
+    (SNAPSHOT_STAT | SNAPSHOT_MEMINFO | SNAPSHOT_VMSTAT | SNAPSHOT_DISKSTATS | SNAPSHOT_NETDEV | SNAPSHOT_PROCS |      \
+     SNAPSHOT_CGROUPS | SNAPSHOT_PSI | SNAPSHOT_SCHEDSTAT | SNAPSHOT_BPF | SNAPSHOT_FILESYSTEMS)
+
+/**
+ * @brief Archivo de /proc abierto de forma persistente y su buffer de lectura preasignado.
+ */
+typedef struct
+{
+    const char* path; ///< Ruta del archivo relativa a la raíz de /proc.
+    int fd;           ///< Descriptor persistente, o -1 si no está abierto.
+    char* buf;        ///< Buffer de lectura, terminado en '\0' tras cada lectura.
+    size_t cap;       ///< Capacidad del buffer en bytes.
+    size_t len;       ///< Bytes válidos de la última lectura.
+    int optional;     ///< 1 si el archivo puede no existir (por ejemplo /proc/pressure sin CONFIG_PSI).
+} proc_source_t;
+
+/**
+ * @brief Cantidad máxima de dispositivos de bloque seguidos a la vez.
+ */
+#define MAX_DISK_DEVICES 64
+
+/**
+ * @brief Tamaño del nombre de un dispositivo.
+ */
+#define DISK_NAME_SIZE 32
+
+/**
+ * @brief Contadores y tasas de un dispositivo de bloque en un ciclo.
+ */
+typedef struct
+{
+    char name[DISK_NAME_SIZE];        ///< Nombre del dispositivo (por ejemplo "nvme0n1").
+    unsigned long long reads;         ///< Lecturas completadas.
+    unsigned long long writes;        ///< Escrituras completadas.
+    unsigned long long read_sectors;  ///< Sectores leídos.
+    unsigned long long write_sectors; ///< Sectores escritos.
+    double read_bytes_per_second;     ///< Tasa de lectura desde el ciclo anterior.
+    double write_bytes_per_second;    ///< Tasa de escritura desde el ciclo anterior.
+} disk_device_t;
+
+/**
+ * @brief Recursos de /proc/pressure.
+ */
+enum psi_resource
+{
+    PSI_CPU,
+    PSI_MEMORY,
+    PSI_IO,
+    PSI_RESOURCE_COUNT
+};
+
+/**
+ * @brief Líneas de cada archivo de /proc/pressure.
+ */
+enum psi_kind
+{
+    PSI_SOME, ///< Al menos una tarea demorada por el recurso.
+    PSI_FULL, ///< Todas las tareas no ociosas demoradas a la vez.
+    PSI_KIND_COUNT
+};
+
+/**
+ * @brief Una línea de /proc/pressure: "some avg10=0.12 avg60=0.05 avg300=0.01 total=123456".
+ */
+typedef struct
+{
+    double avg10;             ///< Porcentaje de tiempo demorado en los últimos 10 segundos.
+    double avg60;             ///< Porcentaje de tiempo demorado en los últimos 60 segundos.
+    double avg300;            ///< Porcentaje de tiempo demorado en los últimos 300 segundos.
+    unsigned long long total; ///< Tiempo demorado acumulado en microsegundos.
+} psi_stall_t;
+
+/**
+ * @brief Estado de una interfaz de red (definido en netdev.h).
+ */
+struct netdev_iface;
+
+/**
+ * @brief Totales y rankings de la tabla de procesos (definido en proctable.h).
+ */
+struct proc_top;
+
+/**
+ * @brief Uso de un cgroup (definido en cgroup_stats.h).
+ */
+struct cgroup_usage;
+
+/**
+ * @brief Histograma de latencias armado por eBPF (definido en bpf_latency_maps.h).
+ */
+struct bpf_latency_slots;
+
+/**
+ * @brief Capacidad de un sistema de archivos montado (definido en fs_stats.h).
+ */
+struct fs_mount;
+
+/**
+ * @brief Valores parseados de todas las fuentes de /proc en un mismo ciclo.
+ */
+typedef struct
+{
+    unsigned int valid;              ///< Máscara SNAPSHOT_* de las fuentes leídas correctamente.
+    unsigned long long timestamp_ns; ///< Instante de la lectura según CLOCK_MONOTONIC.
+
+    unsigned long long cpu_user;    ///< Tiempo de CPU en modo usuario (línea "cpu" de /proc/stat).
+    unsigned long long cpu_nice;    ///< Tiempo de CPU en modo usuario con prioridad baja.
+    unsigned long long cpu_system;  ///< Tiempo de CPU en modo kernel.
+    unsigned long long cpu_idle;    ///< Tiempo de CPU ociosa.
+    unsigned long long cpu_iowait;  ///< Tiempo de CPU esperando E/S.
+    unsigned long long cpu_irq;     ///< Tiempo de CPU atendiendo interrupciones.
+    unsigned long long cpu_softirq; ///< Tiempo de CPU atendiendo softirqs.
+    unsigned long long cpu_steal;   ///< Tiempo de CPU robado por el hipervisor.
+    const cpu_stats_t* cpus;        ///< Contadores y porcentajes por CPU de esta lectura (ver cpu_stats.h).
+    unsigned long long ctxt;        ///< Cambios de contexto desde el arranque.
+    double ctxt_per_second;         ///< Cambios de contexto por segundo desde la lectura anterior de /proc/stat.
+    unsigned long long processes;   ///< Procesos creados desde el arranque.
+
+    unsigned long long memstat[MEMSTAT_FIELD_COUNT]; ///< Campos de /proc/meminfo (en kB) y /proc/vmstat.
+    unsigned long long memstat_found;                ///< Máscara de los campos de memstat leídos en el ciclo.
+
+    disk_device_t disks[MAX_DISK_DEVICES]; ///< Dispositivos seleccionados por la lista de permitidos.
+    int disk_count;                        ///< Cantidad de entradas válidas en disks.
+    unsigned long long disk_reads;         ///< Lecturas completadas sumando los dispositivos seleccionados.
+    unsigned long long disk_writes;        ///< Escrituras completadas sumando los dispositivos seleccionados.
+    unsigned long long disk_read_sectors;  ///< Sectores leídos sumando los dispositivos seleccionados.
+    unsigned long long disk_write_sectors; ///< Sectores escritos sumando los dispositivos seleccionados.
+
+    const struct netdev_iface* const* net_ifaces; ///< Interfaces seleccionadas por el filtro (ver netdev.h).
+    int net_iface_count;                          ///< Cantidad de entradas válidas en net_ifaces.
+    unsigned long long net_rx_bytes;              ///< Bytes recibidos sumando las interfaces seleccionadas.
+    unsigned long long net_tx_bytes;              ///< Bytes transmitidos sumando las interfaces seleccionadas.
+    double net_rx_bytes_per_second;               ///< Tasa de recepción sumando las interfaces seleccionadas.
+    double net_tx_bytes_per_second;               ///< Tasa de transmisión sumando las interfaces seleccionadas.
+
+    psi_stall_t psi[PSI_RESOURCE_COUNT][PSI_KIND_COUNT]; ///< some y full de cada recurso de /proc/pressure.
+
+    unsigned long long sched_run_ns;     ///< Tiempo ejecutando tareas sumando todas las CPUs (/proc/schedstat).
+    unsigned long long sched_wait_ns;    ///< Tiempo esperando en la cola de ejecución sumando todas las CPUs.
+    unsigned long long sched_timeslices; ///< Porciones de tiempo ejecutadas sumando todas las CPUs.
+    double sched_average_wait_seconds;   ///< Espera media en la cola por porción desde la lectura anterior.
+
+    const struct proc_top* procs;              ///< Procesos seguidos y rankings del ciclo (ver proctable.h).
+    const struct cgroup_usage* const* cgroups; ///< Cgroups seguidos (ver cgroup_stats.h).
+    int cgroup_count;                          ///< Cantidad de entradas válidas en cgroups.
+
+    const struct bpf_latency_slots* latency; ///< Histogramas por enum bpf_latency_kind, o NULL sin eBPF.
+
+    const struct fs_mount* mounts; ///< Montajes seleccionados (ver fs_stats.h).
+    int mount_count;               ///< Cantidad de entradas válidas en mounts.
+} proc_snapshot_t;
+
+/**
+ * @brief Devuelve el instante actual de CLOCK_MONOTONIC en nanosegundos.
+ *
+ * @return Nanosegundos desde un origen arbitrario, no afectado por cambios del reloj de pared.
+ */
+unsigned long long monotonic_ns();
+
+/**
+ * @brief Devuelve el instante actual de CLOCK_REALTIME en milisegundos, para las muestras que salen del proceso.
+ *
+ * @return Milisegundos desde la época.
+ */
+int64_t realtime_ms();
+
+/**
+ * @brief Cambia la raíz de la que se leen las fuentes, por ejemplo un directorio de fixtures capturados.
+ *
+ * Cierra todo lo abierto con snapshot_close(); después hay que volver a llamar a snapshot_init(). Con una raíz
+ * distinta de PROC_ROOT la cantidad de CPUs sale de las líneas "cpuN" de su stat y no del sistema.
+ *
+ * @param root Directorio con la estructura de /proc, o NULL para PROC_ROOT.
+ * @return 0 en caso de éxito, -1 si la ruta es demasiado larga.
+ */
+int snapshot_set_proc_root(const char* root);
+
+/**
+ * @brief Raíz vigente de /proc.
+ *
+ * @return Ruta del directorio.
+ */
+const char* snapshot_proc_root();
+
+/**
+ * @brief Cambia la raíz de /sys, de la que diskstats.c toma los discos completos (block/) cuando no hay lista de
+ * dispositivos permitidos.
+ *
+ * Igual que snapshot_set_proc_root(), cierra todo lo abierto con snapshot_close(). Los fixtures capturados la
+ * incluyen en su subdirectorio sys/.
+ *
+ * @param root Directorio con la estructura de /sys, o NULL para SYS_ROOT.
+ * @return 0 en caso de éxito, -1 si la ruta es demasiado larga.
+ */
+int snapshot_set_sys_root(const char* root);
+
+/**
+ * @brief Raíz vigente de /sys.
+ *
+ * @return Ruta del directorio.
+ */
+const char* snapshot_sys_root();
+
+/**
+ * @brief Abre de forma persistente todas las fuentes de /proc y reserva sus buffers.
+ *
+ * Se llama una sola vez desde init_metrics(). Las fuentes que no se puedan abrir se reintentan en cada lectura.
+ *
+ * @return 0 si todas las fuentes se abrieron, -1 si alguna falló.
+ */
+int snapshot_init();
+
+/**
+ * @brief Cierra los descriptores y libera los buffers abiertos por snapshot_init().
+ */
+void snapshot_close();
+
+/**
+ * @brief Relee una fuente completa con pread() desde el desplazamiento 0.
+ *
+ * El buffer crece al doble si el contenido no entra, por lo que en régimen estable no hay reservas de memoria.
+ *
+ * @param src Fuente a leer.
+ * @return 0 en caso de éxito, -1 en caso de error.
+ */
+int proc_source_read(proc_source_t* src);
+
+/**
+ * @brief Parsea el contenido de una fuente ya leído y marca su bit de validez en la instantánea.
+ *
+ * Permite reutilizar los parsers sobre contenidos capturados (por ejemplo en los benchmarks).
+ *
+ * @param snap Instantánea a completar.
+ * @param source Bit SNAPSHOT_* de la fuente.
+ * @param buf Contenido de la fuente.
+ * @param len Bytes válidos de buf.
+ * @return 0 en caso de éxito, -1 en caso de error.
+ */
+int parse_snapshot_source(proc_snapshot_t* snap, unsigned int source, const char* buf, size_t len);
+
+/**
+ * @brief Lee y parsea una vez cada archivo fuente de /proc dentro de la instantánea.
+ *
+ * Las fuentes que no se pudieron leer quedan sin su bit en proc_snapshot_t::valid y los getters que dependen de
+ * ellas devuelven error.
+ *
+ * @param snap Instantánea a actualizar.
+ * @return 0 si todas las fuentes se leyeron, -1 si alguna falló.
+ */
+int update_snapshot(proc_snapshot_t* snap);
+
+/**
+ * @brief Lee y parsea solo las fuentes indicadas dentro de la instantánea.
+ *
+ * Cada fuente mantiene estado propio (buffer, contadores previos), por lo que fuentes distintas pueden leerse desde
+ * hilos distintos, pero una misma fuente no debe leerse desde dos hilos a la vez.
+ *
+ * @param snap Instantánea a actualizar; los campos de las demás fuentes quedan en cero.
+ * @param mask Máscara SNAPSHOT_* de las fuentes a leer.
+ * @return 0 si todas las fuentes indicadas se leyeron, -1 si alguna falló.
+ */
+int update_snapshot_sources(proc_snapshot_t* snap, unsigned int mask);
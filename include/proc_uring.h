@@ -0,0 +1,52 @@
+/**
+ * @file proc_uring.h
+ * @brief Lecturas de /proc en lote con io_uring, sin liburing.
+ *
+ * El anillo se crea con io_uring_setup() y se mapea a mano; cada lectura encolada es un IORING_OP_READ sobre un
+ * descriptor ya abierto y un único io_uring_enter() envía el lote y espera todas las respuestas. En un host con miles
+ * de procesos eso reemplaza miles de pread() por una syscall cada PROC_URING_DEPTH lecturas. Sin io_uring en el
+ * kernel (anterior a 5.6, deshabilitado por kernel.io_uring_disabled o filtrado por seccomp), o sin
+ * linux/io_uring.h al compilar, proc_uring_init() falla y el llamador sigue con pread().
+ */
+
+#pragma once
+#include <stddef.h>
+#include <sys/types.h>
+
+/**
+ * @brief Entradas del anillo de envío: lecturas máximas por lote.
+ */
+#define PROC_URING_DEPTH 512
+
+/**
+ * @brief Crea el anillo y verifica que el kernel soporte IORING_OP_READ.
+ *
+ * Solo lo usa un hilo a la vez; un anillo ya creado se conserva.
+ *
+ * @return 0 en caso de éxito, -1 si io_uring no está disponible (errno indica la causa).
+ */
+int proc_uring_init();
+
+/**
+ * @brief Encola la lectura de un archivo desde el inicio; no se envía hasta proc_uring_submit().
+ *
+ * @param fd Descriptor abierto.
+ * @param buf Buffer de lectura; debe seguir válido hasta que proc_uring_submit() termine.
+ * @param len Bytes a leer.
+ * @param tag Índice en el arreglo de resultados de proc_uring_submit(), menor que PROC_URING_DEPTH.
+ * @return 0 en caso de éxito, -1 si el lote ya tiene PROC_URING_DEPTH lecturas.
+ */
+int proc_uring_queue_read(int fd, void* buf, size_t len, unsigned int tag);
+
+/**
+ * @brief Envía las lecturas encoladas y espera todas las respuestas.
+ *
+ * @param results Resultado de cada lectura indexado por su tag: bytes leídos, o -errno en caso de error.
+ * @return Lecturas completadas, o -1 si io_uring_enter() falló (el anillo queda vacío y results sin cargar).
+ */
+int proc_uring_submit(ssize_t results[PROC_URING_DEPTH]);
+
+/**
+ * @brief Desmapea y cierra el anillo.
+ */
+void proc_uring_close();
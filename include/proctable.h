@@ -0,0 +1,154 @@
+/**
+ * @file proctable.h
+ * @brief Tabla persistente de procesos con lectura incremental de /proc/[pid] y ranking de los que más consumen.
+ *
+ * Cada proceso se guarda en una tabla indexada por PID. En cada ciclo solo se recorre el directorio /proc para
+ * detectar altas y bajas y se releen /proc/[pid]/stat y /proc/[pid]/io; los procesos que sobreviven varios ciclos
+ * conservan sus descriptores abiertos y se releen con pread(), sin volver a resolver la ruta. Se exportan solo los N
+ * procesos con más CPU, memoria residente y E/S, indexados por su puesto, de modo que la cantidad de series no
+ * depende de cuántos procesos corran ni de sus nombres.
+ *
+ * Con el motor io_uring las relecturas de todos los descriptores persistentes de un ciclo se envían en lotes de una
+ * sola syscall (ver proc_uring.h); si el kernel no lo soporta se usa pread().
+ */
+
+#pragma once
+#include "proc_snapshot.h"
+
+/**
+ * @brief Tamaño del nombre de un proceso (campo comm, 15 caracteres más '\0').
+ */
+#define PROCTABLE_COMM_SIZE 16
+
+/**
+ * @brief Tamaño del PID en texto, usado como clave de la tabla.
+ */
+#define PROCTABLE_PID_SIZE 12
+
+/**
+ * @brief Cantidad máxima de procesos por ranking.
+ */
+#define PROCTABLE_TOP_MAX 32
+
+/**
+ * @brief Cantidad de procesos por ranking si config.json no indica otra.
+ */
+#define PROCTABLE_DEFAULT_TOP_N 10
+
+/**
+ * @brief Ciclos que debe sobrevivir un proceso para conservar sus descriptores abiertos.
+ */
+#define PROCTABLE_FD_MIN_AGE 3
+
+/**
+ * @brief Valores de "process_io_engine" en config.json.
+ */
+#define PROCTABLE_IO_ENGINE_PREAD "pread"
+#define PROCTABLE_IO_ENGINE_URING "io_uring"
+
+/**
+ * @brief Motor de lectura de /proc/[pid].
+ */
+typedef enum
+{
+    PROCTABLE_IO_PREAD, ///< Un pread() por archivo.
+    PROCTABLE_IO_URING  ///< Lotes de io_uring para los descriptores persistentes, con pread() como respaldo.
+} proctable_io_engine_t;
+
+/**
+ * @brief Recursos por los que se ordenan los procesos.
+ */
+enum proc_rank
+{
+    PROC_RANK_CPU, ///< Porcentaje de CPU (sobre un núcleo).
+    PROC_RANK_RSS, ///< Memoria residente.
+    PROC_RANK_IO,  ///< Bytes leídos y escritos por segundo.
+    PROC_RANK_COUNT
+};
+
+/**
+ * @brief Nombres de los recursos usados en las etiquetas ("cpu", "rss", "io").
+ */
+extern const char* const proc_rank_names[PROC_RANK_COUNT];
+
+/**
+ * @brief Estado persistente de un proceso entre ciclos.
+ */
+typedef struct proc_entry
+{
+    char key[PROCTABLE_PID_SIZE];         ///< PID en texto, usado también como clave de la tabla.
+    int pid;                              ///< PID.
+    char comm[PROCTABLE_COMM_SIZE];       ///< Nombre del ejecutable según /proc/[pid]/stat.
+    unsigned long long start_time;        ///< Instante de inicio en ticks, para detectar PIDs reutilizados.
+    int stat_fd;                          ///< Descriptor persistente de /proc/[pid]/stat, o -1.
+    int io_fd;                            ///< Descriptor persistente de /proc/[pid]/io, o -1.
+    int io_denied;                        ///< 1 si /proc/[pid]/io no se puede leer (proceso de otro usuario).
+    unsigned int last_seen;               ///< Último ciclo en el que apareció el proceso.
+    unsigned int age;                     ///< Ciclos consecutivos en los que se leyó el proceso.
+    int has_prev;                         ///< 1 si hay una lectura anterior para calcular tasas.
+    unsigned long long prev_timestamp_ns; ///< Instante de la lectura anterior.
+    unsigned long long cpu_ticks;         ///< utime + stime en ticks de reloj.
+    unsigned long long read_bytes;        ///< read_bytes de /proc/[pid]/io.
+    unsigned long long write_bytes;       ///< write_bytes de /proc/[pid]/io.
+    unsigned long long rss_bytes;         ///< Memoria residente en bytes.
+    double cpu_percent;                   ///< Uso de CPU desde el ciclo anterior (100 = un núcleo).
+    double io_bytes_per_second;           ///< Bytes leídos y escritos por segundo desde el ciclo anterior.
+} proc_entry_t;
+
+/**
+ * @brief Resultado de un ciclo: totales de la tabla y rankings.
+ */
+typedef struct proc_top
+{
+    int tracked;                                                 ///< Procesos en la tabla.
+    int open_fds;                                                ///< Descriptores persistentes abiertos.
+    unsigned long long births;                                   ///< Procesos nuevos vistos desde el arranque.
+    unsigned long long exits;                                    ///< Procesos terminados vistos desde el arranque.
+    int count[PROC_RANK_COUNT];                                  ///< Entradas válidas de cada ranking.
+    const proc_entry_t* top[PROC_RANK_COUNT][PROCTABLE_TOP_MAX]; ///< Procesos de cada ranking, de mayor a menor.
+} proc_top_t;
+
+/**
+ * @brief Recorre /proc, actualiza la tabla de procesos y calcula los rankings del ciclo.
+ *
+ * El primer recorrido carga la tabla sin contar altas. Los procesos del ranking de CPU y E/S necesitan dos lecturas.
+ *
+ * @param snap Instantánea a completar; proc_snapshot_t::timestamp_ns debe estar cargado.
+ * @return 0 en caso de éxito, -1 en caso de error.
+ */
+int proctable_scan(proc_snapshot_t* snap);
+
+/**
+ * @brief Parsea comm, utime, stime, starttime y rss de /proc/[pid]/stat.
+ *
+ * comm puede contener espacios y paréntesis, por lo que los campos numéricos se cuentan desde el último ')'.
+ *
+ * @param entry Proceso, del que se actualiza comm.
+ * @param buf Contenido de /proc/[pid]/stat.
+ * @param len Bytes válidos de buf.
+ * @param ticks utime + stime en ticks.
+ * @param start starttime en ticks desde el arranque.
+ * @param rss Memoria residente en páginas.
+ * @return 0 en caso de éxito, -1 en caso de error.
+ */
+int proctable_parse_stat(proc_entry_t* entry, const char* buf, size_t len, unsigned long long* ticks,
+                         unsigned long long* start, unsigned long long* rss);
+
+/**
+ * @brief Configura cuántos procesos se exportan por ranking.
+ *
+ * @param top_n Cantidad entre 1 y PROCTABLE_TOP_MAX; los valores fuera de rango se recortan.
+ */
+void set_proctable_top_n(int top_n);
+
+/**
+ * @brief Elige el motor de lectura de /proc/[pid]; el cambio rige desde el próximo recorrido.
+ *
+ * @param engine Motor.
+ */
+void set_proctable_io_engine(proctable_io_engine_t engine);
+
+/**
+ * @brief Cierra los descriptores y libera la tabla de procesos.
+ */
+void proctable_close();
@@ -0,0 +1,131 @@
+/**
+ * @file prom_lite.h
+ * @brief Exposición propia con la parte de la API de libprom que usa el monitor.
+ *
+ * Con MONITOR_BUILTIN_EXPOSITION este encabezado reemplaza a <prom.h>: mismos tipos y mismas funciones, de modo que
+ * metric_registry.c y expose_metrics.c compilan sin cambios contra cualquiera de las dos implementaciones. Cada
+ * métrica guarda sus series en una tabla por valores de etiquetas, con un lock propio; el bridge escribe el formato de
+ * texto 0.0.4 en un único buffer reservado con malloc, como el de libprom.
+ */
+
+#pragma once
+#include "arena.h"
+#include <stddef.h>
+
+/**
+ * @brief Métrica de cualquier tipo; los tres nombres de libprom son el mismo tipo.
+ */
+typedef struct prom_metric prom_metric_t;
+typedef prom_metric_t prom_gauge_t;
+typedef prom_metric_t prom_counter_t;
+typedef prom_metric_t prom_histogram_t;
+
+/**
+ * @brief Registro de métricas.
+ */
+typedef struct prom_collector_registry prom_collector_registry_t;
+
+/**
+ * @brief Límites superiores de las cubetas de un histograma, sin la cubeta +Inf.
+ */
+typedef struct prom_histogram_buckets
+{
+    int count;                  ///< Cantidad de cubetas.
+    const double* upper_bounds; ///< Límites superiores, en orden creciente.
+} prom_histogram_buckets_t;
+
+/**
+ * @brief Registro por defecto, creado por prom_collector_registry_default_init().
+ */
+extern prom_collector_registry_t* PROM_COLLECTOR_REGISTRY_DEFAULT;
+
+/**
+ * @brief Crea el registro por defecto.
+ *
+ * @return 0 en caso de éxito, 1 si no hay memoria.
+ */
+int prom_collector_registry_default_init(void);
+
+/**
+ * @brief Agrega una métrica al registro por defecto.
+ *
+ * @param metric Métrica creada con prom_*_new().
+ * @return La métrica, o NULL si es NULL o el registro no existe.
+ */
+prom_metric_t* prom_collector_registry_must_register_metric(prom_metric_t* metric);
+
+/**
+ * @brief Escribe todas las métricas del registro en el formato de texto de Prometheus.
+ *
+ * @param self Registro.
+ * @return Texto reservado con malloc (lo libera quien llama), o NULL si no hay memoria.
+ */
+const char* prom_collector_registry_bridge(prom_collector_registry_t* self);
+
+/**
+ * @brief Escribe todas las métricas del registro como prom_collector_registry_bridge(), pero en una arena.
+ *
+ * No existe en libprom: la usa el render de la exposición propia para no reservar memoria del heap en cada scrape.
+ *
+ * @param self Registro.
+ * @param arena Arena del scrape.
+ * @return Texto válido hasta el próximo arena_reset(), o NULL si no hay memoria.
+ */
+const char* prom_collector_registry_render(prom_collector_registry_t* self, arena_t* arena);
+
+/**
+ * @brief Crea un gauge.
+ *
+ * @param name Nombre; debe vivir mientras viva la métrica.
+ * @param help Texto de ayuda; debe vivir mientras viva la métrica.
+ * @param label_key_count Cantidad de etiquetas.
+ * @param label_keys Nombres de las etiquetas (se copian los punteros, no el texto).
+ * @return Métrica, o NULL si no hay memoria.
+ */
+prom_gauge_t* prom_gauge_new(const char* name, const char* help, size_t label_key_count, const char** label_keys);
+
+/**
+ * @brief Fija el valor de una serie de un gauge.
+ *
+ * @return 0 en caso de éxito, 1 si no hay memoria para la serie.
+ */
+int prom_gauge_set(prom_gauge_t* self, double r_value, const char** label_values);
+
+/**
+ * @brief Crea un contador; los parámetros son los de prom_gauge_new().
+ */
+prom_counter_t* prom_counter_new(const char* name, const char* help, size_t label_key_count, const char** label_keys);
+
+/**
+ * @brief Suma un incremento no negativo a una serie de un contador.
+ *
+ * @return 0 en caso de éxito, 1 si el incremento es negativo o no hay memoria para la serie.
+ */
+int prom_counter_add(prom_counter_t* self, double r_value, const char** label_values);
+
+/**
+ * @brief Crea un histograma; los parámetros son los de prom_gauge_new() más las cubetas, que pasan a la métrica.
+ */
+prom_histogram_t* prom_histogram_new(const char* name, const char* help, prom_histogram_buckets_t* buckets,
+                                     size_t label_key_count, const char** label_keys);
+
+/**
+ * @brief Observa un valor en una serie de un histograma.
+ *
+ * @return 0 en caso de éxito, 1 si no hay memoria para la serie.
+ */
+int prom_histogram_observe(prom_histogram_t* self, double value, const char** label_values);
+
+/**
+ * @brief Crea cubetas equiespaciadas: start, start + width, ...
+ *
+ * @return Cubetas, o NULL si no hay memoria.
+ */
+prom_histogram_buckets_t* prom_histogram_buckets_linear(double start, double width, size_t count);
+
+/**
+ * @brief Crea cubetas que crecen en progresión geométrica: start, start * factor, ...
+ *
+ * @return Cubetas, o NULL si no hay memoria.
+ */
+prom_histogram_buckets_t* prom_histogram_buckets_exponential(double start, double factor, size_t count);
@@ -0,0 +1,152 @@
+/**
+ * @file push.h
+ * @brief Envío de muestras a un receptor remoto para los nodos que no se pueden scrapear.
+ *
+ * Las tareas de collector.c copian cada lote publicado a una cola acotada y siguen de inmediato: la cola nunca
+ * bloquea al productor y, si está llena, descarta las muestras más viejas. Un hilo propio vacía la cola en lotes y
+ * los envía como Prometheus remote_write (protobuf comprimido con snappy sobre HTTP), StatsD con etiquetas al estilo
+ * DogStatsD o line protocol de InfluxDB sobre UDP. Un envío fallido se reintenta con espera exponencial y jitter
+ * mientras la cola sigue recibiendo muestras.
+ */
+
+#pragma once
+#include "metric_store.h"
+#include <stddef.h>
+#include <stdint.h>
+
+/**
+ * @brief Intervalo entre envíos si config.json no indica otro, en milisegundos.
+ */
+#define PUSH_DEFAULT_INTERVAL_MS 1000
+
+/**
+ * @brief Capacidad de la cola si config.json no indica otra, en muestras.
+ */
+#define PUSH_DEFAULT_QUEUE_SIZE 16384
+
+/**
+ * @brief Muestras máximas por envío si config.json no indica otra cantidad.
+ */
+#define PUSH_DEFAULT_MAX_BATCH 2000
+
+/**
+ * @brief Espera antes del primer reintento, en milisegundos; se duplica en cada intento.
+ */
+#define PUSH_RETRY_BASE_MS 250
+
+/**
+ * @brief Espera máxima entre reintentos, en milisegundos.
+ */
+#define PUSH_RETRY_MAX_MS 30000
+
+/**
+ * @brief Intentos de un mismo lote antes de descartarlo.
+ */
+#define PUSH_MAX_ATTEMPTS 8
+
+/**
+ * @brief Plazo de conexión, envío y respuesta de cada intento, en milisegundos.
+ */
+#define PUSH_TIMEOUT_MS 5000
+
+/**
+ * @brief Tamaño máximo de un datagrama UDP de StatsD o line protocol (cabe en una MTU de 1500 con IPv6).
+ */
+#define PUSH_DATAGRAM_SIZE 1432
+
+/**
+ * @brief Protocolo de envío.
+ */
+typedef enum
+{
+    PUSH_NONE,         ///< Sin envío: solo se sirve /metrics.
+    PUSH_REMOTE_WRITE, ///< Prometheus remote_write 1.0 sobre HTTP.
+    PUSH_STATSD,       ///< StatsD sobre UDP, con las etiquetas como tags de DogStatsD.
+    PUSH_INFLUX        ///< Line protocol de InfluxDB sobre UDP.
+} push_mode_t;
+
+/**
+ * @brief Destino final de las muestras encoladas, usado como etiqueta "result" de monitor_push_samples_total.
+ */
+typedef enum
+{
+    PUSH_RESULT_SENT,    ///< Aceptadas por el receptor.
+    PUSH_RESULT_DROPPED, ///< Descartadas por cola llena.
+    PUSH_RESULT_FAILED,  ///< Descartadas tras agotar los intentos o por un rechazo permanente.
+    PUSH_RESULT_COUNT    ///< Cantidad de resultados.
+} push_result_t;
+
+/**
+ * @brief Muestra copiada a la cola con su instante.
+ */
+typedef struct
+{
+    const void* metric;                                ///< Métrica de la muestra (ver metric_registry_metric_info()).
+    int64_t timestamp_ms;                              ///< Instante en milisegundos desde la época.
+    double value;                                      ///< Valor.
+    int label_count;                                   ///< Cantidad de etiquetas válidas.
+    char labels[METRIC_MAX_LABELS][METRIC_LABEL_SIZE]; ///< Valores de las etiquetas.
+} push_sample_t;
+
+/**
+ * @brief Buffer de bytes que crece según haga falta.
+ */
+typedef struct
+{
+    uint8_t* data; ///< Contenido.
+    size_t len;    ///< Bytes válidos.
+    size_t cap;    ///< Capacidad de data.
+} push_buffer_t;
+
+/**
+ * @brief Asegura lugar para extra bytes más en el buffer.
+ *
+ * @param buf Buffer.
+ * @param extra Bytes que se van a agregar.
+ * @return 0 en caso de éxito, -1 si no hay memoria.
+ */
+int push_buffer_reserve(push_buffer_t* buf, size_t extra);
+
+/**
+ * @brief Inicia el hilo de envío.
+ *
+ * @param mode "remote_write", "statsd" o "influx".
+ * @param target URL http://host[:puerto]/ruta para remote_write, o host:puerto (con udp:// opcional) para UDP.
+ * @param interval_ms Intervalo entre envíos, o 0 para PUSH_DEFAULT_INTERVAL_MS.
+ * @param queue_size Capacidad de la cola, o 0 para PUSH_DEFAULT_QUEUE_SIZE.
+ * @param max_batch Muestras por envío, o 0 para PUSH_DEFAULT_MAX_BATCH; una cola con esa cantidad adelanta el envío.
+ * @return 0 en caso de éxito, -1 si el modo o el destino no son válidos o no se pudo crear el hilo.
+ */
+int push_start(const char* mode, const char* target, int interval_ms, int queue_size, int max_batch);
+
+/**
+ * @brief Copia a la cola las muestras de un lote con el instante actual.
+ *
+ * No espera nunca al hilo de envío más que lo que tarda en copiar; si la cola está llena se descartan las muestras
+ * más viejas.
+ *
+ * @param batch Lote publicado (se ignora si es NULL o si el envío no está iniciado).
+ */
+void push_enqueue_batch(const metric_batch_t* batch);
+
+/**
+ * @brief Detiene el hilo de envío y libera la cola; las muestras pendientes se descartan.
+ *
+ * Se llama después de collectors_stop(), cuando ninguna tarea puede seguir encolando.
+ */
+void push_stop();
+
+/**
+ * @brief Totales de muestras por resultado desde el arranque; se pueden leer desde cualquier hilo.
+ *
+ * @param counts Totales, indexados por push_result_t.
+ */
+void push_counters(unsigned long long counts[PUSH_RESULT_COUNT]);
+
+/**
+ * @brief Nombre de un resultado para la etiqueta "result".
+ *
+ * @param result Resultado.
+ * @return Nombre.
+ */
+const char* push_result_name(push_result_t result);
@@ -0,0 +1,43 @@
+/**
+ * @file remote_write.h
+ * @brief Codificación de Prometheus remote_write 1.0: WriteRequest en protobuf comprimido con snappy.
+ *
+ * Ni protobuf ni snappy justifican una dependencia para un único mensaje: el WriteRequest se escribe a mano campo por
+ * campo y el compresor genera el formato de bloque de snappy con una búsqueda de coincidencias por hash de 4 bytes.
+ */
+
+#pragma once
+#include "push.h"
+
+/**
+ * @brief Tamaño de los fragmentos que comprime snappy por separado; las copias nunca cruzan un fragmento.
+ */
+#define SNAPPY_FRAGMENT_SIZE 65536
+
+/**
+ * @brief Bits de la tabla de hash del compresor.
+ */
+#define SNAPPY_HASH_BITS 14
+
+/**
+ * @brief Agrega a un buffer un WriteRequest con una TimeSeries por muestra.
+ *
+ * Cada serie lleva __name__ y las etiquetas de la métrica ordenadas por nombre, como exige el protocolo. Las muestras
+ * de métricas que no se registraron con metric_registry_register() se omiten.
+ *
+ * @param samples Muestras.
+ * @param count Cantidad de muestras.
+ * @param out Buffer de salida.
+ * @return 0 en caso de éxito, -1 si no hay memoria.
+ */
+int remote_write_encode(const push_sample_t* samples, size_t count, push_buffer_t* out);
+
+/**
+ * @brief Agrega a un buffer datos comprimidos en el formato de bloque de snappy.
+ *
+ * @param in Datos.
+ * @param len Longitud de los datos.
+ * @param out Buffer de salida.
+ * @return 0 en caso de éxito, -1 si no hay memoria.
+ */
+int snappy_compress(const uint8_t* in, size_t len, push_buffer_t* out);
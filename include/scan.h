@@ -0,0 +1,126 @@
+/**
+ * @file scan.h
+ * @brief Tokenizador mínimo sin reservas de memoria para los archivos de /proc.
+ *
+ * Reemplaza a sscanf() en los parsers: trabaja directamente sobre el buffer leído con pread(), sin copiarlo ni
+ * modificarlo, y recorre cada línea una sola vez.
+ */
+
+#pragma once
+#include <stddef.h>
+
+/**
+ * @brief Cursor sobre una región de texto [pos, end).
+ */
+typedef struct
+{
+    const char* pos; ///< Próximo carácter a consumir.
+    const char* end; ///< Fin de la región (no incluido).
+} scan_t;
+
+/**
+ * @brief Inicializa un cursor sobre un buffer.
+ *
+ * @param s Cursor a inicializar.
+ * @param buf Inicio del buffer.
+ * @param len Cantidad de bytes del buffer.
+ */
+void scan_init(scan_t* s, const char* buf, size_t len);
+
+/**
+ * @brief Extrae la próxima línea del cursor, sin el '\n' final.
+ *
+ * @param s Cursor sobre el buffer completo; avanza hasta la línea siguiente.
+ * @param line Cursor que recibe la línea extraída.
+ * @return 1 si se extrajo una línea, 0 si no quedan más.
+ */
+int scan_next_line(scan_t* s, scan_t* line);
+
+/**
+ * @brief Avanza hasta la próxima línea que empieza con una clave y extrae esa línea.
+ *
+ * La clave debe ir seguida de un espacio, un tabulador o ':'. El cursor de la línea queda justo después de la clave
+ * (y del ':' si lo hay), listo para scan_u64().
+ *
+ * @param s Cursor sobre el buffer completo; queda en la línea siguiente a la encontrada.
+ * @param key Clave buscada, por ejemplo "MemTotal" o "pgfault".
+ * @param line Cursor que recibe el resto de la línea encontrada.
+ * @return 1 si se encontró la clave, 0 si no.
+ */
+int scan_skip_to_key(scan_t* s, const char* key, scan_t* line);
+
+/**
+ * @brief Indica si el cursor empieza con un prefijo dado.
+ *
+ * @param s Cursor a inspeccionar (no se modifica).
+ * @param prefix Prefijo buscado.
+ * @return 1 si el cursor empieza con prefix, 0 si no.
+ */
+int scan_starts_with(const scan_t* s, const char* prefix);
+
+/**
+ * @brief Salta espacios y tabuladores.
+ *
+ * @param s Cursor a avanzar.
+ */
+void scan_skip_ws(scan_t* s);
+
+/**
+ * @brief Salta espacios y lee un entero sin signo en base 10.
+ *
+ * @param s Cursor a avanzar.
+ * @param out Valor leído.
+ * @return 1 si se leyó al menos un dígito, 0 si no.
+ */
+int scan_u64(scan_t* s, unsigned long long* out);
+
+/**
+ * @brief Salta espacios y lee un decimal sin signo con parte fraccionaria opcional (por ejemplo "12.34").
+ *
+ * @param s Cursor a avanzar.
+ * @param out Valor leído.
+ * @return 1 si se leyó al menos un dígito, 0 si no.
+ */
+int scan_double(scan_t* s, double* out);
+
+/**
+ * @brief Salta una cantidad de campos separados por espacios.
+ *
+ * @param s Cursor a avanzar.
+ * @param count Cantidad de campos a saltar.
+ * @return 1 si se saltaron todos los campos, 0 si la línea terminó antes.
+ */
+int scan_skip_fields(scan_t* s, int count);
+
+/**
+ * @brief Salta espacios y extrae el próximo campo separado por espacios, sin copiarlo.
+ *
+ * @param s Cursor a avanzar.
+ * @param tok Inicio del campo dentro del buffer.
+ * @param len Longitud del campo.
+ * @return 1 si se extrajo un campo, 0 si la línea terminó.
+ */
+int scan_token(scan_t* s, const char** tok, size_t* len);
+
+/**
+ * @brief Salta espacios y extrae el texto hasta un delimitador, consumiendo el delimitador.
+ *
+ * Sirve para nombres seguidos de ':' como en /proc/net/dev, donde el número puede venir pegado al ':'.
+ *
+ * @param s Cursor a avanzar.
+ * @param delim Delimitador buscado.
+ * @param tok Inicio del texto dentro del buffer.
+ * @param len Longitud del texto sin el delimitador.
+ * @return 1 si se encontró el delimitador, 0 si no.
+ */
+int scan_until(scan_t* s, char delim, const char** tok, size_t* len);
+
+/**
+ * @brief Copia un campo extraído a un buffer de tamaño fijo terminado en '\0', truncando si hace falta.
+ *
+ * @param dst Buffer destino.
+ * @param size Tamaño de dst.
+ * @param tok Campo de origen.
+ * @param len Longitud del campo.
+ */
+void scan_copy(char* dst, size_t size, const char* tok, size_t len);
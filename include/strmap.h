@@ -0,0 +1,77 @@
+/**
+ * @file strmap.h
+ * @brief Tabla hash de direccionamiento abierto con claves de texto.
+ *
+ * Las claves no se copian: deben vivir mientras la entrada esté en la tabla (normalmente apuntan a un campo del
+ * propio valor). La búsqueda acepta claves no terminadas en '\0', de modo que los parsers pueden buscar un nombre
+ * directamente sobre el buffer leído sin copiarlo.
+ */
+
+#pragma once
+#include <stddef.h>
+
+/**
+ * @brief Entrada de la tabla.
+ */
+typedef struct
+{
+    const char* key; ///< Clave, o NULL si la entrada está libre.
+    size_t key_len;  ///< Longitud de la clave.
+    size_t hash;     ///< Hash de la clave, guardado para no recalcularlo al crecer.
+    void* value;     ///< Valor asociado.
+} strmap_slot_t;
+
+/**
+ * @brief Tabla hash con sondeo lineal y borrado por desplazamiento hacia atrás (sin lápidas).
+ */
+typedef struct
+{
+    strmap_slot_t* slots; ///< Arreglo de entradas.
+    size_t capacity;      ///< Capacidad (potencia de dos).
+    size_t count;         ///< Cantidad de entradas ocupadas.
+} strmap_t;
+
+/**
+ * @brief Inicializa la tabla.
+ *
+ * @param map Tabla a inicializar.
+ * @param capacity Capacidad inicial (se redondea a potencia de dos).
+ * @return 0 en caso de éxito, -1 en caso de error.
+ */
+int strmap_init(strmap_t* map, size_t capacity);
+
+/**
+ * @brief Libera las entradas de la tabla (no los valores).
+ *
+ * @param map Tabla a liberar.
+ */
+void strmap_free(strmap_t* map);
+
+/**
+ * @brief Busca un valor por clave.
+ *
+ * @param map Tabla.
+ * @param key Clave, no necesariamente terminada en '\0'.
+ * @param key_len Longitud de la clave.
+ * @return Valor asociado, o NULL si no existe.
+ */
+void* strmap_get(const strmap_t* map, const char* key, size_t key_len);
+
+/**
+ * @brief Inserta o reemplaza un valor.
+ *
+ * @param map Tabla.
+ * @param key Clave terminada en '\0'; debe vivir mientras esté en la tabla.
+ * @param value Valor asociado.
+ * @return 0 en caso de éxito, -1 si no se pudo agrandar la tabla.
+ */
+int strmap_put(strmap_t* map, const char* key, void* value);
+
+/**
+ * @brief Elimina una clave.
+ *
+ * @param map Tabla.
+ * @param key Clave terminada en '\0'.
+ * @return Valor que estaba asociado, o NULL si no existía.
+ */
+void* strmap_remove(strmap_t* map, const char* key);
@@ -1,11 +1,18 @@
 #!/bin/bash
-find / -name "cJSON.h" 2>/dev/null
+set -e
+cd "$(dirname "$0")"
 
-# Compilación del proyecto
-gcc src/*.c -o metrics -I include/ -I /usr/local/include/ -lprom -pthread -lpromhttp -lcjson
+# Compilación del proyecto con CMake (RelWithDebInfo salvo que se indique otro tipo en BUILD_TYPE). Con STATIC=1
+# se compila además monitoring_project_static, que necesita libcjson.a
+BUILD_DIR=${BUILD_DIR:-cmake-build}
+cmake -S . -B "$BUILD_DIR" -DCMAKE_BUILD_TYPE="${BUILD_TYPE:-RelWithDebInfo}"
+cmake --build "$BUILD_DIR" -j"$(nproc)" --target monitoring_project
+if [ "${STATIC:-0}" = "1" ]; then
+    cmake --build "$BUILD_DIR" -j"$(nproc)" --target monitoring_project_static
+fi
 
 # Actualización de la variable de entorno para localizar las bibliotecas dinámicas
 export LD_LIBRARY_PATH=/usr/local/lib:$LD_LIBRARY_PATH
 
 # Ejecución del binario generado
-#./metrics
+#./cmake-build/monitoring_project -c config.json
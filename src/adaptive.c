@@ -0,0 +1,202 @@
+/**
+ * @file adaptive.c
+ * @brief Comparación de lotes consecutivos de una tarea contra las reglas de muestreo adaptativo.
+ *
+ * Las series de un lote se comparan por posición con las del lote anterior: las tareas agregan sus muestras siempre
+ * en el mismo orden, así que basta verificar que la métrica y el hash de las etiquetas coincidan. Una serie que no
+ * coincide (un proceso nuevo en el ranking, un disco que aparece) se resuelve otra vez contra las reglas con fnmatch
+ * y cuenta como cambio; las que coinciden conservan su regla y no vuelven a comparar patrones.
+ */
+
+#include "adaptive.h"
+#include "metric_registry.h"
+#include "metrics.h"
+#include <fnmatch.h>
+#include <math.h>
+#include <pthread.h>
+#include <stdatomic.h>
+
+/**
+ * @brief Regla copiada de la configuración.
+ */
+typedef struct
+{
+    char pattern[ADAPTIVE_PATTERN_SIZE]; ///< Patrón fnmatch sobre el nombre de la métrica.
+    double delta;                        ///< Variación tolerada.
+    int has_threshold;                   ///< 1 si la regla tiene umbral.
+    double threshold;                    ///< Umbral.
+} adaptive_rule_copy_t;
+
+/**
+ * @brief Reglas vigentes.
+ */
+static adaptive_rule_copy_t rules[MAX_ADAPTIVE_RULES];
+
+/**
+ * @brief Cantidad de reglas vigentes; se lee sin lock para saltear la comparación cuando no hay reglas.
+ */
+static atomic_int rule_count = INICIAL_VALUE;
+
+/**
+ * @brief Generación de las reglas; cambia en cada set_adaptive_rules().
+ */
+static unsigned int rules_generation = ASSIGNED_VALUE;
+
+/**
+ * @brief Protege rules y rules_generation.
+ */
+static pthread_mutex_t rules_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * @brief Intervalo máximo al que se espacia una tarea, en milisegundos.
+ */
+static atomic_int max_interval_ms = ADAPTIVE_DEFAULT_MAX_INTERVAL_MS;
+
+void set_adaptive_rules(const adaptive_rule_t* list, int count)
+{
+    if (count > MAX_ADAPTIVE_RULES)
+    {
+        count = MAX_ADAPTIVE_RULES;
+    }
+
+    pthread_mutex_lock(&rules_lock);
+    int changed = count != atomic_load(&rule_count);
+    for (int i = 0; i < count && !changed; i++)
+    {
+        changed = strncmp(rules[i].pattern, list[i].pattern, ADAPTIVE_PATTERN_SIZE) != INICIAL_VALUE ||
+                  rules[i].delta != list[i].delta || rules[i].has_threshold != list[i].has_threshold ||
+                  rules[i].threshold != list[i].threshold;
+    }
+    if (changed)
+    {
+        for (int i = 0; i < count; i++)
+        {
+            snprintf(rules[i].pattern, ADAPTIVE_PATTERN_SIZE, "%s", list[i].pattern);
+            rules[i].delta = list[i].delta;
+            rules[i].has_threshold = list[i].has_threshold;
+            rules[i].threshold = list[i].threshold;
+        }
+        atomic_store(&rule_count, count);
+        rules_generation++;
+    }
+    pthread_mutex_unlock(&rules_lock);
+}
+
+void set_adaptive_max_interval(int interval_ms)
+{
+    if (interval_ms > INICIAL_VALUE)
+    {
+        atomic_store(&max_interval_ms, interval_ms);
+    }
+}
+
+int adaptive_max_interval_ms()
+{
+    return atomic_load(&max_interval_ms);
+}
+
+/**
+ * @brief Busca la primera regla que cubre una métrica.
+ *
+ * @param list Copia de las reglas vigentes.
+ * @param count Cantidad de reglas.
+ * @param metric Métrica de la muestra.
+ * @return Índice de la regla, o -1 si ninguna la cubre.
+ */
+static int resolve_rule(const adaptive_rule_copy_t* list, int count, const void* metric)
+{
+    const char* name = metric_registry_metric_name(metric);
+    for (int r = 0; name != NULL && r < count; r++)
+    {
+        if (fnmatch(list[r].pattern, name, INICIAL_VALUE) == INICIAL_VALUE)
+        {
+            return r;
+        }
+    }
+    return ERROR_INT;
+}
+
+adaptive_result_t adaptive_evaluate(adaptive_state_t* state, const metric_batch_t* batch, unsigned long long now_ns)
+{
+    if (atomic_load(&rule_count) == INICIAL_VALUE || batch == NULL)
+    {
+        state->count = INICIAL_VALUE;
+        return ADAPTIVE_NONE;
+    }
+
+    if (state->cap < batch->count)
+    {
+        adaptive_point_t* points = realloc(state->points, batch->count * sizeof(*points));
+        if (points == NULL)
+        {
+            perror("Error al asignar memoria");
+            return ADAPTIVE_NONE;
+        }
+        state->points = points;
+        state->cap = batch->count;
+    }
+
+    // Se trabaja sobre una copia de las reglas; si cambiaron, todas las series se resuelven de nuevo
+    adaptive_rule_copy_t current[MAX_ADAPTIVE_RULES];
+    pthread_mutex_lock(&rules_lock);
+    int count = atomic_load(&rule_count);
+    memcpy(current, rules, (size_t)count * sizeof(current[0]));
+    if (state->rules_generation != rules_generation)
+    {
+        state->rules_generation = rules_generation;
+        state->count = INICIAL_VALUE;
+    }
+    pthread_mutex_unlock(&rules_lock);
+
+    double elapsed = state->last_ns != INICIAL_VALUE ? (double)(now_ns - state->last_ns) / 1e9 : INICIAL_VALUE;
+    adaptive_result_t result = ADAPTIVE_NONE;
+    for (size_t i = 0; i < batch->count; i++)
+    {
+        const metric_sample_t* sample = &batch->samples[i];
+        adaptive_point_t* point = &state->points[i];
+        uint64_t hash = metric_labels_hash(sample->labels, sample->label_count);
+
+        if (i >= state->count || point->metric != sample->metric || point->labels_hash != hash)
+        {
+            point->metric = sample->metric;
+            point->labels_hash = hash;
+            point->rule = sample->kind == METRIC_HISTOGRAM ? ERROR_INT : resolve_rule(current, count, sample->metric);
+            point->observations = INICIAL_VALUE;
+        }
+        if (point->rule < INICIAL_VALUE)
+        {
+            continue;
+        }
+
+        // Un gauge se compara por su valor y un contador por su tasa, que recién existe en el segundo lote
+        const adaptive_rule_copy_t* rule = &current[point->rule];
+        int comparable = point->observations >= (sample->kind == METRIC_COUNTER ? 2 : ASSIGNED_VALUE);
+        double quantity = sample->value;
+        if (sample->kind == METRIC_COUNTER)
+        {
+            quantity = point->observations > INICIAL_VALUE && elapsed > INICIAL_VALUE
+                           ? (sample->value - point->value) / elapsed
+                           : INICIAL_VALUE;
+        }
+
+        adaptive_result_t verdict = ADAPTIVE_QUIET;
+        if (rule->has_threshold && point->observations >= (sample->kind == METRIC_COUNTER) &&
+            quantity > rule->threshold)
+        {
+            verdict = ADAPTIVE_HOT;
+        }
+        else if (!comparable || fabs(quantity - point->quantity) > rule->delta)
+        {
+            verdict = ADAPTIVE_CHANGED;
+        }
+        result = verdict > result ? verdict : result;
+
+        point->value = sample->value;
+        point->quantity = quantity;
+        point->observations += point->observations < 2 ? ASSIGNED_VALUE : INICIAL_VALUE;
+    }
+
+    state->count = batch->count;
+    state->last_ns = now_ns;
+    return result;
+}
@@ -0,0 +1,953 @@
+/**
+ * @file aggregator.c
+ * @brief Recepción de line protocol de muchos agentes y cálculo de series resumidas por grupo.
+ *
+ * Todas las tablas (hosts y series) pertenecen al hilo del agregador, así que se leen y escriben sin locks. Solo el
+ * texto publicado se comparte con los scrapes: el hilo lo escribe en una de dos arenas, la publica bajo
+ * published_lock y en el cálculo siguiente reusa la otra, de modo que en régimen estable no reserva memoria.
+ *
+ * Cada serie guarda el último valor y su instante por host, indexados por el número del host. Al calcular, los
+ * valores vigentes se ordenan por grupo y por valor en un único qsort(), y cada tramo del arreglo ordenado da la suma,
+ * el máximo y los cuantiles (por rango más cercano) de un grupo.
+ */
+
+#include "aggregator.h"
+#include "arena.h"
+#include "metrics.h"
+#include "strmap.h"
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fnmatch.h>
+#include <math.h>
+#include <netdb.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <sys/socket.h>
+#include <time.h>
+
+/**
+ * @brief Tamaño máximo de un datagrama recibido.
+ */
+#define AGG_DATAGRAM_SIZE 65536
+
+/**
+ * @brief Tamaño del buffer de recepción del socket; absorbe los envíos de miles de hosts entre dos vaciados.
+ */
+#define AGG_RCVBUF (8 * 1024 * 1024)
+
+/**
+ * @brief Espera máxima del hilo en poll(), que acota cuánto tarda en notar aggregator_stop().
+ */
+#define AGG_POLL_MS 200
+
+/**
+ * @brief Tamaño del nombre de un grupo, de un patrón y de la etiqueta del grupo.
+ */
+#define AGG_NAME_SIZE 64
+
+/**
+ * @brief Tamaño de la dirección de un host.
+ */
+#define AGG_HOST_SIZE INET6_ADDRSTRLEN
+
+/**
+ * @brief Capacidad inicial de los valores por host de una serie.
+ */
+#define AGG_INITIAL_HOSTS 64
+
+/**
+ * @brief Host que envía muestras.
+ */
+typedef struct
+{
+    char addr[AGG_HOST_SIZE]; ///< Dirección numérica, usada también como clave de la tabla.
+    int id;                   ///< Número del host: índice de los valores de cada serie.
+    int group;                ///< Índice del grupo, o group_count para AGGREGATOR_DEFAULT_GROUP.
+    int64_t last_seen_ms;     ///< Instante del último datagrama del host.
+} agg_host_t;
+
+/**
+ * @brief Serie recibida: métrica más etiquetas, con el último valor de cada host.
+ */
+typedef struct
+{
+    char* key;            ///< Medición y etiquetas tal como llegan ("cpu_usage_percentage,cpu=0").
+    size_t name_len;      ///< Longitud del nombre de la métrica dentro de key.
+    char* labels;         ///< Etiquetas en el formato de la exposición ("cpu=\"0\","), o "" si no tiene.
+    double* values;       ///< Último valor por host.
+    int64_t* seen_ms;     ///< Instante del último valor por host, o 0 si el host nunca la envió.
+    int capacity;         ///< Hosts que entran en values y seen_ms.
+    int64_t last_seen_ms; ///< Instante del último valor de cualquier host.
+} agg_series_t;
+
+/**
+ * @brief Valor vigente de un host al calcular una serie.
+ */
+typedef struct
+{
+    int group;    ///< Grupo del host.
+    double value; ///< Valor.
+} agg_point_t;
+
+/**
+ * @brief Grupo configurado, copiado de aggregator_options_t.
+ */
+typedef struct
+{
+    char name[AGG_NAME_SIZE];                              ///< Valor de la etiqueta del grupo.
+    char patterns[AGGREGATOR_MAX_PATTERNS][AGG_NAME_SIZE]; ///< Patrones sobre la dirección del host.
+    int pattern_count;                                     ///< Cantidad de patrones.
+} agg_group_t;
+
+/**
+ * @brief Grupos configurados; el siguiente al último es AGGREGATOR_DEFAULT_GROUP.
+ */
+static agg_group_t groups[AGGREGATOR_MAX_GROUPS + 1];
+static int group_count = INICIAL_VALUE;
+
+/**
+ * @brief Nombre de la etiqueta del grupo.
+ */
+static char group_label[AGG_NAME_SIZE];
+
+/**
+ * @brief Cuantiles calculados por grupo.
+ */
+static double quantiles[AGGREGATOR_MAX_QUANTILES];
+static int quantile_count = INICIAL_VALUE;
+
+/**
+ * @brief Intervalo entre cálculos y vigencia del valor de un host, en milisegundos.
+ */
+static int interval_ms = AGGREGATOR_DEFAULT_INTERVAL_MS;
+static int stale_ms = AGGREGATOR_DEFAULT_STALE_MS;
+
+/**
+ * @brief Socket UDP de escucha.
+ */
+static int listen_fd = ERROR_INT;
+
+/**
+ * @brief Hosts conocidos, indexados por dirección y por número.
+ */
+static strmap_t hosts_by_addr;
+static agg_host_t* hosts[AGGREGATOR_MAX_HOSTS];
+static int host_count = INICIAL_VALUE;
+
+/**
+ * @brief Series conocidas, indexadas por clave; series se ordena por clave en cada cálculo.
+ */
+static strmap_t series_by_key;
+static agg_series_t* series[AGGREGATOR_MAX_SERIES];
+static int series_count = INICIAL_VALUE;
+
+/**
+ * @brief Arreglo de trabajo del cálculo, con lugar para un valor por host.
+ */
+static agg_point_t* points = NULL;
+static int points_capacity = INICIAL_VALUE;
+
+/**
+ * @brief Líneas aceptadas y descartadas desde el arranque (solo las escribe el hilo del agregador).
+ */
+static unsigned long long lines_accepted = INICIAL_VALUE;
+static unsigned long long lines_rejected = INICIAL_VALUE;
+
+/**
+ * @brief 1 si ya se avisó que se alcanzó AGGREGATOR_MAX_HOSTS o AGGREGATOR_MAX_SERIES.
+ */
+static int hosts_full_warned = INICIAL_VALUE;
+static int series_full_warned = INICIAL_VALUE;
+
+/**
+ * @brief Arenas de los textos calculados: una publicada y otra para el cálculo siguiente.
+ */
+static arena_t text_arenas[2];
+static int text_next = INICIAL_VALUE;
+
+/**
+ * @brief Arena de las líneas de *_max de una métrica, que se escriben después de las del resumen.
+ */
+static arena_t max_arena;
+
+/**
+ * @brief Último texto publicado, protegido por published_lock.
+ */
+static pthread_mutex_t published_lock = PTHREAD_MUTEX_INITIALIZER;
+static const char* published_text = NULL;
+static size_t published_len = INICIAL_VALUE;
+
+/**
+ * @brief Cálculos publicados; lo lee route_request() desde los hilos del servidor.
+ */
+static atomic_ullong generation = INICIAL_VALUE;
+
+/**
+ * @brief 1 mientras el hilo está en ejecución, y 1 en stopping cuando se pidió detenerlo.
+ */
+static atomic_int running = INICIAL_VALUE;
+static atomic_int stopping = INICIAL_VALUE;
+
+/**
+ * @brief Hilo del agregador.
+ */
+static pthread_t aggregator_thread;
+
+/**
+ * @brief Devuelve el instante actual de CLOCK_MONOTONIC en milisegundos.
+ */
+static int64_t now_ms()
+{
+    return (int64_t)(monotonic_ns() / 1000000ULL);
+}
+
+/**
+ * @brief Busca un host por dirección, creándolo y asignándole grupo si es nuevo.
+ *
+ * @param addr Dirección numérica.
+ * @return Host, o NULL si no hay lugar o memoria.
+ */
+static agg_host_t* agg_host_lookup(const char* addr)
+{
+    agg_host_t* host = strmap_get(&hosts_by_addr, addr, strlen(addr));
+    if (host != NULL)
+    {
+        return host;
+    }
+
+    if (host_count == AGGREGATOR_MAX_HOSTS)
+    {
+        if (!hosts_full_warned)
+        {
+            fprintf(stderr, "Se alcanzó el máximo de %d hosts agregados; se ignoran los nuevos\n",
+                    AGGREGATOR_MAX_HOSTS);
+            hosts_full_warned = ASSIGNED_VALUE;
+        }
+        return NULL;
+    }
+
+    host = calloc(1, sizeof(*host));
+    if (host == NULL)
+    {
+        perror("Error al asignar memoria");
+        return NULL;
+    }
+    snprintf(host->addr, sizeof(host->addr), "%s", addr);
+    host->id = host_count;
+    host->group = group_count;
+    for (int g = 0; g < group_count && host->group == group_count; g++)
+    {
+        for (int p = 0; p < groups[g].pattern_count; p++)
+        {
+            if (fnmatch(groups[g].patterns[p], host->addr, INICIAL_VALUE) == INICIAL_VALUE)
+            {
+                host->group = g;
+                break;
+            }
+        }
+    }
+
+    if (strmap_put(&hosts_by_addr, host->addr, host) != INICIAL_VALUE)
+    {
+        free(host);
+        return NULL;
+    }
+    hosts[host_count++] = host;
+    return host;
+}
+
+/**
+ * @brief Indica si un carácter es válido en un nombre de métrica (con colon) o de etiqueta (sin colon).
+ */
+static int agg_name_char(char c, int first, int colon)
+{
+    return (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || c == '_' || (colon && c == ':') ||
+           (!first && c >= '0' && c <= '9');
+}
+
+/**
+ * @brief Convierte las etiquetas de line protocol ("k=v,k2=v\ 2") al formato de la exposición ("k=\"v\",").
+ *
+ * @param tags Etiquetas, sin la coma inicial.
+ * @param len Longitud de tags (0 si la serie no tiene etiquetas).
+ * @return Texto reservado con malloc, o NULL si alguna etiqueta no es válida o no hay memoria.
+ */
+static char* agg_convert_labels(const char* tags, size_t len)
+{
+    // En el peor caso cada byte del valor se escapa con una barra, y cada etiqueta suma '"', '"' y ','
+    char* out = malloc(len * 3 + ASSIGNED_VALUE);
+    size_t pos = INICIAL_VALUE;
+    if (out == NULL)
+    {
+        perror("Error al asignar memoria");
+        return NULL;
+    }
+
+    for (size_t i = 0; i < len;)
+    {
+        size_t start = i;
+        while (i < len && tags[i] != '=')
+        {
+            if (!agg_name_char(tags[i], i == start, INICIAL_VALUE))
+            {
+                free(out);
+                return NULL;
+            }
+            out[pos++] = tags[i++];
+        }
+        if (i == start || i == len)
+        {
+            free(out);
+            return NULL;
+        }
+        out[pos++] = tags[i++];
+        out[pos++] = '"';
+        while (i < len && tags[i] != ',')
+        {
+            char c = tags[i++];
+            if (c == '\\' && i < len && (tags[i] == ',' || tags[i] == '=' || tags[i] == ' '))
+            {
+                c = tags[i++];
+            }
+            else if (c == '\\' || c == '"')
+            {
+                out[pos++] = '\\';
+            }
+            out[pos++] = c;
+        }
+        out[pos++] = '"';
+        out[pos++] = ',';
+        i += i < len ? ASSIGNED_VALUE : INICIAL_VALUE;
+    }
+    out[pos] = '\0';
+    return out;
+}
+
+/**
+ * @brief Libera una serie.
+ */
+static void agg_series_free(agg_series_t* entry)
+{
+    free(entry->key);
+    free(entry->labels);
+    free(entry->values);
+    free(entry->seen_ms);
+    free(entry);
+}
+
+/**
+ * @brief Crea una serie a partir de la clave de una línea.
+ *
+ * @param key Medición y etiquetas, no terminada en '\0'.
+ * @param key_len Longitud de key.
+ * @param name_len Longitud del nombre de la métrica dentro de key.
+ * @return Serie registrada en las tablas, o NULL si no es válida, no hay lugar o no hay memoria.
+ */
+static agg_series_t* agg_series_new(const char* key, size_t key_len, size_t name_len)
+{
+    if (series_count == AGGREGATOR_MAX_SERIES)
+    {
+        if (!series_full_warned)
+        {
+            fprintf(stderr, "Se alcanzó el máximo de %d series agregadas; se ignoran las nuevas\n",
+                    AGGREGATOR_MAX_SERIES);
+            series_full_warned = ASSIGNED_VALUE;
+        }
+        return NULL;
+    }
+
+    agg_series_t* entry = calloc(1, sizeof(*entry));
+    if (entry == NULL)
+    {
+        perror("Error al asignar memoria");
+        return NULL;
+    }
+    entry->key = malloc(key_len + ASSIGNED_VALUE);
+    size_t tags_len = key_len > name_len ? key_len - name_len - ASSIGNED_VALUE : INICIAL_VALUE;
+    entry->labels = agg_convert_labels(key + key_len - tags_len, tags_len);
+    if (entry->key == NULL || entry->labels == NULL)
+    {
+        agg_series_free(entry);
+        return NULL;
+    }
+    memcpy(entry->key, key, key_len);
+    entry->key[key_len] = '\0';
+    entry->name_len = name_len;
+
+    if (strmap_put(&series_by_key, entry->key, entry) != INICIAL_VALUE)
+    {
+        agg_series_free(entry);
+        return NULL;
+    }
+    series[series_count++] = entry;
+    return entry;
+}
+
+/**
+ * @brief Asegura lugar en una serie para el valor de un host.
+ *
+ * @return 0 en caso de éxito, -1 si no hay memoria.
+ */
+static int agg_series_reserve(agg_series_t* entry, int id)
+{
+    if (id < entry->capacity)
+    {
+        return INICIAL_VALUE;
+    }
+    int capacity = entry->capacity > INICIAL_VALUE ? entry->capacity : AGG_INITIAL_HOSTS;
+    while (capacity <= id)
+    {
+        capacity *= 2;
+    }
+    double* values = realloc(entry->values, (size_t)capacity * sizeof(*values));
+    if (values == NULL)
+    {
+        perror("Error al asignar memoria");
+        return ERROR_INT;
+    }
+    entry->values = values;
+    int64_t* seen = realloc(entry->seen_ms, (size_t)capacity * sizeof(*seen));
+    if (seen == NULL)
+    {
+        perror("Error al asignar memoria");
+        return ERROR_INT;
+    }
+    memset(seen + entry->capacity, 0, (size_t)(capacity - entry->capacity) * sizeof(*seen));
+    entry->seen_ms = seen;
+    entry->capacity = capacity;
+    return INICIAL_VALUE;
+}
+
+/**
+ * @brief Guarda el valor de una línea de line protocol: "medición[,k=v...] value=N[ instante]".
+ *
+ * @param host Host que la envió.
+ * @param line Línea, sin el '\n'; el buffer termina en '\0' después de la última línea.
+ * @param len Longitud de la línea.
+ * @param now Instante de recepción.
+ * @return 0 si se aceptó, -1 si se descartó.
+ */
+static int agg_ingest_line(agg_host_t* host, const char* line, size_t len, int64_t now)
+{
+    size_t name_len = INICIAL_VALUE, key_len;
+
+    // El nombre termina en la primera ',' y la clave en el primer espacio sin escapar
+    while (name_len < len && line[name_len] != ',' && line[name_len] != ' ')
+    {
+        if (!agg_name_char(line[name_len], name_len == INICIAL_VALUE, ASSIGNED_VALUE))
+        {
+            return ERROR_INT;
+        }
+        name_len++;
+    }
+    for (key_len = name_len; key_len < len && line[key_len] != ' '; key_len++)
+    {
+        key_len += line[key_len] == '\\' ? ASSIGNED_VALUE : INICIAL_VALUE;
+    }
+    if (name_len == INICIAL_VALUE || key_len >= len)
+    {
+        return ERROR_INT;
+    }
+
+    // Campos "k=v" separados por ','; solo interesa "value", que es el que escribe push.c
+    const char* field = line + key_len + ASSIGNED_VALUE;
+    const char* end = line + len;
+    double value = NAN;
+    while (field < end)
+    {
+        const char* next = memchr(field, ',', (size_t)(end - field));
+        if (end - field > 6 && memcmp(field, "value=", 6) == INICIAL_VALUE)
+        {
+            char* parsed;
+            value = strtod(field + 6, &parsed);
+            if (parsed == field + 6)
+            {
+                value = NAN;
+            }
+            break;
+        }
+        field = next != NULL ? next + ASSIGNED_VALUE : end;
+    }
+    if (!isfinite(value))
+    {
+        return ERROR_INT;
+    }
+
+    agg_series_t* entry = strmap_get(&series_by_key, line, key_len);
+    if (entry == NULL && (entry = agg_series_new(line, key_len, name_len)) == NULL)
+    {
+        return ERROR_INT;
+    }
+    if (agg_series_reserve(entry, host->id) != INICIAL_VALUE)
+    {
+        return ERROR_INT;
+    }
+    entry->values[host->id] = value;
+    entry->seen_ms[host->id] = now;
+    entry->last_seen_ms = now;
+    return INICIAL_VALUE;
+}
+
+/**
+ * @brief Guarda todas las líneas de un datagrama.
+ *
+ * @param from Dirección de origen.
+ * @param buf Datagrama, terminado en '\0'.
+ * @param len Bytes del datagrama.
+ * @param now Instante de recepción.
+ */
+static void agg_ingest_datagram(const struct sockaddr_storage* from, const char* buf, size_t len, int64_t now)
+{
+    char addr[AGG_HOST_SIZE];
+
+    // Un origen IPv4 sobre un socket IPv6 llega como ::ffff:a.b.c.d: se usa la forma IPv4 para los patrones
+    if (from->ss_family == AF_INET6)
+    {
+        const struct sockaddr_in6* in6 = (const struct sockaddr_in6*)from;
+        if (IN6_IS_ADDR_V4MAPPED(&in6->sin6_addr))
+        {
+            inet_ntop(AF_INET, &in6->sin6_addr.s6_addr[12], addr, sizeof(addr));
+        }
+        else
+        {
+            inet_ntop(AF_INET6, &in6->sin6_addr, addr, sizeof(addr));
+        }
+    }
+    else
+    {
+        inet_ntop(AF_INET, &((const struct sockaddr_in*)from)->sin_addr, addr, sizeof(addr));
+    }
+
+    agg_host_t* host = agg_host_lookup(addr);
+    if (host == NULL)
+    {
+        return;
+    }
+    host->last_seen_ms = now;
+
+    const char* end = buf + len;
+    for (const char* line = buf; line < end;)
+    {
+        const char* eol = memchr(line, '\n', (size_t)(end - line));
+        eol = eol != NULL ? eol : end;
+        if (eol > line)
+        {
+            if (agg_ingest_line(host, line, (size_t)(eol - line), now) == INICIAL_VALUE)
+            {
+                lines_accepted++;
+            }
+            else
+            {
+                lines_rejected++;
+            }
+        }
+        line = eol + ASSIGNED_VALUE;
+    }
+}
+
+/**
+ * @brief Ordena las series por nombre de métrica y después por etiquetas, para agrupar cada familia.
+ */
+static int agg_compare_series(const void* a, const void* b)
+{
+    const agg_series_t* sa = *(agg_series_t* const*)a;
+    const agg_series_t* sb = *(agg_series_t* const*)b;
+    size_t common = sa->name_len < sb->name_len ? sa->name_len : sb->name_len;
+    int cmp = memcmp(sa->key, sb->key, common);
+    if (cmp != INICIAL_VALUE || sa->name_len == sb->name_len)
+    {
+        return cmp != INICIAL_VALUE ? cmp : strcmp(sa->labels, sb->labels);
+    }
+    return sa->name_len < sb->name_len ? ERROR_INT : ASSIGNED_VALUE;
+}
+
+/**
+ * @brief Ordena los valores de un cálculo por grupo y después por valor.
+ */
+static int agg_compare_points(const void* a, const void* b)
+{
+    const agg_point_t* pa = a;
+    const agg_point_t* pb = b;
+    if (pa->group != pb->group)
+    {
+        return pa->group < pb->group ? ERROR_INT : ASSIGNED_VALUE;
+    }
+    return pa->value < pb->value ? ERROR_INT : pa->value > pb->value ? ASSIGNED_VALUE : INICIAL_VALUE;
+}
+
+/**
+ * @brief Libera las series que ningún host envió dentro de la vigencia.
+ */
+static void agg_remove_stale(int64_t now)
+{
+    for (int i = 0; i < series_count;)
+    {
+        if (now - series[i]->last_seen_ms <= stale_ms)
+        {
+            i++;
+            continue;
+        }
+        strmap_remove(&series_by_key, series[i]->key);
+        agg_series_free(series[i]);
+        series[i] = series[--series_count];
+        series_full_warned = INICIAL_VALUE;
+    }
+}
+
+/**
+ * @brief Escribe el resumen por grupo de una serie: cuantiles, suma y cantidad, y guarda el máximo en max_lines.
+ *
+ * @param text Texto del cálculo.
+ * @param max_lines Líneas de la familia *_max de la métrica en curso.
+ * @param entry Serie.
+ * @param now Instante del cálculo.
+ */
+static void agg_rollup_series(arena_str_t* text, arena_str_t* max_lines, const agg_series_t* entry, int64_t now)
+{
+    int count = INICIAL_VALUE;
+    for (int id = 0; id < host_count && id < entry->capacity; id++)
+    {
+        if (entry->seen_ms[id] != INICIAL_VALUE && now - entry->seen_ms[id] <= stale_ms)
+        {
+            points[count].group = hosts[id]->group;
+            points[count].value = entry->values[id];
+            count++;
+        }
+    }
+    qsort(points, (size_t)count, sizeof(*points), agg_compare_points);
+
+    int name_len = (int)entry->name_len;
+    for (int start = 0; start < count;)
+    {
+        int group = points[start].group;
+        int end = start;
+        double sum = INICIAL_VALUE;
+        while (end < count && points[end].group == group)
+        {
+            sum += points[end++].value;
+        }
+        int n = end - start;
+        const char* label = groups[group].name;
+
+        // Cuantil por rango más cercano: el menor valor con al menos q * n valores menores o iguales
+        for (int q = 0; q < quantile_count; q++)
+        {
+            int rank = (int)ceil(quantiles[q] * n);
+            rank = rank < ASSIGNED_VALUE ? ASSIGNED_VALUE : rank;
+            arena_str_printf(text, AGGREGATOR_PREFIX "%.*s{%s%s=\"%s\",quantile=\"%g\"} %.17g\n", name_len,
+                             entry->key, entry->labels, group_label, label, quantiles[q],
+                             points[start + rank - 1].value);
+        }
+        arena_str_printf(text, AGGREGATOR_PREFIX "%.*s_sum{%s%s=\"%s\"} %.17g\n", name_len, entry->key, entry->labels,
+                         group_label, label, sum);
+        arena_str_printf(text, AGGREGATOR_PREFIX "%.*s_count{%s%s=\"%s\"} %d\n", name_len, entry->key, entry->labels,
+                         group_label, label, n);
+        arena_str_printf(max_lines, AGGREGATOR_PREFIX "%.*s_max{%s%s=\"%s\"} %.17g\n", name_len, entry->key,
+                         entry->labels, group_label, label, points[end - 1].value);
+        start = end;
+    }
+}
+
+/**
+ * @brief Calcula las series resumidas de todas las series vigentes y publica el texto.
+ *
+ * @param now Instante del cálculo.
+ */
+static void agg_rollup(int64_t now)
+{
+    agg_remove_stale(now);
+
+    if (points_capacity < host_count)
+    {
+        agg_point_t* bigger = realloc(points, (size_t)host_count * sizeof(*points));
+        if (bigger == NULL)
+        {
+            perror("Error al asignar memoria");
+            return;
+        }
+        points = bigger;
+        points_capacity = host_count;
+    }
+    qsort(series, (size_t)series_count, sizeof(series[0]), agg_compare_series);
+
+    arena_t* arena = &text_arenas[text_next];
+    arena_str_t text;
+    arena_reset(arena);
+    arena_str_init(&text, arena);
+
+    for (int start = 0; start < series_count;)
+    {
+        const agg_series_t* first = series[start];
+        int name_len = (int)first->name_len;
+        arena_str_t max_lines;
+        arena_reset(&max_arena);
+        arena_str_init(&max_lines, &max_arena);
+
+        arena_str_printf(&text, "# TYPE " AGGREGATOR_PREFIX "%.*s summary\n", name_len, first->key);
+        int end = start;
+        while (end < series_count && series[end]->name_len == first->name_len &&
+               memcmp(series[end]->key, first->key, first->name_len) == INICIAL_VALUE)
+        {
+            agg_rollup_series(&text, &max_lines, series[end++], now);
+        }
+        arena_str_printf(&text, "# TYPE " AGGREGATOR_PREFIX "%.*s_max gauge\n", name_len, first->key);
+        if (max_lines.len > INICIAL_VALUE)
+        {
+            arena_str_append(&text, max_lines.data, max_lines.len);
+        }
+        start = end;
+    }
+
+    // Métricas propias del agregador
+    int group_hosts[AGGREGATOR_MAX_GROUPS + 1] = {0};
+    for (int i = 0; i < host_count; i++)
+    {
+        group_hosts[hosts[i]->group] += now - hosts[i]->last_seen_ms <= stale_ms ? ASSIGNED_VALUE : INICIAL_VALUE;
+    }
+    arena_str_printf(&text, "# TYPE aggregator_hosts gauge\n");
+    for (int g = 0; g <= group_count; g++)
+    {
+        arena_str_printf(&text, "aggregator_hosts{%s=\"%s\"} %d\n", group_label, groups[g].name, group_hosts[g]);
+    }
+    arena_str_printf(&text, "# TYPE aggregator_series gauge\naggregator_series %d\n", series_count);
+    arena_str_printf(&text, "# TYPE aggregator_lines_total counter\n");
+    arena_str_printf(&text, "aggregator_lines_total{result=\"accepted\"} %llu\n", lines_accepted);
+    arena_str_printf(&text, "aggregator_lines_total{result=\"rejected\"} %llu\n", lines_rejected);
+
+    if (text.failed)
+    {
+        fprintf(stderr, "Error al asignar memoria para las series agregadas\n");
+        return;
+    }
+    pthread_mutex_lock(&published_lock);
+    published_text = text.data;
+    published_len = text.len;
+    pthread_mutex_unlock(&published_lock);
+    atomic_fetch_add(&generation, ASSIGNED_VALUE);
+    text_next ^= ASSIGNED_VALUE;
+}
+
+/**
+ * @brief Cuerpo del hilo del agregador: vacía el socket sin bloquear y calcula en cada intervalo.
+ */
+static void* aggregator_main(void* arg)
+{
+    (void)arg;
+    static char datagram[AGG_DATAGRAM_SIZE];
+    int64_t next_rollup = now_ms() + interval_ms;
+
+    while (!atomic_load(&stopping))
+    {
+        int64_t now = now_ms();
+        int64_t wait = next_rollup - now;
+        struct pollfd pfd = {listen_fd, POLLIN, INICIAL_VALUE};
+        poll(&pfd, ASSIGNED_VALUE, wait < INICIAL_VALUE ? INICIAL_VALUE : wait < AGG_POLL_MS ? (int)wait : AGG_POLL_MS);
+
+        // Se vacía todo lo que llegó antes de volver a esperar: un poll() por ráfaga, no por datagrama
+        struct sockaddr_storage from;
+        socklen_t from_len = sizeof(from);
+        ssize_t n;
+        now = now_ms();
+        while ((n = recvfrom(listen_fd, datagram, sizeof(datagram) - ASSIGNED_VALUE, MSG_DONTWAIT,
+                             (struct sockaddr*)&from, &from_len)) >= INICIAL_VALUE)
+        {
+            datagram[n] = '\0';
+            agg_ingest_datagram(&from, datagram, (size_t)n, now);
+            from_len = sizeof(from);
+        }
+        if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR)
+        {
+            perror("Error al recibir muestras del agregador");
+        }
+
+        if (now >= next_rollup)
+        {
+            agg_rollup(now);
+            // Como en collector.c, la grilla sigue al intervalo y no al momento en que el hilo despertó
+            next_rollup += ((now - next_rollup) / interval_ms + ASSIGNED_VALUE) * interval_ms;
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Abre el socket UDP de escucha en host:puerto ([::]:8089, 0.0.0.0:8089 o :8089).
+ *
+ * @param listen Dirección de escucha.
+ * @return 0 en caso de éxito, -1 en caso de error.
+ */
+static int agg_listen(const char* listen)
+{
+    char host[AGG_HOST_SIZE] = "";
+    const char* port = strrchr(listen, ':');
+    const char* start = listen[0] == '[' ? listen + ASSIGNED_VALUE : listen;
+    size_t host_len = port != NULL ? (size_t)(port - start) : INICIAL_VALUE;
+    host_len -= host_len > INICIAL_VALUE && start != listen && start[host_len - 1] == ']' ? ASSIGNED_VALUE : 0;
+    if (port == NULL || port[1] == '\0' || host_len >= sizeof(host))
+    {
+        fprintf(stderr, "Dirección de escucha del agregador no válida: %s\n", listen);
+        return ERROR_INT;
+    }
+    memcpy(host, start, host_len);
+    host[host_len] = '\0';
+
+    struct addrinfo hints = {0};
+    struct addrinfo* res;
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_DGRAM;
+    hints.ai_flags = AI_PASSIVE;
+    int ret = getaddrinfo(host[0] != '\0' ? host : NULL, port + ASSIGNED_VALUE, &hints, &res);
+    if (ret != 0)
+    {
+        fprintf(stderr, "Error al resolver %s: %s\n", listen, gai_strerror(ret));
+        return ERROR_INT;
+    }
+    for (struct addrinfo* ai = res; ai != NULL && listen_fd < 0; ai = ai->ai_next)
+    {
+        listen_fd = socket(ai->ai_family, ai->ai_socktype | SOCK_CLOEXEC | SOCK_NONBLOCK, ai->ai_protocol);
+        if (listen_fd >= 0 && bind(listen_fd, ai->ai_addr, ai->ai_addrlen) != 0)
+        {
+            close(listen_fd);
+            listen_fd = ERROR_INT;
+        }
+    }
+    freeaddrinfo(res);
+    if (listen_fd < 0)
+    {
+        fprintf(stderr, "Error al escuchar en %s: %s\n", listen, strerror(errno));
+        return ERROR_INT;
+    }
+
+    // Un buffer chico pierde datagramas cuando miles de hosts envían en el mismo instante
+    int rcvbuf = AGG_RCVBUF;
+    setsockopt(listen_fd, SOL_SOCKET, SO_RCVBUF, &rcvbuf, sizeof(rcvbuf));
+    return INICIAL_VALUE;
+}
+
+int aggregator_start(const aggregator_options_t* options)
+{
+    if (atomic_load(&running) || options == NULL)
+    {
+        return ERROR_INT;
+    }
+
+    group_count = options->group_count < AGGREGATOR_MAX_GROUPS ? options->group_count : AGGREGATOR_MAX_GROUPS;
+    for (int g = 0; g < group_count; g++)
+    {
+        const aggregator_group_t* group = &options->groups[g];
+        snprintf(groups[g].name, AGG_NAME_SIZE, "%s", group->name);
+        groups[g].pattern_count = group->host_count < AGGREGATOR_MAX_PATTERNS ? group->host_count
+                                                                               : AGGREGATOR_MAX_PATTERNS;
+        for (int p = 0; p < groups[g].pattern_count; p++)
+        {
+            snprintf(groups[g].patterns[p], AGG_NAME_SIZE, "%s", group->hosts[p]);
+        }
+    }
+    snprintf(groups[group_count].name, AGG_NAME_SIZE, "%s", AGGREGATOR_DEFAULT_GROUP);
+    groups[group_count].pattern_count = INICIAL_VALUE;
+    snprintf(group_label, sizeof(group_label), "%s",
+             options->group_label != NULL ? options->group_label : AGGREGATOR_DEFAULT_GROUP_LABEL);
+
+    static const double default_quantiles[] = {0.5, 0.9, 0.99};
+    const double* source = options->quantile_count > INICIAL_VALUE ? options->quantiles : default_quantiles;
+    int count = options->quantile_count > INICIAL_VALUE ? options->quantile_count : 3;
+    quantile_count = INICIAL_VALUE;
+    for (int q = 0; q < count && quantile_count < AGGREGATOR_MAX_QUANTILES; q++)
+    {
+        if (source[q] > INICIAL_VALUE && source[q] <= ASSIGNED_VALUE)
+        {
+            quantiles[quantile_count++] = source[q];
+        }
+    }
+    interval_ms = options->interval_ms > INICIAL_VALUE ? options->interval_ms : AGGREGATOR_DEFAULT_INTERVAL_MS;
+    stale_ms = options->stale_ms > INICIAL_VALUE ? options->stale_ms : AGGREGATOR_DEFAULT_STALE_MS;
+
+    if (strmap_init(&hosts_by_addr, INICIAL_VALUE) != INICIAL_VALUE ||
+        strmap_init(&series_by_key, INICIAL_VALUE) != INICIAL_VALUE ||
+        agg_listen(options->listen != NULL ? options->listen : AGGREGATOR_DEFAULT_LISTEN) != INICIAL_VALUE)
+    {
+        aggregator_stop();
+        return ERROR_INT;
+    }
+
+    atomic_store(&stopping, INICIAL_VALUE);
+    if (pthread_create(&aggregator_thread, NULL, aggregator_main, NULL) != 0)
+    {
+        fprintf(stderr, "Error al crear el hilo del agregador\n");
+        aggregator_stop();
+        return ERROR_INT;
+    }
+    atomic_store(&running, ASSIGNED_VALUE);
+    return INICIAL_VALUE;
+}
+
+void aggregator_stop()
+{
+    if (atomic_load(&running))
+    {
+        atomic_store(&stopping, ASSIGNED_VALUE);
+        pthread_join(aggregator_thread, NULL);
+        atomic_store(&running, INICIAL_VALUE);
+    }
+    if (listen_fd >= 0)
+    {
+        close(listen_fd);
+        listen_fd = ERROR_INT;
+    }
+
+    pthread_mutex_lock(&published_lock);
+    published_text = NULL;
+    published_len = INICIAL_VALUE;
+    pthread_mutex_unlock(&published_lock);
+    arena_free(&text_arenas[0]);
+    arena_free(&text_arenas[1]);
+    arena_free(&max_arena);
+
+    for (int i = 0; i < series_count; i++)
+    {
+        agg_series_free(series[i]);
+    }
+    for (int i = 0; i < host_count; i++)
+    {
+        free(hosts[i]);
+    }
+    series_count = host_count = INICIAL_VALUE;
+    strmap_free(&series_by_key);
+    strmap_free(&hosts_by_addr);
+    free(points);
+    points = NULL;
+    points_capacity = INICIAL_VALUE;
+}
+
+unsigned long long aggregator_generation()
+{
+    return atomic_load(&running) ? atomic_load(&generation) : INICIAL_VALUE;
+}
+
+const char* aggregator_append(const char* body, arena_t* arena)
+{
+    if (body == NULL)
+    {
+        return NULL;
+    }
+
+    pthread_mutex_lock(&published_lock);
+    if (published_text != NULL)
+    {
+        size_t len = strlen(body);
+        char* joined = arena_alloc(arena, len + published_len + ASSIGNED_VALUE);
+        if (joined == NULL)
+        {
+            pthread_mutex_unlock(&published_lock);
+            fprintf(stderr, "Error al asignar memoria\n");
+            return NULL;
+        }
+        memcpy(joined, body, len);
+        memcpy(joined + len, published_text, published_len + ASSIGNED_VALUE);
+        body = joined;
+    }
+    pthread_mutex_unlock(&published_lock);
+    return body;
+}
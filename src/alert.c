@@ -0,0 +1,1002 @@
+/**
+ * @file alert.c
+ * @brief Compilación de las reglas de alert.h, su evaluación sobre cada instantánea y el hilo que envía las
+ * notificaciones.
+ *
+ * La evaluación corre en la función suscrita a monitor_snapshot.h, en el hilo de recolección que armó la instantánea:
+ * solo compara números y copia los cambios de estado a la cola. El lock de las reglas lo toman la evaluación y
+ * set_alert_rules() al recargar; el hilo de envío solo toma el de la cola, y sin él formatea y envía.
+ */
+
+#include "alert.h"
+#include "http_client.h"
+#include "metrics.h"
+#include "monitor_snapshot.h"
+#include <ctype.h>
+#include <errno.h>
+#include <math.h>
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdatomic.h>
+#include <stdbool.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <time.h>
+
+/**
+ * @brief Plazo máximo de "for", en milisegundos (un año).
+ */
+#define ALERT_MAX_FOR_MS 31536000000.0
+
+/**
+ * @brief Comparación de una regla.
+ */
+typedef enum
+{
+    ALERT_GT, ///< >
+    ALERT_GE, ///< >=
+    ALERT_LT, ///< <
+    ALERT_LE, ///< <=
+    ALERT_EQ, ///< ==
+    ALERT_NE  ///< !=
+} alert_op_t;
+
+/**
+ * @brief Filtro por etiqueta de una regla.
+ */
+typedef struct
+{
+    char name[METRIC_LABEL_SIZE];  ///< Nombre de la etiqueta.
+    char value[METRIC_LABEL_SIZE]; ///< Valor comparado.
+    bool negate;                   ///< true para !=, false para =.
+    int index;                     ///< Posición de la etiqueta en la métrica, o -1 si no se resolvió.
+} alert_matcher_t;
+
+/**
+ * @brief Serie que cumple la condición de una regla: pendiente hasta cumplir el plazo de "for" y disparada después.
+ */
+typedef struct
+{
+    uint64_t labels_hash;                              ///< Hash de los valores de las etiquetas.
+    char labels[METRIC_MAX_LABELS][METRIC_LABEL_SIZE]; ///< Valores de las etiquetas.
+    double value;                                      ///< Último valor visto.
+    int64_t since_ms;                                  ///< Primera instantánea en que se cumplió la condición.
+    bool firing;                                       ///< true si ya se notificó como disparada.
+    unsigned long long seen;                           ///< Versión de la última instantánea en que apareció.
+} alert_series_t;
+
+/**
+ * @brief Regla compilada: un predicado sobre las muestras de una métrica y el estado de sus series.
+ */
+typedef struct
+{
+    char name[ALERT_NAME_SIZE];                  ///< Nombre de la regla.
+    char expr[ALERT_EXPR_SIZE];                  ///< Expresión original.
+    char metric[ALERT_NAME_SIZE];                ///< Nombre de la métrica.
+    const char* resolved;                        ///< Nombre de la métrica en el registro, una vez vista.
+    bool unmatchable;                            ///< true si algún filtro nombra una etiqueta que la métrica no tiene.
+    int label_count;                             ///< Etiquetas de la métrica.
+    const char* label_names[METRIC_MAX_LABELS];  ///< Nombres de las etiquetas de la métrica.
+    alert_matcher_t matchers[METRIC_MAX_LABELS]; ///< Filtros por etiqueta.
+    int matcher_count;                           ///< Filtros válidos.
+    alert_op_t op;                               ///< Comparación.
+    double threshold;                            ///< Umbral.
+    int64_t for_ms;                              ///< Tiempo que tiene que cumplirse la condición antes de disparar.
+    alert_series_t series[ALERT_MAX_SERIES];     ///< Series pendientes o disparadas.
+    int series_count;                            ///< Series válidas.
+    bool full_warned;                            ///< true si ya se avisó que la regla llegó a ALERT_MAX_SERIES.
+} alert_predicate_t;
+
+/**
+ * @brief Cambio de estado de una serie, copiado a la cola para el hilo de envío.
+ */
+typedef struct
+{
+    char rule[ALERT_NAME_SIZE];                        ///< Nombre de la regla.
+    char expr[ALERT_EXPR_SIZE];                        ///< Expresión de la regla.
+    const char* metric;                                ///< Nombre de la métrica en el registro.
+    bool firing;                                       ///< true si se disparó, false si se resolvió.
+    int label_count;                                   ///< Etiquetas válidas.
+    const char* label_names[METRIC_MAX_LABELS];        ///< Nombres de las etiquetas, o NULL si no se conocen.
+    char labels[METRIC_MAX_LABELS][METRIC_LABEL_SIZE]; ///< Valores de las etiquetas.
+    double value;                                      ///< Último valor visto.
+    double threshold;                                  ///< Umbral de la regla.
+    int64_t since_ms;                                  ///< Instante desde el que se cumple la condición.
+    int64_t timestamp_ms;                              ///< Instante del cambio de estado.
+} alert_event_t;
+
+/**
+ * @brief JSON en armado dentro de un buffer fijo.
+ */
+typedef struct
+{
+    char* data;  ///< Buffer.
+    size_t len;  ///< Bytes escritos; llega a size si el JSON no entra.
+    size_t size; ///< Capacidad de data.
+} alert_message_t;
+
+/**
+ * @brief Reglas compiladas, en el orden de config.json.
+ */
+static alert_predicate_t* predicates = NULL;
+static int predicate_count = INICIAL_VALUE;
+
+/**
+ * @brief Protege predicates y predicate_count.
+ */
+static pthread_mutex_t rules_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * @brief Cola circular de notificaciones y su lock.
+ */
+static pthread_mutex_t queue_lock = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t queue_cond;
+static alert_event_t queue[ALERT_QUEUE_SIZE];
+static size_t queue_head = INICIAL_VALUE;
+static size_t queue_count = INICIAL_VALUE;
+
+/**
+ * @brief 1 mientras el hilo de envío está iniciado.
+ */
+static atomic_int alert_running = INICIAL_VALUE;
+
+/**
+ * @brief 1 cuando alert_stop() pide terminar (protegido por queue_lock).
+ */
+static int alert_stopping = INICIAL_VALUE;
+
+/**
+ * @brief Hilo de envío.
+ */
+static pthread_t alert_thread;
+
+/**
+ * @brief Identificador de la suscripción a las instantáneas, o -1.
+ */
+static int subscription = ERROR_INT;
+
+/**
+ * @brief Webhook: host, puerto y ruta, si está configurado.
+ */
+static bool has_webhook = false;
+static http_target_t webhook_target;
+
+/**
+ * @brief Socket unix de datagramas y su dirección, o -1 si no está configurado.
+ */
+static int unix_fd = ERROR_INT;
+static struct sockaddr_un unix_addr;
+
+/**
+ * @brief Series disparadas en todas las reglas.
+ */
+static atomic_int firing_count = INICIAL_VALUE;
+
+/**
+ * @brief Totales de notificaciones por resultado.
+ */
+static atomic_ullong notifications_sent = INICIAL_VALUE;
+static atomic_ullong notifications_dropped = INICIAL_VALUE;
+static atomic_ullong notifications_failed = INICIAL_VALUE;
+
+/**
+ * @brief Muestras que cumplían una regla y se ignoraron porque la regla ya seguía ALERT_MAX_SERIES series.
+ */
+static atomic_ullong series_dropped = INICIAL_VALUE;
+
+/**
+ * @brief Salta espacios y tabuladores.
+ */
+static const char* skip_spaces(const char* p)
+{
+    while (*p == ' ' || *p == '\t')
+    {
+        p++;
+    }
+    return p;
+}
+
+/**
+ * @brief Lee un nombre de métrica o de etiqueta ([a-zA-Z_:][a-zA-Z0-9_:]*).
+ *
+ * @return Largo del nombre, o 0 si no empieza uno.
+ */
+static size_t name_length(const char* p)
+{
+    size_t len = INICIAL_VALUE;
+    if (isdigit((unsigned char)*p))
+    {
+        return INICIAL_VALUE;
+    }
+    while (isalnum((unsigned char)p[len]) || p[len] == '_' || p[len] == ':')
+    {
+        len++;
+    }
+    return len;
+}
+
+/**
+ * @brief Lee un plazo de "for": un número seguido de ms, s, m o h.
+ *
+ * @param text Texto; avanza hasta después de la unidad.
+ * @param ms Plazo en milisegundos.
+ * @return 0 en caso de éxito, -1 si no es un plazo válido.
+ */
+static int parse_duration(const char** text, int64_t* ms)
+{
+    char* end;
+    double value = strtod(*text, &end);
+    if (end == *text || !isfinite(value) || value < 0)
+    {
+        return ERROR_INT;
+    }
+
+    double factor;
+    if (strncmp(end, "ms", 2) == 0)
+    {
+        factor = 1;
+        end += 2;
+    }
+    else if (*end == 's' || *end == 'm' || *end == 'h')
+    {
+        factor = *end == 's' ? 1000 : *end == 'm' ? 60000 : 3600000;
+        end++;
+    }
+    else
+    {
+        return ERROR_INT;
+    }
+    if (isalnum((unsigned char)*end) || value * factor > ALERT_MAX_FOR_MS)
+    {
+        return ERROR_INT;
+    }
+    *ms = (int64_t)llround(value * factor);
+    *text = end;
+    return INICIAL_VALUE;
+}
+
+/**
+ * @brief Compila una regla: `métrica{etiqueta="valor",...} op umbral [for plazo]`.
+ *
+ * @param rule Regla de config.json.
+ * @param pred Predicado a completar.
+ * @return 0 en caso de éxito, -1 si la expresión no es válida.
+ */
+static int compile_rule(const alert_rule_t* rule, alert_predicate_t* pred)
+{
+    memset(pred, 0, sizeof(*pred));
+    if (rule->name == NULL || rule->expr == NULL || strlen(rule->expr) >= sizeof(pred->expr))
+    {
+        return ERROR_INT;
+    }
+    snprintf(pred->name, sizeof(pred->name), "%s", rule->name);
+    snprintf(pred->expr, sizeof(pred->expr), "%s", rule->expr);
+
+    const char* p = skip_spaces(rule->expr);
+    size_t len = name_length(p);
+    if (len == 0 || len >= sizeof(pred->metric))
+    {
+        return ERROR_INT;
+    }
+    memcpy(pred->metric, p, len);
+    p = skip_spaces(p + len);
+
+    // Filtros opcionales: {cpu="all", mode!="idle"}
+    if (*p == '{')
+    {
+        p = skip_spaces(p + 1);
+        while (*p != '}')
+        {
+            if (pred->matcher_count == METRIC_MAX_LABELS)
+            {
+                return ERROR_INT;
+            }
+            alert_matcher_t* matcher = &pred->matchers[pred->matcher_count++];
+            matcher->index = ERROR_INT;
+            len = name_length(p);
+            if (len == 0 || len >= sizeof(matcher->name))
+            {
+                return ERROR_INT;
+            }
+            memcpy(matcher->name, p, len);
+            p = skip_spaces(p + len);
+            matcher->negate = *p == '!';
+            p += matcher->negate ? 1 : 0;
+            if (*p != '=')
+            {
+                return ERROR_INT;
+            }
+            p = skip_spaces(p + 1);
+            const char* end = *p == '"' ? strchr(p + 1, '"') : NULL;
+            if (end == NULL || (size_t)(end - p - 1) >= sizeof(matcher->value))
+            {
+                return ERROR_INT;
+            }
+            memcpy(matcher->value, p + 1, (size_t)(end - p - 1));
+            p = skip_spaces(end + 1);
+            if (*p == ',')
+            {
+                p = skip_spaces(p + 1);
+            }
+            else if (*p != '}')
+            {
+                return ERROR_INT;
+            }
+        }
+        p = skip_spaces(p + 1);
+    }
+
+    // Los operadores de dos caracteres van primero para que ">=" no se lea como ">"
+    static const struct
+    {
+        const char* text;
+        alert_op_t op;
+    } ops[] = {
+        {">=", ALERT_GE}, {"<=", ALERT_LE}, {"==", ALERT_EQ}, {"!=", ALERT_NE}, {">", ALERT_GT}, {"<", ALERT_LT},
+    };
+    size_t op = INICIAL_VALUE;
+    while (op < sizeof(ops) / sizeof(ops[0]) && strncmp(p, ops[op].text, strlen(ops[op].text)) != 0)
+    {
+        op++;
+    }
+    if (op == sizeof(ops) / sizeof(ops[0]))
+    {
+        return ERROR_INT;
+    }
+    pred->op = ops[op].op;
+    p = skip_spaces(p + strlen(ops[op].text));
+
+    char* end;
+    pred->threshold = strtod(p, &end);
+    if (end == p || !isfinite(pred->threshold))
+    {
+        return ERROR_INT;
+    }
+    p = skip_spaces(end);
+
+    if (strncmp(p, "for", 3) == 0 && (p[3] == ' ' || p[3] == '\t'))
+    {
+        p = skip_spaces(p + 3);
+        if (parse_duration(&p, &pred->for_ms) != 0)
+        {
+            return ERROR_INT;
+        }
+        p = skip_spaces(p);
+    }
+    return *p == '\0' ? INICIAL_VALUE : ERROR_INT;
+}
+
+/**
+ * @brief Evalúa la comparación de una regla.
+ */
+static bool compare(alert_op_t op, double value, double threshold)
+{
+    switch (op)
+    {
+    case ALERT_GT:
+        return value > threshold;
+    case ALERT_GE:
+        return value >= threshold;
+    case ALERT_LT:
+        return value < threshold;
+    case ALERT_LE:
+        return value <= threshold;
+    case ALERT_EQ:
+        return value == threshold;
+    case ALERT_NE:
+        return value != threshold;
+    }
+    return false;
+}
+
+/**
+ * @brief Asocia una regla con la métrica de la primera muestra que lleva su nombre y ubica sus filtros.
+ *
+ * Los nombres del registro son estáticos, así que desde entonces la regla compara punteros en lugar de textos.
+ */
+static void resolve_metric(alert_predicate_t* pred, const monitor_sample_t* sample)
+{
+    pred->resolved = sample->name;
+    pred->label_count = sample->label_count;
+    memcpy(pred->label_names, sample->label_names, sizeof(pred->label_names));
+    for (int m = 0; m < pred->matcher_count; m++)
+    {
+        alert_matcher_t* matcher = &pred->matchers[m];
+        for (int l = 0; l < sample->label_count && matcher->index < 0; l++)
+        {
+            if (sample->label_names[l] != NULL && strcmp(sample->label_names[l], matcher->name) == 0)
+            {
+                matcher->index = l;
+            }
+        }
+        if (matcher->index < 0)
+        {
+            fprintf(stderr, "La regla de alerta %s filtra por la etiqueta %s, que %s no tiene\n", pred->name,
+                    matcher->name, pred->metric);
+            pred->unmatchable = true;
+        }
+    }
+}
+
+/**
+ * @brief Indica si una muestra de la métrica de la regla pasa sus filtros.
+ */
+static bool matches(const alert_predicate_t* pred, const monitor_sample_t* sample)
+{
+    for (int m = 0; m < pred->matcher_count; m++)
+    {
+        const alert_matcher_t* matcher = &pred->matchers[m];
+        bool equal = strncmp(sample->labels[matcher->index], matcher->value, METRIC_LABEL_SIZE) == 0;
+        if (equal == matcher->negate)
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * @brief Copia un cambio de estado a la cola; si está llena se descarta la notificación más vieja.
+ */
+static void enqueue_event(const alert_predicate_t* pred, const alert_series_t* series, bool firing,
+                          int64_t timestamp_ms)
+{
+    if (!atomic_load_explicit(&alert_running, memory_order_acquire))
+    {
+        return;
+    }
+
+    int dropped = INICIAL_VALUE;
+    pthread_mutex_lock(&queue_lock);
+    if (queue_count == ALERT_QUEUE_SIZE)
+    {
+        queue_head = (queue_head + 1) % ALERT_QUEUE_SIZE;
+        queue_count--;
+        dropped = ASSIGNED_VALUE;
+    }
+    alert_event_t* event = &queue[(queue_head + queue_count) % ALERT_QUEUE_SIZE];
+    memcpy(event->rule, pred->name, sizeof(event->rule));
+    memcpy(event->expr, pred->expr, sizeof(event->expr));
+    event->metric = pred->resolved;
+    event->firing = firing;
+    event->label_count = pred->label_count;
+    memcpy(event->label_names, pred->label_names, sizeof(event->label_names));
+    memcpy(event->labels, series->labels, sizeof(event->labels));
+    event->value = series->value;
+    event->threshold = pred->threshold;
+    event->since_ms = series->since_ms;
+    event->timestamp_ms = timestamp_ms;
+    queue_count++;
+    pthread_cond_signal(&queue_cond);
+    pthread_mutex_unlock(&queue_lock);
+
+    if (dropped)
+    {
+        atomic_fetch_add(&notifications_dropped, 1);
+    }
+}
+
+/**
+ * @brief Quita una serie de una regla, notificándola como resuelta si estaba disparada.
+ */
+static void remove_series(alert_predicate_t* pred, int index, int64_t timestamp_ms)
+{
+    alert_series_t* series = &pred->series[index];
+    if (series->firing)
+    {
+        enqueue_event(pred, series, false, timestamp_ms);
+        atomic_fetch_sub(&firing_count, 1);
+    }
+    pred->series[index] = pred->series[--pred->series_count];
+}
+
+/**
+ * @brief Actualiza el estado de la serie de una muestra que pasa los filtros de la regla.
+ */
+static void evaluate_sample(alert_predicate_t* pred, const monitor_sample_t* sample,
+                            const monitor_snapshot_t* snapshot)
+{
+    uint64_t hash = metric_labels_hash(sample->labels, sample->label_count);
+    int index = ERROR_INT;
+    for (int s = 0; s < pred->series_count && index < 0; s++)
+    {
+        const alert_series_t* series = &pred->series[s];
+        bool same = series->labels_hash == hash;
+        for (int l = 0; l < sample->label_count && same; l++)
+        {
+            same = strncmp(series->labels[l], sample->labels[l], METRIC_LABEL_SIZE) == 0;
+        }
+        index = same ? s : ERROR_INT;
+    }
+
+    if (!compare(pred->op, sample->value, pred->threshold))
+    {
+        if (index >= 0)
+        {
+            pred->series[index].value = sample->value;
+            remove_series(pred, index, snapshot->timestamp_ms);
+        }
+        return;
+    }
+
+    if (index < 0)
+    {
+        if (pred->series_count == ALERT_MAX_SERIES)
+        {
+            atomic_fetch_add(&series_dropped, 1);
+            if (!pred->full_warned)
+            {
+                fprintf(stderr, "La regla de alerta %s ya sigue %d series; se ignoran las nuevas hasta que se resuelva "
+                                "alguna\n",
+                        pred->name, ALERT_MAX_SERIES);
+                pred->full_warned = true;
+            }
+            return;
+        }
+        index = pred->series_count++;
+        alert_series_t* series = &pred->series[index];
+        memset(series, 0, sizeof(*series));
+        series->labels_hash = hash;
+        memcpy(series->labels, sample->labels, sizeof(series->labels));
+        series->since_ms = snapshot->timestamp_ms;
+    }
+
+    alert_series_t* series = &pred->series[index];
+    series->value = sample->value;
+    series->seen = snapshot->version;
+    if (!series->firing && snapshot->timestamp_ms - series->since_ms >= pred->for_ms)
+    {
+        series->firing = true;
+        atomic_fetch_add(&firing_count, 1);
+        enqueue_event(pred, series, true, snapshot->timestamp_ms);
+    }
+}
+
+/**
+ * @brief Evalúa todas las reglas sobre una instantánea; la llama monitor_snapshot.c con cada una publicada.
+ */
+static void evaluate_snapshot(const monitor_snapshot_t* snapshot, void* arg)
+{
+    (void)arg;
+    pthread_mutex_lock(&rules_lock);
+    if (predicate_count == 0)
+    {
+        pthread_mutex_unlock(&rules_lock);
+        return;
+    }
+
+    for (size_t i = 0; i < snapshot->count; i++)
+    {
+        const monitor_sample_t* sample = &snapshot->samples[i];
+        for (int r = 0; r < predicate_count; r++)
+        {
+            alert_predicate_t* pred = &predicates[r];
+            if (pred->resolved != sample->name)
+            {
+                if (pred->resolved != NULL || strcmp(pred->metric, sample->name) != 0)
+                {
+                    continue;
+                }
+                resolve_metric(pred, sample);
+            }
+            if (!pred->unmatchable && matches(pred, sample))
+            {
+                evaluate_sample(pred, sample, snapshot);
+            }
+        }
+    }
+
+    // Una serie que ya no está en la instantánea (proceso terminado, dispositivo quitado) se da por resuelta
+    for (int r = 0; r < predicate_count; r++)
+    {
+        alert_predicate_t* pred = &predicates[r];
+        for (int s = pred->series_count - 1; s >= 0; s--)
+        {
+            if (pred->series[s].seen != snapshot->version)
+            {
+                remove_series(pred, s, snapshot->timestamp_ms);
+            }
+        }
+    }
+    pthread_mutex_unlock(&rules_lock);
+}
+
+void set_alert_rules(const alert_rule_t* list, int count)
+{
+    if (count > MAX_ALERT_RULES)
+    {
+        count = MAX_ALERT_RULES;
+    }
+
+    // Se compila sin el lock: la evaluación solo espera el reemplazo
+    alert_predicate_t* next = count > 0 ? calloc((size_t)count, sizeof(*next)) : NULL;
+    if (count > 0 && next == NULL)
+    {
+        perror("Error al asignar memoria");
+        return;
+    }
+    int next_count = INICIAL_VALUE;
+    for (int i = 0; i < count; i++)
+    {
+        if (compile_rule(&list[i], &next[next_count]) != 0)
+        {
+            fprintf(stderr, "Regla de alerta no válida (%s): %s\n", list[i].name ? list[i].name : "",
+                    list[i].expr ? list[i].expr : "");
+            continue;
+        }
+        next_count++;
+    }
+
+    pthread_mutex_lock(&rules_lock);
+    int64_t now = realtime_ms();
+    bool kept[MAX_ALERT_RULES] = {false};
+    for (int i = 0; i < predicate_count; i++)
+    {
+        alert_predicate_t* old = &predicates[i];
+        int match = ERROR_INT;
+        for (int j = 0; j < next_count && match < 0; j++)
+        {
+            if (!kept[j] && strcmp(next[j].name, old->name) == 0 && strcmp(next[j].expr, old->expr) == 0)
+            {
+                match = j;
+            }
+        }
+        if (match >= 0)
+        {
+            // La misma regla conserva sus series y la métrica ya resuelta
+            next[match] = *old;
+            kept[match] = true;
+            continue;
+        }
+        for (int s = old->series_count - 1; s >= 0; s--)
+        {
+            remove_series(old, s, now);
+        }
+    }
+    free(predicates);
+    predicates = next;
+    predicate_count = next_count;
+    pthread_mutex_unlock(&rules_lock);
+}
+
+/**
+ * @brief Agrega texto con formato al JSON; si no entra, lo marca como desbordado.
+ */
+static void message_printf(alert_message_t* msg, const char* format, ...)
+{
+    if (msg->len >= msg->size)
+    {
+        return;
+    }
+    va_list args;
+    va_start(args, format);
+    int n = vsnprintf(msg->data + msg->len, msg->size - msg->len, format, args);
+    va_end(args);
+    msg->len = n < 0 || (size_t)n >= msg->size - msg->len ? msg->size : msg->len + (size_t)n;
+}
+
+/**
+ * @brief Agrega un texto JSON entre comillas, escapando comillas, barras y caracteres de control.
+ */
+static void message_string(alert_message_t* msg, const char* text)
+{
+    message_printf(msg, "\"");
+    for (const unsigned char* c = (const unsigned char*)text; *c != '\0' && msg->len < msg->size; c++)
+    {
+        if (*c == '"' || *c == '\\')
+        {
+            message_printf(msg, "\\%c", *c);
+        }
+        else if (*c < 0x20)
+        {
+            message_printf(msg, "\\u%04x", *c);
+        }
+        else
+        {
+            message_printf(msg, "%c", *c);
+        }
+    }
+    message_printf(msg, "\"");
+}
+
+/**
+ * @brief Agrega un número JSON; NaN e infinito, que JSON no admite, se escriben como null.
+ */
+static void message_number(alert_message_t* msg, double value)
+{
+    if (isfinite(value))
+    {
+        message_printf(msg, "%.10g", value);
+    }
+    else
+    {
+        message_printf(msg, "null");
+    }
+}
+
+/**
+ * @brief Formatea una notificación como una línea JSON.
+ *
+ * @return Largo del JSON, o 0 si no entra en ALERT_MESSAGE_SIZE.
+ */
+static size_t format_event(const alert_event_t* event, char* out, size_t size)
+{
+    alert_message_t msg = {out, INICIAL_VALUE, size};
+    message_printf(&msg, "{\"alert\":");
+    message_string(&msg, event->rule);
+    message_printf(&msg, ",\"state\":\"%s\",\"expr\":", event->firing ? "firing" : "resolved");
+    message_string(&msg, event->expr);
+    message_printf(&msg, ",\"metric\":");
+    message_string(&msg, event->metric != NULL ? event->metric : "");
+    message_printf(&msg, ",\"labels\":{");
+    int written = INICIAL_VALUE;
+    for (int l = 0; l < event->label_count; l++)
+    {
+        if (event->label_names[l] == NULL)
+        {
+            continue;
+        }
+        if (written++ > 0)
+        {
+            message_printf(&msg, ",");
+        }
+        message_string(&msg, event->label_names[l]);
+        message_printf(&msg, ":");
+        message_string(&msg, event->labels[l]);
+    }
+    message_printf(&msg, "},\"value\":");
+    message_number(&msg, event->value);
+    message_printf(&msg, ",\"threshold\":");
+    message_number(&msg, event->threshold);
+    message_printf(&msg, ",\"since_ms\":%lld,\"timestamp_ms\":%lld}\n", (long long)event->since_ms,
+                   (long long)event->timestamp_ms);
+    return msg.len < msg.size ? msg.len : INICIAL_VALUE;
+}
+
+/**
+ * @brief Espera antes del reintento número attempt; se llama sin el lock de la cola.
+ *
+ * @return true si alert_stop() pidió terminar durante la espera.
+ */
+static bool wait_retry(int attempt)
+{
+    unsigned long long ns = monotonic_ns() + ((unsigned long long)ALERT_RETRY_BASE_MS << (attempt - 1)) * 1000000ULL;
+    struct timespec deadline = {(time_t)(ns / 1000000000ULL), (long)(ns % 1000000000ULL)};
+
+    // Las notificaciones nuevas no cortan la espera: solo alert_stop() o el plazo
+    pthread_mutex_lock(&queue_lock);
+    while (!alert_stopping)
+    {
+        if (pthread_cond_timedwait(&queue_cond, &queue_lock, &deadline) == ETIMEDOUT)
+        {
+            break;
+        }
+    }
+    bool stopping = alert_stopping;
+    pthread_mutex_unlock(&queue_lock);
+    return stopping;
+}
+
+/**
+ * @brief Envía una notificación al webhook, reintentando las fallas transitorias con espera exponencial.
+ *
+ * @return true si el webhook la aceptó.
+ */
+static bool deliver_webhook(const char* body, size_t len)
+{
+    for (int attempt = 0; attempt < ALERT_MAX_ATTEMPTS; attempt++)
+    {
+        if (attempt > 0 && wait_retry(attempt))
+        {
+            return false;
+        }
+        int status;
+        http_post_result_t result =
+            http_post(&webhook_target, "Content-Type: application/json\r\n", body, len, ALERT_TIMEOUT_MS, &status);
+        if (result == HTTP_POST_REJECTED)
+        {
+            fprintf(stderr, "El webhook de alertas rechazó la notificación (HTTP %d)\n", status);
+        }
+        if (result != HTTP_POST_RETRY)
+        {
+            return result == HTTP_POST_OK;
+        }
+    }
+    return false;
+}
+
+/**
+ * @brief Envía una notificación al socket unix como un datagrama; sin receptor o con su cola llena, se descarta.
+ *
+ * @return true si el datagrama se entregó entero.
+ */
+static bool deliver_socket(const char* message, size_t len)
+{
+    ssize_t n;
+    do
+    {
+        n = sendto(unix_fd, message, len, MSG_DONTWAIT | MSG_NOSIGNAL, (const struct sockaddr*)&unix_addr,
+                   sizeof(unix_addr));
+    } while (n < 0 && errno == EINTR);
+    return n == (ssize_t)len;
+}
+
+/**
+ * @brief Bucle del hilo de envío: saca una notificación, la formatea y la envía sin el lock.
+ */
+static void* alert_main(void* arg)
+{
+    (void)arg;
+    char message[ALERT_MESSAGE_SIZE];
+
+    pthread_mutex_lock(&queue_lock);
+    while (!alert_stopping)
+    {
+        if (queue_count == 0)
+        {
+            pthread_cond_wait(&queue_cond, &queue_lock);
+            continue;
+        }
+        alert_event_t event = queue[queue_head];
+        queue_head = (queue_head + 1) % ALERT_QUEUE_SIZE;
+        queue_count--;
+        pthread_mutex_unlock(&queue_lock);
+
+        // Cada destino se intenta por separado; la notificación cuenta como enviada si llegó a todos
+        size_t len = format_event(&event, message, sizeof(message));
+        bool delivered = len > 0;
+        if (len > 0 && unix_fd >= 0)
+        {
+            delivered = deliver_socket(message, len) && delivered;
+        }
+        if (len > 0 && has_webhook)
+        {
+            delivered = deliver_webhook(message, len) && delivered;
+        }
+        atomic_fetch_add(delivered ? &notifications_sent : &notifications_failed, 1);
+
+        pthread_mutex_lock(&queue_lock);
+    }
+    pthread_mutex_unlock(&queue_lock);
+    return NULL;
+}
+
+/**
+ * @brief Separa la URL del webhook en host, puerto y ruta.
+ *
+ * @return 0 en caso de éxito, -1 si no es una URL http:// válida.
+ */
+static int parse_webhook(const char* url)
+{
+    // TLS no está soportado: el webhook es un receptor o proxy local en texto plano
+    if (strncmp(url, "http://", 7) != 0)
+    {
+        return ERROR_INT;
+    }
+    return http_target_parse(url + 7, HTTP_DEFAULT_PORT, &webhook_target);
+}
+
+int alert_start(const char* webhook, const char* socket_path)
+{
+    if (atomic_load(&alert_running) || (webhook == NULL && socket_path == NULL))
+    {
+        return ERROR_INT;
+    }
+    if (webhook != NULL && parse_webhook(webhook) != 0)
+    {
+        fprintf(stderr, "Webhook de alertas no válido: %s\n", webhook);
+        return ERROR_INT;
+    }
+    has_webhook = webhook != NULL;
+
+    if (socket_path != NULL)
+    {
+        if (strlen(socket_path) >= sizeof(unix_addr.sun_path))
+        {
+            fprintf(stderr, "Ruta del socket de alertas no válida: %s\n", socket_path);
+            return ERROR_INT;
+        }
+        memset(&unix_addr, 0, sizeof(unix_addr));
+        unix_addr.sun_family = AF_UNIX;
+        memcpy(unix_addr.sun_path, socket_path, strlen(socket_path));
+        unix_fd = socket(AF_UNIX, SOCK_DGRAM | SOCK_CLOEXEC, 0);
+        if (unix_fd < 0)
+        {
+            perror("Error al crear el socket de alertas");
+            return ERROR_INT;
+        }
+    }
+    queue_head = queue_count = INICIAL_VALUE;
+    alert_stopping = INICIAL_VALUE;
+
+    // Las esperas con plazo usan CLOCK_MONOTONIC, como las de push.c
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    int ret = pthread_cond_init(&queue_cond, &attr);
+    pthread_condattr_destroy(&attr);
+    if (ret != 0 || pthread_create(&alert_thread, NULL, alert_main, NULL) != 0)
+    {
+        fprintf(stderr, "Error al crear el hilo de alertas\n");
+        if (ret == 0)
+        {
+            pthread_cond_destroy(&queue_cond);
+        }
+        if (unix_fd >= 0)
+        {
+            close(unix_fd);
+            unix_fd = ERROR_INT;
+        }
+        return ERROR_INT;
+    }
+    atomic_store_explicit(&alert_running, ASSIGNED_VALUE, memory_order_release);
+
+    // La suscripción activa el armado de las instantáneas
+    subscription = monitor_snapshot_subscribe(evaluate_snapshot, NULL);
+    if (subscription < 0)
+    {
+        fprintf(stderr, "Error al suscribir las alertas a las instantáneas\n");
+        alert_stop();
+        return ERROR_INT;
+    }
+    return INICIAL_VALUE;
+}
+
+void alert_stop()
+{
+    if (atomic_load(&alert_running))
+    {
+        // Al volver ninguna evaluación sigue en curso, así que nadie más encola
+        if (subscription >= 0)
+        {
+            monitor_snapshot_unsubscribe(subscription);
+            subscription = ERROR_INT;
+        }
+        atomic_store(&alert_running, INICIAL_VALUE);
+
+        pthread_mutex_lock(&queue_lock);
+        alert_stopping = ASSIGNED_VALUE;
+        pthread_cond_signal(&queue_cond);
+        pthread_mutex_unlock(&queue_lock);
+        pthread_join(alert_thread, NULL);
+
+        pthread_cond_destroy(&queue_cond);
+        if (unix_fd >= 0)
+        {
+            close(unix_fd);
+            unix_fd = ERROR_INT;
+        }
+        has_webhook = false;
+    }
+
+    // Las reglas se compilan aunque no haya destino, así que se liberan siempre
+    pthread_mutex_lock(&rules_lock);
+    free(predicates);
+    predicates = NULL;
+    predicate_count = INICIAL_VALUE;
+    pthread_mutex_unlock(&rules_lock);
+    atomic_store(&firing_count, INICIAL_VALUE);
+}
+
+int alert_firing_count()
+{
+    return atomic_load(&firing_count);
+}
+
+void alert_counters(unsigned long long counts[ALERT_RESULT_COUNT])
+{
+    counts[ALERT_RESULT_SENT] = atomic_load(&notifications_sent);
+    counts[ALERT_RESULT_DROPPED] = atomic_load(&notifications_dropped);
+    counts[ALERT_RESULT_FAILED] = atomic_load(&notifications_failed);
+}
+
+unsigned long long alert_series_dropped()
+{
+    return atomic_load(&series_dropped);
+}
+
+const char* alert_result_name(alert_result_t result)
+{
+    static const char* const names[ALERT_RESULT_COUNT] = {"sent", "dropped", "failed"};
+    return names[result];
+}
@@ -0,0 +1,197 @@
+/**
+ * @file arena.c
+ * @brief Implementación de la arena de reserva lineal.
+ */
+
+#include "arena.h"
+#include "metrics.h"
+#include <stdarg.h>
+
+/**
+ * @brief Bloque de memoria de la arena.
+ */
+struct arena_block
+{
+    arena_block_t* next; ///< Bloque anterior, o NULL.
+    size_t cap;          ///< Bytes de data.
+    size_t used;         ///< Bytes ya reservados de data.
+    _Alignas(ARENA_ALIGN) unsigned char data[];
+};
+
+/**
+ * @brief Redondea un tamaño a la alineación de la arena.
+ */
+static size_t arena_round(size_t size)
+{
+    return (size + ARENA_ALIGN - ASSIGNED_VALUE) & ~(size_t)(ARENA_ALIGN - ASSIGNED_VALUE);
+}
+
+/**
+ * @brief Agrega un bloque de al menos size bytes delante de los actuales.
+ *
+ * @return Bloque nuevo, o NULL si no hay memoria.
+ */
+static arena_block_t* arena_push_block(arena_t* arena, size_t size)
+{
+    size_t cap = size > ARENA_BLOCK_SIZE ? size : ARENA_BLOCK_SIZE;
+    arena_block_t* block = malloc(sizeof(*block) + cap);
+    if (block == NULL)
+    {
+        perror("Error al asignar memoria");
+        return NULL;
+    }
+    block->next = arena->head;
+    block->cap = cap;
+    block->used = INICIAL_VALUE;
+    arena->head = block;
+    arena->capacity += cap;
+    return block;
+}
+
+void* arena_alloc(arena_t* arena, size_t size)
+{
+    arena_block_t* block = arena->head;
+    size = arena_round(size);
+    if (block == NULL || block->cap - block->used < size)
+    {
+        // El resto del bloque actual se pierde hasta el reinicio, que junta todo en un bloque
+        block = arena_push_block(arena, size);
+        if (block == NULL)
+        {
+            return NULL;
+        }
+    }
+    void* ptr = block->data + block->used;
+    block->used += size;
+    return ptr;
+}
+
+void arena_reset(arena_t* arena)
+{
+    if (arena->head == NULL)
+    {
+        return;
+    }
+    size_t capacity = arena->capacity;
+    if (capacity > ARENA_RETAIN_MAX)
+    {
+        arena_free(arena);
+        return;
+    }
+    if (arena->head->next == NULL)
+    {
+        arena->head->used = INICIAL_VALUE;
+        return;
+    }
+    arena_free(arena);
+    arena_push_block(arena, capacity);
+}
+
+void arena_free(arena_t* arena)
+{
+    arena_block_t* block = arena->head;
+    while (block != NULL)
+    {
+        arena_block_t* next = block->next;
+        free(block);
+        block = next;
+    }
+    arena->head = NULL;
+    arena->capacity = INICIAL_VALUE;
+}
+
+void arena_str_init(arena_str_t* str, arena_t* arena)
+{
+    memset(str, INICIAL_VALUE, sizeof(*str));
+    str->arena = arena;
+}
+
+/**
+ * @brief Asegura lugar para extra bytes más el '\0'.
+ *
+ * @return 0 en caso de éxito, -1 si no hay memoria.
+ */
+static int arena_str_reserve(arena_str_t* str, size_t extra)
+{
+    if (str->failed)
+    {
+        return ERROR_INT;
+    }
+    size_t need = str->len + extra + ASSIGNED_VALUE;
+    if (need <= str->cap)
+    {
+        return INICIAL_VALUE;
+    }
+
+    // Si el texto es la última reserva del bloque actual y hay lugar, se extiende sin copiar
+    arena_block_t* block = str->arena->head;
+    if (str->data != NULL && block != NULL && (unsigned char*)str->data + arena_round(str->cap) ==
+                                                  block->data + block->used)
+    {
+        size_t grow = arena_round(need) - arena_round(str->cap);
+        if (block->cap - block->used >= grow)
+        {
+            block->used += grow;
+            str->cap = arena_round(need);
+            return INICIAL_VALUE;
+        }
+    }
+
+    size_t cap = str->cap ? str->cap * 2 : BUFFER_SIZE;
+    while (cap < need)
+    {
+        cap *= 2;
+    }
+    char* data = arena_alloc(str->arena, cap);
+    if (data == NULL)
+    {
+        str->failed = ASSIGNED_VALUE;
+        return ERROR_INT;
+    }
+    if (str->len > INICIAL_VALUE)
+    {
+        memcpy(data, str->data, str->len);
+    }
+    str->data = data;
+    str->cap = arena_round(cap);
+    return INICIAL_VALUE;
+}
+
+void arena_str_append(arena_str_t* str, const char* data, size_t len)
+{
+    if (arena_str_reserve(str, len) != INICIAL_VALUE)
+    {
+        return;
+    }
+    memcpy(str->data + str->len, data, len);
+    str->len += len;
+    str->data[str->len] = '\0';
+}
+
+void arena_str_printf(arena_str_t* str, const char* fmt, ...)
+{
+    va_list args;
+    char small[BUFFER_SIZE];
+
+    va_start(args, fmt);
+    int n = vsnprintf(small, sizeof(small), fmt, args);
+    va_end(args);
+    if (n < INICIAL_VALUE)
+    {
+        return;
+    }
+    if ((size_t)n < sizeof(small))
+    {
+        arena_str_append(str, small, (size_t)n);
+        return;
+    }
+
+    if (arena_str_reserve(str, (size_t)n) != INICIAL_VALUE)
+    {
+        return;
+    }
+    va_start(args, fmt);
+    vsnprintf(str->data + str->len, (size_t)n + ASSIGNED_VALUE, fmt, args);
+    va_end(args);
+    str->len += (size_t)n;
+}
@@ -0,0 +1,212 @@
+/**
+ * @file latency.bpf.c
+ * @brief Programa eBPF que arma en el kernel los histogramas de latencia de la cola de ejecución y de E/S de bloque.
+ *
+ * Se compila con clang -target bpf y se embebe en el ejecutable (ver CMakeLists.txt). Usa las tracepoints clásicas
+ * en lugar de BTF, así que no necesita vmlinux.h: los contextos de abajo repiten los campos de
+ * /sys/kernel/tracing/events/{sched,block}/.../format que se usan, cuyo desplazamiento no cambió entre versiones.
+ */
+
+#include "bpf_latency_maps.h"
+#include <linux/bpf.h>
+#include <linux/types.h>
+#include <bpf/bpf_helpers.h>
+
+/**
+ * @brief Inicios pendientes de cada mapa; los que no terminan nunca (tareas que mueren dormidas) se desalojan solos.
+ */
+#define PENDING_MAX 16384
+
+/**
+ * @brief Estado de una tarea que compite por la CPU (prev_state de sched_switch).
+ */
+#define TASK_RUNNING 0
+
+/**
+ * @brief Contexto de sched_wakeup y sched_wakeup_new.
+ */
+struct sched_wakeup_ctx
+{
+    __u64 common; ///< Encabezado común de las tracepoints.
+    char comm[16];
+    __s32 pid;
+    __s32 prio;
+    __s32 target_cpu;
+};
+
+/**
+ * @brief Contexto de sched_switch.
+ */
+struct sched_switch_ctx
+{
+    __u64 common;
+    char prev_comm[16];
+    __s32 prev_pid;
+    __s32 prev_prio;
+    __s64 prev_state;
+    char next_comm[16];
+    __s32 next_pid;
+    __s32 next_prio;
+};
+
+/**
+ * @brief Prefijo común de los contextos de block_rq_issue y block_rq_complete.
+ */
+struct block_rq_ctx
+{
+    __u64 common;
+    __u32 dev;
+    __u32 pad;
+    __u64 sector;
+};
+
+/**
+ * @brief Pedido de bloque en vuelo.
+ */
+struct rq_key
+{
+    __u32 dev;
+    __u32 pad;
+    __u64 sector;
+};
+
+/**
+ * @brief Instante en que cada tarea quedó lista para correr.
+ */
+struct
+{
+    __uint(type, BPF_MAP_TYPE_LRU_HASH);
+    __uint(max_entries, PENDING_MAX);
+    __type(key, __u32);
+    __type(value, __u64);
+} wakeup_start SEC(".maps");
+
+/**
+ * @brief Instante en que se emitió cada pedido de bloque.
+ */
+struct
+{
+    __uint(type, BPF_MAP_TYPE_LRU_HASH);
+    __uint(max_entries, PENDING_MAX);
+    __type(key, struct rq_key);
+    __type(value, __u64);
+} rq_start SEC(".maps");
+
+/**
+ * @brief Histogramas por CPU, indexados por enum bpf_latency_kind.
+ */
+struct
+{
+    __uint(type, BPF_MAP_TYPE_PERCPU_ARRAY);
+    __uint(max_entries, BPF_LATENCY_COUNT);
+    __type(key, __u32);
+    __type(value, struct bpf_latency_slots);
+} latency_hists SEC(".maps");
+
+/**
+ * @brief Suma una latencia a su histograma en la copia de la CPU actual.
+ */
+static __always_inline void observe(__u32 kind, __u64 delta_ns)
+{
+    struct bpf_latency_slots* hist = bpf_map_lookup_elem(&latency_hists, &kind);
+    if (!hist)
+    {
+        return;
+    }
+
+    __u64 us = delta_ns / 1000;
+    __u32 slot = 0;
+#pragma unroll
+    for (int i = 0; i < BPF_LATENCY_SLOTS - 1; i++)
+    {
+        if (us < 2)
+        {
+            break;
+        }
+        us >>= 1;
+        slot++;
+    }
+    hist->slots[slot]++;
+    hist->count++;
+    hist->sum_ns += delta_ns;
+}
+
+/**
+ * @brief Guarda el instante en que una tarea quedó lista para correr.
+ */
+static __always_inline void mark_runnable(__s32 pid)
+{
+    __u32 key = (__u32)pid;
+    __u64 now = bpf_ktime_get_ns();
+    if (pid != 0)
+    {
+        bpf_map_update_elem(&wakeup_start, &key, &now, BPF_ANY);
+    }
+}
+
+SEC("tracepoint/sched/sched_wakeup")
+int on_sched_wakeup(struct sched_wakeup_ctx* ctx)
+{
+    mark_runnable(ctx->pid);
+    return 0;
+}
+
+SEC("tracepoint/sched/sched_wakeup_new")
+int on_sched_wakeup_new(struct sched_wakeup_ctx* ctx)
+{
+    mark_runnable(ctx->pid);
+    return 0;
+}
+
+SEC("tracepoint/sched/sched_switch")
+int on_sched_switch(struct sched_switch_ctx* ctx)
+{
+    // Una tarea expropiada sigue lista para correr y vuelve a la cola
+    if (ctx->prev_state == TASK_RUNNING)
+    {
+        mark_runnable(ctx->prev_pid);
+    }
+
+    __u32 key = (__u32)ctx->next_pid;
+    __u64* start = bpf_map_lookup_elem(&wakeup_start, &key);
+    if (!start)
+    {
+        return 0;
+    }
+    __u64 now = bpf_ktime_get_ns();
+    if (now > *start)
+    {
+        observe(BPF_LATENCY_RUNQUEUE, now - *start);
+    }
+    bpf_map_delete_elem(&wakeup_start, &key);
+    return 0;
+}
+
+SEC("tracepoint/block/block_rq_issue")
+int on_block_rq_issue(struct block_rq_ctx* ctx)
+{
+    struct rq_key key = {.dev = ctx->dev, .sector = ctx->sector};
+    __u64 now = bpf_ktime_get_ns();
+    bpf_map_update_elem(&rq_start, &key, &now, BPF_ANY);
+    return 0;
+}
+
+SEC("tracepoint/block/block_rq_complete")
+int on_block_rq_complete(struct block_rq_ctx* ctx)
+{
+    struct rq_key key = {.dev = ctx->dev, .sector = ctx->sector};
+    __u64* start = bpf_map_lookup_elem(&rq_start, &key);
+    if (!start)
+    {
+        return 0;
+    }
+    __u64 now = bpf_ktime_get_ns();
+    if (now > *start)
+    {
+        observe(BPF_LATENCY_BLOCK, now - *start);
+    }
+    bpf_map_delete_elem(&rq_start, &key);
+    return 0;
+}
+
+char LICENSE[] SEC("license") = "GPL";
@@ -0,0 +1,188 @@
+/**
+ * @file bpf_latency.c
+ * @brief Carga del programa eBPF de latencias y lectura de sus histogramas por CPU.
+ *
+ * El objeto compilado de src/bpf/latency.bpf.c se embebe como un arreglo (latency_bpf_object.h, generado por CMake),
+ * así que el ejecutable no depende de ningún archivo instalado aparte. bpf_latency_scan() corre siempre en el hilo de
+ * la tarea "latency", por lo que el estado no necesita lock.
+ */
+
+#include "bpf_latency.h"
+#include "metrics.h"
+#include <errno.h>
+
+/**
+ * @brief Histogramas del último ciclo, sumando todas las CPUs; proc_snapshot_t::latency apunta aquí.
+ */
+static bpf_latency_hist_t hists[BPF_LATENCY_COUNT];
+
+double bpf_latency_slot_bound(int slot)
+{
+    return (double)(1ULL << (slot + ASSIGNED_VALUE)) / 1e6;
+}
+
+#ifdef HAVE_LIBBPF
+#include "latency_bpf_object.h"
+#include <bpf/bpf.h>
+#include <bpf/libbpf.h>
+
+/**
+ * @brief Programas del objeto: uno por tracepoint.
+ */
+#define BPF_LATENCY_PROGRAMS 5
+
+/**
+ * @brief Objeto cargado, o NULL.
+ */
+static struct bpf_object* object = NULL;
+
+/**
+ * @brief Enganches de los programas.
+ */
+static struct bpf_link* links[BPF_LATENCY_PROGRAMS];
+
+/**
+ * @brief Cantidad de entradas válidas de links.
+ */
+static int link_count = INICIAL_VALUE;
+
+/**
+ * @brief Descriptor del mapa latency_hists.
+ */
+static int hists_fd = ERROR_INT;
+
+/**
+ * @brief Copias por CPU de un histograma, leídas de una vez con bpf_map_lookup_elem().
+ */
+static struct bpf_latency_slots* percpu = NULL;
+
+/**
+ * @brief CPUs posibles, tamaño de percpu.
+ */
+static int cpu_count = INICIAL_VALUE;
+
+/**
+ * @brief 1 si la carga falló; no se reintenta hasta bpf_latency_close().
+ */
+static int unavailable = INICIAL_VALUE;
+
+/**
+ * @brief Carga el objeto embebido y engancha cada programa a su tracepoint.
+ *
+ * @return 0 en caso de éxito, -1 en caso de error (el estado queda liberado).
+ */
+static int bpf_latency_open()
+{
+    struct bpf_program* prog;
+    long err;
+
+    object = bpf_object__open_mem(latency_bpf_object, sizeof(latency_bpf_object), NULL);
+    if ((err = libbpf_get_error(object)) != INICIAL_VALUE)
+    {
+        object = NULL;
+        fprintf(stderr, "Error al abrir el programa eBPF: %s\n", strerror((int)-err));
+        return ERROR_INT;
+    }
+    if ((err = bpf_object__load(object)) != INICIAL_VALUE)
+    {
+        fprintf(stderr, "Error al cargar el programa eBPF: %s\n", strerror((int)-err));
+        bpf_latency_close();
+        return ERROR_INT;
+    }
+
+    bpf_object__for_each_program(prog, object)
+    {
+        struct bpf_link* link = link_count < BPF_LATENCY_PROGRAMS ? bpf_program__attach(prog) : NULL;
+        if (link == NULL || (err = libbpf_get_error(link)) != INICIAL_VALUE)
+        {
+            fprintf(stderr, "Error al enganchar %s\n", bpf_program__name(prog));
+            bpf_latency_close();
+            return ERROR_INT;
+        }
+        links[link_count++] = link;
+    }
+
+    struct bpf_map* map = bpf_object__find_map_by_name(object, "latency_hists");
+    cpu_count = libbpf_num_possible_cpus();
+    hists_fd = map != NULL ? bpf_map__fd(map) : ERROR_INT;
+    percpu = cpu_count > INICIAL_VALUE ? calloc((size_t)cpu_count, sizeof(*percpu)) : NULL;
+    if (hists_fd < INICIAL_VALUE || percpu == NULL)
+    {
+        fprintf(stderr, "Error al preparar el mapa de histogramas eBPF\n");
+        bpf_latency_close();
+        return ERROR_INT;
+    }
+    return INICIAL_VALUE;
+}
+
+int bpf_latency_scan(proc_snapshot_t* snap)
+{
+    snap->latency = NULL;
+    if (unavailable)
+    {
+        return INICIAL_VALUE;
+    }
+    if (object == NULL && bpf_latency_open() != INICIAL_VALUE)
+    {
+        fprintf(stderr, "eBPF no disponible; no se publican las latencias de planificación y de E/S\n");
+        unavailable = ASSIGNED_VALUE;
+        return INICIAL_VALUE;
+    }
+
+    for (unsigned int kind = 0; kind < BPF_LATENCY_COUNT; kind++)
+    {
+        bpf_latency_hist_t* hist = &hists[kind];
+        if (bpf_map_lookup_elem(hists_fd, &kind, percpu) != INICIAL_VALUE)
+        {
+            fprintf(stderr, "Error al leer los histogramas eBPF: %s\n", strerror(errno));
+            return INICIAL_VALUE;
+        }
+        memset(hist, INICIAL_VALUE, sizeof(*hist));
+        for (int cpu = 0; cpu < cpu_count; cpu++)
+        {
+            for (int s = 0; s < BPF_LATENCY_SLOTS; s++)
+            {
+                hist->slots[s] += percpu[cpu].slots[s];
+            }
+            hist->count += percpu[cpu].count;
+            hist->sum_ns += percpu[cpu].sum_ns;
+        }
+    }
+    snap->latency = hists;
+    return INICIAL_VALUE;
+}
+
+void bpf_latency_close()
+{
+    for (int i = 0; i < link_count; i++)
+    {
+        bpf_link__destroy(links[i]);
+    }
+    if (object != NULL)
+    {
+        bpf_object__close(object);
+    }
+    free(percpu);
+    object = NULL;
+    link_count = INICIAL_VALUE;
+    hists_fd = ERROR_INT;
+    percpu = NULL;
+    cpu_count = INICIAL_VALUE;
+    unavailable = INICIAL_VALUE;
+}
+
+#else
+
+int bpf_latency_scan(proc_snapshot_t* snap)
+{
+    // Compilado sin libbpf: la fuente existe para que la tarea y las métricas no dependan de la compilación
+    (void)hists;
+    snap->latency = NULL;
+    return INICIAL_VALUE;
+}
+
+void bpf_latency_close()
+{
+}
+
+#endif
@@ -0,0 +1,402 @@
+/**
+ * @file cgroup_stats.c
+ * @brief Recorrido de la jerarquía de cgroup v2 con estado persistente por cgroup.
+ *
+ * Cada directorio se abre con openat() relativo a su padre, de modo que ninguna ruta se resuelve completa, y se lee
+ * con getdents64() sobre un buffer de la pila, sin reservar un DIR por directorio. Los cgroups que desaparecen (por
+ * ejemplo contenedores terminados) se liberan en el mismo ciclo, y los que exceden CGROUP_MAX_GROUPS se ignoran hasta
+ * que se libere lugar.
+ */
+
+#include "cgroup_stats.h"
+#include "metric_store.h"
+#include "metrics.h"
+#include "monitor_stats.h"
+#include "scan.h"
+#include "strmap.h"
+#include <dirent.h>
+#include <fcntl.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <sys/syscall.h>
+
+/**
+ * @brief Tamaño del buffer de lectura de los archivos de un cgroup.
+ */
+#define CGROUP_READ_SIZE 4096
+
+/**
+ * @brief Tamaño del buffer de getdents64() de cada nivel del recorrido.
+ */
+#define CGROUP_DIRENT_SIZE 4096
+
+/**
+ * @brief Entrada de getdents64() (struct linux_dirent64 del kernel, que glibc solo declara con _GNU_SOURCE).
+ */
+typedef struct
+{
+    uint64_t d_ino;          ///< Inodo.
+    int64_t d_off;           ///< Posición de la entrada siguiente.
+    unsigned short d_reclen; ///< Longitud de esta entrada, incluido el relleno.
+    unsigned char d_type;    ///< Tipo DT_*.
+    char d_name[];           ///< Nombre terminado en '\0'.
+} cgroup_dirent_t;
+
+/**
+ * @brief Tabla de cgroups indexada por ruta relativa.
+ */
+static strmap_t by_path;
+
+/**
+ * @brief Cgroups seguidos; proc_snapshot_t::cgroups apunta aquí.
+ */
+static cgroup_usage_t* groups[CGROUP_MAX_GROUPS];
+
+/**
+ * @brief Cantidad de entradas de groups.
+ */
+static int group_count = INICIAL_VALUE;
+
+/**
+ * @brief Número de ciclo de recorrido, usado para detectar cgroups que desaparecieron.
+ */
+static unsigned int scan_cycle = INICIAL_VALUE;
+
+/**
+ * @brief 1 si ya se avisó que se alcanzó CGROUP_MAX_GROUPS.
+ */
+static int full_warned = INICIAL_VALUE;
+
+/**
+ * @brief 1 si ya se avisó que no hay una jerarquía de cgroup v2.
+ */
+static int root_warned = INICIAL_VALUE;
+
+/**
+ * @brief Profundidad de la jerarquía; se cambia desde el hilo de configuración.
+ */
+static atomic_int max_depth = CGROUP_DEFAULT_DEPTH;
+
+/**
+ * @brief Configura hasta qué profundidad de la jerarquía se siguen cgroups.
+ *
+ * @param depth Profundidad.
+ */
+void set_cgroup_depth(int depth)
+{
+    if (depth < ASSIGNED_VALUE)
+    {
+        depth = ASSIGNED_VALUE;
+    }
+    if (depth > CGROUP_MAX_DEPTH)
+    {
+        depth = CGROUP_MAX_DEPTH;
+    }
+    atomic_store(&max_depth, depth);
+}
+
+/**
+ * @brief Lee un archivo de un cgroup.
+ *
+ * @param dir_fd Descriptor del directorio del cgroup.
+ * @param file Nombre del archivo.
+ * @param buf Buffer de lectura, terminado en '\0' tras la lectura.
+ * @param cap Capacidad del buffer.
+ * @return Bytes leídos, o -1 si el archivo no existe (controlador no habilitado) o no se pudo leer.
+ */
+static ssize_t cgroup_read(int dir_fd, const char* file, char* buf, size_t cap)
+{
+    int fd = openat(dir_fd, file, O_RDONLY | O_CLOEXEC);
+    monitor_count_syscall(MONITOR_SYSCALL_OPEN);
+    if (fd < INICIAL_VALUE)
+    {
+        return ERROR_INT;
+    }
+    ssize_t n = pread(fd, buf, cap - ASSIGNED_VALUE, INICIAL_VALUE);
+    monitor_count_read(n);
+    close(fd);
+    monitor_count_syscall(MONITOR_SYSCALL_CLOSE);
+    if (n < INICIAL_VALUE)
+    {
+        return ERROR_INT;
+    }
+    buf[n] = '\0';
+    return n;
+}
+
+/**
+ * @brief Busca el estado persistente de un cgroup, creándolo si es nuevo y queda lugar.
+ *
+ * @param path Ruta relativa a la raíz.
+ * @param path_len Longitud de la ruta.
+ * @return Estado del cgroup, o NULL si no hay lugar o memoria.
+ */
+static cgroup_usage_t* cgroup_lookup(const char* path, size_t path_len)
+{
+    cgroup_usage_t* group = strmap_get(&by_path, path, path_len);
+    if (group != NULL)
+    {
+        return group;
+    }
+
+    if (group_count == CGROUP_MAX_GROUPS)
+    {
+        if (!full_warned)
+        {
+            fprintf(stderr, "Se alcanzó el máximo de %d cgroups; se ignoran los nuevos\n", CGROUP_MAX_GROUPS);
+            full_warned = ASSIGNED_VALUE;
+        }
+        return NULL;
+    }
+
+    group = calloc(1, sizeof(*group));
+    if (group == NULL)
+    {
+        perror("Error al asignar memoria");
+        return NULL;
+    }
+    scan_copy(group->path, sizeof(group->path), path, path_len);
+
+    if (strmap_put(&by_path, group->path, group) != INICIAL_VALUE)
+    {
+        free(group);
+        return NULL;
+    }
+    groups[group_count++] = group;
+    return group;
+}
+
+/**
+ * @brief Relee cpu.stat, memory.current e io.stat de un cgroup y recalcula sus tasas.
+ *
+ * @param group Cgroup.
+ * @param dir_fd Descriptor del directorio del cgroup.
+ * @param now Instante de la lectura.
+ */
+static void cgroup_update(cgroup_usage_t* group, int dir_fd, unsigned long long now)
+{
+    static char buf[CGROUP_READ_SIZE]; // cgroup_scan() corre en un único hilo
+    unsigned long long usage_usec = group->usage_usec;
+    unsigned long long read_bytes = INICIAL_VALUE, write_bytes = INICIAL_VALUE;
+    const char* key;
+    size_t key_len;
+    scan_t s, line;
+    ssize_t n;
+
+    if ((n = cgroup_read(dir_fd, "cpu.stat", buf, sizeof(buf))) >= INICIAL_VALUE)
+    {
+        scan_init(&s, buf, (size_t)n);
+        if (scan_skip_to_key(&s, "usage_usec", &line))
+        {
+            scan_u64(&line, &usage_usec);
+        }
+    }
+
+    group->memory_current = INICIAL_VALUE;
+    if ((n = cgroup_read(dir_fd, "memory.current", buf, sizeof(buf))) >= INICIAL_VALUE)
+    {
+        scan_init(&s, buf, (size_t)n);
+        scan_u64(&s, &group->memory_current);
+    }
+
+    // "8:0 rbytes=N wbytes=N rios=N wios=N dbytes=N dios=N", una línea por dispositivo
+    if ((n = cgroup_read(dir_fd, "io.stat", buf, sizeof(buf))) >= INICIAL_VALUE)
+    {
+        scan_init(&s, buf, (size_t)n);
+        while (scan_next_line(&s, &line))
+        {
+            unsigned long long value;
+            if (!scan_token(&line, &key, &key_len))
+            {
+                continue;
+            }
+            while (scan_until(&line, '=', &key, &key_len) && scan_u64(&line, &value))
+            {
+                if (key_len == 6 && memcmp(key, "rbytes", 6) == INICIAL_VALUE)
+                {
+                    read_bytes += value;
+                }
+                else if (key_len == 6 && memcmp(key, "wbytes", 6) == INICIAL_VALUE)
+                {
+                    write_bytes += value;
+                }
+            }
+        }
+    }
+
+    // Un total menor que el anterior (dispositivo quitado) cuenta como reinicio: la tasa de ese ciclo es cero
+    double elapsed = group->has_prev && now > group->prev_timestamp_ns
+                         ? (double)(now - group->prev_timestamp_ns) / 1e9
+                         : INICIAL_VALUE;
+    group->cpu_percent = elapsed > INICIAL_VALUE && usage_usec >= group->usage_usec
+                             ? (double)(usage_usec - group->usage_usec) / 1e6 / elapsed * POCENTAGE
+                             : INICIAL_VALUE;
+    group->read_bytes_per_second = elapsed > INICIAL_VALUE && read_bytes >= group->read_bytes
+                                       ? (double)(read_bytes - group->read_bytes) / elapsed
+                                       : INICIAL_VALUE;
+    group->write_bytes_per_second = elapsed > INICIAL_VALUE && write_bytes >= group->write_bytes
+                                        ? (double)(write_bytes - group->write_bytes) / elapsed
+                                        : INICIAL_VALUE;
+
+    group->usage_usec = usage_usec;
+    group->read_bytes = read_bytes;
+    group->write_bytes = write_bytes;
+    group->prev_timestamp_ns = now;
+    group->has_prev = ASSIGNED_VALUE;
+}
+
+/**
+ * @brief Recorre los cgroups hijos de un directorio hasta la profundidad indicada.
+ *
+ * @param dir_fd Descriptor del directorio; la función lo cierra.
+ * @param path Ruta relativa del directorio, con espacio para CGROUP_PATH_SIZE bytes.
+ * @param path_len Longitud de path.
+ * @param depth Profundidad de los hijos.
+ * @param limit Profundidad máxima.
+ * @param now Instante de la lectura.
+ */
+static void cgroup_walk(int dir_fd, char* path, size_t path_len, int depth, int limit, unsigned long long now)
+{
+    // getdents64() sobre el descriptor en lugar de fdopendir(), que reserva un DIR en el heap por cada directorio
+    char entries[CGROUP_DIRENT_SIZE] __attribute__((aligned(8)));
+    ssize_t n;
+
+    while ((n = syscall(SYS_getdents64, dir_fd, entries, sizeof(entries))) > INICIAL_VALUE)
+    {
+        for (ssize_t off = 0; off < n;)
+        {
+            const cgroup_dirent_t* de = (const cgroup_dirent_t*)(entries + off);
+            off += de->d_reclen;
+            if (de->d_type != DT_DIR || de->d_name[0] == '.')
+            {
+                continue; // Archivos de interfaz (cpu.stat, ...) y entradas "." y ".."
+            }
+
+            int len =
+                snprintf(path + path_len, CGROUP_PATH_SIZE - path_len, "%s%s", path_len ? "/" : "", de->d_name);
+            if (len < INICIAL_VALUE || path_len + (size_t)len >= CGROUP_PATH_SIZE)
+            {
+                continue;
+            }
+            int child_fd = openat(dir_fd, de->d_name, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+            if (child_fd < INICIAL_VALUE)
+            {
+                continue;
+            }
+
+            cgroup_usage_t* group = cgroup_lookup(path, path_len + (size_t)len);
+            if (group != NULL)
+            {
+                group->last_seen = scan_cycle;
+                cgroup_update(group, child_fd, now);
+            }
+            if (depth < limit)
+            {
+                cgroup_walk(child_fd, path, path_len + (size_t)len, depth + ASSIGNED_VALUE, limit, now);
+            }
+            else
+            {
+                close(child_fd);
+            }
+            path[path_len] = '\0';
+        }
+    }
+    close(dir_fd);
+}
+
+/**
+ * @brief Libera los cgroups que no aparecieron en el ciclo actual.
+ */
+static void cgroup_remove_stale()
+{
+    for (int i = 0; i < group_count;)
+    {
+        if (groups[i]->last_seen == scan_cycle)
+        {
+            i++;
+            continue;
+        }
+        strmap_remove(&by_path, groups[i]->path);
+        free(groups[i]);
+        groups[i] = groups[--group_count];
+        full_warned = INICIAL_VALUE;
+    }
+}
+
+/**
+ * @brief Abre la raíz de cgroup v2, en CGROUP_ROOT o en CGROUP_HYBRID_ROOT.
+ *
+ * @return Descriptor de la raíz, o -1 si no hay una jerarquía v2 montada.
+ */
+static int cgroup_open_root()
+{
+    const char* roots[] = {CGROUP_ROOT, CGROUP_HYBRID_ROOT};
+
+    for (size_t i = 0; i < sizeof(roots) / sizeof(roots[0]); i++)
+    {
+        int fd = open(roots[i], O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+        if (fd < INICIAL_VALUE)
+        {
+            continue;
+        }
+        // Solo la raíz v2 tiene cgroup.controllers; en v1 los directorios son jerarquías por controlador
+        if (faccessat(fd, "cgroup.controllers", F_OK, INICIAL_VALUE) == INICIAL_VALUE)
+        {
+            return fd;
+        }
+        close(fd);
+    }
+
+    // Sin cgroup v2 el colector queda sin muestras: se avisa una vez y no en cada ciclo
+    if (!root_warned)
+    {
+        fprintf(stderr, "No se encontró una jerarquía de cgroup v2 en %s\n", CGROUP_ROOT);
+        root_warned = ASSIGNED_VALUE;
+    }
+    return ERROR_INT;
+}
+
+/**
+ * @brief Recorre la jerarquía de cgroups y actualiza los cgroups de la instantánea.
+ *
+ * @param snap Instantánea a completar.
+ * @return 0 en caso de éxito, -1 en caso de error.
+ */
+int cgroup_scan(proc_snapshot_t* snap)
+{
+    char path[CGROUP_PATH_SIZE] = "";
+
+    if (by_path.capacity == INICIAL_VALUE && strmap_init(&by_path, INICIAL_VALUE) != INICIAL_VALUE)
+    {
+        return ERROR_INT;
+    }
+
+    int root_fd = cgroup_open_root();
+    if (root_fd < INICIAL_VALUE)
+    {
+        return ERROR_INT;
+    }
+
+    scan_cycle++;
+    cgroup_walk(root_fd, path, INICIAL_VALUE, ASSIGNED_VALUE, atomic_load(&max_depth), snap->timestamp_ns);
+    cgroup_remove_stale();
+
+    snap->cgroups = (const cgroup_usage_t* const*)groups;
+    snap->cgroup_count = group_count;
+    return INICIAL_VALUE;
+}
+
+/**
+ * @brief Libera la tabla de cgroups.
+ */
+void cgroup_close()
+{
+    for (int i = 0; i < group_count; i++)
+    {
+        free(groups[i]);
+    }
+    strmap_free(&by_path);
+    group_count = INICIAL_VALUE;
+    full_warned = INICIAL_VALUE;
+    root_warned = INICIAL_VALUE;
+}
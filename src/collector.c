@@ -0,0 +1,614 @@
+/**
+ * @file collector.c
+ * @brief Despachador y pool de hilos de las tareas de recolección.
+ *
+ * Todo el estado de planificación de las tareas se protege con pool_lock; las lecturas de /proc y la actualización
+ * de métricas se hacen fuera del lock, sobre la instantánea propia de cada tarea.
+ *
+ * Las ejecuciones de cada tarea siguen una grilla fija de instantes absolutos de CLOCK_MONOTONIC (inicio + k *
+ * intervalo): el próximo instante se calcula a partir del anterior y no del momento en que el despachador despertó,
+ * así que la demora de un ciclo no se acumula en los siguientes. Los instantes de la grilla que pasan mientras la
+ * tarea sigue en ejecución se cuentan como ticks perdidos en lugar de encolarse de golpe.
+ *
+ * Con reglas de muestreo adaptativo (adaptive.h), el paso de la grilla de una tarea es su intervalo multiplicado por
+ * 2^backoff: cada ejecución sin cambios duplica el paso hasta el máximo y un cambio lo devuelve al intervalo. La
+ * grilla se reancla en el instante de la última ejecución, de modo que cambiar el paso tampoco acumula demora.
+ */
+
+#include "collector.h"
+#include "adaptive.h"
+#include "expose_metrics.h"
+#include "history.h"
+#include "monitor_snapshot.h"
+#include "push.h"
+#include <time.h>
+
+/**
+ * @brief Tarea de recolección: una fuente de /proc y las métricas que se calculan a partir de ella.
+ */
+typedef struct
+{
+    const char* name;                ///< Nombre de la tarea, usado como etiqueta "collector".
+    unsigned int sources;            ///< Máscara SNAPSHOT_* de las fuentes que lee.
+    int interval_ms;                 ///< Intervalo propio, o 0 para usar el de por defecto.
+    int deadline_ms;                 ///< Plazo propio, o 0 para usar el intervalo.
+    unsigned long long tick_ns;      ///< Instante de la grilla de la última ejecución.
+    unsigned long long next_run_ns;  ///< Próximo instante de la grilla, o 0 si no empezó.
+    int rescheduled;                 ///< 1 si cambió el intervalo y hay que rearmar la grilla.
+    unsigned long long queued_ns;    ///< Instante en que se encoló la ejecución en curso.
+    int running;                     ///< 1 mientras está encolada o en ejecución.
+    int timed_out;                   ///< 1 si la ejecución en curso ya se contó como timeout.
+    unsigned long long runs;         ///< Ejecuciones completadas.
+    unsigned long long timeouts;     ///< Ejecuciones que superaron su plazo.
+    unsigned long long missed_ticks; ///< Instantes de la grilla que se saltearon por demora.
+    double last_duration;            ///< Duración de la última ejecución completa en segundos.
+    unsigned long long allocations;  ///< Reservas del heap hechas por sus ejecuciones.
+    int backoff;                     ///< Duplicaciones del intervalo por muestreo adaptativo.
+    adaptive_state_t adaptive;       ///< Series del último lote, para compararlas con las del siguiente.
+    metric_channel_t* channel;       ///< Canal del almacén en el que la tarea publica su lote.
+    proc_snapshot_t snap;            ///< Instantánea propia, solo con las fuentes de la tarea.
+} collector_task_t;
+
+/**
+ * @brief Tabla de tareas; cada fuente de /proc pertenece a una sola tarea para que nunca se lea en paralelo.
+ */
+static collector_task_t tasks[] = {
+    {.name = "cpu", .sources = SNAPSHOT_STAT},
+    {.name = "memory", .sources = SNAPSHOT_MEMINFO},
+    {.name = "vmstat", .sources = SNAPSHOT_VMSTAT},
+    {.name = "disk", .sources = SNAPSHOT_DISKSTATS},
+    {.name = "network", .sources = SNAPSHOT_NETDEV},
+    {.name = "pressure", .sources = SNAPSHOT_PSI | SNAPSHOT_SCHEDSTAT},
+    {.name = "processes", .sources = SNAPSHOT_PROCS},
+    {.name = "cgroups", .sources = SNAPSHOT_CGROUPS},
+    {.name = "latency", .sources = SNAPSHOT_BPF},
+    {.name = "filesystem", .sources = SNAPSHOT_FILESYSTEMS},
+};
+
+/**
+ * @brief Cantidad de tareas.
+ */
+#define TASK_COUNT ((int)(sizeof(tasks) / sizeof(tasks[0])))
+
+/**
+ * @brief Lock del estado de planificación, la cola y las banderas de parada.
+ */
+static pthread_mutex_t pool_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * @brief Señala a los hilos del pool que hay tareas en la cola.
+ */
+static pthread_cond_t work_cond;
+
+/**
+ * @brief Despierta al despachador cuando termina una tarea o cambia la planificación.
+ */
+static pthread_cond_t dispatch_cond;
+
+/**
+ * @brief Cola circular de tareas pendientes; como una tarea no se encola dos veces, TASK_COUNT lugares alcanzan.
+ */
+static collector_task_t* queue[TASK_COUNT];
+
+/**
+ * @brief Índice del primer elemento de la cola.
+ */
+static int queue_head = INICIAL_VALUE;
+
+/**
+ * @brief Cantidad de elementos en la cola.
+ */
+static int queue_len = INICIAL_VALUE;
+
+/**
+ * @brief Intervalo de las tareas sin intervalo propio.
+ */
+static int default_interval_ms = COLLECTOR_DEFAULT_INTERVAL_MS;
+
+/**
+ * @brief 1 cuando se pidió detener el pool.
+ */
+static int stopping = INICIAL_VALUE;
+
+/**
+ * @brief 1 mientras los hilos están en ejecución.
+ */
+static int started = INICIAL_VALUE;
+
+/**
+ * @brief Canal en el que el despachador publica las métricas propias de las tareas.
+ */
+static metric_channel_t* self_channel = NULL;
+
+/**
+ * @brief 1 si las estadísticas de alguna tarea cambiaron desde la última publicación de self_channel.
+ */
+static int stats_dirty = INICIAL_VALUE;
+
+/**
+ * @brief Hilo despachador.
+ */
+static pthread_t dispatcher;
+
+/**
+ * @brief Hilos del pool.
+ */
+static pthread_t workers[COLLECTOR_WORKERS];
+
+/**
+ * @brief Intervalo efectivo de una tarea en nanosegundos.
+ *
+ * @param task Tarea.
+ * @return Intervalo en nanosegundos.
+ */
+static unsigned long long task_interval_ns(const collector_task_t* task)
+{
+    int ms = task->interval_ms > INICIAL_VALUE ? task->interval_ms : default_interval_ms;
+    return (unsigned long long)ms * 1000000ULL;
+}
+
+/**
+ * @brief Paso de la grilla de una tarea en nanosegundos: su intervalo espaciado por el muestreo adaptativo.
+ *
+ * @param task Tarea.
+ * @return Paso en nanosegundos; nunca supera el máximo adaptativo salvo que el intervalo ya sea mayor.
+ */
+static unsigned long long task_period_ns(const collector_task_t* task)
+{
+    unsigned long long interval = task_interval_ns(task);
+    unsigned long long limit = (unsigned long long)adaptive_max_interval_ms() * 1000000ULL;
+    unsigned long long period = interval << task->backoff;
+    return period > limit ? (interval > limit ? interval : limit) : period;
+}
+
+/**
+ * @brief Plazo efectivo de una tarea en nanosegundos.
+ *
+ * @param task Tarea.
+ * @return Plazo en nanosegundos.
+ */
+static unsigned long long task_deadline_ns(const collector_task_t* task)
+{
+    return task->deadline_ms > INICIAL_VALUE ? (unsigned long long)task->deadline_ms * 1000000ULL
+                                              : task_interval_ns(task);
+}
+
+/**
+ * @brief Convierte un instante de CLOCK_MONOTONIC en nanosegundos a timespec.
+ *
+ * @param ns Instante en nanosegundos.
+ * @return Instante como timespec.
+ */
+static struct timespec ns_to_timespec(unsigned long long ns)
+{
+    struct timespec ts;
+    ts.tv_sec = (time_t)(ns / 1000000000ULL);
+    ts.tv_nsec = (long)(ns % 1000000000ULL);
+    return ts;
+}
+
+/**
+ * @brief Encola una tarea vencida y avanza su grilla, contando los instantes que ya pasaron sin ejecutarse.
+ *
+ * @param task Tarea vencida.
+ * @param now Instante actual.
+ */
+static void enqueue_task(collector_task_t* task, unsigned long long now)
+{
+    unsigned long long interval = task_period_ns(task);
+
+    if (task->next_run_ns == INICIAL_VALUE || task->rescheduled)
+    {
+        // Primera ejecución o intervalo nuevo: la grilla arranca en este instante
+        task->tick_ns = now;
+        task->rescheduled = INICIAL_VALUE;
+    }
+    else
+    {
+        unsigned long long missed = (now - task->next_run_ns) / interval;
+        task->tick_ns = task->next_run_ns + missed * interval;
+        if (missed > INICIAL_VALUE)
+        {
+            task->missed_ticks += missed;
+            stats_dirty = ASSIGNED_VALUE;
+        }
+    }
+    task->next_run_ns = task->tick_ns + interval;
+
+    task->running = ASSIGNED_VALUE;
+    task->timed_out = INICIAL_VALUE;
+    task->queued_ns = now;
+    queue[(queue_head + queue_len) % TASK_COUNT] = task;
+    queue_len++;
+    pthread_cond_signal(&work_cond);
+}
+
+/**
+ * @brief Espacia o restablece el paso de una tarea según su último lote; se llama con pool_lock tomado.
+ *
+ * @param task Tarea que acaba de terminar.
+ * @param verdict Resultado de comparar su lote con el anterior.
+ */
+static void adapt_task_period(collector_task_t* task, adaptive_result_t verdict)
+{
+    int backoff = task->backoff;
+    if (verdict == ADAPTIVE_QUIET)
+    {
+        unsigned long long limit = (unsigned long long)adaptive_max_interval_ms() * 1000000ULL;
+        backoff += task_period_ns(task) < limit ? ASSIGNED_VALUE : INICIAL_VALUE;
+    }
+    else
+    {
+        backoff = INICIAL_VALUE;
+    }
+
+    // El próximo instante se recalcula desde el de esta ejecución, así un cambio brusco se vuelve a leer enseguida
+    if (backoff != task->backoff)
+    {
+        task->backoff = backoff;
+        if (!task->rescheduled)
+        {
+            task->next_run_ns = task->tick_ns + task_period_ns(task);
+        }
+    }
+}
+
+/**
+ * @brief Bucle de un hilo del pool: toma tareas de la cola, las ejecuta y registra su duración.
+ *
+ * @param arg Argumento no utilizado.
+ * @return NULL al detenerse el pool.
+ */
+static void* worker_main(void* arg)
+{
+    (void)arg;
+
+    pthread_mutex_lock(&pool_lock);
+    while (!stopping)
+    {
+        if (queue_len == INICIAL_VALUE)
+        {
+            pthread_cond_wait(&work_cond, &pool_lock);
+            continue;
+        }
+        collector_task_t* task = queue[queue_head];
+        queue_head = (queue_head + 1) % TASK_COUNT;
+        queue_len--;
+        pthread_mutex_unlock(&pool_lock);
+
+        // La lectura de /proc y el armado del lote se hacen sin el lock del pool; el lote se publica entero.
+        // Si ninguna métrica habilitada usa la fuente de la tarea no se lee /proc y se publica un lote vacío.
+        // La duración se mide con CLOCK_MONOTONIC_RAW; el plazo sigue la grilla de CLOCK_MONOTONIC.
+        unsigned long long start = monitor_clock_ns();
+        unsigned long long allocated = monitor_thread_allocations();
+        unsigned long long enabled = metric_registry_enabled();
+        unsigned int sources = task->sources & metric_registry_sources(enabled);
+        if (sources != INICIAL_VALUE)
+        {
+            update_snapshot_sources(&task->snap, sources);
+        }
+        metric_batch_t* batch = metric_batch_begin(task->channel);
+        adaptive_result_t verdict = ADAPTIVE_NONE;
+        if (batch != NULL)
+        {
+            metric_registry_collect(batch, &task->snap, sources, enabled);
+            // tick_ns no cambia mientras la tarea está en ejecución: las tasas se miden entre instantes de la grilla
+            verdict = adaptive_evaluate(&task->adaptive, batch, task->tick_ns);
+            metric_batch_publish(task->channel);
+            history_record_batch(batch);
+            push_enqueue_batch(batch);
+            monitor_snapshot_update();
+        }
+        double duration = (double)(monitor_clock_ns() - start) / 1e9;
+        allocated = monitor_thread_allocations() - allocated;
+        unsigned long long end = monotonic_ns();
+        observe_collector_duration(task->name, duration);
+
+        pthread_mutex_lock(&pool_lock);
+        if (!task->timed_out && end - task->queued_ns > task_deadline_ns(task))
+        {
+            task->timeouts++;
+        }
+        task->runs++;
+        task->last_duration = duration;
+        task->allocations += allocated;
+        task->running = INICIAL_VALUE;
+        adapt_task_period(task, verdict);
+        stats_dirty = ASSIGNED_VALUE;
+        pthread_cond_signal(&dispatch_cond);
+    }
+    pthread_mutex_unlock(&pool_lock);
+
+    return NULL;
+}
+
+/**
+ * @brief Agrega al lote el paso vigente de cada métrica habilitada: el de la tarea que lee su fuente.
+ *
+ * @param batch Lote del despachador; se llama con pool_lock tomado.
+ */
+static void add_sampling_intervals(metric_batch_t* batch)
+{
+    unsigned long long enabled = metric_registry_enabled();
+    for (int m = 0; m < metric_registry_count(); m++)
+    {
+        const metric_desc_t* desc = metric_registry_at(m);
+        if (!(enabled & (1ULL << m)))
+        {
+            continue;
+        }
+        for (int i = 0; i < TASK_COUNT; i++)
+        {
+            if (tasks[i].sources & desc->source)
+            {
+                update_sampling_interval_metric(batch, desc->name, (double)task_period_ns(&tasks[i]) / 1e9);
+                break;
+            }
+        }
+    }
+}
+
+/**
+ * @brief Bucle del despachador: encola las tareas vencidas y cuenta los timeouts de las que siguen en ejecución.
+ *
+ * @param arg Argumento no utilizado.
+ * @return NULL al detenerse el pool.
+ */
+static void* dispatcher_main(void* arg)
+{
+    (void)arg;
+
+    pthread_mutex_lock(&pool_lock);
+    while (!stopping)
+    {
+        unsigned long long now = monotonic_ns();
+        unsigned long long wake = now + 1000000000ULL;
+
+        for (int i = 0; i < TASK_COUNT; i++)
+        {
+            collector_task_t* task = &tasks[i];
+
+            if (task->running)
+            {
+                // Una tarea colgada se cuenta una sola vez y no se vuelve a encolar hasta que termine
+                unsigned long long deadline = task->queued_ns + task_deadline_ns(task);
+                if (!task->timed_out && now >= deadline)
+                {
+                    task->timed_out = ASSIGNED_VALUE;
+                    task->timeouts++;
+                    stats_dirty = ASSIGNED_VALUE;
+                }
+                else if (!task->timed_out && deadline < wake)
+                {
+                    wake = deadline;
+                }
+                continue;
+            }
+
+            if (now >= task->next_run_ns)
+            {
+                enqueue_task(task, now);
+            }
+            if (task->next_run_ns < wake)
+            {
+                wake = task->next_run_ns;
+            }
+        }
+
+        // Métricas propias de las tareas, publicadas como un lote más
+        if (stats_dirty)
+        {
+            metric_batch_t* batch = metric_batch_begin(self_channel);
+            for (int i = 0; i < TASK_COUNT && batch != NULL; i++)
+            {
+                update_collector_metrics(batch, tasks[i].name, tasks[i].last_duration, tasks[i].runs,
+                                         tasks[i].timeouts, tasks[i].missed_ticks, tasks[i].allocations);
+            }
+            if (batch != NULL)
+            {
+                add_sampling_intervals(batch);
+                update_monitor_metrics(batch);
+            }
+            metric_batch_publish(self_channel);
+            stats_dirty = batch == NULL;
+
+            // El historial y la cola de envío toman sus propios locks: se alimentan sin pool_lock para que una
+            // consulta larga de /history no congele la planificación. Lo que cambió mientras tanto (una tarea que
+            // terminó o pool_shutdown()) se vuelve a mirar en lugar de esperar
+            if (batch != NULL)
+            {
+                pthread_mutex_unlock(&pool_lock);
+                history_record_batch(batch);
+                push_enqueue_batch(batch);
+                pthread_mutex_lock(&pool_lock);
+                continue;
+            }
+        }
+
+        // Espera hasta un instante absoluto, de modo que despertar tarde no corre el siguiente
+        struct timespec ts = ns_to_timespec(wake);
+        pthread_cond_timedwait(&dispatch_cond, &pool_lock, &ts);
+    }
+    pthread_mutex_unlock(&pool_lock);
+
+    return NULL;
+}
+
+/**
+ * @brief Pide a los hilos del pool que terminen, espera a los creados y destruye las variables de condición.
+ *
+ * @param worker_count Hilos de trabajo creados.
+ * @param with_dispatcher 1 si se creó el despachador.
+ */
+static void pool_shutdown(int worker_count, int with_dispatcher)
+{
+    pthread_mutex_lock(&pool_lock);
+    stopping = ASSIGNED_VALUE;
+    pthread_cond_broadcast(&work_cond);
+    pthread_cond_signal(&dispatch_cond);
+    pthread_mutex_unlock(&pool_lock);
+
+    if (with_dispatcher)
+    {
+        pthread_join(dispatcher, NULL);
+    }
+    for (int i = 0; i < worker_count; i++)
+    {
+        pthread_join(workers[i], NULL);
+    }
+    pthread_cond_destroy(&work_cond);
+    pthread_cond_destroy(&dispatch_cond);
+}
+
+/**
+ * @brief Inicia el hilo despachador y los hilos del pool.
+ *
+ * @return 0 en caso de éxito, -1 en caso de error.
+ */
+int collectors_start()
+{
+    pthread_condattr_t attr;
+
+    if (started)
+    {
+        return INICIAL_VALUE;
+    }
+
+    // Las esperas con plazo usan CLOCK_MONOTONIC, igual que los instantes de las tareas
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    if (pthread_cond_init(&work_cond, NULL) != INICIAL_VALUE ||
+        pthread_cond_init(&dispatch_cond, &attr) != INICIAL_VALUE)
+    {
+        fprintf(stderr, "Error al inicializar las variables de condición del pool\n");
+        pthread_condattr_destroy(&attr);
+        return ERROR_INT;
+    }
+    pthread_condattr_destroy(&attr);
+
+    // Un canal del almacén por tarea, más el de las métricas propias; nunca se destruyen
+    for (int i = 0; i < TASK_COUNT; i++)
+    {
+        if (tasks[i].channel == NULL && (tasks[i].channel = metric_channel_new(tasks[i].name)) == NULL)
+        {
+            pool_shutdown(INICIAL_VALUE, INICIAL_VALUE);
+            return ERROR_INT;
+        }
+    }
+    if (self_channel == NULL && (self_channel = metric_channel_new("collector")) == NULL)
+    {
+        pool_shutdown(INICIAL_VALUE, INICIAL_VALUE);
+        return ERROR_INT;
+    }
+
+    // Si falla un pthread_create() se detienen los hilos ya creados, que si no quedarían esperando trabajo
+    stopping = INICIAL_VALUE;
+    for (int i = 0; i < COLLECTOR_WORKERS; i++)
+    {
+        if (pthread_create(&workers[i], NULL, worker_main, NULL) != INICIAL_VALUE)
+        {
+            fprintf(stderr, "Error al crear los hilos de recolección\n");
+            pool_shutdown(i, INICIAL_VALUE);
+            return ERROR_INT;
+        }
+    }
+    if (pthread_create(&dispatcher, NULL, dispatcher_main, NULL) != INICIAL_VALUE)
+    {
+        fprintf(stderr, "Error al crear el hilo despachador\n");
+        pool_shutdown(COLLECTOR_WORKERS, INICIAL_VALUE);
+        return ERROR_INT;
+    }
+
+    started = ASSIGNED_VALUE;
+    return INICIAL_VALUE;
+}
+
+/**
+ * @brief Detiene el despachador y espera a que los hilos del pool terminen su tarea en curso.
+ */
+void collectors_stop()
+{
+    if (!started)
+    {
+        return;
+    }
+
+    pool_shutdown(COLLECTOR_WORKERS, ASSIGNED_VALUE);
+    started = INICIAL_VALUE;
+}
+
+/**
+ * @brief Cambia el intervalo de las tareas que no tienen uno propio configurado.
+ *
+ * @param interval_ms Intervalo en milisegundos.
+ */
+void set_collector_default_interval(int interval_ms)
+{
+    if (interval_ms <= INICIAL_VALUE)
+    {
+        return;
+    }
+
+    pthread_mutex_lock(&pool_lock);
+    if (interval_ms != default_interval_ms)
+    {
+        default_interval_ms = interval_ms;
+        for (int i = 0; i < TASK_COUNT; i++)
+        {
+            if (tasks[i].interval_ms == INICIAL_VALUE && tasks[i].next_run_ns != INICIAL_VALUE)
+            {
+                tasks[i].backoff = INICIAL_VALUE;
+                tasks[i].next_run_ns = tasks[i].tick_ns + task_interval_ns(&tasks[i]);
+                tasks[i].rescheduled = ASSIGNED_VALUE;
+            }
+        }
+        if (started)
+        {
+            pthread_cond_signal(&dispatch_cond);
+        }
+    }
+    pthread_mutex_unlock(&pool_lock);
+}
+
+/**
+ * @brief Configura el intervalo y el plazo de una tarea.
+ *
+ * @param name Nombre de la tarea.
+ * @param interval_ms Intervalo en milisegundos, o 0 para el de por defecto.
+ * @param deadline_ms Plazo en milisegundos, o 0 para usar el intervalo.
+ * @return 0 en caso de éxito, -1 si no existe la tarea.
+ */
+int set_collector_schedule(const char* name, int interval_ms, int deadline_ms)
+{
+    for (int i = 0; i < TASK_COUNT; i++)
+    {
+        collector_task_t* task = &tasks[i];
+        if (strcmp(task->name, name) != INICIAL_VALUE)
+        {
+            continue;
+        }
+
+        pthread_mutex_lock(&pool_lock);
+        if (task->interval_ms != interval_ms || task->deadline_ms != deadline_ms)
+        {
+            task->interval_ms = interval_ms > INICIAL_VALUE ? interval_ms : INICIAL_VALUE;
+            task->deadline_ms = deadline_ms > INICIAL_VALUE ? deadline_ms : INICIAL_VALUE;
+            // Reprogramar desde la última ejecución para que un intervalo más corto se aplique de inmediato
+            task->backoff = INICIAL_VALUE;
+            if (task->next_run_ns != INICIAL_VALUE)
+            {
+                task->next_run_ns = task->tick_ns + task_interval_ns(task);
+                task->rescheduled = ASSIGNED_VALUE;
+            }
+            if (started)
+            {
+                pthread_cond_signal(&dispatch_cond);
+            }
+        }
+        pthread_mutex_unlock(&pool_lock);
+        return INICIAL_VALUE;
+    }
+
+    fprintf(stderr, "Tarea de recolección desconocida: %s\n", name);
+    return ERROR_INT;
+}
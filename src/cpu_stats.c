@@ -0,0 +1,201 @@
+/**
+ * @file cpu_stats.c
+ * @brief Contadores de CPU por núcleo en estructura de arreglos y cálculo vectorizable de porcentajes.
+ */
+
+#include "cpu_stats.h"
+#include "metrics.h"
+
+/**
+ * @brief Nombres de los modos usados como etiqueta "mode".
+ */
+const char* const cpu_mode_labels[CPU_PERCENT_COUNT] = {"user", "nice",    "system", "idle", "iowait",
+                                                        "irq",  "softirq", "steal",  "busy"};
+
+/**
+ * @brief Tabla de contadores única del proceso.
+ */
+static cpu_stats_t stats;
+
+/**
+ * @brief Reserva los arreglos según la cantidad de CPUs configuradas y prepara las etiquetas.
+ *
+ * @param cpus CPUs de la instantánea, o 0 para las configuradas en el sistema.
+ * @return 0 en caso de éxito, -1 en caso de error.
+ */
+int cpu_stats_init(long cpus)
+{
+    if (stats.columns > INICIAL_VALUE)
+    {
+        return INICIAL_VALUE;
+    }
+
+    if (cpus <= INICIAL_VALUE)
+    {
+        cpus = sysconf(_SC_NPROCESSORS_CONF);
+    }
+    if (cpus < ASSIGNED_VALUE)
+    {
+        cpus = ASSIGNED_VALUE;
+    }
+
+    int columns = (int)cpus + 1;
+    stats.cur = calloc((size_t)CPU_MODE_COUNT * columns, sizeof(*stats.cur));
+    stats.prev = calloc((size_t)CPU_MODE_COUNT * columns, sizeof(*stats.prev));
+    stats.scale = calloc((size_t)columns, sizeof(*stats.scale));
+    stats.percent = calloc((size_t)CPU_PERCENT_COUNT * columns, sizeof(*stats.percent));
+    stats.present = calloc((size_t)columns, sizeof(*stats.present));
+    stats.labels = calloc((size_t)columns, sizeof(*stats.labels));
+    if (stats.cur == NULL || stats.prev == NULL || stats.scale == NULL || stats.percent == NULL ||
+        stats.present == NULL || stats.labels == NULL)
+    {
+        perror("Error al asignar memoria");
+        cpu_stats_close();
+        return ERROR_INT;
+    }
+
+    // Las etiquetas se generan una sola vez para no reservar memoria en cada ciclo
+    snprintf(stats.labels[0], CPU_LABEL_SIZE, "all");
+    for (int c = 1; c < columns; c++)
+    {
+        snprintf(stats.labels[c], CPU_LABEL_SIZE, "%d", c - 1);
+    }
+
+    stats.columns = columns;
+    stats.has_prev = INICIAL_VALUE;
+    return INICIAL_VALUE;
+}
+
+/**
+ * @brief Libera la memoria reservada por cpu_stats_init().
+ */
+void cpu_stats_close()
+{
+    free(stats.cur);
+    free(stats.prev);
+    free(stats.scale);
+    free(stats.percent);
+    free(stats.present);
+    free(stats.labels);
+    memset(&stats, INICIAL_VALUE, sizeof(stats));
+}
+
+/**
+ * @brief Marca el comienzo de una lectura de /proc/stat.
+ */
+void cpu_stats_begin()
+{
+    if (stats.present != NULL)
+    {
+        memset(stats.present, INICIAL_VALUE, (size_t)stats.columns);
+    }
+}
+
+/**
+ * @brief Guarda los contadores de una línea "cpu" en la columna indicada.
+ *
+ * @param column Columna de destino.
+ * @param line Cursor ubicado después del nombre de la línea.
+ * @return 0 en caso de éxito, -1 en caso de error.
+ */
+int cpu_stats_store(int column, scan_t* line)
+{
+    if (column < INICIAL_VALUE || column >= stats.columns)
+    {
+        return ERROR_INT;
+    }
+
+    for (int m = 0; m < CPU_MODE_COUNT; m++)
+    {
+        if (!scan_u64(line, &stats.cur[(size_t)m * stats.columns + column]))
+        {
+            return ERROR_INT;
+        }
+    }
+
+    stats.present[column] = ASSIGNED_VALUE;
+    return INICIAL_VALUE;
+}
+
+/**
+ * @brief Calcula deltas y porcentajes de todas las columnas y rota los contadores.
+ *
+ * Cada paso es un bucle plano sobre arreglos contiguos y sin ramas, apto para vectorización.
+ */
+void cpu_stats_compute()
+{
+    const int cols = stats.columns;
+    const size_t cells = (size_t)CPU_MODE_COUNT * cols;
+    unsigned long long* restrict cur = stats.cur;
+    unsigned long long* restrict prev = stats.prev;
+    double* restrict percent = stats.percent;
+    double* restrict scale = stats.scale;
+
+    if (cols == INICIAL_VALUE)
+    {
+        return;
+    }
+
+    // Deltas de cada modo y columna; en la primera lectura no hay intervalo y quedan en cero
+    if (stats.has_prev)
+    {
+        for (size_t i = 0; i < cells; i++)
+        {
+            percent[i] = (double)(cur[i] - prev[i]);
+        }
+    }
+    else
+    {
+        memset(percent, INICIAL_VALUE, cells * sizeof(*percent));
+    }
+
+    // Total por columna sumando las filas de modos
+    memset(scale, INICIAL_VALUE, (size_t)cols * sizeof(*scale));
+    for (int m = 0; m < CPU_MODE_COUNT; m++)
+    {
+        const double* row = percent + (size_t)m * cols;
+        for (int c = 0; c < cols; c++)
+        {
+            scale[c] += row[c];
+        }
+    }
+
+    // Escala inversa por columna; las columnas ausentes (CPU offline) o sin tiempo transcurrido quedan en cero
+    for (int c = 0; c < cols; c++)
+    {
+        scale[c] = scale[c] > 0 && stats.present[c] ? POCENTAGE / scale[c] : 0;
+    }
+
+    for (int m = 0; m < CPU_MODE_COUNT; m++)
+    {
+        double* row = percent + (size_t)m * cols;
+        for (int c = 0; c < cols; c++)
+        {
+            row[c] *= scale[c];
+        }
+    }
+
+    // Ocupado = todos los modos salvo idle e iowait
+    double* busy = percent + (size_t)CPU_MODE_BUSY * cols;
+    for (int c = 0; c < cols; c++)
+    {
+        busy[c] = percent[CPU_MODE_USER * cols + c] + percent[CPU_MODE_NICE * cols + c] +
+                  percent[CPU_MODE_SYSTEM * cols + c] + percent[CPU_MODE_IRQ * cols + c] +
+                  percent[CPU_MODE_SOFTIRQ * cols + c] + percent[CPU_MODE_STEAL * cols + c];
+    }
+
+    // Rotar los buffers en lugar de copiar: la próxima lectura sobrescribe cur
+    stats.cur = prev;
+    stats.prev = cur;
+    stats.has_prev = ASSIGNED_VALUE;
+}
+
+/**
+ * @brief Devuelve la tabla de contadores y porcentajes.
+ *
+ * @return Tabla de CPU, o NULL si cpu_stats_init() no se llamó.
+ */
+const cpu_stats_t* get_cpu_stats()
+{
+    return stats.columns > INICIAL_VALUE ? &stats : NULL;
+}
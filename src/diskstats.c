@@ -0,0 +1,291 @@
+/**
+ * @file diskstats.c
+ * @brief Parser en proceso de /proc/diskstats con lista de dispositivos permitidos.
+ *
+ * Mantiene una tabla persistente de dispositivos con la decisión de selección ya resuelta y los contadores del
+ * ciclo anterior, de modo que cada ciclo solo parsea las líneas y calcula las tasas por dispositivo.
+ */
+
+#include "diskstats.h"
+#include "metrics.h"
+#include "scan.h"
+#include <fnmatch.h>
+#include <pthread.h>
+
+/**
+ * @brief Estado persistente de un dispositivo entre ciclos.
+ */
+typedef struct
+{
+    char name[DISK_NAME_SIZE];             ///< Nombre del dispositivo.
+    int selected;                          ///< 1 si el dispositivo pasa la lista de permitidos.
+    unsigned int allowlist_generation;     ///< Generación de la lista con la que se resolvió selected.
+    unsigned int last_seen;                ///< Último ciclo en el que apareció el dispositivo.
+    int has_prev;                          ///< 1 si prev_* contiene una lectura anterior.
+    unsigned long long prev_read_sectors;  ///< Sectores leídos en el ciclo anterior.
+    unsigned long long prev_write_sectors; ///< Sectores escritos en el ciclo anterior.
+    unsigned long long prev_timestamp_ns;  ///< Instante de la lectura anterior.
+} disk_state_t;
+
+/**
+ * @brief Tabla persistente de dispositivos vistos en /proc/diskstats.
+ */
+static disk_state_t states[MAX_DISK_DEVICES];
+
+/**
+ * @brief Cantidad de entradas ocupadas en states.
+ */
+static int state_count = INICIAL_VALUE;
+
+/**
+ * @brief Número de ciclo de parseo, usado para detectar dispositivos que desaparecieron.
+ */
+static unsigned int parse_cycle = INICIAL_VALUE;
+
+/**
+ * @brief Patrones de la lista de dispositivos permitidos.
+ */
+static char allowlist[MAX_DISK_ALLOWLIST][DISK_NAME_SIZE];
+
+/**
+ * @brief Cantidad de patrones en allowlist.
+ */
+static int allowlist_count = INICIAL_VALUE;
+
+/**
+ * @brief Generación de la lista de permitidos; cambia en cada set_disk_allowlist().
+ */
+static unsigned int allowlist_generation = ASSIGNED_VALUE;
+
+/**
+ * @brief Protege la lista de permitidos, que se reemplaza desde el hilo de configuración mientras se parsea.
+ */
+static pthread_mutex_t allowlist_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * @brief Reemplaza la lista de dispositivos permitidos.
+ *
+ * @param patterns Patrones de nombres de dispositivo.
+ * @param count Cantidad de patrones.
+ */
+void set_disk_allowlist(const char** patterns, int count)
+{
+    if (count > MAX_DISK_ALLOWLIST)
+    {
+        count = MAX_DISK_ALLOWLIST;
+    }
+
+    pthread_mutex_lock(&allowlist_lock);
+
+    // Evitar invalidar la tabla si la lista no cambió
+    int changed = count != allowlist_count;
+    for (int i = 0; i < count && !changed; i++)
+    {
+        changed = strncmp(allowlist[i], patterns[i], DISK_NAME_SIZE) != 0;
+    }
+    if (changed)
+    {
+        for (int i = 0; i < count; i++)
+        {
+            snprintf(allowlist[i], DISK_NAME_SIZE, "%s", patterns[i]);
+        }
+        allowlist_count = count;
+        allowlist_generation++;
+    }
+
+    pthread_mutex_unlock(&allowlist_lock);
+}
+
+/**
+ * @brief Decide si un dispositivo debe seguirse.
+ *
+ * Con lista de permitidos se usan sus patrones. Sin lista se seleccionan los discos completos (los que figuran en
+ * block/ de snapshot_sys_root(), lo que excluye las particiones) salvo loop*, ram* y zram*.
+ *
+ * @param name Nombre del dispositivo.
+ * @return 1 si se selecciona, 0 si no.
+ */
+static int disk_is_selected(const char* name)
+{
+    if (allowlist_count > INICIAL_VALUE)
+    {
+        for (int i = 0; i < allowlist_count; i++)
+        {
+            if (fnmatch(allowlist[i], name, INICIAL_VALUE) == INICIAL_VALUE)
+            {
+                return ASSIGNED_VALUE;
+            }
+        }
+        return INICIAL_VALUE;
+    }
+
+    if (strncmp(name, "loop", 4) == 0 || strncmp(name, "ram", 3) == 0 || strncmp(name, "zram", 4) == 0)
+    {
+        return INICIAL_VALUE;
+    }
+
+    // Sin /sys (por ejemplo en algunos contenedores) no se pueden distinguir particiones: se acepta todo
+    char path[PROC_PATH_SIZE + DISK_NAME_SIZE];
+    int root_len = snprintf(path, sizeof(path), "%s/block/", snapshot_sys_root());
+    if (access(path, F_OK) != INICIAL_VALUE)
+    {
+        return ASSIGNED_VALUE;
+    }
+
+    // En /sys/block los '/' del nombre del kernel (cciss/c0d0) aparecen como '!'
+    snprintf(path + root_len, sizeof(path) - (size_t)root_len, "%s", name);
+    for (char* c = path + root_len; *c != '\0'; c++)
+    {
+        if (*c == '/')
+        {
+            *c = '!';
+        }
+    }
+
+    return access(path, F_OK) == INICIAL_VALUE;
+}
+
+/**
+ * @brief Busca el estado persistente de un dispositivo, creándolo si es nuevo.
+ *
+ * Si la tabla está llena se reutiliza la entrada de un dispositivo que no apareció en el ciclo actual.
+ *
+ * @param name Nombre del dispositivo.
+ * @return Estado del dispositivo, o NULL si no hay lugar en la tabla.
+ */
+static disk_state_t* disk_state_lookup(const char* name)
+{
+    disk_state_t* stale = NULL;
+
+    for (int i = 0; i < state_count; i++)
+    {
+        if (strcmp(states[i].name, name) == 0)
+        {
+            return &states[i];
+        }
+        if (stale == NULL && states[i].last_seen != parse_cycle)
+        {
+            stale = &states[i];
+        }
+    }
+
+    if (state_count < MAX_DISK_DEVICES)
+    {
+        stale = &states[state_count++];
+    }
+    if (stale == NULL)
+    {
+        return NULL;
+    }
+
+    memset(stale, INICIAL_VALUE, sizeof(*stale));
+    snprintf(stale->name, DISK_NAME_SIZE, "%s", name);
+    return stale;
+}
+
+/**
+ * @brief Calcula la diferencia entre dos lecturas de un contador, tomando un reinicio como cero.
+ *
+ * @param cur Valor actual.
+ * @param prev Valor anterior.
+ * @return Diferencia cur - prev, o 0 si el contador retrocedió.
+ */
+static unsigned long long counter_delta(unsigned long long cur, unsigned long long prev)
+{
+    return cur >= prev ? cur - prev : INICIAL_VALUE;
+}
+
+/**
+ * @brief Parsea /proc/diskstats y completa los dispositivos seleccionados de la instantánea.
+ *
+ * @param snap Instantánea a completar.
+ * @param buf Contenido de /proc/diskstats.
+ * @param len Bytes válidos de buf.
+ * @return 0 en caso de éxito, -1 en caso de error.
+ */
+int parse_diskstats(proc_snapshot_t* snap, const char* buf, size_t len)
+{
+    scan_t s, line;
+
+    parse_cycle++;
+    scan_init(&s, buf, len);
+
+    pthread_mutex_lock(&allowlist_lock);
+    unsigned int generation = allowlist_generation;
+    pthread_mutex_unlock(&allowlist_lock);
+
+    while (scan_next_line(&s, &line))
+    {
+        char name[DISK_NAME_SIZE];
+        const char* tok;
+        size_t tok_len;
+        unsigned long long reads, read_sectors, writes, write_sectors;
+
+        // Campos: major minor nombre lecturas fusionadas sectores_leídos ms escrituras fusionadas sectores_escritos
+        if (!scan_skip_fields(&line, 2) || !scan_token(&line, &tok, &tok_len) || !scan_u64(&line, &reads) ||
+            !scan_skip_fields(&line, 1) || !scan_u64(&line, &read_sectors) || !scan_skip_fields(&line, 1) ||
+            !scan_u64(&line, &writes) || !scan_skip_fields(&line, 1) || !scan_u64(&line, &write_sectors))
+        {
+            continue;
+        }
+        scan_copy(name, sizeof(name), tok, tok_len);
+
+        disk_state_t* state = disk_state_lookup(name);
+        if (state == NULL)
+        {
+            continue;
+        }
+        state->last_seen = parse_cycle;
+
+        // La selección se resuelve solo para dispositivos nuevos o cuando cambió la lista
+        if (state->allowlist_generation != generation)
+        {
+            pthread_mutex_lock(&allowlist_lock);
+            state->selected = disk_is_selected(name);
+            state->allowlist_generation = allowlist_generation;
+            pthread_mutex_unlock(&allowlist_lock);
+        }
+        if (!state->selected || snap->disk_count >= MAX_DISK_DEVICES)
+        {
+            continue;
+        }
+
+        disk_device_t* dev = &snap->disks[snap->disk_count++];
+        memcpy(dev->name, state->name, DISK_NAME_SIZE);
+        dev->reads = reads;
+        dev->writes = writes;
+        dev->read_sectors = read_sectors;
+        dev->write_sectors = write_sectors;
+        dev->read_bytes_per_second = INICIAL_VALUE;
+        dev->write_bytes_per_second = INICIAL_VALUE;
+
+        // Tasas desde la lectura anterior, usando el tiempo realmente transcurrido
+        if (state->has_prev && snap->timestamp_ns > state->prev_timestamp_ns)
+        {
+            double elapsed = (double)(snap->timestamp_ns - state->prev_timestamp_ns) / 1e9;
+            dev->read_bytes_per_second =
+                (double)(counter_delta(read_sectors, state->prev_read_sectors) * SECTOR_SIZE) / elapsed;
+            dev->write_bytes_per_second =
+                (double)(counter_delta(write_sectors, state->prev_write_sectors) * SECTOR_SIZE) / elapsed;
+        }
+        state->prev_read_sectors = read_sectors;
+        state->prev_write_sectors = write_sectors;
+        state->prev_timestamp_ns = snap->timestamp_ns;
+        state->has_prev = ASSIGNED_VALUE;
+
+        snap->disk_reads += reads;
+        snap->disk_writes += writes;
+        snap->disk_read_sectors += read_sectors;
+        snap->disk_write_sectors += write_sectors;
+    }
+
+    return INICIAL_VALUE;
+}
+
+/**
+ * @brief Vacía la tabla de dispositivos.
+ */
+void diskstats_close()
+{
+    state_count = INICIAL_VALUE;
+}
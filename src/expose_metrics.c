@@ -9,489 +9,807 @@
  */
 
 #include "expose_metrics.h"
+#include "aggregator.h"
+#include "alert.h"
+#include <netdb.h>
+#include <sys/socket.h>
 
 /**
- * @brief Mutex para sincronización de hilos.
+ * @brief Serializa los scrapes: el volcado del almacén y el formateo de libprom no son reentrantes.
+ *
+ * Los recolectores no lo toman nunca; publican sus lotes en el almacén de metric_store.h.
+ */
+static pthread_mutex_t scrape_lock;
+
+/**
+ * @brief 1 una vez creadas las métricas de Prometheus, que viven todo el proceso: monitor_stop() no las destruye.
+ */
+static int metrics_created = INICIAL_VALUE;
+
+/**
+ * @brief Arena de las respuestas de /history; con el pool de hilos la protege history_arena_lock.
+ *
+ * MHD copia el cuerpo al crear la respuesta, así que la arena se reinicia en la consulta siguiente y, pasado el primer
+ * pedido de cada tamaño, la consulta no le pide memoria al heap.
+ */
+static arena_t history_arena;
+
+/**
+ * @brief Serializa el uso de history_arena.
  */
-pthread_mutex_t lock;
+static pthread_mutex_t history_arena_lock = PTHREAD_MUTEX_INITIALIZER;
 
 /**
- * @brief Métrica de Prometheus para el uso de CPU.
+ * @brief Duración de la última ejecución de cada tarea de recolección, etiquetada con "collector".
  */
-static prom_gauge_t* cpu_usage_metric;
+static prom_gauge_t* collector_duration_metric;
 
 /**
- * @brief Métrica de Prometheus para el uso de memoria.
+ * @brief Ejecuciones completadas de cada tarea de recolección, etiquetadas con "collector".
  */
-static prom_gauge_t* memory_usage_metric;
+static prom_counter_t* collector_runs_metric;
 
 /**
- * @brief Métrica de Prometheus para el uso de disco.
+ * @brief Ejecuciones que superaron su plazo, etiquetadas con "collector".
  */
-static prom_gauge_t* disk_usage_metric;
+static prom_counter_t* collector_timeouts_metric;
 
 /**
- * @brief Métrica de Prometheus para el uso de red.
+ * @brief Instantes de la grilla salteados por demora, etiquetados con "collector".
  */
-static prom_gauge_t* network_usage_metric;
+static prom_counter_t* collector_missed_ticks_metric;
 
 /**
- * @brief Métrica de Prometheus que representa el uso de ancho de banda en la red.
+ * @brief Intervalo de muestreo vigente de cada métrica, etiquetado con "metric".
  */
-static prom_gauge_t* bandwidth_usage_metric;
+static prom_gauge_t* metric_sampling_interval_metric;
 
 /**
- * @brief Métrica de Prometheus para los fallos de página mayores.
+ * @brief Distribución de la duración de las ejecuciones de cada tarea, etiquetada con "collector".
  */
-static prom_gauge_t* major_page_faults_metric;
+static prom_histogram_t* monitor_collector_duration_metric;
 
 /**
- * @brief Métrica de Prometheus para los fallos de página menores.
+ * @brief Distribución de la duración del render de la exposición.
  */
-static prom_gauge_t* minor_page_faults_metric;
+static prom_histogram_t* monitor_render_duration_metric;
 
 /**
- * @brief Métrica de Prometheus para los cambios de contexto.
+ * @brief Distribución de la duración del manejador HTTP.
  */
-static prom_gauge_t* change_context_metric;
+static prom_histogram_t* monitor_request_duration_metric;
 
 /**
- * @brief Métrica de Prometheus para el total de procesos.
+ * @brief Bytes leídos de /proc y de cgroupfs.
  */
-static prom_gauge_t* total_processes_metric;
+static prom_counter_t* monitor_read_bytes_metric;
 
 /**
- * @brief Métrica de Prometheus para estadísticas del disco.
+ * @brief Syscalls de lectura de /proc y de cgroupfs, etiquetadas con "syscall".
  */
-static prom_gauge_t* disk_stats_metric;
+static prom_counter_t* monitor_syscalls_metric;
 
 /**
- * @brief Métrica de Prometheus para la memoria total.
+ * @brief Memoria residente del monitor.
  */
-static prom_gauge_t* memory_total_metric;
+static prom_gauge_t* monitor_resident_metric;
 
 /**
- * @brief Métrica de Prometheus para la memoria disponible.
+ * @brief Muestras del envío remoto, etiquetadas con "result" (sent, dropped o failed).
  */
-static prom_gauge_t* memory_avalible_metric;
+static prom_counter_t* monitor_push_samples_metric;
 
 /**
- * @brief Métrica de Prometheus para el uso alternativo de memoria.
+ * @brief Notificaciones de alertas, etiquetadas con "result" (sent, dropped o failed).
  */
-static prom_gauge_t* memory_usage_2_metric;
+static prom_counter_t* monitor_alert_notifications_metric;
 
 /**
- * @brief Actualiza la métrica de memoria disponible.
+ * @brief Series disparadas en todas las reglas de alerta.
  */
-void update_memory_avalible_gauge()
+static prom_gauge_t* monitor_alerts_firing_metric;
+
+/**
+ * @brief Muestras ignoradas porque su regla de alerta ya seguía ALERT_MAX_SERIES series.
+ */
+static prom_counter_t* monitor_alert_series_dropped_metric;
+
+/**
+ * @brief Reservas del heap de todo el monitor (solo con MONITOR_COUNT_ALLOCATIONS).
+ */
+static prom_counter_t* monitor_heap_allocations_metric;
+
+/**
+ * @brief Reservas del heap hechas por las ejecuciones de cada tarea (solo con MONITOR_COUNT_ALLOCATIONS).
+ */
+static prom_counter_t* monitor_collector_allocations_metric;
+
+/**
+ * @brief Agrega al lote la duración, las ejecuciones y los timeouts de una tarea de recolección.
+ */
+void update_collector_metrics(metric_batch_t* batch, const char* name, double duration_seconds,
+                              unsigned long long runs, unsigned long long timeouts, unsigned long long missed_ticks,
+                              unsigned long long allocations)
 {
-    double usage = get_memory_avalible();
-    if (usage >= MIN_VALUE)
-    {
-        pthread_mutex_lock(&lock);
-        prom_gauge_set(memory_avalible_metric, usage, NULL);
-        pthread_mutex_unlock(&lock);
-    }
-    else
+    const char* labels[] = {name};
+
+    metric_batch_add(batch, collector_duration_metric, METRIC_GAUGE, duration_seconds, labels, 1);
+    metric_batch_add(batch, collector_runs_metric, METRIC_COUNTER, (double)runs, labels, 1);
+    metric_batch_add(batch, collector_timeouts_metric, METRIC_COUNTER, (double)timeouts, labels, 1);
+    metric_batch_add(batch, collector_missed_ticks_metric, METRIC_COUNTER, (double)missed_ticks, labels, 1);
+    if (monitor_counts_allocations())
     {
-        fprintf(stderr, "Error al obtener la memoria disponible\n");
+        metric_batch_add(batch, monitor_collector_allocations_metric, METRIC_COUNTER, (double)allocations, labels, 1);
     }
 }
 
+void update_sampling_interval_metric(metric_batch_t* batch, const char* metric, double interval_seconds)
+{
+    const char* labels[] = {metric};
+    metric_batch_add(batch, metric_sampling_interval_metric, METRIC_GAUGE, interval_seconds, labels, 1);
+}
+
+void observe_collector_duration(const char* name, double duration_seconds)
+{
+    const char* labels[] = {name};
+    prom_histogram_observe(monitor_collector_duration_metric, duration_seconds, labels);
+}
+
 /**
- * @brief Actualiza la métrica de memoria total.
+ * @brief Agrega al lote los contadores de lectura, la memoria residente y las muestras del envío remoto.
  */
-void update_memory_total_gauge()
+void update_monitor_metrics(metric_batch_t* batch)
 {
-    double usage = get_memory_total();
-    if (usage >= MIN_VALUE)
+    metric_batch_add(batch, monitor_read_bytes_metric, METRIC_COUNTER, (double)monitor_read_bytes(), NULL, 0);
+    for (int i = 0; i < MONITOR_SYSCALL_COUNT; i++)
     {
-        pthread_mutex_lock(&lock);
-        prom_gauge_set(memory_total_metric, usage, NULL);
-        pthread_mutex_unlock(&lock);
+        const char* labels[] = {monitor_syscall_name((monitor_syscall_t)i)};
+        metric_batch_add(batch, monitor_syscalls_metric, METRIC_COUNTER, (double)monitor_syscalls((monitor_syscall_t)i),
+                         labels, 1);
     }
-    else
+
+    double resident = monitor_resident_bytes();
+    if (resident >= MIN_VALUE)
     {
-        fprintf(stderr, "Error al obtener la memoria total\n");
+        metric_batch_add(batch, monitor_resident_metric, METRIC_GAUGE, resident, NULL, 0);
     }
-}
 
-/**
- * @brief Actualiza la métrica alternativa de uso de memoria.
- */
-void update_memory_2_gauge()
-{
-    double usage = get_memory_usage_2();
-    if (usage >= MIN_VALUE)
+    unsigned long long pushed[PUSH_RESULT_COUNT];
+    push_counters(pushed);
+    for (int i = 0; i < PUSH_RESULT_COUNT; i++)
     {
-        pthread_mutex_lock(&lock);
-        prom_gauge_set(memory_usage_2_metric, usage, NULL);
-        pthread_mutex_unlock(&lock);
+        const char* labels[] = {push_result_name((push_result_t)i)};
+        metric_batch_add(batch, monitor_push_samples_metric, METRIC_COUNTER, (double)pushed[i], labels, 1);
     }
-    else
+
+    unsigned long long notified[ALERT_RESULT_COUNT];
+    alert_counters(notified);
+    for (int i = 0; i < ALERT_RESULT_COUNT; i++)
     {
-        fprintf(stderr, "Error al obtener el uso de memoria (métrica alternativa)\n");
+        const char* labels[] = {alert_result_name((alert_result_t)i)};
+        metric_batch_add(batch, monitor_alert_notifications_metric, METRIC_COUNTER, (double)notified[i], labels, 1);
+    }
+    metric_batch_add(batch, monitor_alerts_firing_metric, METRIC_GAUGE, (double)alert_firing_count(), NULL, 0);
+    metric_batch_add(batch, monitor_alert_series_dropped_metric, METRIC_COUNTER, (double)alert_series_dropped(), NULL,
+                     0);
+
+    if (monitor_counts_allocations())
+    {
+        metric_batch_add(batch, monitor_heap_allocations_metric, METRIC_COUNTER, (double)monitor_heap_allocations(),
+                         NULL, 0);
     }
 }
 
 /**
- * @brief Actualiza la métrica de estadísticas del disco.
+ * @brief Estado de un contador de Prometheus entre scrapes, para convertir totales en incrementos.
+ */
+typedef struct
+{
+    char key[METRIC_SERIES_KEY_SIZE]; ///< Métrica y etiquetas de la serie, usado como clave de counter_series.
+    double last;                      ///< Último total aplicado al contador.
+} counter_series_t;
+
+/**
+ * @brief Series de contadores ya vistas, indexadas por métrica y etiquetas.
+ */
+static strmap_t counter_series;
+
+/**
+ * @brief Aplica a un contador de Prometheus el incremento entre el total de la muestra y el último aplicado.
+ *
+ * @param sample Muestra de tipo METRIC_COUNTER.
+ * @param labels Valores de las etiquetas de la muestra.
  */
-void update_disk_stats_gauge()
+static void sync_counter(const metric_sample_t* sample, const char** labels)
 {
-    double usage = get_disk_stats();
-    if (usage >= MIN_VALUE)
+    char key[METRIC_SERIES_KEY_SIZE];
+    int len = snprintf(key, sizeof(key), "%p", sample->metric);
+    for (int i = 0; i < sample->label_count && len < (int)sizeof(key); i++)
     {
-        pthread_mutex_lock(&lock);
-        prom_gauge_set(disk_stats_metric, usage, NULL);
-        pthread_mutex_unlock(&lock);
+        len += snprintf(key + len, sizeof(key) - (size_t)len, "\x1f%s", labels[i]);
     }
-    else
+    if (len >= (int)sizeof(key))
     {
-        fprintf(stderr, "Error al obtener las estadísticas del disco\n");
+        len = (int)sizeof(key) - 1;
     }
-}
 
-/**
- * @brief Actualiza la métrica del número total de procesos.
- */
-void update_total_processes_gauge()
-{
-    double usage = get_total_processes();
-    if (usage >= MIN_VALUE)
+    counter_series_t* series = strmap_get(&counter_series, key, (size_t)len);
+    if (series == NULL)
     {
-        pthread_mutex_lock(&lock);
-        prom_gauge_set(total_processes_metric, usage, NULL);
-        pthread_mutex_unlock(&lock);
+        series = calloc(1, sizeof(*series));
+        if (series == NULL)
+        {
+            perror("Error al asignar memoria");
+            return;
+        }
+        memcpy(series->key, key, (size_t)len + 1);
+        if (strmap_put(&counter_series, series->key, series) != 0)
+        {
+            free(series);
+            return;
+        }
     }
-    else
+
+    // Un total menor que el anterior es un reinicio de la fuente: se cuenta desde cero
+    double delta = sample->value >= series->last ? sample->value - series->last : sample->value;
+    if (delta > 0)
     {
-        fprintf(stderr, "Error al obtener el número total de procesos\n");
+        prom_counter_add(sample->metric, delta, labels);
     }
+    series->last = sample->value;
 }
 
 /**
- * @brief Actualiza la métrica de cambios de contexto.
+ * @brief Vuelca en las métricas de Prometheus el último lote publicado de cada canal del almacén.
+ *
+ * Se llama con scrape_lock tomado, así que los recolectores nunca compiten con el volcado.
  */
-void update_change_context_gauge()
+static void sync_metric_store()
 {
-    double usage = get_change_context();
-    if (usage >= MIN_VALUE)
-    {
-        pthread_mutex_lock(&lock);
-        prom_gauge_set(change_context_metric, usage, NULL);
-        pthread_mutex_unlock(&lock);
-    }
-    else
-    {
-        fprintf(stderr, "Error al obtener el número de cambios de contexto\n");
+    for (int c = 0; c < metric_channel_count(); c++)
+    {
+        metric_channel_t* ch = metric_channel_at(c);
+        int slot;
+        const metric_batch_t* batch = metric_store_acquire(ch, &slot);
+        if (batch == NULL)
+        {
+            continue;
+        }
+
+        for (size_t i = 0; i < batch->count; i++)
+        {
+            const metric_sample_t* sample = &batch->samples[i];
+            const char* labels[METRIC_MAX_LABELS];
+            for (int l = 0; l < sample->label_count; l++)
+            {
+                labels[l] = sample->labels[l];
+            }
+
+            if (sample->kind == METRIC_COUNTER)
+            {
+                sync_counter(sample, labels);
+            }
+            else
+            {
+                prom_gauge_set(sample->metric, sample->value, sample->label_count ? labels : NULL);
+            }
+        }
+
+        metric_store_release(ch, slot);
     }
 }
 
 /**
- * @brief Actualiza la métrica de uso de CPU.
+ * @brief Envía una respuesta de texto con el código indicado.
+ *
+ * @param connection Conexión HTTP.
+ * @param status Código de estado HTTP.
+ * @param body Cuerpo de la respuesta.
+ * @param mode Modo de memoria del cuerpo para microhttpd.
+ * @return Resultado de MHD_queue_response().
  */
-void update_cpu_gauge()
+static MHD_RESULT send_text(struct MHD_Connection* connection, unsigned int status, const char* body,
+                                 enum MHD_ResponseMemoryMode mode)
 {
-    double usage = get_cpu_usage();
-    if (usage >= MIN_VALUE)
-    {
-        pthread_mutex_lock(&lock);
-        prom_gauge_set(cpu_usage_metric, usage, NULL);
-        pthread_mutex_unlock(&lock);
-    }
-    else
+    struct MHD_Response* response = MHD_create_response_from_buffer(strlen(body), (void*)body, mode);
+    if (response == NULL)
     {
-        fprintf(stderr, "Error al obtener el uso de CPU\n");
+        return MHD_NO;
     }
+    MHD_add_response_header(response, MHD_HTTP_HEADER_CONTENT_TYPE, CONTENT_TYPE);
+    MHD_RESULT ret = MHD_queue_response(connection, status, response);
+    MHD_destroy_response(response);
+    return ret;
 }
 
 /**
- * @brief Actualiza la métrica de uso de memoria.
+ * @brief Lee un instante en milisegundos de un argumento de la URL.
+ *
+ * @param connection Conexión HTTP.
+ * @param name Nombre del argumento.
+ * @param fallback Valor si el argumento no vino.
+ * @param value Instante leído.
+ * @return 0 en caso de éxito, -1 si el argumento no es un número.
  */
-void update_memory_gauge()
+static int history_argument(struct MHD_Connection* connection, const char* name, int64_t fallback, int64_t* value)
 {
-    double usage = get_memory_usage();
-    if (usage >= MIN_VALUE)
+    const char* text = MHD_lookup_connection_value(connection, MHD_GET_ARGUMENT_KIND, name);
+    if (text == NULL)
     {
-        pthread_mutex_lock(&lock);
-        prom_gauge_set(memory_usage_metric, usage, NULL);
-        pthread_mutex_unlock(&lock);
+        *value = fallback;
+        return INICIAL_VALUE;
     }
-    else
+    char* end;
+    errno = 0;
+    long long parsed = strtoll(text, &end, 10);
+    if (errno != 0 || end == text || *end != '\0')
     {
-        fprintf(stderr, "Error al obtener el uso de memoria\n");
+        return ERROR_INT;
     }
+    *value = parsed;
+    return INICIAL_VALUE;
 }
 
 /**
- * @brief Actualiza la métrica de uso del disco.
+ * @brief Responde con las muestras del historial de una métrica en un rango de tiempo.
+ *
+ * @param connection Conexión HTTP.
+ * @return Resultado de MHD_queue_response().
  */
-void update_disk_gauge()
+static MHD_RESULT send_history(struct MHD_Connection* connection)
 {
-    double usage = get_disk_usage();
-    if (usage >= MIN_VALUE)
+    const char* metric = MHD_lookup_connection_value(connection, MHD_GET_ARGUMENT_KIND, "metric");
+    int64_t now = history_now_ms();
+    int64_t start;
+    int64_t end;
+    if (metric == NULL || history_argument(connection, "start", 0, &start) != 0 ||
+        history_argument(connection, "end", now, &end) != 0)
     {
-        pthread_mutex_lock(&lock);
-        prom_gauge_set(disk_usage_metric, usage, NULL);
-        pthread_mutex_unlock(&lock);
+        return send_text(connection, MHD_HTTP_BAD_REQUEST, "Bad Request\n", MHD_RESPMEM_PERSISTENT);
     }
-    else
+
+    pthread_mutex_lock(&history_arena_lock);
+    arena_reset(&history_arena);
+    const char* body = history_query_json(metric, start, end, &history_arena);
+    struct MHD_Response* response =
+        body != NULL ? MHD_create_response_from_buffer(strlen(body), (void*)body, MHD_RESPMEM_MUST_COPY) : NULL;
+    pthread_mutex_unlock(&history_arena_lock);
+    if (body == NULL)
     {
-        fprintf(stderr, "Error al obtener el uso del disco\n");
+        return send_text(connection, MHD_HTTP_SERVICE_UNAVAILABLE, "Error\n", MHD_RESPMEM_PERSISTENT);
     }
+    if (response == NULL)
+    {
+        return MHD_NO;
+    }
+    MHD_add_response_header(response, MHD_HTTP_HEADER_CONTENT_TYPE, JSON_CONTENT_TYPE);
+    MHD_RESULT ret = MHD_queue_response(connection, MHD_HTTP_OK, response);
+    MHD_destroy_response(response);
+    return ret;
 }
 
 /**
- * @brief Actualiza la métrica de uso de la red.
+ * @brief Renderiza la exposición en la arena del scrape: vuelca el almacén en el registro y lo formatea.
  */
-void update_network_gauge()
+const char* render_exposition(arena_t* arena)
 {
-    double usage = get_network_usage();
-    if (usage >= MIN_VALUE)
-    {
-        pthread_mutex_lock(&lock);
-        prom_gauge_set(network_usage_metric, usage, NULL);
-        pthread_mutex_unlock(&lock);
-    }
-    else
-    {
-        fprintf(stderr, "Error al obtener el uso de la red\n");
-    }
+    // El volcado y el formateo de libprom comparten estado, así que se hacen siempre juntos
+    pthread_mutex_lock(&scrape_lock);
+    unsigned long long start = monitor_clock_ns();
+    sync_metric_store();
+#ifdef MONITOR_BUILTIN_EXPOSITION
+    const char* body = prom_collector_registry_render(PROM_COLLECTOR_REGISTRY_DEFAULT, arena);
+#else
+    // libprom siempre reserva el texto con malloc: se copia a la arena para que el llamador no tenga que liberarlo
+    char* text = (char*)prom_collector_registry_bridge(PROM_COLLECTOR_REGISTRY_DEFAULT);
+    const char* body = NULL;
+    if (text != NULL)
+    {
+        arena_str_t str;
+        arena_str_init(&str, arena);
+        arena_str_append(&str, text, strlen(text));
+        body = str.failed ? NULL : str.data;
+        free(text);
+    }
+#endif
+    unsigned long long end = monitor_clock_ns();
+    pthread_mutex_unlock(&scrape_lock);
+
+    // Se observa después del texto: la duración de este render aparece en el siguiente
+    prom_histogram_observe(monitor_render_duration_metric, (double)(end - start) / 1e9, NULL);
+    return body;
 }
 
 /**
- * @brief Actualiza la métrica de uso de ancho de banda.
+ * @brief Renderiza la exposición local y, si el agregador está en marcha, le agrega las series resumidas.
  */
-void update_bandwidth_gauge()
+static const char* render_full_exposition(arena_t* arena)
 {
-    double usage = get_average_bandwidth();
-    if (usage >= MIN_VALUE)
-    {
-        pthread_mutex_lock(&lock);
-        prom_gauge_set(bandwidth_usage_metric, usage, NULL);
-        pthread_mutex_unlock(&lock);
-    }
-    else
-    {
-        fprintf(stderr, "Error al obtener el ancho de banda en uso\n");
-    }
+    const char* body = render_exposition(arena);
+    return aggregator_generation() > 0 ? aggregator_append(body, arena) : body;
 }
 
 /**
- * @brief Actualiza la métrica de fallos de página mayores.
+ * @brief Indica si una lista de valores de un encabezado contiene el elemento dado.
+ *
+ * @param header Valor del encabezado, o NULL si no vino.
+ * @param token Elemento buscado.
+ * @return 1 si lo contiene, 0 si no.
  */
-void update_major_page_faults_gauge()
+static int header_has(const char* header, const char* token)
 {
-    unsigned long long faults = get_major_page_faults();
-    if (faults >= MIN_VALUE)
-    {
-        pthread_mutex_lock(&lock);
-        prom_gauge_set(major_page_faults_metric, faults, NULL);
-        pthread_mutex_unlock(&lock);
-    }
-    else
-    {
-        fprintf(stderr, "Error al obtener los fallos de página mayores\n");
-    }
+    return header != NULL && strstr(header, token) != NULL;
 }
 
 /**
- * @brief Actualiza la métrica de fallos de página menores.
+ * @brief Responde con la exposición cacheada, comprimida si el cliente acepta gzip, o 304 si ya la tiene.
+ *
+ * @param connection Conexión HTTP.
+ * @param exp Exposición fijada.
+ * @return Resultado de MHD_queue_response().
  */
-void update_minor_page_faults_gauge()
+static MHD_RESULT send_exposition(struct MHD_Connection* connection, const exposition_t* exp)
 {
-    unsigned long long faults = get_minor_page_faults();
-    if (faults >= MIN_VALUE)
+    const char* accept = MHD_lookup_connection_value(connection, MHD_HEADER_KIND, MHD_HTTP_HEADER_ACCEPT_ENCODING);
+    const char* if_none_match =
+        MHD_lookup_connection_value(connection, MHD_HEADER_KIND, MHD_HTTP_HEADER_IF_NONE_MATCH);
+    int gzip = exp->gzip_len > 0 && header_has(accept, "gzip");
+    const char* etag = gzip ? exp->gzip_etag : exp->etag;
+
+    struct MHD_Response* response;
+    unsigned int status = MHD_HTTP_OK;
+    if (header_has(if_none_match, etag))
     {
-        pthread_mutex_lock(&lock);
-        prom_gauge_set(minor_page_faults_metric, faults, NULL);
-        pthread_mutex_unlock(&lock);
+        status = MHD_HTTP_NOT_MODIFIED;
+        response = MHD_create_response_from_buffer(0, NULL, MHD_RESPMEM_PERSISTENT);
+    }
+    else if (gzip)
+    {
+        response = MHD_create_response_from_buffer(exp->gzip_len, (void*)exp->gzip, MHD_RESPMEM_MUST_COPY);
     }
     else
     {
-        fprintf(stderr, "Error al obtener los fallos de página menores\n");
+        response = MHD_create_response_from_buffer(exp->body_len, (void*)exp->body, MHD_RESPMEM_MUST_COPY);
+    }
+    if (response == NULL)
+    {
+        return MHD_NO;
     }
+
+    MHD_add_response_header(response, MHD_HTTP_HEADER_CONTENT_TYPE, CONTENT_TYPE);
+    MHD_add_response_header(response, MHD_HTTP_HEADER_ETAG, etag);
+    MHD_add_response_header(response, MHD_HTTP_HEADER_VARY, MHD_HTTP_HEADER_ACCEPT_ENCODING);
+    if (gzip && status == MHD_HTTP_OK)
+    {
+        MHD_add_response_header(response, MHD_HTTP_HEADER_CONTENT_ENCODING, "gzip");
+    }
+    MHD_RESULT ret = MHD_queue_response(connection, status, response);
+    MHD_destroy_response(response);
+    return ret;
 }
 
 /**
- * @brief Función que expone las métricas en el servidor HTTP.
+ * @brief Atiende una petición: responde con la exposición de texto cacheada.
+ *
+ * Replica el comportamiento de promhttp ("/" responde OK, "/metrics" la exposición) y agrega "/history" con el
+ * historial de muestras en JSON. La exposición solo se renderiza de nuevo cuando el almacén publicó un lote desde el
+ * último render; los demás scrapes del mismo ciclo reciben el buffer cacheado (o su versión gzip) y un ETag con el
+ * que pueden pedir un 304.
  */
-
-void* expose_metrics(void* arg)
+static MHD_RESULT route_request(struct MHD_Connection* connection, const char* url, const char* method)
 {
-    (void)arg; // Argumento no utilizado
-
-    // Aseguramos que el manejador HTTP esté adjunto al registro por defecto
-    promhttp_set_active_collector_registry(NULL);
-
-    // Iniciamos el servidor HTTP en el puerto 8000
-    struct MHD_Daemon* daemon = promhttp_start_daemon(MHD_USE_SELECT_INTERNALLY, PUERTO, NULL, NULL);
-    if (daemon == NULL)
+    if (strcmp(method, "GET") != 0)
+    {
+        return send_text(connection, MHD_HTTP_BAD_REQUEST, "Invalid HTTP Method\n", MHD_RESPMEM_PERSISTENT);
+    }
+    if (strcmp(url, "/") == 0)
     {
-        fprintf(stderr, "Error al iniciar el servidor HTTP\n");
+        return send_text(connection, MHD_HTTP_OK, "OK\n", MHD_RESPMEM_PERSISTENT);
+    }
+    if (strcmp(url, HISTORY_PATH) == 0)
+    {
+        return send_history(connection);
+    }
+    if (strcmp(url, METRICS_PATH) != 0)
+    {
+        return send_text(connection, MHD_HTTP_BAD_REQUEST, "Bad Request\n", MHD_RESPMEM_PERSISTENT);
     }
 
-    // Mantenemos el servidor en ejecución
-    while (1)
+    // La generación se lee antes de renderizar: un lote publicado durante el render fuerza el siguiente. Con el
+    // agregador en marcha también cambia con cada cálculo publicado, que se agrega al final del texto
+    unsigned long long generation = metric_store_generation() + aggregator_generation();
+    const exposition_t* exp = exposition_cache_acquire(generation, render_full_exposition);
+    if (exp == NULL)
     {
-        sleep(SLEEP_TIME);
+        return send_text(connection, MHD_HTTP_SERVICE_UNAVAILABLE, "Error\n", MHD_RESPMEM_PERSISTENT);
     }
 
-    // Nunca debería llegar aquí
-    MHD_stop_daemon(daemon);
+    MHD_RESULT ret = send_exposition(connection, exp);
+    exposition_cache_release();
+    return ret;
 }
 
 /**
- * @brief Inicializa las métricas del sistema y registra las métricas de Prometheus.
- *
- * Esta función inicializa el mutex utilizado para proteger el acceso a las métricas,
- * configura el registro de coleccionistas de Prometheus, y crea métricas para
- * el uso de CPU, memoria, disco y red, así como otros indicadores de rendimiento.
+ * @brief Manejador HTTP: atiende la petición con route_request() y observa cuánto tardó.
+ */
+static MHD_RESULT metrics_handler(void* cls, struct MHD_Connection* connection, const char* url,
+                                       const char* method, const char* version, const char* upload_data,
+                                       size_t* upload_data_size, void** con_cls)
+{
+    (void)cls;
+    (void)version;
+    (void)upload_data;
+    (void)upload_data_size;
+    (void)con_cls;
+
+    unsigned long long start = monitor_clock_ns();
+    MHD_RESULT ret = route_request(connection, url, method);
+    prom_histogram_observe(monitor_request_duration_metric, (double)(monitor_clock_ns() - start) / 1e9, NULL);
+    return ret;
+}
+
+/**
+ * @brief Arma las banderas de microhttpd para el modo pedido.
  *
- * @note Si ocurre un error en la inicialización de cualquiera de las métricas,
- * se imprimirá un mensaje de error en stderr.
+ * @param mode "epoll", "thread_per_connection", "select" o NULL para epoll.
+ * @param pool Se pone en true si el modo admite un grupo de hilos (MHD_OPTION_THREAD_POOL_SIZE).
+ * @return Banderas, o 0 si el modo no es válido.
  */
-void init_metrics()
+static unsigned int http_flags(const char* mode, bool* pool)
 {
-    // Inicializamos el mutex
-    if (pthread_mutex_init(&lock, NULL) != 0)
+    *pool = false;
+    if (mode == NULL || strcmp(mode, HTTP_MODE_EPOLL) == 0)
     {
-        fprintf(stderr, "Error al inicializar el mutex\n");
-        // return EXIT_FAILURE;
+        *pool = true;
+        // Sin epoll (otros sistemas o una biblioteca compilada sin él), poll con el mismo grupo de hilos
+        if (MHD_is_feature_supported(MHD_FEATURE_EPOLL) == MHD_YES)
+        {
+            return MHD_USE_EPOLL_INTERNAL_THREAD;
+        }
+        return MHD_USE_POLL_INTERNAL_THREAD;
     }
-
-    // Inicializamos el registro de coleccionistas de Prometheus
-    if (prom_collector_registry_default_init() != 0)
+    if (strcmp(mode, HTTP_MODE_THREAD_PER_CONNECTION) == 0)
     {
-        fprintf(stderr, "Error al inicializar el registro de Prometheus\n");
-        // return EXIT_FAILURE;
+        // El hilo que acepta conexiones usa poll para no depender del límite de FD_SETSIZE
+        return MHD_USE_THREAD_PER_CONNECTION | MHD_USE_POLL_INTERNAL_THREAD;
     }
-
-    // Creamos la métrica para el uso de CPU
-    cpu_usage_metric = prom_gauge_new("cpu_usage_percentage", "Porcentaje de uso de CPU", 0, NULL);
-    if (cpu_usage_metric == NULL)
+    if (strcmp(mode, HTTP_MODE_SELECT) == 0)
     {
-        fprintf(stderr, "Error al crear la métrica de uso de CPU\n");
-        // return EXIT_FAILURE;
+        return MHD_USE_INTERNAL_POLLING_THREAD;
     }
+    return 0;
+}
 
-    // Creamos la métrica para el uso de memoria
-    memory_usage_metric = prom_gauge_new("memory_usage_percentage", "Porcentaje de uso de memoria", 0, NULL);
-    if (memory_usage_metric == NULL)
-    {
-        fprintf(stderr, "Error al crear la métrica de uso de memoria\n");
-        // return EXIT_FAILURE;
-    }
+/**
+ * @brief Servidor HTTP iniciado por expose_metrics_start(), o NULL.
+ */
+static struct MHD_Daemon* http_daemon;
 
-    // Creamos la métrica para el uso de disco
-    disk_usage_metric = prom_gauge_new("disk_usage_percentage", "Porcentaje de uso de disco", 0, NULL);
-    if (disk_usage_metric == NULL)
-    {
-        fprintf(stderr, "Error al crear la métrica de uso de disco\n");
-        // return EXIT_FAILURE;
-    }
+/**
+ * @brief Dirección de escucha; microhttpd la lee al iniciar y no guarda el puntero.
+ */
+static struct sockaddr_storage http_address;
 
-    // Creamos la métrica para el uso de la red
-    network_usage_metric = prom_gauge_new("network_usage", "Uso de la red", 0, NULL);
-    if (network_usage_metric == NULL)
-    {
-        fprintf(stderr, "Error al crear la métrica de uso de la red\n");
-        // return EXIT_FAILURE;
-    }
+int expose_metrics_start(const http_options_t* options)
+{
+    http_options_t opts = {0};
+    if (options != NULL)
+    {
+        opts = *options;
+    }
+    const char* bind = opts.bind != NULL ? opts.bind : HTTP_DEFAULT_BIND;
+    int port = opts.port > 0 ? opts.port : HTTP_DEFAULT_PORT;
+    int threads = opts.threads > 0 ? opts.threads : HTTP_DEFAULT_THREADS;
+    int timeout = opts.connection_timeout > 0 ? opts.connection_timeout : HTTP_DEFAULT_CONNECTION_TIMEOUT;
+    int limit = opts.connection_limit > 0 ? opts.connection_limit : HTTP_DEFAULT_CONNECTION_LIMIT;
+    int backlog = opts.backlog > 0 ? opts.backlog : HTTP_DEFAULT_BACKLOG;
+
+    bool pool;
+    unsigned int flags = http_flags(opts.mode, &pool);
+    if (flags == 0 || port > UINT16_MAX)
+    {
+        fprintf(stderr, "Modo o puerto del servidor HTTP no válido\n");
+        return ERROR_INT;
+    }
+
+    // Solo direcciones numéricas: el servidor no debe depender del DNS para arrancar
+    char service[BUFFER_SIZE];
+    snprintf(service, sizeof(service), "%d", port);
+    struct addrinfo hints = {0};
+    hints.ai_flags = AI_PASSIVE | AI_NUMERICHOST | AI_NUMERICSERV;
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    struct addrinfo* res;
+    if (getaddrinfo(bind, service, &hints, &res) != 0)
+    {
+        fprintf(stderr, "Dirección de escucha no válida: %s\n", bind);
+        return ERROR_INT;
+    }
+    memcpy(&http_address, res->ai_addr, res->ai_addrlen);
+    if (res->ai_family == AF_INET6)
+    {
+        // "::" atiende también IPv4 con direcciones mapeadas
+        flags |= MHD_USE_DUAL_STACK;
+    }
+    freeaddrinfo(res);
+    flags |= MHD_USE_ERROR_LOG;
+
+    // El timeout cierra las conexiones keep-alive inactivas; el límite acota los sockets que un scraper puede tomar
+    struct MHD_OptionItem items[] = {
+        {MHD_OPTION_SOCK_ADDR, 0, &http_address},
+        {MHD_OPTION_CONNECTION_TIMEOUT, timeout, NULL},
+        {MHD_OPTION_CONNECTION_LIMIT, limit, NULL},
+        {MHD_OPTION_LISTEN_BACKLOG_SIZE, backlog, NULL},
+        // Sin grupo de hilos este elemento ya termina la lista
+        {pool && threads > 1 ? MHD_OPTION_THREAD_POOL_SIZE : MHD_OPTION_END, threads, NULL},
+        {MHD_OPTION_END, 0, NULL},
+    };
+    http_daemon = MHD_start_daemon(flags, (uint16_t)port, NULL, NULL, metrics_handler, NULL, MHD_OPTION_ARRAY, items,
+                                   MHD_OPTION_END);
+    if (http_daemon == NULL)
+    {
+        fprintf(stderr, "Error al iniciar el servidor HTTP en %s:%d\n", bind, port);
+        return ERROR_INT;
+    }
+    return INICIAL_VALUE;
+}
 
-    // Creamos la métrica para el ancho de banda de la red
-    bandwidth_usage_metric = prom_gauge_new("bandwidth_usage", "Ancho de banda en uso", 0, NULL);
-    if (bandwidth_usage_metric == NULL)
+void expose_metrics_stop()
+{
+    if (http_daemon != NULL)
     {
-        fprintf(stderr, "Error al crear la métrica de uso de ancho de banda\n");
-        // return EXIT_FAILURE;
+        MHD_stop_daemon(http_daemon);
+        http_daemon = NULL;
     }
+    arena_free(&history_arena);
+}
 
-    // Creamos la métrica para los fallos de página mayores
-    major_page_faults_metric = prom_gauge_new("major_page_faults", "Número de fallos de página mayores", 0, NULL);
-    if (major_page_faults_metric == NULL)
+/**
+ * @brief Inicializa las métricas del sistema y registra las métricas de Prometheus.
+ *
+ * Esta función inicializa el mutex utilizado para serializar los scrapes,
+ * configura el registro de coleccionistas de Prometheus, y crea métricas para
+ * el uso de CPU, memoria, disco y red, así como otros indicadores de rendimiento.
+ *
+ * @note Si ocurre un error en la inicialización de cualquiera de las métricas,
+ * se imprimirá un mensaje de error en stderr.
+ */
+void init_metrics()
+{
+    // Inicializamos el mutex que serializa los scrapes
+    if (pthread_mutex_init(&scrape_lock, NULL) != 0)
     {
-        fprintf(stderr, "Error al crear la métrica de fallos de página mayores\n");
+        fprintf(stderr, "Error al inicializar el mutex de los scrapes\n");
     }
 
-    // Creamos la métrica para los fallos de página menores
-    minor_page_faults_metric = prom_gauge_new("minor_page_faults", "Número de fallos de página menores", 0, NULL);
-    if (minor_page_faults_metric == NULL)
+    // La caché informa su propia causa; aquí solo se indica qué parte falló
+    if (exposition_cache_init() != 0)
     {
-        fprintf(stderr, "Error al crear la métrica de fallos de página menores\n");
+        fprintf(stderr, "Error al inicializar la caché de exposición\n");
     }
 
-    // Ejemplo de métricas adicionales (asegúrate de definirlas en tu código)
-    change_context_metric = prom_gauge_new("change_contexts", "Número de cambios de contexto", 0, NULL);
-    if (change_context_metric == NULL)
+    // Abrimos una sola vez los archivos de /proc que se releen en cada ciclo
+    if (snapshot_init() != 0)
     {
-        fprintf(stderr, "Error al crear la métrica de cambios de contexto\n");
-        return; // Salimos si hay un error
+        fprintf(stderr, "Error al abrir las fuentes de /proc\n");
     }
 
-    total_processes_metric = prom_gauge_new("total_processes", "Número total de procesos", 0, NULL);
-    if (total_processes_metric == NULL)
+    // Al reiniciar el monitor las métricas y los totales de sus contadores ya existen: registrarlas otra vez las
+    // duplicaría en la exposición
+    if (metrics_created)
     {
-        fprintf(stderr, "Error al crear la métrica de total de procesos\n");
-        return; // Salimos si hay un error
+        return;
     }
-
-    memory_total_metric = prom_gauge_new("memory_total", "Memoria total del sistema", 0, NULL);
-    if (memory_total_metric == NULL)
+    metrics_created = ASSIGNED_VALUE;
+    if (strmap_init(&counter_series, 0) != 0)
     {
-        fprintf(stderr, "Error al crear la métrica de memoria total\n");
-        return; // Salimos si hay un error
+        fprintf(stderr, "Error al inicializar la tabla de contadores\n");
     }
 
-    memory_avalible_metric = prom_gauge_new("memory_available", "Memoria disponible del sistema", 0, NULL);
-    if (memory_avalible_metric == NULL)
+    // Inicializamos el registro de coleccionistas de Prometheus
+    if (prom_collector_registry_default_init() != 0)
     {
-        fprintf(stderr, "Error al crear la métrica de memoria disponible\n");
-        return; // Salimos si hay un error
+        fprintf(stderr, "Error al inicializar el registro de Prometheus\n");
     }
 
-    memory_usage_2_metric = prom_gauge_new("memory_usage_2", "Uso de memoria (otra métrica)", 0, NULL);
-    if (memory_usage_2_metric == NULL)
+    // Métricas del sistema descritas en la tabla de metric_registry.c
+    if (metric_registry_init() != 0)
     {
-        fprintf(stderr, "Error al crear la métrica de uso de memoria (otra)\n");
-        return; // Salimos si hay un error
+        fprintf(stderr, "Error al registrar las métricas\n");
     }
 
-    // Agregamos la métrica para los disk stats
-    disk_stats_metric = prom_gauge_new("disk_stats", "Estadísticas del disco", 0, NULL);
-    if (disk_stats_metric == NULL)
-    {
-        fprintf(stderr, "Error al crear la métrica de estadísticas del disco\n");
+    // Métricas propias de las tareas de recolección
+    const char* labels[] = {"collector"};
+    collector_duration_metric = prom_gauge_new("collector_duration_seconds",
+                                               "Duración de la última ejecución de la tarea de recolección", 1,
+                                               labels);
+    collector_runs_metric = prom_counter_new("collector_runs_total",
+                                             "Ejecuciones completadas de la tarea de recolección", 1,
+                                             labels);
+    collector_timeouts_metric = prom_counter_new("collector_timeouts_total",
+                                                 "Ejecuciones de la tarea de recolección que superaron su plazo", 1,
+                                                 labels);
+    collector_missed_ticks_metric = prom_counter_new("collector_missed_ticks_total",
+                                                     "Ticks de la tarea de recolección salteados por demora", 1,
+                                                     labels);
+    const char* metric_labels[] = {"metric"};
+    metric_sampling_interval_metric =
+        prom_gauge_new("metric_sampling_interval_seconds",
+                       "Intervalo de muestreo vigente de la métrica, espaciado por el muestreo adaptativo", 1,
+                       metric_labels);
+    if (metric_registry_register(collector_duration_metric, "collector_duration_seconds", 1, labels) == NULL ||
+        metric_registry_register(collector_runs_metric, "collector_runs_total", 1, labels) == NULL ||
+        metric_registry_register(collector_timeouts_metric, "collector_timeouts_total", 1, labels) == NULL ||
+        metric_registry_register(collector_missed_ticks_metric, "collector_missed_ticks_total", 1, labels) == NULL ||
+        metric_registry_register(metric_sampling_interval_metric, "metric_sampling_interval_seconds", 1,
+                                 metric_labels) == NULL)
+    {
+        fprintf(stderr, "Error al crear las métricas de las tareas de recolección\n");
         return; // Manejo de errores
     }
 
-    // Registramos las métricas en el registro por defecto
-    if (prom_collector_registry_must_register_metric(cpu_usage_metric) == NULL ||
-        prom_collector_registry_must_register_metric(memory_usage_metric) == NULL ||
-        prom_collector_registry_must_register_metric(disk_usage_metric) == NULL ||
-        prom_collector_registry_must_register_metric(network_usage_metric) == NULL ||
-        prom_collector_registry_must_register_metric(bandwidth_usage_metric) == NULL ||
-        prom_collector_registry_must_register_metric(major_page_faults_metric) == NULL ||
-        prom_collector_registry_must_register_metric(minor_page_faults_metric) == NULL ||
-        prom_collector_registry_must_register_metric(change_context_metric) == NULL ||
-        prom_collector_registry_must_register_metric(total_processes_metric) == NULL ||
-        prom_collector_registry_must_register_metric(memory_total_metric) == NULL ||
-        prom_collector_registry_must_register_metric(memory_avalible_metric) == NULL ||
-        prom_collector_registry_must_register_metric(memory_usage_2_metric) == NULL)
-    {
-        fprintf(stderr, "Error al registrar las métricas\n");
-        // return EXIT_FAILURE;
+    // Costo del propio monitor: duraciones de 50 us a 1.6 s en cubetas que se duplican
+    const char* syscall_labels[] = {"syscall"};
+    const char* result_labels[] = {"result"};
+    monitor_collector_duration_metric = prom_histogram_new(
+        "monitor_collector_duration_seconds", "Duración de las ejecuciones de la tarea de recolección",
+        prom_histogram_buckets_exponential(MONITOR_BUCKET_START, 2, MONITOR_BUCKET_COUNT), 1, labels);
+    monitor_render_duration_metric =
+        prom_histogram_new("monitor_scrape_render_seconds", "Duración del render de la exposición",
+                           prom_histogram_buckets_exponential(MONITOR_BUCKET_START, 2, MONITOR_BUCKET_COUNT), 0, NULL);
+    monitor_request_duration_metric =
+        prom_histogram_new("monitor_http_request_duration_seconds", "Duración del manejador HTTP",
+                           prom_histogram_buckets_exponential(MONITOR_BUCKET_START, 2, MONITOR_BUCKET_COUNT), 0, NULL);
+    monitor_read_bytes_metric =
+        prom_counter_new("monitor_proc_read_bytes_total", "Bytes leídos de /proc y de cgroupfs", 0, NULL);
+    monitor_syscalls_metric = prom_counter_new("monitor_syscalls_total",
+                                               "Syscalls de lectura de /proc y de cgroupfs", 1, syscall_labels);
+    monitor_resident_metric =
+        prom_gauge_new("monitor_resident_memory_bytes", "Memoria residente del monitor", 0, NULL);
+    monitor_push_samples_metric =
+        prom_counter_new("monitor_push_samples_total", "Muestras del envío remoto por resultado", 1, result_labels);
+    monitor_alert_notifications_metric = prom_counter_new(
+        "monitor_alert_notifications_total", "Notificaciones de alertas por resultado", 1, result_labels);
+    monitor_alerts_firing_metric =
+        prom_gauge_new("monitor_alerts_firing", "Series disparadas en las reglas de alerta", 0, NULL);
+    monitor_alert_series_dropped_metric =
+        prom_counter_new("monitor_alert_series_dropped_total",
+                         "Muestras ignoradas porque su regla de alerta ya sigue el máximo de series", 0, NULL);
+    monitor_heap_allocations_metric =
+        prom_counter_new("monitor_heap_allocations_total", "Reservas del heap del monitor", 0, NULL);
+    monitor_collector_allocations_metric = prom_counter_new(
+        "monitor_collector_allocations_total", "Reservas del heap de las ejecuciones de la tarea de recolección", 1,
+        labels);
+    if (metric_registry_register(monitor_collector_duration_metric, "monitor_collector_duration_seconds", 1,
+                                 labels) == NULL ||
+        metric_registry_register(monitor_render_duration_metric, "monitor_scrape_render_seconds", 0, NULL) == NULL ||
+        metric_registry_register(monitor_request_duration_metric, "monitor_http_request_duration_seconds", 0, NULL) ==
+            NULL ||
+        metric_registry_register(monitor_read_bytes_metric, "monitor_proc_read_bytes_total", 0, NULL) == NULL ||
+        metric_registry_register(monitor_syscalls_metric, "monitor_syscalls_total", 1, syscall_labels) == NULL ||
+        metric_registry_register(monitor_resident_metric, "monitor_resident_memory_bytes", 0, NULL) == NULL ||
+        metric_registry_register(monitor_push_samples_metric, "monitor_push_samples_total", 1, result_labels) == NULL ||
+        metric_registry_register(monitor_alert_notifications_metric, "monitor_alert_notifications_total", 1,
+                                 result_labels) == NULL ||
+        metric_registry_register(monitor_alerts_firing_metric, "monitor_alerts_firing", 0, NULL) == NULL ||
+        metric_registry_register(monitor_alert_series_dropped_metric, "monitor_alert_series_dropped_total", 0, NULL) ==
+            NULL ||
+        metric_registry_register(monitor_heap_allocations_metric, "monitor_heap_allocations_total", 0, NULL) == NULL ||
+        metric_registry_register(monitor_collector_allocations_metric, "monitor_collector_allocations_total", 1,
+                                 labels) == NULL)
+    {
+        fprintf(stderr, "Error al crear las métricas del monitor\n");
     }
 }
 
 /**
- * @brief Destruye el mutex utilizado para proteger el acceso a las métricas.
+ * @brief Destruye el mutex utilizado para serializar los scrapes.
  *
  * Esta función libera los recursos asociados al mutex creado en la función
  * @ref init_metrics.
  */
 void destroy_mutex()
 {
-    pthread_mutex_destroy(&lock);
+    exposition_cache_close();
+    pthread_mutex_destroy(&scrape_lock);
 }
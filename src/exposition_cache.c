@@ -0,0 +1,248 @@
+/**
+ * @file exposition_cache.c
+ * @brief Caché de la exposición de texto con compresión gzip y ETag por contenido.
+ *
+ * Los scrapes toman el lock de lectura para copiar la exposición a su respuesta; solo el scrape que detecta una
+ * generación nueva toma el lock de escritura y renderiza, y el resto de los que llegan en ese momento esperan ese
+ * único render en lugar de repetirlo.
+ */
+
+#include "exposition_cache.h"
+#include "metrics.h"
+#include <pthread.h>
+#include <stdint.h>
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+/**
+ * @brief Base de offset de FNV-1a de 64 bits.
+ */
+#define FNV64_OFFSET 0xcbf29ce484222325ULL
+
+/**
+ * @brief Primo de FNV-1a de 64 bits.
+ */
+#define FNV64_PRIME 0x100000001b3ULL
+
+#ifdef HAVE_ZLIB
+/**
+ * @brief Bits de ventana de deflate; sumar 16 hace que zlib escriba el encabezado y el pie de gzip.
+ */
+#define GZIP_WINDOW_BITS (15 + 16)
+
+/**
+ * @brief Nivel de memoria de deflate (el valor por defecto de zlib).
+ */
+#define GZIP_MEM_LEVEL 8
+
+/**
+ * @brief Flujo de compresión reutilizado entre renders.
+ */
+static z_stream zs;
+
+/**
+ * @brief 1 si zs está inicializado.
+ */
+static int zs_ready = INICIAL_VALUE;
+#endif
+
+/**
+ * @brief Exposición vigente.
+ */
+static exposition_t current;
+
+/**
+ * @brief Protege current: lectura para servirla, escritura para reemplazarla.
+ */
+static pthread_rwlock_t cache_lock;
+
+/**
+ * @brief Arena en la que escribe el render; se reinicia después de copiar el texto a current.
+ */
+static arena_t scrape_arena;
+
+/**
+ * @brief Inicializa la caché y el flujo de compresión.
+ *
+ * @return 0 en caso de éxito, -1 en caso de error.
+ */
+int exposition_cache_init()
+{
+    if (pthread_rwlock_init(&cache_lock, NULL) != INICIAL_VALUE)
+    {
+        fprintf(stderr, "Error al inicializar el lock de la caché de exposición\n");
+        return ERROR_INT;
+    }
+
+#ifdef HAVE_ZLIB
+    if (deflateInit2(&zs, Z_DEFAULT_COMPRESSION, Z_DEFLATED, GZIP_WINDOW_BITS, GZIP_MEM_LEVEL, Z_DEFAULT_STRATEGY) ==
+        Z_OK)
+    {
+        zs_ready = ASSIGNED_VALUE;
+    }
+    else
+    {
+        // Sin compresión la caché sigue sirviendo el texto plano
+        fprintf(stderr, "Error al inicializar zlib: %s\n", zs.msg ? zs.msg : "desconocido");
+    }
+#endif
+    return INICIAL_VALUE;
+}
+
+/**
+ * @brief Comprime body en current.gzip reutilizando su buffer.
+ *
+ * Si la compresión falla current.gzip queda en NULL y se sirve solo el texto plano.
+ */
+static void compress_current()
+{
+    current.gzip_len = INICIAL_VALUE;
+#ifdef HAVE_ZLIB
+    if (!zs_ready || deflateReset(&zs) != Z_OK)
+    {
+        return;
+    }
+
+    size_t bound = deflateBound(&zs, (uLong)current.body_len);
+    if (bound > current.gzip_cap)
+    {
+        unsigned char* bigger = realloc(current.gzip, bound);
+        if (bigger == NULL)
+        {
+            perror("Error al asignar memoria");
+            return;
+        }
+        current.gzip = bigger;
+        current.gzip_cap = bound;
+    }
+
+    zs.next_in = (Bytef*)current.body;
+    zs.avail_in = (uInt)current.body_len;
+    zs.next_out = current.gzip;
+    zs.avail_out = (uInt)current.gzip_cap;
+    if (deflate(&zs, Z_FINISH) == Z_STREAM_END)
+    {
+        current.gzip_len = zs.total_out;
+    }
+#endif
+}
+
+/**
+ * @brief Copia el texto renderizado a current.body reutilizando su buffer.
+ *
+ * @return 0 en caso de éxito, -1 si no hay memoria.
+ */
+static int copy_body(const char* body)
+{
+    size_t len = strlen(body);
+    if (len + 1 > current.body_cap)
+    {
+        char* bigger = realloc(current.body, len + 1);
+        if (bigger == NULL)
+        {
+            perror("Error al asignar memoria");
+            return ERROR_INT;
+        }
+        current.body = bigger;
+        current.body_cap = len + 1;
+    }
+    memcpy(current.body, body, len + 1);
+    current.body_len = len;
+    return INICIAL_VALUE;
+}
+
+/**
+ * @brief Renderiza la exposición en la arena del scrape y reemplaza current.
+ *
+ * @param generation Generación del almacén leída antes de renderizar.
+ * @param render Función que genera el texto.
+ */
+static void render_current(unsigned long long generation, exposition_render_fn render)
+{
+    const char* body = render(&scrape_arena);
+    int copied = body != NULL && copy_body(body) == INICIAL_VALUE;
+    arena_reset(&scrape_arena);
+    if (!copied)
+    {
+        // Se sigue sirviendo la exposición anterior, que es la mejor disponible
+        return;
+    }
+    body = current.body;
+
+    // El ETag depende del contenido: un ciclo que publica los mismos valores no invalida a los clientes
+    uint64_t hash = FNV64_OFFSET;
+    for (size_t i = 0; i < current.body_len; i++)
+    {
+        hash ^= (unsigned char)body[i];
+        hash *= FNV64_PRIME;
+    }
+    snprintf(current.etag, sizeof(current.etag), "\"%016llx\"", (unsigned long long)hash);
+    snprintf(current.gzip_etag, sizeof(current.gzip_etag), "\"%016llx-gz\"", (unsigned long long)hash);
+
+    compress_current();
+    current.generation = generation;
+    current.valid = ASSIGNED_VALUE;
+}
+
+/**
+ * @brief Devuelve la exposición vigente, renderizándola si la generación cambió.
+ *
+ * @param generation Generación actual del almacén.
+ * @param render Función que genera el texto.
+ * @return Exposición fijada con el lock de lectura, o NULL si no hay ninguna.
+ */
+const exposition_t* exposition_cache_acquire(unsigned long long generation, exposition_render_fn render)
+{
+    pthread_rwlock_rdlock(&cache_lock);
+    if (current.valid && current.generation == generation)
+    {
+        return &current;
+    }
+    pthread_rwlock_unlock(&cache_lock);
+
+    pthread_rwlock_wrlock(&cache_lock);
+    // Otro scrape pudo haber renderizado esta generación mientras se esperaba el lock
+    if (!current.valid || current.generation != generation)
+    {
+        render_current(generation, render);
+    }
+    pthread_rwlock_unlock(&cache_lock);
+
+    pthread_rwlock_rdlock(&cache_lock);
+    if (!current.valid)
+    {
+        pthread_rwlock_unlock(&cache_lock);
+        return NULL;
+    }
+    return &current;
+}
+
+/**
+ * @brief Libera la exposición fijada.
+ */
+void exposition_cache_release()
+{
+    pthread_rwlock_unlock(&cache_lock);
+}
+
+/**
+ * @brief Libera los buffers de la caché y el flujo de compresión.
+ */
+void exposition_cache_close()
+{
+    pthread_rwlock_wrlock(&cache_lock);
+    free(current.body);
+    free(current.gzip);
+    memset(&current, 0, sizeof(current));
+    arena_free(&scrape_arena);
+#ifdef HAVE_ZLIB
+    if (zs_ready)
+    {
+        deflateEnd(&zs);
+        zs_ready = INICIAL_VALUE;
+    }
+#endif
+    pthread_rwlock_unlock(&cache_lock);
+    pthread_rwlock_destroy(&cache_lock);
+}
@@ -0,0 +1,571 @@
+/**
+ * @file fs_stats.c
+ * @brief Tabla de montajes cacheada y statvfs() con plazo en un hilo auxiliar.
+ *
+ * /proc/self/mountinfo queda abierto en una proc_source_t: el kernel marca POLLPRI en el descriptor cada vez que
+ * cambia la tabla de montajes del namespace, así que un poll() sin espera alcanza para saber si hay que releerla.
+ *
+ * statvfs() sobre un montaje de red caído puede bloquearse indefinidamente y no hay forma de interrumpirlo. Por eso
+ * las llamadas se delegan a un hilo auxiliar y el recolector espera cada respuesta hasta el plazo configurado. Si el
+ * plazo vence, el hilo se abandona (se guarda en stuck hasta que su llamada vuelva) y el próximo montaje usa un hilo
+ * nuevo; mientras tanto el montaje colgado se exporta como filesystem_stale y no se vuelve a consultar.
+ */
+
+#include "fs_stats.h"
+#include "metric_store.h"
+#include "metrics.h"
+#include "scan.h"
+#include <errno.h>
+#include <fnmatch.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <sys/statvfs.h>
+#include <time.h>
+
+/**
+ * @brief Hilo auxiliar que ejecuta un statvfs() por pedido.
+ */
+typedef struct
+{
+    pthread_t thread;        ///< Hilo.
+    pthread_cond_t cond;     ///< Señala un pedido nuevo al hilo y su respuesta al recolector.
+    char path[FS_PATH_SIZE]; ///< Punto de montaje del pedido en curso.
+    struct statvfs result;   ///< Resultado del último pedido.
+    int ret;                 ///< Valor devuelto por el último statvfs().
+    int pending;             ///< 1 mientras hay un pedido sin responder.
+    int abandoned;           ///< 1 si venció el plazo: el hilo termina al volver de statvfs().
+    int quit;                ///< 1 para que el hilo termine.
+} fs_worker_t;
+
+/**
+ * @brief Tipos de sistemas de archivos virtuales que se excluyen sin lista de permitidos.
+ */
+static const char* const pseudo_types[] = {
+    "autofs", "binfmt_misc", "bpf", "cgroup", "cgroup2", "configfs", "debugfs", "devpts", "devtmpfs", "efivarfs",
+    "erofs", "fusectl", "hugetlbfs", "iso9660", "mqueue", "nsfs", "overlay", "proc", "pstore", "rpc_pipefs",
+    "securityfs", "selinuxfs", "squashfs", "sysfs", "tracefs"};
+
+/**
+ * @brief /proc/self/mountinfo, abierto de forma persistente.
+ */
+static proc_source_t mountinfo = {FS_MOUNTINFO, ERROR_INT, NULL, INICIAL_VALUE, INICIAL_VALUE, INICIAL_VALUE};
+
+/**
+ * @brief Descriptor de mountinfo con el que se parseó la tabla; si se reabrió, el poll() anterior no vale.
+ */
+static int parsed_fd = ERROR_INT;
+
+/**
+ * @brief Montajes seleccionados; proc_snapshot_t::mounts apunta aquí.
+ */
+static fs_mount_t mounts[FS_MAX_MOUNTS];
+
+/**
+ * @brief Cantidad de entradas de mounts.
+ */
+static int mount_count = INICIAL_VALUE;
+
+/**
+ * @brief 1 si ya se avisó que se alcanzó FS_MAX_MOUNTS.
+ */
+static int full_warned = INICIAL_VALUE;
+
+/**
+ * @brief Lista de puntos de montaje permitidos.
+ */
+static char allowlist[MAX_FS_ALLOWLIST][FS_PATH_SIZE];
+
+/**
+ * @brief Cantidad de patrones en allowlist.
+ */
+static int allowlist_count = INICIAL_VALUE;
+
+/**
+ * @brief Generación de la lista de permitidos; cambia en cada set_fs_allowlist().
+ */
+static unsigned int allowlist_generation = ASSIGNED_VALUE;
+
+/**
+ * @brief Generación de la lista con la que se seleccionaron los montajes de la tabla.
+ */
+static unsigned int parsed_generation = INICIAL_VALUE;
+
+/**
+ * @brief Protege la lista de permitidos, que se reemplaza desde el hilo de configuración.
+ */
+static pthread_mutex_t allowlist_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * @brief Plazo de cada statvfs(); se cambia desde el hilo de configuración.
+ */
+static atomic_int timeout_ms = FS_DEFAULT_TIMEOUT_MS;
+
+/**
+ * @brief Protege los pedidos y las respuestas de los hilos auxiliares.
+ */
+static pthread_mutex_t worker_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * @brief Hilo auxiliar disponible, o NULL hasta el primer pedido o después de abandonarlo.
+ */
+static fs_worker_t* worker = NULL;
+
+/**
+ * @brief Hilos abandonados cuyo statvfs() todavía no volvió.
+ */
+static fs_worker_t* stuck[FS_MAX_STUCK];
+
+/**
+ * @brief Cantidad de entradas de stuck.
+ */
+static int stuck_count = INICIAL_VALUE;
+
+/**
+ * @brief 1 si ya se avisó que todos los lugares de stuck están ocupados.
+ */
+static int stuck_warned = INICIAL_VALUE;
+
+void set_fs_allowlist(const char** patterns, int count)
+{
+    if (count > MAX_FS_ALLOWLIST)
+    {
+        count = MAX_FS_ALLOWLIST;
+    }
+
+    pthread_mutex_lock(&allowlist_lock);
+
+    // Evitar reseleccionar la tabla si la lista no cambió
+    int changed = count != allowlist_count;
+    for (int i = 0; i < count && !changed; i++)
+    {
+        changed = strncmp(allowlist[i], patterns[i], FS_PATH_SIZE) != 0;
+    }
+    if (changed)
+    {
+        for (int i = 0; i < count; i++)
+        {
+            snprintf(allowlist[i], FS_PATH_SIZE, "%s", patterns[i]);
+        }
+        allowlist_count = count;
+        allowlist_generation++;
+    }
+
+    pthread_mutex_unlock(&allowlist_lock);
+}
+
+void set_fs_timeout(int timeout)
+{
+    if (timeout > INICIAL_VALUE)
+    {
+        atomic_store(&timeout_ms, timeout);
+    }
+}
+
+/**
+ * @brief Decide si un montaje debe seguirse; se llama con allowlist_lock tomado.
+ *
+ * @param mountpoint Punto de montaje.
+ * @param fstype Tipo de sistema de archivos.
+ * @return 1 si se selecciona, 0 si no.
+ */
+static int fs_is_selected(const char* mountpoint, const char* fstype)
+{
+    if (allowlist_count > INICIAL_VALUE)
+    {
+        for (int i = 0; i < allowlist_count; i++)
+        {
+            if (fnmatch(allowlist[i], mountpoint, INICIAL_VALUE) == INICIAL_VALUE)
+            {
+                return ASSIGNED_VALUE;
+            }
+        }
+        return INICIAL_VALUE;
+    }
+
+    for (size_t i = 0; i < sizeof(pseudo_types) / sizeof(pseudo_types[0]); i++)
+    {
+        if (strcmp(fstype, pseudo_types[i]) == INICIAL_VALUE)
+        {
+            return INICIAL_VALUE;
+        }
+    }
+    return ASSIGNED_VALUE;
+}
+
+/**
+ * @brief Copia un campo de mountinfo deshaciendo los escapes octales ("\040" es un espacio).
+ *
+ * @param dst Buffer destino.
+ * @param size Tamaño de dst.
+ * @param tok Campo de origen.
+ * @param len Longitud del campo.
+ */
+static void fs_unescape(char* dst, size_t size, const char* tok, size_t len)
+{
+    size_t out = INICIAL_VALUE;
+
+    for (size_t i = 0; i < len && out + ASSIGNED_VALUE < size; i++)
+    {
+        if (tok[i] == '\\' && len - i > 3 && tok[i + 1] >= '0' && tok[i + 1] <= '3' && tok[i + 2] >= '0' &&
+            tok[i + 2] <= '7' && tok[i + 3] >= '0' && tok[i + 3] <= '7')
+        {
+            dst[out++] = (char)((tok[i + 1] - '0') << 6 | (tok[i + 2] - '0') << 3 | (tok[i + 3] - '0'));
+            i += 3;
+            continue;
+        }
+        dst[out++] = tok[i];
+    }
+    dst[out] = '\0';
+}
+
+/**
+ * @brief Parsea /proc/self/mountinfo y reemplaza la tabla de montajes seleccionados.
+ *
+ * Cada línea es "36 35 98:0 /raíz /punto opciones [opcionales...] - tipo fuente superopciones".
+ *
+ * @param buf Contenido de mountinfo.
+ * @param len Bytes válidos de buf.
+ */
+static void fs_parse_mountinfo(const char* buf, size_t len)
+{
+    const char *tok, *point, *type, *source;
+    size_t tok_len, point_len, type_len, source_len;
+    scan_t s, line;
+
+    mount_count = INICIAL_VALUE;
+    pthread_mutex_lock(&allowlist_lock);
+    parsed_generation = allowlist_generation;
+
+    scan_init(&s, buf, len);
+    while (scan_next_line(&s, &line))
+    {
+        if (!scan_skip_fields(&line, 4) || !scan_token(&line, &point, &point_len) ||
+            !scan_skip_fields(&line, ASSIGNED_VALUE))
+        {
+            continue;
+        }
+        // Los campos opcionales ("shared:1", "master:2", ...) terminan en un "-" suelto
+        int separator = INICIAL_VALUE;
+        while (!separator && scan_token(&line, &tok, &tok_len))
+        {
+            separator = tok_len == ASSIGNED_VALUE && tok[0] == '-';
+        }
+        if (!separator || !scan_token(&line, &type, &type_len) || !scan_token(&line, &source, &source_len))
+        {
+            continue;
+        }
+
+        char mountpoint[FS_PATH_SIZE], fstype[FS_TYPE_SIZE];
+        fs_unescape(mountpoint, sizeof(mountpoint), point, point_len);
+        scan_copy(fstype, sizeof(fstype), type, type_len);
+        if (!fs_is_selected(mountpoint, fstype))
+        {
+            continue;
+        }
+        // Un montaje apilado sobre otro en el mismo punto lo tapa: se reemplaza para no duplicar la serie
+        int index = INICIAL_VALUE;
+        while (index < mount_count && strcmp(mounts[index].mountpoint, mountpoint) != INICIAL_VALUE)
+        {
+            index++;
+        }
+        if (index == FS_MAX_MOUNTS)
+        {
+            if (!full_warned)
+            {
+                fprintf(stderr, "Se alcanzó el máximo de %d montajes; se ignoran los demás\n", FS_MAX_MOUNTS);
+                full_warned = ASSIGNED_VALUE;
+            }
+            continue;
+        }
+        fs_mount_t* mount = &mounts[index];
+        strcpy(mount->mountpoint, mountpoint);
+        strcpy(mount->fstype, fstype);
+        fs_unescape(mount->device, sizeof(mount->device), source, source_len);
+
+        mount->has_stats = INICIAL_VALUE;
+        mount->stale = INICIAL_VALUE;
+        if (index == mount_count)
+        {
+            mount_count++;
+        }
+    }
+    if (mount_count < FS_MAX_MOUNTS)
+    {
+        full_warned = INICIAL_VALUE;
+    }
+
+    pthread_mutex_unlock(&allowlist_lock);
+}
+
+/**
+ * @brief Cuerpo de un hilo auxiliar: atiende pedidos hasta que se lo detiene o se lo abandona.
+ *
+ * @param arg Hilo auxiliar (fs_worker_t).
+ * @return NULL.
+ */
+static void* fs_worker_main(void* arg)
+{
+    fs_worker_t* self = arg;
+    struct statvfs result;
+
+    pthread_mutex_lock(&worker_lock);
+    while (!self->quit && !self->abandoned)
+    {
+        if (!self->pending)
+        {
+            pthread_cond_wait(&self->cond, &worker_lock);
+            continue;
+        }
+        // path no cambia mientras pending es 1, así que se puede leer sin el lock
+        pthread_mutex_unlock(&worker_lock);
+        int ret = statvfs(self->path, &result);
+        pthread_mutex_lock(&worker_lock);
+
+        self->result = result;
+        self->ret = ret;
+        self->pending = INICIAL_VALUE;
+        pthread_cond_signal(&self->cond);
+    }
+    pthread_mutex_unlock(&worker_lock);
+    return NULL;
+}
+
+/**
+ * @brief Crea un hilo auxiliar.
+ *
+ * @return Hilo, o NULL en caso de error.
+ */
+static fs_worker_t* fs_worker_new()
+{
+    fs_worker_t* created = calloc(1, sizeof(*created));
+    if (created == NULL)
+    {
+        perror("Error al asignar memoria");
+        return NULL;
+    }
+
+    // La espera con plazo usa CLOCK_MONOTONIC, como las de collector.c
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    int ret = pthread_cond_init(&created->cond, &attr);
+    pthread_condattr_destroy(&attr);
+    if (ret != 0 || pthread_create(&created->thread, NULL, fs_worker_main, created) != 0)
+    {
+        fprintf(stderr, "Error al crear el hilo de statvfs\n");
+        if (ret == 0)
+        {
+            pthread_cond_destroy(&created->cond);
+        }
+        free(created);
+        return NULL;
+    }
+    return created;
+}
+
+/**
+ * @brief Espera un hilo que ya terminó y libera sus recursos.
+ *
+ * @param done Hilo.
+ */
+static void fs_worker_free(fs_worker_t* done)
+{
+    pthread_join(done->thread, NULL);
+    pthread_cond_destroy(&done->cond);
+    free(done);
+}
+
+/**
+ * @brief Libera los hilos abandonados cuyo statvfs() ya volvió.
+ */
+static void fs_reap_stuck()
+{
+    for (int i = 0; i < stuck_count;)
+    {
+        pthread_mutex_lock(&worker_lock);
+        int pending = stuck[i]->pending;
+        pthread_mutex_unlock(&worker_lock);
+        if (pending)
+        {
+            i++;
+            continue;
+        }
+        fs_worker_free(stuck[i]);
+        stuck[i] = stuck[--stuck_count];
+        stuck_warned = INICIAL_VALUE;
+    }
+}
+
+/**
+ * @brief Indica si un montaje tiene un statvfs() colgado.
+ *
+ * @param mountpoint Punto de montaje.
+ * @return 1 si alguno de los hilos abandonados sigue en statvfs() sobre ese montaje, 0 si no.
+ */
+static int fs_is_stuck(const char* mountpoint)
+{
+    for (int i = 0; i < stuck_count; i++)
+    {
+        if (strcmp(stuck[i]->path, mountpoint) == INICIAL_VALUE)
+        {
+            return ASSIGNED_VALUE;
+        }
+    }
+    return INICIAL_VALUE;
+}
+
+/**
+ * @brief Consulta la capacidad de un montaje en el hilo auxiliar, esperando hasta el plazo.
+ *
+ * @param mount Montaje; se marca stale si el plazo vence.
+ * @param result Resultado de statvfs().
+ * @return 0 en caso de éxito, -1 si statvfs() falló, venció el plazo o no hay hilo disponible.
+ */
+static int fs_statvfs(fs_mount_t* mount, struct statvfs* result)
+{
+    if (worker == NULL)
+    {
+        if (stuck_count == FS_MAX_STUCK)
+        {
+            if (!stuck_warned)
+            {
+                fprintf(stderr, "Hay %d statvfs() colgados; no se consultan más montajes\n", FS_MAX_STUCK);
+                stuck_warned = ASSIGNED_VALUE;
+            }
+            return ERROR_INT;
+        }
+        if ((worker = fs_worker_new()) == NULL)
+        {
+            return ERROR_INT;
+        }
+    }
+
+    unsigned long long deadline_ns = monotonic_ns() + (unsigned long long)atomic_load(&timeout_ms) * 1000000ULL;
+    struct timespec deadline = {(time_t)(deadline_ns / 1000000000ULL), (long)(deadline_ns % 1000000000ULL)};
+    int ret = INICIAL_VALUE;
+
+    pthread_mutex_lock(&worker_lock);
+    strcpy(worker->path, mount->mountpoint);
+    worker->pending = ASSIGNED_VALUE;
+    pthread_cond_signal(&worker->cond);
+    while (worker->pending && ret != ETIMEDOUT)
+    {
+        ret = pthread_cond_timedwait(&worker->cond, &worker_lock, &deadline);
+    }
+
+    if (worker->pending)
+    {
+        // El hilo sigue dentro de statvfs(): se abandona y el próximo pedido crea otro
+        fprintf(stderr, "statvfs(%s) superó el plazo de %d ms\n", mount->mountpoint, atomic_load(&timeout_ms));
+        worker->abandoned = ASSIGNED_VALUE;
+        stuck[stuck_count++] = worker;
+        worker = NULL;
+        pthread_mutex_unlock(&worker_lock);
+        mount->stale = ASSIGNED_VALUE;
+        return ERROR_INT;
+    }
+
+    *result = worker->result;
+    ret = worker->ret;
+    pthread_mutex_unlock(&worker_lock);
+    return ret == INICIAL_VALUE ? INICIAL_VALUE : ERROR_INT;
+}
+
+/**
+ * @brief Relee la tabla de montajes si cambió y consulta la capacidad de los montajes seleccionados.
+ *
+ * @param snap Instantánea a completar.
+ * @return 0 en caso de éxito, -1 en caso de error.
+ */
+int fs_scan(proc_snapshot_t* snap)
+{
+    pthread_mutex_lock(&allowlist_lock);
+    int changed = parsed_generation != allowlist_generation;
+    pthread_mutex_unlock(&allowlist_lock);
+
+    // El descriptor se reabre si una lectura falló: la tabla se relee sin esperar un POLLPRI
+    if (!changed && mountinfo.fd >= INICIAL_VALUE && mountinfo.fd == parsed_fd)
+    {
+        struct pollfd pfd = {mountinfo.fd, POLLPRI, INICIAL_VALUE};
+        changed = poll(&pfd, ASSIGNED_VALUE, INICIAL_VALUE) > INICIAL_VALUE && (pfd.revents & (POLLPRI | POLLERR));
+    }
+    else
+    {
+        changed = ASSIGNED_VALUE;
+    }
+
+    if (changed)
+    {
+        if (proc_source_read(&mountinfo) != INICIAL_VALUE)
+        {
+            return ERROR_INT;
+        }
+        fs_parse_mountinfo(mountinfo.buf, mountinfo.len);
+        parsed_fd = mountinfo.fd;
+    }
+
+    fs_reap_stuck();
+    for (int i = 0; i < mount_count; i++)
+    {
+        fs_mount_t* mount = &mounts[i];
+        struct statvfs st;
+
+        mount->stale = fs_is_stuck(mount->mountpoint);
+        if (mount->stale || fs_statvfs(mount, &st) != INICIAL_VALUE)
+        {
+            mount->has_stats = INICIAL_VALUE;
+            continue;
+        }
+
+        // f_frsize es la unidad de los contadores de bloques; algunos sistemas antiguos solo cargan f_bsize
+        unsigned long long block = st.f_frsize ? (unsigned long long)st.f_frsize : (unsigned long long)st.f_bsize;
+        mount->size_bytes = (unsigned long long)st.f_blocks * block;
+        mount->free_bytes = (unsigned long long)st.f_bfree * block;
+        mount->avail_bytes = (unsigned long long)st.f_bavail * block;
+        mount->files = (unsigned long long)st.f_files;
+        mount->files_free = (unsigned long long)st.f_ffree;
+        mount->has_stats = ASSIGNED_VALUE;
+    }
+
+    snap->mounts = mounts;
+    snap->mount_count = mount_count;
+    return INICIAL_VALUE;
+}
+
+/**
+ * @brief Detiene el hilo de statvfs() y cierra la tabla de montajes.
+ */
+void fs_close()
+{
+    if (worker != NULL)
+    {
+        pthread_mutex_lock(&worker_lock);
+        worker->quit = ASSIGNED_VALUE;
+        pthread_cond_signal(&worker->cond);
+        pthread_mutex_unlock(&worker_lock);
+        fs_worker_free(worker);
+        worker = NULL;
+    }
+
+    // Un statvfs() colgado no se puede interrumpir: sus hilos se sueltan y terminan solos si la llamada vuelve
+    for (int i = 0; i < stuck_count; i++)
+    {
+        pthread_detach(stuck[i]->thread);
+    }
+    stuck_count = INICIAL_VALUE;
+    stuck_warned = INICIAL_VALUE;
+
+    if (mountinfo.fd >= INICIAL_VALUE)
+    {
+        close(mountinfo.fd);
+        mountinfo.fd = ERROR_INT;
+    }
+    free(mountinfo.buf);
+    mountinfo.buf = NULL;
+    mountinfo.cap = INICIAL_VALUE;
+    mountinfo.len = INICIAL_VALUE;
+    parsed_fd = ERROR_INT;
+    mount_count = INICIAL_VALUE;
+    full_warned = INICIAL_VALUE;
+}
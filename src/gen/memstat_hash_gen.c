@@ -0,0 +1,105 @@
+/**
+ * @file memstat_hash_gen.c
+ * @brief Generador de la tabla de hash perfecto de las claves de memstat_fields.h.
+ *
+ * CMake lo compila para el host y lo corre antes de compilar el monitor. Busca la tabla más chica (desde el doble de
+ * la cantidad de claves) y la primera semilla con la que memstat_hash() no tiene colisiones, y escribe memstat_hash.h
+ * con la semilla y la posición de cada campo. Como la tabla sale del mismo X-macro que usa memstat.c, nunca puede
+ * quedar desactualizada.
+ */
+
+#include "memstat_fields.h"
+#include <stdio.h>
+#include <string.h>
+
+/**
+ * @brief Semillas probadas con cada tamaño antes de duplicar la tabla.
+ */
+#define GEN_MAX_SEEDS 1000000u
+
+/**
+ * @brief Bits máximos de la tabla.
+ */
+#define GEN_MAX_BITS 12
+
+/**
+ * @brief Claves, en el orden de memstat_field_t.
+ */
+static const char* const keys[MEMSTAT_FIELD_COUNT] = {
+#define MEMSTAT_FIELD_KEY(id, key, file, metric, scale, help) key,
+    MEMSTAT_FIELDS(MEMSTAT_FIELD_KEY)
+#undef MEMSTAT_FIELD_KEY
+};
+
+/**
+ * @brief Campo en cada posición de la tabla, o -1.
+ */
+static int slots[1 << GEN_MAX_BITS];
+
+/**
+ * @brief Prueba una semilla y deja cargada la tabla si no hay colisiones.
+ *
+ * @param seed Semilla.
+ * @param bits Bits de la tabla.
+ * @return 1 si no hubo colisiones, 0 si no.
+ */
+static int try_seed(uint32_t seed, int bits)
+{
+    memset(slots, 0xff, sizeof(slots));
+    for (int f = 0; f < MEMSTAT_FIELD_COUNT; f++)
+    {
+        uint32_t slot = memstat_hash(seed, keys[f], strlen(keys[f])) >> (32 - bits);
+        if (slots[slot] >= 0)
+        {
+            return 0;
+        }
+        slots[slot] = f;
+    }
+    return 1;
+}
+
+int main(int argc, char** argv)
+{
+    if (argc != 2)
+    {
+        fprintf(stderr, "Uso: %s <memstat_hash.h>\n", argv[0]);
+        return 1;
+    }
+
+    int bits = 1;
+    while ((1 << bits) < 2 * MEMSTAT_FIELD_COUNT)
+    {
+        bits++;
+    }
+    for (; bits <= GEN_MAX_BITS; bits++)
+    {
+        for (uint32_t seed = 0; seed < GEN_MAX_SEEDS; seed++)
+        {
+            if (!try_seed(seed, bits))
+            {
+                continue;
+            }
+
+            FILE* out = fopen(argv[1], "w");
+            if (out == NULL)
+            {
+                perror("Error al crear la tabla de hash");
+                return 1;
+            }
+            fprintf(out, "/* Generado por memstat_hash_gen a partir de memstat_fields.h; no editar. */\n");
+            fprintf(out, "#pragma once\n\n");
+            fprintf(out, "#define MEMSTAT_HASH_SEED %uu\n", seed);
+            fprintf(out, "#define MEMSTAT_HASH_BITS %d\n\n", bits);
+            fprintf(out, "static const signed char memstat_hash_slots[1 << MEMSTAT_HASH_BITS] = {");
+            for (int i = 0; i < (1 << bits); i++)
+            {
+                fprintf(out, "%s%d", i % 16 == 0 ? "\n    " : " ", slots[i]);
+                fputc(i + 1 < (1 << bits) ? ',' : '\n', out);
+            }
+            fprintf(out, "};\n");
+            return fclose(out) == 0 ? 0 : 1;
+        }
+    }
+    fprintf(stderr, "No se encontró una semilla sin colisiones para %d claves\n", MEMSTAT_FIELD_COUNT);
+    return 1;
+}
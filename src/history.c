@@ -0,0 +1,583 @@
+/**
+ * @file history.c
+ * @brief Historial de muestras con compresión Gorilla sobre una región mapeada.
+ *
+ * Cada serie guarda un anillo de bloques de history_block.h; el formato de los bits de un bloque está en
+ * history_block.c.
+ */
+
+#include "history.h"
+#include "metric_registry.h"
+#include "metrics.h"
+#include "strmap.h"
+#include <fcntl.h>
+#include <fnmatch.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <time.h>
+
+/**
+ * @brief Identificador del archivo del historial.
+ */
+#define HISTORY_MAGIC "MONHIST"
+
+/**
+ * @brief Versión del formato del archivo; cambiarla vacía los archivos anteriores.
+ */
+#define HISTORY_VERSION 2
+
+/**
+ * @brief Separador entre la métrica y los valores de las etiquetas en las claves.
+ */
+#define HISTORY_KEY_SEPARATOR '\x1f'
+
+/**
+ * @brief Encabezado de la región, seguido de la tabla de series y de los bloques.
+ */
+typedef struct
+{
+    char magic[8];              ///< HISTORY_MAGIC.
+    uint32_t version;           ///< HISTORY_VERSION.
+    uint32_t block_bytes;       ///< HISTORY_BLOCK_BYTES al crear la región.
+    uint32_t blocks_per_series; ///< Bloques del anillo de cada serie.
+    uint32_t max_series;        ///< Capacidad de la tabla de series.
+    uint32_t series_count;      ///< Series usadas.
+    uint32_t reserved;          ///< Relleno para alinear la tabla de series.
+} history_header_t;
+
+/**
+ * @brief Serie vista en un lote, indexada por puntero de la métrica y valores de etiquetas.
+ */
+typedef struct
+{
+    char key[HISTORY_KEY_SIZE]; ///< Puntero y etiquetas, usado como clave de series_by_metric.
+    history_series_t* series;   ///< Serie del historial, o NULL si la tabla está llena o la métrica no tiene nombre.
+} history_ref_t;
+
+/**
+ * @brief Protege la región y las tablas: los lotes de varias tareas y las consultas HTTP llegan en paralelo.
+ */
+static pthread_mutex_t history_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * @brief Región mapeada, o NULL si el historial no está inicializado.
+ */
+static history_header_t* region = NULL;
+
+/**
+ * @brief Tamaño de la región.
+ */
+static size_t region_size = INICIAL_VALUE;
+
+/**
+ * @brief Descriptor del archivo del historial, o -1 si la región es anónima.
+ */
+static int history_fd = ERROR_INT;
+
+/**
+ * @brief Series indexadas por puntero de la métrica y etiquetas (camino de cada muestra).
+ */
+static strmap_t series_by_metric;
+
+/**
+ * @brief Series indexadas por history_series_t::key, para reencontrar las del archivo tras un reinicio.
+ */
+static strmap_t series_by_key;
+
+/**
+ * @brief Instante del último msync().
+ */
+static int64_t last_sync_ms = INICIAL_VALUE;
+
+/**
+ * @brief Devuelve la tabla de series de la región.
+ */
+static history_series_t* series_table()
+{
+    return (history_series_t*)(region + 1);
+}
+
+/**
+ * @brief Devuelve el bloque index del anillo de una serie.
+ */
+static history_block_t* series_block(const history_series_t* series, uint32_t index)
+{
+    size_t s = (size_t)(series - series_table());
+    history_block_t* blocks = (history_block_t*)(series_table() + region->max_series);
+    return &blocks[s * region->blocks_per_series + index];
+}
+
+int64_t history_now_ms()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return (int64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+/**
+ * @brief Arma la clave de una serie con el nombre de la métrica y los valores de las etiquetas.
+ */
+static void series_key(char* key, size_t size, const char* name, const metric_sample_t* sample)
+{
+    int len = snprintf(key, size, "%s", name);
+    for (int i = 0; i < sample->label_count && len < (int)size; i++)
+    {
+        len += snprintf(key + len, size - (size_t)len, "%c%s", HISTORY_KEY_SEPARATOR, sample->labels[i]);
+    }
+}
+
+/**
+ * @brief Busca o crea la serie de una muestra.
+ */
+static history_series_t* series_for(const metric_sample_t* sample)
+{
+    char key[HISTORY_KEY_SIZE];
+    int len = snprintf(key, sizeof(key), "%p", sample->metric);
+    for (int i = 0; i < sample->label_count && len < (int)sizeof(key); i++)
+    {
+        len += snprintf(key + len, sizeof(key) - (size_t)len, "%c%s", HISTORY_KEY_SEPARATOR, sample->labels[i]);
+    }
+    if (len >= (int)sizeof(key))
+    {
+        len = (int)sizeof(key) - 1;
+    }
+
+    history_ref_t* ref = strmap_get(&series_by_metric, key, (size_t)len);
+    if (ref != NULL)
+    {
+        return ref->series;
+    }
+
+    ref = calloc(1, sizeof(*ref));
+    if (ref == NULL)
+    {
+        perror("Error al asignar memoria");
+        return NULL;
+    }
+    memcpy(ref->key, key, (size_t)len + 1);
+
+    // La serie puede venir del archivo de una ejecución anterior; si no, se toma una entrada libre
+    const char* name = metric_registry_metric_name(sample->metric);
+    if (name != NULL)
+    {
+        char name_key[HISTORY_KEY_SIZE];
+        series_key(name_key, sizeof(name_key), name, sample);
+        ref->series = strmap_get(&series_by_key, name_key, strlen(name_key));
+        if (ref->series == NULL && region->series_count < region->max_series)
+        {
+            history_series_t* series = &series_table()[region->series_count];
+            memset(series, 0, sizeof(*series));
+            memcpy(series->key, name_key, sizeof(series->key));
+            if (strmap_put(&series_by_key, series->key, series) == 0)
+            {
+                region->series_count++;
+                ref->series = series;
+            }
+        }
+    }
+
+    if (strmap_put(&series_by_metric, ref->key, ref) != 0)
+    {
+        free(ref);
+        return NULL;
+    }
+    return ref->series;
+}
+
+/**
+ * @brief Agrega una muestra a una serie, abriendo un bloque nuevo (y pisando el más viejo) si hace falta.
+ */
+static void series_append(history_series_t* series, int64_t ts, double value)
+{
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+
+    if (series->used > 0)
+    {
+        history_block_t* block = series_block(series, series->head);
+        if (ts <= block->last_ts)
+        {
+            return; // Dos lotes en el mismo milisegundo: se conserva el primero
+        }
+        if (history_block_append(block, ts, bits) == INICIAL_VALUE)
+        {
+            return;
+        }
+        series->head = (series->head + 1) % region->blocks_per_series;
+    }
+    if (series->used < region->blocks_per_series)
+    {
+        series->used++;
+    }
+    history_block_start(series_block(series, series->head), ts, bits);
+}
+
+void history_record_batch(const metric_batch_t* batch)
+{
+    if (batch == NULL)
+    {
+        return;
+    }
+
+    pthread_mutex_lock(&history_lock);
+    if (region != NULL)
+    {
+        int64_t now = history_now_ms();
+        for (size_t i = 0; i < batch->count; i++)
+        {
+            history_series_t* series = series_for(&batch->samples[i]);
+            if (series != NULL)
+            {
+                series_append(series, now, batch->samples[i].value);
+            }
+        }
+
+        if (history_fd >= 0 && now - last_sync_ms >= HISTORY_SYNC_MS)
+        {
+            msync(region, region_size, MS_ASYNC);
+            last_sync_ms = now;
+        }
+    }
+    pthread_mutex_unlock(&history_lock);
+}
+
+/**
+ * @brief Agrega un texto JSON entre comillas, con el escapado de cJSON.
+ */
+static void json_string(arena_str_t* out, const char* text)
+{
+    static const char special[] = "\"\\\b\f\n\r\t"; // Caracteres con escape corto ...
+    static const char named[] = "\"\\bfnrt";             // ... y la letra que los nombra
+
+    arena_str_append(out, "\"", 1);
+    for (const char* p = text; *p != '\0'; p++)
+    {
+        unsigned char c = (unsigned char)*p;
+        const char* escape = strchr(special, c);
+        if (escape != NULL)
+        {
+            char pair[] = {'\\', named[escape - special]};
+            arena_str_append(out, pair, sizeof(pair));
+        }
+        else if (c < 0x20)
+        {
+            arena_str_printf(out, "\\u%04x", c);
+        }
+        else
+        {
+            arena_str_append(out, p, 1);
+        }
+    }
+    arena_str_append(out, "\"", 1);
+}
+
+/**
+ * @brief Agrega un número JSON como cJSON: 15 dígitos si alcanzan para recuperar el valor, si no 17.
+ */
+static void json_number(arena_str_t* out, double value)
+{
+    char text[ASSIGNED_VALUE_8 * 4];
+    if (value != value || value - value != value - value)
+    {
+        arena_str_append(out, "null", 4); // NaN e infinitos no existen en JSON
+        return;
+    }
+    int n = snprintf(text, sizeof(text), "%1.15g", value);
+    if (strtod(text, NULL) != value)
+    {
+        n = snprintf(text, sizeof(text), "%1.17g", value);
+    }
+    arena_str_append(out, text, (size_t)n);
+}
+
+/**
+ * @brief Copia de una serie que coincidió con una consulta, con los bloques del rango en orden cronológico.
+ */
+typedef struct
+{
+    char key[HISTORY_KEY_SIZE];    ///< Métrica y valores de etiquetas.
+    const history_block_t* blocks; ///< Copias de los bloques, en la arena de la consulta.
+    uint32_t block_count;          ///< Cantidad de bloques copiados.
+} history_match_t;
+
+/**
+ * @brief Copia a la arena las series que coinciden con el patrón y sus bloques dentro del rango.
+ *
+ * Se llama con history_lock tomado: solo copia estructuras de tamaño fijo, para que la decodificación y el formato
+ * de la respuesta no demoren a las tareas que graban lotes.
+ *
+ * @return Cantidad de series copiadas, o -1 si no hay memoria.
+ */
+static int copy_matches(const char* pattern, int64_t start_ms, int64_t end_ms, arena_t* arena,
+                        history_match_t** matches)
+{
+    uint32_t n = region->blocks_per_series;
+    *matches = arena_alloc(arena, (region->series_count + 1) * sizeof(history_match_t));
+    if (*matches == NULL)
+    {
+        return ERROR_INT;
+    }
+
+    int count = INICIAL_VALUE;
+    for (uint32_t s = 0; s < region->series_count; s++)
+    {
+        const history_series_t* series = &series_table()[s];
+        history_match_t* match = &(*matches)[count];
+        memcpy(match->key, series->key, sizeof(match->key));
+        match->key[sizeof(match->key) - 1] = '\0';
+
+        // La clave es la métrica seguida de los valores de las etiquetas
+        char* labels = strchr(match->key, HISTORY_KEY_SEPARATOR);
+        if (labels != NULL)
+        {
+            *labels = '\0';
+        }
+        int matched = fnmatch(pattern, match->key, 0) == 0;
+        if (labels != NULL)
+        {
+            *labels = HISTORY_KEY_SEPARATOR;
+        }
+        if (!matched)
+        {
+            continue;
+        }
+
+        history_block_t* blocks = arena_alloc(arena, (series->used + 1) * sizeof(history_block_t));
+        if (blocks == NULL)
+        {
+            return ERROR_INT;
+        }
+        match->blocks = blocks;
+        match->block_count = INICIAL_VALUE;
+        for (uint32_t i = 0; i < series->used; i++)
+        {
+            const history_block_t* block = series_block(series, (series->head + n + 1 - series->used + i) % n);
+            if (block->last_ts >= start_ms && block->first_ts <= end_ms)
+            {
+                blocks[match->block_count++] = *block;
+            }
+        }
+        count++;
+    }
+    return count;
+}
+
+/**
+ * @brief Agrega un arreglo JSON con las muestras de una serie copiada dentro del rango.
+ */
+static void series_samples_json(const history_match_t* match, int64_t start_ms, int64_t end_ms, arena_str_t* out)
+{
+    int first = ASSIGNED_VALUE;
+
+    arena_str_append(out, "[", 1);
+    for (uint32_t i = 0; i < match->block_count; i++)
+    {
+        history_block_reader_t reader;
+        history_block_reader_init(&reader, &match->blocks[i]);
+        int64_t ts;
+        double value;
+        while (history_block_next(&reader, &ts, &value))
+        {
+            if (ts < start_ms || ts > end_ms)
+            {
+                continue;
+            }
+            arena_str_printf(out, first ? "[%lld," : ",[%lld,", (long long)ts);
+            json_number(out, value);
+            arena_str_append(out, "]", 1);
+            first = INICIAL_VALUE;
+        }
+    }
+    arena_str_append(out, "]", 1);
+}
+
+const char* history_query_json(const char* pattern, int64_t start_ms, int64_t end_ms, arena_t* arena)
+{
+    history_match_t* matches = NULL;
+
+    pthread_mutex_lock(&history_lock);
+    if (region == NULL)
+    {
+        pthread_mutex_unlock(&history_lock);
+        return NULL;
+    }
+    int count = copy_matches(pattern, start_ms, end_ms, arena, &matches);
+    pthread_mutex_unlock(&history_lock);
+    if (count < 0)
+    {
+        return NULL;
+    }
+
+    arena_str_t out;
+    arena_str_init(&out, arena);
+    arena_str_append(&out, "{\"series\":[", 11);
+    for (int m = 0; m < count; m++)
+    {
+        char* key = matches[m].key;
+        char* labels = strchr(key, HISTORY_KEY_SEPARATOR);
+        if (labels != NULL)
+        {
+            *labels++ = '\0';
+        }
+
+        arena_str_append(&out, m == 0 ? "{\"metric\":" : ",{\"metric\":", m == 0 ? 10 : 11);
+        json_string(&out, key);
+        arena_str_append(&out, ",\"labels\":[", 11);
+        while (labels != NULL)
+        {
+            char* next = strchr(labels, HISTORY_KEY_SEPARATOR);
+            if (next != NULL)
+            {
+                *next++ = '\0';
+            }
+            json_string(&out, labels);
+            if (next != NULL)
+            {
+                arena_str_append(&out, ",", 1);
+            }
+            labels = next;
+        }
+        arena_str_append(&out, "],\"samples\":", 12);
+        series_samples_json(&matches[m], start_ms, end_ms, &out);
+        arena_str_append(&out, "}", 1);
+    }
+    arena_str_append(&out, "]}", 2);
+    return out.failed ? NULL : out.data;
+}
+
+/**
+ * @brief Mapea la región: el archivo indicado (creándolo o ajustando su tamaño) o memoria anónima.
+ *
+ * @return Región mapeada, o NULL en caso de error.
+ */
+static void* map_region(const char* file, size_t size)
+{
+    if (file == NULL)
+    {
+        void* map = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        return map == MAP_FAILED ? NULL : map;
+    }
+
+    history_fd = open(file, O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (history_fd < 0)
+    {
+        perror("Error al abrir el archivo del historial");
+        return NULL;
+    }
+    struct stat st;
+    if (fstat(history_fd, &st) != 0 || ((size_t)st.st_size != size && ftruncate(history_fd, (off_t)size) != 0))
+    {
+        perror("Error al dimensionar el archivo del historial");
+        close(history_fd);
+        history_fd = ERROR_INT;
+        return NULL;
+    }
+    void* map = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED, history_fd, 0);
+    if (map == MAP_FAILED)
+    {
+        perror("Error al mapear el archivo del historial");
+        close(history_fd);
+        history_fd = ERROR_INT;
+        return NULL;
+    }
+    return map;
+}
+
+int history_init(int samples, int max_series, const char* file)
+{
+    if (samples <= 0)
+    {
+        samples = HISTORY_DEFAULT_SAMPLES;
+    }
+    if (max_series <= 0)
+    {
+        max_series = HISTORY_DEFAULT_MAX_SERIES;
+    }
+
+    // Un bloque más que los necesarios: el que está en escritura no cuenta hasta llenarse
+    uint32_t blocks = (uint32_t)((samples + HISTORY_BLOCK_SAMPLES - 1) / HISTORY_BLOCK_SAMPLES) + 1;
+    size_t size = sizeof(history_header_t) + (size_t)max_series * sizeof(history_series_t) +
+                  (size_t)max_series * blocks * sizeof(history_block_t);
+
+    pthread_mutex_lock(&history_lock);
+    if (region != NULL || strmap_init(&series_by_metric, 0) != 0)
+    {
+        pthread_mutex_unlock(&history_lock);
+        return ERROR_INT;
+    }
+    if (strmap_init(&series_by_key, 0) != 0)
+    {
+        strmap_free(&series_by_metric);
+        pthread_mutex_unlock(&history_lock);
+        return ERROR_INT;
+    }
+    history_header_t* map = map_region(file, size);
+    if (map == NULL)
+    {
+        strmap_free(&series_by_metric);
+        strmap_free(&series_by_key);
+        pthread_mutex_unlock(&history_lock);
+        return ERROR_INT;
+    }
+    region = map;
+    region_size = size;
+
+    // Un archivo de otra versión o con otra geometría no se puede reutilizar: se empieza de cero
+    if (memcmp(region->magic, HISTORY_MAGIC, sizeof(HISTORY_MAGIC)) != 0 || region->version != HISTORY_VERSION ||
+        region->block_bytes != HISTORY_BLOCK_BYTES || region->blocks_per_series != blocks ||
+        region->max_series != (uint32_t)max_series || region->series_count > region->max_series)
+    {
+        memset(region, 0, sizeof(*region));
+        memcpy(region->magic, HISTORY_MAGIC, sizeof(HISTORY_MAGIC));
+        region->version = HISTORY_VERSION;
+        region->block_bytes = HISTORY_BLOCK_BYTES;
+        region->blocks_per_series = blocks;
+        region->max_series = (uint32_t)max_series;
+    }
+    for (uint32_t s = 0; s < region->series_count; s++)
+    {
+        history_series_t* series = &series_table()[s];
+        series->key[sizeof(series->key) - 1] = '\0';
+        if (series->head >= blocks || series->used > blocks)
+        {
+            series->head = INICIAL_VALUE;
+            series->used = INICIAL_VALUE;
+        }
+        strmap_put(&series_by_key, series->key, series);
+    }
+    last_sync_ms = history_now_ms();
+    pthread_mutex_unlock(&history_lock);
+    return INICIAL_VALUE;
+}
+
+/**
+ * @brief Libera las entradas de series_by_metric.
+ */
+static void free_refs()
+{
+    for (size_t i = 0; i < series_by_metric.capacity; i++)
+    {
+        free(series_by_metric.slots[i].value);
+    }
+}
+
+void history_close()
+{
+    pthread_mutex_lock(&history_lock);
+    if (region != NULL)
+    {
+        if (history_fd >= 0)
+        {
+            msync(region, region_size, MS_SYNC);
+            close(history_fd);
+            history_fd = ERROR_INT;
+        }
+        munmap(region, region_size);
+        region = NULL;
+        free_refs();
+        strmap_free(&series_by_metric);
+        strmap_free(&series_by_key);
+    }
+    pthread_mutex_unlock(&history_lock);
+}
@@ -0,0 +1,207 @@
+/**
+ * @file history_block.c
+ * @brief Codificador y decodificador de los bloques de history_block.h.
+ *
+ * Los instantes de un bloque se codifican como diferencia de diferencias con prefijos de 1 a 4 bits ('0', '10' con 7
+ * bits, '110' con 9, '1110' con 12 y '1111' con 32) y los valores como XOR con el anterior: '0' si no cambió, '10'
+ * con los bits significativos si caben en la ventana anterior, o '11' con 5 bits de ceros a la izquierda, 6 bits de
+ * longitud y los bits significativos. Las diferencias de diferencias van en complemento a dos, así que cada campo de
+ * n bits cubre de -2^(n-1) a 2^(n-1)-1. La peor muestra ocupa HISTORY_MAX_SAMPLE_BITS; un bloque se cierra cuando ya
+ * no hay lugar para ella.
+ */
+
+#include "history_block.h"
+#include "metrics.h"
+
+/**
+ * @brief Bits máximos de una muestra: 4 + 32 del instante y 2 + 5 + 6 + 64 del valor.
+ */
+#define HISTORY_MAX_SAMPLE_BITS 113
+
+/**
+ * @brief Bits de datos de un bloque.
+ */
+#define HISTORY_BLOCK_BITS (HISTORY_BLOCK_BYTES * 8)
+
+/**
+ * @brief Marca de history_block_t::leading sin ventana de XOR previa.
+ */
+#define HISTORY_NO_WINDOW 0xff
+
+/**
+ * @brief Escribe los nbits menos significativos de value al final del bloque, del más significativo al menor.
+ */
+static void bits_write(history_block_t* block, uint64_t value, int nbits)
+{
+    while (nbits > INICIAL_VALUE)
+    {
+        int free_bits = ASSIGNED_VALUE_8 - (int)(block->bits & 7);
+        int take = nbits < free_bits ? nbits : free_bits;
+        uint8_t chunk = (uint8_t)((value >> (nbits - take)) & ((1u << take) - 1));
+        block->data[block->bits >> 3] |= (uint8_t)(chunk << (free_bits - take));
+        block->bits += (uint32_t)take;
+        nbits -= take;
+    }
+}
+
+/**
+ * @brief Lee nbits a partir de la posición *pos de un bloque.
+ */
+static uint64_t bits_read(const history_block_t* block, uint32_t* pos, int nbits)
+{
+    uint64_t value = INICIAL_VALUE;
+    while (nbits > INICIAL_VALUE)
+    {
+        int avail = ASSIGNED_VALUE_8 - (int)(*pos & 7);
+        int take = nbits < avail ? nbits : avail;
+        uint8_t byte = block->data[*pos >> 3];
+        value = (value << take) | (uint64_t)((byte >> (avail - take)) & ((1u << take) - 1));
+        *pos += (uint32_t)take;
+        nbits -= take;
+    }
+    return value;
+}
+
+/**
+ * @brief Extiende el signo de un valor de nbits bits.
+ */
+static int64_t sign_extend(uint64_t value, int nbits)
+{
+    uint64_t sign = 1ULL << (nbits - 1);
+    return (int64_t)((value ^ sign) - sign);
+}
+
+void history_block_start(history_block_t* block, int64_t ts, uint64_t value)
+{
+    memset(block, 0, sizeof(*block));
+    block->first_ts = ts;
+    block->last_ts = ts;
+    block->first_value = value;
+    block->last_value = value;
+    block->count = ASSIGNED_VALUE;
+    block->leading = HISTORY_NO_WINDOW;
+}
+
+int history_block_append(history_block_t* block, int64_t ts, uint64_t value)
+{
+    int64_t delta = ts - block->last_ts;
+    int64_t dod = delta - block->last_delta;
+    if (block->count >= HISTORY_BLOCK_SAMPLES || HISTORY_BLOCK_BITS - block->bits < HISTORY_MAX_SAMPLE_BITS ||
+        dod < INT32_MIN || dod > INT32_MAX)
+    {
+        return ERROR_INT;
+    }
+
+    if (dod == 0)
+    {
+        bits_write(block, 0, 1);
+    }
+    else if (dod >= -64 && dod <= 63)
+    {
+        bits_write(block, 0x2, 2);
+        bits_write(block, (uint64_t)dod, 7);
+    }
+    else if (dod >= -256 && dod <= 255)
+    {
+        bits_write(block, 0x6, 3);
+        bits_write(block, (uint64_t)dod, 9);
+    }
+    else if (dod >= -2048 && dod <= 2047)
+    {
+        bits_write(block, 0xe, 4);
+        bits_write(block, (uint64_t)dod, 12);
+    }
+    else
+    {
+        bits_write(block, 0xf, 4);
+        bits_write(block, (uint64_t)dod, 32);
+    }
+
+    uint64_t xor = value ^ block->last_value;
+    if (xor == 0)
+    {
+        bits_write(block, 0, 1);
+    }
+    else
+    {
+        int leading = __builtin_clzll(xor);
+        int trailing = __builtin_ctzll(xor);
+        if (leading > 31)
+        {
+            leading = 31;
+        }
+        if (block->leading != HISTORY_NO_WINDOW && leading >= block->leading && trailing >= block->trailing)
+        {
+            // Los bits que cambiaron caben en la ventana anterior
+            bits_write(block, 0x2, 2);
+            bits_write(block, xor >> block->trailing, 64 - block->leading - block->trailing);
+        }
+        else
+        {
+            int length = 64 - leading - trailing;
+            bits_write(block, 0x3, 2);
+            bits_write(block, (uint64_t)leading, 5);
+            bits_write(block, (uint64_t)(length - 1), 6);
+            bits_write(block, xor >> trailing, length);
+            block->leading = (uint8_t)leading;
+            block->trailing = (uint8_t)trailing;
+        }
+    }
+
+    block->last_delta = delta;
+    block->last_ts = ts;
+    block->last_value = value;
+    block->count++;
+    return INICIAL_VALUE;
+}
+
+int history_block_next(history_block_reader_t* reader, int64_t* ts, double* value)
+{
+    const history_block_t* block = reader->block;
+    if (reader->index >= block->count)
+    {
+        return INICIAL_VALUE;
+    }
+
+    if (reader->index == 0)
+    {
+        reader->ts = block->first_ts;
+        reader->value = block->first_value;
+    }
+    else
+    {
+        // Prefijo del instante: cantidad de unos antes del primer cero, hasta cuatro
+        int ones = 0;
+        while (ones < 4 && bits_read(block, &reader->pos, 1))
+        {
+            ones++;
+        }
+        static const int dod_bits[] = {0, 7, 9, 12, 32};
+        int64_t dod = ones == 0 ? 0 : sign_extend(bits_read(block, &reader->pos, dod_bits[ones]), dod_bits[ones]);
+        reader->delta += dod;
+        reader->ts += reader->delta;
+
+        if (bits_read(block, &reader->pos, 1))
+        {
+            if (bits_read(block, &reader->pos, 1))
+            {
+                reader->leading = (int)bits_read(block, &reader->pos, 5);
+                int length = (int)bits_read(block, &reader->pos, 6) + 1;
+                reader->trailing = 64 - reader->leading - length;
+            }
+            int length = 64 - reader->leading - reader->trailing;
+            reader->value ^= bits_read(block, &reader->pos, length) << reader->trailing;
+        }
+    }
+
+    reader->index++;
+    *ts = reader->ts;
+    memcpy(value, &reader->value, sizeof(*value));
+    return ASSIGNED_VALUE;
+}
+
+void history_block_reader_init(history_block_reader_t* reader, const history_block_t* block)
+{
+    memset(reader, 0, sizeof(*reader));
+    reader->block = block;
+}
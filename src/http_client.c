@@ -0,0 +1,182 @@
+/**
+ * @file http_client.c
+ * @brief Conexión, envío y clasificación de respuestas del cliente de http_client.h.
+ */
+
+#include "http_client.h"
+#include "metrics.h"
+#include <errno.h>
+#include <netdb.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+
+int http_target_parse(const char* text, const char* default_port, http_target_t* target)
+{
+    const char* path = strchr(text, '/');
+    size_t authority = path ? (size_t)(path - text) : strlen(text);
+    if (strlen(path ? path : "/") >= sizeof(target->path))
+    {
+        return ERROR_INT;
+    }
+    snprintf(target->path, sizeof(target->path), "%s", path ? path : "/");
+
+    // [::1]:9090, host:9090 o host
+    const char* host = text;
+    const char* port = NULL;
+    size_t host_len = authority;
+    if (*text == '[')
+    {
+        const char* bracket = memchr(text, ']', authority);
+        if (bracket == NULL)
+        {
+            return ERROR_INT;
+        }
+        host = text + 1;
+        host_len = (size_t)(bracket - host);
+        port = bracket + 1 < text + authority && bracket[1] == ':' ? bracket + 2 : NULL;
+    }
+    else
+    {
+        const char* colon = memchr(text, ':', authority);
+        if (colon != NULL)
+        {
+            host_len = (size_t)(colon - text);
+            port = colon + 1;
+        }
+    }
+    size_t port_len = port ? (size_t)(text + authority - port) : strlen(default_port);
+    if (host_len == 0 || host_len >= sizeof(target->host) || port_len == 0 || port_len >= sizeof(target->port))
+    {
+        return ERROR_INT;
+    }
+    memcpy(target->host, host, host_len);
+    target->host[host_len] = '\0';
+    memcpy(target->port, port ? port : default_port, port_len);
+    target->port[port_len] = '\0';
+    return INICIAL_VALUE;
+}
+
+int http_format_request(const http_target_t* target, const char* headers, size_t body_len, char* out, size_t size)
+{
+    // Una dirección IPv6 va entre corchetes en Host
+    int ipv6 = strchr(target->host, ':') != NULL;
+    int len = snprintf(out, size,
+                       "POST %s HTTP/1.1\r\n"
+                       "Host: %s%s%s:%s\r\n"
+                       "%s"
+                       "User-Agent: monitoring_project\r\n"
+                       "Content-Length: %zu\r\n"
+                       "Connection: close\r\n\r\n",
+                       target->path, ipv6 ? "[" : "", target->host, ipv6 ? "]" : "", target->port, headers, body_len);
+    return len >= 0 && (size_t)len < size ? len : ERROR_INT;
+}
+
+/**
+ * @brief Abre una conexión TCP al destino con el plazo indicado para conectar, escribir y leer.
+ *
+ * @return Descriptor conectado, o -1 en caso de error.
+ */
+static int tcp_connect(const http_target_t* target, int timeout_ms)
+{
+    struct addrinfo hints = {0};
+    struct addrinfo* res;
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    if (getaddrinfo(target->host, target->port, &hints, &res) != 0)
+    {
+        return ERROR_INT;
+    }
+
+    struct timeval timeout = {timeout_ms / 1000, (timeout_ms % 1000) * 1000};
+    int fd = ERROR_INT;
+    for (struct addrinfo* ai = res; ai != NULL && fd < 0; ai = ai->ai_next)
+    {
+        fd = socket(ai->ai_family, ai->ai_socktype | SOCK_CLOEXEC, ai->ai_protocol);
+        if (fd < 0)
+        {
+            continue;
+        }
+        // En Linux SO_SNDTIMEO también acota connect()
+        setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+        setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+        if (connect(fd, ai->ai_addr, ai->ai_addrlen) != 0)
+        {
+            close(fd);
+            fd = ERROR_INT;
+        }
+    }
+    freeaddrinfo(res);
+    return fd;
+}
+
+/**
+ * @brief Escribe todo el buffer en un socket.
+ *
+ * @return 0 en caso de éxito, -1 en caso de error o timeout.
+ */
+static int send_all(int fd, const void* data, size_t len)
+{
+    const char* p = data;
+    while (len > 0)
+    {
+        ssize_t n = send(fd, p, len, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (n <= 0)
+        {
+            return ERROR_INT;
+        }
+        p += n;
+        len -= (size_t)n;
+    }
+    return INICIAL_VALUE;
+}
+
+http_post_result_t http_post(const http_target_t* target, const char* headers, const void* body, size_t len,
+                             int timeout_ms, int* status)
+{
+    *status = INICIAL_VALUE;
+    char header[BUFFER_SIZE * 4];
+    int header_len = http_format_request(target, headers, len, header, sizeof(header));
+    if (header_len < 0)
+    {
+        return HTTP_POST_REJECTED;
+    }
+
+    int fd = tcp_connect(target, timeout_ms);
+    if (fd < 0)
+    {
+        return HTTP_POST_RETRY;
+    }
+    if (send_all(fd, header, (size_t)header_len) != 0 || send_all(fd, body, len) != 0)
+    {
+        close(fd);
+        return HTTP_POST_RETRY;
+    }
+
+    // Solo interesa la línea de estado
+    char response[BUFFER_SIZE];
+    ssize_t n;
+    do
+    {
+        n = recv(fd, response, sizeof(response) - 1, 0);
+    } while (n < 0 && errno == EINTR);
+    close(fd);
+    if (n <= 0)
+    {
+        return HTTP_POST_RETRY;
+    }
+    response[n] = '\0';
+    if (sscanf(response, "HTTP/%*s %d", status) != 1)
+    {
+        *status = INICIAL_VALUE;
+        return HTTP_POST_RETRY;
+    }
+    if (*status >= 200 && *status < 300)
+    {
+        return HTTP_POST_OK;
+    }
+    return *status == 429 || *status >= 500 ? HTTP_POST_RETRY : HTTP_POST_REJECTED;
+}
@@ -0,0 +1,808 @@
+/**
+ * @file http_lite.c
+ * @brief Servidor HTTP/1.1 de un solo hilo para la exposición sin microhttpd.
+ *
+ * El hilo espera con poll() sobre el socket de escucha, un pipe para detenerlo y las conexiones abiertas. Los bytes
+ * que llegan se acumulan en el buffer de la conexión hasta completar los encabezados; la petición se parte en el
+ * mismo buffer (terminando cadenas en su lugar) y se pasa al manejador, que responde con MHD_queue_response() antes
+ * de volver. Lo que sobra en el buffer es la siguiente petición de un cliente que encadena pedidos.
+ */
+
+#include "http_lite.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <poll.h>
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <sys/time.h>
+#include <time.h>
+#include <unistd.h>
+
+/**
+ * @brief Tamaño máximo de la línea de petición más los encabezados.
+ */
+#define HTTP_LITE_REQUEST_SIZE 8192
+
+/**
+ * @brief Encabezados y argumentos que se guardan por petición; los demás se ignoran.
+ */
+#define HTTP_LITE_MAX_VALUES 32
+
+/**
+ * @brief Tamaño de los encabezados agregados a una respuesta.
+ */
+#define HTTP_LITE_HEADERS_SIZE 1024
+
+/**
+ * @brief Valores por defecto de las opciones de MHD_start_daemon().
+ */
+#define HTTP_LITE_DEFAULT_LIMIT 64
+#define HTTP_LITE_DEFAULT_BACKLOG 64
+
+/**
+ * @brief Período con el que el hilo revisa los timeouts aunque no haya actividad, en milisegundos.
+ */
+#define HTTP_LITE_POLL_MS 1000
+
+/**
+ * @brief Encabezado o argumento de la petición en curso, apuntando al buffer de la conexión.
+ */
+typedef struct
+{
+    enum MHD_ValueKind kind; ///< Encabezado o argumento.
+    const char* key;         ///< Nombre.
+    const char* value;       ///< Valor.
+} http_lite_value_t;
+
+struct MHD_Connection
+{
+    int fd;                                         ///< Socket, o -1 si la ranura está libre.
+    char buffer[HTTP_LITE_REQUEST_SIZE + 1];        ///< Bytes recibidos y todavía no atendidos.
+    size_t len;                                     ///< Bytes válidos de buffer.
+    long long last_ms;                              ///< Última actividad, para el timeout.
+    int keep_alive;                                 ///< 1 si la conexión sigue abierta después de responder.
+    int queued;                                     ///< 1 si el manejador ya respondió la petición en curso.
+    http_lite_value_t values[HTTP_LITE_MAX_VALUES]; ///< Encabezados y argumentos de la petición en curso.
+    int value_count;                                ///< Valores válidos.
+};
+
+struct MHD_Response
+{
+    char* body;                           ///< Copia del cuerpo, o NULL si está vacío.
+    size_t size;                          ///< Tamaño del cuerpo.
+    char headers[HTTP_LITE_HEADERS_SIZE]; ///< Encabezados agregados, ya con "\r\n".
+    size_t headers_len;                   ///< Bytes válidos de headers.
+};
+
+struct MHD_Daemon
+{
+    int listen_fd;                     ///< Socket de escucha.
+    int wake[2];                       ///< Pipe con el que MHD_stop_daemon() despierta al hilo.
+    pthread_t thread;                  ///< Hilo del servidor.
+    MHD_AccessHandlerCallback handler; ///< Manejador de peticiones.
+    void* handler_cls;                 ///< Argumento del manejador.
+    unsigned int flags;                ///< Banderas MHD_USE_*.
+    uint16_t port;                     ///< Puerto si no se pasó dirección.
+    const struct sockaddr* address;    ///< Dirección pasada con MHD_OPTION_SOCK_ADDR, o NULL.
+    int timeout_s;                     ///< Segundos de inactividad, o 0 sin límite.
+    int backlog;                       ///< Cola de conexiones pendientes.
+    int limit;                         ///< Conexiones simultáneas.
+    struct MHD_Connection* conns;      ///< Ranuras de conexión.
+};
+
+/**
+ * @brief Devuelve el instante de CLOCK_MONOTONIC en milisegundos.
+ */
+static long long now_ms(void)
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (long long)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+/**
+ * @brief Aplica una opción de MHD_start_daemon().
+ *
+ * @return 0 en caso de éxito, -1 si la opción no se conoce.
+ */
+static int apply_option(struct MHD_Daemon* daemon, enum MHD_OPTION option, intptr_t value, void* ptr_value)
+{
+    switch (option)
+    {
+    case MHD_OPTION_CONNECTION_LIMIT:
+        daemon->limit = value > 0 ? (int)value : daemon->limit;
+        return 0;
+    case MHD_OPTION_CONNECTION_TIMEOUT:
+        daemon->timeout_s = value > 0 ? (int)value : 0;
+        return 0;
+    case MHD_OPTION_SOCK_ADDR:
+        daemon->address = ptr_value;
+        return 0;
+    case MHD_OPTION_LISTEN_BACKLOG_SIZE:
+        daemon->backlog = value > 0 ? (int)value : daemon->backlog;
+        return 0;
+    case MHD_OPTION_THREAD_POOL_SIZE:
+        return 0;
+    case MHD_OPTION_ARRAY:
+        for (const struct MHD_OptionItem* item = ptr_value; item != NULL && item->option != MHD_OPTION_END; item++)
+        {
+            if (item->option == MHD_OPTION_ARRAY || apply_option(daemon, item->option, item->value,
+                                                                 item->ptr_value) != 0)
+            {
+                return -1;
+            }
+        }
+        return 0;
+    default:
+        fprintf(stderr, "Opción del servidor HTTP no soportada: %d\n", (int)option);
+        return -1;
+    }
+}
+
+/**
+ * @brief Lee las opciones variádicas de MHD_start_daemon(); cada una lleva un argumento con el tipo de microhttpd.
+ *
+ * @return 0 en caso de éxito, -1 si alguna no se conoce (no se puede seguir leyendo la lista).
+ */
+static int read_options(struct MHD_Daemon* daemon, va_list ap)
+{
+    for (;;)
+    {
+        enum MHD_OPTION option = va_arg(ap, int);
+        switch (option)
+        {
+        case MHD_OPTION_END:
+            return 0;
+        case MHD_OPTION_SOCK_ADDR:
+        case MHD_OPTION_ARRAY:
+            if (apply_option(daemon, option, 0, va_arg(ap, void*)) != 0)
+            {
+                return -1;
+            }
+            break;
+        case MHD_OPTION_CONNECTION_LIMIT:
+        case MHD_OPTION_CONNECTION_TIMEOUT:
+        case MHD_OPTION_THREAD_POOL_SIZE:
+        case MHD_OPTION_LISTEN_BACKLOG_SIZE:
+            apply_option(daemon, option, va_arg(ap, unsigned int), NULL);
+            break;
+        default:
+            return apply_option(daemon, option, 0, NULL);
+        }
+    }
+}
+
+/**
+ * @brief Abre el socket de escucha del servidor.
+ *
+ * @return 0 en caso de éxito, -1 en caso de error.
+ */
+static int open_listener(struct MHD_Daemon* daemon)
+{
+    struct sockaddr_storage address = {0};
+    socklen_t length;
+    if (daemon->address != NULL)
+    {
+        length = daemon->address->sa_family == AF_INET6 ? sizeof(struct sockaddr_in6) : sizeof(struct sockaddr_in);
+        memcpy(&address, daemon->address, length);
+    }
+    else if (daemon->flags & MHD_USE_DUAL_STACK)
+    {
+        struct sockaddr_in6* in6 = (struct sockaddr_in6*)&address;
+        in6->sin6_family = AF_INET6;
+        in6->sin6_addr = in6addr_any;
+        in6->sin6_port = htons(daemon->port);
+        length = sizeof(*in6);
+    }
+    else
+    {
+        struct sockaddr_in* in = (struct sockaddr_in*)&address;
+        in->sin_family = AF_INET;
+        in->sin_addr.s_addr = htonl(INADDR_ANY);
+        in->sin_port = htons(daemon->port);
+        length = sizeof(*in);
+    }
+
+    daemon->listen_fd = socket(address.ss_family, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (daemon->listen_fd < 0)
+    {
+        perror("Error al crear el socket HTTP");
+        return -1;
+    }
+    int on = 1;
+    setsockopt(daemon->listen_fd, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+    if (address.ss_family == AF_INET6)
+    {
+        // Con doble pila "::" atiende también IPv4 con direcciones mapeadas
+        int v6only = (daemon->flags & MHD_USE_DUAL_STACK) ? 0 : 1;
+        setsockopt(daemon->listen_fd, IPPROTO_IPV6, IPV6_V6ONLY, &v6only, sizeof(v6only));
+    }
+    if (bind(daemon->listen_fd, (struct sockaddr*)&address, length) != 0 ||
+        listen(daemon->listen_fd, daemon->backlog) != 0)
+    {
+        perror("Error al abrir el puerto HTTP");
+        close(daemon->listen_fd);
+        daemon->listen_fd = -1;
+        return -1;
+    }
+    return 0;
+}
+
+/**
+ * @brief Cierra una conexión y libera su ranura.
+ */
+static void close_connection(struct MHD_Connection* conn)
+{
+    close(conn->fd);
+    conn->fd = -1;
+    conn->len = 0;
+}
+
+/**
+ * @brief Agrega un valor a la petición en curso si queda lugar.
+ */
+static void add_value(struct MHD_Connection* conn, enum MHD_ValueKind kind, const char* key, const char* value)
+{
+    if (conn->value_count < HTTP_LITE_MAX_VALUES)
+    {
+        conn->values[conn->value_count].kind = kind;
+        conn->values[conn->value_count].key = key;
+        conn->values[conn->value_count].value = value;
+        conn->value_count++;
+    }
+}
+
+/**
+ * @brief Decodifica en su lugar el "%XX" y el '+' de un componente de la URL.
+ */
+static void url_decode(char* text)
+{
+    char* out = text;
+    for (char* in = text; *in != '\0'; in++)
+    {
+        unsigned int byte;
+        if (*in == '%' && in[1] != '\0' && in[2] != '\0' && sscanf(in + 1, "%2x", &byte) == 1)
+        {
+            *out++ = (char)byte;
+            in += 2;
+        }
+        else
+        {
+            *out++ = *in == '+' ? ' ' : *in;
+        }
+    }
+    *out = '\0';
+}
+
+/**
+ * @brief Separa los argumentos de la URL ("a=1&b=2") en su lugar.
+ */
+static void parse_arguments(struct MHD_Connection* conn, char* query)
+{
+    char* save;
+    for (char* pair = strtok_r(query, "&", &save); pair != NULL; pair = strtok_r(NULL, "&", &save))
+    {
+        char* value = strchr(pair, '=');
+        if (value != NULL)
+        {
+            *value++ = '\0';
+        }
+        url_decode(pair);
+        if (value != NULL)
+        {
+            url_decode(value);
+        }
+        add_value(conn, MHD_GET_ARGUMENT_KIND, pair, value != NULL ? value : "");
+    }
+}
+
+/**
+ * @brief Quita los espacios y tabuladores de ambos extremos de un texto, en su lugar.
+ */
+static char* trim(char* text)
+{
+    while (*text == ' ' || *text == '\t')
+    {
+        text++;
+    }
+    size_t len = strlen(text);
+    while (len > 0 && (text[len - 1] == ' ' || text[len - 1] == '\t'))
+    {
+        text[--len] = '\0';
+    }
+    return text;
+}
+
+/**
+ * @brief Indica si una lista separada por comas ("keep-alive, Upgrade") contiene un elemento, sin importar mayúsculas.
+ */
+static int has_token(const char* list, const char* token)
+{
+    size_t len = strlen(token);
+    for (const char* p = list; *p != '\0'; p += strspn(p, ", \t"))
+    {
+        size_t n = strcspn(p, ",");
+        while (n > 0 && (p[n - 1] == ' ' || p[n - 1] == '\t'))
+        {
+            n--;
+        }
+        if (n == len && strncasecmp(p, token, len) == 0)
+        {
+            return 1;
+        }
+        p += strcspn(p, ",");
+    }
+    return 0;
+}
+
+/**
+ * @brief Responde con un error y marca la conexión para cerrarse.
+ */
+static void reject(struct MHD_Connection* conn, unsigned int status)
+{
+    conn->keep_alive = 0;
+    struct MHD_Response* response = MHD_create_response_from_buffer(0, NULL, MHD_RESPMEM_PERSISTENT);
+    if (response != NULL)
+    {
+        MHD_queue_response(conn, status, response);
+        MHD_destroy_response(response);
+    }
+}
+
+/**
+ * @brief Parte una petición completa en su lugar y la pasa al manejador.
+ *
+ * @param daemon Servidor.
+ * @param conn Conexión.
+ * @param head Línea de petición y encabezados, terminados en '\0' donde estaba la línea vacía.
+ * @return 0 si la conexión sigue abierta, -1 si hay que cerrarla.
+ */
+static int handle_request(struct MHD_Daemon* daemon, struct MHD_Connection* conn, char* head)
+{
+    conn->value_count = 0;
+    conn->queued = 0;
+    conn->keep_alive = 0;
+
+    char* save;
+    char* rest;
+    char* line = strtok_r(head, "\r\n", &save);
+    char* method = line != NULL ? strtok_r(line, " ", &rest) : NULL;
+    char* url = method != NULL ? strtok_r(NULL, " ", &rest) : NULL;
+    char* version = url != NULL ? strtok_r(NULL, " ", &rest) : NULL;
+    if (version == NULL || strncmp(version, "HTTP/1.", 7) != 0)
+    {
+        reject(conn, MHD_HTTP_BAD_REQUEST);
+        return -1;
+    }
+
+    // HTTP/1.1 mantiene la conexión salvo "Connection: close"; HTTP/1.0 la cierra salvo "keep-alive"
+    int keep_alive = strcmp(version, "HTTP/1.1") == 0;
+    int has_body = 0;
+    for (char* header = strtok_r(NULL, "\r\n", &save); header != NULL; header = strtok_r(NULL, "\r\n", &save))
+    {
+        char* value = strchr(header, ':');
+        if (value == NULL)
+        {
+            continue;
+        }
+        *value++ = '\0';
+        value = trim(value);
+        if (strcasecmp(header, "Connection") == 0)
+        {
+            if (has_token(value, "close"))
+            {
+                keep_alive = 0;
+            }
+            else if (has_token(value, "keep-alive"))
+            {
+                keep_alive = 1;
+            }
+        }
+        else if ((strcasecmp(header, "Content-Length") == 0 && strtoull(value, NULL, 10) > 0) ||
+                 strcasecmp(header, "Transfer-Encoding") == 0)
+        {
+            has_body = 1;
+        }
+        add_value(conn, MHD_HEADER_KIND, header, value);
+    }
+    if (has_body)
+    {
+        // El monitor solo atiende GET: un cuerpo no se lee y dejaría la conexión desincronizada
+        reject(conn, MHD_HTTP_BAD_REQUEST);
+        return -1;
+    }
+
+    char* query = strchr(url, '?');
+    if (query != NULL)
+    {
+        *query++ = '\0';
+        parse_arguments(conn, query);
+    }
+    url_decode(url);
+
+    conn->keep_alive = keep_alive;
+    size_t upload_size = 0;
+    void* con_cls = NULL;
+    enum MHD_Result ret =
+        daemon->handler(daemon->handler_cls, conn, url, method, version, NULL, &upload_size, &con_cls);
+    if (ret != MHD_YES || !conn->queued)
+    {
+        return -1;
+    }
+    return conn->keep_alive ? 0 : -1;
+}
+
+/**
+ * @brief Lee lo disponible en una conexión y atiende todas las peticiones completas.
+ *
+ * @return 0 si la conexión sigue abierta, -1 si hay que cerrarla.
+ */
+static int serve_connection(struct MHD_Daemon* daemon, struct MHD_Connection* conn)
+{
+    ssize_t n = recv(conn->fd, conn->buffer + conn->len, HTTP_LITE_REQUEST_SIZE - conn->len, MSG_DONTWAIT);
+    if (n <= 0)
+    {
+        return n < 0 && (errno == EAGAIN || errno == EINTR) ? 0 : -1;
+    }
+    conn->len += (size_t)n;
+    conn->buffer[conn->len] = '\0';
+    conn->last_ms = now_ms();
+
+    for (;;)
+    {
+        char* end = strstr(conn->buffer, "\r\n\r\n");
+        if (end == NULL)
+        {
+            if (conn->len == HTTP_LITE_REQUEST_SIZE || strlen(conn->buffer) != conn->len)
+            {
+                // Encabezados demasiado largos o un '\0' en la petición
+                reject(conn, MHD_HTTP_BAD_REQUEST);
+                return -1;
+            }
+            return 0;
+        }
+        end[2] = '\0';
+        size_t used = (size_t)(end + 4 - conn->buffer);
+        if (handle_request(daemon, conn, conn->buffer) != 0)
+        {
+            return -1;
+        }
+        memmove(conn->buffer, conn->buffer + used, conn->len - used + 1);
+        conn->len -= used;
+    }
+}
+
+/**
+ * @brief Acepta una conexión pendiente en una ranura libre.
+ */
+static void accept_connection(struct MHD_Daemon* daemon)
+{
+    int fd = accept(daemon->listen_fd, NULL, NULL);
+    if (fd < 0)
+    {
+        return;
+    }
+    fcntl(fd, F_SETFD, FD_CLOEXEC);
+    for (int i = 0; i < daemon->limit; i++)
+    {
+        if (daemon->conns[i].fd < 0)
+        {
+            // Un cliente que deja de leer no puede retener al único hilo más que el timeout
+            if (daemon->timeout_s > 0)
+            {
+                struct timeval tv = {.tv_sec = daemon->timeout_s};
+                setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &tv, sizeof(tv));
+            }
+            daemon->conns[i].fd = fd;
+            daemon->conns[i].len = 0;
+            daemon->conns[i].last_ms = now_ms();
+            return;
+        }
+    }
+    close(fd);
+}
+
+/**
+ * @brief Hilo del servidor.
+ */
+static void* server_main(void* arg)
+{
+    struct MHD_Daemon* daemon = arg;
+    struct pollfd* fds = malloc((size_t)(daemon->limit + 2) * sizeof(*fds));
+    int* slots = malloc((size_t)daemon->limit * sizeof(*slots));
+    if (fds == NULL || slots == NULL)
+    {
+        perror("Error al asignar memoria");
+        free(fds);
+        free(slots);
+        return NULL;
+    }
+
+    for (;;)
+    {
+        int nfds = 0;
+        int open = 0;
+        fds[nfds++] = (struct pollfd){.fd = daemon->wake[0], .events = POLLIN};
+        for (int i = 0; i < daemon->limit; i++)
+        {
+            if (daemon->conns[i].fd >= 0)
+            {
+                slots[open++] = i;
+                fds[nfds++] = (struct pollfd){.fd = daemon->conns[i].fd, .events = POLLIN};
+            }
+        }
+        // Con todas las ranuras ocupadas las conexiones nuevas esperan en la cola de listen()
+        int listening = open < daemon->limit;
+        if (listening)
+        {
+            fds[nfds++] = (struct pollfd){.fd = daemon->listen_fd, .events = POLLIN};
+        }
+
+        if (poll(fds, (nfds_t)nfds, HTTP_LITE_POLL_MS) < 0 && errno != EINTR)
+        {
+            perror("Error en poll del servidor HTTP");
+            break;
+        }
+        if (fds[0].revents != 0)
+        {
+            break;
+        }
+
+        long long now = now_ms();
+        for (int k = 0; k < open; k++)
+        {
+            struct MHD_Connection* conn = &daemon->conns[slots[k]];
+            if (fds[k + 1].revents != 0 && serve_connection(daemon, conn) != 0)
+            {
+                close_connection(conn);
+            }
+            else if (daemon->timeout_s > 0 && now - conn->last_ms > (long long)daemon->timeout_s * 1000)
+            {
+                close_connection(conn);
+            }
+        }
+        if (listening && fds[nfds - 1].revents & POLLIN)
+        {
+            accept_connection(daemon);
+        }
+    }
+
+    free(fds);
+    free(slots);
+    return NULL;
+}
+
+struct MHD_Daemon* MHD_start_daemon(unsigned int flags, uint16_t port, MHD_AcceptPolicyCallback apc, void* apc_cls,
+                                    MHD_AccessHandlerCallback dh, void* dh_cls, ...)
+{
+    (void)apc;
+    (void)apc_cls;
+    if (dh == NULL)
+    {
+        return NULL;
+    }
+
+    struct MHD_Daemon* daemon = calloc(1, sizeof(*daemon));
+    if (daemon == NULL)
+    {
+        perror("Error al asignar memoria");
+        return NULL;
+    }
+    daemon->handler = dh;
+    daemon->handler_cls = dh_cls;
+    daemon->flags = flags;
+    daemon->port = port;
+    daemon->limit = HTTP_LITE_DEFAULT_LIMIT;
+    daemon->backlog = HTTP_LITE_DEFAULT_BACKLOG;
+    daemon->listen_fd = -1;
+    daemon->wake[0] = daemon->wake[1] = -1;
+
+    va_list ap;
+    va_start(ap, dh_cls);
+    int ok = read_options(daemon, ap) == 0;
+    va_end(ap);
+
+    daemon->conns = ok ? malloc((size_t)daemon->limit * sizeof(*daemon->conns)) : NULL;
+    if (daemon->conns == NULL || open_listener(daemon) != 0 || pipe(daemon->wake) != 0)
+    {
+        if (daemon->listen_fd >= 0)
+        {
+            close(daemon->listen_fd);
+        }
+        free(daemon->conns);
+        free(daemon);
+        return NULL;
+    }
+    fcntl(daemon->wake[0], F_SETFD, FD_CLOEXEC);
+    fcntl(daemon->wake[1], F_SETFD, FD_CLOEXEC);
+    for (int i = 0; i < daemon->limit; i++)
+    {
+        daemon->conns[i].fd = -1;
+    }
+
+    if (pthread_create(&daemon->thread, NULL, server_main, daemon) != 0)
+    {
+        fprintf(stderr, "Error al crear el hilo del servidor HTTP\n");
+        close(daemon->wake[0]);
+        close(daemon->wake[1]);
+        close(daemon->listen_fd);
+        free(daemon->conns);
+        free(daemon);
+        return NULL;
+    }
+    return daemon;
+}
+
+void MHD_stop_daemon(struct MHD_Daemon* daemon)
+{
+    if (daemon == NULL)
+    {
+        return;
+    }
+    ssize_t n = write(daemon->wake[1], "x", 1);
+    (void)n;
+    pthread_join(daemon->thread, NULL);
+
+    for (int i = 0; i < daemon->limit; i++)
+    {
+        if (daemon->conns[i].fd >= 0)
+        {
+            close_connection(&daemon->conns[i]);
+        }
+    }
+    close(daemon->wake[0]);
+    close(daemon->wake[1]);
+    close(daemon->listen_fd);
+    free(daemon->conns);
+    free(daemon);
+}
+
+struct MHD_Response* MHD_create_response_from_buffer(size_t size, void* buffer, enum MHD_ResponseMemoryMode mode)
+{
+    struct MHD_Response* response = calloc(1, sizeof(*response));
+    if (response == NULL)
+    {
+        return NULL;
+    }
+    if (size > 0)
+    {
+        response->body = malloc(size);
+        if (response->body == NULL)
+        {
+            free(response);
+            return NULL;
+        }
+        memcpy(response->body, buffer, size);
+        response->size = size;
+    }
+    // Con MHD_RESPMEM_MUST_FREE la respuesta asume el buffer: ya copiado, se libera acá
+    if (mode == MHD_RESPMEM_MUST_FREE)
+    {
+        free(buffer);
+    }
+    return response;
+}
+
+enum MHD_Result MHD_add_response_header(struct MHD_Response* response, const char* header, const char* content)
+{
+    if (response == NULL || header == NULL || content == NULL || strpbrk(header, "\r\n:") != NULL ||
+        strpbrk(content, "\r\n") != NULL)
+    {
+        return MHD_NO;
+    }
+    size_t room = sizeof(response->headers) - response->headers_len;
+    int n = snprintf(response->headers + response->headers_len, room, "%s: %s\r\n", header, content);
+    if (n < 0 || (size_t)n >= room)
+    {
+        response->headers[response->headers_len] = '\0';
+        return MHD_NO;
+    }
+    response->headers_len += (size_t)n;
+    return MHD_YES;
+}
+
+/**
+ * @brief Devuelve la frase de un código de estado.
+ */
+static const char* reason_phrase(unsigned int status)
+{
+    switch (status)
+    {
+    case MHD_HTTP_OK:
+        return "OK";
+    case MHD_HTTP_NOT_MODIFIED:
+        return "Not Modified";
+    case MHD_HTTP_BAD_REQUEST:
+        return "Bad Request";
+    case MHD_HTTP_SERVICE_UNAVAILABLE:
+        return "Service Unavailable";
+    default:
+        return "Unknown";
+    }
+}
+
+/**
+ * @brief Escribe un buffer entero en un socket.
+ *
+ * @return 0 en caso de éxito, -1 si el socket falló o venció el timeout de envío.
+ */
+static int send_all(int fd, const char* data, size_t len)
+{
+    while (len > 0)
+    {
+        ssize_t n = send(fd, data, len, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR)
+        {
+            continue;
+        }
+        if (n <= 0)
+        {
+            return -1;
+        }
+        data += n;
+        len -= (size_t)n;
+    }
+    return 0;
+}
+
+enum MHD_Result MHD_queue_response(struct MHD_Connection* connection, unsigned int status_code,
+                                   struct MHD_Response* response)
+{
+    if (connection == NULL || response == NULL || connection->queued)
+    {
+        return MHD_NO;
+    }
+    connection->queued = 1;
+
+    // Un 304 no lleva cuerpo ni Content-Length: el del 200 que reemplaza sigue siendo el válido
+    char head[HTTP_LITE_HEADERS_SIZE + 256];
+    int n = snprintf(head, sizeof(head), "HTTP/1.1 %u %s\r\n", status_code, reason_phrase(status_code));
+    if (status_code != MHD_HTTP_NOT_MODIFIED)
+    {
+        n += snprintf(head + n, sizeof(head) - (size_t)n, "Content-Length: %zu\r\n", response->size);
+    }
+    n += snprintf(head + n, sizeof(head) - (size_t)n, "%s%s\r\n",
+                  connection->keep_alive ? "" : "Connection: close\r\n", response->headers);
+
+    if (send_all(connection->fd, head, (size_t)n) != 0 ||
+        (status_code != MHD_HTTP_NOT_MODIFIED && send_all(connection->fd, response->body, response->size) != 0))
+    {
+        connection->keep_alive = 0;
+        return MHD_NO;
+    }
+    return MHD_YES;
+}
+
+void MHD_destroy_response(struct MHD_Response* response)
+{
+    if (response != NULL)
+    {
+        free(response->body);
+        free(response);
+    }
+}
+
+const char* MHD_lookup_connection_value(struct MHD_Connection* connection, enum MHD_ValueKind kind, const char* key)
+{
+    for (int i = 0; connection != NULL && key != NULL && i < connection->value_count; i++)
+    {
+        const http_lite_value_t* value = &connection->values[i];
+        if (value->kind == kind &&
+            (kind == MHD_HEADER_KIND ? strcasecmp(value->key, key) : strcmp(value->key, key)) == 0)
+        {
+            return value->value;
+        }
+    }
+    return NULL;
+}
+
+enum MHD_Result MHD_is_feature_supported(enum MHD_FEATURE feature)
+{
+    (void)feature;
+    return MHD_NO;
+}
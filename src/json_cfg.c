@@ -1,43 +1,66 @@
 #include "json_cfg.h"
+#include "adaptive.h"
+#include "aggregator.h"
+#include "alert.h"
+#include "cgroup_stats.h"
+#include "collector.h"
+#include "diskstats.h"
+#include "fs_stats.h"
+#include "memstat.h"
+#include "metric_registry.h"
+#include "netdev.h"
+#include "proctable.h"
+#include <errno.h>
+#include <limits.h>
+#include <poll.h>
+#include <sys/inotify.h>
+#include <sys/stat.h>
+#include <unistd.h>
 
 /**
- * @brief Bandera para el monitoreo del ancho de banda.
- *
- * Esta variable se utiliza para habilitar o deshabilitar el monitoreo
- * del uso del ancho de banda en la configuración.
+ * @brief Milisegundos por segundo, para convertir sampling_interval.
  */
-bool flag_bandwidth = true;
+#define MS_PER_SECOND 1000
 
 /**
- * @brief Bandera para el monitoreo del uso de CPU.
+ * @brief Eventos de inotify sobre el directorio que pueden indicar un cambio del archivo.
  *
- * Esta variable se utiliza para habilitar o deshabilitar el monitoreo
- * del uso de CPU en la configuración.
+ * Se vigila el directorio y no el archivo porque los editores suelen reemplazarlo con un rename.
  */
-bool flag_cpu = true;
+#define CONFIG_WATCH_EVENTS (IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_ATTRIB)
 
 /**
- * @brief Bandera para el monitoreo del uso de disco.
- *
- * Esta variable se utiliza para habilitar o deshabilitar el monitoreo
- * del uso del disco en la configuración.
+ * @brief Descriptor de inotify, o -1 si se usa la comparación de mtime y tamaño.
  */
-bool flag_disk = true;
+static int inotify_fd = -1;
 
 /**
- * @brief Bandera para indicar cambios en la configuración.
- *
- * Esta variable se utiliza para señalar si ha habido cambios en
- * la configuración que deben ser procesados.
+ * @brief Ruta del archivo vigilado.
+ */
+static char *watch_path = NULL;
+
+/**
+ * @brief Nombre del archivo vigilado dentro de su directorio.
  */
-bool flag_change = true;
+static const char *watch_name = NULL;
 
-int read_sampling_interval(const char *file_path) {
+/**
+ * @brief Último estado conocido del archivo vigilado.
+ */
+static struct stat watch_stat;
+
+/**
+ * @brief Lee y parsea un archivo JSON.
+ *
+ * @param file_path Ruta al archivo.
+ * @return Documento parseado (liberar con cJSON_Delete), o NULL en caso de error.
+ */
+static cJSON *parse_json_file(const char *file_path) {
     // Abrir el archivo JSON
     FILE *file = fopen(file_path, "r");
     if (!file) {
         perror("Error al abrir el archivo");
-        return -1;
+        return NULL;
     }
 
     // Leer el contenido del archivo
@@ -49,7 +72,7 @@ int read_sampling_interval(const char *file_path) {
     if (!json_content) {
         perror("Error al asignar memoria");
         fclose(file);
-        return -1;
+        return NULL;
     }
 
     fread(json_content, 1, file_size, file);
@@ -61,96 +84,563 @@ int read_sampling_interval(const char *file_path) {
     free(json_content);
     if (!json) {
         fprintf(stderr, "Error al parsear el JSON: %s\n", cJSON_GetErrorPtr());
+    }
+    return json;
+}
+
+/**
+ * @brief Copia los textos de un array JSON.
+ *
+ * @param array Array JSON (se ignoran los elementos que no son texto).
+ * @param max Cantidad máxima de elementos a copiar.
+ * @param count Cantidad de elementos copiados.
+ * @return Copias reservadas con malloc, o NULL si no hay ninguna.
+ */
+static char **copy_strings(const cJSON *array, int max, int *count) {
+    *count = 0;
+    if (!cJSON_IsArray(array)) {
+        return NULL;
+    }
+
+    int size = cJSON_GetArraySize(array);
+    size = size < max ? size : max;
+    char **strings = size > 0 ? calloc((size_t)size, sizeof(*strings)) : NULL;
+    if (!strings) {
+        return NULL;
+    }
+
+    const cJSON *item;
+    cJSON_ArrayForEach(item, array) {
+        if (*count < size && cJSON_IsString(item) && (strings[*count] = strdup(item->valuestring)) != NULL) {
+            (*count)++;
+        }
+    }
+    return strings;
+}
+
+/**
+ * @brief Nombres que aceptaba "metrics" antes del registro; los tres primeros también habilitaban el último.
+ */
+static const char *const legacy_metrics[] = {"bandwith_usage", "cpu_usage_porcentage", "disk_usage_porcentage",
+                                             "change_contexts"};
+
+/**
+ * @brief Cantidad de nombres de legacy_metrics.
+ */
+#define LEGACY_METRICS_COUNT ((int)(sizeof(legacy_metrics) / sizeof(legacy_metrics[0])))
+
+/**
+ * @brief Calcula las métricas habilitadas por la lista "metrics".
+ *
+ * Una lista con nombres, alias o patrones habilita solo las métricas que coinciden. Una lista que solo nombra
+ * métricas de legacy_metrics tiene el formato original: ahí esas cuatro son interruptores y las demás métricas
+ * quedan habilitadas, como antes, así que un config.json viejo no pierde los colectores agregados después.
+ *
+ * @param metrics Lista de config.json.
+ * @param count Cantidad de elementos.
+ * @return Máscara de metric_registry.h.
+ */
+static unsigned long long metrics_mask(const char *const *metrics, int count) {
+    unsigned long long listed = metric_registry_match(metrics, count);
+    int legacy = count > 0;
+    for (int i = 0; i < count && legacy; i++) {
+        legacy = 0;
+        for (int l = 0; l < LEGACY_METRICS_COUNT; l++) {
+            legacy |= strcmp(metrics[i], legacy_metrics[l]) == 0;
+        }
+    }
+    if (!legacy) {
+        return listed;
+    }
+
+    if (listed & metric_registry_match(legacy_metrics, LEGACY_METRICS_COUNT - 1)) {
+        listed |= metric_registry_match(&legacy_metrics[LEGACY_METRICS_COUNT - 1], 1);
+    }
+    return (METRIC_REGISTRY_ALL & ~metric_registry_match(legacy_metrics, LEGACY_METRICS_COUNT)) | listed;
+}
+
+/**
+ * @brief Lee y parsea el archivo de configuración una sola vez.
+ *
+ * @param file_path Ruta al archivo JSON.
+ * @param config Configuración a completar.
+ * @return 0 en caso de éxito, -1 en caso de error.
+ */
+int config_load(const char *file_path, Config *config) {
+    memset(config, 0, sizeof(*config));
+    config->sampling_interval = -1;
+    config->sampling_interval_ms = -1;
+
+    cJSON *json = parse_json_file(file_path);
+    if (!json) {
         return -1;
     }
 
-    // Obtener el valor de "sampling_interval"
-    cJSON *sampling_interval = cJSON_GetObjectItemCaseSensitive(json, "sampling_interval");
-    if (!cJSON_IsNumber(sampling_interval)) {
+    // Sin "metrics" se recolecta todo; cada elemento habilita las métricas cuyo nombre coincide ("memory_*" vale)
+    cJSON *metrics = cJSON_GetObjectItemCaseSensitive(json, "metrics");
+    if (metrics == NULL) {
+        config->enabled = METRIC_REGISTRY_ALL;
+    } else if (!cJSON_IsArray(metrics)) {
+        fprintf(stderr, "'metrics' no es un array válido; se recolectan todas las métricas\n");
+        config->enabled = METRIC_REGISTRY_ALL;
+    } else {
+        config->metrics = copy_strings(metrics, INT_MAX, &config->metrics_count);
+        config->enabled = metrics_mask((const char *const *)config->metrics, config->metrics_count);
+    }
+
+    // Intervalo de muestreo: "sampling_interval_ms" o "sampling_interval" en segundos (se acepta 0.5)
+    cJSON *interval_ms = cJSON_GetObjectItemCaseSensitive(json, "sampling_interval_ms");
+    cJSON *interval_s = cJSON_GetObjectItemCaseSensitive(json, "sampling_interval");
+    if (cJSON_IsNumber(interval_s)) {
+        config->sampling_interval = interval_s->valueint;
+    }
+    if (cJSON_IsNumber(interval_ms)) {
+        config->sampling_interval_ms = interval_ms->valueint;
+    } else if (cJSON_IsNumber(interval_s)) {
+        config->sampling_interval_ms = (int)(interval_s->valuedouble * MS_PER_SECOND);
+    } else {
         fprintf(stderr, "El valor de 'sampling_interval' no es válido\n");
-        cJSON_Delete(json);
-        return -1;
+    }
+    if (config->sampling_interval_ms <= 0) {
+        config->sampling_interval_ms = -1;
+    }
+
+    // Lista opcional de dispositivos de bloque permitidos (patrones fnmatch)
+    config->disk_devices = copy_strings(cJSON_GetObjectItemCaseSensitive(json, "disk_devices"), MAX_DISK_ALLOWLIST,
+                                        &config->disk_devices_count);
+
+    // Lista opcional de campos de /proc/meminfo y /proc/vmstat exportados (patrones fnmatch sobre las claves)
+    config->memory_fields = copy_strings(cJSON_GetObjectItemCaseSensitive(json, "memory_fields"),
+                                         MAX_MEMSTAT_ALLOWLIST, &config->memory_fields_count);
+
+    // Puntos de montaje seguidos (patrones fnmatch) y plazo de cada statvfs()
+    config->filesystem_mounts = copy_strings(cJSON_GetObjectItemCaseSensitive(json, "filesystem_mounts"),
+                                             MAX_FS_ALLOWLIST, &config->filesystem_mounts_count);
+    cJSON *fs_timeout = cJSON_GetObjectItemCaseSensitive(json, "filesystem_timeout_ms");
+    config->filesystem_timeout_ms = cJSON_IsNumber(fs_timeout) ? fs_timeout->valueint : 0;
+
+    // Interfaces virtuales incluidas en las métricas de red (por defecto se excluyen lo y veth*)
+    cJSON *include_loopback = cJSON_GetObjectItemCaseSensitive(json, "network_include_loopback");
+    cJSON *include_veth = cJSON_GetObjectItemCaseSensitive(json, "network_include_veth");
+    config->network_include_loopback = cJSON_IsTrue(include_loopback);
+    config->network_include_veth = cJSON_IsTrue(include_veth);
+
+    // Tamaño de los rankings de procesos y profundidad de los cgroups seguidos
+    cJSON *top_n = cJSON_GetObjectItemCaseSensitive(json, "process_top_n");
+    cJSON *cgroup_depth = cJSON_GetObjectItemCaseSensitive(json, "cgroup_depth");
+    config->process_top_n = cJSON_IsNumber(top_n) ? top_n->valueint : 0;
+    config->cgroup_depth = cJSON_IsNumber(cgroup_depth) ? cgroup_depth->valueint : 0;
+
+    // Motor de lectura de /proc/[pid]: "pread" (por defecto) o "io_uring"
+    cJSON *io_engine = cJSON_GetObjectItemCaseSensitive(json, "process_io_engine");
+    if (cJSON_IsString(io_engine)) {
+        if (strcmp(io_engine->valuestring, PROCTABLE_IO_ENGINE_PREAD) == 0 ||
+            strcmp(io_engine->valuestring, PROCTABLE_IO_ENGINE_URING) == 0) {
+            config->process_io_engine = strdup(io_engine->valuestring);
+        } else {
+            fprintf(stderr, "El valor de 'process_io_engine' no es válido: %s\n", io_engine->valuestring);
+        }
+    }
+
+    // Historial en memoria: "history": {"samples": 720, "max_series": 2048, "file": "/var/lib/.../history"}
+    cJSON *history = cJSON_GetObjectItemCaseSensitive(json, "history");
+    if (cJSON_IsObject(history)) {
+        cJSON *samples = cJSON_GetObjectItemCaseSensitive(history, "samples");
+        cJSON *max_series = cJSON_GetObjectItemCaseSensitive(history, "max_series");
+        cJSON *file = cJSON_GetObjectItemCaseSensitive(history, "file");
+        config->history_samples = cJSON_IsNumber(samples) ? samples->valueint : 0;
+        config->history_max_series = cJSON_IsNumber(max_series) ? max_series->valueint : 0;
+        config->history_file = cJSON_IsString(file) ? strdup(file->valuestring) : NULL;
+    }
+
+    // Envío remoto: "push": {"mode": "remote_write", "url": "http://host:9090/api/v1/write", "interval_ms": 1000}
+    cJSON *push = cJSON_GetObjectItemCaseSensitive(json, "push");
+    if (cJSON_IsObject(push)) {
+        cJSON *mode = cJSON_GetObjectItemCaseSensitive(push, "mode");
+        cJSON *url = cJSON_GetObjectItemCaseSensitive(push, "url");
+        cJSON *push_interval = cJSON_GetObjectItemCaseSensitive(push, "interval_ms");
+        cJSON *queue_size = cJSON_GetObjectItemCaseSensitive(push, "queue_size");
+        cJSON *max_batch = cJSON_GetObjectItemCaseSensitive(push, "max_batch");
+        config->push_mode = cJSON_IsString(mode) ? strdup(mode->valuestring) : NULL;
+        config->push_url = cJSON_IsString(url) ? strdup(url->valuestring) : NULL;
+        config->push_interval_ms = cJSON_IsNumber(push_interval) ? push_interval->valueint : 0;
+        config->push_queue_size = cJSON_IsNumber(queue_size) ? queue_size->valueint : 0;
+        config->push_max_batch = cJSON_IsNumber(max_batch) ? max_batch->valueint : 0;
+    }
+
+    // Agregador: "aggregator": {"listen": "0.0.0.0:8089", "groups": {"rack-a": ["10.0.1.*"]}, "quantiles": [0.5, 0.99]}
+    cJSON *aggregator = cJSON_GetObjectItemCaseSensitive(json, "aggregator");
+    if (cJSON_IsObject(aggregator)) {
+        cJSON *listen = cJSON_GetObjectItemCaseSensitive(aggregator, "listen");
+        cJSON *group_label = cJSON_GetObjectItemCaseSensitive(aggregator, "group_label");
+        cJSON *groups = cJSON_GetObjectItemCaseSensitive(aggregator, "groups");
+        cJSON *quantiles = cJSON_GetObjectItemCaseSensitive(aggregator, "quantiles");
+        cJSON *agg_interval = cJSON_GetObjectItemCaseSensitive(aggregator, "interval_ms");
+        cJSON *stale = cJSON_GetObjectItemCaseSensitive(aggregator, "stale_ms");
+        config->aggregator_enabled = true;
+        config->aggregator_listen = cJSON_IsString(listen) ? strdup(listen->valuestring) : NULL;
+        config->aggregator_group_label = cJSON_IsString(group_label) ? strdup(group_label->valuestring) : NULL;
+        config->aggregator_interval_ms = cJSON_IsNumber(agg_interval) ? agg_interval->valueint : 0;
+        config->aggregator_stale_ms = cJSON_IsNumber(stale) ? stale->valueint : 0;
+
+        int group_count = cJSON_IsObject(groups) ? cJSON_GetArraySize(groups) : 0;
+        group_count = group_count < AGGREGATOR_MAX_GROUPS ? group_count : AGGREGATOR_MAX_GROUPS;
+        if (group_count > 0) {
+            config->aggregator_groups = calloc((size_t)group_count, sizeof(*config->aggregator_groups));
+        }
+        cJSON *group;
+        if (config->aggregator_groups) {
+            cJSON_ArrayForEach(group, groups) {
+                AggregatorGroup *entry = &config->aggregator_groups[config->aggregator_groups_count];
+                if (config->aggregator_groups_count == group_count || (entry->name = strdup(group->string)) == NULL) {
+                    continue;
+                }
+                entry->hosts = copy_strings(group, AGGREGATOR_MAX_PATTERNS, &entry->hosts_count);
+                config->aggregator_groups_count++;
+            }
+        }
+
+        int quantile_count = cJSON_IsArray(quantiles) ? cJSON_GetArraySize(quantiles) : 0;
+        quantile_count = quantile_count < AGGREGATOR_MAX_QUANTILES ? quantile_count : AGGREGATOR_MAX_QUANTILES;
+        if (quantile_count > 0) {
+            config->aggregator_quantiles = calloc((size_t)quantile_count, sizeof(*config->aggregator_quantiles));
+        }
+        cJSON *quantile;
+        if (config->aggregator_quantiles) {
+            cJSON_ArrayForEach(quantile, quantiles) {
+                if (config->aggregator_quantiles_count < quantile_count && cJSON_IsNumber(quantile)) {
+                    config->aggregator_quantiles[config->aggregator_quantiles_count++] = quantile->valuedouble;
+                }
+            }
+        }
+    }
+
+    // Servidor HTTP: "http": {"bind": "::", "port": 8000, "mode": "epoll", "threads": 2, "connection_timeout_s": 30}
+    cJSON *http = cJSON_GetObjectItemCaseSensitive(json, "http");
+    if (cJSON_IsObject(http)) {
+        cJSON *bind = cJSON_GetObjectItemCaseSensitive(http, "bind");
+        cJSON *port = cJSON_GetObjectItemCaseSensitive(http, "port");
+        cJSON *http_mode = cJSON_GetObjectItemCaseSensitive(http, "mode");
+        cJSON *threads = cJSON_GetObjectItemCaseSensitive(http, "threads");
+        cJSON *timeout = cJSON_GetObjectItemCaseSensitive(http, "connection_timeout_s");
+        cJSON *limit = cJSON_GetObjectItemCaseSensitive(http, "connection_limit");
+        cJSON *backlog = cJSON_GetObjectItemCaseSensitive(http, "backlog");
+        config->http_bind = cJSON_IsString(bind) ? strdup(bind->valuestring) : NULL;
+        config->http_port = cJSON_IsNumber(port) ? port->valueint : 0;
+        config->http_mode = cJSON_IsString(http_mode) ? strdup(http_mode->valuestring) : NULL;
+        config->http_threads = cJSON_IsNumber(threads) ? threads->valueint : 0;
+        config->http_connection_timeout = cJSON_IsNumber(timeout) ? timeout->valueint : 0;
+        config->http_connection_limit = cJSON_IsNumber(limit) ? limit->valueint : 0;
+        config->http_backlog = cJSON_IsNumber(backlog) ? backlog->valueint : 0;
+    }
+
+    // Muestreo adaptativo: "adaptive": {"max_interval_ms": 16000, "rules": {"cpu_*": {"delta": 2, "threshold": 80}}}
+    cJSON *adaptive = cJSON_GetObjectItemCaseSensitive(json, "adaptive");
+    if (cJSON_IsObject(adaptive)) {
+        cJSON *max_interval = cJSON_GetObjectItemCaseSensitive(adaptive, "max_interval_ms");
+        cJSON *rules = cJSON_GetObjectItemCaseSensitive(adaptive, "rules");
+        config->adaptive_max_interval_ms = cJSON_IsNumber(max_interval) ? max_interval->valueint : 0;
+
+        int rule_count = cJSON_IsObject(rules) ? cJSON_GetArraySize(rules) : 0;
+        rule_count = rule_count < MAX_ADAPTIVE_RULES ? rule_count : MAX_ADAPTIVE_RULES;
+        if (rule_count > 0) {
+            config->adaptive_rules = calloc((size_t)rule_count, sizeof(*config->adaptive_rules));
+        }
+        cJSON *rule;
+        if (config->adaptive_rules) {
+            cJSON_ArrayForEach(rule, rules) {
+                AdaptiveRule *entry = &config->adaptive_rules[config->adaptive_rules_count];
+                if (config->adaptive_rules_count == rule_count || (entry->metric = strdup(rule->string)) == NULL) {
+                    continue;
+                }
+                cJSON *delta = cJSON_GetObjectItemCaseSensitive(rule, "delta");
+                cJSON *threshold = cJSON_GetObjectItemCaseSensitive(rule, "threshold");
+                entry->delta = cJSON_IsNumber(delta) ? delta->valuedouble : 0;
+                entry->has_threshold = cJSON_IsNumber(threshold);
+                entry->threshold = entry->has_threshold ? threshold->valuedouble : 0;
+                config->adaptive_rules_count++;
+            }
+        }
+    }
+
+    // Alertas: "alerts": {"webhook": "http://127.0.0.1:9093/hook", "socket": "/run/monitor/alerts.sock",
+    // "rules": {"cpu_high": "cpu_usage_percentage{cpu=\"all\"} > 90 for 5s"}}; en un array, cada regla se llama
+    // como su expresión. Cada regla sigue a lo sumo ALERT_MAX_SERIES series a la vez (ver alert.h)
+    cJSON *alerts = cJSON_GetObjectItemCaseSensitive(json, "alerts");
+    if (cJSON_IsObject(alerts)) {
+        cJSON *webhook = cJSON_GetObjectItemCaseSensitive(alerts, "webhook");
+        cJSON *alert_socket = cJSON_GetObjectItemCaseSensitive(alerts, "socket");
+        cJSON *alert_rules = cJSON_GetObjectItemCaseSensitive(alerts, "rules");
+        config->alert_webhook = cJSON_IsString(webhook) ? strdup(webhook->valuestring) : NULL;
+        config->alert_socket = cJSON_IsString(alert_socket) ? strdup(alert_socket->valuestring) : NULL;
+
+        bool named = cJSON_IsObject(alert_rules);
+        int alert_count = named || cJSON_IsArray(alert_rules) ? cJSON_GetArraySize(alert_rules) : 0;
+        alert_count = alert_count < MAX_ALERT_RULES ? alert_count : MAX_ALERT_RULES;
+        if (alert_count > 0) {
+            config->alert_rules = calloc((size_t)alert_count, sizeof(*config->alert_rules));
+        }
+        cJSON *alert_rule;
+        if (config->alert_rules) {
+            cJSON_ArrayForEach(alert_rule, alert_rules) {
+                AlertRule *entry = &config->alert_rules[config->alert_rules_count];
+                if (config->alert_rules_count == alert_count || !cJSON_IsString(alert_rule)) {
+                    continue;
+                }
+                entry->name = strdup(named ? alert_rule->string : alert_rule->valuestring);
+                entry->expr = strdup(alert_rule->valuestring);
+                if (!entry->name || !entry->expr) {
+                    free(entry->name);
+                    free(entry->expr);
+                    entry->name = entry->expr = NULL;
+                    continue;
+                }
+                config->alert_rules_count++;
+            }
+        }
+    }
+
+    // Intervalo y plazo opcionales por tarea: "collectors": {"cpu": {"interval_ms": 250, "deadline_ms": 200}}
+    cJSON *collectors = cJSON_GetObjectItemCaseSensitive(json, "collectors");
+    int collector_count = cJSON_IsObject(collectors) ? cJSON_GetArraySize(collectors) : 0;
+    if (collector_count > 0) {
+        config->collectors = calloc((size_t)collector_count, sizeof(*config->collectors));
+    }
+    cJSON *collector;
+    if (config->collectors) {
+        cJSON_ArrayForEach(collector, collectors) {
+            CollectorSchedule *schedule = &config->collectors[config->collectors_count];
+            if ((schedule->name = strdup(collector->string)) == NULL) {
+                continue;
+            }
+            cJSON *task_interval = cJSON_GetObjectItemCaseSensitive(collector, "interval_ms");
+            cJSON *task_deadline = cJSON_GetObjectItemCaseSensitive(collector, "deadline_ms");
+            schedule->interval_ms = cJSON_IsNumber(task_interval) ? task_interval->valueint : 0;
+            schedule->deadline_ms = cJSON_IsNumber(task_deadline) ? task_deadline->valueint : 0;
+            config->collectors_count++;
+        }
     }
 
-    int interval = sampling_interval->valueint;
     cJSON_Delete(json);
-    return interval;
+    return 0;
 }
 
 /**
- * @brief Actualiza las banderas de monitoreo según las métricas en el JSON.
+ * @brief Aplica una configuración.
  *
- * @param file_path Ruta al archivo JSON que contiene la configuración.
+ * @param config Configuración leída con config_load().
  */
-void update_flags_from_json(const char *file_path) {
-    // Abrir el archivo JSON
-    FILE *file = fopen(file_path, "r");
-    if (!file) {
-        perror("Error al abrir el archivo");
-        return;
+void config_apply(const Config *config) {
+    // Todas las métricas cambian con un único store: una tarea nunca ve una mezcla de ambas configuraciones
+    metric_registry_set_enabled(config->enabled);
+
+    // Con -1 se conserva el intervalo anterior
+    if (config->sampling_interval_ms > 0) {
+        set_collector_default_interval(config->sampling_interval_ms);
     }
 
-    // Leer el contenido del archivo
-    fseek(file, 0, SEEK_END);
-    long file_size = ftell(file);
-    rewind(file);
+    set_disk_allowlist((const char **)config->disk_devices, config->disk_devices_count);
+    set_memstat_fields((const char **)config->memory_fields, config->memory_fields_count);
+    set_fs_allowlist((const char **)config->filesystem_mounts, config->filesystem_mounts_count);
+    set_fs_timeout(config->filesystem_timeout_ms > 0 ? config->filesystem_timeout_ms : FS_DEFAULT_TIMEOUT_MS);
+    set_netdev_filter(config->network_include_loopback, config->network_include_veth);
+    set_proctable_top_n(config->process_top_n > 0 ? config->process_top_n : PROCTABLE_DEFAULT_TOP_N);
+    set_cgroup_depth(config->cgroup_depth > 0 ? config->cgroup_depth : CGROUP_DEFAULT_DEPTH);
+    bool uring = config->process_io_engine != NULL && strcmp(config->process_io_engine, PROCTABLE_IO_ENGINE_URING) == 0;
+    set_proctable_io_engine(uring ? PROCTABLE_IO_URING : PROCTABLE_IO_PREAD);
 
-    char *json_content = (char *)malloc(file_size + 1);
-    if (!json_content) {
+    for (int i = 0; i < config->collectors_count; i++) {
+        set_collector_schedule(config->collectors[i].name, config->collectors[i].interval_ms,
+                               config->collectors[i].deadline_ms);
+    }
+
+    adaptive_rule_t rules[MAX_ADAPTIVE_RULES];
+    for (int i = 0; i < config->adaptive_rules_count; i++) {
+        rules[i].pattern = config->adaptive_rules[i].metric;
+        rules[i].delta = config->adaptive_rules[i].delta;
+        rules[i].has_threshold = config->adaptive_rules[i].has_threshold;
+        rules[i].threshold = config->adaptive_rules[i].threshold;
+    }
+    set_adaptive_rules(rules, config->adaptive_rules_count);
+    set_adaptive_max_interval(config->adaptive_max_interval_ms > 0 ? config->adaptive_max_interval_ms
+                                                                   : ADAPTIVE_DEFAULT_MAX_INTERVAL_MS);
+
+    // Las reglas se compilan aquí, al cargar cada config.json; los destinos solo se leen al arrancar
+    alert_rule_t alert_rules[MAX_ALERT_RULES];
+    for (int i = 0; i < config->alert_rules_count; i++) {
+        alert_rules[i].name = config->alert_rules[i].name;
+        alert_rules[i].expr = config->alert_rules[i].expr;
+    }
+    set_alert_rules(alert_rules, config->alert_rules_count);
+}
+
+/**
+ * @brief Libera los campos de una configuración.
+ *
+ * @param config Configuración.
+ */
+void config_free(Config *config) {
+    for (int i = 0; i < config->metrics_count; i++) {
+        free(config->metrics[i]);
+    }
+    for (int i = 0; i < config->disk_devices_count; i++) {
+        free(config->disk_devices[i]);
+    }
+    for (int i = 0; i < config->memory_fields_count; i++) {
+        free(config->memory_fields[i]);
+    }
+    for (int i = 0; i < config->filesystem_mounts_count; i++) {
+        free(config->filesystem_mounts[i]);
+    }
+    for (int i = 0; i < config->collectors_count; i++) {
+        free(config->collectors[i].name);
+    }
+    for (int i = 0; i < config->adaptive_rules_count; i++) {
+        free(config->adaptive_rules[i].metric);
+    }
+    for (int i = 0; i < config->alert_rules_count; i++) {
+        free(config->alert_rules[i].name);
+        free(config->alert_rules[i].expr);
+    }
+    for (int i = 0; i < config->aggregator_groups_count; i++) {
+        for (int j = 0; j < config->aggregator_groups[i].hosts_count; j++) {
+            free(config->aggregator_groups[i].hosts[j]);
+        }
+        free(config->aggregator_groups[i].name);
+        free(config->aggregator_groups[i].hosts);
+    }
+    free(config->metrics);
+    free(config->disk_devices);
+    free(config->memory_fields);
+    free(config->filesystem_mounts);
+    free(config->collectors);
+    free(config->adaptive_rules);
+    free(config->alert_rules);
+    free(config->alert_webhook);
+    free(config->alert_socket);
+    free(config->history_file);
+    free(config->process_io_engine);
+    free(config->push_mode);
+    free(config->push_url);
+    free(config->aggregator_listen);
+    free(config->aggregator_group_label);
+    free(config->aggregator_groups);
+    free(config->aggregator_quantiles);
+    free(config->http_bind);
+    free(config->http_mode);
+    memset(config, 0, sizeof(*config));
+}
+
+/**
+ * @brief Compara el estado actual del archivo vigilado con el último conocido.
+ *
+ * @return 1 si cambió el inodo, el tamaño o la fecha de modificación, 0 si no.
+ */
+static int watched_file_changed() {
+    struct stat st;
+    if (stat(watch_path, &st) != 0) {
+        // Mientras el archivo no existe se conserva la configuración anterior
+        return 0;
+    }
+
+    int changed = st.st_ino != watch_stat.st_ino || st.st_size != watch_stat.st_size ||
+                  st.st_mtim.tv_sec != watch_stat.st_mtim.tv_sec || st.st_mtim.tv_nsec != watch_stat.st_mtim.tv_nsec;
+    watch_stat = st;
+    return changed;
+}
+
+/**
+ * @brief Empieza a vigilar el archivo de configuración.
+ *
+ * @param file_path Ruta al archivo JSON.
+ * @return 0 si se usa inotify, -1 si se usa la comparación de mtime y tamaño.
+ */
+int config_watch(const char *file_path) {
+    config_unwatch();
+    if ((watch_path = strdup(file_path)) == NULL) {
         perror("Error al asignar memoria");
-        fclose(file);
-        return;
+        return -1;
+    }
+    if (stat(watch_path, &watch_stat) != 0) {
+        memset(&watch_stat, 0, sizeof(watch_stat));
     }
 
-    fread(json_content, 1, file_size, file);
-    json_content[file_size] = '\0';
-    fclose(file);
+    // Directorio del archivo: todo lo anterior a la última '/', o el directorio actual
+    char dir[PATH_MAX];
+    const char *slash = strrchr(watch_path, '/');
+    if (slash) {
+        snprintf(dir, sizeof(dir), "%.*s", slash == watch_path ? 1 : (int)(slash - watch_path), watch_path);
+        watch_name = slash + 1;
+    } else {
+        snprintf(dir, sizeof(dir), ".");
+        watch_name = watch_path;
+    }
 
-    // Parsear el JSON
-    cJSON *json = cJSON_Parse(json_content);
-    free(json_content);
-    if (!json) {
-        fprintf(stderr, "Error al parsear el JSON: %s\n", cJSON_GetErrorPtr());
-        return;
+    inotify_fd = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (inotify_fd < 0 || inotify_add_watch(inotify_fd, dir, CONFIG_WATCH_EVENTS) < 0) {
+        perror("Error al iniciar inotify sobre la configuración; se compara mtime y tamaño");
+        if (inotify_fd >= 0) {
+            close(inotify_fd);
+            inotify_fd = -1;
+        }
+        return -1;
     }
+    return 0;
+}
 
-    // Obtener el array de "metrics"
-    cJSON *metrics = cJSON_GetObjectItemCaseSensitive(json, "metrics");
-    if (!cJSON_IsArray(metrics)) {
-        fprintf(stderr, "'metrics' no es un array válido\n");
-        cJSON_Delete(json);
-        return;
-    }
-
-    // Resetear banderas
-    flag_bandwidth = false;
-    flag_cpu = false;
-    flag_disk = false;
-    flag_change = false;
-
-    // Actualizar banderas según las métricas
-    cJSON *metric;
-    cJSON_ArrayForEach(metric, metrics) {
-        if (cJSON_IsString(metric)) {
-            if (strcmp(metric->valuestring, "bandwith_usage") == 0) {
-                flag_bandwidth = true;
-            } 
-            if (strcmp(metric->valuestring, "cpu_usage_porcentage") == 0) {
-                flag_cpu = true;
-            } 
-            if (strcmp(metric->valuestring, "disk_usage_porcentage") == 0) {
-                flag_disk = true;
-            } 
-            if (strcmp(metric->valuestring, "change_contexts") == 0){
-                flag_change = true;
+/**
+ * @brief Espera un cambio en el archivo de configuración.
+ *
+ * @param timeout_ms Tiempo máximo de espera en milisegundos.
+ * @return 1 si el archivo cambió, 0 si no.
+ */
+int config_wait_change(int timeout_ms) {
+    if (!watch_path) {
+        return 0;
+    }
+
+    if (inotify_fd < 0) {
+        poll(NULL, 0, timeout_ms);
+        return watched_file_changed();
+    }
+
+    struct pollfd pfd = {.fd = inotify_fd, .events = POLLIN};
+    if (poll(&pfd, 1, timeout_ms) <= 0) {
+        return 0;
+    }
+
+    // Vaciar la cola de eventos y ver si alguno es del archivo vigilado
+    char events[sizeof(struct inotify_event) + NAME_MAX + 1]
+        __attribute__((aligned(__alignof__(struct inotify_event))));
+    int relevant = 0;
+    ssize_t len;
+    while ((len = read(inotify_fd, events, sizeof(events))) > 0) {
+        for (char *p = events; p < events + len;) {
+            const struct inotify_event *event = (const struct inotify_event *)p;
+            if (event->len > 0 && strcmp(event->name, watch_name) == 0) {
+                relevant = 1;
             }
+            p += sizeof(*event) + event->len;
         }
     }
 
-    // Indicar si hubo cambios en la configuración
-    if (flag_bandwidth || flag_cpu || flag_disk) {
-        flag_change = true;
+    // El evento ya indica el cambio; stat actualiza el estado conocido y descarta un archivo borrado
+    if (!relevant) {
+        return 0;
     }
+    watched_file_changed();
+    return access(watch_path, R_OK) == 0;
+}
 
-    cJSON_Delete(json);
-}
\ No newline at end of file
+/**
+ * @brief Deja de vigilar el archivo de configuración.
+ */
+void config_unwatch() {
+    if (inotify_fd >= 0) {
+        close(inotify_fd);
+        inotify_fd = -1;
+    }
+    free(watch_path);
+    watch_path = NULL;
+    watch_name = NULL;
+}
@@ -0,0 +1,77 @@
+/**
+ * @file line_protocol.c
+ * @brief Formato de las líneas de line_protocol.h.
+ */
+
+#include "line_protocol.h"
+#include "metrics.h"
+#include <math.h>
+
+void line_protocol_escape(char* dst, size_t size, const char* src)
+{
+    size_t j = 0;
+    for (size_t i = 0; src[i] != '\0' && j + 2 < size; i++)
+    {
+        if (src[i] == ',' || src[i] == '=' || src[i] == ' ')
+        {
+            dst[j++] = '\\';
+        }
+        dst[j++] = src[i];
+    }
+    dst[j] = '\0';
+}
+
+void line_protocol_statsd_tag(char* dst, size_t size, const char* src)
+{
+    size_t j = 0;
+    for (size_t i = 0; src[i] != '\0' && j + 1 < size; i++)
+    {
+        // DogStatsD no tiene escape: ',' separa tags, '|' campos, '#' abre los tags y ':' separa nombre y valor
+        dst[j++] = strchr(",|#:", src[i]) != NULL ? '_' : src[i];
+    }
+    dst[j] = '\0';
+}
+
+int line_protocol_format(push_mode_t mode, const metric_info_t* info, const push_sample_t* sample, char* line,
+                         size_t size)
+{
+    if (info == NULL || !isfinite(sample->value))
+    {
+        return INICIAL_VALUE;
+    }
+
+    int len;
+    if (mode == PUSH_STATSD)
+    {
+        len = snprintf(line, size, "%s:%.17g|g", info->name, sample->value);
+        for (int l = 0; l < sample->label_count && l < info->label_count && len < (int)size; l++)
+        {
+            char value[METRIC_LABEL_SIZE];
+            line_protocol_statsd_tag(value, sizeof(value), sample->labels[l]);
+            len += snprintf(line + len, size - (size_t)len, "%s%s:%s", l == 0 ? "|#" : ",", info->labels[l], value);
+        }
+    }
+    else
+    {
+        len = snprintf(line, size, "%s", info->name);
+        for (int l = 0; l < sample->label_count && l < info->label_count && len < (int)size; l++)
+        {
+            char value[METRIC_LABEL_SIZE * 2];
+            line_protocol_escape(value, sizeof(value), sample->labels[l]);
+            if (value[0] != '\0')
+            {
+                len += snprintf(line + len, size - (size_t)len, ",%s=%s", info->labels[l], value);
+            }
+        }
+        if (len < (int)size)
+        {
+            len += snprintf(line + len, size - (size_t)len, " value=%.17g %lld000000", sample->value,
+                            (long long)sample->timestamp_ms);
+        }
+    }
+    if (len < (int)size)
+    {
+        len += snprintf(line + len, size - (size_t)len, "\n");
+    }
+    return len < (int)size ? len : INICIAL_VALUE;
+}
@@ -2,60 +2,57 @@
  * @file main.c
  * @brief Punto de entrada del sistema.
  *
- * Este archivo contiene la función principal que inicializa las métricas y
- * comienza un hilo para exponer las métricas a través de HTTP. Actualiza
- * continuamente varios indicadores relacionados con el rendimiento del sistema
- * cada segundo.
+ * Este archivo contiene la función principal que inicializa las métricas,
+ * inicia el servidor HTTP que las expone y las tareas que actualizan los
+ * indicadores del sistema, cada una con su propio intervalo, y las detiene
+ * en orden al recibir SIGTERM o SIGINT.
  */
 
-#include "expose_metrics.h"
+#include "monitor.h"
+#include <getopt.h>
 #include <pthread.h>
-#include <stdbool.h>
+#include <signal.h>
 #include <stdio.h>
 #include <stdlib.h>
-#include <unistd.h>
-#include <stdbool.h>
-#include "cjson/cJSON.h"
-
 
 /**
- * @brief Bandera para el monitoreo del ancho de banda.
- *
- * Esta variable se utiliza para habilitar o deshabilitar el monitoreo
- * del uso del ancho de banda en la configuración.
+ * @brief Tiempo máximo de espera de un cambio de config.json, en milisegundos.
  */
-extern bool flag_bandwidth;
+#define CONFIG_POLL_MS 1000
 
 /**
- * @brief Bandera para el monitoreo del uso de CPU.
- *
- * Esta variable se utiliza para habilitar o deshabilitar el monitoreo
- * del uso de CPU en la configuración.
+ * @brief Se pone en 1 al recibir SIGTERM o SIGINT; el bucle principal lo revisa en cada espera.
  */
-extern bool flag_cpu;
+static volatile sig_atomic_t stop_requested;
 
 /**
- * @brief Bandera para el monitoreo del uso de disco.
+ * @brief Manejador de SIGTERM y SIGINT.
  *
- * Esta variable se utiliza para habilitar o deshabilitar el monitoreo
- * del uso del disco en la configuración.
+ * @param signum Señal recibida.
  */
-extern bool flag_disk;
+static void request_stop(int signum)
+{
+    (void)signum;
+    stop_requested = 1;
+}
 
 /**
- * @brief Bandera para indicar cambios en la configuración.
+ * @brief Muestra el uso del programa.
  *
- * Esta variable se utiliza para señalar si ha habido cambios en
- * la configuración que deben ser procesados.
+ * @param program Nombre del ejecutable.
  */
-extern bool flag_change;
+static void usage(const char* program)
+{
+    fprintf(stderr, "Uso: %s [-c|--config <ruta>]\n", program);
+    fprintf(stderr, "  -c, --config  Archivo de configuración JSON (por defecto %s)\n", MONITOR_DEFAULT_CONFIG_PATH);
+}
 
 /**
  * @brief Función principal de la aplicación.
  *
- * Esta función inicializa la recolección de métricas, crea un hilo para exponer
- * las métricas a través de HTTP y entra en un bucle para actualizar varios
- * indicadores del sistema cada segundo.
+ * Esta función inicia el monitor con su servidor HTTP (ver monitor.h) y entra en
+ * un bucle que vuelve a leer la configuración solo cuando el archivo cambia, hasta
+ * recibir SIGTERM o SIGINT.
  *
  * @param argc Número de argumentos de la línea de comandos.
  * @param argv Array de cadenas de argumentos de la línea de comandos.
@@ -64,46 +61,55 @@ extern bool flag_change;
  */
 int main(int argc, char* argv[])
 {
-    init_metrics(); /**< Inicializa la recolección de métricas. */
-
-    // Creamos un hilo para exponer las métricas vía HTTP
-    pthread_t tid; /**< Identificador del hilo del servidor HTTP. */
-    if (pthread_create(&tid, NULL, expose_metrics, NULL) != 0)
+    const char* config_filename = MONITOR_DEFAULT_CONFIG_PATH;
+    static const struct option options[] = {
+        {"config", required_argument, NULL, 'c'},
+        {"help", no_argument, NULL, 'h'},
+        {NULL, 0, NULL, 0},
+    };
+    int opt;
+    while ((opt = getopt_long(argc, argv, "c:h", options, NULL)) != -1)
     {
-        fprintf(stderr, "Error al crear el hilo del servidor HTTP\n");
-        return EXIT_FAILURE; /**< Retorna fallo si la creación del hilo falla. */
+        switch (opt)
+        {
+        case 'c':
+            config_filename = optarg;
+            break;
+        case 'h':
+            usage(argv[0]);
+            return EXIT_SUCCESS;
+        default:
+            usage(argv[0]);
+            return EXIT_FAILURE;
+        }
     }
 
-    const char* config_filename = "../../../config.json";
+    // Los hilos heredan las señales bloqueadas: solo el hilo principal atiende SIGTERM y SIGINT, y su espera de
+    // config.json se interrumpe apenas llega una
+    sigset_t stop_signals;
+    sigemptyset(&stop_signals);
+    sigaddset(&stop_signals, SIGTERM);
+    sigaddset(&stop_signals, SIGINT);
+    pthread_sigmask(SIG_BLOCK, &stop_signals, NULL);
+    struct sigaction action = {0};
+    action.sa_handler = request_stop;
+    sigemptyset(&action.sa_mask);
+    sigaction(SIGTERM, &action, NULL);
+    sigaction(SIGINT, &action, NULL);
 
-    // Bucle principal para actualizar las métricas cada segundo
-    while (true)
+    monitor_options_t monitor = {.config_path = config_filename, .serve_http = true};
+    if (monitor_start(&monitor) != 0)
     {
-        if(flag_bandwidth){
-            update_bandwidth_gauge();         /**< Actualiza el indicador de ancho de banda. */
-        }
-        if(flag_change){
-            update_change_context_gauge();    /**< Actualiza el indicador de cambios de contexto. */
-        }
-        if(flag_cpu){
-            update_cpu_gauge();               /**< Actualiza el indicador de uso de CPU. */
-        }
-        if(flag_disk){
-            update_disk_gauge();              /**< Actualiza el indicador de uso de disco. */
-        }
-        update_memory_gauge();            /**< Actualiza el indicador de uso de memoria. */
-        update_network_gauge();           /**< Actualiza el indicador de uso de red. */
-        update_major_page_faults_gauge(); /**< Actualiza el indicador de fallos de página mayores. */
-        update_minor_page_faults_gauge(); /**< Actualiza el indicador de fallos de página menores. */
-        update_memory_avalible_gauge();   /**< Actualiza el indicador de memoria disponible. */
-        update_memory_total_gauge();      /**< Actualiza el indicador de memoria total. */
-        update_memory_2_gauge();          /**< Actualiza el segundo indicador de memoria. */
-        update_disk_stats_gauge();        /**< Actualiza el indicador de estadísticas del disco. */
-        update_total_processes_gauge();   /**< Actualiza el indicador de procesos totales. */
-        
-        update_flags_from_json(config_filename);
-        sleep(read_sampling_interval(config_filename)); /**< Duerme durante un periodo definido antes de actualizar nuevamente. */
+        return EXIT_FAILURE;
+    }
+    pthread_sigmask(SIG_UNBLOCK, &stop_signals, NULL);
+
+    // Bucle principal: recargar config.json cada vez que cambia, hasta recibir SIGTERM o SIGINT
+    while (!stop_requested)
+    {
+        monitor_poll_config(CONFIG_POLL_MS);
     }
 
+    monitor_stop();
     return EXIT_SUCCESS; /**< Retorna éxito si la aplicación finaliza. */
 }
@@ -0,0 +1,155 @@
+/**
+ * @file memstat.c
+ * @brief Parseo de /proc/meminfo y /proc/vmstat con la tabla generada por memstat_hash_gen.
+ */
+
+#include "memstat.h"
+#include "memstat_hash.h"
+#include "metrics.h"
+#include "scan.h"
+#include <fnmatch.h>
+#include <stdatomic.h>
+
+/**
+ * @brief Bit de un campo en las máscaras.
+ */
+#define MEMSTAT_BIT(field) (1ULL << (field))
+
+/**
+ * @brief Todos los campos.
+ */
+#define MEMSTAT_ALL ((MEMSTAT_FIELD_COUNT == 64 ? 0ULL : MEMSTAT_BIT(MEMSTAT_FIELD_COUNT)) - 1ULL)
+
+/**
+ * @brief Campos que leen los getters de metrics.c, parseados aunque no se exporten.
+ */
+#define MEMSTAT_REQUIRED                                                                                               \
+    (MEMSTAT_BIT(MEMSTAT_MEM_TOTAL) | MEMSTAT_BIT(MEMSTAT_MEM_AVAILABLE) | MEMSTAT_BIT(MEMSTAT_PGFAULT) |             \
+     MEMSTAT_BIT(MEMSTAT_PGMAJFAULT))
+
+const memstat_field_info_t memstat_fields[MEMSTAT_FIELD_COUNT] = {
+#define MEMSTAT_FIELD_INFO(id, key, file, metric, scale, help) {key, file, metric, scale, help},
+    MEMSTAT_FIELDS(MEMSTAT_FIELD_INFO)
+#undef MEMSTAT_FIELD_INFO
+};
+
+/**
+ * @brief Bit de un campo si es de /proc/meminfo, seguido de '|' para sumar la lista.
+ */
+#define MEMSTAT_MEMINFO_BIT(id, key, file, metric, scale, help)                                                       \
+    ((file) == MEMSTAT_MEMINFO ? MEMSTAT_BIT(MEMSTAT_##id) : 0ULL) |
+
+/**
+ * @brief Campos de /proc/meminfo.
+ */
+#define MEMSTAT_MEMINFO_MASK (MEMSTAT_FIELDS(MEMSTAT_MEMINFO_BIT) 0ULL)
+
+/**
+ * @brief Campos de cada archivo, indexados por MEMSTAT_MEMINFO y MEMSTAT_VMSTAT; la pasada termina al leerlos todos.
+ */
+static const unsigned long long file_masks[2] = {MEMSTAT_MEMINFO_MASK, MEMSTAT_ALL & ~MEMSTAT_MEMINFO_MASK};
+
+/**
+ * @brief Campos exportados; se reemplaza entera al recargar la configuración.
+ */
+static atomic_ullong exported_mask = MEMSTAT_ALL;
+
+/**
+ * @brief Campos que se parsean: los exportados, los requeridos y los que hacen falta para los derivados.
+ */
+static atomic_ullong parsed_mask = MEMSTAT_ALL;
+
+int memstat_lookup(const char* key, size_t len)
+{
+    if (len == INICIAL_VALUE)
+    {
+        return ERROR_INT;
+    }
+    uint32_t slot = memstat_hash(MEMSTAT_HASH_SEED, key, len) >> (32 - MEMSTAT_HASH_BITS);
+    int field = memstat_hash_slots[slot];
+
+    // La tabla no tiene colisiones entre las claves conocidas, pero cualquier otra clave cae en alguna posición
+    if (field < INICIAL_VALUE || memcmp(memstat_fields[field].key, key, len) != INICIAL_VALUE ||
+        memstat_fields[field].key[len] != '\0')
+    {
+        return ERROR_INT;
+    }
+    return field;
+}
+
+void memstat_parse(int file, const char* buf, size_t len, unsigned long long values[MEMSTAT_FIELD_COUNT],
+                   unsigned long long* found)
+{
+    unsigned long long pending = atomic_load_explicit(&parsed_mask, memory_order_relaxed) & file_masks[file];
+    unsigned long long swap = MEMSTAT_BIT(MEMSTAT_SWAP_TOTAL) | MEMSTAT_BIT(MEMSTAT_SWAP_FREE);
+    const char* pos = buf;
+    const char* end = buf + len;
+
+    pending &= ~MEMSTAT_BIT(MEMSTAT_SWAP_USED); // Derivado, nunca aparece en el archivo
+    while (pending != INICIAL_VALUE && pos < end)
+    {
+        // La clave va hasta el ':' de /proc/meminfo o el espacio de /proc/vmstat; el resto de la línea solo se
+        // recorre si la clave es de un campo pendiente
+        const char* key = pos;
+        while (pos < end && *pos != ':' && *pos != ' ' && *pos != '\n')
+        {
+            pos++;
+        }
+        // Con LTO el compilador no ve que pos <= end: el resto se calcula una sola vez y solo si queda algo
+        size_t rest = pos < end ? (size_t)(end - pos) : INICIAL_VALUE;
+        const char* eol = rest > INICIAL_VALUE ? memchr(pos, '\n', rest) : NULL;
+        eol = eol != NULL ? eol : end;
+
+        int field = memstat_lookup(key, (size_t)(pos - key));
+        if (field >= INICIAL_VALUE && (pending & MEMSTAT_BIT(field)))
+        {
+            scan_t line = {pos < eol && *pos == ':' ? pos + 1 : pos, eol};
+            if (scan_u64(&line, &values[field]))
+            {
+                *found |= MEMSTAT_BIT(field);
+            }
+            pending &= ~MEMSTAT_BIT(field);
+        }
+        pos = eol + 1;
+    }
+
+    if (file == MEMSTAT_MEMINFO && (*found & swap) == swap && values[MEMSTAT_SWAP_TOTAL] >= values[MEMSTAT_SWAP_FREE])
+    {
+        values[MEMSTAT_SWAP_USED] = values[MEMSTAT_SWAP_TOTAL] - values[MEMSTAT_SWAP_FREE];
+        *found |= MEMSTAT_BIT(MEMSTAT_SWAP_USED);
+    }
+}
+
+void set_memstat_fields(const char** patterns, int count)
+{
+    unsigned long long mask = count > INICIAL_VALUE ? INICIAL_VALUE : MEMSTAT_ALL;
+
+    if (count > MAX_MEMSTAT_ALLOWLIST)
+    {
+        count = MAX_MEMSTAT_ALLOWLIST;
+    }
+    for (int f = 0; f < MEMSTAT_FIELD_COUNT; f++)
+    {
+        for (int p = 0; p < count; p++)
+        {
+            if (fnmatch(patterns[p], memstat_fields[f].key, INICIAL_VALUE) == INICIAL_VALUE)
+            {
+                mask |= MEMSTAT_BIT(f);
+                break;
+            }
+        }
+    }
+
+    unsigned long long parsed = mask | MEMSTAT_REQUIRED;
+    if (mask & MEMSTAT_BIT(MEMSTAT_SWAP_USED))
+    {
+        parsed |= MEMSTAT_BIT(MEMSTAT_SWAP_TOTAL) | MEMSTAT_BIT(MEMSTAT_SWAP_FREE);
+    }
+    atomic_store(&parsed_mask, parsed);
+    atomic_store(&exported_mask, mask);
+}
+
+unsigned long long memstat_exported_fields()
+{
+    return atomic_load(&exported_mask);
+}
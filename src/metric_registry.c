@@ -0,0 +1,1295 @@
+/**
+ * @file metric_registry.c
+ * @brief Descriptores de las métricas del sistema y su recolección a partir de la instantánea.
+ *
+ * Agregar una métrica escalar es agregar una fila a la tabla: la creación, el registro, la habilitación desde
+ * config.json y la recolección salen del descriptor.
+ */
+
+#include "metric_registry.h"
+#include "bpf_latency.h"
+#include "cgroup_stats.h"
+#include "cpu_stats.h"
+#include "fs_stats.h"
+#include "memstat.h"
+#include "metrics.h"
+#include "netdev.h"
+#include "proctable.h"
+#include <fnmatch.h>
+#ifdef MONITOR_BUILTIN_EXPOSITION
+#include "prom_lite.h"
+#else
+#include <prom.h>
+#endif
+#include <stdatomic.h>
+
+/**
+ * @brief Métricas registradas con metric_registry_register(); se completa al iniciar, antes de las tareas.
+ */
+static metric_info_t metric_names[METRIC_REGISTRY_MAX_METRICS];
+
+/**
+ * @brief Cantidad de entradas válidas de metric_names.
+ */
+static int metric_name_count = INICIAL_VALUE;
+
+/**
+ * @brief Registra una métrica en libprom y guarda su nombre y etiquetas.
+ */
+void* metric_registry_register(void* metric, const char* name, int label_count, const char* const* labels)
+{
+    if (metric == NULL || prom_collector_registry_must_register_metric(metric) == NULL)
+    {
+        return NULL;
+    }
+    if (metric_name_count < METRIC_REGISTRY_MAX_METRICS)
+    {
+        metric_info_t* info = &metric_names[metric_name_count++];
+        info->metric = metric;
+        info->name = name;
+        info->label_count = label_count < METRIC_MAX_LABELS ? label_count : METRIC_MAX_LABELS;
+        for (int i = 0; i < info->label_count; i++)
+        {
+            snprintf(info->labels[i], METRIC_LABEL_SIZE, "%s", labels[i]);
+        }
+    }
+    return metric;
+}
+
+/**
+ * @brief Busca el nombre y las etiquetas de una métrica registrada.
+ */
+const metric_info_t* metric_registry_metric_info(const void* metric)
+{
+    for (int i = 0; i < metric_name_count; i++)
+    {
+        if (metric_names[i].metric == metric)
+        {
+            return &metric_names[i];
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Busca el nombre de una métrica registrada.
+ */
+const char* metric_registry_metric_name(const void* metric)
+{
+    const metric_info_t* info = metric_registry_metric_info(metric);
+    return info != NULL ? info->name : NULL;
+}
+
+/**
+ * @brief Convierte el resultado de un getter entero (que devuelve -1 en caso de error) en un valor de métrica.
+ *
+ * @param value Valor del getter.
+ * @return Valor como double, o -1.0 en caso de error.
+ */
+static double counter_value(unsigned long long value)
+{
+    return value == (unsigned long long)ERROR_INT ? ERROR_FLOAT : (double)value;
+}
+
+/**
+ * @brief Cambios de contexto desde el arranque.
+ */
+static double change_context_value(const proc_snapshot_t* snap)
+{
+    return counter_value(get_change_context(snap));
+}
+
+/**
+ * @brief Procesos creados desde el arranque.
+ */
+static double total_processes_value(const proc_snapshot_t* snap)
+{
+    return counter_value(get_total_processes(snap));
+}
+
+/**
+ * @brief Fallos de página mayores desde el arranque.
+ */
+static double major_page_faults_value(const proc_snapshot_t* snap)
+{
+    return counter_value(get_major_page_faults(snap));
+}
+
+/**
+ * @brief Fallos de página menores desde el arranque.
+ */
+static double minor_page_faults_value(const proc_snapshot_t* snap)
+{
+    return counter_value(get_minor_page_faults(snap));
+}
+
+/**
+ * @brief Total acumulado de una suma de contadores de varios dispositivos o interfaces.
+ */
+typedef struct
+{
+    double total; ///< Total exportado; nunca retrocede.
+    double last;  ///< Suma de la lectura anterior.
+    int primed;   ///< 1 si last tiene una lectura.
+} aggregate_counter_t;
+
+/**
+ * @brief Avanza un total acumulado con la suma del ciclo.
+ *
+ * Una suma menor que la anterior significa que se quitó un dispositivo o una interfaz, no que el contador se
+ * reinició: el total no retrocede y Prometheus no ve un reinicio falso.
+ *
+ * @param agg Total acumulado.
+ * @param sum Suma del ciclo, o negativa en caso de error.
+ * @return Total acumulado, o -1.0 en caso de error.
+ */
+static double aggregate_counter_update(aggregate_counter_t* agg, double sum)
+{
+    if (sum < INICIAL_VALUE)
+    {
+        return ERROR_FLOAT;
+    }
+    if (!agg->primed)
+    {
+        agg->total = sum;
+        agg->primed = ASSIGNED_VALUE;
+    }
+    else if (sum >= agg->last)
+    {
+        agg->total += sum - agg->last;
+    }
+    agg->last = sum;
+    return agg->total;
+}
+
+/**
+ * @brief Operaciones de lectura y escritura completadas sumando los dispositivos seleccionados.
+ */
+static double disk_operations_value(const proc_snapshot_t* snap)
+{
+    static aggregate_counter_t total; // Solo la tarea de disco lee esta fuente
+    return aggregate_counter_update(&total, get_disk_stats(snap));
+}
+
+/**
+ * @brief Bytes recibidos y transmitidos sumando las interfaces seleccionadas.
+ */
+static double network_bytes_value(const proc_snapshot_t* snap)
+{
+    static aggregate_counter_t total; // Solo la tarea de red lee esta fuente
+    if (!(snap->valid & SNAPSHOT_NETDEV))
+    {
+        return ERROR_FLOAT;
+    }
+    return aggregate_counter_update(&total, (double)(snap->net_rx_bytes + snap->net_tx_bytes));
+}
+
+/**
+ * @brief Histogramas de los valores de cada ciclo; el almacén solo conserva el último lote, así que se observan al
+ * recolectar, con el lock de cada métrica de libprom.
+ */
+static prom_histogram_t* cpu_usage_histogram;
+static prom_histogram_t* bandwidth_usage_histogram;
+
+/**
+ * @brief Crea cpu_usage_percentage_histogram con cubetas de 10 en 10 hasta 100.
+ */
+static int create_cpu_histogram(metric_desc_t* desc)
+{
+    (void)desc;
+    cpu_usage_histogram = prom_histogram_new("cpu_usage_percentage_histogram",
+                                             "Distribución del uso de CPU de cada ciclo (percent)",
+                                             prom_histogram_buckets_linear(10, 10, 10), 0, NULL);
+    return metric_registry_register(cpu_usage_histogram, "cpu_usage_percentage_histogram", 0, NULL) != NULL
+               ? INICIAL_VALUE
+               : ERROR_INT;
+}
+
+/**
+ * @brief Observa el uso de CPU del ciclo.
+ */
+static void update_cpu_histogram(metric_batch_t* batch, const metric_desc_t* desc, const proc_snapshot_t* snap)
+{
+    (void)batch;
+    (void)desc;
+    double value = get_cpu_usage(snap);
+    if (value >= INICIAL_VALUE)
+    {
+        prom_histogram_observe(cpu_usage_histogram, value, NULL);
+    }
+}
+
+/**
+ * @brief Crea bandwidth_usage_histogram con cubetas exponenciales desde 10 kB/s.
+ */
+static int create_bandwidth_histogram(metric_desc_t* desc)
+{
+    (void)desc;
+    bandwidth_usage_histogram = prom_histogram_new("bandwidth_usage_histogram",
+                                                   "Distribución del ancho de banda de cada ciclo (MB/s)",
+                                                   prom_histogram_buckets_exponential(0.01, 4, 10), 0, NULL);
+    return metric_registry_register(bandwidth_usage_histogram, "bandwidth_usage_histogram", 0, NULL) != NULL
+               ? INICIAL_VALUE
+               : ERROR_INT;
+}
+
+/**
+ * @brief Observa el ancho de banda del ciclo.
+ */
+static void update_bandwidth_histogram(metric_batch_t* batch, const metric_desc_t* desc, const proc_snapshot_t* snap)
+{
+    (void)batch;
+    (void)desc;
+    double value = get_average_bandwidth(snap);
+    if (value >= INICIAL_VALUE)
+    {
+        prom_histogram_observe(bandwidth_usage_histogram, value, NULL);
+    }
+}
+
+/**
+ * @brief Publica cpu_usage_percentage{cpu="N|all",mode="..."} a partir de los porcentajes por núcleo.
+ *
+ * La serie cpu="all",mode="busy" equivale al valor anterior sin etiquetas.
+ */
+static void update_cpu(metric_batch_t* batch, const metric_desc_t* desc, const proc_snapshot_t* snap)
+{
+    const cpu_stats_t* cpus = snap->cpus;
+    if (!(snap->valid & SNAPSHOT_STAT) || cpus == NULL)
+    {
+        fprintf(stderr, "Error al obtener el uso de CPU\n");
+        return;
+    }
+    if (!cpus->has_prev)
+    {
+        return; // Primera lectura: todavía no hay diferencias de las que sacar porcentajes
+    }
+
+    // Las etiquetas "cpu" están preasignadas; solo se arma el arreglo de punteros en la pila
+    for (int c = 0; c < cpus->columns; c++)
+    {
+        if (cpus->scale[c] == 0)
+        {
+            continue; // CPU offline o sin tiempo transcurrido
+        }
+        for (int m = 0; m < CPU_PERCENT_COUNT; m++)
+        {
+            const char* labels[] = {cpus->labels[c], cpu_mode_labels[m]};
+            metric_batch_add(batch, desc->metric, METRIC_GAUGE, cpus->percent[(size_t)m * cpus->columns + c],
+                             labels, 2);
+        }
+    }
+}
+
+/**
+ * @brief Métricas de tasa de lectura y escritura por dispositivo.
+ */
+static prom_gauge_t* disk_rate_metrics[2];
+
+/**
+ * @brief Nombres de las métricas de tasa por dispositivo.
+ */
+static const char* const disk_rate_names[2] = {"disk_read_bytes_per_second", "disk_write_bytes_per_second"};
+
+/**
+ * @brief Crea disk_read_bytes_per_second y disk_write_bytes_per_second.
+ */
+static int create_disk_devices(metric_desc_t* desc)
+{
+    (void)desc;
+    const char* labels[] = {"device"};
+    disk_rate_metrics[0] = prom_gauge_new(disk_rate_names[0], "Bytes leídos por segundo por dispositivo", 1, labels);
+    disk_rate_metrics[1] = prom_gauge_new(disk_rate_names[1], "Bytes escritos por segundo por dispositivo", 1, labels);
+    for (int i = 0; i < 2; i++)
+    {
+        if (metric_registry_register(disk_rate_metrics[i], disk_rate_names[i], 1, labels) == NULL)
+        {
+            return ERROR_INT;
+        }
+    }
+    return INICIAL_VALUE;
+}
+
+/**
+ * @brief Publica las tasas de lectura y escritura de cada dispositivo de bloque seleccionado.
+ */
+static void update_disk_devices(metric_batch_t* batch, const metric_desc_t* desc, const proc_snapshot_t* snap)
+{
+    (void)desc;
+    if (!(snap->valid & SNAPSHOT_DISKSTATS))
+    {
+        fprintf(stderr, "Error al obtener las estadísticas por dispositivo\n");
+        return;
+    }
+
+    for (int i = 0; i < snap->disk_count; i++)
+    {
+        const char* labels[] = {snap->disks[i].name};
+        metric_batch_add(batch, disk_rate_metrics[0], METRIC_GAUGE, snap->disks[i].read_bytes_per_second, labels, 1);
+        metric_batch_add(batch, disk_rate_metrics[1], METRIC_GAUGE, snap->disks[i].write_bytes_per_second, labels, 1);
+    }
+}
+
+/**
+ * @brief Métricas de los campos de /proc/meminfo (gauges) y /proc/vmstat (contadores), indexadas por
+ * memstat_field_t.
+ */
+static void* memstat_metrics[MEMSTAT_FIELD_COUNT];
+
+/**
+ * @brief Crea una métrica por cada campo de un archivo de memstat_fields.h.
+ *
+ * @param file MEMSTAT_MEMINFO o MEMSTAT_VMSTAT.
+ * @return 0 en caso de éxito, -1 en caso de error.
+ */
+static int create_memstat(int file)
+{
+    for (int f = 0; f < MEMSTAT_FIELD_COUNT; f++)
+    {
+        const memstat_field_info_t* field = &memstat_fields[f];
+        if (field->file != file)
+        {
+            continue;
+        }
+        memstat_metrics[f] = file == MEMSTAT_VMSTAT ? (void*)prom_counter_new(field->metric, field->help, 0, NULL)
+                                                    : (void*)prom_gauge_new(field->metric, field->help, 0, NULL);
+        if (metric_registry_register(memstat_metrics[f], field->metric, 0, NULL) == NULL)
+        {
+            return ERROR_INT;
+        }
+    }
+    return INICIAL_VALUE;
+}
+
+/**
+ * @brief Publica los campos de un archivo que estén en la lista "memory_fields" y se hayan leído en el ciclo.
+ *
+ * @param batch Lote de la tarea.
+ * @param snap Instantánea del ciclo.
+ * @param file MEMSTAT_MEMINFO o MEMSTAT_VMSTAT.
+ */
+static void update_memstat(metric_batch_t* batch, const proc_snapshot_t* snap, int file)
+{
+    unsigned long long fields = memstat_exported_fields() & snap->memstat_found;
+
+    for (int f = 0; f < MEMSTAT_FIELD_COUNT; f++)
+    {
+        const memstat_field_info_t* field = &memstat_fields[f];
+        if (field->file == file && (fields & (1ULL << f)))
+        {
+            metric_batch_add(batch, memstat_metrics[f], file == MEMSTAT_VMSTAT ? METRIC_COUNTER : METRIC_GAUGE,
+                             (double)snap->memstat[f] * field->scale, NULL, 0);
+        }
+    }
+}
+
+/**
+ * @brief Crea las métricas meminfo_*.
+ */
+static int create_meminfo(metric_desc_t* desc)
+{
+    (void)desc;
+    return create_memstat(MEMSTAT_MEMINFO);
+}
+
+/**
+ * @brief Publica las métricas meminfo_*.
+ */
+static void update_meminfo(metric_batch_t* batch, const metric_desc_t* desc, const proc_snapshot_t* snap)
+{
+    (void)desc;
+    if (!(snap->valid & SNAPSHOT_MEMINFO))
+    {
+        fprintf(stderr, "Error al leer la información de memoria desde /proc/meminfo\n");
+        return;
+    }
+    update_memstat(batch, snap, MEMSTAT_MEMINFO);
+}
+
+/**
+ * @brief Crea las métricas vmstat_*.
+ */
+static int create_vmstat(metric_desc_t* desc)
+{
+    (void)desc;
+    return create_memstat(MEMSTAT_VMSTAT);
+}
+
+/**
+ * @brief Publica las métricas vmstat_*.
+ */
+static void update_vmstat(metric_batch_t* batch, const metric_desc_t* desc, const proc_snapshot_t* snap)
+{
+    (void)desc;
+    if (!(snap->valid & SNAPSHOT_VMSTAT))
+    {
+        fprintf(stderr, "Error al leer /proc/vmstat\n");
+        return;
+    }
+    update_memstat(batch, snap, MEMSTAT_VMSTAT);
+}
+
+/**
+ * @brief Contadores por interfaz de red, uno por campo de /proc/net/dev.
+ */
+static prom_counter_t* netdev_counter_metrics[NETDEV_FIELD_COUNT];
+
+/**
+ * @brief Tasas por segundo por interfaz de red, una por campo de /proc/net/dev.
+ */
+static prom_gauge_t* netdev_rate_metrics[NETDEV_FIELD_COUNT];
+
+/**
+ * @brief Nombres de las métricas por interfaz; libprom no copia el nombre.
+ */
+static char netdev_metric_names[2][NETDEV_FIELD_COUNT][BUFFER_SIZE];
+
+/**
+ * @brief Crea network_<campo>_total y network_<campo>_per_second para cada campo de /proc/net/dev.
+ */
+static int create_netdev(metric_desc_t* desc)
+{
+    (void)desc;
+    const char* labels[] = {"interface"};
+    for (int f = 0; f < NETDEV_FIELD_COUNT; f++)
+    {
+        snprintf(netdev_metric_names[0][f], BUFFER_SIZE, "network_%s_total", netdev_field_names[f]);
+        snprintf(netdev_metric_names[1][f], BUFFER_SIZE, "network_%s_per_second", netdev_field_names[f]);
+        netdev_counter_metrics[f] = prom_counter_new(netdev_metric_names[0][f], "Contador por interfaz de red", 1,
+                                                     labels);
+        netdev_rate_metrics[f] = prom_gauge_new(netdev_metric_names[1][f], "Tasa por segundo por interfaz de red", 1,
+                                                labels);
+        if (netdev_counter_metrics[f] == NULL || netdev_rate_metrics[f] == NULL ||
+            metric_registry_register(netdev_counter_metrics[f], netdev_metric_names[0][f], 1, labels) == NULL ||
+            metric_registry_register(netdev_rate_metrics[f], netdev_metric_names[1][f], 1, labels) == NULL)
+        {
+            return ERROR_INT;
+        }
+    }
+    return INICIAL_VALUE;
+}
+
+/**
+ * @brief Publica los contadores y tasas de cada interfaz de red seleccionada.
+ */
+static void update_netdev(metric_batch_t* batch, const metric_desc_t* desc, const proc_snapshot_t* snap)
+{
+    (void)desc;
+    if (!(snap->valid & SNAPSHOT_NETDEV))
+    {
+        fprintf(stderr, "Error al obtener las estadísticas por interfaz\n");
+        return;
+    }
+
+    for (int i = 0; i < snap->net_iface_count; i++)
+    {
+        const netdev_iface_t* iface = snap->net_ifaces[i];
+        const char* labels[] = {iface->name};
+        for (int f = 0; f < NETDEV_FIELD_COUNT; f++)
+        {
+            // Los totales ya están corregidos por desbordes y nunca retroceden
+            metric_batch_add(batch, netdev_counter_metrics[f], METRIC_COUNTER, (double)iface->total[f], labels, 1);
+            metric_batch_add(batch, netdev_rate_metrics[f], METRIC_GAUGE, iface->rate[f], labels, 1);
+        }
+    }
+}
+
+/**
+ * @brief Cambios de contexto por segundo desde la lectura anterior de /proc/stat.
+ */
+static double context_switches_rate_value(const proc_snapshot_t* snap)
+{
+    return snap->valid & SNAPSHOT_STAT ? snap->ctxt_per_second : ERROR_FLOAT;
+}
+
+/**
+ * @brief Nombres de los recursos y ventanas de /proc/pressure usados en las etiquetas.
+ */
+static const char* const psi_resource_labels[PSI_RESOURCE_COUNT] = {"cpu", "memory", "io"};
+static const char* const psi_window_labels[] = {"10s", "60s", "300s"};
+
+/**
+ * @brief Bit de validez de cada recurso de /proc/pressure.
+ */
+static const unsigned int psi_resource_bits[PSI_RESOURCE_COUNT] = {SNAPSHOT_PSI_CPU, SNAPSHOT_PSI_MEMORY,
+                                                                   SNAPSHOT_PSI_IO};
+
+/**
+ * @brief Promedios de presión por recurso y ventana, uno por línea "some" y "full".
+ */
+static prom_gauge_t* psi_avg_metrics[PSI_KIND_COUNT];
+
+/**
+ * @brief Tiempo demorado acumulado por recurso, uno por línea "some" y "full".
+ */
+static prom_counter_t* psi_total_metrics[PSI_KIND_COUNT];
+
+/**
+ * @brief Nombres de los promedios y totales de presión, uno por línea "some" y "full".
+ */
+static const char* const psi_avg_names[PSI_KIND_COUNT] = {"pressure_some_percentage", "pressure_full_percentage"};
+static const char* const psi_total_names[PSI_KIND_COUNT] = {"pressure_some_seconds_total",
+                                                            "pressure_full_seconds_total"};
+
+/**
+ * @brief Crea pressure_{some,full}_percentage{resource,window} y pressure_{some,full}_seconds_total{resource}.
+ */
+static int create_pressure(metric_desc_t* desc)
+{
+    (void)desc;
+    const char* labels[] = {"resource", "window"};
+    psi_avg_metrics[PSI_SOME] = prom_gauge_new(
+        psi_avg_names[PSI_SOME], "Porcentaje de tiempo con al menos una tarea demorada por el recurso (PSI)", 2,
+        labels);
+    psi_avg_metrics[PSI_FULL] = prom_gauge_new(
+        psi_avg_names[PSI_FULL], "Porcentaje de tiempo con todas las tareas demoradas por el recurso (PSI)", 2,
+        labels);
+    psi_total_metrics[PSI_SOME] = prom_counter_new(
+        psi_total_names[PSI_SOME], "Tiempo con al menos una tarea demorada por el recurso (PSI)", 1, labels);
+    psi_total_metrics[PSI_FULL] = prom_counter_new(
+        psi_total_names[PSI_FULL], "Tiempo con todas las tareas demoradas por el recurso (PSI)", 1, labels);
+    for (int k = 0; k < PSI_KIND_COUNT; k++)
+    {
+        if (metric_registry_register(psi_avg_metrics[k], psi_avg_names[k], 2, labels) == NULL ||
+            metric_registry_register(psi_total_metrics[k], psi_total_names[k], 1, labels) == NULL)
+        {
+            return ERROR_INT;
+        }
+    }
+    return INICIAL_VALUE;
+}
+
+/**
+ * @brief Publica los promedios y totales de presión de cada recurso disponible.
+ */
+static void update_pressure(metric_batch_t* batch, const metric_desc_t* desc, const proc_snapshot_t* snap)
+{
+    (void)desc;
+    if (!(snap->valid & SNAPSHOT_PSI))
+    {
+        return; // Sin CONFIG_PSI o con psi=0 la fuente no existe y no hay muestras
+    }
+
+    for (int r = 0; r < PSI_RESOURCE_COUNT; r++)
+    {
+        if (!(snap->valid & psi_resource_bits[r]))
+        {
+            continue;
+        }
+        for (int k = 0; k < PSI_KIND_COUNT; k++)
+        {
+            const psi_stall_t* stall = &snap->psi[r][k];
+            double averages[] = {stall->avg10, stall->avg60, stall->avg300};
+            for (int w = 0; w < 3; w++)
+            {
+                const char* labels[] = {psi_resource_labels[r], psi_window_labels[w]};
+                metric_batch_add(batch, psi_avg_metrics[k], METRIC_GAUGE, averages[w], labels, 2);
+            }
+            const char* labels[] = {psi_resource_labels[r]};
+            metric_batch_add(batch, psi_total_metrics[k], METRIC_COUNTER, (double)stall->total / 1e6, labels, 1);
+        }
+    }
+}
+
+/**
+ * @brief Contadores de /proc/schedstat: tiempo en ejecución, espera en la cola y porciones.
+ */
+static prom_counter_t* schedstat_counter_metrics[3];
+
+/**
+ * @brief Nombres de los contadores de /proc/schedstat.
+ */
+static const char* const schedstat_counter_names[3] = {"schedstat_running_seconds_total",
+                                                       "schedstat_waiting_seconds_total", "schedstat_timeslices_total"};
+
+/**
+ * @brief Espera media en la cola de ejecución por porción.
+ */
+static prom_gauge_t* schedstat_wait_metric;
+
+/**
+ * @brief Crea las métricas schedstat_*.
+ */
+static int create_schedstat(metric_desc_t* desc)
+{
+    (void)desc;
+    schedstat_counter_metrics[0] = prom_counter_new(schedstat_counter_names[0],
+                                                    "Tiempo ejecutando tareas sumando todas las CPUs", 0, NULL);
+    schedstat_counter_metrics[1] = prom_counter_new(schedstat_counter_names[1],
+                                                    "Tiempo de tareas esperando en la cola de ejecución", 0, NULL);
+    schedstat_counter_metrics[2] = prom_counter_new(schedstat_counter_names[2],
+                                                    "Porciones de tiempo ejecutadas sumando todas las CPUs", 0, NULL);
+    schedstat_wait_metric = prom_gauge_new("schedstat_average_wait_seconds",
+                                           "Espera media en la cola de ejecución por porción de tiempo", 0, NULL);
+    if (metric_registry_register(schedstat_wait_metric, "schedstat_average_wait_seconds", 0, NULL) == NULL)
+    {
+        return ERROR_INT;
+    }
+    for (int i = 0; i < 3; i++)
+    {
+        if (metric_registry_register(schedstat_counter_metrics[i], schedstat_counter_names[i], 0, NULL) == NULL)
+        {
+            return ERROR_INT;
+        }
+    }
+    return INICIAL_VALUE;
+}
+
+/**
+ * @brief Publica los totales de /proc/schedstat y la espera media del intervalo.
+ */
+static void update_schedstat(metric_batch_t* batch, const metric_desc_t* desc, const proc_snapshot_t* snap)
+{
+    (void)desc;
+    if (!(snap->valid & SNAPSHOT_SCHEDSTAT))
+    {
+        return; // Sin CONFIG_SCHEDSTATS la fuente no existe y no hay muestras
+    }
+
+    metric_batch_add(batch, schedstat_counter_metrics[0], METRIC_COUNTER, (double)snap->sched_run_ns / 1e9, NULL, 0);
+    metric_batch_add(batch, schedstat_counter_metrics[1], METRIC_COUNTER, (double)snap->sched_wait_ns / 1e9, NULL, 0);
+    metric_batch_add(batch, schedstat_counter_metrics[2], METRIC_COUNTER, (double)snap->sched_timeslices, NULL, 0);
+    metric_batch_add(batch, schedstat_wait_metric, METRIC_GAUGE, snap->sched_average_wait_seconds, NULL, 0);
+}
+
+/**
+ * @brief Procesos en la tabla de procesos.
+ */
+static double processes_tracked_value(const proc_snapshot_t* snap)
+{
+    return snap->valid & SNAPSHOT_PROCS ? (double)snap->procs->tracked : ERROR_FLOAT;
+}
+
+/**
+ * @brief Procesos nuevos vistos desde el arranque del monitor.
+ */
+static double process_births_value(const proc_snapshot_t* snap)
+{
+    return snap->valid & SNAPSHOT_PROCS ? (double)snap->procs->births : ERROR_FLOAT;
+}
+
+/**
+ * @brief Procesos terminados vistos desde el arranque del monitor.
+ */
+static double process_exits_value(const proc_snapshot_t* snap)
+{
+    return snap->valid & SNAPSHOT_PROCS ? (double)snap->procs->exits : ERROR_FLOAT;
+}
+
+/**
+ * @brief Métricas de los rankings de procesos, indexadas por enum proc_rank.
+ */
+static prom_gauge_t* process_top_metrics[PROC_RANK_COUNT];
+
+/**
+ * @brief Nombres de las métricas de cada ranking.
+ */
+static const char* const process_top_names[PROC_RANK_COUNT] = {
+    "process_top_cpu_percentage", "process_top_resident_bytes", "process_top_io_bytes_per_second"};
+
+/**
+ * @brief PID del proceso en cada puesto de cada ranking.
+ */
+static prom_gauge_t* process_top_pid_metric;
+
+/**
+ * @brief Valores de la etiqueta "rank" ("1" a "PROCTABLE_TOP_MAX").
+ */
+static char rank_labels[PROCTABLE_TOP_MAX][ASSIGNED_VALUE_8];
+
+/**
+ * @brief Puestos publicados alguna vez en cada ranking; los que quedan vacíos se publican en cero.
+ */
+static int process_top_published[PROC_RANK_COUNT];
+
+/**
+ * @brief Crea process_top_<recurso>{rank} y process_top_pid{resource,rank}.
+ *
+ * Las etiquetas son el puesto y el recurso, nunca el PID ni el nombre del proceso: libprom no borra series, y con
+ * esas etiquetas cada proceso que pasara por el ranking dejaría una serie para siempre.
+ */
+static int create_process_top(metric_desc_t* desc)
+{
+    (void)desc;
+    for (int r = 0; r < PROCTABLE_TOP_MAX; r++)
+    {
+        snprintf(rank_labels[r], sizeof(rank_labels[r]), "%d", r + 1);
+    }
+    const char* labels[] = {"resource", "rank"};
+    process_top_metrics[PROC_RANK_CPU] = prom_gauge_new(
+        process_top_names[PROC_RANK_CPU], "Uso de CPU de los procesos que más consumen (100 = un núcleo)", 1,
+        &labels[1]);
+    process_top_metrics[PROC_RANK_RSS] = prom_gauge_new(process_top_names[PROC_RANK_RSS],
+                                                        "Memoria residente de los procesos que más consumen", 1,
+                                                        &labels[1]);
+    process_top_metrics[PROC_RANK_IO] = prom_gauge_new(
+        process_top_names[PROC_RANK_IO], "Bytes leídos y escritos por segundo de los procesos que más consumen", 1,
+        &labels[1]);
+    process_top_pid_metric =
+        prom_gauge_new("process_top_pid", "PID del proceso en cada puesto de cada ranking", 2, labels);
+    if (metric_registry_register(process_top_pid_metric, "process_top_pid", 2, labels) == NULL)
+    {
+        return ERROR_INT;
+    }
+    for (int r = 0; r < PROC_RANK_COUNT; r++)
+    {
+        if (metric_registry_register(process_top_metrics[r], process_top_names[r], 1, &labels[1]) == NULL)
+        {
+            return ERROR_INT;
+        }
+    }
+    return INICIAL_VALUE;
+}
+
+/**
+ * @brief Publica los rankings de procesos del ciclo.
+ */
+static void update_process_top(metric_batch_t* batch, const metric_desc_t* desc, const proc_snapshot_t* snap)
+{
+    (void)desc;
+    if (!(snap->valid & SNAPSHOT_PROCS))
+    {
+        fprintf(stderr, "Error al obtener los procesos\n");
+        return;
+    }
+
+    const proc_top_t* top = snap->procs;
+    for (int r = 0; r < PROC_RANK_COUNT; r++)
+    {
+        if (top->count[r] > process_top_published[r])
+        {
+            process_top_published[r] = top->count[r];
+        }
+        for (int i = 0; i < process_top_published[r]; i++)
+        {
+            const proc_entry_t* entry = i < top->count[r] ? top->top[r][i] : NULL;
+            double value = INICIAL_VALUE;
+            if (entry != NULL)
+            {
+                value = r == PROC_RANK_CPU   ? entry->cpu_percent
+                        : r == PROC_RANK_RSS ? (double)entry->rss_bytes
+                                             : entry->io_bytes_per_second;
+            }
+            const char* labels[] = {proc_rank_names[r], rank_labels[i]};
+            metric_batch_add(batch, process_top_metrics[r], METRIC_GAUGE, value, &labels[1], 1);
+            metric_batch_add(batch, process_top_pid_metric, METRIC_GAUGE, entry ? entry->pid : INICIAL_VALUE, labels,
+                             2);
+        }
+    }
+}
+
+/**
+ * @brief Métricas por cgroup.
+ */
+static prom_gauge_t* cgroup_gauge_metrics[4];
+
+/**
+ * @brief Nombres de las métricas por cgroup.
+ */
+static const char* const cgroup_gauge_names[4] = {"cgroup_cpu_percentage", "cgroup_memory_current_bytes",
+                                                 "cgroup_io_read_bytes_per_second",
+                                                 "cgroup_io_write_bytes_per_second"};
+
+/**
+ * @brief Tiempo de CPU acumulado por cgroup.
+ */
+static prom_counter_t* cgroup_cpu_seconds_metric;
+
+/**
+ * @brief Crea las métricas cgroup_*{cgroup}.
+ */
+static int create_cgroups(metric_desc_t* desc)
+{
+    (void)desc;
+    const char* labels[] = {"cgroup"};
+    cgroup_gauge_metrics[0] = prom_gauge_new(cgroup_gauge_names[0], "Uso de CPU por cgroup (100 = un núcleo)", 1,
+                                             labels);
+    cgroup_gauge_metrics[1] = prom_gauge_new(cgroup_gauge_names[1], "memory.current por cgroup", 1, labels);
+    cgroup_gauge_metrics[2] = prom_gauge_new(cgroup_gauge_names[2], "Bytes leídos por segundo por cgroup", 1, labels);
+    cgroup_gauge_metrics[3] = prom_gauge_new(cgroup_gauge_names[3], "Bytes escritos por segundo por cgroup", 1, labels);
+    cgroup_cpu_seconds_metric = prom_counter_new("cgroup_cpu_usage_seconds_total",
+                                                 "Tiempo de CPU acumulado por cgroup (usage_usec)", 1, labels);
+    if (metric_registry_register(cgroup_cpu_seconds_metric, "cgroup_cpu_usage_seconds_total", 1, labels) == NULL)
+    {
+        return ERROR_INT;
+    }
+    for (int i = 0; i < 4; i++)
+    {
+        if (metric_registry_register(cgroup_gauge_metrics[i], cgroup_gauge_names[i], 1, labels) == NULL)
+        {
+            return ERROR_INT;
+        }
+    }
+    return INICIAL_VALUE;
+}
+
+/**
+ * @brief Publica el uso de cada cgroup seguido.
+ */
+static void update_cgroups(metric_batch_t* batch, const metric_desc_t* desc, const proc_snapshot_t* snap)
+{
+    (void)desc;
+    if (!(snap->valid & SNAPSHOT_CGROUPS))
+    {
+        return; // Sin cgroup v2; cgroup_scan() ya lo informó
+    }
+
+    for (int i = 0; i < snap->cgroup_count; i++)
+    {
+        const cgroup_usage_t* group = snap->cgroups[i];
+        const char* labels[] = {group->path};
+        double values[] = {group->cpu_percent, (double)group->memory_current, group->read_bytes_per_second,
+                           group->write_bytes_per_second};
+        for (int m = 0; m < 4; m++)
+        {
+            metric_batch_add(batch, cgroup_gauge_metrics[m], METRIC_GAUGE, values[m], labels, 1);
+        }
+        metric_batch_add(batch, cgroup_cpu_seconds_metric, METRIC_COUNTER, (double)group->usage_usec / 1e6, labels, 1);
+    }
+}
+
+/**
+ * @brief Métricas por montaje: capacidad e inodos.
+ */
+static prom_gauge_t* fs_gauge_metrics[7];
+
+/**
+ * @brief Nombres de las métricas por montaje.
+ */
+static const char* const fs_gauge_names[7] = {"filesystem_size_bytes",  "filesystem_free_bytes",
+                                             "filesystem_avail_bytes", "filesystem_used_bytes",
+                                             "filesystem_files",       "filesystem_files_free",
+                                             "filesystem_files_used"};
+
+/**
+ * @brief Ayuda de las métricas por montaje.
+ */
+static const char* const fs_gauge_help[7] = {"Capacidad total del sistema de archivos",
+                                            "Bytes libres, incluida la reserva de root",
+                                            "Bytes libres para usuarios sin privilegios",
+                                            "Bytes en uso",
+                                            "Inodos totales",
+                                            "Inodos libres",
+                                            "Inodos en uso"};
+
+/**
+ * @brief 1 si el statvfs() del montaje superó el plazo y sigue sin volver.
+ */
+static prom_gauge_t* fs_stale_metric;
+
+/**
+ * @brief Dispositivo de cada montaje, con valor 1.
+ */
+static prom_gauge_t* fs_info_metric;
+
+/**
+ * @brief 1 si ya se avisó que la tabla de montajes no se pudo leer; vuelve a 0 con la siguiente lectura válida.
+ */
+static int fs_invalid_warned = INICIAL_VALUE;
+
+/**
+ * @brief Crea las métricas filesystem_*{mountpoint,fstype}.
+ */
+static int create_filesystems(metric_desc_t* desc)
+{
+    (void)desc;
+    const char* labels[] = {"mountpoint", "fstype"};
+    const char* info_labels[] = {"mountpoint", "device"};
+    for (int i = 0; i < 7; i++)
+    {
+        fs_gauge_metrics[i] = prom_gauge_new(fs_gauge_names[i], fs_gauge_help[i], 2, labels);
+        if (metric_registry_register(fs_gauge_metrics[i], fs_gauge_names[i], 2, labels) == NULL)
+        {
+            return ERROR_INT;
+        }
+    }
+    fs_stale_metric = prom_gauge_new("filesystem_stale", "1 si statvfs() superó el plazo y sigue sin volver", 2,
+                                     labels);
+    fs_info_metric = prom_gauge_new("filesystem_info", "Dispositivo de cada montaje", 2, info_labels);
+    if (metric_registry_register(fs_stale_metric, "filesystem_stale", 2, labels) == NULL ||
+        metric_registry_register(fs_info_metric, "filesystem_info", 2, info_labels) == NULL)
+    {
+        return ERROR_INT;
+    }
+    return INICIAL_VALUE;
+}
+
+/**
+ * @brief Publica la capacidad y los inodos de cada montaje seleccionado.
+ */
+static void update_filesystems(metric_batch_t* batch, const metric_desc_t* desc, const proc_snapshot_t* snap)
+{
+    (void)desc;
+    if (!(snap->valid & SNAPSHOT_FILESYSTEMS))
+    {
+        if (!fs_invalid_warned)
+        {
+            fprintf(stderr, "Error al obtener los sistemas de archivos\n");
+            fs_invalid_warned = ASSIGNED_VALUE;
+        }
+        return;
+    }
+    fs_invalid_warned = INICIAL_VALUE;
+
+    for (int i = 0; i < snap->mount_count; i++)
+    {
+        const fs_mount_t* mount = &snap->mounts[i];
+        const char* labels[] = {mount->mountpoint, mount->fstype};
+        const char* info_labels[] = {mount->mountpoint, mount->device};
+        metric_batch_add(batch, fs_info_metric, METRIC_GAUGE, ASSIGNED_VALUE, info_labels, 2);
+        metric_batch_add(batch, fs_stale_metric, METRIC_GAUGE, mount->stale, labels, 2);
+        if (!mount->has_stats)
+        {
+            continue; // Sin respuesta dentro del plazo: mejor sin muestra que con una vieja
+        }
+        double values[] = {(double)mount->size_bytes,
+                           (double)mount->free_bytes,
+                           (double)mount->avail_bytes,
+                           (double)(mount->size_bytes - mount->free_bytes),
+                           (double)mount->files,
+                           (double)mount->files_free,
+                           (double)(mount->files - mount->files_free)};
+        for (int m = 0; m < 7; m++)
+        {
+            metric_batch_add(batch, fs_gauge_metrics[m], METRIC_GAUGE, values[m], labels, 2);
+        }
+    }
+}
+
+/**
+ * @brief Nombres base de los histogramas de eBPF, por enum bpf_latency_kind.
+ */
+static const char* const latency_names[BPF_LATENCY_COUNT] = {"bpf_runqueue_latency_seconds",
+                                                             "bpf_block_io_latency_seconds"};
+
+/**
+ * @brief Nombres de las series _bucket, _sum y _count de cada histograma.
+ */
+static char latency_series_names[BPF_LATENCY_COUNT][3][BUFFER_SIZE];
+
+/**
+ * @brief Contadores de las series _bucket{le}, _sum y _count de cada histograma.
+ */
+static prom_counter_t* latency_metrics[BPF_LATENCY_COUNT][3];
+
+/**
+ * @brief Valores de la etiqueta "le" de cada cubeta, más "+Inf".
+ */
+static char latency_bounds[BPF_LATENCY_SLOTS + 1][METRIC_LABEL_SIZE];
+
+/**
+ * @brief Crea bpf_*_latency_seconds_bucket{le}, _sum y _count.
+ *
+ * El histograma ya viene armado del kernel y prom_histogram_observe() solo acepta observaciones sueltas, así que se
+ * publica con las series de un histograma de Prometheus pero como contadores; histogram_quantile() las usa igual.
+ */
+static int create_latency(metric_desc_t* desc)
+{
+    (void)desc;
+    static const char* const suffixes[3] = {"_bucket", "_sum", "_count"};
+    static const char* const helps[BPF_LATENCY_COUNT] = {
+        "Espera en la cola de ejecución desde que una tarea queda lista hasta que corre",
+        "Latencia de los pedidos de E/S de bloque desde que se emiten hasta que terminan"};
+    const char* labels[] = {"le"};
+
+    for (int s = 0; s < BPF_LATENCY_SLOTS; s++)
+    {
+        snprintf(latency_bounds[s], sizeof(latency_bounds[s]), "%.9g", bpf_latency_slot_bound(s));
+    }
+    snprintf(latency_bounds[BPF_LATENCY_SLOTS], sizeof(latency_bounds[0]), "+Inf");
+
+    for (int k = 0; k < BPF_LATENCY_COUNT; k++)
+    {
+        for (int m = 0; m < 3; m++)
+        {
+            int label_count = m == 0 ? 1 : 0;
+            snprintf(latency_series_names[k][m], BUFFER_SIZE, "%s%s", latency_names[k], suffixes[m]);
+            latency_metrics[k][m] = prom_counter_new(latency_series_names[k][m], helps[k], label_count,
+                                                     label_count ? labels : NULL);
+            if (metric_registry_register(latency_metrics[k][m], latency_series_names[k][m], label_count, labels) ==
+                NULL)
+            {
+                return ERROR_INT;
+            }
+        }
+    }
+    return INICIAL_VALUE;
+}
+
+/**
+ * @brief Publica los histogramas de eBPF con las cubetas acumuladas, como espera Prometheus.
+ */
+static void update_latency(metric_batch_t* batch, const metric_desc_t* desc, const proc_snapshot_t* snap)
+{
+    (void)desc;
+    if (snap->latency == NULL)
+    {
+        return; // Sin eBPF; bpf_latency_scan() ya lo informó
+    }
+
+    for (int k = 0; k < BPF_LATENCY_COUNT; k++)
+    {
+        const bpf_latency_hist_t* hist = &snap->latency[k];
+        unsigned long long cumulative = INICIAL_VALUE;
+        for (int s = 0; s <= BPF_LATENCY_SLOTS; s++)
+        {
+            cumulative = s < BPF_LATENCY_SLOTS ? cumulative + hist->slots[s] : hist->count;
+            const char* labels[] = {latency_bounds[s]};
+            metric_batch_add(batch, latency_metrics[k][0], METRIC_COUNTER, (double)cumulative, labels, 1);
+        }
+        metric_batch_add(batch, latency_metrics[k][1], METRIC_COUNTER, (double)hist->sum_ns / 1e9, NULL, 0);
+        metric_batch_add(batch, latency_metrics[k][2], METRIC_COUNTER, (double)hist->count, NULL, 0);
+    }
+}
+
+/**
+ * @brief Tabla de métricas; el índice de cada fila es su bit en la máscara de habilitadas.
+ */
+static metric_desc_t registry[] = {
+    {.name = "cpu_usage_percentage", .alias = "cpu_usage_porcentage", .unit = "percent",
+     .help = "Porcentaje de uso de CPU por núcleo y modo", .source = SNAPSHOT_STAT, .kind = METRIC_GAUGE,
+     .label_count = 2, .labels = {"cpu", "mode"}, .update = update_cpu},
+    {.name = "cpu_usage_percentage_histogram", .unit = "percent", .help = "Distribución del uso de CPU por ciclo",
+     .source = SNAPSHOT_STAT, .kind = METRIC_HISTOGRAM, .update = update_cpu_histogram,
+     .create = create_cpu_histogram},
+    {.name = "context_switches_total", .alias = "change_contexts", .unit = "count",
+     .help = "Cambios de contexto desde el arranque", .source = SNAPSHOT_STAT, .kind = METRIC_COUNTER,
+     .value = change_context_value},
+    {.name = "context_switches_per_second", .unit = "1/s", .help = "Cambios de contexto por segundo",
+     .source = SNAPSHOT_STAT, .kind = METRIC_GAUGE, .value = context_switches_rate_value},
+    {.name = "processes_forked_total", .alias = "total_processes", .unit = "count",
+     .help = "Procesos creados desde el arranque", .source = SNAPSHOT_STAT, .kind = METRIC_COUNTER,
+     .value = total_processes_value},
+    {.name = "memory_usage_percentage", .unit = "percent", .help = "Porcentaje de uso de memoria",
+     .source = SNAPSHOT_MEMINFO, .kind = METRIC_GAUGE, .value = get_memory_usage},
+    {.name = "memory_available", .unit = "kB", .help = "Memoria disponible del sistema", .source = SNAPSHOT_MEMINFO,
+     .kind = METRIC_GAUGE, .value = get_memory_avalible},
+    {.name = "memory_total", .unit = "kB", .help = "Memoria total del sistema", .source = SNAPSHOT_MEMINFO,
+     .kind = METRIC_GAUGE, .value = get_memory_total},
+    {.name = "memory_usage_2", .unit = "ratio", .help = "Uso de memoria (otra métrica)", .source = SNAPSHOT_MEMINFO,
+     .kind = METRIC_GAUGE, .value = get_memory_usage_2},
+    {.name = "major_page_faults_total", .alias = "major_page_faults", .unit = "count",
+     .help = "Fallos de página mayores desde el arranque", .source = SNAPSHOT_VMSTAT, .kind = METRIC_COUNTER,
+     .value = major_page_faults_value},
+    {.name = "minor_page_faults_total", .alias = "minor_page_faults", .unit = "count",
+     .help = "Fallos de página menores desde el arranque", .source = SNAPSHOT_VMSTAT, .kind = METRIC_COUNTER,
+     .value = minor_page_faults_value},
+    {.name = "meminfo", .unit = "bytes, count", .help = "Campos de /proc/meminfo elegidos con memory_fields",
+     .source = SNAPSHOT_MEMINFO, .kind = METRIC_GAUGE, .update = update_meminfo, .create = create_meminfo},
+    {.name = "vmstat", .unit = "count", .help = "Contadores de /proc/vmstat elegidos con memory_fields",
+     .source = SNAPSHOT_VMSTAT, .kind = METRIC_COUNTER, .update = update_vmstat, .create = create_vmstat},
+    {.name = "disk_usage_percentage", .alias = "disk_usage_porcentage", .unit = "MB/s",
+     .help = "Uso de disco", .source = SNAPSHOT_DISKSTATS, .kind = METRIC_GAUGE, .value = get_disk_usage},
+    {.name = "disk_devices", .unit = "bytes/s", .help = "Tasas de lectura y escritura por dispositivo",
+     .source = SNAPSHOT_DISKSTATS, .kind = METRIC_GAUGE, .update = update_disk_devices,
+     .create = create_disk_devices},
+    {.name = "disk_operations_total", .alias = "disk_stats", .unit = "count",
+     .help = "Lecturas y escrituras completadas en los dispositivos seleccionados", .source = SNAPSHOT_DISKSTATS,
+     .kind = METRIC_COUNTER, .value = disk_operations_value},
+    {.name = "bandwidth_usage", .alias = "bandwith_usage", .unit = "MB/s", .help = "Ancho de banda en uso",
+     .source = SNAPSHOT_NETDEV, .kind = METRIC_GAUGE, .value = get_average_bandwidth},
+    {.name = "bandwidth_usage_histogram", .unit = "MB/s", .help = "Distribución del ancho de banda por ciclo",
+     .source = SNAPSHOT_NETDEV, .kind = METRIC_HISTOGRAM, .update = update_bandwidth_histogram,
+     .create = create_bandwidth_histogram},
+    {.name = "network_bytes_total", .alias = "network_usage", .unit = "bytes",
+     .help = "Bytes recibidos y transmitidos por las interfaces seleccionadas", .source = SNAPSHOT_NETDEV,
+     .kind = METRIC_COUNTER, .value = network_bytes_value},
+    {.name = "network_interfaces", .unit = "bytes", .help = "Contadores y tasas por interfaz de red",
+     .source = SNAPSHOT_NETDEV, .kind = METRIC_COUNTER, .update = update_netdev, .create = create_netdev},
+    {.name = "pressure", .unit = "percent, seconds", .help = "Pressure Stall Information de CPU, memoria y E/S",
+     .source = SNAPSHOT_PSI, .kind = METRIC_GAUGE, .update = update_pressure, .create = create_pressure},
+    {.name = "schedstat", .unit = "seconds, count", .help = "Latencia de la cola de ejecución (/proc/schedstat)",
+     .source = SNAPSHOT_SCHEDSTAT, .kind = METRIC_COUNTER, .update = update_schedstat, .create = create_schedstat},
+    {.name = "processes_tracked", .unit = "count", .help = "Procesos seguidos en /proc", .source = SNAPSHOT_PROCS,
+     .kind = METRIC_GAUGE, .value = processes_tracked_value},
+    {.name = "process_births_total", .unit = "count", .help = "Procesos nuevos vistos", .source = SNAPSHOT_PROCS,
+     .kind = METRIC_COUNTER, .value = process_births_value},
+    {.name = "process_exits_total", .unit = "count", .help = "Procesos terminados vistos", .source = SNAPSHOT_PROCS,
+     .kind = METRIC_COUNTER, .value = process_exits_value},
+    {.name = "process_top", .unit = "percent, bytes, bytes/s", .help = "Procesos que más CPU, memoria y E/S usan",
+     .source = SNAPSHOT_PROCS, .kind = METRIC_GAUGE, .update = update_process_top, .create = create_process_top},
+    {.name = "cgroup_usage", .unit = "percent, bytes, bytes/s", .help = "Uso de CPU, memoria y E/S por cgroup v2",
+     .source = SNAPSHOT_CGROUPS, .kind = METRIC_GAUGE, .update = update_cgroups, .create = create_cgroups},
+    {.name = "bpf_latency", .unit = "seconds", .help = "Latencia de planificación y de E/S de bloque medida con eBPF",
+     .source = SNAPSHOT_BPF, .kind = METRIC_COUNTER, .update = update_latency, .create = create_latency},
+    {.name = "filesystem_usage", .unit = "bytes, count", .help = "Capacidad e inodos por sistema de archivos montado",
+     .source = SNAPSHOT_FILESYSTEMS, .kind = METRIC_GAUGE, .update = update_filesystems,
+     .create = create_filesystems},
+};
+
+/**
+ * @brief Cantidad de descriptores.
+ */
+#define REGISTRY_COUNT ((int)(sizeof(registry) / sizeof(registry[0])))
+
+_Static_assert(sizeof(registry) / sizeof(registry[0]) <= METRIC_REGISTRY_MAX, "demasiadas métricas para la máscara");
+
+/**
+ * @brief Textos de ayuda con la unidad; libprom no copia la ayuda.
+ */
+static char help_texts[REGISTRY_COUNT][BUFFER_SIZE];
+
+/**
+ * @brief Máscara de métricas habilitadas; se reemplaza entera al recargar la configuración.
+ */
+static atomic_ullong enabled_mask = METRIC_REGISTRY_ALL;
+
+/**
+ * @brief Crea y registra las métricas de todos los descriptores.
+ *
+ * @return 0 en caso de éxito, -1 si alguna falló.
+ */
+int metric_registry_init()
+{
+    int ret = INICIAL_VALUE;
+
+    for (int i = 0; i < REGISTRY_COUNT; i++)
+    {
+        metric_desc_t* desc = &registry[i];
+        if (desc->create != NULL)
+        {
+            if (desc->create(desc) != INICIAL_VALUE)
+            {
+                fprintf(stderr, "Error al crear la métrica %s\n", desc->name);
+                ret = ERROR_INT;
+            }
+            continue;
+        }
+
+        snprintf(help_texts[i], BUFFER_SIZE, "%s (%s)", desc->help, desc->unit);
+        desc->metric = desc->kind == METRIC_COUNTER
+                           ? (void*)prom_counter_new(desc->name, help_texts[i], desc->label_count, desc->labels)
+                           : (void*)prom_gauge_new(desc->name, help_texts[i], desc->label_count, desc->labels);
+        if (metric_registry_register(desc->metric, desc->name, desc->label_count, desc->labels) == NULL)
+        {
+            fprintf(stderr, "Error al crear la métrica %s\n", desc->name);
+            desc->metric = NULL;
+            ret = ERROR_INT;
+        }
+    }
+    return ret;
+}
+
+/**
+ * @brief Devuelve la cantidad de descriptores.
+ *
+ * @return Cantidad de descriptores.
+ */
+int metric_registry_count()
+{
+    return REGISTRY_COUNT;
+}
+
+/**
+ * @brief Devuelve un descriptor.
+ *
+ * @param index Índice del descriptor.
+ * @return Descriptor.
+ */
+const metric_desc_t* metric_registry_at(int index)
+{
+    return &registry[index];
+}
+
+/**
+ * @brief Calcula la máscara de las métricas que coinciden con algún patrón.
+ *
+ * @param patterns Patrones fnmatch.
+ * @param count Cantidad de patrones.
+ * @return Máscara de métricas.
+ */
+unsigned long long metric_registry_match(const char* const* patterns, int count)
+{
+    unsigned long long mask = INICIAL_VALUE;
+
+    for (int i = 0; i < REGISTRY_COUNT; i++)
+    {
+        for (int p = 0; p < count; p++)
+        {
+            if (fnmatch(patterns[p], registry[i].name, INICIAL_VALUE) == INICIAL_VALUE ||
+                (registry[i].alias != NULL && strcmp(patterns[p], registry[i].alias) == INICIAL_VALUE))
+            {
+                mask |= 1ULL << i;
+                break;
+            }
+        }
+    }
+    return mask;
+}
+
+/**
+ * @brief Reemplaza las métricas habilitadas.
+ *
+ * @param mask Máscara de métricas habilitadas.
+ */
+void metric_registry_set_enabled(unsigned long long mask)
+{
+    atomic_store(&enabled_mask, mask);
+}
+
+/**
+ * @brief Devuelve la máscara de métricas habilitadas.
+ *
+ * @return Máscara de métricas habilitadas.
+ */
+unsigned long long metric_registry_enabled()
+{
+    return atomic_load(&enabled_mask);
+}
+
+/**
+ * @brief Devuelve las fuentes de /proc que necesitan las métricas de una máscara.
+ *
+ * @param mask Máscara de métricas.
+ * @return Máscara SNAPSHOT_*.
+ */
+unsigned int metric_registry_sources(unsigned long long mask)
+{
+    unsigned int sources = INICIAL_VALUE;
+
+    for (int i = 0; i < REGISTRY_COUNT; i++)
+    {
+        if (mask & (1ULL << i))
+        {
+            sources |= registry[i].source;
+        }
+    }
+    return sources;
+}
+
+/**
+ * @brief Agrega al lote las métricas habilitadas de las fuentes indicadas.
+ *
+ * @param batch Lote de la tarea.
+ * @param snap Instantánea de /proc.
+ * @param sources Máscara SNAPSHOT_* de la tarea.
+ * @param mask Máscara de métricas habilitadas.
+ */
+void metric_registry_collect(metric_batch_t* batch, const proc_snapshot_t* snap, unsigned int sources,
+                             unsigned long long mask)
+{
+    for (int i = 0; i < REGISTRY_COUNT; i++)
+    {
+        const metric_desc_t* desc = &registry[i];
+        if (!(mask & (1ULL << i)) || !(desc->source & sources))
+        {
+            continue;
+        }
+
+        if (desc->update != NULL)
+        {
+            desc->update(batch, desc, snap);
+            continue;
+        }
+
+        double value = desc->value(snap);
+        if (value >= INICIAL_VALUE)
+        {
+            metric_batch_add(batch, desc->metric, desc->kind, value, NULL, 0);
+        }
+        else
+        {
+            fprintf(stderr, "Error al obtener la métrica %s\n", desc->name);
+        }
+    }
+}
@@ -0,0 +1,276 @@
+/**
+ * @file metric_store.c
+ * @brief Canales de muestras con tres buffers y publicación por intercambio atómico.
+ *
+ * Protocolo del lector: leer published, incrementar readers de ese buffer y verificar que published no cambió; si
+ * cambió, soltarlo y reintentar. El productor solo elige buffers que no son el publicado y cuyo contador de
+ * lectores es cero, por lo que un lector que llega tarde nunca queda fijado sobre un buffer en escritura.
+ */
+
+#include "metric_store.h"
+#include "metrics.h"
+#include <stdint.h>
+
+/**
+ * @brief Capacidad inicial de un lote.
+ */
+#define METRIC_BATCH_INITIAL_CAP 64
+
+/**
+ * @brief Canales registrados.
+ */
+static metric_channel_t* channels[METRIC_STORE_MAX_CHANNELS];
+
+/**
+ * @brief Cantidad de canales registrados; se publica después de guardar el canal.
+ */
+static atomic_int channel_count = INICIAL_VALUE;
+
+/**
+ * @brief Generación del almacén; aumenta con cada publicación.
+ */
+static atomic_ullong store_generation = INICIAL_VALUE;
+
+/**
+ * @brief Crea y registra un canal.
+ *
+ * @param name Nombre del productor.
+ * @return Canal creado, o NULL en caso de error.
+ */
+metric_channel_t* metric_channel_new(const char* name)
+{
+    int index = atomic_load(&channel_count);
+    if (index >= METRIC_STORE_MAX_CHANNELS)
+    {
+        fprintf(stderr, "No hay lugar para el canal de métricas %s\n", name);
+        return NULL;
+    }
+
+    metric_channel_t* ch = calloc(1, sizeof(*ch));
+    if (ch == NULL)
+    {
+        perror("Error al asignar memoria");
+        return NULL;
+    }
+    ch->name = name;
+    ch->writing = ERROR_INT;
+    atomic_init(&ch->published, ERROR_INT);
+    for (int i = 0; i < METRIC_STORE_BUFFERS; i++)
+    {
+        atomic_init(&ch->readers[i], INICIAL_VALUE);
+    }
+
+    // Los canales se crean desde un único hilo antes de que empiecen los scrapes que los recorren
+    channels[index] = ch;
+    atomic_store(&channel_count, index + 1);
+    return ch;
+}
+
+/**
+ * @brief Empieza un lote nuevo en un buffer libre.
+ *
+ * @param ch Canal del productor.
+ * @return Lote vacío, o NULL si todos los buffers están ocupados.
+ */
+metric_batch_t* metric_batch_begin(metric_channel_t* ch)
+{
+    int published = atomic_load(&ch->published);
+
+    for (int i = 0; i < METRIC_STORE_BUFFERS; i++)
+    {
+        if (i != published && atomic_load(&ch->readers[i]) == INICIAL_VALUE)
+        {
+            ch->writing = i;
+            ch->buffers[i].count = INICIAL_VALUE;
+            return &ch->buffers[i];
+        }
+    }
+
+    ch->writing = ERROR_INT;
+    return NULL;
+}
+
+/**
+ * @brief Copia un valor de etiqueta en METRIC_LABEL_SIZE bytes.
+ *
+ * Un valor que no entra conserva su comienzo (sin cortar un carácter UTF-8) y termina con '~' y el hash FNV-1a del
+ * valor completo: dos puntos de montaje largos con el mismo prefijo no se confunden en una sola serie.
+ *
+ * @param dst Destino.
+ * @param src Valor.
+ */
+static void copy_label(char* dst, const char* src)
+{
+    size_t len = strlen(src);
+    if (len < METRIC_LABEL_SIZE)
+    {
+        memcpy(dst, src, len + ASSIGNED_VALUE);
+        return;
+    }
+
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < len; i++)
+    {
+        hash = (hash ^ (unsigned char)src[i]) * 16777619u;
+    }
+    size_t keep = METRIC_LABEL_SIZE - METRIC_LABEL_HASH_LEN - ASSIGNED_VALUE;
+    while (keep > INICIAL_VALUE && ((unsigned char)src[keep] & 0xc0) == 0x80)
+    {
+        keep--;
+    }
+    memcpy(dst, src, keep);
+    snprintf(dst + keep, METRIC_LABEL_HASH_LEN + ASSIGNED_VALUE, "~%08x", (unsigned int)hash);
+}
+
+/**
+ * @brief Agrega una muestra al lote, duplicando su capacidad si hace falta.
+ *
+ * @param batch Lote en construcción.
+ * @param metric Métrica de destino.
+ * @param kind Tipo de la muestra.
+ * @param value Valor.
+ * @param labels Valores de las etiquetas.
+ * @param label_count Cantidad de etiquetas.
+ */
+void metric_batch_add(metric_batch_t* batch, void* metric, metric_kind_t kind, double value, const char** labels,
+                      int label_count)
+{
+    if (batch == NULL || metric == NULL)
+    {
+        return;
+    }
+
+    if (batch->count == batch->cap)
+    {
+        size_t cap = batch->cap ? batch->cap * 2 : METRIC_BATCH_INITIAL_CAP;
+        metric_sample_t* bigger = realloc(batch->samples, cap * sizeof(*bigger));
+        if (bigger == NULL)
+        {
+            perror("Error al asignar memoria");
+            return;
+        }
+        batch->samples = bigger;
+        batch->cap = cap;
+    }
+
+    metric_sample_t* sample = &batch->samples[batch->count++];
+    sample->metric = metric;
+    sample->kind = kind;
+    sample->value = value;
+    sample->label_count = label_count < METRIC_MAX_LABELS ? label_count : METRIC_MAX_LABELS;
+    for (int i = 0; i < sample->label_count; i++)
+    {
+        copy_label(sample->labels[i], labels[i]);
+    }
+}
+
+/**
+ * @brief Hash FNV-1a de los valores de las etiquetas, con un separador después de cada uno.
+ *
+ * @param labels Valores de las etiquetas.
+ * @param label_count Cantidad de etiquetas válidas.
+ * @return Hash.
+ */
+uint64_t metric_labels_hash(const char (*labels)[METRIC_LABEL_SIZE], int label_count)
+{
+    uint64_t hash = 14695981039346656037ULL;
+    for (int l = 0; l < label_count; l++)
+    {
+        for (const char* c = labels[l]; *c != '\0'; c++)
+        {
+            hash = (hash ^ (unsigned char)*c) * 1099511628211ULL;
+        }
+        hash = (hash ^ 0xff) * 1099511628211ULL;
+    }
+    return hash;
+}
+
+/**
+ * @brief Publica el lote en construcción.
+ *
+ * @param ch Canal del productor.
+ */
+void metric_batch_publish(metric_channel_t* ch)
+{
+    if (ch->writing >= INICIAL_VALUE)
+    {
+        atomic_store(&ch->published, ch->writing);
+        ch->writing = ERROR_INT;
+        atomic_fetch_add(&store_generation, ASSIGNED_VALUE);
+    }
+}
+
+/**
+ * @brief Devuelve la generación del almacén.
+ *
+ * @return Generación actual.
+ */
+unsigned long long metric_store_generation()
+{
+    return atomic_load(&store_generation);
+}
+
+/**
+ * @brief Devuelve la cantidad de canales registrados.
+ *
+ * @return Cantidad de canales.
+ */
+int metric_channel_count()
+{
+    return atomic_load(&channel_count);
+}
+
+/**
+ * @brief Devuelve un canal registrado.
+ *
+ * @param index Índice del canal.
+ * @return Canal.
+ */
+metric_channel_t* metric_channel_at(int index)
+{
+    return channels[index];
+}
+
+/**
+ * @brief Fija el último lote publicado de un canal.
+ *
+ * @param ch Canal.
+ * @param slot Índice fijado.
+ * @return Lote publicado, o NULL si no hay ninguno.
+ */
+const metric_batch_t* metric_store_acquire(metric_channel_t* ch, int* slot)
+{
+    for (;;)
+    {
+        int published = atomic_load(&ch->published);
+        if (published < INICIAL_VALUE)
+        {
+            *slot = ERROR_INT;
+            return NULL;
+        }
+
+        atomic_fetch_add(&ch->readers[published], ASSIGNED_VALUE);
+        if (atomic_load(&ch->published) == published)
+        {
+            *slot = published;
+            return &ch->buffers[published];
+        }
+
+        // El productor publicó otro buffer entre la lectura y la fijación: reintentar con el nuevo
+        atomic_fetch_sub(&ch->readers[published], ASSIGNED_VALUE);
+    }
+}
+
+/**
+ * @brief Libera un lote fijado.
+ *
+ * @param ch Canal.
+ * @param slot Índice devuelto por metric_store_acquire().
+ */
+void metric_store_release(metric_channel_t* ch, int slot)
+{
+    if (slot >= INICIAL_VALUE)
+    {
+        atomic_fetch_sub(&ch->readers[slot], ASSIGNED_VALUE);
+    }
+}
@@ -0,0 +1,174 @@
+/**
+ * @file monitor.c
+ * @brief Arranque y parada del monitor, compartidos por monitoring_project y los programas que embeben libmonitor.
+ */
+
+#include "monitor.h"
+#include "aggregator.h"
+#include "alert.h"
+#include "collector.h"
+#include "expose_metrics.h"
+#include "history.h"
+#include "push.h"
+
+/**
+ * @brief Configuración vigente; se reemplaza en cada recarga válida.
+ */
+static Config config;
+
+/**
+ * @brief Ruta de config.json.
+ */
+static const char* config_filename = MONITOR_DEFAULT_CONFIG_PATH;
+
+/**
+ * @brief 1 si monitor_start() inició el servidor HTTP.
+ */
+static int serving_http = INICIAL_VALUE;
+
+/**
+ * @brief Inicia el agregador con las opciones de config.json.
+ *
+ * @param config Configuración leída al arrancar; las opciones se copian, así que puede liberarse después.
+ * @return 0 en caso de éxito, -1 en caso de error.
+ */
+static int start_aggregator(const Config* config)
+{
+    aggregator_group_t groups[AGGREGATOR_MAX_GROUPS];
+    int group_count = config->aggregator_groups_count < AGGREGATOR_MAX_GROUPS ? config->aggregator_groups_count
+                                                                               : AGGREGATOR_MAX_GROUPS;
+    for (int i = 0; i < group_count; i++)
+    {
+        groups[i].name = config->aggregator_groups[i].name;
+        groups[i].hosts = (const char* const*)config->aggregator_groups[i].hosts;
+        groups[i].host_count = config->aggregator_groups[i].hosts_count;
+    }
+
+    aggregator_options_t options = {
+        .listen = config->aggregator_listen,
+        .group_label = config->aggregator_group_label,
+        .groups = groups,
+        .group_count = group_count,
+        .quantiles = config->aggregator_quantiles,
+        .quantile_count = config->aggregator_quantiles_count,
+        .interval_ms = config->aggregator_interval_ms,
+        .stale_ms = config->aggregator_stale_ms,
+    };
+    return aggregator_start(&options);
+}
+
+int monitor_start(const monitor_options_t* options)
+{
+    monitor_options_t opts = {.config_path = NULL, .serve_http = true};
+    if (options != NULL)
+    {
+        opts = *options;
+    }
+    config_filename = opts.config_path != NULL ? opts.config_path : MONITOR_DEFAULT_CONFIG_PATH;
+
+    init_metrics(); /**< Inicializa la recolección de métricas. */
+
+    // La configuración se lee antes de iniciar las tareas para que la primera muestra ya use sus intervalos
+    if (config_load(config_filename, &config) == 0)
+    {
+        config_apply(&config);
+    }
+    config_watch(config_filename);
+
+    // La dirección, el puerto y el modo del servidor solo se leen al arrancar
+    if (opts.serve_http)
+    {
+        http_options_t http = {
+            .bind = config.http_bind,
+            .port = config.http_port,
+            .mode = config.http_mode,
+            .threads = config.http_threads,
+            .connection_timeout = config.http_connection_timeout,
+            .connection_limit = config.http_connection_limit,
+            .backlog = config.http_backlog,
+        };
+        if (expose_metrics_start(&http) != 0)
+        {
+            monitor_stop();
+            return ERROR_INT;
+        }
+        serving_http = ASSIGNED_VALUE;
+    }
+
+    // El historial se dimensiona una sola vez; recargar config.json no cambia su tamaño ni su archivo
+    if (history_init(config.history_samples, config.history_max_series, config.history_file) != 0)
+    {
+        fprintf(stderr, "Error al iniciar el historial de muestras\n");
+    }
+
+    // Envío opcional a un receptor remoto, para los nodos que no se pueden scrapear; tampoco cambia al recargar
+    if (config.push_mode != NULL && push_start(config.push_mode, config.push_url, config.push_interval_ms,
+                                               config.push_queue_size, config.push_max_batch) != 0)
+    {
+        fprintf(stderr, "Error al iniciar el envío de métricas\n");
+    }
+
+    // Modo agregador: recibe el line protocol de otros agentes y agrega a /metrics sus series resumidas por grupo
+    if (config.aggregator_enabled && start_aggregator(&config) != 0)
+    {
+        fprintf(stderr, "Error al iniciar el agregador\n");
+    }
+
+    // Alertas: las reglas ya se compilaron en config_apply(); el webhook y el socket no cambian al recargar
+    if ((config.alert_webhook != NULL || config.alert_socket != NULL) &&
+        alert_start(config.alert_webhook, config.alert_socket) != 0)
+    {
+        fprintf(stderr, "Error al iniciar las alertas\n");
+    }
+
+    // Cada fuente de /proc se recolecta en su propia tarea, con su intervalo y plazo
+    if (collectors_start() != 0)
+    {
+        fprintf(stderr, "Error al iniciar las tareas de recolección\n");
+        monitor_stop();
+        return ERROR_INT;
+    }
+    return INICIAL_VALUE;
+}
+
+int monitor_poll_config(int timeout_ms)
+{
+    // Parsear de nuevo solo cuando inotify (o mtime y tamaño) indica un cambio
+    if (!config_wait_change(timeout_ms))
+    {
+        return INICIAL_VALUE;
+    }
+
+    // Un archivo inválido no reemplaza a la configuración vigente
+    Config next;
+    if (config_load(config_filename, &next) != 0)
+    {
+        return INICIAL_VALUE;
+    }
+    config_apply(&next);
+    config_free(&config);
+    config = next;
+    return ASSIGNED_VALUE;
+}
+
+void monitor_stop()
+{
+    // Primero deja de aceptar scrapes, después se detienen los productores y al final se libera lo que comparten.
+    // Cada parada no hace nada si su parte no llegó a iniciarse, así que tras un arranque fallido deshace solo lo que
+    // monitor_start() alcanzó a hacer
+    if (serving_http)
+    {
+        expose_metrics_stop();
+        serving_http = INICIAL_VALUE;
+    }
+    collectors_stop();
+    push_stop();
+    aggregator_stop();
+    alert_stop();
+    monitor_snapshot_close();
+    history_close();
+    config_unwatch();
+    config_free(&config);
+    destroy_mutex();
+    snapshot_close();
+}
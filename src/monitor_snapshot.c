@@ -0,0 +1,441 @@
+/**
+ * @file monitor_snapshot.c
+ * @brief Armado y publicación de las instantáneas de monitor_snapshot.h.
+ *
+ * Protocolo del lector: el mismo de metric_store.c (leer published, incrementar readers de ese buffer y verificar
+ * que published no cambió). Los armadores se serializan con build_lock, que nunca toma un lector: un hilo que
+ * encuentra el lock ocupado solo marca pending y vuelve, y el que lo tiene arma otra instantánea antes de soltarlo,
+ * así que ningún lote publicado queda sin reflejar y ninguna tarea espera a otra. Si los lectores fijaron todos los
+ * buffers, pending queda marcado y la instantánea la arma el lector que suelta el último de un buffer.
+ */
+
+#include "monitor_snapshot.h"
+#include "history.h"
+#include "metric_registry.h"
+#include "metrics.h"
+#include <pthread.h>
+#include <sys/eventfd.h>
+
+/**
+ * @brief Buffer de una instantánea; la parte pública va primero para recuperar el buffer desde el puntero.
+ */
+typedef struct
+{
+    monitor_snapshot_t snapshot; ///< Instantánea que ve el lector.
+    monitor_sample_t* samples;   ///< Muestras del buffer.
+    size_t cap;                  ///< Capacidad de samples.
+    atomic_int readers;          ///< Lectores que fijaron el buffer.
+} snapshot_buffer_t;
+
+/**
+ * @brief Suscripción a las instantáneas publicadas.
+ */
+typedef struct
+{
+    monitor_snapshot_cb cb; ///< Función, o NULL si el lugar está libre.
+    void* arg;              ///< Argumento de la función.
+} snapshot_subscriber_t;
+
+/**
+ * @brief Buffers de las instantáneas.
+ */
+static snapshot_buffer_t buffers[MONITOR_SNAPSHOT_BUFFERS];
+
+/**
+ * @brief Índice del buffer publicado, o -1.
+ */
+static atomic_int published = ERROR_INT;
+
+/**
+ * @brief Versión de la última instantánea publicada.
+ */
+static atomic_ullong published_version = INICIAL_VALUE;
+
+/**
+ * @brief 1 desde que alguien pidió una instantánea, una suscripción o el eventfd.
+ */
+static atomic_int enabled = INICIAL_VALUE;
+
+/**
+ * @brief 1 si se publicó un lote que todavía no está en una instantánea.
+ */
+static atomic_int pending = INICIAL_VALUE;
+
+/**
+ * @brief Serializa a los armadores.
+ */
+static pthread_mutex_t build_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * @brief Suscripciones; subscribers_lock se mantiene durante las llamadas para que quitar una sea sincrónico.
+ */
+static snapshot_subscriber_t subscribers[MONITOR_SNAPSHOT_MAX_SUBSCRIBERS];
+
+/**
+ * @brief Suscripciones activas; se lee sin lock para no tomar subscribers_lock si no hay ninguna.
+ */
+static atomic_int subscriber_count = INICIAL_VALUE;
+
+/**
+ * @brief Protege subscribers y la creación del eventfd.
+ */
+static pthread_mutex_t subscribers_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * @brief eventfd de monitor_snapshot_eventfd(), o -1.
+ */
+static atomic_int event_fd = ERROR_INT;
+
+/**
+ * @brief Activa el armado; la primera vez arma la instantánea inicial con lo que ya está en el almacén.
+ */
+static void snapshot_enable()
+{
+    if (!atomic_exchange(&enabled, ASSIGNED_VALUE))
+    {
+        monitor_snapshot_update();
+    }
+}
+
+/**
+ * @brief Asegura la capacidad de un buffer.
+ *
+ * @return 0 en caso de éxito, -1 si no hay memoria.
+ */
+static int buffer_reserve(snapshot_buffer_t* buffer, size_t count)
+{
+    if (count <= buffer->cap)
+    {
+        return INICIAL_VALUE;
+    }
+    size_t cap = buffer->cap ? buffer->cap : 256;
+    while (cap < count)
+    {
+        cap *= 2;
+    }
+    monitor_sample_t* bigger = realloc(buffer->samples, cap * sizeof(*bigger));
+    if (bigger == NULL)
+    {
+        perror("Error al asignar memoria");
+        return ERROR_INT;
+    }
+    buffer->samples = bigger;
+    buffer->cap = cap;
+    return INICIAL_VALUE;
+}
+
+/**
+ * @brief Busca un buffer que no esté publicado ni fijado por un lector.
+ *
+ * @return Buffer libre, o NULL si todos los demás están fijados.
+ */
+static snapshot_buffer_t* snapshot_free_buffer()
+{
+    int current = atomic_load(&published);
+    for (int i = 0; i < MONITOR_SNAPSHOT_BUFFERS; i++)
+    {
+        if (i != current && atomic_load(&buffers[i].readers) == INICIAL_VALUE)
+        {
+            return &buffers[i];
+        }
+    }
+    return NULL;
+}
+
+/**
+ * @brief Copia el último lote de cada canal en un buffer libre y lo publica.
+ *
+ * Se llama con build_lock tomado.
+ *
+ * @param buffer Buffer devuelto por snapshot_free_buffer().
+ * @return 0 en caso de éxito, -1 si faltó memoria.
+ */
+static int snapshot_build(snapshot_buffer_t* buffer)
+{
+    // La generación se lee antes que los lotes: un lote publicado durante la copia deja la siguiente como pendiente
+    unsigned long long generation = metric_store_generation();
+    const metric_batch_t* batches[METRIC_STORE_MAX_CHANNELS];
+    int slots[METRIC_STORE_MAX_CHANNELS];
+    int channels = metric_channel_count();
+    size_t total = INICIAL_VALUE;
+    for (int c = 0; c < channels; c++)
+    {
+        batches[c] = metric_store_acquire(metric_channel_at(c), &slots[c]);
+        total += batches[c] != NULL ? batches[c]->count : INICIAL_VALUE;
+    }
+
+    int ok = buffer_reserve(buffer, total) == INICIAL_VALUE;
+    size_t count = INICIAL_VALUE;
+    const void* last_metric = NULL;
+    const metric_info_t* info = NULL;
+    for (int c = 0; c < channels; c++)
+    {
+        for (size_t i = 0; ok && batches[c] != NULL && i < batches[c]->count; i++)
+        {
+            const metric_sample_t* sample = &batches[c]->samples[i];
+            if (sample->kind == METRIC_HISTOGRAM)
+            {
+                continue;
+            }
+            // Las muestras de una métrica van seguidas en el lote: el nombre se busca una vez por métrica
+            if (sample->metric != last_metric)
+            {
+                last_metric = sample->metric;
+                info = metric_registry_metric_info(sample->metric);
+            }
+            if (info == NULL)
+            {
+                continue;
+            }
+
+            monitor_sample_t* out = &buffer->samples[count++];
+            out->name = info->name;
+            out->kind = sample->kind;
+            out->label_count = sample->label_count;
+            for (int l = 0; l < METRIC_MAX_LABELS; l++)
+            {
+                out->label_names[l] = l < info->label_count ? info->labels[l] : NULL;
+            }
+            memcpy(out->labels, sample->labels, sizeof(out->labels));
+            out->value = sample->value;
+        }
+        metric_store_release(metric_channel_at(c), slots[c]);
+    }
+    if (!ok)
+    {
+        return ERROR_INT;
+    }
+
+    buffer->snapshot.samples = buffer->samples;
+    buffer->snapshot.count = count;
+    buffer->snapshot.generation = generation;
+    buffer->snapshot.timestamp_ms = history_now_ms();
+    buffer->snapshot.version = atomic_load(&published_version) + ASSIGNED_VALUE;
+    atomic_store(&published, (int)(buffer - buffers));
+    atomic_store(&published_version, buffer->snapshot.version);
+    return INICIAL_VALUE;
+}
+
+/**
+ * @brief Avisa a los suscriptores y al eventfd de una instantánea recién publicada.
+ *
+ * Se llama con build_lock tomado, así que el buffer no se reutiliza mientras corren las funciones.
+ */
+static void snapshot_notify(const snapshot_buffer_t* buffer)
+{
+    if (atomic_load(&subscriber_count) > INICIAL_VALUE)
+    {
+        pthread_mutex_lock(&subscribers_lock);
+        for (int i = 0; i < MONITOR_SNAPSHOT_MAX_SUBSCRIBERS; i++)
+        {
+            if (subscribers[i].cb != NULL)
+            {
+                subscribers[i].cb(&buffer->snapshot, subscribers[i].arg);
+            }
+        }
+        pthread_mutex_unlock(&subscribers_lock);
+    }
+
+    int fd = atomic_load(&event_fd);
+    if (fd >= INICIAL_VALUE)
+    {
+        uint64_t one = ASSIGNED_VALUE;
+        ssize_t written = write(fd, &one, sizeof(one));
+        (void)written; // Con el contador saturado el lector igual está avisado
+    }
+}
+
+void monitor_snapshot_update()
+{
+    if (!atomic_load(&enabled))
+    {
+        return;
+    }
+
+    // Si otro hilo está armando, ve pending al terminar y arma otra; si lo soltó justo antes de que se marcara, el
+    // bucle lo vuelve a intentar
+    atomic_store(&pending, ASSIGNED_VALUE);
+    while (atomic_load(&pending) && pthread_mutex_trylock(&build_lock) == INICIAL_VALUE)
+    {
+        int blocked = INICIAL_VALUE;
+        while (!blocked && atomic_exchange(&pending, INICIAL_VALUE))
+        {
+            snapshot_buffer_t* buffer = snapshot_free_buffer();
+            if (buffer == NULL)
+            {
+                // Los lectores fijaron todos los buffers: el lote queda pendiente, no perdido
+                atomic_store(&pending, ASSIGNED_VALUE);
+                blocked = ASSIGNED_VALUE;
+            }
+            else if (snapshot_build(buffer) == INICIAL_VALUE)
+            {
+                snapshot_notify(buffer);
+            }
+        }
+        pthread_mutex_unlock(&build_lock);
+
+        // Con todos los buffers fijados arma el monitor_snapshot_release() que suelte uno; si lo soltó mientras se
+        // tenía el lock su intento falló, así que se vuelve a mirar después de soltarlo
+        if (blocked && snapshot_free_buffer() == NULL)
+        {
+            break;
+        }
+    }
+}
+
+const monitor_snapshot_t* monitor_snapshot_get()
+{
+    snapshot_enable();
+    for (;;)
+    {
+        int current = atomic_load(&published);
+        if (current < INICIAL_VALUE)
+        {
+            return NULL;
+        }
+
+        atomic_fetch_add(&buffers[current].readers, ASSIGNED_VALUE);
+        if (atomic_load(&published) == current)
+        {
+            return &buffers[current].snapshot;
+        }
+
+        // Se publicó otra instantánea entre la lectura y la fijación: reintentar con la nueva
+        atomic_fetch_sub(&buffers[current].readers, ASSIGNED_VALUE);
+    }
+}
+
+void monitor_snapshot_release(const monitor_snapshot_t* snapshot)
+{
+    if (snapshot != NULL)
+    {
+        snapshot_buffer_t* buffer = (snapshot_buffer_t*)snapshot;
+        // El último lector de un buffer arma la instantánea que quedó pendiente por falta de uno libre
+        if (atomic_fetch_sub(&buffer->readers, ASSIGNED_VALUE) == ASSIGNED_VALUE && atomic_load(&pending))
+        {
+            monitor_snapshot_update();
+        }
+    }
+}
+
+unsigned long long monitor_snapshot_version()
+{
+    return atomic_load(&published_version);
+}
+
+const monitor_sample_t* monitor_snapshot_find(const monitor_snapshot_t* snapshot, const char* name,
+                                              const char* const* labels, int label_count)
+{
+    if (snapshot == NULL || name == NULL)
+    {
+        return NULL;
+    }
+    for (size_t i = 0; i < snapshot->count; i++)
+    {
+        const monitor_sample_t* sample = &snapshot->samples[i];
+        if (sample->label_count < label_count || strcmp(sample->name, name) != INICIAL_VALUE)
+        {
+            continue;
+        }
+        int l = INICIAL_VALUE;
+        while (l < label_count && strncmp(sample->labels[l], labels[l], METRIC_LABEL_SIZE) == INICIAL_VALUE)
+        {
+            l++;
+        }
+        if (l == label_count)
+        {
+            return sample;
+        }
+    }
+    return NULL;
+}
+
+int monitor_snapshot_subscribe(monitor_snapshot_cb cb, void* arg)
+{
+    if (cb == NULL)
+    {
+        return ERROR_INT;
+    }
+
+    int id = ERROR_INT;
+    pthread_mutex_lock(&subscribers_lock);
+    for (int i = 0; i < MONITOR_SNAPSHOT_MAX_SUBSCRIBERS && id < INICIAL_VALUE; i++)
+    {
+        if (subscribers[i].cb == NULL)
+        {
+            subscribers[i].cb = cb;
+            subscribers[i].arg = arg;
+            atomic_fetch_add(&subscriber_count, ASSIGNED_VALUE);
+            id = i;
+        }
+    }
+    pthread_mutex_unlock(&subscribers_lock);
+
+    // Fuera del lock: el armado inicial avisa a los suscriptores y lo tomaría de nuevo
+    if (id >= INICIAL_VALUE)
+    {
+        snapshot_enable();
+    }
+    return id;
+}
+
+void monitor_snapshot_unsubscribe(int id)
+{
+    if (id < INICIAL_VALUE || id >= MONITOR_SNAPSHOT_MAX_SUBSCRIBERS)
+    {
+        return;
+    }
+    pthread_mutex_lock(&subscribers_lock);
+    if (subscribers[id].cb != NULL)
+    {
+        subscribers[id].cb = NULL;
+        subscribers[id].arg = NULL;
+        atomic_fetch_sub(&subscriber_count, ASSIGNED_VALUE);
+    }
+    pthread_mutex_unlock(&subscribers_lock);
+}
+
+int monitor_snapshot_eventfd()
+{
+    pthread_mutex_lock(&subscribers_lock);
+    int fd = atomic_load(&event_fd);
+    if (fd < INICIAL_VALUE)
+    {
+        fd = eventfd(INICIAL_VALUE, EFD_NONBLOCK | EFD_CLOEXEC);
+        if (fd < INICIAL_VALUE)
+        {
+            perror("Error al crear el eventfd de las instantáneas");
+        }
+        atomic_store(&event_fd, fd);
+    }
+    pthread_mutex_unlock(&subscribers_lock);
+
+    if (fd >= INICIAL_VALUE)
+    {
+        snapshot_enable();
+    }
+    return fd;
+}
+
+void monitor_snapshot_close()
+{
+    pthread_mutex_lock(&build_lock);
+    atomic_store(&enabled, INICIAL_VALUE);
+    atomic_store(&published, ERROR_INT);
+    for (int i = 0; i < MONITOR_SNAPSHOT_BUFFERS; i++)
+    {
+        free(buffers[i].samples);
+        buffers[i].samples = NULL;
+        buffers[i].cap = INICIAL_VALUE;
+        atomic_store(&buffers[i].readers, INICIAL_VALUE);
+    }
+    pthread_mutex_unlock(&build_lock);
+
+    pthread_mutex_lock(&subscribers_lock);
+    int fd = atomic_exchange(&event_fd, ERROR_INT);
+    if (fd >= INICIAL_VALUE)
+    {
+        close(fd);
+    }
+    pthread_mutex_unlock(&subscribers_lock);
+}
@@ -0,0 +1,180 @@
+/**
+ * @file monitor_stats.c
+ * @brief Contadores atómicos del costo del monitor y lectura de su memoria residente.
+ */
+
+#include "monitor_stats.h"
+#include "metrics.h"
+#include <fcntl.h>
+#include <stdatomic.h>
+#include <time.h>
+
+/**
+ * @brief Bytes leídos de /proc y de cgroupfs.
+ */
+static atomic_ullong read_bytes = INICIAL_VALUE;
+
+/**
+ * @brief Llamadas de cada syscall contada.
+ */
+static atomic_ullong syscalls[MONITOR_SYSCALL_COUNT];
+
+/**
+ * @brief Nombres de las syscalls, en el orden de monitor_syscall_t.
+ */
+static const char* const syscall_names[MONITOR_SYSCALL_COUNT] = {"open", "read", "close", "io_uring_enter"};
+
+/**
+ * @brief Descriptor persistente de /proc/self/statm.
+ */
+static int statm_fd = ERROR_INT;
+
+unsigned long long monitor_clock_ns()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC_RAW, &ts);
+    return (unsigned long long)ts.tv_sec * 1000000000ULL + (unsigned long long)ts.tv_nsec;
+}
+
+void monitor_count_syscall(monitor_syscall_t call)
+{
+    atomic_fetch_add_explicit(&syscalls[call], 1, memory_order_relaxed);
+}
+
+void monitor_count_read(ssize_t bytes)
+{
+    atomic_fetch_add_explicit(&syscalls[MONITOR_SYSCALL_READ], 1, memory_order_relaxed);
+    if (bytes > INICIAL_VALUE)
+    {
+        atomic_fetch_add_explicit(&read_bytes, (unsigned long long)bytes, memory_order_relaxed);
+    }
+}
+
+void monitor_count_bytes(ssize_t bytes)
+{
+    if (bytes > INICIAL_VALUE)
+    {
+        atomic_fetch_add_explicit(&read_bytes, (unsigned long long)bytes, memory_order_relaxed);
+    }
+}
+
+unsigned long long monitor_read_bytes()
+{
+    return atomic_load_explicit(&read_bytes, memory_order_relaxed);
+}
+
+unsigned long long monitor_syscalls(monitor_syscall_t call)
+{
+    return atomic_load_explicit(&syscalls[call], memory_order_relaxed);
+}
+
+const char* monitor_syscall_name(monitor_syscall_t call)
+{
+    return syscall_names[call];
+}
+
+double monitor_resident_bytes()
+{
+    // El despachador es el único llamador, así que el descriptor no necesita lock. Estas lecturas no se cuentan:
+    // son del propio monitor y no de las fuentes que recolecta
+    if (statm_fd < INICIAL_VALUE && (statm_fd = open("/proc/self/statm", O_RDONLY | O_CLOEXEC)) < INICIAL_VALUE)
+    {
+        return ERROR_FLOAT;
+    }
+    char buf[BUFFER_SIZE];
+    ssize_t n = pread(statm_fd, buf, sizeof(buf) - ASSIGNED_VALUE, INICIAL_VALUE);
+    if (n <= INICIAL_VALUE)
+    {
+        return ERROR_FLOAT;
+    }
+    buf[n] = '\0';
+
+    // Segundo campo: páginas residentes
+    unsigned long long size;
+    unsigned long long resident;
+    if (sscanf(buf, "%llu %llu", &size, &resident) != 2)
+    {
+        return ERROR_FLOAT;
+    }
+    return (double)resident * (double)sysconf(_SC_PAGESIZE);
+}
+
+#ifdef MONITOR_COUNT_ALLOCATIONS
+
+/**
+ * @brief Reservas de todos los hilos.
+ */
+static atomic_ullong heap_allocations = INICIAL_VALUE;
+
+/**
+ * @brief Reservas del hilo actual; no necesita atómicos porque solo lo escribe su hilo.
+ */
+static _Thread_local unsigned long long thread_allocations = INICIAL_VALUE;
+
+/**
+ * @brief Implementaciones de glibc a las que delegan los envoltorios.
+ */
+extern void* __libc_malloc(size_t size);
+extern void* __libc_calloc(size_t count, size_t size);
+extern void* __libc_realloc(void* ptr, size_t size);
+
+/**
+ * @brief Cuenta una reserva.
+ */
+static inline void count_allocation()
+{
+    atomic_fetch_add_explicit(&heap_allocations, 1, memory_order_relaxed);
+    thread_allocations++;
+}
+
+void* malloc(size_t size)
+{
+    count_allocation();
+    return __libc_malloc(size);
+}
+
+void* calloc(size_t count, size_t size)
+{
+    count_allocation();
+    return __libc_calloc(count, size);
+}
+
+void* realloc(void* ptr, size_t size)
+{
+    count_allocation();
+    return __libc_realloc(ptr, size);
+}
+
+int monitor_counts_allocations()
+{
+    return ASSIGNED_VALUE;
+}
+
+unsigned long long monitor_heap_allocations()
+{
+    return atomic_load_explicit(&heap_allocations, memory_order_relaxed);
+}
+
+unsigned long long monitor_thread_allocations()
+{
+    return thread_allocations;
+}
+
+#else
+
+int monitor_counts_allocations()
+{
+    return INICIAL_VALUE;
+}
+
+unsigned long long monitor_heap_allocations()
+{
+    return INICIAL_VALUE;
+}
+
+unsigned long long monitor_thread_allocations()
+{
+    return INICIAL_VALUE;
+}
+
+#endif
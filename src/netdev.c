@@ -0,0 +1,318 @@
+/**
+ * @file netdev.c
+ * @brief Parser en proceso de /proc/net/dev con estado persistente por interfaz.
+ *
+ * Las interfaces se buscan por nombre en una tabla hash sin copiar el nombre del buffer leído, y solo se reserva
+ * memoria cuando aparece una interfaz nueva. Las interfaces que desaparecen (por ejemplo los veth de contenedores
+ * que terminan) se liberan en el mismo ciclo.
+ */
+
+#include "netdev.h"
+#include "metrics.h"
+#include "scan.h"
+#include "strmap.h"
+#include <fnmatch.h>
+#include <pthread.h>
+#include <stdint.h>
+
+/**
+ * @brief Nombres de los contadores usados en las métricas.
+ */
+const char* const netdev_field_names[NETDEV_FIELD_COUNT] = {
+    "receive_bytes",  "receive_packets",  "receive_errs",  "receive_drop",
+    "transmit_bytes", "transmit_packets", "transmit_errs", "transmit_drop",
+};
+
+/**
+ * @brief Tabla de interfaces indexada por nombre.
+ */
+static strmap_t by_name;
+
+/**
+ * @brief Todas las interfaces conocidas, en el orden en que aparecieron.
+ */
+static netdev_iface_t** ifaces = NULL;
+
+/**
+ * @brief Interfaces seleccionadas en el último ciclo; proc_snapshot_t::net_ifaces apunta aquí.
+ */
+static const netdev_iface_t** active = NULL;
+
+/**
+ * @brief Cantidad de entradas de ifaces.
+ */
+static int iface_count = INICIAL_VALUE;
+
+/**
+ * @brief Capacidad de ifaces y active.
+ */
+static int iface_cap = INICIAL_VALUE;
+
+/**
+ * @brief Número de ciclo de parseo, usado para detectar interfaces que desaparecieron.
+ */
+static unsigned int parse_cycle = INICIAL_VALUE;
+
+/**
+ * @brief 1 si se incluye la interfaz de loopback.
+ */
+static int include_loopback = INICIAL_VALUE;
+
+/**
+ * @brief 1 si se incluyen las interfaces veth*.
+ */
+static int include_veth = INICIAL_VALUE;
+
+/**
+ * @brief Generación del filtro; cambia en cada set_netdev_filter() que modifica algo.
+ */
+static unsigned int filter_generation = ASSIGNED_VALUE;
+
+/**
+ * @brief Protege el filtro, que se cambia desde el hilo de configuración mientras se parsea.
+ */
+static pthread_mutex_t filter_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * @brief Configura qué interfaces virtuales se incluyen.
+ *
+ * @param loopback 1 para incluir la interfaz de loopback.
+ * @param veth 1 para incluir las interfaces veth*.
+ */
+void set_netdev_filter(int loopback, int veth)
+{
+    loopback = loopback != INICIAL_VALUE;
+    veth = veth != INICIAL_VALUE;
+
+    pthread_mutex_lock(&filter_lock);
+    if (loopback != include_loopback || veth != include_veth)
+    {
+        include_loopback = loopback;
+        include_veth = veth;
+        filter_generation++;
+    }
+    pthread_mutex_unlock(&filter_lock);
+}
+
+/**
+ * @brief Decide si una interfaz debe seguirse según el filtro.
+ *
+ * @param name Nombre de la interfaz.
+ * @return 1 si se selecciona, 0 si no.
+ */
+static int netdev_is_selected(const char* name)
+{
+    if (strcmp(name, "lo") == INICIAL_VALUE)
+    {
+        return include_loopback;
+    }
+    if (fnmatch("veth*", name, INICIAL_VALUE) == INICIAL_VALUE)
+    {
+        return include_veth;
+    }
+    return ASSIGNED_VALUE;
+}
+
+/**
+ * @brief Busca el estado persistente de una interfaz, creándolo si es nueva.
+ *
+ * @param name Nombre dentro del buffer de /proc/net/dev, sin terminar en '\0'.
+ * @param name_len Longitud del nombre.
+ * @return Estado de la interfaz, o NULL si no se pudo reservar memoria.
+ */
+static netdev_iface_t* netdev_lookup(const char* name, size_t name_len)
+{
+    if (by_name.capacity == INICIAL_VALUE && strmap_init(&by_name, INICIAL_VALUE) != INICIAL_VALUE)
+    {
+        return NULL;
+    }
+
+    netdev_iface_t* iface = strmap_get(&by_name, name, name_len);
+    if (iface != NULL)
+    {
+        return iface;
+    }
+
+    if (iface_count == iface_cap)
+    {
+        int cap = iface_cap ? iface_cap * 2 : ASSIGNED_VALUE_8;
+        netdev_iface_t** bigger = realloc(ifaces, (size_t)cap * sizeof(*ifaces));
+        if (bigger == NULL)
+        {
+            perror("Error al asignar memoria");
+            return NULL;
+        }
+        ifaces = bigger;
+        const netdev_iface_t** bigger_active = realloc(active, (size_t)cap * sizeof(*active));
+        if (bigger_active == NULL)
+        {
+            perror("Error al asignar memoria");
+            return NULL;
+        }
+        active = bigger_active;
+        iface_cap = cap;
+    }
+
+    iface = calloc(1, sizeof(*iface));
+    if (iface == NULL)
+    {
+        perror("Error al asignar memoria");
+        return NULL;
+    }
+    scan_copy(iface->name, sizeof(iface->name), name, name_len);
+    if (strmap_put(&by_name, iface->name, iface) != INICIAL_VALUE)
+    {
+        free(iface);
+        return NULL;
+    }
+
+    ifaces[iface_count++] = iface;
+    return iface;
+}
+
+/**
+ * @brief Libera las interfaces que no aparecieron en el ciclo actual.
+ */
+static void netdev_remove_stale()
+{
+    for (int i = 0; i < iface_count;)
+    {
+        if (ifaces[i]->last_seen == parse_cycle)
+        {
+            i++;
+            continue;
+        }
+        strmap_remove(&by_name, ifaces[i]->name);
+        free(ifaces[i]);
+        ifaces[i] = ifaces[--iface_count];
+    }
+}
+
+/**
+ * @brief Calcula el incremento de un contador de interfaz entre dos lecturas.
+ *
+ * Si el valor retrocede y el anterior entraba en 32 bits se asume un desborde del contador de 32 bits; en otro caso
+ * se asume que el contador se reinició (por ejemplo al recargar el driver) y se cuenta desde cero.
+ *
+ * @param cur Valor actual.
+ * @param prev Valor anterior.
+ * @return Incremento desde la lectura anterior.
+ */
+static unsigned long long netdev_delta(unsigned long long cur, unsigned long long prev)
+{
+    if (cur >= prev)
+    {
+        return cur - prev;
+    }
+    if (prev <= UINT32_MAX)
+    {
+        return (UINT32_MAX - prev) + cur + ASSIGNED_VALUE;
+    }
+    return cur;
+}
+
+/**
+ * @brief Parsea /proc/net/dev y actualiza las interfaces de la instantánea.
+ *
+ * @param snap Instantánea a completar.
+ * @param buf Contenido de /proc/net/dev.
+ * @param len Bytes válidos de buf.
+ * @return 0 en caso de éxito, -1 en caso de error.
+ */
+int parse_netdev(proc_snapshot_t* snap, const char* buf, size_t len)
+{
+    scan_t s, line;
+    const char* name;
+    size_t name_len;
+    int active_count = INICIAL_VALUE;
+
+    parse_cycle++;
+    scan_init(&s, buf, len);
+
+    pthread_mutex_lock(&filter_lock);
+    unsigned int generation = filter_generation;
+    pthread_mutex_unlock(&filter_lock);
+
+    // Saltar las primeras dos líneas que son encabezados
+    if (!scan_next_line(&s, &line) || !scan_next_line(&s, &line))
+    {
+        return ERROR_INT;
+    }
+
+    while (scan_next_line(&s, &line))
+    {
+        unsigned long long raw[NETDEV_FIELD_COUNT];
+
+        // "  eth0: bytes packets errs drop fifo frame compressed multicast bytes packets errs drop ..."
+        if (!scan_until(&line, ':', &name, &name_len) || !scan_u64(&line, &raw[NETDEV_RX_BYTES]) ||
+            !scan_u64(&line, &raw[NETDEV_RX_PACKETS]) || !scan_u64(&line, &raw[NETDEV_RX_ERRS]) ||
+            !scan_u64(&line, &raw[NETDEV_RX_DROP]) || !scan_skip_fields(&line, 4) ||
+            !scan_u64(&line, &raw[NETDEV_TX_BYTES]) || !scan_u64(&line, &raw[NETDEV_TX_PACKETS]) ||
+            !scan_u64(&line, &raw[NETDEV_TX_ERRS]) || !scan_u64(&line, &raw[NETDEV_TX_DROP]))
+        {
+            continue;
+        }
+
+        netdev_iface_t* iface = netdev_lookup(name, name_len);
+        if (iface == NULL)
+        {
+            continue;
+        }
+        iface->last_seen = parse_cycle;
+
+        // Totales sin desbordes: la primera lectura parte del valor del kernel
+        double elapsed = iface->has_prev && snap->timestamp_ns > iface->prev_timestamp_ns
+                             ? (double)(snap->timestamp_ns - iface->prev_timestamp_ns) / 1e9
+                             : INICIAL_VALUE;
+        for (int f = 0; f < NETDEV_FIELD_COUNT; f++)
+        {
+            iface->delta[f] = iface->has_prev ? netdev_delta(raw[f], iface->raw[f]) : INICIAL_VALUE;
+            iface->total[f] = iface->has_prev ? iface->total[f] + iface->delta[f] : raw[f];
+            iface->rate[f] = elapsed > INICIAL_VALUE ? (double)iface->delta[f] / elapsed : INICIAL_VALUE;
+            iface->raw[f] = raw[f];
+        }
+        iface->has_prev = ASSIGNED_VALUE;
+        iface->prev_timestamp_ns = snap->timestamp_ns;
+
+        if (iface->filter_generation != generation)
+        {
+            pthread_mutex_lock(&filter_lock);
+            iface->selected = netdev_is_selected(iface->name);
+            iface->filter_generation = filter_generation;
+            pthread_mutex_unlock(&filter_lock);
+        }
+        if (!iface->selected)
+        {
+            continue;
+        }
+
+        active[active_count++] = iface;
+        snap->net_rx_bytes += iface->total[NETDEV_RX_BYTES];
+        snap->net_tx_bytes += iface->total[NETDEV_TX_BYTES];
+        snap->net_rx_bytes_per_second += iface->rate[NETDEV_RX_BYTES];
+        snap->net_tx_bytes_per_second += iface->rate[NETDEV_TX_BYTES];
+    }
+
+    netdev_remove_stale();
+    snap->net_ifaces = active;
+    snap->net_iface_count = active_count;
+    return INICIAL_VALUE;
+}
+
+/**
+ * @brief Libera la tabla de interfaces.
+ */
+void netdev_close()
+{
+    for (int i = 0; i < iface_count; i++)
+    {
+        free(ifaces[i]);
+    }
+    free(ifaces);
+    free(active);
+    strmap_free(&by_name);
+    ifaces = NULL;
+    active = NULL;
+    iface_count = INICIAL_VALUE;
+    iface_cap = INICIAL_VALUE;
+}
@@ -0,0 +1,657 @@
+/**
+ * @file proc_snapshot.c
+ * @brief Lectura en una sola pasada de los archivos de /proc usados por las métricas.
+ *
+ * Cada archivo se abre una única vez en snapshot_init() y en cada ciclo se relee con pread() desde el
+ * desplazamiento 0 sobre un buffer preasignado, evitando la búsqueda de ruta de open() y las reservas de stdio.
+ * Cada función read_* recorre el buffer una sola vez con el tokenizador de scan.h y guarda en la instantánea
+ * todos los campos que necesitan los getters de metrics.c.
+ */
+
+#include "proc_snapshot.h"
+#include "bpf_latency.h"
+#include "cgroup_stats.h"
+#include "diskstats.h"
+#include "fs_stats.h"
+#include "memstat.h"
+#include "metrics.h"
+#include "monitor_stats.h"
+#include "netdev.h"
+#include "proctable.h"
+#include "scan.h"
+#include <errno.h>
+#include <fcntl.h>
+#include <time.h>
+
+/**
+ * @brief Índices de las fuentes dentro de la tabla sources.
+ */
+enum
+{
+    SOURCE_STAT,
+    SOURCE_MEMINFO,
+    SOURCE_VMSTAT,
+    SOURCE_DISKSTATS,
+    SOURCE_NETDEV,
+    SOURCE_PSI_CPU,
+    SOURCE_PSI_MEMORY,
+    SOURCE_PSI_IO,
+    SOURCE_SCHEDSTAT,
+    SOURCE_COUNT
+};
+
+/**
+ * @brief Fuentes de /proc abiertas de forma persistente.
+ */
+static proc_source_t sources[SOURCE_COUNT] = {
+    [SOURCE_STAT] = {"stat", ERROR_INT, NULL, INICIAL_VALUE, INICIAL_VALUE},
+    [SOURCE_MEMINFO] = {"meminfo", ERROR_INT, NULL, INICIAL_VALUE, INICIAL_VALUE},
+    [SOURCE_VMSTAT] = {"vmstat", ERROR_INT, NULL, INICIAL_VALUE, INICIAL_VALUE},
+    [SOURCE_DISKSTATS] = {"diskstats", ERROR_INT, NULL, INICIAL_VALUE, INICIAL_VALUE},
+    [SOURCE_NETDEV] = {"net/dev", ERROR_INT, NULL, INICIAL_VALUE, INICIAL_VALUE},
+    [SOURCE_PSI_CPU] = {"pressure/cpu", ERROR_INT, NULL, INICIAL_VALUE, INICIAL_VALUE, ASSIGNED_VALUE},
+    [SOURCE_PSI_MEMORY] = {"pressure/memory", ERROR_INT, NULL, INICIAL_VALUE, INICIAL_VALUE, ASSIGNED_VALUE},
+    [SOURCE_PSI_IO] = {"pressure/io", ERROR_INT, NULL, INICIAL_VALUE, INICIAL_VALUE, ASSIGNED_VALUE},
+    [SOURCE_SCHEDSTAT] = {"schedstat", ERROR_INT, NULL, INICIAL_VALUE, INICIAL_VALUE, ASSIGNED_VALUE},
+};
+
+/**
+ * @brief Raíz de la que se leen las fuentes.
+ */
+static char proc_root[PROC_PATH_SIZE] = PROC_ROOT;
+
+/**
+ * @brief Raíz de /sys.
+ */
+static char sys_root[PROC_PATH_SIZE] = SYS_ROOT;
+
+/**
+ * @brief Devuelve el instante actual de CLOCK_MONOTONIC en nanosegundos.
+ *
+ * @return Nanosegundos desde un origen arbitrario.
+ */
+unsigned long long monotonic_ns()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (unsigned long long)ts.tv_sec * 1000000000ULL + (unsigned long long)ts.tv_nsec;
+}
+
+/**
+ * @brief Devuelve el instante actual de CLOCK_REALTIME en milisegundos.
+ *
+ * @return Milisegundos desde la época.
+ */
+int64_t realtime_ms()
+{
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return (int64_t)ts.tv_sec * 1000 + ts.tv_nsec / 1000000;
+}
+
+/**
+ * @brief Abre el descriptor persistente de una fuente y reserva su buffer si aún no lo tiene.
+ *
+ * @param src Fuente a abrir.
+ * @return 0 en caso de éxito, -1 en caso de error.
+ */
+static int proc_source_open(proc_source_t* src)
+{
+    if (src->buf == NULL)
+    {
+        src->buf = malloc(PROC_BUFFER_SIZE);
+        if (src->buf == NULL)
+        {
+            perror("Error al asignar memoria");
+            return ERROR_INT;
+        }
+        src->cap = PROC_BUFFER_SIZE;
+    }
+
+    if (src->fd < INICIAL_VALUE)
+    {
+        char path[PROC_PATH_SIZE + BUFFER_SIZE];
+        snprintf(path, sizeof(path), "%s/%s", proc_root, src->path);
+        src->fd = open(path, O_RDONLY | O_CLOEXEC);
+        monitor_count_syscall(MONITOR_SYSCALL_OPEN);
+        if (src->fd < INICIAL_VALUE)
+        {
+            // Un archivo opcional que no existe no es un error: se reintenta en silencio en cada lectura
+            if (!src->optional || errno != ENOENT)
+            {
+                fprintf(stderr, "Error al abrir %s: %s\n", path, strerror(errno));
+            }
+            return ERROR_INT;
+        }
+    }
+
+    return INICIAL_VALUE;
+}
+
+int snapshot_set_proc_root(const char* root)
+{
+    if (root == NULL)
+    {
+        root = PROC_ROOT;
+    }
+    if (strlen(root) >= sizeof(proc_root))
+    {
+        fprintf(stderr, "Ruta de /proc demasiado larga: %s\n", root);
+        return ERROR_INT;
+    }
+    snapshot_close();
+    strcpy(proc_root, root);
+    return INICIAL_VALUE;
+}
+
+const char* snapshot_proc_root()
+{
+    return proc_root;
+}
+
+int snapshot_set_sys_root(const char* root)
+{
+    if (root == NULL)
+    {
+        root = SYS_ROOT;
+    }
+    if (strlen(root) >= sizeof(sys_root))
+    {
+        fprintf(stderr, "Ruta de /sys demasiado larga: %s\n", root);
+        return ERROR_INT;
+    }
+    snapshot_close();
+    strcpy(sys_root, root);
+    return INICIAL_VALUE;
+}
+
+const char* snapshot_sys_root()
+{
+    return sys_root;
+}
+
+/**
+ * @brief Cuenta las CPUs de una raíz que no es la del sistema: el mayor N de las líneas "cpuN" de stat, más uno.
+ *
+ * @return CPUs, o 0 si stat no se pudo leer o la raíz es PROC_ROOT.
+ */
+static long proc_root_cpus()
+{
+    if (strcmp(proc_root, PROC_ROOT) == 0 || proc_source_read(&sources[SOURCE_STAT]) != INICIAL_VALUE)
+    {
+        return INICIAL_VALUE;
+    }
+    // Las líneas "cpu" van primero en stat: la primera que no lo es termina la búsqueda
+    long cpus = INICIAL_VALUE;
+    const char* line = sources[SOURCE_STAT].buf;
+    while (line != NULL && strncmp(line, "cpu", 3) == 0)
+    {
+        // "cpu " es el total; strtol() saltearía los espacios y leería su primer contador
+        long cpu = line[3] >= '0' && line[3] <= '9' ? strtol(line + 3, NULL, 10) : ERROR_INT;
+        if (cpu >= cpus)
+        {
+            cpus = cpu + 1;
+        }
+        line = strchr(line, '\n');
+        line = line != NULL ? line + 1 : NULL;
+    }
+    return cpus;
+}
+
+/**
+ * @brief Abre de forma persistente todas las fuentes de /proc y reserva sus buffers.
+ *
+ * @return 0 si todas las fuentes se abrieron, -1 si alguna falló.
+ */
+int snapshot_init()
+{
+    int ret = cpu_stats_init(proc_root_cpus());
+
+    for (int i = 0; i < SOURCE_COUNT; i++)
+    {
+        if (proc_source_open(&sources[i]) != INICIAL_VALUE && !sources[i].optional)
+        {
+            ret = ERROR_INT;
+        }
+    }
+
+    return ret;
+}
+
+/**
+ * @brief Cierra los descriptores persistentes y libera los buffers de lectura.
+ */
+void snapshot_close()
+{
+    for (int i = 0; i < SOURCE_COUNT; i++)
+    {
+        if (sources[i].fd >= INICIAL_VALUE)
+        {
+            close(sources[i].fd);
+            sources[i].fd = ERROR_INT;
+        }
+        free(sources[i].buf);
+        sources[i].buf = NULL;
+        sources[i].cap = INICIAL_VALUE;
+        sources[i].len = INICIAL_VALUE;
+    }
+    cpu_stats_close();
+    diskstats_close();
+    netdev_close();
+    proctable_close();
+    cgroup_close();
+    bpf_latency_close();
+    fs_close();
+}
+
+/**
+ * @brief Relee una fuente completa con pread() sobre su buffer preasignado.
+ *
+ * @param src Fuente a leer.
+ * @return 0 en caso de éxito, -1 en caso de error.
+ */
+int proc_source_read(proc_source_t* src)
+{
+    size_t off = INICIAL_VALUE;
+    ssize_t n;
+
+    // Reintentar la apertura si el archivo no estaba disponible en snapshot_init()
+    if (src->fd < INICIAL_VALUE && proc_source_open(src) != INICIAL_VALUE)
+    {
+        return ERROR_INT;
+    }
+
+    for (;;)
+    {
+        // La última lectura, la que devuelve 0, también es una syscall
+        n = pread(src->fd, src->buf + off, src->cap - off - ASSIGNED_VALUE, (off_t)off);
+        monitor_count_read(n);
+        if (n <= INICIAL_VALUE)
+        {
+            break;
+        }
+        off += (size_t)n;
+        if (off == src->cap - ASSIGNED_VALUE)
+        {
+            // El contenido no entra: duplicar el buffer y seguir leyendo
+            char* bigger = realloc(src->buf, src->cap * 2);
+            if (bigger == NULL)
+            {
+                perror("Error al asignar memoria");
+                break;
+            }
+            src->buf = bigger;
+            src->cap *= 2;
+        }
+    }
+
+    if (n < INICIAL_VALUE)
+    {
+        fprintf(stderr, "Error al leer %s/%s: %s\n", proc_root, src->path, strerror(errno));
+        close(src->fd);
+        monitor_count_syscall(MONITOR_SYSCALL_CLOSE);
+        src->fd = ERROR_INT;
+        return ERROR_INT;
+    }
+
+    src->buf[off] = '\0';
+    src->len = off;
+    return INICIAL_VALUE;
+}
+
+/**
+ * @brief Valor de 'ctxt' en la lectura anterior de /proc/stat, para calcular su tasa.
+ */
+static unsigned long long prev_ctxt = INICIAL_VALUE;
+
+/**
+ * @brief Instante de la lectura anterior de /proc/stat, o 0 si no la hubo.
+ */
+static unsigned long long prev_ctxt_timestamp_ns = INICIAL_VALUE;
+
+/**
+ * @brief Parsea la línea agregada "cpu", 'ctxt' y 'processes' de /proc/stat.
+ *
+ * @param snap Instantánea a completar.
+ * @param buf Contenido de /proc/stat.
+ * @param len Bytes válidos de buf.
+ * @return 0 en caso de éxito, -1 en caso de error.
+ */
+static int read_stat(proc_snapshot_t* snap, const char* buf, size_t len)
+{
+    scan_t s, line, aggregate;
+    unsigned long long* cpu_times[] = {&snap->cpu_user,   &snap->cpu_nice, &snap->cpu_system,  &snap->cpu_idle,
+                                       &snap->cpu_iowait, &snap->cpu_irq,  &snap->cpu_softirq, &snap->cpu_steal};
+
+    scan_init(&s, buf, len);
+    cpu_stats_begin();
+
+    // La línea agregada "cpu" es la primera; las "cpuN" no coinciden porque la clave exige un espacio detrás
+    if (!scan_skip_to_key(&s, "cpu", &line))
+    {
+        fprintf(stderr, "Error al parsear /proc/stat\n");
+        return ERROR_INT;
+    }
+    aggregate = line;
+    for (int i = 0; i < ASSIGNED_VALUE_8; i++)
+    {
+        if (!scan_u64(&line, cpu_times[i]))
+        {
+            fprintf(stderr, "Error al parsear /proc/stat\n");
+            return ERROR_INT;
+        }
+    }
+    cpu_stats_store(INICIAL_VALUE, &aggregate);
+
+    // Las líneas "cpuN" siguen a la agregada; la columna N + 1 corresponde a la CPU N
+    while (scan_next_line(&s, &line) && scan_starts_with(&line, "cpu"))
+    {
+        unsigned long long index;
+        line.pos += strlen("cpu");
+        if (scan_u64(&line, &index))
+        {
+            cpu_stats_store((int)index + 1, &line);
+        }
+    }
+    cpu_stats_compute();
+    snap->cpus = get_cpu_stats();
+
+    // 'ctxt' y 'processes' aparecen en ese orden después de las líneas de CPU e 'intr'
+    if (scan_skip_to_key(&s, "ctxt", &line))
+    {
+        scan_u64(&line, &snap->ctxt);
+    }
+    if (prev_ctxt_timestamp_ns != INICIAL_VALUE && snap->timestamp_ns > prev_ctxt_timestamp_ns &&
+        snap->ctxt >= prev_ctxt)
+    {
+        snap->ctxt_per_second =
+            (double)(snap->ctxt - prev_ctxt) / ((double)(snap->timestamp_ns - prev_ctxt_timestamp_ns) / 1e9);
+    }
+    prev_ctxt = snap->ctxt;
+    prev_ctxt_timestamp_ns = snap->timestamp_ns;
+    if (scan_skip_to_key(&s, "processes", &line))
+    {
+        scan_u64(&line, &snap->processes);
+    }
+
+    return INICIAL_VALUE;
+}
+
+/**
+ * @brief Parsea los campos de /proc/meminfo en una pasada (ver memstat.h).
+ *
+ * @param snap Instantánea a completar.
+ * @param buf Contenido de /proc/meminfo.
+ * @param len Bytes válidos de buf.
+ * @return 0 en caso de éxito, -1 en caso de error.
+ */
+static int read_meminfo(proc_snapshot_t* snap, const char* buf, size_t len)
+{
+    memstat_parse(MEMSTAT_MEMINFO, buf, len, snap->memstat, &snap->memstat_found);
+    return INICIAL_VALUE;
+}
+
+/**
+ * @brief Parsea los campos de /proc/vmstat en una pasada (ver memstat.h).
+ *
+ * @param snap Instantánea a completar.
+ * @param buf Contenido de /proc/vmstat.
+ * @param len Bytes válidos de buf.
+ * @return 0 en caso de éxito, -1 en caso de error.
+ */
+static int read_vmstat(proc_snapshot_t* snap, const char* buf, size_t len)
+{
+    memstat_parse(MEMSTAT_VMSTAT, buf, len, snap->memstat, &snap->memstat_found);
+    return INICIAL_VALUE;
+}
+
+/**
+ * @brief Parsea las líneas "some" y "full" de un archivo de /proc/pressure.
+ *
+ * @param snap Instantánea a completar.
+ * @param resource Recurso del archivo (enum psi_resource).
+ * @param buf Contenido del archivo.
+ * @param len Bytes válidos de buf.
+ * @return 0 en caso de éxito, -1 en caso de error.
+ */
+static int read_psi(proc_snapshot_t* snap, int resource, const char* buf, size_t len)
+{
+    scan_t s, line;
+    const char* key;
+    size_t key_len;
+    int found = INICIAL_VALUE;
+
+    scan_init(&s, buf, len);
+    while (scan_next_line(&s, &line))
+    {
+        // "some avg10=0.12 avg60=0.05 avg300=0.01 total=123456"; la línea "full" de cpu existe desde Linux 5.13
+        psi_stall_t* stall;
+        if (scan_starts_with(&line, "some"))
+        {
+            stall = &snap->psi[resource][PSI_SOME];
+        }
+        else if (scan_starts_with(&line, "full"))
+        {
+            stall = &snap->psi[resource][PSI_FULL];
+        }
+        else
+        {
+            continue;
+        }
+        line.pos += strlen("some");
+
+        while (scan_until(&line, '=', &key, &key_len))
+        {
+            if (key_len == 5 && memcmp(key, "total", 5) == INICIAL_VALUE)
+            {
+                scan_u64(&line, &stall->total);
+            }
+            else if (key_len == 5 && memcmp(key, "avg10", 5) == INICIAL_VALUE)
+            {
+                scan_double(&line, &stall->avg10);
+            }
+            else if (key_len == 5 && memcmp(key, "avg60", 5) == INICIAL_VALUE)
+            {
+                scan_double(&line, &stall->avg60);
+            }
+            else if (key_len == 6 && memcmp(key, "avg300", 6) == INICIAL_VALUE)
+            {
+                scan_double(&line, &stall->avg300);
+            }
+        }
+        found = ASSIGNED_VALUE;
+    }
+
+    if (!found)
+    {
+        fprintf(stderr, "Error al parsear /proc/pressure\n");
+        return ERROR_INT;
+    }
+    return INICIAL_VALUE;
+}
+
+/**
+ * @brief Parsea /proc/pressure/cpu.
+ */
+static int read_psi_cpu(proc_snapshot_t* snap, const char* buf, size_t len)
+{
+    return read_psi(snap, PSI_CPU, buf, len);
+}
+
+/**
+ * @brief Parsea /proc/pressure/memory.
+ */
+static int read_psi_memory(proc_snapshot_t* snap, const char* buf, size_t len)
+{
+    return read_psi(snap, PSI_MEMORY, buf, len);
+}
+
+/**
+ * @brief Parsea /proc/pressure/io.
+ */
+static int read_psi_io(proc_snapshot_t* snap, const char* buf, size_t len)
+{
+    return read_psi(snap, PSI_IO, buf, len);
+}
+
+/**
+ * @brief Tiempo de espera en la cola y porciones de la lectura anterior de /proc/schedstat.
+ */
+static unsigned long long prev_sched_wait_ns = INICIAL_VALUE, prev_sched_timeslices = INICIAL_VALUE;
+
+/**
+ * @brief Suma el tiempo en ejecución, la espera en la cola y las porciones de cada CPU de /proc/schedstat.
+ *
+ * @param snap Instantánea a completar.
+ * @param buf Contenido de /proc/schedstat.
+ * @param len Bytes válidos de buf.
+ * @return 0 en caso de éxito, -1 en caso de error.
+ */
+static int read_schedstat(proc_snapshot_t* snap, const char* buf, size_t len)
+{
+    scan_t s, line;
+    int cpus = INICIAL_VALUE;
+
+    scan_init(&s, buf, len);
+    while (scan_next_line(&s, &line))
+    {
+        // "cpuN yld_count 0 sched_count sched_goidle ttwu_count ttwu_local run_ns wait_ns timeslices"
+        unsigned long long run_ns, wait_ns, timeslices;
+        if (!scan_starts_with(&line, "cpu") || !scan_skip_fields(&line, 7) || !scan_u64(&line, &run_ns) ||
+            !scan_u64(&line, &wait_ns) || !scan_u64(&line, &timeslices))
+        {
+            continue; // "version", "timestamp" y las líneas "domainN"
+        }
+        snap->sched_run_ns += run_ns;
+        snap->sched_wait_ns += wait_ns;
+        snap->sched_timeslices += timeslices;
+        cpus++;
+    }
+    if (cpus == INICIAL_VALUE)
+    {
+        fprintf(stderr, "Error al parsear /proc/schedstat\n");
+        return ERROR_INT;
+    }
+
+    // Espera media por porción en el intervalo: la latencia de la cola de ejecución que percibe cada tarea
+    if (snap->sched_timeslices > prev_sched_timeslices && snap->sched_wait_ns >= prev_sched_wait_ns &&
+        prev_sched_timeslices != INICIAL_VALUE)
+    {
+        snap->sched_average_wait_seconds = (double)(snap->sched_wait_ns - prev_sched_wait_ns) / 1e9 /
+                                           (double)(snap->sched_timeslices - prev_sched_timeslices);
+    }
+    prev_sched_wait_ns = snap->sched_wait_ns;
+    prev_sched_timeslices = snap->sched_timeslices;
+    return INICIAL_VALUE;
+}
+
+/**
+ * @brief Parser de una fuente y bit de validez que activa.
+ */
+typedef struct
+{
+    int (*parse)(proc_snapshot_t* snap, const char* buf, size_t len); ///< Función de parseo del contenido.
+    unsigned int bit;                                                ///< Bit SNAPSHOT_* correspondiente.
+} source_parser_t;
+
+/**
+ * @brief Parser de cada fuente, en el mismo orden que la tabla sources.
+ */
+static const source_parser_t parsers[SOURCE_COUNT] = {
+    [SOURCE_STAT] = {read_stat, SNAPSHOT_STAT},
+    [SOURCE_MEMINFO] = {read_meminfo, SNAPSHOT_MEMINFO},
+    [SOURCE_VMSTAT] = {read_vmstat, SNAPSHOT_VMSTAT},
+    [SOURCE_DISKSTATS] = {parse_diskstats, SNAPSHOT_DISKSTATS},
+    [SOURCE_NETDEV] = {parse_netdev, SNAPSHOT_NETDEV},
+    [SOURCE_PSI_CPU] = {read_psi_cpu, SNAPSHOT_PSI_CPU},
+    [SOURCE_PSI_MEMORY] = {read_psi_memory, SNAPSHOT_PSI_MEMORY},
+    [SOURCE_PSI_IO] = {read_psi_io, SNAPSHOT_PSI_IO},
+    [SOURCE_SCHEDSTAT] = {read_schedstat, SNAPSHOT_SCHEDSTAT},
+};
+
+/**
+ * @brief Fuente que recorre un directorio o lee mapas de eBPF en lugar de leer un único archivo.
+ */
+typedef struct
+{
+    int (*scan)(proc_snapshot_t* snap); ///< Función que recorre la fuente y completa la instantánea.
+    unsigned int bit;                   ///< Bit SNAPSHOT_* correspondiente.
+} source_scanner_t;
+
+/**
+ * @brief Fuentes de directorio y de eBPF, leídas después de los archivos.
+ */
+static const source_scanner_t scanners[] = {
+    {proctable_scan, SNAPSHOT_PROCS},
+    {cgroup_scan, SNAPSHOT_CGROUPS},
+    {bpf_latency_scan, SNAPSHOT_BPF},
+    {fs_scan, SNAPSHOT_FILESYSTEMS},
+};
+
+/**
+ * @brief Parsea el contenido de una fuente ya leído y marca su bit de validez.
+ *
+ * @param snap Instantánea a completar.
+ * @param source Bit SNAPSHOT_* de la fuente.
+ * @param buf Contenido de la fuente.
+ * @param len Bytes válidos de buf.
+ * @return 0 en caso de éxito, -1 en caso de error.
+ */
+int parse_snapshot_source(proc_snapshot_t* snap, unsigned int source, const char* buf, size_t len)
+{
+    for (int i = 0; i < SOURCE_COUNT; i++)
+    {
+        if (parsers[i].bit == source)
+        {
+            if (parsers[i].parse(snap, buf, len) != INICIAL_VALUE)
+            {
+                return ERROR_INT;
+            }
+            snap->valid |= source;
+            return INICIAL_VALUE;
+        }
+    }
+
+    return ERROR_INT;
+}
+
+/**
+ * @brief Actualiza la instantánea leyendo una sola vez las fuentes indicadas.
+ *
+ * @param snap Instantánea a actualizar.
+ * @param mask Máscara SNAPSHOT_* de las fuentes a leer.
+ * @return 0 si todas las fuentes indicadas se leyeron, -1 si alguna falló.
+ */
+int update_snapshot_sources(proc_snapshot_t* snap, unsigned int mask)
+{
+    memset(snap, INICIAL_VALUE, sizeof(*snap));
+    snap->timestamp_ns = monotonic_ns();
+
+    for (int i = 0; i < SOURCE_COUNT; i++)
+    {
+        if ((parsers[i].bit & mask) && proc_source_read(&sources[i]) == INICIAL_VALUE)
+        {
+            parse_snapshot_source(snap, parsers[i].bit, sources[i].buf, sources[i].len);
+        }
+    }
+    for (size_t i = 0; i < sizeof(scanners) / sizeof(scanners[0]); i++)
+    {
+        if ((scanners[i].bit & mask) && scanners[i].scan(snap) == INICIAL_VALUE)
+        {
+            snap->valid |= scanners[i].bit;
+        }
+    }
+
+    return (snap->valid & mask) == mask ? INICIAL_VALUE : ERROR_INT;
+}
+
+/**
+ * @brief Actualiza la instantánea leyendo cada fuente de /proc una sola vez.
+ *
+ * @param snap Instantánea a actualizar.
+ * @return 0 si todas las fuentes se leyeron, -1 si alguna falló.
+ */
+int update_snapshot(proc_snapshot_t* snap)
+{
+    return update_snapshot_sources(snap, SNAPSHOT_ALL);
+}
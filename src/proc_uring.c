@@ -0,0 +1,261 @@
+/**
+ * @file proc_uring.c
+ * @brief Anillo de io_uring mapeado a mano para leer /proc en lote.
+ *
+ * Un único hilo encola y envía, así que la cola de envío solo necesita publicar su tail con un store release y la de
+ * respuestas leer su tail con un load acquire; los índices del kernel y los del proceso nunca se pisan.
+ */
+
+#include "proc_uring.h"
+#include "metrics.h"
+#include "monitor_stats.h"
+#include <errno.h>
+
+#ifdef HAVE_IO_URING
+#include <linux/io_uring.h>
+#include <stdint.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+
+/**
+ * @brief Operaciones consultadas con IORING_REGISTER_PROBE; alcanza con llegar a IORING_OP_READ.
+ */
+#define PROC_URING_PROBE_OPS 64
+
+/**
+ * @brief Estado del anillo.
+ */
+typedef struct
+{
+    int fd;                    ///< Descriptor de io_uring_setup(), o -1.
+    void* sq_ring;             ///< Cola de envío mapeada (y la de respuestas con IORING_FEAT_SINGLE_MMAP).
+    size_t sq_ring_size;       ///< Bytes mapeados de sq_ring.
+    void* cq_ring;             ///< Cola de respuestas mapeada; igual a sq_ring con IORING_FEAT_SINGLE_MMAP.
+    size_t cq_ring_size;       ///< Bytes mapeados de cq_ring.
+    struct io_uring_sqe* sqes; ///< Entradas de envío.
+    size_t sqes_size;          ///< Bytes mapeados de sqes.
+    unsigned int* sq_tail;     ///< Tail de la cola de envío, escrito por el proceso.
+    unsigned int sq_mask;      ///< Máscara de índices de la cola de envío.
+    unsigned int* sq_array;    ///< Índices de las entradas enviadas.
+    unsigned int* cq_head;     ///< Head de la cola de respuestas, escrito por el proceso.
+    unsigned int* cq_tail;     ///< Tail de la cola de respuestas, escrito por el kernel.
+    unsigned int cq_mask;      ///< Máscara de índices de la cola de respuestas.
+    struct io_uring_cqe* cqes; ///< Respuestas.
+    unsigned int queued;       ///< Lecturas encoladas y todavía no enviadas.
+} proc_uring_t;
+
+/**
+ * @brief Anillo único del proceso.
+ */
+static proc_uring_t ring = {.fd = ERROR_INT};
+
+/**
+ * @brief Indica si el kernel soporta IORING_OP_READ (agregado en 5.6, igual que IORING_REGISTER_PROBE).
+ *
+ * @return 1 si lo soporta, 0 si no.
+ */
+static int proc_uring_supports_read()
+{
+    char storage[sizeof(struct io_uring_probe) + PROC_URING_PROBE_OPS * sizeof(struct io_uring_probe_op)];
+    struct io_uring_probe* probe = (struct io_uring_probe*)storage;
+
+    memset(storage, INICIAL_VALUE, sizeof(storage));
+    if (syscall(__NR_io_uring_register, ring.fd, IORING_REGISTER_PROBE, probe, PROC_URING_PROBE_OPS) <
+        INICIAL_VALUE)
+    {
+        return INICIAL_VALUE;
+    }
+    return probe->last_op >= IORING_OP_READ && (probe->ops[IORING_OP_READ].flags & IO_URING_OP_SUPPORTED);
+}
+
+int proc_uring_init()
+{
+    struct io_uring_params params;
+
+    if (ring.fd >= INICIAL_VALUE)
+    {
+        return INICIAL_VALUE;
+    }
+    memset(&params, INICIAL_VALUE, sizeof(params));
+    ring.fd = (int)syscall(__NR_io_uring_setup, PROC_URING_DEPTH, &params);
+    if (ring.fd < INICIAL_VALUE)
+    {
+        return ERROR_INT;
+    }
+
+    ring.sq_ring_size = params.sq_off.array + params.sq_entries * sizeof(unsigned int);
+    ring.cq_ring_size = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    if (params.features & IORING_FEAT_SINGLE_MMAP)
+    {
+        // Las dos colas comparten un mapeo del tamaño de la mayor
+        if (ring.cq_ring_size > ring.sq_ring_size)
+        {
+            ring.sq_ring_size = ring.cq_ring_size;
+        }
+        ring.cq_ring_size = INICIAL_VALUE;
+    }
+    ring.sq_ring = mmap(NULL, ring.sq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring.fd,
+                        IORING_OFF_SQ_RING);
+    ring.cq_ring = ring.sq_ring;
+    if (ring.sq_ring != MAP_FAILED && ring.cq_ring_size > INICIAL_VALUE)
+    {
+        ring.cq_ring = mmap(NULL, ring.cq_ring_size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, ring.fd,
+                            IORING_OFF_CQ_RING);
+    }
+    ring.sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+    ring.sqes = ring.cq_ring == MAP_FAILED ? MAP_FAILED
+                                           : mmap(NULL, ring.sqes_size, PROT_READ | PROT_WRITE,
+                                                  MAP_SHARED | MAP_POPULATE, ring.fd, IORING_OFF_SQES);
+    if (ring.sq_ring == MAP_FAILED || ring.cq_ring == MAP_FAILED || ring.sqes == MAP_FAILED)
+    {
+        int saved = errno;
+        proc_uring_close();
+        errno = saved;
+        return ERROR_INT;
+    }
+
+    char* sq = ring.sq_ring;
+    char* cq = ring.cq_ring;
+    ring.sq_tail = (unsigned int*)(sq + params.sq_off.tail);
+    ring.sq_mask = *(unsigned int*)(sq + params.sq_off.ring_mask);
+    ring.sq_array = (unsigned int*)(sq + params.sq_off.array);
+    ring.cq_head = (unsigned int*)(cq + params.cq_off.head);
+    ring.cq_tail = (unsigned int*)(cq + params.cq_off.tail);
+    ring.cq_mask = *(unsigned int*)(cq + params.cq_off.ring_mask);
+    ring.cqes = (struct io_uring_cqe*)(cq + params.cq_off.cqes);
+    ring.queued = INICIAL_VALUE;
+
+    if (!proc_uring_supports_read())
+    {
+        proc_uring_close();
+        errno = EOPNOTSUPP;
+        return ERROR_INT;
+    }
+    return INICIAL_VALUE;
+}
+
+int proc_uring_queue_read(int fd, void* buf, size_t len, unsigned int tag)
+{
+    if (ring.fd < INICIAL_VALUE || ring.queued == PROC_URING_DEPTH)
+    {
+        return ERROR_INT;
+    }
+
+    // Solo este hilo escribe el tail, así que se puede leer sin sincronizar
+    unsigned int tail = *ring.sq_tail + ring.queued;
+    unsigned int index = tail & ring.sq_mask;
+    struct io_uring_sqe* sqe = &ring.sqes[index];
+
+    memset(sqe, INICIAL_VALUE, sizeof(*sqe));
+    sqe->opcode = IORING_OP_READ;
+    sqe->fd = fd;
+    sqe->addr = (unsigned long long)(uintptr_t)buf;
+    sqe->len = (unsigned int)len;
+    sqe->off = INICIAL_VALUE;
+    sqe->user_data = tag;
+    ring.sq_array[index] = index;
+    ring.queued++;
+    return INICIAL_VALUE;
+}
+
+int proc_uring_submit(ssize_t results[PROC_URING_DEPTH])
+{
+    unsigned int pending = ring.queued;
+    unsigned int to_submit = ring.queued;
+    int completed = INICIAL_VALUE;
+
+    if (ring.fd < INICIAL_VALUE)
+    {
+        return ERROR_INT;
+    }
+    if (pending == INICIAL_VALUE)
+    {
+        return INICIAL_VALUE;
+    }
+    // El kernel lee las entradas recién después de ver el nuevo tail
+    __atomic_store_n(ring.sq_tail, *ring.sq_tail + ring.queued, __ATOMIC_RELEASE);
+    ring.queued = INICIAL_VALUE;
+
+    while (pending > INICIAL_VALUE)
+    {
+        long n = syscall(__NR_io_uring_enter, ring.fd, to_submit, pending, IORING_ENTER_GETEVENTS, NULL, 0);
+        monitor_count_syscall(MONITOR_SYSCALL_URING);
+        if (n < INICIAL_VALUE && errno != EINTR)
+        {
+            // Con lecturas en vuelo el anillo no se puede reutilizar: se cierra y el llamador vuelve a pread()
+            perror("Error en io_uring_enter");
+            proc_uring_close();
+            return ERROR_INT;
+        }
+        if (n > INICIAL_VALUE)
+        {
+            to_submit -= (unsigned int)n;
+        }
+
+        unsigned int head = *ring.cq_head;
+        unsigned int tail = __atomic_load_n(ring.cq_tail, __ATOMIC_ACQUIRE);
+        for (; head != tail && pending > INICIAL_VALUE; head++, pending--)
+        {
+            const struct io_uring_cqe* cqe = &ring.cqes[head & ring.cq_mask];
+            if (cqe->user_data < PROC_URING_DEPTH)
+            {
+                results[cqe->user_data] = cqe->res;
+                monitor_count_bytes(cqe->res);
+                completed++;
+            }
+        }
+        __atomic_store_n(ring.cq_head, head, __ATOMIC_RELEASE);
+    }
+    return completed;
+}
+
+void proc_uring_close()
+{
+    if (ring.sqes != NULL && ring.sqes != MAP_FAILED)
+    {
+        munmap(ring.sqes, ring.sqes_size);
+    }
+    if (ring.cq_ring != NULL && ring.cq_ring != MAP_FAILED && ring.cq_ring != ring.sq_ring)
+    {
+        munmap(ring.cq_ring, ring.cq_ring_size);
+    }
+    if (ring.sq_ring != NULL && ring.sq_ring != MAP_FAILED)
+    {
+        munmap(ring.sq_ring, ring.sq_ring_size);
+    }
+    if (ring.fd >= INICIAL_VALUE)
+    {
+        close(ring.fd);
+    }
+    memset(&ring, INICIAL_VALUE, sizeof(ring));
+    ring.fd = ERROR_INT;
+}
+
+#else
+
+int proc_uring_init()
+{
+    errno = ENOSYS;
+    return ERROR_INT;
+}
+
+int proc_uring_queue_read(int fd, void* buf, size_t len, unsigned int tag)
+{
+    (void)fd;
+    (void)buf;
+    (void)len;
+    (void)tag;
+    return ERROR_INT;
+}
+
+int proc_uring_submit(ssize_t results[PROC_URING_DEPTH])
+{
+    (void)results;
+    return ERROR_INT;
+}
+
+void proc_uring_close()
+{
+}
+
+#endif
@@ -0,0 +1,788 @@
+/**
+ * @file proctable.c
+ * @brief Recorrido incremental de /proc/[pid] con estado persistente por proceso.
+ *
+ * El directorio /proc se mantiene abierto y se rebobina en cada ciclo; cada PID se busca en una tabla hash sin
+ * copiar su nombre y solo se reserva memoria cuando aparece un proceso nuevo. Los archivos de cada proceso se abren
+ * con openat() relativo a /proc, y los procesos de larga vida conservan sus descriptores hasta un presupuesto
+ * derivado de RLIMIT_NOFILE. Un descriptor de un proceso que terminó devuelve ESRCH aunque el PID se reutilice, y
+ * el instante de inicio distingue al proceso nuevo del anterior.
+ *
+ * Con el motor io_uring, las lecturas de los descriptores persistentes de hasta PROCTABLE_URING_BATCH procesos se
+ * envían juntas con proc_uring_submit() y se parsean después; los procesos sin descriptor persistente y los que
+ * terminaron entre dos ciclos siguen por openat() y pread().
+ */
+
+#include "proctable.h"
+#include "metrics.h"
+#include "monitor_stats.h"
+#include "proc_uring.h"
+#include "scan.h"
+#include "strmap.h"
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <stdatomic.h>
+#include <sys/resource.h>
+
+/**
+ * @brief Capacidad inicial de la tabla de procesos.
+ */
+#define PROCTABLE_INITIAL_CAPACITY 1024
+
+/**
+ * @brief Tamaño del buffer de lectura de /proc/[pid]/stat y /proc/[pid]/io.
+ */
+#define PROCTABLE_READ_SIZE 1024
+
+/**
+ * @brief Tope de descriptores persistentes, aunque RLIMIT_NOFILE permita más.
+ */
+#define PROCTABLE_MAX_FDS 4096
+
+/**
+ * @brief Procesos por lote de io_uring: cada uno encola a lo sumo stat e io.
+ */
+#define PROCTABLE_URING_BATCH (PROC_URING_DEPTH / 2)
+
+/**
+ * @brief Lecturas de un proceso encoladas en el lote actual.
+ */
+typedef struct
+{
+    proc_entry_t* entry; ///< Proceso.
+    int stat_tag;        ///< Lectura de /proc/[pid]/stat en el lote, o -1 si se lee con pread().
+    int io_tag;          ///< Lectura de /proc/[pid]/io en el lote, o -1 si se lee con pread().
+} proc_prefetch_t;
+
+/**
+ * @brief Lote de lecturas de io_uring con sus buffers.
+ */
+typedef struct
+{
+    proc_prefetch_t procs[PROCTABLE_URING_BATCH];     ///< Procesos del lote.
+    int count;                                        ///< Procesos válidos de procs.
+    int queued;                                       ///< Lecturas encoladas.
+    ssize_t results[PROC_URING_DEPTH];                ///< Resultado de cada lectura.
+    char bufs[PROC_URING_DEPTH][PROCTABLE_READ_SIZE]; ///< Buffer de cada lectura.
+} proc_batch_t;
+
+/**
+ * @brief Nombres de los recursos usados en las etiquetas.
+ */
+const char* const proc_rank_names[PROC_RANK_COUNT] = {"cpu", "rss", "io"};
+
+/**
+ * @brief Directorio /proc abierto de forma persistente.
+ */
+static DIR* proc_dir = NULL;
+
+/**
+ * @brief Descriptor de proc_dir, base de los openat() de cada proceso.
+ */
+static int proc_fd = ERROR_INT;
+
+/**
+ * @brief Tabla de procesos indexada por PID en texto.
+ */
+static strmap_t by_pid;
+
+/**
+ * @brief Todos los procesos conocidos.
+ */
+static proc_entry_t** entries = NULL;
+
+/**
+ * @brief Cantidad de entradas de entries.
+ */
+static int entry_count = INICIAL_VALUE;
+
+/**
+ * @brief Capacidad de entries.
+ */
+static int entry_cap = INICIAL_VALUE;
+
+/**
+ * @brief Número de ciclo de recorrido, usado para detectar procesos que terminaron.
+ */
+static unsigned int scan_cycle = INICIAL_VALUE;
+
+/**
+ * @brief 1 cuando la tabla ya se cargó una vez y los procesos nuevos cuentan como altas.
+ */
+static int primed = INICIAL_VALUE;
+
+/**
+ * @brief Ticks de reloj por segundo de utime y stime.
+ */
+static long clock_ticks = INICIAL_VALUE;
+
+/**
+ * @brief Tamaño de página, unidad del campo rss.
+ */
+static long page_size = INICIAL_VALUE;
+
+/**
+ * @brief Descriptores persistentes permitidos.
+ */
+static int fd_budget = INICIAL_VALUE;
+
+/**
+ * @brief Resultado del último ciclo; proc_snapshot_t::procs apunta aquí.
+ */
+static proc_top_t top;
+
+/**
+ * @brief Procesos por ranking; se cambia desde el hilo de configuración.
+ */
+static atomic_int top_n = PROCTABLE_DEFAULT_TOP_N;
+
+/**
+ * @brief Motor de lectura pedido; se cambia desde el hilo de configuración.
+ */
+static atomic_int io_engine = PROCTABLE_IO_PREAD;
+
+/**
+ * @brief Lote de io_uring, o NULL si se lee con pread().
+ */
+static proc_batch_t* batch = NULL;
+
+/**
+ * @brief 1 si io_uring falló una vez; no se reintenta hasta proctable_close().
+ */
+static int uring_unavailable = INICIAL_VALUE;
+
+/**
+ * @brief Configura cuántos procesos se exportan por ranking.
+ *
+ * @param n Cantidad de procesos.
+ */
+void set_proctable_top_n(int n)
+{
+    if (n < ASSIGNED_VALUE)
+    {
+        n = ASSIGNED_VALUE;
+    }
+    if (n > PROCTABLE_TOP_MAX)
+    {
+        n = PROCTABLE_TOP_MAX;
+    }
+    atomic_store(&top_n, n);
+}
+
+/**
+ * @brief Elige el motor de lectura de /proc/[pid].
+ *
+ * @param engine Motor.
+ */
+void set_proctable_io_engine(proctable_io_engine_t engine)
+{
+    atomic_store(&io_engine, engine);
+}
+
+/**
+ * @brief Abre /proc y calcula las constantes del sistema la primera vez.
+ *
+ * @return 0 en caso de éxito, -1 en caso de error.
+ */
+static int proctable_open()
+{
+    struct rlimit limit;
+
+    if (proc_dir != NULL)
+    {
+        return INICIAL_VALUE;
+    }
+    if (strmap_init(&by_pid, PROCTABLE_INITIAL_CAPACITY) != INICIAL_VALUE)
+    {
+        return ERROR_INT;
+    }
+    proc_dir = opendir(snapshot_proc_root());
+    if (proc_dir == NULL)
+    {
+        fprintf(stderr, "Error al abrir %s: %s\n", snapshot_proc_root(), strerror(errno));
+        strmap_free(&by_pid);
+        return ERROR_INT;
+    }
+    proc_fd = dirfd(proc_dir);
+    clock_ticks = sysconf(_SC_CLK_TCK);
+    page_size = sysconf(_SC_PAGESIZE);
+
+    // Un cuarto del límite de descriptores; el resto queda para los sockets HTTP y las demás fuentes
+    fd_budget = PROCTABLE_MAX_FDS;
+    if (getrlimit(RLIMIT_NOFILE, &limit) == INICIAL_VALUE && limit.rlim_cur != RLIM_INFINITY &&
+        limit.rlim_cur / 4 < (rlim_t)fd_budget)
+    {
+        fd_budget = (int)(limit.rlim_cur / 4);
+    }
+    return INICIAL_VALUE;
+}
+
+/**
+ * @brief Busca el estado persistente de un proceso, creándolo si es nuevo.
+ *
+ * @param key PID en texto.
+ * @param key_len Longitud del PID.
+ * @return Estado del proceso, o NULL si no se pudo reservar memoria.
+ */
+static proc_entry_t* proctable_lookup(const char* key, size_t key_len)
+{
+    proc_entry_t* entry = strmap_get(&by_pid, key, key_len);
+    if (entry != NULL)
+    {
+        return entry;
+    }
+
+    if (entry_count == entry_cap)
+    {
+        int cap = entry_cap ? entry_cap * 2 : PROCTABLE_INITIAL_CAPACITY;
+        proc_entry_t** bigger = realloc(entries, (size_t)cap * sizeof(*entries));
+        if (bigger == NULL)
+        {
+            perror("Error al asignar memoria");
+            return NULL;
+        }
+        entries = bigger;
+        entry_cap = cap;
+    }
+
+    entry = calloc(1, sizeof(*entry));
+    if (entry == NULL)
+    {
+        perror("Error al asignar memoria");
+        return NULL;
+    }
+    scan_copy(entry->key, sizeof(entry->key), key, key_len);
+    entry->pid = atoi(entry->key);
+    entry->stat_fd = ERROR_INT;
+    entry->io_fd = ERROR_INT;
+    if (strmap_put(&by_pid, entry->key, entry) != INICIAL_VALUE)
+    {
+        free(entry);
+        return NULL;
+    }
+
+    entries[entry_count++] = entry;
+    if (primed)
+    {
+        top.births++;
+    }
+    return entry;
+}
+
+/**
+ * @brief Cierra un descriptor persistente de un proceso.
+ *
+ * @param fd Descriptor a cerrar; queda en -1.
+ */
+static void proc_entry_close_fd(int* fd)
+{
+    if (*fd >= INICIAL_VALUE)
+    {
+        close(*fd);
+        monitor_count_syscall(MONITOR_SYSCALL_CLOSE);
+        *fd = ERROR_INT;
+        top.open_fds--;
+    }
+}
+
+/**
+ * @brief Lee un archivo de /proc/[pid] con el descriptor persistente, o abriéndolo con openat() si no lo hay.
+ *
+ * El descriptor recién abierto se conserva si el proceso ya sobrevivió PROCTABLE_FD_MIN_AGE ciclos y queda
+ * presupuesto; si no, se cierra después de leer.
+ *
+ * @param entry Proceso.
+ * @param fd Descriptor persistente del archivo.
+ * @param file Nombre del archivo dentro de /proc/[pid].
+ * @param buf Buffer de lectura, terminado en '\0' tras la lectura.
+ * @param cap Capacidad del buffer.
+ * @return Bytes leídos, o -1 en caso de error (errno indica la causa).
+ */
+static ssize_t proc_entry_read(proc_entry_t* entry, int* fd, const char* file, char* buf, size_t cap)
+{
+    char path[PROCTABLE_PID_SIZE + ASSIGNED_VALUE_8];
+    ssize_t n;
+
+    if (*fd >= INICIAL_VALUE)
+    {
+        n = pread(*fd, buf, cap - ASSIGNED_VALUE, INICIAL_VALUE);
+        monitor_count_read(n);
+        if (n >= INICIAL_VALUE)
+        {
+            buf[n] = '\0';
+            return n;
+        }
+        // El proceso del descriptor terminó (ESRCH); el PID puede pertenecer ahora a otro proceso
+        proc_entry_close_fd(fd);
+    }
+
+    snprintf(path, sizeof(path), "%s/%s", entry->key, file);
+    int tmp = openat(proc_fd, path, O_RDONLY | O_CLOEXEC);
+    monitor_count_syscall(MONITOR_SYSCALL_OPEN);
+    if (tmp < INICIAL_VALUE)
+    {
+        return ERROR_INT;
+    }
+    n = pread(tmp, buf, cap - ASSIGNED_VALUE, INICIAL_VALUE);
+    monitor_count_read(n);
+    if (n >= INICIAL_VALUE && entry->age >= PROCTABLE_FD_MIN_AGE && top.open_fds < fd_budget)
+    {
+        *fd = tmp;
+        top.open_fds++;
+    }
+    else
+    {
+        int saved = errno;
+        close(tmp);
+        monitor_count_syscall(MONITOR_SYSCALL_CLOSE);
+        errno = saved;
+    }
+    if (n < INICIAL_VALUE)
+    {
+        return ERROR_INT;
+    }
+    buf[n] = '\0';
+    return n;
+}
+
+/**
+ * @brief Toma una lectura del lote de io_uring, o lee con proc_entry_read() si no estaba encolada o falló.
+ *
+ * @param entry Proceso.
+ * @param fd Descriptor persistente del archivo.
+ * @param file Nombre del archivo dentro de /proc/[pid].
+ * @param tag Lectura en el lote, o -1.
+ * @param buf Buffer para proc_entry_read().
+ * @param cap Capacidad de buf.
+ * @param data Contenido leído, terminado en '\0': el buffer del lote o buf.
+ * @return Bytes leídos, o -1 en caso de error (errno indica la causa).
+ */
+static ssize_t proc_entry_fetch(proc_entry_t* entry, int* fd, const char* file, int tag, char* buf, size_t cap,
+                                const char** data)
+{
+    if (tag >= INICIAL_VALUE)
+    {
+        ssize_t n = batch->results[tag];
+        if (n >= INICIAL_VALUE)
+        {
+            batch->bufs[tag][n] = '\0';
+            *data = batch->bufs[tag];
+            return n;
+        }
+        // Igual que con pread(): el proceso del descriptor terminó y se reintenta con openat()
+        proc_entry_close_fd(fd);
+    }
+    *data = buf;
+    return proc_entry_read(entry, fd, file, buf, cap);
+}
+
+int proctable_parse_stat(proc_entry_t* entry, const char* buf, size_t len, unsigned long long* ticks,
+                         unsigned long long* start, unsigned long long* rss)
+{
+    const char* open = memchr(buf, '(', len);
+    const char* end = buf + len;
+    unsigned long long utime, stime;
+    scan_t s;
+
+    while (end > buf && end[-1] != ')')
+    {
+        end--;
+    }
+    if (open == NULL || end <= open + ASSIGNED_VALUE)
+    {
+        return ERROR_INT;
+    }
+    scan_copy(entry->comm, sizeof(entry->comm), open + ASSIGNED_VALUE, (size_t)(end - open) - 2);
+
+    // Después de ')': state(3) ... cmajflt(13) utime(14) stime(15) ... itrealvalue(21) starttime(22) vsize(23) rss(24)
+    scan_init(&s, end, (size_t)(buf + len - end));
+    if (!scan_skip_fields(&s, 11) || !scan_u64(&s, &utime) || !scan_u64(&s, &stime) || !scan_skip_fields(&s, 6) ||
+        !scan_u64(&s, start) || !scan_skip_fields(&s, ASSIGNED_VALUE) || !scan_u64(&s, rss))
+    {
+        return ERROR_INT;
+    }
+    *ticks = utime + stime;
+    return INICIAL_VALUE;
+}
+
+/**
+ * @brief Incremento de un contador de proceso; un valor menor que el anterior cuenta desde cero.
+ *
+ * @param cur Valor actual.
+ * @param prev Valor anterior.
+ * @return Incremento desde la lectura anterior.
+ */
+static unsigned long long proc_delta(unsigned long long cur, unsigned long long prev)
+{
+    return cur >= prev ? cur - prev : cur;
+}
+
+/**
+ * @brief Relee un proceso y recalcula sus tasas.
+ *
+ * @param entry Proceso.
+ * @param now Instante de la lectura.
+ * @param stat_tag Lectura de /proc/[pid]/stat en el lote de io_uring, o -1.
+ * @param io_tag Lectura de /proc/[pid]/io en el lote de io_uring, o -1.
+ * @return 0 en caso de éxito, -1 si el proceso ya no existe.
+ */
+static int proc_entry_update(proc_entry_t* entry, unsigned long long now, int stat_tag, int io_tag)
+{
+    static char buf[PROCTABLE_READ_SIZE]; // proctable_scan() corre en un único hilo
+    unsigned long long ticks, start, rss;
+    unsigned long long read_bytes = entry->read_bytes;
+    unsigned long long write_bytes = entry->write_bytes;
+    const char* data;
+    scan_t s, line;
+
+    ssize_t n = proc_entry_fetch(entry, &entry->stat_fd, "stat", stat_tag, buf, sizeof(buf), &data);
+    if (n <= INICIAL_VALUE || proctable_parse_stat(entry, data, (size_t)n, &ticks, &start, &rss) != INICIAL_VALUE)
+    {
+        return ERROR_INT;
+    }
+
+    if (entry->age > INICIAL_VALUE && start != entry->start_time)
+    {
+        // PID reutilizado entre dos ciclos: termina el proceso anterior y empieza uno nuevo
+        top.exits++;
+        top.births++;
+        entry->age = INICIAL_VALUE;
+        entry->has_prev = INICIAL_VALUE;
+        entry->io_denied = INICIAL_VALUE;
+        proc_entry_close_fd(&entry->io_fd);
+        io_tag = ERROR_INT; // la lectura del lote es del proceso anterior
+    }
+    entry->start_time = start;
+
+    if (!entry->io_denied)
+    {
+        n = proc_entry_fetch(entry, &entry->io_fd, "io", io_tag, buf, sizeof(buf), &data);
+        if (n < INICIAL_VALUE)
+        {
+            // Sin CAP_SYS_PTRACE los procesos de otros usuarios no exponen su E/S; no se reintenta
+            entry->io_denied = errno == EACCES || errno == EPERM;
+        }
+        else
+        {
+            scan_init(&s, data, (size_t)n);
+            if (scan_skip_to_key(&s, "read_bytes", &line))
+            {
+                scan_u64(&line, &read_bytes);
+            }
+            if (scan_skip_to_key(&s, "write_bytes", &line)) // write_bytes aparece después de read_bytes
+            {
+                scan_u64(&line, &write_bytes);
+            }
+        }
+    }
+
+    double elapsed = entry->has_prev && now > entry->prev_timestamp_ns
+                         ? (double)(now - entry->prev_timestamp_ns) / 1e9
+                         : INICIAL_VALUE;
+    if (elapsed > INICIAL_VALUE)
+    {
+        entry->cpu_percent =
+            (double)proc_delta(ticks, entry->cpu_ticks) / (double)clock_ticks / elapsed * POCENTAGE;
+        entry->io_bytes_per_second =
+            (double)(proc_delta(read_bytes, entry->read_bytes) + proc_delta(write_bytes, entry->write_bytes)) /
+            elapsed;
+    }
+    else
+    {
+        entry->cpu_percent = INICIAL_VALUE;
+        entry->io_bytes_per_second = INICIAL_VALUE;
+    }
+
+    entry->cpu_ticks = ticks;
+    entry->read_bytes = read_bytes;
+    entry->write_bytes = write_bytes;
+    entry->rss_bytes = rss * (unsigned long long)page_size;
+    entry->prev_timestamp_ns = now;
+    entry->has_prev = ASSIGNED_VALUE;
+    entry->age++;
+    return INICIAL_VALUE;
+}
+
+/**
+ * @brief Libera los procesos que no aparecieron o no se pudieron leer en el ciclo actual.
+ */
+static void proctable_remove_stale()
+{
+    for (int i = 0; i < entry_count;)
+    {
+        proc_entry_t* entry = entries[i];
+        if (entry->last_seen == scan_cycle)
+        {
+            i++;
+            continue;
+        }
+        proc_entry_close_fd(&entry->stat_fd);
+        proc_entry_close_fd(&entry->io_fd);
+        strmap_remove(&by_pid, entry->key);
+        free(entry);
+        entries[i] = entries[--entry_count];
+        top.exits++;
+    }
+}
+
+/**
+ * @brief Valor de un proceso en un ranking.
+ *
+ * @param entry Proceso.
+ * @param rank Ranking (enum proc_rank).
+ * @return Valor por el que se ordena.
+ */
+static double proc_rank_value(const proc_entry_t* entry, int rank)
+{
+    switch (rank)
+    {
+    case PROC_RANK_CPU:
+        return entry->cpu_percent;
+    case PROC_RANK_RSS:
+        return (double)entry->rss_bytes;
+    default:
+        return entry->io_bytes_per_second;
+    }
+}
+
+/**
+ * @brief Inserta un proceso en un ranking ordenado de a lo sumo n entradas, si le corresponde un puesto.
+ *
+ * @param rank Ranking (enum proc_rank).
+ * @param entry Proceso.
+ * @param n Tamaño del ranking.
+ */
+static void proctable_rank_insert(int rank, const proc_entry_t* entry, int n)
+{
+    const proc_entry_t** list = top.top[rank];
+    double value = proc_rank_value(entry, rank);
+    int i;
+
+    if (value <= INICIAL_VALUE ||
+        (top.count[rank] == n && value <= proc_rank_value(list[n - ASSIGNED_VALUE], rank)))
+    {
+        return;
+    }
+    i = top.count[rank] < n ? top.count[rank]++ : n - ASSIGNED_VALUE;
+    for (; i > INICIAL_VALUE && proc_rank_value(list[i - ASSIGNED_VALUE], rank) < value; i--)
+    {
+        list[i] = list[i - ASSIGNED_VALUE];
+    }
+    list[i] = entry;
+}
+
+/**
+ * @brief Libera el lote y el anillo de io_uring.
+ */
+static void proctable_uring_release()
+{
+    if (batch != NULL)
+    {
+        proc_uring_close();
+        free(batch);
+        batch = NULL;
+    }
+}
+
+/**
+ * @brief Prepara el motor pedido para un ciclo: crea el anillo la primera vez o lo libera si se volvió a pread().
+ *
+ * @return 1 si el ciclo usa io_uring, 0 si usa pread().
+ */
+static int proctable_use_uring()
+{
+    if (atomic_load(&io_engine) != PROCTABLE_IO_URING || uring_unavailable)
+    {
+        proctable_uring_release();
+        return INICIAL_VALUE;
+    }
+    if (batch != NULL)
+    {
+        return ASSIGNED_VALUE;
+    }
+    if (proc_uring_init() != INICIAL_VALUE)
+    {
+        fprintf(stderr, "io_uring no disponible (%s); /proc/[pid] se lee con pread()\n", strerror(errno));
+        uring_unavailable = ASSIGNED_VALUE;
+        return INICIAL_VALUE;
+    }
+    batch = calloc(1, sizeof(*batch));
+    if (batch == NULL)
+    {
+        perror("Error al asignar memoria");
+        proc_uring_close();
+        uring_unavailable = ASSIGNED_VALUE;
+        return INICIAL_VALUE;
+    }
+    return ASSIGNED_VALUE;
+}
+
+/**
+ * @brief Encola una lectura de un descriptor persistente en el lote.
+ *
+ * @param fd Descriptor, o -1 si no hay uno persistente.
+ * @return Lectura en el lote, o -1 si se tiene que leer con pread().
+ */
+static int proctable_batch_queue(int fd)
+{
+    if (fd < INICIAL_VALUE ||
+        proc_uring_queue_read(fd, batch->bufs[batch->queued], PROCTABLE_READ_SIZE - ASSIGNED_VALUE,
+                              (unsigned int)batch->queued) != INICIAL_VALUE)
+    {
+        return ERROR_INT;
+    }
+    batch->results[batch->queued] = -EIO;
+    return batch->queued++;
+}
+
+/**
+ * @brief Envía el lote, espera las lecturas y actualiza sus procesos.
+ *
+ * Si io_uring_enter() falla, los procesos del lote se leen con pread() y el motor queda deshabilitado.
+ *
+ * @param now Instante de la lectura.
+ */
+static void proctable_batch_flush(unsigned long long now)
+{
+    if (batch->queued > INICIAL_VALUE && proc_uring_submit(batch->results) < INICIAL_VALUE)
+    {
+        fprintf(stderr, "Se deja de usar io_uring; /proc/[pid] se lee con pread()\n");
+        uring_unavailable = ASSIGNED_VALUE;
+        for (int i = 0; i < batch->count; i++)
+        {
+            batch->procs[i].stat_tag = ERROR_INT;
+            batch->procs[i].io_tag = ERROR_INT;
+        }
+    }
+    for (int i = 0; i < batch->count; i++)
+    {
+        proc_prefetch_t* pre = &batch->procs[i];
+        if (proc_entry_update(pre->entry, now, pre->stat_tag, pre->io_tag) == INICIAL_VALUE)
+        {
+            pre->entry->last_seen = scan_cycle;
+        }
+    }
+    batch->count = INICIAL_VALUE;
+    batch->queued = INICIAL_VALUE;
+}
+
+/**
+ * @brief Agrega un proceso al lote y lo envía si se llenó.
+ *
+ * @param entry Proceso.
+ * @param now Instante de la lectura.
+ */
+static void proctable_batch_add(proc_entry_t* entry, unsigned long long now)
+{
+    proc_prefetch_t* pre = &batch->procs[batch->count++];
+    pre->entry = entry;
+    pre->stat_tag = proctable_batch_queue(entry->stat_fd);
+    pre->io_tag = entry->io_denied ? ERROR_INT : proctable_batch_queue(entry->io_fd);
+    if (batch->count == PROCTABLE_URING_BATCH)
+    {
+        proctable_batch_flush(now);
+    }
+}
+
+/**
+ * @brief Recorre /proc, actualiza la tabla de procesos y calcula los rankings del ciclo.
+ *
+ * @param snap Instantánea a completar.
+ * @return 0 en caso de éxito, -1 en caso de error.
+ */
+int proctable_scan(proc_snapshot_t* snap)
+{
+    struct dirent* de;
+    int saved;
+
+    if (proctable_open() != INICIAL_VALUE)
+    {
+        return ERROR_INT;
+    }
+    int uring = proctable_use_uring();
+
+    scan_cycle++;
+    rewinddir(proc_dir);
+    for (errno = INICIAL_VALUE; (de = readdir(proc_dir)) != NULL; errno = INICIAL_VALUE)
+    {
+        size_t len = INICIAL_VALUE;
+        while (de->d_name[len] >= '0' && de->d_name[len] <= '9')
+        {
+            len++;
+        }
+        if (len == INICIAL_VALUE || de->d_name[len] != '\0' || len >= PROCTABLE_PID_SIZE)
+        {
+            continue; // "self", "meminfo", ... no son procesos
+        }
+
+        proc_entry_t* entry = proctable_lookup(de->d_name, len);
+        if (entry == NULL)
+        {
+            continue;
+        }
+        if (uring)
+        {
+            proctable_batch_add(entry, snap->timestamp_ns);
+        }
+        else if (proc_entry_update(entry, snap->timestamp_ns, ERROR_INT, ERROR_INT) == INICIAL_VALUE)
+        {
+            entry->last_seen = scan_cycle;
+        }
+    }
+    saved = errno;
+    if (uring)
+    {
+        proctable_batch_flush(snap->timestamp_ns);
+    }
+    if (saved != INICIAL_VALUE)
+    {
+        errno = saved;
+        perror("Error al recorrer /proc");
+        return ERROR_INT;
+    }
+
+    proctable_remove_stale();
+    primed = ASSIGNED_VALUE;
+
+    int n = atomic_load(&top_n);
+    memset(top.count, INICIAL_VALUE, sizeof(top.count));
+    for (int i = 0; i < entry_count; i++)
+    {
+        for (int r = 0; r < PROC_RANK_COUNT; r++)
+        {
+            proctable_rank_insert(r, entries[i], n);
+        }
+    }
+    top.tracked = entry_count;
+    snap->procs = &top;
+    return INICIAL_VALUE;
+}
+
+/**
+ * @brief Cierra los descriptores y libera la tabla de procesos.
+ */
+void proctable_close()
+{
+    for (int i = 0; i < entry_count; i++)
+    {
+        proc_entry_close_fd(&entries[i]->stat_fd);
+        proc_entry_close_fd(&entries[i]->io_fd);
+        free(entries[i]);
+    }
+    free(entries);
+    proctable_uring_release();
+    uring_unavailable = INICIAL_VALUE;
+    if (proc_dir != NULL)
+    {
+        strmap_free(&by_pid);
+        closedir(proc_dir);
+    }
+    entries = NULL;
+    proc_dir = NULL;
+    proc_fd = ERROR_INT;
+    entry_count = INICIAL_VALUE;
+    entry_cap = INICIAL_VALUE;
+    primed = INICIAL_VALUE;
+    memset(&top, INICIAL_VALUE, sizeof(top));
+}
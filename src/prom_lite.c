@@ -0,0 +1,604 @@
+/**
+ * @file prom_lite.c
+ * @brief Métricas y formato de texto de Prometheus sin libprom.
+ *
+ * Las series de una métrica se buscan en una strmap por los valores de sus etiquetas unidos con '\x1f', y se guardan
+ * también en un arreglo para escribirlas en el orden en que aparecieron. Las etiquetas ya escapadas se arman una sola
+ * vez al crear la serie, así que el bridge solo copia texto y formatea números. prom_collector_registry_render() escribe
+ * el mismo texto en una arena, para que un scrape con la capacidad ya reservada no le pida memoria al heap.
+ */
+
+#include "prom_lite.h"
+#include "arena.h"
+#include "strmap.h"
+#include <math.h>
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @brief Tamaño de la clave de una serie que se arma en la pila; las más largas se arman en el heap.
+ */
+#define PROM_LITE_KEY_SIZE 256
+
+/**
+ * @brief Tamaño de un número formateado.
+ */
+#define PROM_LITE_NUMBER_SIZE 32
+
+/**
+ * @brief Capacidad inicial del texto del bridge.
+ */
+#define PROM_LITE_INITIAL_TEXT (64 * 1024)
+
+/**
+ * @brief Tipo de una métrica.
+ */
+typedef enum
+{
+    PROM_LITE_GAUGE,
+    PROM_LITE_COUNTER,
+    PROM_LITE_HISTOGRAM
+} prom_lite_kind_t;
+
+/**
+ * @brief Serie de una métrica.
+ */
+typedef struct
+{
+    char* key;                   ///< Valores de las etiquetas unidos con '\x1f'; clave de la strmap.
+    char* labels;                ///< Etiquetas escapadas ("cpu=\"0\",mode=\"user\""), o "" si no tiene.
+    double value;                ///< Valor de un gauge o un contador, o suma de un histograma.
+    unsigned long long count;    ///< Observaciones de un histograma.
+    unsigned long long* buckets; ///< Observaciones por cubeta (no acumuladas), la última es +Inf.
+} prom_lite_series_t;
+
+struct prom_metric
+{
+    prom_lite_kind_t kind;             ///< Tipo de la métrica.
+    const char* name;                  ///< Nombre.
+    const char* help;                  ///< Texto de ayuda.
+    size_t label_count;                ///< Cantidad de etiquetas.
+    const char** label_keys;           ///< Nombres de las etiquetas.
+    prom_histogram_buckets_t* buckets; ///< Cubetas de un histograma, o NULL.
+    pthread_mutex_t lock;              ///< Protege las series.
+    strmap_t by_key;                   ///< Series por valores de etiquetas.
+    prom_lite_series_t** series;       ///< Series en orden de aparición.
+    size_t count;                      ///< Series válidas.
+    size_t cap;                        ///< Capacidad de series.
+    prom_metric_t* next;               ///< Siguiente métrica del registro.
+};
+
+struct prom_collector_registry
+{
+    pthread_mutex_t lock; ///< Protege la lista.
+    prom_metric_t* head;  ///< Primera métrica registrada.
+    prom_metric_t* tail;  ///< Última métrica registrada.
+};
+
+prom_collector_registry_t* PROM_COLLECTOR_REGISTRY_DEFAULT = NULL;
+
+/**
+ * @brief Texto que crece con realloc o, si tiene arena, dentro de ella.
+ */
+typedef struct
+{
+    char* data;     ///< Contenido terminado en '\0'.
+    size_t len;     ///< Bytes válidos sin contar el '\0'.
+    size_t cap;     ///< Capacidad de data.
+    int failed;     ///< 1 si alguna escritura no tuvo memoria.
+    arena_t* arena; ///< Arena de la que sale data, o NULL para reservarla con realloc.
+} prom_lite_text_t;
+
+/**
+ * @brief Asegura lugar para len bytes más el '\0'.
+ */
+static int text_reserve(prom_lite_text_t* text, size_t len)
+{
+    if (text->failed)
+    {
+        return 1;
+    }
+    if (text->len + len + 1 <= text->cap)
+    {
+        return 0;
+    }
+    size_t cap = text->cap > 0 ? text->cap : PROM_LITE_INITIAL_TEXT;
+    while (cap < text->len + len + 1)
+    {
+        cap *= 2;
+    }
+    // En una arena el buffer anterior no se libera: queda hasta el arena_reset() del scrape
+    char* data = text->arena != NULL ? arena_alloc(text->arena, cap) : realloc(text->data, cap);
+    if (data == NULL)
+    {
+        text->failed = 1;
+        return 1;
+    }
+    if (text->arena != NULL && text->len > 0)
+    {
+        memcpy(data, text->data, text->len + 1);
+    }
+    text->data = data;
+    text->cap = cap;
+    return 0;
+}
+
+/**
+ * @brief Agrega texto.
+ */
+static void text_append(prom_lite_text_t* text, const char* data, size_t len)
+{
+    if (text_reserve(text, len) == 0)
+    {
+        memcpy(text->data + text->len, data, len);
+        text->len += len;
+        text->data[text->len] = '\0';
+    }
+}
+
+/**
+ * @brief Agrega texto con formato.
+ */
+static void text_printf(prom_lite_text_t* text, const char* fmt, ...) __attribute__((format(printf, 2, 3)));
+static void text_printf(prom_lite_text_t* text, const char* fmt, ...)
+{
+    va_list args;
+    va_start(args, fmt);
+    va_list copy;
+    va_copy(copy, args);
+    int len = vsnprintf(NULL, 0, fmt, copy);
+    va_end(copy);
+    if (len >= 0 && text_reserve(text, (size_t)len) == 0)
+    {
+        vsnprintf(text->data + text->len, (size_t)len + 1, fmt, args);
+        text->len += (size_t)len;
+    }
+    va_end(args);
+}
+
+/**
+ * @brief Formatea un número con la representación más corta que se lee de vuelta igual.
+ *
+ * @param buf Destino de PROM_LITE_NUMBER_SIZE bytes.
+ * @param value Número.
+ */
+static void format_number(char* buf, double value)
+{
+    if (isnan(value))
+    {
+        snprintf(buf, PROM_LITE_NUMBER_SIZE, "NaN");
+        return;
+    }
+    if (isinf(value))
+    {
+        snprintf(buf, PROM_LITE_NUMBER_SIZE, "%s", value > 0 ? "+Inf" : "-Inf");
+        return;
+    }
+    snprintf(buf, PROM_LITE_NUMBER_SIZE, "%.15g", value);
+    if (strtod(buf, NULL) != value)
+    {
+        snprintf(buf, PROM_LITE_NUMBER_SIZE, "%.17g", value);
+    }
+}
+
+/**
+ * @brief Agrega un texto escapando '\\', '"' (si quote) y '\n', como piden los valores de etiquetas y la ayuda.
+ */
+static void text_escaped(prom_lite_text_t* text, const char* value, int quote)
+{
+    for (const char* c = value; *c != '\0'; c++)
+    {
+        if (*c == '\\' || (quote && *c == '"'))
+        {
+            text_append(text, "\\", 1);
+            text_append(text, c, 1);
+        }
+        else if (*c == '\n')
+        {
+            text_append(text, "\\n", 2);
+        }
+        else
+        {
+            text_append(text, c, 1);
+        }
+    }
+}
+
+int prom_collector_registry_default_init(void)
+{
+    if (PROM_COLLECTOR_REGISTRY_DEFAULT != NULL)
+    {
+        return 0;
+    }
+    prom_collector_registry_t* registry = calloc(1, sizeof(*registry));
+    if (registry == NULL)
+    {
+        return 1;
+    }
+    pthread_mutex_init(&registry->lock, NULL);
+    PROM_COLLECTOR_REGISTRY_DEFAULT = registry;
+    return 0;
+}
+
+prom_metric_t* prom_collector_registry_must_register_metric(prom_metric_t* metric)
+{
+    prom_collector_registry_t* registry = PROM_COLLECTOR_REGISTRY_DEFAULT;
+    if (metric == NULL || registry == NULL)
+    {
+        return NULL;
+    }
+    pthread_mutex_lock(&registry->lock);
+    if (registry->tail != NULL)
+    {
+        registry->tail->next = metric;
+    }
+    else
+    {
+        registry->head = metric;
+    }
+    registry->tail = metric;
+    pthread_mutex_unlock(&registry->lock);
+    return metric;
+}
+
+/**
+ * @brief Crea una métrica de cualquier tipo.
+ */
+static prom_metric_t* metric_new(prom_lite_kind_t kind, const char* name, const char* help, size_t label_count,
+                                 const char** label_keys)
+{
+    prom_metric_t* metric = calloc(1, sizeof(*metric));
+    if (metric == NULL)
+    {
+        return NULL;
+    }
+    metric->label_keys = label_count > 0 ? calloc(label_count, sizeof(*metric->label_keys)) : NULL;
+    if ((label_count > 0 && metric->label_keys == NULL) || strmap_init(&metric->by_key, 0) != 0)
+    {
+        free(metric->label_keys);
+        free(metric);
+        return NULL;
+    }
+    for (size_t i = 0; i < label_count; i++)
+    {
+        metric->label_keys[i] = label_keys[i];
+    }
+    metric->kind = kind;
+    metric->name = name;
+    metric->help = help;
+    metric->label_count = label_count;
+    pthread_mutex_init(&metric->lock, NULL);
+    return metric;
+}
+
+prom_gauge_t* prom_gauge_new(const char* name, const char* help, size_t label_key_count, const char** label_keys)
+{
+    return metric_new(PROM_LITE_GAUGE, name, help, label_key_count, label_keys);
+}
+
+prom_counter_t* prom_counter_new(const char* name, const char* help, size_t label_key_count, const char** label_keys)
+{
+    return metric_new(PROM_LITE_COUNTER, name, help, label_key_count, label_keys);
+}
+
+prom_histogram_t* prom_histogram_new(const char* name, const char* help, prom_histogram_buckets_t* buckets,
+                                     size_t label_key_count, const char** label_keys)
+{
+    if (buckets == NULL)
+    {
+        return NULL;
+    }
+    prom_metric_t* metric = metric_new(PROM_LITE_HISTOGRAM, name, help, label_key_count, label_keys);
+    if (metric != NULL)
+    {
+        metric->buckets = buckets;
+    }
+    return metric;
+}
+
+/**
+ * @brief Crea una serie nueva; se llama con el lock de la métrica tomado.
+ *
+ * @param metric Métrica.
+ * @param key Clave ya armada.
+ * @param key_len Longitud de la clave.
+ * @param label_values Valores de las etiquetas.
+ * @return Serie, o NULL si no hay memoria.
+ */
+static prom_lite_series_t* series_new(prom_metric_t* metric, const char* key, size_t key_len,
+                                      const char** label_values)
+{
+    if (metric->count == metric->cap)
+    {
+        size_t cap = metric->cap > 0 ? metric->cap * 2 : 8;
+        prom_lite_series_t** bigger = realloc(metric->series, cap * sizeof(*bigger));
+        if (bigger == NULL)
+        {
+            return NULL;
+        }
+        metric->series = bigger;
+        metric->cap = cap;
+    }
+
+    prom_lite_text_t labels = {0};
+    for (size_t i = 0; i < metric->label_count; i++)
+    {
+        text_printf(&labels, "%s%s=\"", i > 0 ? "," : "", metric->label_keys[i]);
+        text_escaped(&labels, label_values[i], 1);
+        text_append(&labels, "\"", 1);
+    }
+    text_append(&labels, "", 0);
+
+    prom_lite_series_t* series = calloc(1, sizeof(*series));
+    if (series != NULL)
+    {
+        series->key = malloc(key_len + 1);
+        series->labels = labels.data;
+        if (metric->kind == PROM_LITE_HISTOGRAM)
+        {
+            series->buckets = calloc((size_t)metric->buckets->count + 1, sizeof(*series->buckets));
+        }
+    }
+    if (series == NULL || series->key == NULL || labels.failed ||
+        (metric->kind == PROM_LITE_HISTOGRAM && series->buckets == NULL))
+    {
+        if (series != NULL)
+        {
+            free(series->key);
+            free(series->buckets);
+            free(series);
+        }
+        free(labels.data);
+        return NULL;
+    }
+    memcpy(series->key, key, key_len);
+    series->key[key_len] = '\0';
+
+    if (strmap_put(&metric->by_key, series->key, series) != 0)
+    {
+        free(series->key);
+        free(series->labels);
+        free(series->buckets);
+        free(series);
+        return NULL;
+    }
+    metric->series[metric->count++] = series;
+    return series;
+}
+
+/**
+ * @brief Busca la serie de unos valores de etiquetas, creándola si es nueva; se llama con el lock tomado.
+ *
+ * @return Serie, o NULL si no hay memoria.
+ */
+static prom_lite_series_t* series_lookup(prom_metric_t* metric, const char** label_values)
+{
+    char stack_key[PROM_LITE_KEY_SIZE];
+    size_t key_len = 0;
+    for (size_t i = 0; i < metric->label_count; i++)
+    {
+        key_len += strlen(label_values[i]) + (i > 0 ? 1 : 0);
+    }
+    char* key = key_len < sizeof(stack_key) ? stack_key : malloc(key_len + 1);
+    if (key == NULL)
+    {
+        return NULL;
+    }
+
+    size_t pos = 0;
+    for (size_t i = 0; i < metric->label_count; i++)
+    {
+        if (i > 0)
+        {
+            key[pos++] = '\x1f';
+        }
+        size_t len = strlen(label_values[i]);
+        memcpy(key + pos, label_values[i], len);
+        pos += len;
+    }
+    key[pos] = '\0';
+
+    prom_lite_series_t* series = strmap_get(&metric->by_key, key, key_len);
+    if (series == NULL)
+    {
+        series = series_new(metric, key, key_len, label_values);
+    }
+    if (key != stack_key)
+    {
+        free(key);
+    }
+    return series;
+}
+
+int prom_gauge_set(prom_gauge_t* self, double r_value, const char** label_values)
+{
+    if (self == NULL || (self->label_count > 0 && label_values == NULL))
+    {
+        return 1;
+    }
+    pthread_mutex_lock(&self->lock);
+    prom_lite_series_t* series = series_lookup(self, label_values);
+    if (series != NULL)
+    {
+        series->value = r_value;
+    }
+    pthread_mutex_unlock(&self->lock);
+    return series == NULL;
+}
+
+int prom_counter_add(prom_counter_t* self, double r_value, const char** label_values)
+{
+    if (self == NULL || r_value < 0 || (self->label_count > 0 && label_values == NULL))
+    {
+        return 1;
+    }
+    pthread_mutex_lock(&self->lock);
+    prom_lite_series_t* series = series_lookup(self, label_values);
+    if (series != NULL)
+    {
+        series->value += r_value;
+    }
+    pthread_mutex_unlock(&self->lock);
+    return series == NULL;
+}
+
+int prom_histogram_observe(prom_histogram_t* self, double value, const char** label_values)
+{
+    if (self == NULL || (self->label_count > 0 && label_values == NULL))
+    {
+        return 1;
+    }
+    pthread_mutex_lock(&self->lock);
+    prom_lite_series_t* series = series_lookup(self, label_values);
+    if (series != NULL)
+    {
+        int bucket = 0;
+        while (bucket < self->buckets->count && value > self->buckets->upper_bounds[bucket])
+        {
+            bucket++;
+        }
+        series->buckets[bucket]++;
+        series->count++;
+        series->value += value;
+    }
+    pthread_mutex_unlock(&self->lock);
+    return series == NULL;
+}
+
+/**
+ * @brief Crea cubetas con límites calculados por una progresión.
+ */
+static prom_histogram_buckets_t* buckets_new(double start, double step, size_t count, int geometric)
+{
+    prom_histogram_buckets_t* buckets = calloc(1, sizeof(*buckets));
+    double* bounds = count > 0 ? calloc(count, sizeof(*bounds)) : NULL;
+    if (buckets == NULL || (count > 0 && bounds == NULL))
+    {
+        free(buckets);
+        free(bounds);
+        return NULL;
+    }
+    double bound = start;
+    for (size_t i = 0; i < count; i++)
+    {
+        bounds[i] = bound;
+        bound = geometric ? bound * step : bound + step;
+    }
+    buckets->count = (int)count;
+    buckets->upper_bounds = bounds;
+    return buckets;
+}
+
+prom_histogram_buckets_t* prom_histogram_buckets_linear(double start, double width, size_t count)
+{
+    return buckets_new(start, width, count, 0);
+}
+
+prom_histogram_buckets_t* prom_histogram_buckets_exponential(double start, double factor, size_t count)
+{
+    return buckets_new(start, factor, count, 1);
+}
+
+/**
+ * @brief Escribe una línea de muestra: nombre, sufijo, etiquetas más una extra opcional, y valor.
+ */
+static void write_sample(prom_lite_text_t* text, const prom_metric_t* metric, const char* suffix, const char* labels,
+                         const char* extra, double value)
+{
+    char number[PROM_LITE_NUMBER_SIZE];
+    format_number(number, value);
+    int has_labels = labels[0] != '\0';
+    if (!has_labels && extra == NULL)
+    {
+        text_printf(text, "%s%s %s\n", metric->name, suffix, number);
+        return;
+    }
+    text_printf(text, "%s%s{%s%s%s} %s\n", metric->name, suffix, labels, has_labels && extra != NULL ? "," : "",
+                extra != NULL ? extra : "", number);
+}
+
+/**
+ * @brief Escribe una métrica con sus series; se llama con el lock de la métrica tomado.
+ */
+static void write_metric(prom_lite_text_t* text, const prom_metric_t* metric)
+{
+    static const char* const types[] = {"gauge", "counter", "histogram"};
+
+    text_printf(text, "# HELP %s ", metric->name);
+    text_escaped(text, metric->help != NULL ? metric->help : "", 0);
+    text_printf(text, "\n# TYPE %s %s\n", metric->name, types[metric->kind]);
+
+    for (size_t s = 0; s < metric->count; s++)
+    {
+        const prom_lite_series_t* series = metric->series[s];
+        if (metric->kind != PROM_LITE_HISTOGRAM)
+        {
+            write_sample(text, metric, "", series->labels, NULL, series->value);
+            continue;
+        }
+
+        // Las cubetas del formato son acumuladas; se guardan sueltas para que observar sea un solo incremento
+        unsigned long long cumulative = 0;
+        char le[PROM_LITE_NUMBER_SIZE + 8];
+        char number[PROM_LITE_NUMBER_SIZE];
+        for (int b = 0; b <= metric->buckets->count; b++)
+        {
+            cumulative += series->buckets[b];
+            format_number(number, b < metric->buckets->count ? metric->buckets->upper_bounds[b] : INFINITY);
+            snprintf(le, sizeof(le), "le=\"%s\"", number);
+            write_sample(text, metric, "_bucket", series->labels, le, (double)cumulative);
+        }
+        write_sample(text, metric, "_sum", series->labels, NULL, series->value);
+        write_sample(text, metric, "_count", series->labels, NULL, (double)series->count);
+    }
+}
+
+/**
+ * @brief Escribe todas las métricas del registro en un texto.
+ *
+ * @return 0 en caso de éxito, 1 si no hay memoria.
+ */
+static int registry_write(prom_collector_registry_t* self, prom_lite_text_t* text)
+{
+    text_reserve(text, 0);
+    pthread_mutex_lock(&self->lock);
+    for (prom_metric_t* metric = self->head; metric != NULL; metric = metric->next)
+    {
+        pthread_mutex_lock(&metric->lock);
+        write_metric(text, metric);
+        pthread_mutex_unlock(&metric->lock);
+    }
+    pthread_mutex_unlock(&self->lock);
+    return text->failed;
+}
+
+const char* prom_collector_registry_bridge(prom_collector_registry_t* self)
+{
+    if (self == NULL)
+    {
+        return NULL;
+    }
+
+    prom_lite_text_t text = {0};
+    if (registry_write(self, &text) != 0)
+    {
+        free(text.data);
+        return NULL;
+    }
+    return text.data;
+}
+
+const char* prom_collector_registry_render(prom_collector_registry_t* self, arena_t* arena)
+{
+    if (self == NULL)
+    {
+        return NULL;
+    }
+
+    prom_lite_text_t text = {0};
+    text.arena = arena;
+    return registry_write(self, &text) == 0 ? text.data : NULL;
+}
@@ -0,0 +1,490 @@
+/**
+ * @file push.c
+ * @brief Cola acotada de muestras y el hilo que las envía por remote_write, StatsD o line protocol.
+ *
+ * El lock de la cola solo se toma para copiar muestras: el hilo de envío saca un lote entero, lo suelta y recién
+ * entonces codifica y envía, de modo que un receptor lento nunca demora a las tareas de recolección. Mientras un lote
+ * se reintenta la cola sigue llenándose y, al llenarse, pierde sus muestras más viejas.
+ */
+
+#include "push.h"
+#include "http_client.h"
+#include "line_protocol.h"
+#include "metric_registry.h"
+#include "metrics.h"
+#include "remote_write.h"
+#include <errno.h>
+#include <netdb.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <sys/socket.h>
+#include <time.h>
+
+/**
+ * @brief Puertos por defecto de los protocolos UDP.
+ */
+#define PUSH_STATSD_PORT "8125"
+#define PUSH_INFLUX_PORT "8089"
+
+/**
+ * @brief Tamaño de una línea de StatsD o line protocol.
+ */
+#define PUSH_LINE_SIZE 1024
+
+/**
+ * @brief Resultado de un intento de envío.
+ */
+typedef enum
+{
+    SEND_OK,        ///< El receptor aceptó el lote.
+    SEND_RETRY,     ///< Falla transitoria (red, 5xx o 429): se reintenta.
+    SEND_PERMANENT  ///< El receptor rechazó el lote (otro 4xx): se descarta.
+} send_result_t;
+
+/**
+ * @brief Protocolo en uso.
+ */
+static push_mode_t push_mode = PUSH_NONE;
+
+/**
+ * @brief Destino: host, puerto y, para remote_write, ruta.
+ */
+static http_target_t push_target;
+
+/**
+ * @brief Protege la cola; nunca se toma durante la codificación ni el envío.
+ */
+static pthread_mutex_t queue_lock = PTHREAD_MUTEX_INITIALIZER;
+
+/**
+ * @brief Despierta al hilo de envío cuando la cola junta un lote o al detenerse.
+ */
+static pthread_cond_t queue_cond;
+
+/**
+ * @brief Cola circular de muestras.
+ */
+static push_sample_t* queue = NULL;
+static size_t queue_size = INICIAL_VALUE;
+static size_t queue_head = INICIAL_VALUE;
+static size_t queue_count = INICIAL_VALUE;
+
+/**
+ * @brief Lote que se está enviando o reintentando, propiedad del hilo de envío.
+ */
+static push_sample_t* pending = NULL;
+static size_t pending_count = INICIAL_VALUE;
+
+/**
+ * @brief Muestras por envío e intervalo entre envíos.
+ */
+static size_t max_batch = PUSH_DEFAULT_MAX_BATCH;
+static int interval_ms = PUSH_DEFAULT_INTERVAL_MS;
+
+/**
+ * @brief 1 mientras el hilo de envío corre; las tareas lo leen sin tomar el lock.
+ */
+static atomic_int push_running = INICIAL_VALUE;
+
+/**
+ * @brief 1 cuando push_stop() pidió que el hilo termine.
+ */
+static int push_stopping = INICIAL_VALUE;
+
+/**
+ * @brief Hilo de envío.
+ */
+static pthread_t push_thread;
+
+/**
+ * @brief Muestras enviadas, descartadas por cola llena y descartadas tras agotar los intentos o por rechazo.
+ */
+static atomic_ullong samples_sent = INICIAL_VALUE;
+static atomic_ullong samples_dropped = INICIAL_VALUE;
+static atomic_ullong samples_failed = INICIAL_VALUE;
+
+/**
+ * @brief Socket UDP conectado al destino de StatsD o line protocol, o -1.
+ */
+static int udp_fd = ERROR_INT;
+
+int push_buffer_reserve(push_buffer_t* buf, size_t extra)
+{
+    if (buf->len + extra <= buf->cap)
+    {
+        return INICIAL_VALUE;
+    }
+    size_t cap = buf->cap ? buf->cap : BUFFER_SIZE;
+    while (cap < buf->len + extra)
+    {
+        cap *= 2;
+    }
+    uint8_t* data = realloc(buf->data, cap);
+    if (data == NULL)
+    {
+        perror("Error al asignar memoria");
+        return ERROR_INT;
+    }
+    buf->data = data;
+    buf->cap = cap;
+    return INICIAL_VALUE;
+}
+
+/**
+ * @brief Suma milisegundos a un instante de CLOCK_MONOTONIC, para pthread_cond_timedwait().
+ */
+static struct timespec deadline_after(int ms)
+{
+    unsigned long long ns = monotonic_ns() + (unsigned long long)ms * 1000000ULL;
+    struct timespec ts;
+    ts.tv_sec = (time_t)(ns / 1000000000ULL);
+    ts.tv_nsec = (long)(ns % 1000000000ULL);
+    return ts;
+}
+
+void push_enqueue_batch(const metric_batch_t* batch)
+{
+    if (batch == NULL || !atomic_load_explicit(&push_running, memory_order_acquire))
+    {
+        return;
+    }
+
+    int64_t now = realtime_ms();
+    size_t dropped = INICIAL_VALUE;
+    pthread_mutex_lock(&queue_lock);
+    for (size_t i = 0; i < batch->count; i++)
+    {
+        const metric_sample_t* sample = &batch->samples[i];
+        if (queue_count == queue_size)
+        {
+            // Cola llena: se pierde la muestra más vieja, nunca se espera al hilo de envío
+            queue_head = (queue_head + 1) % queue_size;
+            queue_count--;
+            dropped++;
+        }
+        push_sample_t* slot = &queue[(queue_head + queue_count) % queue_size];
+        slot->metric = sample->metric;
+        slot->timestamp_ms = now;
+        slot->value = sample->value;
+        slot->label_count = sample->label_count;
+        memcpy(slot->labels, sample->labels, sizeof(slot->labels));
+        queue_count++;
+    }
+    if (queue_count >= max_batch)
+    {
+        pthread_cond_signal(&queue_cond);
+    }
+    pthread_mutex_unlock(&queue_lock);
+
+    if (dropped > 0)
+    {
+        atomic_fetch_add(&samples_dropped, dropped);
+    }
+}
+
+/**
+ * @brief Encabezados propios de remote_write 1.0.
+ */
+static const char remote_write_headers[] = "Content-Type: application/x-protobuf\r\n"
+                                           "Content-Encoding: snappy\r\n"
+                                           "X-Prometheus-Remote-Write-Version: 0.1.0\r\n";
+
+/**
+ * @brief Codifica el lote pendiente como WriteRequest comprimido y lo envía.
+ */
+static send_result_t send_remote_write(push_buffer_t* proto, push_buffer_t* body)
+{
+    proto->len = INICIAL_VALUE;
+    body->len = INICIAL_VALUE;
+    if (remote_write_encode(pending, pending_count, proto) != 0 || snappy_compress(proto->data, proto->len, body) != 0)
+    {
+        return SEND_RETRY;
+    }
+
+    int status;
+    http_post_result_t result = http_post(&push_target, remote_write_headers, body->data, body->len, PUSH_TIMEOUT_MS,
+                                          &status);
+    if (result == HTTP_POST_REJECTED)
+    {
+        fprintf(stderr, "El receptor de remote_write rechazó el lote (HTTP %d)\n", status);
+        return SEND_PERMANENT;
+    }
+    return result == HTTP_POST_OK ? SEND_OK : SEND_RETRY;
+}
+
+/**
+ * @brief Abre el socket UDP conectado al destino.
+ *
+ * @return 0 en caso de éxito, -1 en caso de error.
+ */
+static int udp_connect()
+{
+    struct addrinfo hints = {0};
+    struct addrinfo* res;
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_DGRAM;
+    if (getaddrinfo(push_target.host, push_target.port, &hints, &res) != 0)
+    {
+        return ERROR_INT;
+    }
+    for (struct addrinfo* ai = res; ai != NULL && udp_fd < 0; ai = ai->ai_next)
+    {
+        udp_fd = socket(ai->ai_family, ai->ai_socktype | SOCK_CLOEXEC, ai->ai_protocol);
+        if (udp_fd >= 0 && connect(udp_fd, ai->ai_addr, ai->ai_addrlen) != 0)
+        {
+            close(udp_fd);
+            udp_fd = ERROR_INT;
+        }
+    }
+    freeaddrinfo(res);
+    return udp_fd >= 0 ? INICIAL_VALUE : ERROR_INT;
+}
+
+/**
+ * @brief Envía el lote pendiente en datagramas de hasta PUSH_DATAGRAM_SIZE bytes, sin cortar líneas.
+ *
+ * Un error de envío (por ejemplo ECONNREFUSED de un envío anterior) cierra el socket; el reintento lo vuelve a abrir
+ * y reenvía el lote entero.
+ */
+static send_result_t send_datagrams()
+{
+    if (udp_fd < 0 && udp_connect() != 0)
+    {
+        return SEND_RETRY;
+    }
+
+    char datagram[PUSH_DATAGRAM_SIZE];
+    size_t used = INICIAL_VALUE;
+    for (size_t i = 0; i <= pending_count; i++)
+    {
+        char line[PUSH_LINE_SIZE];
+        int len = i < pending_count ? line_protocol_format(push_mode, metric_registry_metric_info(pending[i].metric),
+                                                           &pending[i], line, sizeof(line))
+                                    : INICIAL_VALUE;
+        if (used > 0 && (i == pending_count || used + (size_t)len > sizeof(datagram)))
+        {
+            if (send(udp_fd, datagram, used, MSG_NOSIGNAL) < 0)
+            {
+                close(udp_fd);
+                udp_fd = ERROR_INT;
+                return SEND_RETRY;
+            }
+            used = INICIAL_VALUE;
+        }
+        if (len > 0 && (size_t)len <= sizeof(datagram))
+        {
+            memcpy(datagram + used, line, (size_t)len);
+            used += (size_t)len;
+        }
+    }
+    return SEND_OK;
+}
+
+/**
+ * @brief Espera antes del reintento número attempt: al azar entre 0 y la espera exponencial ("full jitter").
+ */
+static int retry_delay_ms(int attempt, unsigned int* seed)
+{
+    long long backoff = (long long)PUSH_RETRY_BASE_MS << (attempt < 16 ? attempt : 16);
+    if (backoff > PUSH_RETRY_MAX_MS)
+    {
+        backoff = PUSH_RETRY_MAX_MS;
+    }
+    return (int)(rand_r(seed) % (backoff + 1));
+}
+
+/**
+ * @brief Bucle del hilo de envío: junta un lote, lo envía sin el lock y reintenta con espera si falla.
+ */
+static void* push_main(void* arg)
+{
+    (void)arg;
+    unsigned int seed = (unsigned int)monotonic_ns() ^ (unsigned int)getpid();
+    push_buffer_t proto = {0};
+    push_buffer_t body = {0};
+    int attempts = INICIAL_VALUE;
+
+    pthread_mutex_lock(&queue_lock);
+    while (!push_stopping)
+    {
+        if (pending_count == 0)
+        {
+            // Se envía al cumplirse el intervalo o antes si la cola ya juntó un lote completo
+            struct timespec deadline = deadline_after(interval_ms);
+            while (!push_stopping && queue_count < max_batch)
+            {
+                if (pthread_cond_timedwait(&queue_cond, &queue_lock, &deadline) == ETIMEDOUT)
+                {
+                    break;
+                }
+            }
+            while (pending_count < max_batch && queue_count > 0)
+            {
+                pending[pending_count++] = queue[queue_head];
+                queue_head = (queue_head + 1) % queue_size;
+                queue_count--;
+            }
+            if (push_stopping || pending_count == 0)
+            {
+                continue;
+            }
+        }
+        pthread_mutex_unlock(&queue_lock);
+
+        send_result_t result = push_mode == PUSH_REMOTE_WRITE ? send_remote_write(&proto, &body) : send_datagrams();
+
+        pthread_mutex_lock(&queue_lock);
+        if (result == SEND_OK)
+        {
+            atomic_fetch_add(&samples_sent, pending_count);
+        }
+        else if (result == SEND_RETRY && ++attempts < PUSH_MAX_ATTEMPTS)
+        {
+            // Las señales de la cola no cortan la espera: solo push_stop() o el plazo
+            struct timespec deadline = deadline_after(retry_delay_ms(attempts, &seed));
+            while (!push_stopping)
+            {
+                if (pthread_cond_timedwait(&queue_cond, &queue_lock, &deadline) == ETIMEDOUT)
+                {
+                    break;
+                }
+            }
+            continue;
+        }
+        else
+        {
+            atomic_fetch_add(&samples_failed, pending_count);
+        }
+        pending_count = INICIAL_VALUE;
+        attempts = INICIAL_VALUE;
+    }
+    pthread_mutex_unlock(&queue_lock);
+
+    free(proto.data);
+    free(body.data);
+    return NULL;
+}
+
+/**
+ * @brief Separa el destino en host, puerto y ruta.
+ *
+ * @return 0 en caso de éxito, -1 si el destino no es válido para el modo.
+ */
+static int parse_target(const char* target)
+{
+    const char* default_port = push_mode == PUSH_STATSD ? PUSH_STATSD_PORT : PUSH_INFLUX_PORT;
+    if (push_mode == PUSH_REMOTE_WRITE)
+    {
+        // TLS no está soportado: remote_write se envía a un agente o proxy local en texto plano
+        if (strncmp(target, "http://", 7) != 0)
+        {
+            return ERROR_INT;
+        }
+        target += 7;
+        default_port = HTTP_DEFAULT_PORT;
+    }
+    else if (strncmp(target, "udp://", 6) == 0)
+    {
+        target += 6;
+    }
+
+    return http_target_parse(target, default_port, &push_target);
+}
+
+int push_start(const char* mode, const char* target, int interval, int queue_capacity, int batch)
+{
+    if (atomic_load(&push_running) || mode == NULL || target == NULL)
+    {
+        return ERROR_INT;
+    }
+    push_mode = strcmp(mode, "remote_write") == 0 ? PUSH_REMOTE_WRITE
+                : strcmp(mode, "statsd") == 0     ? PUSH_STATSD
+                : strcmp(mode, "influx") == 0     ? PUSH_INFLUX
+                                                  : PUSH_NONE;
+    if (push_mode == PUSH_NONE || parse_target(target) != 0)
+    {
+        fprintf(stderr, "Modo o destino de envío no válido: %s %s\n", mode, target);
+        push_mode = PUSH_NONE;
+        return ERROR_INT;
+    }
+
+    interval_ms = interval > 0 ? interval : PUSH_DEFAULT_INTERVAL_MS;
+    queue_size = queue_capacity > 0 ? (size_t)queue_capacity : PUSH_DEFAULT_QUEUE_SIZE;
+    max_batch = batch > 0 ? (size_t)batch : PUSH_DEFAULT_MAX_BATCH;
+    if (max_batch > queue_size)
+    {
+        max_batch = queue_size;
+    }
+    queue = calloc(queue_size, sizeof(*queue));
+    pending = calloc(max_batch, sizeof(*pending));
+    if (queue == NULL || pending == NULL)
+    {
+        perror("Error al asignar memoria");
+        free(queue);
+        free(pending);
+        queue = pending = NULL;
+        return ERROR_INT;
+    }
+    queue_head = queue_count = pending_count = INICIAL_VALUE;
+    push_stopping = INICIAL_VALUE;
+
+    // Las esperas con plazo usan CLOCK_MONOTONIC, como las de collector.c
+    pthread_condattr_t attr;
+    pthread_condattr_init(&attr);
+    pthread_condattr_setclock(&attr, CLOCK_MONOTONIC);
+    int ret = pthread_cond_init(&queue_cond, &attr);
+    pthread_condattr_destroy(&attr);
+    if (ret != 0 || pthread_create(&push_thread, NULL, push_main, NULL) != 0)
+    {
+        fprintf(stderr, "Error al crear el hilo de envío\n");
+        if (ret == 0)
+        {
+            pthread_cond_destroy(&queue_cond);
+        }
+        free(queue);
+        free(pending);
+        queue = pending = NULL;
+        return ERROR_INT;
+    }
+    atomic_store_explicit(&push_running, ASSIGNED_VALUE, memory_order_release);
+    return INICIAL_VALUE;
+}
+
+void push_stop()
+{
+    if (!atomic_load(&push_running))
+    {
+        return;
+    }
+    atomic_store(&push_running, INICIAL_VALUE);
+
+    pthread_mutex_lock(&queue_lock);
+    push_stopping = ASSIGNED_VALUE;
+    pthread_cond_signal(&queue_cond);
+    pthread_mutex_unlock(&queue_lock);
+    pthread_join(push_thread, NULL);
+
+    pthread_cond_destroy(&queue_cond);
+    if (udp_fd >= 0)
+    {
+        close(udp_fd);
+        udp_fd = ERROR_INT;
+    }
+    free(queue);
+    free(pending);
+    queue = pending = NULL;
+    push_mode = PUSH_NONE;
+}
+
+void push_counters(unsigned long long counts[PUSH_RESULT_COUNT])
+{
+    counts[PUSH_RESULT_SENT] = atomic_load(&samples_sent);
+    counts[PUSH_RESULT_DROPPED] = atomic_load(&samples_dropped);
+    counts[PUSH_RESULT_FAILED] = atomic_load(&samples_failed);
+}
+
+const char* push_result_name(push_result_t result)
+{
+    static const char* const names[PUSH_RESULT_COUNT] = {"sent", "dropped", "failed"};
+    return names[result];
+}
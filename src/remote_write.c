@@ -0,0 +1,257 @@
+/**
+ * @file remote_write.c
+ * @brief WriteRequest de remote_write en protobuf y compresor snappy escritos a mano.
+ *
+ * Mensajes de prompb usados (remote.proto y types.proto):
+ *   WriteRequest { repeated TimeSeries timeseries = 1; }
+ *   TimeSeries { repeated Label labels = 1; repeated Sample samples = 2; }
+ *   Label { string name = 1; string value = 2; }
+ *   Sample { double value = 1; int64 timestamp = 2; }
+ */
+
+#include "remote_write.h"
+#include "metric_registry.h"
+#include "metrics.h"
+
+/**
+ * @brief Tipos de cable de protobuf usados.
+ */
+#define PB_VARINT 0
+#define PB_FIXED64 1
+#define PB_LEN 2
+
+/**
+ * @brief Arma la clave de un campo de protobuf.
+ */
+#define PB_KEY(field, type) ((uint8_t)(((field) << 3) | (type)))
+
+/**
+ * @brief Elementos de un tag de snappy (los dos bits bajos).
+ */
+#define SNAPPY_LITERAL 0
+#define SNAPPY_COPY_2 2
+
+/**
+ * @brief Longitud máxima de una copia con offset de 2 bytes.
+ */
+#define SNAPPY_MAX_COPY 64
+
+/**
+ * @brief Etiqueta (nombre y valor) de una serie.
+ */
+typedef struct
+{
+    const char* name;  ///< Nombre de la etiqueta.
+    const char* value; ///< Valor de la etiqueta.
+} series_label_t;
+
+/**
+ * @brief Bytes que ocupa un entero como varint.
+ */
+static size_t varint_size(uint64_t value)
+{
+    size_t size = ASSIGNED_VALUE;
+    while (value >= 0x80)
+    {
+        value >>= 7;
+        size++;
+    }
+    return size;
+}
+
+/**
+ * @brief Escribe un varint; el llamador ya reservó el lugar.
+ */
+static void put_varint(push_buffer_t* out, uint64_t value)
+{
+    while (value >= 0x80)
+    {
+        out->data[out->len++] = (uint8_t)(value | 0x80);
+        value >>= 7;
+    }
+    out->data[out->len++] = (uint8_t)value;
+}
+
+/**
+ * @brief Escribe un campo de tipo string; el llamador ya reservó el lugar.
+ */
+static void put_string(push_buffer_t* out, int field, const char* value, size_t len)
+{
+    out->data[out->len++] = PB_KEY(field, PB_LEN);
+    put_varint(out, len);
+    memcpy(out->data + out->len, value, len);
+    out->len += len;
+}
+
+/**
+ * @brief Bytes de un mensaje Label.
+ */
+static size_t label_size(const series_label_t* label)
+{
+    size_t name = strlen(label->name);
+    size_t value = strlen(label->value);
+    return 1 + varint_size(name) + name + 1 + varint_size(value) + value;
+}
+
+int remote_write_encode(const push_sample_t* samples, size_t count, push_buffer_t* out)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        const push_sample_t* sample = &samples[i];
+        const metric_info_t* info = metric_registry_metric_info(sample->metric);
+        if (info == NULL)
+        {
+            continue;
+        }
+
+        // __name__ más las etiquetas de la métrica, ordenadas por nombre
+        series_label_t labels[METRIC_MAX_LABELS + 1] = {{"__name__", info->name}};
+        int label_count = ASSIGNED_VALUE;
+        for (int l = 0; l < sample->label_count && l < info->label_count; l++)
+        {
+            series_label_t label = {info->labels[l], sample->labels[l]};
+            int pos = label_count++;
+            while (pos > 0 && strcmp(labels[pos - 1].name, label.name) > 0)
+            {
+                labels[pos] = labels[pos - 1];
+                pos--;
+            }
+            labels[pos] = label;
+        }
+
+        uint64_t timestamp = (uint64_t)sample->timestamp_ms;
+        size_t sample_size = 1 + sizeof(double) + 1 + varint_size(timestamp);
+        size_t series_size = 1 + varint_size(sample_size) + sample_size;
+        for (int l = 0; l < label_count; l++)
+        {
+            size_t size = label_size(&labels[l]);
+            series_size += 1 + varint_size(size) + size;
+        }
+        if (push_buffer_reserve(out, 1 + varint_size(series_size) + series_size) != 0)
+        {
+            return ERROR_INT;
+        }
+
+        out->data[out->len++] = PB_KEY(1, PB_LEN);
+        put_varint(out, series_size);
+        for (int l = 0; l < label_count; l++)
+        {
+            out->data[out->len++] = PB_KEY(1, PB_LEN);
+            put_varint(out, label_size(&labels[l]));
+            put_string(out, 1, labels[l].name, strlen(labels[l].name));
+            put_string(out, 2, labels[l].value, strlen(labels[l].value));
+        }
+        out->data[out->len++] = PB_KEY(2, PB_LEN);
+        put_varint(out, sample_size);
+
+        // double en little endian de 64 bits, como fixed64
+        uint64_t bits;
+        memcpy(&bits, &sample->value, sizeof(bits));
+        out->data[out->len++] = PB_KEY(1, PB_FIXED64);
+        for (int b = 0; b < 8; b++)
+        {
+            out->data[out->len++] = (uint8_t)(bits >> (8 * b));
+        }
+        out->data[out->len++] = PB_KEY(2, PB_VARINT);
+        put_varint(out, timestamp);
+    }
+    return INICIAL_VALUE;
+}
+
+/**
+ * @brief Lee 4 bytes sin alinear.
+ */
+static uint32_t load32(const uint8_t* p)
+{
+    uint32_t value;
+    memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+/**
+ * @brief Escribe un literal de snappy: tag con la longitud (o 1 a 4 bytes de longitud) y los bytes.
+ */
+static void emit_literal(push_buffer_t* out, const uint8_t* data, size_t len)
+{
+    if (len == 0)
+    {
+        return;
+    }
+    size_t n = len - 1;
+    if (n < 60)
+    {
+        out->data[out->len++] = (uint8_t)(n << 2 | SNAPPY_LITERAL);
+    }
+    else
+    {
+        int bytes = n < (1u << 8) ? 1 : n < (1u << 16) ? 2 : n < (1u << 24) ? 3 : 4;
+        out->data[out->len++] = (uint8_t)((59 + bytes) << 2 | SNAPPY_LITERAL);
+        for (int b = 0; b < bytes; b++)
+        {
+            out->data[out->len++] = (uint8_t)(n >> (8 * b));
+        }
+    }
+    memcpy(out->data + out->len, data, len);
+    out->len += len;
+}
+
+/**
+ * @brief Escribe una copia de snappy con offset de 2 bytes, partida en tramos de hasta SNAPPY_MAX_COPY bytes.
+ */
+static void emit_copy(push_buffer_t* out, size_t offset, size_t len)
+{
+    while (len > 0)
+    {
+        // Como en la implementación de referencia, el último tramo queda con al menos 4 bytes
+        size_t chunk = len > SNAPPY_MAX_COPY + 4 ? SNAPPY_MAX_COPY : len > SNAPPY_MAX_COPY ? len - 4 : len;
+        out->data[out->len++] = (uint8_t)((chunk - 1) << 2 | SNAPPY_COPY_2);
+        out->data[out->len++] = (uint8_t)offset;
+        out->data[out->len++] = (uint8_t)(offset >> 8);
+        len -= chunk;
+    }
+}
+
+int snappy_compress(const uint8_t* in, size_t len, push_buffer_t* out)
+{
+    // Peor caso del formato: el largo en varint y todo en literales, con un tag cada 60 bytes o menos
+    if (push_buffer_reserve(out, 10 + len + len / 6 + 32) != 0)
+    {
+        return ERROR_INT;
+    }
+    put_varint(out, len);
+
+    uint16_t table[1 << SNAPPY_HASH_BITS];
+    for (size_t base = 0; base < len; base += SNAPPY_FRAGMENT_SIZE)
+    {
+        const uint8_t* frag = in + base;
+        size_t frag_len = len - base < SNAPPY_FRAGMENT_SIZE ? len - base : SNAPPY_FRAGMENT_SIZE;
+        memset(table, 0, sizeof(table));
+
+        size_t literal = 0;
+        size_t i = 0;
+        while (i + 4 <= frag_len)
+        {
+            uint32_t word = load32(frag + i);
+            uint32_t hash = (word * 0x1e35a7bdU) >> (32 - SNAPPY_HASH_BITS);
+            size_t candidate = table[hash];
+            table[hash] = (uint16_t)i;
+            if (candidate >= i || load32(frag + candidate) != word)
+            {
+                i++;
+                continue;
+            }
+
+            size_t match = 4;
+            while (i + match < frag_len && frag[candidate + match] == frag[i + match])
+            {
+                match++;
+            }
+            emit_literal(out, frag + literal, i - literal);
+            emit_copy(out, i - candidate, match);
+            i += match;
+            literal = i;
+        }
+        emit_literal(out, frag + literal, frag_len - literal);
+    }
+    return INICIAL_VALUE;
+}
@@ -0,0 +1,265 @@
+/**
+ * @file scan.c
+ * @brief Implementación del tokenizador sin reservas de memoria usado por los parsers de /proc.
+ */
+
+#include "scan.h"
+#include <string.h>
+
+/**
+ * @brief Indica si un carácter separa campos dentro de una línea.
+ *
+ * @param c Carácter a evaluar.
+ * @return 1 si es espacio o tabulador, 0 si no.
+ */
+static int scan_is_ws(char c)
+{
+    return c == ' ' || c == '\t';
+}
+
+/**
+ * @brief Inicializa un cursor sobre un buffer.
+ *
+ * @param s Cursor a inicializar.
+ * @param buf Inicio del buffer.
+ * @param len Cantidad de bytes del buffer.
+ */
+void scan_init(scan_t* s, const char* buf, size_t len)
+{
+    s->pos = buf;
+    s->end = buf + len;
+}
+
+/**
+ * @brief Extrae la próxima línea del cursor, sin el '\n' final.
+ *
+ * @param s Cursor sobre el buffer completo.
+ * @param line Cursor que recibe la línea extraída.
+ * @return 1 si se extrajo una línea, 0 si no quedan más.
+ */
+int scan_next_line(scan_t* s, scan_t* line)
+{
+    if (s->pos >= s->end)
+    {
+        return 0;
+    }
+
+    const char* nl = memchr(s->pos, '\n', (size_t)(s->end - s->pos));
+    line->pos = s->pos;
+    line->end = nl != NULL ? nl : s->end;
+    s->pos = nl != NULL ? nl + 1 : s->end;
+    return 1;
+}
+
+/**
+ * @brief Avanza hasta la próxima línea que empieza con una clave y extrae esa línea.
+ *
+ * @param s Cursor sobre el buffer completo.
+ * @param key Clave buscada.
+ * @param line Cursor que recibe el resto de la línea encontrada.
+ * @return 1 si se encontró la clave, 0 si no.
+ */
+int scan_skip_to_key(scan_t* s, const char* key, scan_t* line)
+{
+    size_t key_len = strlen(key);
+
+    while (scan_next_line(s, line))
+    {
+        if ((size_t)(line->end - line->pos) <= key_len || line->pos[0] != key[0] ||
+            memcmp(line->pos, key, key_len) != 0)
+        {
+            continue;
+        }
+
+        char next = line->pos[key_len];
+        if (next == ':' || scan_is_ws(next))
+        {
+            line->pos += key_len + (next == ':' ? 1 : 0);
+            return 1;
+        }
+    }
+
+    return 0;
+}
+
+/**
+ * @brief Indica si el cursor empieza con un prefijo dado.
+ *
+ * @param s Cursor a inspeccionar.
+ * @param prefix Prefijo buscado.
+ * @return 1 si el cursor empieza con prefix, 0 si no.
+ */
+int scan_starts_with(const scan_t* s, const char* prefix)
+{
+    size_t len = strlen(prefix);
+    return (size_t)(s->end - s->pos) >= len && memcmp(s->pos, prefix, len) == 0;
+}
+
+/**
+ * @brief Salta espacios y tabuladores.
+ *
+ * @param s Cursor a avanzar.
+ */
+void scan_skip_ws(scan_t* s)
+{
+    while (s->pos < s->end && scan_is_ws(*s->pos))
+    {
+        s->pos++;
+    }
+}
+
+/**
+ * @brief Salta espacios y lee un entero sin signo en base 10.
+ *
+ * @param s Cursor a avanzar.
+ * @param out Valor leído.
+ * @return 1 si se leyó al menos un dígito, 0 si no.
+ */
+int scan_u64(scan_t* s, unsigned long long* out)
+{
+    unsigned long long value = 0;
+    const char* start;
+
+    scan_skip_ws(s);
+    start = s->pos;
+    while (s->pos < s->end && (unsigned char)(*s->pos - '0') <= 9)
+    {
+        value = value * 10 + (unsigned long long)(*s->pos - '0');
+        s->pos++;
+    }
+
+    if (s->pos == start)
+    {
+        return 0;
+    }
+
+    *out = value;
+    return 1;
+}
+
+/**
+ * @brief Salta espacios y lee un decimal sin signo con parte fraccionaria opcional.
+ *
+ * Los valores de /proc (avg10 de /proc/pressure, por ejemplo) tienen pocos decimales, así que se acumulan como
+ * enteros y se divide una sola vez, sin depender de strtod() ni de la configuración regional.
+ *
+ * @param s Cursor a avanzar.
+ * @param out Valor leído.
+ * @return 1 si se leyó al menos un dígito, 0 si no.
+ */
+int scan_double(scan_t* s, double* out)
+{
+    unsigned long long whole, fraction = 0;
+    double scale = 1.0;
+
+    if (!scan_u64(s, &whole))
+    {
+        return 0;
+    }
+    if (s->pos < s->end && *s->pos == '.')
+    {
+        s->pos++;
+        while (s->pos < s->end && (unsigned char)(*s->pos - '0') <= 9)
+        {
+            fraction = fraction * 10 + (unsigned long long)(*s->pos - '0');
+            scale *= 10.0;
+            s->pos++;
+        }
+    }
+
+    *out = (double)whole + (double)fraction / scale;
+    return 1;
+}
+
+/**
+ * @brief Salta una cantidad de campos separados por espacios.
+ *
+ * @param s Cursor a avanzar.
+ * @param count Cantidad de campos a saltar.
+ * @return 1 si se saltaron todos los campos, 0 si la línea terminó antes.
+ */
+int scan_skip_fields(scan_t* s, int count)
+{
+    for (int i = 0; i < count; i++)
+    {
+        scan_skip_ws(s);
+        if (s->pos >= s->end)
+        {
+            return 0;
+        }
+        while (s->pos < s->end && !scan_is_ws(*s->pos))
+        {
+            s->pos++;
+        }
+    }
+
+    return 1;
+}
+
+/**
+ * @brief Salta espacios y extrae el próximo campo separado por espacios.
+ *
+ * @param s Cursor a avanzar.
+ * @param tok Inicio del campo dentro del buffer.
+ * @param len Longitud del campo.
+ * @return 1 si se extrajo un campo, 0 si la línea terminó.
+ */
+int scan_token(scan_t* s, const char** tok, size_t* len)
+{
+    scan_skip_ws(s);
+    if (s->pos >= s->end)
+    {
+        return 0;
+    }
+
+    *tok = s->pos;
+    while (s->pos < s->end && !scan_is_ws(*s->pos))
+    {
+        s->pos++;
+    }
+    *len = (size_t)(s->pos - *tok);
+    return 1;
+}
+
+/**
+ * @brief Salta espacios y extrae el texto hasta un delimitador, consumiendo el delimitador.
+ *
+ * @param s Cursor a avanzar.
+ * @param delim Delimitador buscado.
+ * @param tok Inicio del texto dentro del buffer.
+ * @param len Longitud del texto sin el delimitador.
+ * @return 1 si se encontró el delimitador, 0 si no.
+ */
+int scan_until(scan_t* s, char delim, const char** tok, size_t* len)
+{
+    scan_skip_ws(s);
+
+    const char* found = memchr(s->pos, delim, (size_t)(s->end - s->pos));
+    if (found == NULL)
+    {
+        return 0;
+    }
+
+    *tok = s->pos;
+    *len = (size_t)(found - s->pos);
+    s->pos = found + 1;
+    return 1;
+}
+
+/**
+ * @brief Copia un campo extraído a un buffer de tamaño fijo terminado en '\0'.
+ *
+ * @param dst Buffer destino.
+ * @param size Tamaño de dst.
+ * @param tok Campo de origen.
+ * @param len Longitud del campo.
+ */
+void scan_copy(char* dst, size_t size, const char* tok, size_t len)
+{
+    if (len >= size)
+    {
+        len = size - 1;
+    }
+    memcpy(dst, tok, len);
+    dst[len] = '\0';
+}
@@ -0,0 +1,225 @@
+/**
+ * @file strmap.c
+ * @brief Implementación de la tabla hash de claves de texto.
+ */
+
+#include "strmap.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @brief Capacidad mínima de la tabla.
+ */
+#define STRMAP_MIN_CAPACITY 16
+
+/**
+ * @brief Calcula el hash FNV-1a de una clave.
+ *
+ * @param key Clave.
+ * @param len Longitud de la clave.
+ * @return Hash de la clave.
+ */
+static size_t strmap_hash(const char* key, size_t len)
+{
+    size_t h = (size_t)1469598103934665603ULL;
+    for (size_t i = 0; i < len; i++)
+    {
+        h ^= (unsigned char)key[i];
+        h *= (size_t)1099511628211ULL;
+    }
+    return h;
+}
+
+/**
+ * @brief Busca la entrada de una clave o la primera libre de su secuencia de sondeo.
+ *
+ * @param map Tabla.
+ * @param key Clave.
+ * @param len Longitud de la clave.
+ * @param hash Hash de la clave.
+ * @return Índice de la entrada encontrada o libre.
+ */
+static size_t strmap_find(const strmap_t* map, const char* key, size_t len, size_t hash)
+{
+    size_t mask = map->capacity - 1;
+    size_t i = hash & mask;
+
+    while (map->slots[i].key != NULL)
+    {
+        const strmap_slot_t* slot = &map->slots[i];
+        if (slot->hash == hash && slot->key_len == len && memcmp(slot->key, key, len) == 0)
+        {
+            break;
+        }
+        i = (i + 1) & mask;
+    }
+
+    return i;
+}
+
+/**
+ * @brief Cambia la capacidad de la tabla y redistribuye las entradas.
+ *
+ * @param map Tabla.
+ * @param capacity Nueva capacidad (potencia de dos).
+ * @return 0 en caso de éxito, -1 en caso de error.
+ */
+static int strmap_resize(strmap_t* map, size_t capacity)
+{
+    strmap_slot_t* old = map->slots;
+    size_t old_capacity = map->capacity;
+
+    map->slots = calloc(capacity, sizeof(*map->slots));
+    if (map->slots == NULL)
+    {
+        perror("Error al asignar memoria");
+        map->slots = old;
+        return -1;
+    }
+    map->capacity = capacity;
+
+    for (size_t i = 0; i < old_capacity; i++)
+    {
+        if (old[i].key != NULL)
+        {
+            map->slots[strmap_find(map, old[i].key, old[i].key_len, old[i].hash)] = old[i];
+        }
+    }
+
+    free(old);
+    return 0;
+}
+
+/**
+ * @brief Inicializa la tabla.
+ *
+ * @param map Tabla a inicializar.
+ * @param capacity Capacidad inicial.
+ * @return 0 en caso de éxito, -1 en caso de error.
+ */
+int strmap_init(strmap_t* map, size_t capacity)
+{
+    size_t real = STRMAP_MIN_CAPACITY;
+    while (real < capacity)
+    {
+        real <<= 1;
+    }
+
+    map->slots = calloc(real, sizeof(*map->slots));
+    if (map->slots == NULL)
+    {
+        perror("Error al asignar memoria");
+        return -1;
+    }
+    map->capacity = real;
+    map->count = 0;
+    return 0;
+}
+
+/**
+ * @brief Libera las entradas de la tabla.
+ *
+ * @param map Tabla a liberar.
+ */
+void strmap_free(strmap_t* map)
+{
+    free(map->slots);
+    map->slots = NULL;
+    map->capacity = 0;
+    map->count = 0;
+}
+
+/**
+ * @brief Busca un valor por clave.
+ *
+ * @param map Tabla.
+ * @param key Clave.
+ * @param key_len Longitud de la clave.
+ * @return Valor asociado, o NULL si no existe.
+ */
+void* strmap_get(const strmap_t* map, const char* key, size_t key_len)
+{
+    if (map->capacity == 0)
+    {
+        return NULL;
+    }
+
+    return map->slots[strmap_find(map, key, key_len, strmap_hash(key, key_len))].value;
+}
+
+/**
+ * @brief Inserta o reemplaza un valor.
+ *
+ * @param map Tabla.
+ * @param key Clave terminada en '\0'.
+ * @param value Valor asociado.
+ * @return 0 en caso de éxito, -1 en caso de error.
+ */
+int strmap_put(strmap_t* map, const char* key, void* value)
+{
+    // Mantener la carga por debajo del 70% para que los sondeos sean cortos
+    if ((map->count + 1) * 10 > map->capacity * 7 &&
+        strmap_resize(map, map->capacity ? map->capacity * 2 : STRMAP_MIN_CAPACITY) != 0)
+    {
+        return -1;
+    }
+
+    size_t len = strlen(key);
+    size_t hash = strmap_hash(key, len);
+    strmap_slot_t* slot = &map->slots[strmap_find(map, key, len, hash)];
+
+    if (slot->key == NULL)
+    {
+        map->count++;
+    }
+    slot->key = key;
+    slot->key_len = len;
+    slot->hash = hash;
+    slot->value = value;
+    return 0;
+}
+
+/**
+ * @brief Elimina una clave desplazando hacia atrás las entradas de su cadena de sondeo.
+ *
+ * @param map Tabla.
+ * @param key Clave terminada en '\0'.
+ * @return Valor que estaba asociado, o NULL si no existía.
+ */
+void* strmap_remove(strmap_t* map, const char* key)
+{
+    if (map->capacity == 0)
+    {
+        return NULL;
+    }
+
+    size_t len = strlen(key);
+    size_t mask = map->capacity - 1;
+    size_t i = strmap_find(map, key, len, strmap_hash(key, len));
+    void* value = map->slots[i].value;
+
+    if (map->slots[i].key == NULL)
+    {
+        return NULL;
+    }
+
+    // Rellenar el hueco con las entradas posteriores cuya posición ideal no quede entre el hueco y ellas
+    size_t j = i;
+    for (;;)
+    {
+        map->slots[i].key = NULL;
+        map->slots[i].value = NULL;
+        do
+        {
+            j = (j + 1) & mask;
+            if (map->slots[j].key == NULL)
+            {
+                map->count--;
+                return value;
+            }
+        } while (((j - (map->slots[j].hash & mask)) & mask) < ((j - i) & mask));
+        map->slots[i] = map->slots[j];
+        i = j;
+    }
+}
@@ -0,0 +1,30 @@
+/**
+ * @file test.h
+ * @brief Macros mínimas de las pruebas unitarias: cada prueba es un ejecutable que devuelve 0 si pasó.
+ */
+
+#pragma once
+#include <stdio.h>
+
+/**
+ * @brief Comprobaciones fallidas del ejecutable.
+ */
+static int test_failures = 0;
+
+/**
+ * @brief Comprueba una condición y, si no se cumple, informa el archivo, la línea y la condición.
+ */
+#define CHECK(cond)                                                                                                  \
+    do                                                                                                               \
+    {                                                                                                                \
+        if (!(cond))                                                                                                 \
+        {                                                                                                            \
+            fprintf(stderr, "%s:%d: falló %s\n", __FILE__, __LINE__, #cond);                                        \
+            test_failures++;                                                                                         \
+        }                                                                                                            \
+    } while (0)
+
+/**
+ * @brief Resultado del ejecutable para ctest.
+ */
+#define TEST_RESULT() (test_failures == 0 ? 0 : 1)
@@ -0,0 +1,211 @@
+/**
+ * @file test_aggregator.c
+ * @brief Exposición de un nodo que recolecta y agrega a la vez: las métricas propias del registro más las series
+ * resumidas de las mismas métricas que llegan por line protocol deben formar una exposición válida.
+ */
+
+#include "aggregator.h"
+#include "metric_registry.h"
+#include "prom_lite.h"
+#include "test.h"
+#include <arpa/inet.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/socket.h>
+#include <time.h>
+#include <unistd.h>
+
+/**
+ * @brief Primer puerto UDP que se prueba para el agregador; se sigue con los siguientes si está ocupado.
+ */
+#define TEST_PORT 18089
+
+/**
+ * @brief Cantidad máxima de familias de la exposición.
+ */
+#define TEST_MAX_FAMILIES 1024
+
+/**
+ * @brief Familia declarada con "# TYPE".
+ */
+typedef struct
+{
+    char name[128]; ///< Nombre.
+    char type[16];  ///< Tipo.
+} test_family_t;
+
+/**
+ * @brief Indica si una muestra pertenece a una familia: el mismo nombre o, en summary e histogram, sus sufijos.
+ */
+static int sample_in_family(const char* sample, size_t len, const test_family_t* family)
+{
+    static const char* const suffixes[] = {"_sum", "_count", "_bucket"};
+    size_t family_len = strlen(family->name);
+    if (len < family_len || memcmp(sample, family->name, family_len) != 0)
+    {
+        return 0;
+    }
+    if (len == family_len)
+    {
+        return strcmp(family->type, "histogram") != 0;
+    }
+    if (strcmp(family->type, "summary") != 0 && strcmp(family->type, "histogram") != 0)
+    {
+        return 0;
+    }
+    for (size_t s = 0; s < sizeof(suffixes) / sizeof(suffixes[0]); s++)
+    {
+        if (strlen(suffixes[s]) == len - family_len && memcmp(sample + family_len, suffixes[s], len - family_len) == 0)
+        {
+            return s < 2 || strcmp(family->type, "histogram") == 0;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Verifica la exposición: cada familia se declara una sola vez y cada muestra sigue a la declaración de su
+ * familia.
+ *
+ * @return Cantidad de muestras de familias con AGGREGATOR_PREFIX.
+ */
+static int check_exposition(const char* body)
+{
+    static test_family_t families[TEST_MAX_FAMILIES];
+    int family_count = 0;
+    int aggregated = 0;
+
+    for (const char* line = body; *line != '\0';)
+    {
+        const char* eol = strchr(line, '\n');
+        size_t len = eol != NULL ? (size_t)(eol - line) : strlen(line);
+        if (len > 7 && memcmp(line, "# TYPE ", 7) == 0)
+        {
+            test_family_t family;
+            CHECK(sscanf(line + 7, "%127s %15s", family.name, family.type) == 2);
+            int duplicate = 0;
+            for (int f = 0; f < family_count && !duplicate; f++)
+            {
+                duplicate = strcmp(families[f].name, family.name) == 0;
+                if (duplicate)
+                {
+                    fprintf(stderr, "familia duplicada: %s (%s y %s)\n", family.name, families[f].type, family.type);
+                }
+            }
+            CHECK(!duplicate);
+            CHECK(family_count < TEST_MAX_FAMILIES);
+            if (family_count < TEST_MAX_FAMILIES)
+            {
+                families[family_count++] = family;
+            }
+        }
+        else if (len > 0 && line[0] != '#')
+        {
+            size_t name_len = strcspn(line, "{ ");
+            int valid = family_count > 0 && sample_in_family(line, name_len, &families[family_count - 1]);
+            if (!valid)
+            {
+                fprintf(stderr, "muestra fuera de su familia: %.*s\n", (int)len, line);
+            }
+            CHECK(valid);
+            aggregated += strncmp(line, AGGREGATOR_PREFIX, strlen(AGGREGATOR_PREFIX)) == 0;
+        }
+        line += len + (eol != NULL);
+    }
+    return aggregated;
+}
+
+/**
+ * @brief Envía una línea por métrica del registro, con y sin etiquetas, como lo haría push.c desde otro agente.
+ */
+static void send_registry_lines(int port)
+{
+    int fd = socket(AF_INET, SOCK_DGRAM, 0);
+    CHECK(fd >= 0);
+    struct sockaddr_in to = {0};
+    to.sin_family = AF_INET;
+    to.sin_port = htons((uint16_t)port);
+    to.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+
+    char datagram[8192];
+    size_t len = 0;
+    for (int i = 0; i < metric_registry_count(); i++)
+    {
+        const char* name = metric_registry_at(i)->name;
+        if (len + 2 * strlen(name) + 64 > sizeof(datagram))
+        {
+            sendto(fd, datagram, len, 0, (const struct sockaddr*)&to, sizeof(to));
+            len = 0;
+        }
+        len += (size_t)snprintf(datagram + len, sizeof(datagram) - len, "%s value=%d\n%s,cpu=0 value=1\n", name, i,
+                                name);
+    }
+    sendto(fd, datagram, len, 0, (const struct sockaddr*)&to, sizeof(to));
+    close(fd);
+}
+
+int main()
+{
+    CHECK(prom_collector_registry_default_init() == 0);
+    CHECK(metric_registry_init() == 0);
+    for (int i = 0; i < metric_registry_count(); i++)
+    {
+        const metric_desc_t* desc = metric_registry_at(i);
+        if (desc->metric != NULL && desc->kind == METRIC_GAUGE && desc->label_count == 0 && desc->create == NULL)
+        {
+            prom_gauge_set(desc->metric, 1.0, NULL);
+        }
+    }
+
+    static const char* const patterns[] = {"127.0.0.*"};
+    static const aggregator_group_t group = {"local", patterns, 1};
+    aggregator_options_t options = {0};
+    char listen[32];
+    int port = TEST_PORT;
+    options.groups = &group;
+    options.group_count = 1;
+    options.interval_ms = 20;
+    options.listen = listen;
+    for (; port < TEST_PORT + 16; port++)
+    {
+        snprintf(listen, sizeof(listen), "127.0.0.1:%d", port);
+        if (aggregator_start(&options) == 0)
+        {
+            break;
+        }
+    }
+    CHECK(port < TEST_PORT + 16);
+    if (port == TEST_PORT + 16)
+    {
+        return TEST_RESULT();
+    }
+
+    // UDP puede perder datagramas: se reenvía hasta que un cálculo completo posterior al envío incluya las series
+    arena_t arena = {0};
+    const char* body = NULL;
+    for (int attempt = 0; attempt < 100; attempt++)
+    {
+        send_registry_lines(port);
+        unsigned long long generation = aggregator_generation();
+        struct timespec pause = {0, 10 * 1000 * 1000};
+        while (aggregator_generation() < generation + 2)
+        {
+            nanosleep(&pause, NULL);
+        }
+        arena_reset(&arena);
+        body = aggregator_append(prom_collector_registry_render(PROM_COLLECTOR_REGISTRY_DEFAULT, &arena), &arena);
+        if (body != NULL && strstr(body, "# TYPE " AGGREGATOR_PREFIX) != NULL)
+        {
+            break;
+        }
+    }
+    CHECK(body != NULL);
+    if (body != NULL)
+    {
+        CHECK(check_exposition(body) > 0);
+    }
+    arena_free(&arena);
+    aggregator_stop();
+    return TEST_RESULT();
+}
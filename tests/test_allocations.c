@@ -0,0 +1,128 @@
+/**
+ * @file test_allocations.c
+ * @brief Reservas del heap en régimen: después del calentamiento, un ciclo de recolección sobre un fixture y un render
+ * en la arena del scrape no le piden memoria al heap.
+ */
+
+#include "arena.h"
+#include "metric_registry.h"
+#include "monitor_stats.h"
+#include "prom_lite.h"
+#include "test.h"
+
+/**
+ * @brief Fuentes que los fixtures no capturan: las de monitor_bench más la tabla de montajes.
+ */
+#define UNCAPTURED_SOURCES (SNAPSHOT_PROCS | SNAPSHOT_CGROUPS | SNAPSHOT_BPF | SNAPSHOT_FILESYSTEMS)
+
+/**
+ * @brief Ciclos de calentamiento: crean las series y llevan arenas y buffers a su tamaño final.
+ */
+#define WARMUP_TICKS 3
+
+/**
+ * @brief Ciclos medidos.
+ */
+#define MEASURED_TICKS 20
+
+/**
+ * @brief Ejecuta un ciclo de recolección y publica el lote.
+ */
+static void tick(metric_channel_t* channel, proc_snapshot_t* snap, unsigned int sources, unsigned long long enabled)
+{
+    update_snapshot_sources(snap, sources);
+    metric_batch_t* batch = metric_batch_begin(channel);
+    if (batch != NULL)
+    {
+        metric_registry_collect(batch, snap, sources, enabled);
+        metric_batch_publish(channel);
+    }
+}
+
+/**
+ * @brief Vuelca el último lote en el registro, como el scrape; solo importa que cada serie exista.
+ */
+static void sync_registry(metric_channel_t* channel)
+{
+    int slot;
+    const metric_batch_t* batch = metric_store_acquire(channel, &slot);
+    if (batch == NULL)
+    {
+        return;
+    }
+    for (size_t i = 0; i < batch->count; i++)
+    {
+        const metric_sample_t* sample = &batch->samples[i];
+        const char* labels[METRIC_MAX_LABELS];
+        for (int l = 0; l < sample->label_count; l++)
+        {
+            labels[l] = sample->labels[l];
+        }
+        prom_gauge_set(sample->metric, sample->value, sample->label_count ? labels : NULL);
+    }
+    metric_store_release(channel, slot);
+}
+
+/**
+ * @brief Renderiza la exposición en la arena y la reinicia, como exposition_cache.c.
+ *
+ * @return 1 si el render produjo texto, 0 si no.
+ */
+static int render(arena_t* arena)
+{
+    const char* body = prom_collector_registry_render(PROM_COLLECTOR_REGISTRY_DEFAULT, arena);
+    int ok = body != NULL && body[0] != '\0';
+    arena_reset(arena);
+    return ok;
+}
+
+int main()
+{
+    CHECK(monitor_counts_allocations());
+    CHECK(snapshot_set_sys_root(TEST_FIXTURE_DIR "/sys") == 0);
+    CHECK(snapshot_set_proc_root(TEST_FIXTURE_DIR) == 0);
+    CHECK(snapshot_init() == 0);
+    CHECK(prom_collector_registry_default_init() == 0);
+    CHECK(metric_registry_init() == 0);
+    metric_channel_t* channel = metric_channel_new("test");
+    CHECK(channel != NULL);
+
+    unsigned long long enabled = metric_registry_enabled();
+    unsigned int sources = metric_registry_sources(enabled) & ~UNCAPTURED_SOURCES;
+    static proc_snapshot_t snap;
+    arena_t arena = {0};
+    for (int i = 0; i < WARMUP_TICKS; i++)
+    {
+        tick(channel, &snap, sources, enabled);
+        sync_registry(channel);
+        CHECK(render(&arena));
+    }
+
+    // El ciclo de recolección
+    unsigned long long before = monitor_thread_allocations();
+    for (int i = 0; i < MEASURED_TICKS; i++)
+    {
+        tick(channel, &snap, sources, enabled);
+    }
+    unsigned long long collect_allocations = monitor_thread_allocations() - before;
+    CHECK(collect_allocations == 0);
+
+    // El volcado y el render del scrape
+    before = monitor_thread_allocations();
+    for (int i = 0; i < MEASURED_TICKS; i++)
+    {
+        sync_registry(channel);
+        CHECK(render(&arena));
+    }
+    unsigned long long render_allocations = monitor_thread_allocations() - before;
+    CHECK(render_allocations == 0);
+
+    if (collect_allocations != 0 || render_allocations != 0)
+    {
+        fprintf(stderr, "reservas en %d ciclos: recolección %llu, render %llu\n", MEASURED_TICKS,
+                collect_allocations, render_allocations);
+    }
+    arena_free(&arena);
+    snapshot_close();
+    return TEST_RESULT();
+}
@@ -0,0 +1,55 @@
+/**
+ * @file test_diskstats.c
+ * @brief Selección de dispositivos de diskstats.c sobre el fixture cores_128: sin lista de permitidos quedan los
+ * discos completos de su sys/block, sin particiones ni loop*; con lista, los que cumplen sus patrones.
+ */
+
+#include "diskstats.h"
+#include "metrics.h"
+#include "test.h"
+
+/**
+ * @brief Indica si la instantánea incluye un dispositivo.
+ */
+static int has_disk(const proc_snapshot_t* snap, const char* name)
+{
+    for (int i = 0; i < snap->disk_count; i++)
+    {
+        if (strcmp(snap->disks[i].name, name) == 0)
+        {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+int main()
+{
+    static proc_snapshot_t snap;
+    CHECK(snapshot_set_sys_root(TEST_FIXTURE_DIR "/sys") == 0);
+    CHECK(snapshot_set_proc_root(TEST_FIXTURE_DIR) == 0);
+    CHECK(snapshot_init() == 0);
+
+    // Los 8 NVMe y los 4 md del fixture, sin sus particiones ni los loop que también figuran en sys/block
+    CHECK(update_snapshot_sources(&snap, SNAPSHOT_DISKSTATS) == 0);
+    CHECK(snap.disk_count == 12);
+    CHECK(has_disk(&snap, "nvme0n1") && has_disk(&snap, "nvme7n1") && has_disk(&snap, "md3"));
+    CHECK(!has_disk(&snap, "nvme0n1p1") && !has_disk(&snap, "loop0"));
+
+    // Con lista de permitidos se usan solo sus patrones
+    const char* patterns[] = {"nvme*"};
+    set_disk_allowlist(patterns, 1);
+    CHECK(update_snapshot_sources(&snap, SNAPSHOT_DISKSTATS) == 0);
+    CHECK(snap.disk_count == 24);
+    CHECK(has_disk(&snap, "nvme0n1p1") && !has_disk(&snap, "md0"));
+    set_disk_allowlist(NULL, 0);
+
+    // Sin block/ en la raíz de /sys no se pueden distinguir particiones: se acepta todo salvo loop*, ram* y zram*
+    CHECK(snapshot_set_sys_root(TEST_FIXTURE_DIR) == 0);
+    CHECK(snapshot_init() == 0);
+    CHECK(update_snapshot_sources(&snap, SNAPSHOT_DISKSTATS) == 0);
+    CHECK(snap.disk_count == 28);
+
+    snapshot_close();
+    return TEST_RESULT();
+}
@@ -0,0 +1,159 @@
+/**
+ * @file test_history_block.c
+ * @brief Ida y vuelta del codificador Gorilla de history_block.c, con los bordes de cada campo de instantes.
+ */
+
+#include "history_block.h"
+#include "test.h"
+#include <math.h>
+#include <stdint.h>
+#include <string.h>
+
+/**
+ * @brief Muestras de una prueba.
+ */
+#define TEST_SAMPLES (HISTORY_BLOCK_SAMPLES)
+
+/**
+ * @brief Bits de un double.
+ */
+static uint64_t double_bits(double value)
+{
+    uint64_t bits;
+    memcpy(&bits, &value, sizeof(bits));
+    return bits;
+}
+
+/**
+ * @brief Codifica las muestras en bloques sucesivos y verifica que cada bloque devuelve exactamente lo agregado.
+ */
+static void check_round_trip(const int64_t* ts, const double* values, int count)
+{
+    history_block_t block;
+    int first = 0;
+    while (first < count)
+    {
+        history_block_start(&block, ts[first], double_bits(values[first]));
+        int end = first + 1;
+        while (end < count && history_block_append(&block, ts[end], double_bits(values[end])) == 0)
+        {
+            end++;
+        }
+        CHECK(block.count == end - first);
+
+        history_block_reader_t reader;
+        history_block_reader_init(&reader, &block);
+        int64_t t;
+        double v;
+        for (int i = first; i < end; i++)
+        {
+            CHECK(history_block_next(&reader, &t, &v) == 1);
+            CHECK(t == ts[i]);
+            CHECK(double_bits(v) == double_bits(values[i]));
+        }
+        CHECK(history_block_next(&reader, &t, &v) == 0);
+        first = end;
+    }
+}
+
+/**
+ * @brief Diferencias de diferencias en los bordes de los campos de 7, 9, 12 y 32 bits y del lado de afuera.
+ */
+static void test_delta_of_delta_boundaries()
+{
+    static const int64_t dods[] = {
+        0,     1,    -1,    63,    64,   -64,  -65,       255,       256,        -256, -257,
+        2047,  2048, -2048, -2049, 1 << 20, -(1 << 20), INT32_MAX, INT32_MIN + 1, 0,    0,
+    };
+    int count = (int)(sizeof(dods) / sizeof(dods[0]));
+    int64_t ts[sizeof(dods) / sizeof(dods[0]) + 2];
+    double values[sizeof(dods) / sizeof(dods[0]) + 2];
+
+    int64_t delta = 1000;
+    ts[0] = 1700000000000;
+    ts[1] = ts[0] + delta;
+    values[0] = values[1] = 42.5;
+    for (int i = 0; i < count; i++)
+    {
+        delta += dods[i];
+        ts[i + 2] = ts[i + 1] + delta;
+        values[i + 2] = 42.5;
+    }
+    check_round_trip(ts, values, count + 2);
+
+    // Cada borde en un bloque de tres muestras, así la diferencia de diferencias es exactamente la del arreglo
+    for (int i = 0; i < count; i++)
+    {
+        int64_t edge_ts[3] = {1700000000000, 1700000001000, 1700000002000 + dods[i]};
+        double edge_values[3] = {1, 1, 1};
+        history_block_t block;
+        history_block_start(&block, edge_ts[0], double_bits(edge_values[0]));
+        CHECK(history_block_append(&block, edge_ts[1], double_bits(edge_values[1])) == 0);
+        CHECK(history_block_append(&block, edge_ts[2], double_bits(edge_values[2])) == 0);
+        history_block_reader_t reader;
+        history_block_reader_init(&reader, &block);
+        int64_t t = 0;
+        double v;
+        for (int s = 0; s < 3; s++)
+        {
+            CHECK(history_block_next(&reader, &t, &v) == 1);
+            CHECK(t == edge_ts[s]);
+        }
+    }
+}
+
+/**
+ * @brief Valores que ejercitan la ventana de XOR: iguales, con pocos bits cambiados, con muchos y especiales.
+ */
+static void test_values()
+{
+    int64_t ts[TEST_SAMPLES * 3];
+    double values[TEST_SAMPLES * 3];
+    int count = (int)(sizeof(ts) / sizeof(ts[0]));
+    for (int i = 0; i < count; i++)
+    {
+        ts[i] = 1700000000000 + (int64_t)i * 1000 + (i % 7 == 0 ? 3 : 0);
+        switch (i % 6)
+        {
+        case 0:
+            values[i] = 12.0;
+            break;
+        case 1:
+            values[i] = 12.0 + i;
+            break;
+        case 2:
+            values[i] = -1e300 / (i + 1);
+            break;
+        case 3:
+            values[i] = i % 4 == 0 ? NAN : INFINITY;
+            break;
+        case 4:
+            values[i] = 0.0;
+            break;
+        default:
+            values[i] = 1.0 / 3.0 * i;
+            break;
+        }
+    }
+    check_round_trip(ts, values, count);
+}
+
+/**
+ * @brief Una diferencia de diferencias que no entra en 32 bits cierra el bloque sin corromperlo.
+ */
+static void test_out_of_range()
+{
+    history_block_t block;
+    history_block_start(&block, 0, double_bits(1));
+    CHECK(history_block_append(&block, 1000, double_bits(1)) == 0);
+    CHECK(history_block_append(&block, 1000 + 1000 + (int64_t)INT32_MAX + 1, double_bits(1)) == -1);
+    CHECK(block.count == 2);
+}
+
+int main()
+{
+    test_delta_of_delta_boundaries();
+    test_values();
+    test_out_of_range();
+    return TEST_RESULT();
+}
@@ -0,0 +1,48 @@
+/**
+ * @file test_http_client.c
+ * @brief Destinos de http_client.c y la cabecera de los POST que envían push.c y alert.c.
+ */
+
+#include "http_client.h"
+#include "test.h"
+#include <string.h>
+
+int main()
+{
+    http_target_t target;
+    char request[1024];
+
+    // Nombre con puerto y ruta
+    CHECK(http_target_parse("localhost:9201/api/v1/write", HTTP_DEFAULT_PORT, &target) == 0);
+    CHECK(strcmp(target.host, "localhost") == 0 && strcmp(target.port, "9201") == 0);
+    CHECK(strcmp(target.path, "/api/v1/write") == 0);
+    int len = http_format_request(&target, "Content-Type: application/json\r\n", 12, request, sizeof(request));
+    CHECK(len > 0 && (size_t)len == strlen(request));
+    CHECK(strcmp(request, "POST /api/v1/write HTTP/1.1\r\n"
+                          "Host: localhost:9201\r\n"
+                          "Content-Type: application/json\r\n"
+                          "User-Agent: monitoring_project\r\n"
+                          "Content-Length: 12\r\n"
+                          "Connection: close\r\n\r\n") == 0);
+
+    // IPv6: los corchetes se quitan para getaddrinfo() y vuelven en Host
+    CHECK(http_target_parse("[::1]:9201/api/v1/write", HTTP_DEFAULT_PORT, &target) == 0);
+    CHECK(strcmp(target.host, "::1") == 0 && strcmp(target.port, "9201") == 0);
+    CHECK(http_format_request(&target, "", 0, request, sizeof(request)) > 0);
+    CHECK(strstr(request, "\r\nHost: [::1]:9201\r\n") != NULL);
+
+    // Sin puerto ni ruta
+    CHECK(http_target_parse("[fe80::1]", HTTP_DEFAULT_PORT, &target) == 0);
+    CHECK(strcmp(target.host, "fe80::1") == 0 && strcmp(target.port, "80") == 0 && strcmp(target.path, "/") == 0);
+    CHECK(http_target_parse("example.org", "8125", &target) == 0);
+    CHECK(strcmp(target.host, "example.org") == 0 && strcmp(target.port, "8125") == 0);
+
+    // Destinos inválidos y cabecera que no entra
+    CHECK(http_target_parse("[::1:9201/", HTTP_DEFAULT_PORT, &target) != 0);
+    CHECK(http_target_parse(":9201/", HTTP_DEFAULT_PORT, &target) != 0);
+    CHECK(http_target_parse("host:/", HTTP_DEFAULT_PORT, &target) != 0);
+    CHECK(http_target_parse("host:123456789/", HTTP_DEFAULT_PORT, &target) != 0);
+    CHECK(http_format_request(&target, "", 0, request, 16) < 0);
+
+    return TEST_RESULT();
+}
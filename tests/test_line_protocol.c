@@ -0,0 +1,47 @@
+/**
+ * @file test_line_protocol.c
+ * @brief Formato de las líneas de StatsD y line protocol.
+ */
+
+#include "line_protocol.h"
+#include "test.h"
+#include <math.h>
+#include <string.h>
+
+int main()
+{
+    metric_info_t info = {NULL, "disk_usage_percentage", 2, {"device", "mountpoint"}};
+    push_sample_t sample = {NULL, 1700000000123LL, 42.5, 2, {"sda1", "/mnt/a b,c=d"}};
+    char line[PUSH_DATAGRAM_SIZE];
+
+    // StatsD: gauge del valor con las etiquetas como tags de DogStatsD, sin separadores en los valores
+    int len = line_protocol_format(PUSH_STATSD, &info, &sample, line, sizeof(line));
+    CHECK(len > 0 && strcmp(line, "disk_usage_percentage:42.5|g|#device:sda1,mountpoint:/mnt/a b_c=d\n") == 0);
+
+    // line protocol: ',', '=' y ' ' escapados en los valores e instante en nanosegundos
+    len = line_protocol_format(PUSH_INFLUX, &info, &sample, line, sizeof(line));
+    CHECK(len > 0 && (size_t)len == strlen(line));
+    CHECK(strcmp(line, "disk_usage_percentage,device=sda1,mountpoint=/mnt/a\\ b\\,c\\=d value=42.5 "
+                       "1700000000123000000\n") == 0);
+
+    // Una etiqueta vacía se omite; sin métrica registrada, con valor no finito o sin lugar, la muestra se omite
+    strcpy(sample.labels[1], "");
+    CHECK(line_protocol_format(PUSH_INFLUX, &info, &sample, line, sizeof(line)) > 0);
+    CHECK(strncmp(line, "disk_usage_percentage,device=sda1 value=", 40) == 0);
+    CHECK(line_protocol_format(PUSH_INFLUX, NULL, &sample, line, sizeof(line)) == 0);
+    CHECK(line_protocol_format(PUSH_INFLUX, &info, &sample, line, 20) == 0);
+    sample.value = NAN;
+    CHECK(line_protocol_format(PUSH_STATSD, &info, &sample, line, sizeof(line)) == 0);
+
+    // Tags de DogStatsD: cada separador se reemplaza, con truncado
+    char tag[8];
+    line_protocol_statsd_tag(tag, sizeof(tag), "a|b#c:d,e");
+    CHECK(strcmp(tag, "a_b_c_d") == 0);
+
+    // Escape truncado sin cortar el final
+    char escaped[6];
+    line_protocol_escape(escaped, sizeof(escaped), "a,b,c");
+    CHECK(strcmp(escaped, "a\\,b") == 0);
+
+    return TEST_RESULT();
+}
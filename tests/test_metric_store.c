@@ -0,0 +1,82 @@
+/**
+ * @file test_metric_store.c
+ * @brief Copia de los valores de etiquetas en metric_batch_add(): los valores largos se truncan sin confundirse.
+ */
+
+#include "metric_store.h"
+#include "test.h"
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @brief Agrega una muestra con una etiqueta y devuelve el valor copiado.
+ */
+static const char* add_label(metric_batch_t* batch, const char* value)
+{
+    static int metric;
+    const char* labels[] = {value};
+    metric_batch_add(batch, &metric, METRIC_GAUGE, 1.0, labels, 1);
+    return batch->samples[batch->count - 1].labels[0];
+}
+
+int main()
+{
+    metric_batch_t batch = {0};
+    char prefix[METRIC_LABEL_SIZE * 2];
+    char first[sizeof(prefix) + 8];
+    char second[sizeof(prefix) + 8];
+    memset(prefix, 'a', sizeof(prefix) - 1);
+    prefix[0] = '/';
+    prefix[sizeof(prefix) - 1] = '\0';
+    snprintf(first, sizeof(first), "%s/uno", prefix);
+    snprintf(second, sizeof(second), "%s/dos", prefix);
+
+    // Un valor que entra se copia tal cual
+    CHECK(strcmp(add_label(&batch, "/var/lib"), "/var/lib") == 0);
+    char exact[METRIC_LABEL_SIZE];
+    memcpy(exact, prefix, sizeof(exact) - 1);
+    exact[sizeof(exact) - 1] = '\0';
+    CHECK(strcmp(add_label(&batch, exact), exact) == 0);
+
+    // Dos valores largos con el mismo comienzo quedan distintos, con el comienzo y el hash del valor completo
+    char copy[METRIC_LABEL_SIZE];
+    snprintf(copy, sizeof(copy), "%s", add_label(&batch, first));
+    const char* other = add_label(&batch, second);
+    CHECK(strlen(copy) == METRIC_LABEL_SIZE - 1);
+    CHECK(strlen(other) == METRIC_LABEL_SIZE - 1);
+    CHECK(strcmp(copy, other) != 0);
+    CHECK(memcmp(copy, prefix, METRIC_LABEL_SIZE - METRIC_LABEL_HASH_LEN - 1) == 0);
+    CHECK(copy[METRIC_LABEL_SIZE - METRIC_LABEL_HASH_LEN - 1] == '~');
+    CHECK(strcmp(add_label(&batch, first), copy) == 0);
+
+    // El corte no deja un carácter UTF-8 a medias
+    char accented[METRIC_LABEL_SIZE * 2];
+    size_t len = 0;
+    while (len + 2 < sizeof(accented))
+    {
+        accented[len++] = (char)0xc3;
+        accented[len++] = (char)0xb1;
+    }
+    accented[len] = '\0';
+    const char* cut = add_label(&batch, accented);
+    size_t kept = strlen(cut) - METRIC_LABEL_HASH_LEN;
+    CHECK(kept % 2 == 0);
+    CHECK(cut[kept] == '~');
+
+    // El hash de las etiquetas separa los valores: {"ab", "c"} y {"a", "bc"} son series distintas
+    const char* joined[] = {"ab", "c"};
+    const char* split[] = {"a", "bc"};
+    static int metric;
+    batch.count = 0;
+    metric_batch_add(&batch, &metric, METRIC_GAUGE, 0, joined, 2);
+    metric_batch_add(&batch, &metric, METRIC_GAUGE, 0, split, 2);
+    metric_batch_add(&batch, &metric, METRIC_GAUGE, 0, joined, 2);
+    const metric_sample_t* samples = batch.samples;
+    uint64_t first_hash = metric_labels_hash(samples[0].labels, samples[0].label_count);
+    CHECK(first_hash != metric_labels_hash(samples[1].labels, samples[1].label_count));
+    CHECK(first_hash == metric_labels_hash(samples[2].labels, samples[2].label_count));
+    CHECK(first_hash != metric_labels_hash(samples[0].labels, 1));
+
+    free(batch.samples);
+    return TEST_RESULT();
+}
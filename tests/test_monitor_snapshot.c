@@ -0,0 +1,74 @@
+/**
+ * @file test_monitor_snapshot.c
+ * @brief Instantáneas de monitor_snapshot.c con todos los buffers fijados: el lote publicado mientras tanto se
+ * refleja cuando un lector suelta un buffer.
+ */
+
+#include "metric_registry.h"
+#include "monitor_snapshot.h"
+#include "prom_lite.h"
+#include "test.h"
+
+/**
+ * @brief Publica un lote con un valor del gauge de prueba.
+ */
+static void publish(metric_channel_t* channel, void* metric, double value)
+{
+    metric_batch_t* batch = metric_batch_begin(channel);
+    metric_batch_add(batch, metric, METRIC_GAUGE, value, NULL, 0);
+    metric_batch_publish(channel);
+    monitor_snapshot_update();
+}
+
+/**
+ * @brief Valor del gauge de prueba en una instantánea, o -1 si no está.
+ */
+static double snapshot_value(const monitor_snapshot_t* snapshot)
+{
+    const monitor_sample_t* sample = monitor_snapshot_find(snapshot, "snapshot_test", NULL, 0);
+    return sample != NULL ? sample->value : -1;
+}
+
+int main()
+{
+    CHECK(prom_collector_registry_default_init() == 0);
+    void* metric = prom_gauge_new("snapshot_test", "Prueba", 0, NULL);
+    CHECK(metric_registry_register(metric, "snapshot_test", 0, NULL) == metric);
+    metric_channel_t* channel = metric_channel_new("test");
+    CHECK(channel != NULL);
+
+    // Cada lote nuevo se publica en otro buffer; el lector fija todos
+    publish(channel, metric, 0);
+    const monitor_snapshot_t* pinned[MONITOR_SNAPSHOT_BUFFERS];
+    for (int i = 0; i < MONITOR_SNAPSHOT_BUFFERS; i++)
+    {
+        if (i > 0)
+        {
+            publish(channel, metric, i);
+        }
+        pinned[i] = monitor_snapshot_get();
+        CHECK(pinned[i] != NULL && snapshot_value(pinned[i]) == i);
+    }
+
+    // Sin buffer libre el lote no se refleja todavía, pero tampoco se pierde
+    unsigned long long version = monitor_snapshot_version();
+    publish(channel, metric, 100);
+    CHECK(monitor_snapshot_version() == version);
+
+    // Soltar un buffer que no es el publicado arma la instantánea pendiente
+    monitor_snapshot_release(pinned[0]);
+    CHECK(monitor_snapshot_version() == version + 1);
+    const monitor_snapshot_t* latest = monitor_snapshot_get();
+    CHECK(latest != NULL && snapshot_value(latest) == 100);
+    monitor_snapshot_release(latest);
+
+    // Sin nada pendiente, soltar no arma otra
+    for (int i = 1; i < MONITOR_SNAPSHOT_BUFFERS; i++)
+    {
+        monitor_snapshot_release(pinned[i]);
+    }
+    CHECK(monitor_snapshot_version() == version + 1);
+
+    monitor_snapshot_close();
+    return TEST_RESULT();
+}
@@ -0,0 +1,50 @@
+/**
+ * @file test_proctable.c
+ * @brief Parser de /proc/[pid]/stat de proctable.c: comm con espacios y paréntesis, líneas truncadas y comm largo.
+ */
+
+#include "proctable.h"
+#include "test.h"
+#include <string.h>
+
+/**
+ * @brief Parsea una línea de stat sobre una entrada vacía.
+ */
+static int parse(const char* stat, proc_entry_t* entry, unsigned long long* ticks, unsigned long long* start,
+                 unsigned long long* rss)
+{
+    memset(entry, 0, sizeof(*entry));
+    return proctable_parse_stat(entry, stat, strlen(stat), ticks, start, rss);
+}
+
+int main()
+{
+    proc_entry_t entry;
+    unsigned long long ticks = 0, start = 0, rss = 0;
+
+    // Campos de utime(14), stime(15), starttime(22) y rss(24) contados desde el último ')'
+    CHECK(parse("1234 (bash) S 1 1234 1234 34816 1234 4194560 3000 0 5 0 150 25 0 0 20 0 1 0 98765 12345678 2222 "
+                "18446744073709551615\n",
+                &entry, &ticks, &start, &rss) == 0);
+    CHECK(strcmp(entry.comm, "bash") == 0);
+    CHECK(ticks == 175 && start == 98765 && rss == 2222);
+
+    // comm puede tener espacios y paréntesis: solo el último ')' cierra el nombre
+    CHECK(parse("77 (a) b (c) R 1 77 77 0 -1 0 0 0 0 0 9 1 0 0 20 0 1 0 500 100 7", &entry, &ticks, &start, &rss) ==
+          0);
+    CHECK(strcmp(entry.comm, "a) b (c") == 0);
+    CHECK(ticks == 10 && start == 500 && rss == 7);
+
+    // comm se trunca al tamaño del campo
+    CHECK(parse("5 (un_nombre_muy_largo_de_proceso) S 1 5 5 0 -1 0 0 0 0 0 1 1 0 0 20 0 1 0 1 1 1", &entry, &ticks,
+                &start, &rss) == 0);
+    CHECK(strlen(entry.comm) == PROCTABLE_COMM_SIZE - 1);
+
+    // Sin paréntesis, con comm vacío a medias o sin los campos hasta rss, la línea no es válida
+    CHECK(parse("1 bash S 1 1 1", &entry, &ticks, &start, &rss) == -1);
+    CHECK(parse("1 (", &entry, &ticks, &start, &rss) == -1);
+    CHECK(parse("1 (bash) S 1 1234 1234 34816 1234 4194560 3000 0 5 0 150 25 0 0 20 0 1 0 98765", &entry, &ticks,
+                &start, &rss) == -1);
+
+    return TEST_RESULT();
+}
@@ -0,0 +1,215 @@
+/**
+ * @file test_remote_write.c
+ * @brief WriteRequest de remote_write.c decodificado campo por campo e ida y vuelta del compresor snappy con un
+ * descompresor mínimo del formato de bloque.
+ */
+
+#include "metric_registry.h"
+#include "prom_lite.h"
+#include "remote_write.h"
+#include "test.h"
+#include <stdlib.h>
+#include <string.h>
+
+/**
+ * @brief Cursor de lectura de protobuf.
+ */
+typedef struct
+{
+    const uint8_t* pos; ///< Próximo byte.
+    const uint8_t* end; ///< Fin del mensaje.
+} pb_reader_t;
+
+/**
+ * @brief Lee un varint; devuelve 0 si el mensaje termina antes.
+ */
+static int pb_varint(pb_reader_t* r, uint64_t* value)
+{
+    *value = 0;
+    for (int shift = 0; r->pos < r->end && shift < 64; shift += 7)
+    {
+        uint8_t byte = *r->pos++;
+        *value |= (uint64_t)(byte & 0x7f) << shift;
+        if (!(byte & 0x80))
+        {
+            return 1;
+        }
+    }
+    return 0;
+}
+
+/**
+ * @brief Lee un campo de tipo LEN con la clave esperada y devuelve un cursor sobre su contenido.
+ */
+static int pb_len_field(pb_reader_t* r, int field, pb_reader_t* inner)
+{
+    uint64_t key, len;
+    if (!pb_varint(r, &key) || key != (uint64_t)(field << 3 | 2) || !pb_varint(r, &len) ||
+        len > (uint64_t)(r->end - r->pos))
+    {
+        return 0;
+    }
+    inner->pos = r->pos;
+    inner->end = r->pos + len;
+    r->pos += len;
+    return 1;
+}
+
+/**
+ * @brief Lee un Label y compara su nombre y su valor.
+ */
+static int pb_label_is(pb_reader_t* series, const char* name, const char* value)
+{
+    pb_reader_t label, text;
+    if (!pb_len_field(series, 1, &label))
+    {
+        return 0;
+    }
+    int ok = pb_len_field(&label, 1, &text) && (size_t)(text.end - text.pos) == strlen(name) &&
+             memcmp(text.pos, name, strlen(name)) == 0;
+    ok = ok && pb_len_field(&label, 2, &text) && (size_t)(text.end - text.pos) == strlen(value) &&
+         memcmp(text.pos, value, strlen(value)) == 0;
+    return ok && label.pos == label.end;
+}
+
+/**
+ * @brief Descomprime un bloque de snappy.
+ *
+ * @return Datos reservados con malloc, o NULL si el bloque no es válido.
+ */
+static uint8_t* snappy_decompress(const uint8_t* in, size_t len, size_t* out_len)
+{
+    pb_reader_t r = {in, in + len};
+    uint64_t size;
+    if (!pb_varint(&r, &size))
+    {
+        return NULL;
+    }
+    uint8_t* out = malloc(size + 1);
+    size_t pos = 0;
+    while (out != NULL && r.pos < r.end)
+    {
+        uint8_t tag = *r.pos++;
+        size_t n, offset = 0;
+        if ((tag & 3) == 0)
+        {
+            n = tag >> 2;
+            if (n >= 60)
+            {
+                int bytes = (int)n - 59;
+                n = 0;
+                for (int b = 0; b < bytes && r.pos < r.end; b++)
+                {
+                    n |= (size_t)*r.pos++ << (8 * b);
+                }
+            }
+            n++;
+            if (n > (size_t)(r.end - r.pos) || pos + n > size)
+            {
+                break;
+            }
+            memcpy(out + pos, r.pos, n);
+            r.pos += n;
+            pos += n;
+            continue;
+        }
+        int bytes = (tag & 3) == 1 ? 1 : (tag & 3) == 2 ? 2 : 4;
+        n = (tag & 3) == 1 ? (size_t)((tag >> 2) & 7) + 4 : (size_t)(tag >> 2) + 1;
+        offset = (tag & 3) == 1 ? (size_t)(tag >> 5) << 8 : 0;
+        for (int b = 0; b < bytes && r.pos < r.end; b++)
+        {
+            offset |= (size_t)*r.pos++ << (8 * ((tag & 3) == 1 ? 0 : b));
+        }
+        if (offset == 0 || offset > pos || pos + n > size)
+        {
+            break;
+        }
+        for (size_t i = 0; i < n; i++, pos++)
+        {
+            out[pos] = out[pos - offset];
+        }
+    }
+    if (out != NULL && (r.pos != r.end || pos != size))
+    {
+        free(out);
+        out = NULL;
+    }
+    *out_len = pos;
+    return out;
+}
+
+/**
+ * @brief Comprime y descomprime un buffer y verifica que vuelve igual.
+ *
+ * @return Bytes comprimidos.
+ */
+static size_t check_snappy(const uint8_t* data, size_t len)
+{
+    push_buffer_t compressed = {0};
+    CHECK(snappy_compress(data, len, &compressed) == 0);
+    size_t out_len = 0;
+    uint8_t* out = snappy_decompress(compressed.data, compressed.len, &out_len);
+    CHECK(out != NULL && out_len == len && (len == 0 || memcmp(out, data, len) == 0));
+    free(out);
+    free(compressed.data);
+    return compressed.len;
+}
+
+int main()
+{
+    CHECK(prom_collector_registry_default_init() == 0);
+    const char* labels[] = {"mode", "cpu"};
+    void* metric = prom_gauge_new("node_cpu_test", "Prueba", 2, labels);
+    CHECK(metric_registry_register(metric, "node_cpu_test", 2, labels) == metric);
+
+    // Una TimeSeries por muestra, con __name__ y las etiquetas ordenadas por nombre; las no registradas se omiten
+    static int unregistered;
+    push_sample_t samples[2] = {{metric, 1700000000123LL, 1.5, 2, {"idle", "3"}}, {&unregistered, 1, 2.0, 0, {{0}}}};
+    push_buffer_t proto = {0};
+    CHECK(remote_write_encode(samples, 2, &proto) == 0);
+    pb_reader_t request = {proto.data, proto.data + proto.len}, series, sample;
+    CHECK(pb_len_field(&request, 1, &series));
+    CHECK(request.pos == request.end);
+    CHECK(pb_label_is(&series, "__name__", "node_cpu_test"));
+    CHECK(pb_label_is(&series, "cpu", "3"));
+    CHECK(pb_label_is(&series, "mode", "idle"));
+    CHECK(pb_len_field(&series, 2, &sample));
+    CHECK(series.pos == series.end);
+    double value = 0;
+    uint64_t key = 0, timestamp = 0;
+    CHECK(sample.end - sample.pos == 1 + 8 + 1 + 6);
+    CHECK(pb_varint(&sample, &key) && key == (1 << 3 | 1));
+    memcpy(&value, sample.pos, sizeof(value));
+    sample.pos += sizeof(value);
+    CHECK(value == 1.5);
+    CHECK(pb_varint(&sample, &key) && key == (2 << 3 | 0));
+    CHECK(pb_varint(&sample, &timestamp) && timestamp == 1700000000123ULL);
+
+    // snappy: vacío, sin repeticiones, con repeticiones largas y cruzando fragmentos, y el propio WriteRequest
+    check_snappy(NULL, 0);
+    uint8_t noise[1000];
+    uint32_t seed = 12345;
+    for (size_t i = 0; i < sizeof(noise); i++)
+    {
+        seed = seed * 1103515245u + 12345u;
+        noise[i] = (uint8_t)(seed >> 16);
+    }
+    check_snappy(noise, sizeof(noise));
+    size_t big_len = 3 * SNAPPY_FRAGMENT_SIZE + 77;
+    uint8_t* big = malloc(big_len);
+    CHECK(big != NULL);
+    if (big != NULL)
+    {
+        static const char pattern[] = "cpu_usage_percentage{cpu=\"0\"} ";
+        for (size_t i = 0; i < big_len; i++)
+        {
+            big[i] = (uint8_t)(pattern[i % (sizeof(pattern) - 1)] + (i / 4096) % 3);
+        }
+        CHECK(check_snappy(big, big_len) < big_len / 4);
+        free(big);
+    }
+    check_snappy(proto.data, proto.len);
+
+    free(proto.data);
+    return TEST_RESULT();
+}
@@ -0,0 +1,72 @@
+/**
+ * @file test_scan.c
+ * @brief Tokenizador de scan.h: líneas, claves, números y campos sobre buffers sin '\0' final.
+ */
+
+#include "scan.h"
+#include "test.h"
+#include <string.h>
+
+/**
+ * @brief Cursor sobre un texto sin su '\0'.
+ */
+static scan_t scan_text(const char* text)
+{
+    scan_t s;
+    scan_init(&s, text, strlen(text));
+    return s;
+}
+
+int main()
+{
+    // Líneas: la última puede no terminar en '\n' y una línea vacía cuenta
+    scan_t s = scan_text("uno\n\ntres");
+    scan_t line;
+    CHECK(scan_next_line(&s, &line) && line.end - line.pos == 3 && memcmp(line.pos, "uno", 3) == 0);
+    CHECK(scan_next_line(&s, &line) && line.end == line.pos);
+    CHECK(scan_next_line(&s, &line) && line.end - line.pos == 4);
+    CHECK(!scan_next_line(&s, &line));
+
+    // Claves con ':' y con espacio; un prefijo de otra clave no coincide
+    unsigned long long value = 0;
+    s = scan_text("MemTotalX: 1\nMemTotal:   16318072 kB\npgfault 42\n");
+    CHECK(scan_skip_to_key(&s, "MemTotal", &line) && scan_u64(&line, &value) && value == 16318072ULL);
+    CHECK(scan_skip_to_key(&s, "pgfault", &line) && scan_u64(&line, &value) && value == 42);
+    CHECK(!scan_skip_to_key(&s, "pgmajfault", &line));
+
+    // Enteros y decimales; el cursor no lee más allá del final aunque siga un dígito en memoria
+    const char digits[] = "18446744073709551615 12.5 7";
+    scan_init(&s, digits, sizeof(digits) - 2);
+    double real = 0;
+    CHECK(scan_u64(&s, &value) && value == 18446744073709551615ULL);
+    CHECK(scan_double(&s, &real) && real == 12.5);
+    CHECK(!scan_u64(&s, &value));
+    s = scan_text("  abc");
+    CHECK(!scan_u64(&s, &value));
+    CHECK(scan_starts_with(&s, "ab") && !scan_starts_with(&s, "abcd"));
+
+    // Campos: se saltan los pedidos y luego se extrae el siguiente sin copiarlo
+    const char* tok;
+    size_t len;
+    s = scan_text("8 0 sda 100 \t 200");
+    CHECK(scan_skip_fields(&s, 2) && scan_token(&s, &tok, &len) && len == 3 && memcmp(tok, "sda", 3) == 0);
+    CHECK(scan_skip_fields(&s, 2) && !scan_token(&s, &tok, &len));
+    s = scan_text("a b");
+    CHECK(!scan_skip_fields(&s, 3));
+
+    // Texto hasta un delimitador, con el número pegado como en /proc/net/dev
+    s = scan_text("  eth0:1234 5");
+    CHECK(scan_until(&s, ':', &tok, &len) && len == 4 && memcmp(tok, "eth0", 4) == 0);
+    CHECK(scan_u64(&s, &value) && value == 1234);
+    s = scan_text("lo 1");
+    CHECK(!scan_until(&s, ':', &tok, &len));
+
+    // Copia truncada y siempre terminada en '\0'
+    char small[4];
+    scan_copy(small, sizeof(small), "abcdef", 6);
+    CHECK(strcmp(small, "abc") == 0);
+    scan_copy(small, sizeof(small), "xy", 2);
+    CHECK(strcmp(small, "xy") == 0);
+
+    return TEST_RESULT();
+}